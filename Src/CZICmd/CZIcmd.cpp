@@ -8,6 +8,7 @@
 #include "execute.h"
 #include "inc_libCZI.h"
 #include <clocale>
+#include <iomanip>
 #if CZICMD_WINDOWSAPI_AVAILABLE
 #include <Windows.h>
 #endif
@@ -64,6 +65,36 @@ public:
     }
 };
 
+static void PrintPerformanceCounters(const CCmdLineOptions& options)
+{
+    const auto counters = libCZI::GetGlobalPerformanceCounters();
+    options.GetLog()->WriteLineStdOut("");
+    options.GetLog()->WriteLineStdOut("Performance counters:");
+    for (std::uint8_t i = 0; i < static_cast<std::uint8_t>(libCZI::PerformanceCounter::Count); ++i)
+    {
+        const auto counter = static_cast<libCZI::PerformanceCounter>(i);
+        std::stringstream ss;
+        ss << "  " << std::left << std::setw(30) << libCZI::GetPerformanceCounterName(counter) << counters.GetCounter(counter);
+        options.GetLog()->WriteLineStdOut(ss.str());
+    }
+
+    options.GetLog()->WriteLineStdOut("Performance timers:");
+    for (std::uint8_t i = 0; i < static_cast<std::uint8_t>(libCZI::PerformanceTimer::Count); ++i)
+    {
+        const auto timer = static_cast<libCZI::PerformanceTimer>(i);
+        const auto& histogram = counters.GetTimer(timer);
+        std::stringstream ss;
+        ss << "  " << std::left << std::setw(30) << libCZI::GetPerformanceTimerName(timer) << "count: " << histogram.count
+            << ", total: " << std::fixed << std::setprecision(3) << static_cast<double>(histogram.total_nanoseconds) / 1e6 << "ms";
+        if (histogram.count > 0)
+        {
+            ss << ", average: " << static_cast<double>(histogram.total_nanoseconds) / histogram.count / 1e3 << "us";
+        }
+
+        options.GetLog()->WriteLineStdOut(ss.str());
+    }
+}
+
 int main(int argc, char** _argv)
 {
 #if CZICMD_WINDOWSAPI_AVAILABLE
@@ -94,7 +125,19 @@ int main(int argc, char** _argv)
                 CLibCZISite site(options);
                 libCZI::SetSiteObject(&site);
 
+                if (!options.GetTraceEventsFilename().empty())
+                {
+                    libCZI::SetTraceEventSink(libCZI::CreateChromeTraceEventSink(libCZI::CreateOutputStreamForFile(options.GetTraceEventsFilename().c_str(), true)));
+                }
+
                 execute(options);
+
+                // releasing the trace-event sink will terminate the trace-events file
+                libCZI::SetTraceEventSink(nullptr);
+                if (options.GetPrintPerformanceCounters())
+                {
+                    PrintPerformanceCounters(options);
+                }
             }
         }
         else if (cmdLineParseResult == CCmdLineOptions::ParseResult::Error)
@@ -470,6 +470,27 @@ struct TileSizeForPlaneScanValidator : public CLI::Validator
     }
 };
 
+/// CLI11-validator for the option "--subblock-layout".
+struct SubBlockLayoutValidator : public CLI::Validator
+{
+    SubBlockLayoutValidator()
+    {
+        this->name_ = "SubBlockLayoutValidator";
+        this->func_ = [](const std::string& str) -> string
+            {
+                const bool parsed_ok = CCmdLineOptions::TryParseSubBlockLayout(str, nullptr);
+                if (!parsed_ok)
+                {
+                    ostringstream string_stream;
+                    string_stream << "Invalid subblock-layout given \"" << str << "\"";
+                    throw CLI::ValidationError(string_stream.str());
+                }
+
+                return {};
+            };
+    }
+};
+
 /// A custom formatter for CLI11 - used to have nicely formatted descriptions.
 class CustomFormatter : public CLI::Formatter
 {
@@ -540,6 +561,16 @@ CCmdLineOptions::ParseResult CCmdLineOptions::Parse(int argc, char** argv)
         { "ExtractAttachment",                  Command::ExtractAttachment},
         { "CreateCZI",                          Command::CreateCZI },
         { "PlaneScan",                          Command::PlaneScan },
+        { "RewriteCZI",                         Command::RewriteCZI },
+        { "CompactCZI",                         Command::CompactCZI },
+        { "TranscodeCZI",                       Command::TranscodeCZI },
+        { "Benchmark",                          Command::Benchmark },
+    };
+
+    static const std::map<std::string, BenchmarkReportFormat> map_string_to_benchmark_report_format
+    {
+        { "Text",   BenchmarkReportFormat::Text },
+        { "JSON",   BenchmarkReportFormat::Json },
     };
 
     const static PlaneCoordinateValidator plane_coordinate_validator;
@@ -563,6 +594,7 @@ CCmdLineOptions::ParseResult CCmdLineOptions::Parse(int argc, char** argv)
     const static GeneratorPixelTypeValidator generatorpixeltype_validator;
     const static CacheSizeValidator cachesize_validator;
     const static TileSizeForPlaneScanValidator tile_size_for_plane_scan_validator;
+    const static SubBlockLayoutValidator subblock_layout_validator;
 
     Command argument_command;
     string argument_source_filename;
@@ -593,16 +625,23 @@ CCmdLineOptions::ParseResult CCmdLineOptions::Parse(int argc, char** argv)
     string argument_generatorpixeltype;
     string argument_subblock_cachesize;
     string argument_tilesize_for_scan;
+    string argument_subblock_layout;
+    int argument_threads = 0;
     bool argument_versionflag = false;
     string argument_source_stream_class;
     string argument_source_stream_creation_propbag;
     bool argument_use_visibility_check_optimization = false;
     bool argument_use_mask_aware_compositing = false;
+    bool argument_performance_counters = false;
+    string argument_trace_events_filename;
+    BenchmarkReportFormat argument_benchmark_report_format;
+    int argument_benchmark_samples = 100;
 
     // editorconfig-checker-disable
     cli_app.add_option("-c,--command", argument_command,
         R"(COMMAND can be one of 'PrintInformation', 'ExtractSubBlock', 'SingleChannelTileAccessor', 'ChannelComposite',
-           'SingleChannelPyramidTileAccessor', 'SingleChannelScalingTileAccessor', 'ScalingChannelComposite', 'ExtractAttachment' and 'CreateCZI'.
+           'SingleChannelPyramidTileAccessor', 'SingleChannelScalingTileAccessor', 'ScalingChannelComposite', 'ExtractAttachment', 'CreateCZI',
+           'PlaneScan', 'RewriteCZI', 'CompactCZI', 'TranscodeCZI' and 'Benchmark'.
            \N'PrintInformation' will print information about the CZI-file to the console. The argument 'info-level' can be used
            to specify which information is to be printed.
            \N'ExtractSubBlock' will write the bitmap contained in the specified sub-block to the OUTPUTFILE.
@@ -623,7 +662,26 @@ CCmdLineOptions::ParseResult CCmdLineOptions::Parse(int argc, char** argv)
            the --tilesize-for-plane-scan option is moved, and the image content of this rectangle is written out to
            files. The operation takes place on a plane which is given with the --plane-coordinate option. The filenames of the
            tile-bitmaps are generated from the filename given with the --output option, where a string _X[x-position]_Y[y-position]_W[width]_H[height]
-           is added.)")
+           is added. The tiles are rendered (in the order of a Hilbert curve over the tiles) on the number of threads given with the --threads
+           option, and the PNG-files are encoded and written on separate threads. The Hilbert order only pays off if a subblock-cache
+           is given with the --cachesize option, which is then shared by all rendering threads.
+           \N'RewriteCZI' copies the source CZI-file (subblocks, attachments and metadata) without re-encoding into a new CZI-file,
+           where the subblocks are stored in the order given with the --subblock-layout option. Subblocks with identical content are
+           stored only once. The new CZI-file gets the file-GUID given with the --guidofczi option, or a new file-GUID.
+           \N'CompactCZI' creates a compacted version of the source CZI-file (e.g. after it has been edited in place), where unused space
+           and deleted segments are removed and the subblocks are stored in the order given with the --subblock-layout option. Subblocks with
+           identical content are stored only once (so that segments shared in the source remain shared). The file-GUID
+           is retained (unless specified with the --guidofczi option). The OUTPUTFILE may be the same as the SOURCEFILE, the compacted
+           document is written to a temporary file which replaces the OUTPUTFILE only after the operation completed successfully.
+           \N'TranscodeCZI' decodes all subblocks of the source CZI-file and re-encodes them with the compression given with the --compressionopts
+           option (default is 'zstd1') into a new CZI-file, where attachments and metadata are copied as is. Decoding and encoding is done on the
+           number of threads given with the --threads option, and the throughput is reported.
+           \N'Benchmark' measures the performance of reading the source CZI-file (opened with the stream-class given with --source-stream-class):
+           opening the document, enumerating the subblock-directory, reading and parsing the metadata, reading subblocks sequentially and
+           randomly, decoding subblocks (for each compression mode) and getting randomly positioned viewports (of the size given with
+           --tilesize-for-plane-scan) at several zoom levels without and with a subblock-cache. The number of samples is given with
+           --benchmark-samples, and the operations are run on the number of threads given with the --threads option. Latency percentiles
+           and throughput are reported in the format given with --benchmark-format.)")
         ->default_val(Command::Invalid)
         ->option_text("COMMAND")
         ->transform(CLI::CheckedTransformer(map_string_to_command, CLI::ignore_case));
@@ -737,7 +795,7 @@ CCmdLineOptions::ParseResult CCmdLineOptions::Parse(int argc, char** argv)
         ->option_text("HEIGHT")
         ->check(CLI::Range(0.f, 10000.f));
     cli_app.add_option("-g,--guidofczi", argument_guidofczi,
-        "Only used for 'CreateCZI': specify the GUID of the file (which is useful for bit-exact reproducible results); the GUID must be "
+        "Only used for 'CreateCZI', 'RewriteCZI', 'CompactCZI' and 'TranscodeCZI': specify the GUID of the file (which is useful for bit-exact reproducible results); the GUID must be "
         "given in the form  \"cfc4a2fe-f968-4ef8-b685-e73d1b77271a\" or \"{cfc4a2fe-f968-4ef8-b685-e73d1b77271a}\"")
         ->option_text("CZI-File-GUID")
         ->check(guidofczi_validator);
@@ -752,7 +810,7 @@ CCmdLineOptions::ParseResult CCmdLineOptions::Parse(int argc, char** argv)
         ->option_text("KEY_VALUE_SUBBLOCKMETADATA")
         ->check(createsubblockmetadata_validator);
     cli_app.add_option("--compressionopts", argument_compressionoptions,
-        "Only used for 'CreateCZI': a string in a defined format which states the compression-method and (compression-method specific) "
+        "Only used for 'CreateCZI' and 'TranscodeCZI': a string in a defined format which states the compression-method and (compression-method specific) "
         "parameters. The format is \"compression_method: key=value; ...\". It starts with the name of the compression-method, followed by a colon, "
         "then followed by a list of key-value pairs which are separated by a semicolon. Examples: \"zstd0:ExplicitLevel=3\", \"zstd1:ExplicitLevel=2;PreProcess=HiLoByteUnpack\".")
         ->option_text("COMPRESSIONDESCRIPTION")
@@ -763,19 +821,47 @@ CCmdLineOptions::ParseResult CCmdLineOptions::Parse(int argc, char** argv)
         ->option_text("PIXELTYPE")
         ->check(generatorpixeltype_validator);
     cli_app.add_option("--cachesize", argument_subblock_cachesize,
-        "Only used for 'PlaneScan' - specify the size of the subblock-cache in bytes. The argument is to "
+        "Only used for 'PlaneScan' and 'Benchmark' - specify the size of the subblock-cache in bytes. The argument is to "
         "be given with a suffix k, M, G, ...")
         ->option_text("CACHESIZE")
         ->check(cachesize_validator);
     cli_app.add_option("--tilesize-for-plane-scan", argument_tilesize_for_scan,
-        "Only used for 'PlaneScan' - specify the size of ROI which is used for scanning the plane in "
-        "units of pixels. Format is e.g. '1600x1200' and default is 512x512.")
+        "Only used for 'PlaneScan' and 'Benchmark' - specify the size of ROI which is used for scanning the plane (or the size of the "
+        "viewports for 'Benchmark') in units of pixels. Format is e.g. '1600x1200' and default is 512x512.")
         ->option_text("TILESIZE")
         ->check(tile_size_for_plane_scan_validator);
+    cli_app.add_option("--subblock-layout", argument_subblock_layout,
+        "Only used for 'RewriteCZI' and 'CompactCZI' - specify the order in which the subblocks are stored in the output file. Possible values are "
+        "'InOrderOfAddition' (the order of the source file), 'Morton' (per plane and pyramid-layer in Morton-order) or "
+        "'Hilbert' (per plane and pyramid-layer in Hilbert-order). Default is 'Hilbert'.")
+        ->option_text("LAYOUT")
+        ->check(subblock_layout_validator);
+    cli_app.add_option("--threads", argument_threads,
+        "Only used for 'PlaneScan', 'TranscodeCZI' and 'Benchmark' - specify the number of worker threads. Default is 0, which means that the number of hardware threads is used. "
+        "With 'PlaneScan', the threads only share decoded subblocks if a subblock-cache is given with the --cachesize option.")
+        ->option_text("NUMBER")
+        ->check(CLI::Range(0, 1024));
+    cli_app.add_option("--benchmark-format", argument_benchmark_report_format,
+        "Only used for 'Benchmark' - specify the format of the report, which can be 'Text' or 'JSON'. Default is 'Text'.")
+        ->default_val(BenchmarkReportFormat::Text)
+        ->option_text("FORMAT")
+        ->transform(CLI::CheckedTransformer(map_string_to_benchmark_report_format, CLI::ignore_case));
+    cli_app.add_option("--benchmark-samples", argument_benchmark_samples,
+        "Only used for 'Benchmark' - specify the number of samples for each measurement (e.g. the number of subblocks read or "
+        "the number of viewports per zoom level). Default is 100.")
+        ->option_text("NUMBER")
+        ->check(CLI::Range(1, 1000000));
     cli_app.add_flag("--use-visibility-check-optimization", argument_use_visibility_check_optimization,
         "Whether to enable the experimental \"visibility check optimization\" for the accessors.");
     cli_app.add_flag("--mask-aware-compositing", argument_use_mask_aware_compositing,
         "Whether to use mask-aware compositing. This is subject to the availability of mask data in the CZI-file.");
+    cli_app.add_flag("--performance-counters", argument_performance_counters,
+        "Print libCZI's performance counters (number of stream reads, sub-blocks read, cache hits, timings of decode and "
+        "composition operations) after the operation has completed.");
+    cli_app.add_option("--trace-events", argument_trace_events_filename,
+        "Write a trace of the timed operations within libCZI to the specified file. The file is in the JSON format of the "
+        "\"Chrome Trace Event Format\" and can be loaded into \"chrome://tracing\" or \"https://ui.perfetto.dev\".")
+        ->option_text("FILENAME");
     cli_app.add_flag("--version", argument_versionflag,
         "Print extended version-info and supported operations, then exit.");
 
@@ -812,6 +898,10 @@ CCmdLineOptions::ParseResult CCmdLineOptions::Parse(int argc, char** argv)
     this->command = argument_command;
     this->useVisibilityCheckOptimization = argument_use_visibility_check_optimization;
     this->use_mask_aware_compositing_ = argument_use_mask_aware_compositing;
+    this->numberOfThreads = argument_threads;
+    this->printPerformanceCounters = argument_performance_counters;
+    this->benchmarkReportFormat = argument_benchmark_report_format;
+    this->benchmarkSamples = argument_benchmark_samples;
 
     try
     {
@@ -836,6 +926,11 @@ CCmdLineOptions::ParseResult CCmdLineOptions::Parse(int argc, char** argv)
             this->SetOutputFilename(convertUtf8ToWide(argument_output_filename));
         }
 
+        if (!argument_trace_events_filename.empty())
+        {
+            this->traceEventsFilename = convertUtf8ToWide(argument_trace_events_filename);
+        }
+
         if (!argument_plane_coordinate.empty())
         {
             this->planeCoordinate = libCZI::CDimCoordinate::Parse(argument_plane_coordinate.c_str());
@@ -983,6 +1078,12 @@ CCmdLineOptions::ParseResult CCmdLineOptions::Parse(int argc, char** argv)
             const bool b = TryParseCreateSize(argument_tilesize_for_scan, &this->tilesSizeForPlaneScan);
             ThrowIfFalse(b, "--tilesize-for-plane-scan", argument_tilesize_for_scan);
         }
+
+        if (!argument_subblock_layout.empty())
+        {
+            const bool b = TryParseSubBlockLayout(argument_subblock_layout, &this->subBlockLayoutForRewrite);
+            ThrowIfFalse(b, "--subblock-layout", argument_subblock_layout);
+        }
     }
     catch (runtime_error& exception)
     {
@@ -1023,7 +1124,7 @@ bool CCmdLineOptions::CheckArgumentConsistency() const
         return false;
     }
 
-    if (cmd != Command::PrintInformation)
+    if (cmd != Command::PrintInformation && cmd != Command::Benchmark)
     {
         auto str = this->MakeOutputFilename(nullptr, nullptr);
         if (str.empty())
@@ -1121,6 +1222,12 @@ void CCmdLineOptions::Clear()
     this->tilesSizeForPlaneScan = make_tuple(512, 512);
     this->useVisibilityCheckOptimization = false;
     this->use_mask_aware_compositing_ = false;
+    this->subBlockLayoutForRewrite = libCZI::CZIWriterSubBlockLayout::PlaneThenHilbertOrder;
+    this->numberOfThreads = 0;
+    this->printPerformanceCounters = false;
+    this->traceEventsFilename.clear();
+    this->benchmarkReportFormat = BenchmarkReportFormat::Text;
+    this->benchmarkSamples = 100;
 }
 
 bool CCmdLineOptions::IsLogLevelEnabled(int level) const
@@ -2435,3 +2542,33 @@ void CCmdLineOptions::PrintHelpStreamsObjects()
 
     return true;
 }
+
+/*static*/bool CCmdLineOptions::TryParseSubBlockLayout(const std::string& s, libCZI::CZIWriterSubBlockLayout* layout)
+{
+    static const struct
+    {
+        const char* name;
+        libCZI::CZIWriterSubBlockLayout layout;
+    } possible_layouts[] =
+    {
+        { "InOrderOfAddition", libCZI::CZIWriterSubBlockLayout::InOrderOfAddition },
+        { "Morton", libCZI::CZIWriterSubBlockLayout::PlaneThenMortonOrder },
+        { "Hilbert", libCZI::CZIWriterSubBlockLayout::PlaneThenHilbertOrder },
+    };
+
+    const auto layout_string = trim(s);
+    for (const auto& item : possible_layouts)
+    {
+        if (icasecmp(layout_string, item.name))
+        {
+            if (layout != nullptr)
+            {
+                *layout = item.layout;
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
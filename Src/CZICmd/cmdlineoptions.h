@@ -35,6 +35,21 @@ enum class Command
     ReadWriteCZI,
 
     PlaneScan,
+
+    RewriteCZI,
+
+    CompactCZI,
+
+    TranscodeCZI,
+
+    Benchmark,
+};
+
+/// Values that represent the format in which the results of the 'Benchmark' command are reported.
+enum class BenchmarkReportFormat
+{
+    Text,
+    Json,
 };
 
 enum class InfoLevel : std::uint32_t
@@ -198,6 +213,12 @@ private:
 
     bool useVisibilityCheckOptimization;
     bool use_mask_aware_compositing_;
+    libCZI::CZIWriterSubBlockLayout subBlockLayoutForRewrite;   ///< The layout of the subblocks in the output-file for the 'RewriteCZI' and 'CompactCZI' operations.
+    int numberOfThreads;    ///< The number of worker threads to use (for operations which support this), where 0 means "number of hardware threads".
+    bool printPerformanceCounters;  ///< Whether to print libCZI's performance counters after the operation has completed.
+    std::wstring traceEventsFilename;   ///< The filename of the trace-events file to write (empty if no trace is to be written).
+    BenchmarkReportFormat benchmarkReportFormat;    ///< The format of the report of the 'Benchmark' command.
+    int benchmarkSamples;   ///< The number of samples (per measurement) for the 'Benchmark' command.
 public:
     /// Values that represent the result of the "Parse"-operation.
     enum class ParseResult
@@ -269,6 +290,12 @@ public:
     const std::tuple<std::uint32_t, std::uint32_t>& GetTileSizeForPlaneScan() const { return this->tilesSizeForPlaneScan; }
     bool GetUseVisibilityCheckOptimization() const { return this->useVisibilityCheckOptimization; }
     bool GetUseMaskAwareCompositing() const { return this->use_mask_aware_compositing_; }
+    libCZI::CZIWriterSubBlockLayout GetSubBlockLayoutForRewrite() const { return this->subBlockLayoutForRewrite; }
+    int GetNumberOfThreads() const { return this->numberOfThreads; }
+    bool GetPrintPerformanceCounters() const { return this->printPerformanceCounters; }
+    const std::wstring& GetTraceEventsFilename() const { return this->traceEventsFilename; }
+    BenchmarkReportFormat GetBenchmarkReportFormat() const { return this->benchmarkReportFormat; }
+    int GetBenchmarkSamples() const { return this->benchmarkSamples; }
 private:
     friend struct RegionOfInterestValidator;
     friend struct DisplaySettingsValidator;
@@ -290,6 +317,7 @@ private:
     friend struct GeneratorPixelTypeValidator;
     friend struct CacheSizeValidator;
     friend struct TileSizeForPlaneScanValidator;
+    friend struct SubBlockLayoutValidator;
 
     bool CheckArgumentConsistency() const;
     void SetOutputFilename(const std::wstring& s);
@@ -322,6 +350,7 @@ private:
     static bool TryParseGeneratorPixeltype(const std::string& s, libCZI::PixelType* pixel_type);
     static bool TryParseInputStreamCreationPropertyBag(const std::string& s, std::map<int, libCZI::StreamsFactory::Property>* property_bag);
     static bool TryParseSubBlockCacheSize(const std::string& text, std::uint64_t* size);
+    static bool TryParseSubBlockLayout(const std::string& s, libCZI::CZIWriterSubBlockLayout* layout);
 
     static void ThrowIfFalse(bool b, const std::string& argument_switch, const std::string& argument);
 };
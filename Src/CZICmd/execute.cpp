@@ -7,6 +7,10 @@
 #include "executeBase.h"
 #include "executeCreateCzi.h"
 #include "executePlaneScan.h"
+#include "executeRewriteCzi.h"
+#include "executeCompactCzi.h"
+#include "executeTranscodeCzi.h"
+#include "executeBenchmark.h"
 #include "inc_libCZI.h"
 #include "SaveBitmap.h"
 #include "utils.h"
@@ -1144,6 +1148,18 @@ bool execute(const CCmdLineOptions& options)
         case Command::PlaneScan:
             success = executePlaneScan(options);
             break;
+        case Command::RewriteCZI:
+            success = executeRewriteCzi(options);
+            break;
+        case Command::CompactCZI:
+            success = executeCompactCzi(options);
+            break;
+        case Command::TranscodeCZI:
+            success = executeTranscodeCzi(options);
+            break;
+        case Command::Benchmark:
+            success = executeBenchmark(options);
+            break;
         default:
             break;
         }
@@ -11,22 +11,23 @@ using namespace libCZI;
 
 std::shared_ptr<ICZIReader> CExecuteBase::CreateAndOpenCziReader(const CCmdLineOptions& options)
 {
-    shared_ptr<IStream> stream;
+    const auto stream = CExecuteBase::CreateSourceStream(options);
+    auto spReader = libCZI::CreateCZIReader();
+    spReader->Open(stream);
+    return spReader;
+}
+
+std::shared_ptr<IStream> CExecuteBase::CreateSourceStream(const CCmdLineOptions& options)
+{
     if (options.GetInputStreamClassName().empty())
     {
-        stream = CExecuteBase::CreateStandardFileBasedStreamObject(options.GetCZIFilename().c_str());
-    }
-    else
-    {
-        stream = CExecuteBase::CreateInputStreamObject(
-                                options.GetCZIFilename().c_str(),
-                                options.GetInputStreamClassName(),
-                                &options.GetInputStreamPropertyBag());
+        return CExecuteBase::CreateStandardFileBasedStreamObject(options.GetCZIFilename().c_str());
     }
 
-    auto spReader = libCZI::CreateCZIReader();
-    spReader->Open(stream);
-    return spReader;
+    return CExecuteBase::CreateInputStreamObject(
+                            options.GetCZIFilename().c_str(),
+                            options.GetInputStreamClassName(),
+                            &options.GetInputStreamPropertyBag());
 }
 
 std::shared_ptr<IStream> CExecuteBase::CreateStandardFileBasedStreamObject(const wchar_t* fileName)
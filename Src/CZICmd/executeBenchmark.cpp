@@ -0,0 +1,559 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "executeBenchmark.h"
+#include "executeBase.h"
+#include "inc_rapidjson.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace libCZI;
+
+/// This operation characterizes the performance of reading a (real) CZI-file on (real) storage. The file is opened
+/// with the stream-class given on the command line, and the following is measured:
+/// - creating the stream object and opening the document (i.e. reading the file-header and the subblock-directory),
+/// - enumerating the subblock-directory,
+/// - reading and parsing the metadata-segment,
+/// - reading subblocks sequentially (in the order of their file-position) and in random order,
+/// - decoding subblocks (for each compression mode found in the document),
+/// - getting randomly positioned viewports from the scaling-tile-accessor at several zoom levels, without
+///   and with a subblock-cache (for each zoom level, the run without cache is followed by the run with cache,
+///   using the same viewports).
+///
+/// The number of samples for each measurement is given with the "--benchmark-samples" option, and (except for opening
+/// the document and reading the metadata) the operations are run on the number of threads given with "--threads".
+/// For each measurement the latency percentiles and the throughput are reported, either as text or in JSON-format.
+class CExecuteBenchmark : public CExecuteBase
+{
+private:
+    /// The number of times the operations "open the document" and "read/parse the metadata" are repeated.
+    static constexpr int OpenRepetitions = 5;
+
+    /// The default size (in bytes) of the subblock-cache used for the viewport measurements "with cache", used
+    /// if no size is given with the "--cachesize" option.
+    static constexpr uint64_t DefaultCacheSize = 1024ull * 1024 * 1024;
+
+    /// The seed of the pseudo-random number generator (so that the same file results in the same workload).
+    static constexpr uint32_t RandomSeed = 42;
+
+    struct SubBlockEntry
+    {
+        int index;
+        DirectorySubBlockInfo info;
+    };
+
+    struct Measurement
+    {
+        string name;
+        int threads;
+        vector<double> latencies;   ///< The duration of each operation in seconds.
+        double wall_seconds;        ///< The elapsed (wall-clock) time for all operations.
+        uint64_t bytes;             ///< The number of bytes processed (0 if not applicable).
+    };
+public:
+    static bool execute(const CCmdLineOptions& options)
+    {
+        const int number_of_threads = options.GetNumberOfThreads() > 0 ? options.GetNumberOfThreads() : (std::max)(1, static_cast<int>(thread::hardware_concurrency()));
+        const size_t samples = static_cast<size_t>(options.GetBenchmarkSamples());
+        vector<Measurement> measurements;
+
+        const auto reader = CExecuteBenchmark::MeasureOpen(options, measurements);
+        const auto sub_blocks = CExecuteBenchmark::MeasureEnumerateDirectory(reader.get(), measurements);
+        CExecuteBenchmark::MeasureMetadata(reader.get(), measurements);
+
+        mt19937 random_generator(RandomSeed);
+        CExecuteBenchmark::MeasureReadSubBlocks(reader, sub_blocks, samples, number_of_threads, random_generator, measurements);
+        CExecuteBenchmark::MeasureDecode(reader, sub_blocks, samples, number_of_threads, random_generator, measurements);
+        CExecuteBenchmark::MeasureViewports(reader, options, samples, number_of_threads, random_generator, measurements);
+
+        if (options.GetBenchmarkReportFormat() == BenchmarkReportFormat::Json)
+        {
+            CExecuteBenchmark::ReportAsJson(options, number_of_threads, samples, measurements);
+        }
+        else
+        {
+            CExecuteBenchmark::ReportAsText(options, number_of_threads, samples, measurements);
+        }
+
+        return true;
+    }
+private:
+    static shared_ptr<ICZIReader> MeasureOpen(const CCmdLineOptions& options, vector<Measurement>& measurements)
+    {
+        Measurement create_stream{ "create-stream", 1, {}, 0, 0 };
+        Measurement open{ "open (file-header and subblock-directory)", 1, {}, 0, 0 };
+        shared_ptr<ICZIReader> reader;
+        for (int i = 0; i < OpenRepetitions; ++i)
+        {
+            auto start = chrono::steady_clock::now();
+            const auto stream = CExecuteBase::CreateSourceStream(options);
+            create_stream.latencies.push_back(CExecuteBenchmark::GetSecondsSince(start));
+
+            start = chrono::steady_clock::now();
+            reader = libCZI::CreateCZIReader();
+            reader->Open(stream);
+            open.latencies.push_back(CExecuteBenchmark::GetSecondsSince(start));
+        }
+
+        create_stream.wall_seconds = CExecuteBenchmark::GetSum(create_stream.latencies);
+        open.wall_seconds = CExecuteBenchmark::GetSum(open.latencies);
+        measurements.push_back(std::move(create_stream));
+        measurements.push_back(std::move(open));
+        return reader;
+    }
+
+    /// Enumerates the subblock-directory (and measures the time for this) and returns the information about all
+    /// subblocks sorted by file-position.
+    static vector<SubBlockEntry> MeasureEnumerateDirectory(ICZIReader* reader, vector<Measurement>& measurements)
+    {
+        Measurement enumerate{ "enumerate-directory", 1, {}, 0, 0 };
+        vector<SubBlockEntry> sub_blocks;
+        for (int i = 0; i < OpenRepetitions; ++i)
+        {
+            sub_blocks.clear();
+            const auto start = chrono::steady_clock::now();
+            reader->EnumerateSubBlocksEx(
+                [&](int index, const DirectorySubBlockInfo& info)->bool
+                {
+                    sub_blocks.push_back(SubBlockEntry{ index, info });
+                    return true;
+                });
+            enumerate.latencies.push_back(CExecuteBenchmark::GetSecondsSince(start));
+        }
+
+        enumerate.wall_seconds = CExecuteBenchmark::GetSum(enumerate.latencies);
+        measurements.push_back(std::move(enumerate));
+
+        sort(
+            sub_blocks.begin(),
+            sub_blocks.end(),
+            [](const SubBlockEntry& a, const SubBlockEntry& b)->bool { return a.info.filePosition < b.info.filePosition; });
+        return sub_blocks;
+    }
+
+    static void MeasureMetadata(ICZIReader* reader, vector<Measurement>& measurements)
+    {
+        Measurement read_metadata{ "read-metadata-segment", 1, {}, 0, 0 };
+        Measurement parse_metadata{ "parse-metadata", 1, {}, 0, 0 };
+        for (int i = 0; i < OpenRepetitions; ++i)
+        {
+            auto start = chrono::steady_clock::now();
+            shared_ptr<IMetadataSegment> metadata_segment;
+            try
+            {
+                metadata_segment = reader->ReadMetadataSegment();
+            }
+            catch (LibCZISegmentNotPresent&)
+            {
+                // the document has no metadata-segment, so there is nothing to measure
+                return;
+            }
+
+            read_metadata.latencies.push_back(CExecuteBenchmark::GetSecondsSince(start));
+            const void* ptr;
+            size_t size;
+            metadata_segment->DangerousGetRawData(IMetadataSegment::MemBlkType::XmlMetadata, ptr, size);
+            read_metadata.bytes += size;
+
+            start = chrono::steady_clock::now();
+            const auto metadata = metadata_segment->CreateMetaFromMetadataSegment();
+            parse_metadata.latencies.push_back(CExecuteBenchmark::GetSecondsSince(start));
+            parse_metadata.bytes += size;
+        }
+
+        read_metadata.wall_seconds = CExecuteBenchmark::GetSum(read_metadata.latencies);
+        parse_metadata.wall_seconds = CExecuteBenchmark::GetSum(parse_metadata.latencies);
+        measurements.push_back(std::move(read_metadata));
+        measurements.push_back(std::move(parse_metadata));
+    }
+
+    static void MeasureReadSubBlocks(const shared_ptr<ICZIReader>& reader, const vector<SubBlockEntry>& sub_blocks, size_t samples, int number_of_threads, mt19937& random_generator, vector<Measurement>& measurements)
+    {
+        if (sub_blocks.empty())
+        {
+            return;
+        }
+
+        // sequential: the first subblocks in the order of their file-position
+        vector<int> indices;
+        for (size_t i = 0; i < (std::min)(samples, sub_blocks.size()); ++i)
+        {
+            indices.push_back(sub_blocks[i].index);
+        }
+
+        measurements.push_back(CExecuteBenchmark::MeasureReadSubBlocks("read-subblocks-sequential", reader, indices, number_of_threads));
+
+        // random: subblocks chosen at random (with replacement)
+        indices.clear();
+        uniform_int_distribution<size_t> distribution(0, sub_blocks.size() - 1);
+        for (size_t i = 0; i < samples; ++i)
+        {
+            indices.push_back(sub_blocks[distribution(random_generator)].index);
+        }
+
+        measurements.push_back(CExecuteBenchmark::MeasureReadSubBlocks("read-subblocks-random", reader, indices, number_of_threads));
+    }
+
+    static Measurement MeasureReadSubBlocks(const char* name, const shared_ptr<ICZIReader>& reader, const vector<int>& indices, int number_of_threads)
+    {
+        atomic<uint64_t> bytes{ 0 };
+        Measurement measurement = CExecuteBenchmark::RunOnWorkers(
+            name,
+            indices.size(),
+            number_of_threads,
+            [&](size_t i)
+            {
+                const auto sub_block = reader->ReadSubBlock(indices[i]);
+                const void* ptr;
+                size_t size;
+                sub_block->DangerousGetRawData(ISubBlock::MemBlkType::Data, ptr, size);
+                bytes.fetch_add(size, memory_order_relaxed);
+            });
+        measurement.bytes = bytes.load();
+        return measurement;
+    }
+
+    static void MeasureDecode(const shared_ptr<ICZIReader>& reader, const vector<SubBlockEntry>& sub_blocks, size_t samples, int number_of_threads, mt19937& random_generator, vector<Measurement>& measurements)
+    {
+        map<CompressionMode, vector<int>> indices_per_compression_mode;
+        for (const auto& sub_block : sub_blocks)
+        {
+            indices_per_compression_mode[sub_block.info.GetCompressionMode()].push_back(sub_block.index);
+        }
+
+        for (auto& item : indices_per_compression_mode)
+        {
+            // we read a random selection of subblocks (untimed), and then measure the decoding only
+            auto& indices = item.second;
+            shuffle(indices.begin(), indices.end(), random_generator);
+            indices.resize((std::min)(indices.size(), samples));
+            vector<shared_ptr<ISubBlock>> sub_blocks_to_decode;
+            for (const auto index : indices)
+            {
+                sub_blocks_to_decode.push_back(reader->ReadSubBlock(index));
+            }
+
+            atomic<uint64_t> bytes{ 0 };
+            string name = "decode-";
+            name += Utils::CompressionModeToInformalString(item.first);
+            Measurement measurement = CExecuteBenchmark::RunOnWorkers(
+                name,
+                sub_blocks_to_decode.size(),
+                number_of_threads,
+                [&](size_t i)
+                {
+                    const auto bitmap = sub_blocks_to_decode[i]->CreateBitmap();
+                    const auto size = bitmap->GetSize();
+                    bytes.fetch_add(static_cast<uint64_t>(size.w) * size.h * Utils::GetBytesPerPixel(bitmap->GetPixelType()), memory_order_relaxed);
+                });
+            measurement.bytes = bytes.load();
+            measurements.push_back(std::move(measurement));
+        }
+    }
+
+    static void MeasureViewports(const shared_ptr<ICZIReader>& reader, const CCmdLineOptions& options, size_t samples, int number_of_threads, mt19937& random_generator, vector<Measurement>& measurements)
+    {
+        static constexpr float zoom_levels[] = { 1.f, 0.5f, 0.25f, 0.125f };
+
+        const auto statistics = reader->GetStatistics();
+        const IntRect region = options.GetRectW() > 0 && options.GetRectH() > 0 ? CExecuteBase::GetRoiFromOptions(options, statistics) : statistics.boundingBoxLayer0Only;
+        if (region.w <= 0 || region.h <= 0)
+        {
+            return;
+        }
+
+        const auto accessor = reader->CreateSingleChannelScalingTileAccessor();
+        const auto& viewport_size = options.GetTileSizeForPlaneScan();
+
+        // For each zoom level, the runs without and with cache are done one after the other (with the same viewports),
+        //  so that the two are measured under the same conditions (e.g. w.r.t. the state of the operating system's file cache).
+        for (const float zoom : zoom_levels)
+        {
+            // the viewport is given in the output-bitmap's pixels, so its extent on layer-0 scales with 1/zoom
+            const int roi_width = (std::min)(static_cast<int>(get<0>(viewport_size) / zoom), region.w);
+            const int roi_height = (std::min)(static_cast<int>(get<1>(viewport_size) / zoom), region.h);
+            uniform_int_distribution<int> distribution_x(region.x, region.x + region.w - roi_width);
+            uniform_int_distribution<int> distribution_y(region.y, region.y + region.h - roi_height);
+            vector<IntRect> viewports;
+            for (size_t i = 0; i < samples; ++i)
+            {
+                viewports.push_back(IntRect{ distribution_x(random_generator), distribution_y(random_generator), roi_width, roi_height });
+            }
+
+            for (const bool use_cache : { false, true })
+            {
+                ISingleChannelScalingTileAccessor::Options accessor_options;
+                accessor_options.Clear();
+                accessor_options.backGroundColor = GetBackgroundColorFromOptions(options);
+                accessor_options.sceneFilter = options.GetSceneIndexSet();
+                accessor_options.useVisibilityCheckOptimization = options.GetUseVisibilityCheckOptimization();
+                shared_ptr<ISubBlockCache> cache;
+                ISubBlockCache::PruneOptions prune_options;
+                if (use_cache)
+                {
+                    cache = CreateSubBlockCache();
+                    accessor_options.subBlockCache = cache;
+                    prune_options.maxMemoryUsage = options.GetSubBlockCacheSize() > 0 ? options.GetSubBlockCacheSize() : DefaultCacheSize;
+                }
+
+                stringstream name;
+                name << "viewport-zoom" << zoom << (use_cache ? "-cache" : "-nocache");
+                atomic<uint64_t> bytes{ 0 };
+                mutex prune_mutex;
+                Measurement measurement = CExecuteBenchmark::RunOnWorkers(
+                    name.str(),
+                    viewports.size(),
+                    number_of_threads,
+                    [&](size_t i)
+                    {
+                        const auto bitmap = accessor->Get(viewports[i], &options.GetPlaneCoordinate(), zoom, &accessor_options);
+                        const auto size = bitmap->GetSize();
+                        bytes.fetch_add(static_cast<uint64_t>(size.w) * size.h * Utils::GetBytesPerPixel(bitmap->GetPixelType()), memory_order_relaxed);
+                        if (cache)
+                        {
+                            lock_guard<mutex> lck(prune_mutex);
+                            cache->Prune(prune_options);
+                        }
+                    });
+                measurement.bytes = bytes.load();
+                measurements.push_back(std::move(measurement));
+            }
+        }
+    }
+
+    /// Runs the specified operation for the indices 0 to count-1 on the specified number of threads, and measures
+    /// the duration of each operation. If an operation throws an exception, the first exception is re-thrown
+    /// (after all threads have finished).
+    ///
+    /// \param  name                The name of the measurement.
+    /// \param  count               The number of operations.
+    /// \param  number_of_threads   The number of threads.
+    /// \param  operation           The operation.
+    ///
+    /// \returns The measurement (where the field "bytes" is not set).
+    static Measurement RunOnWorkers(const string& name, size_t count, int number_of_threads, const function<void(size_t)>& operation)
+    {
+        Measurement measurement{ name, number_of_threads, vector<double>(count), 0, 0 };
+        atomic<size_t> next{ 0 };
+        mutex exception_mutex;
+        exception_ptr first_exception;
+        const auto worker = [&]()
+        {
+            for (;;)
+            {
+                const size_t i = next.fetch_add(1);
+                if (i >= count)
+                {
+                    return;
+                }
+
+                try
+                {
+                    const auto start = chrono::steady_clock::now();
+                    operation(i);
+                    measurement.latencies[i] = CExecuteBenchmark::GetSecondsSince(start);
+                }
+                catch (...)
+                {
+                    lock_guard<mutex> lck(exception_mutex);
+                    if (!first_exception)
+                    {
+                        first_exception = current_exception();
+                    }
+
+                    // make the remaining workers stop as soon as possible
+                    next.store(count);
+                }
+            }
+        };
+
+        const auto start = chrono::steady_clock::now();
+        vector<thread> threads;
+        const auto join_threads = [&threads]()
+        {
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        };
+
+        try
+        {
+            for (int i = 1; i < number_of_threads; ++i)
+            {
+                threads.emplace_back(worker);
+            }
+        }
+        catch (...)
+        {
+            // make the threads which have been started already stop, and join them before the exception propagates
+            next.store(count);
+            join_threads();
+            throw;
+        }
+
+        worker();
+        join_threads();
+
+        measurement.wall_seconds = CExecuteBenchmark::GetSecondsSince(start);
+        if (first_exception)
+        {
+            rethrow_exception(first_exception);
+        }
+
+        return measurement;
+    }
+
+    static void ReportAsText(const CCmdLineOptions& options, int number_of_threads, size_t samples, const vector<Measurement>& measurements)
+    {
+        stringstream ss;
+        ss << "Benchmark of \"" << convertToUtf8(options.GetCZIFilename()) << "\" (threads: " << number_of_threads << ", samples: " << samples << ")" << endl << endl;
+        ss << left << setw(44) << "measurement" << right
+            << setw(8) << "count" << setw(10) << "min ms" << setw(10) << "p50 ms" << setw(10) << "p90 ms" << setw(10) << "p99 ms" << setw(10) << "max ms"
+            << setw(12) << "MB/s" << setw(12) << "ops/s" << endl;
+        for (const auto& measurement : measurements)
+        {
+            const auto sorted_latencies = CExecuteBenchmark::GetSorted(measurement.latencies);
+            ss << left << setw(44) << measurement.name << right << setw(8) << sorted_latencies.size() << fixed << setprecision(3);
+            for (const double percentile : { 0., 50., 90., 99., 100. })
+            {
+                ss << setw(10) << CExecuteBenchmark::GetPercentile(sorted_latencies, percentile) * 1000;
+            }
+
+            ss << setprecision(1) << setw(12);
+            if (measurement.bytes > 0)
+            {
+                ss << CExecuteBenchmark::GetMegabytesPerSecond(measurement);
+            }
+            else
+            {
+                ss << "-";
+            }
+
+            ss << setw(12) << CExecuteBenchmark::GetOperationsPerSecond(measurement) << endl;
+        }
+
+        options.GetLog()->WriteLineStdOut(ss.str());
+    }
+
+    static void ReportAsJson(const CCmdLineOptions& options, int number_of_threads, size_t samples, const vector<Measurement>& measurements)
+    {
+        rapidjson::StringBuffer string_buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(string_buffer);
+        writer.StartObject();
+        writer.Key("file");
+        writer.String(convertToUtf8(options.GetCZIFilename()));
+        writer.Key("threads");
+        writer.Int(number_of_threads);
+        writer.Key("samples");
+        writer.Uint64(samples);
+        writer.Key("measurements");
+        writer.StartArray();
+        for (const auto& measurement : measurements)
+        {
+            const auto sorted_latencies = CExecuteBenchmark::GetSorted(measurement.latencies);
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(measurement.name);
+            writer.Key("threads");
+            writer.Int(measurement.threads);
+            writer.Key("count");
+            writer.Uint64(sorted_latencies.size());
+            writer.Key("wall_seconds");
+            writer.Double(measurement.wall_seconds);
+            writer.Key("bytes");
+            writer.Uint64(measurement.bytes);
+            writer.Key("mb_per_second");
+            writer.Double(CExecuteBenchmark::GetMegabytesPerSecond(measurement));
+            writer.Key("operations_per_second");
+            writer.Double(CExecuteBenchmark::GetOperationsPerSecond(measurement));
+            writer.Key("latency_ms");
+            writer.StartObject();
+            writer.Key("min");
+            writer.Double(CExecuteBenchmark::GetPercentile(sorted_latencies, 0) * 1000);
+            writer.Key("mean");
+            writer.Double(sorted_latencies.empty() ? 0 : CExecuteBenchmark::GetSum(sorted_latencies) / sorted_latencies.size() * 1000);
+            writer.Key("p50");
+            writer.Double(CExecuteBenchmark::GetPercentile(sorted_latencies, 50) * 1000);
+            writer.Key("p90");
+            writer.Double(CExecuteBenchmark::GetPercentile(sorted_latencies, 90) * 1000);
+            writer.Key("p99");
+            writer.Double(CExecuteBenchmark::GetPercentile(sorted_latencies, 99) * 1000);
+            writer.Key("max");
+            writer.Double(CExecuteBenchmark::GetPercentile(sorted_latencies, 100) * 1000);
+            writer.EndObject();
+            writer.EndObject();
+        }
+
+        writer.EndArray();
+        writer.EndObject();
+        options.GetLog()->WriteLineStdOut(string_buffer.GetString());
+    }
+
+    static double GetSecondsSince(chrono::steady_clock::time_point start)
+    {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    static double GetSum(const vector<double>& values)
+    {
+        double sum = 0;
+        for (const double value : values)
+        {
+            sum += value;
+        }
+
+        return sum;
+    }
+
+    static vector<double> GetSorted(vector<double> values)
+    {
+        sort(values.begin(), values.end());
+        return values;
+    }
+
+    /// Gets the specified percentile (using the "nearest-rank" method).
+    ///
+    /// \param  sorted_values   The values (sorted in ascending order).
+    /// \param  percentile      The percentile (between 0 and 100).
+    ///
+    /// \returns The percentile (or 0 if there are no values).
+    static double GetPercentile(const vector<double>& sorted_values, double percentile)
+    {
+        if (sorted_values.empty())
+        {
+            return 0;
+        }
+
+        const size_t rank = static_cast<size_t>(ceil(percentile / 100 * sorted_values.size()));
+        return sorted_values[rank > 0 ? rank - 1 : 0];
+    }
+
+    static double GetMegabytesPerSecond(const Measurement& measurement)
+    {
+        return measurement.wall_seconds > 0 ? static_cast<double>(measurement.bytes) / (1024 * 1024) / measurement.wall_seconds : 0;
+    }
+
+    static double GetOperationsPerSecond(const Measurement& measurement)
+    {
+        return measurement.wall_seconds > 0 ? measurement.latencies.size() / measurement.wall_seconds : 0;
+    }
+};
+
+bool executeBenchmark(const CCmdLineOptions& options)
+{
+    return CExecuteBenchmark::execute(options);
+}
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "executeCompactCzi.h"
+#include "executeBase.h"
+#include <sstream>
+
+using namespace std;
+using namespace libCZI;
+
+/// This operation creates a compacted version of a CZI-file (e.g. one which has been edited in place, and which therefore
+/// contains unused space and "DELETED" segments). The output file may be the same as the source file. The operation is
+/// crash-safe (c.f. "libCZI::CompactCziFile"), i.e. the compacted document is written into a temporary file first, which
+/// is flushed to disk and replaces the output file only when the operation completed successfully.
+class CExecuteCompactCzi : public CExecuteBase
+{
+public:
+    static bool execute(const CCmdLineOptions& options)
+    {
+        const auto output_filename = options.MakeOutputFilename(L"", L"czi");
+
+        CompactCziOptions compact_options;
+        compact_options.subblock_layout = options.GetSubBlockLayoutForRewrite();
+        compact_options.keep_file_guid = !options.GetIsFileGuidValid();
+        if (options.GetIsFileGuidValid())
+        {
+            compact_options.file_guid = options.GetFileGuid();
+        }
+
+        // note that the source stream is not referenced here, so it is released (and the file is closed) before the
+        //  output file is replaced
+        const auto statistics = libCZI::CompactCziFile(
+            CExecuteBase::CreateSourceStream(options),
+            output_filename.c_str(),
+            &compact_options);
+
+        stringstream ss;
+        ss << "Compacted " << statistics.subblock_count << " subblock(s) and " << statistics.attachment_count << " attachment(s).";
+        options.GetLog()->WriteLineStdOut(ss.str());
+        return true;
+    }
+};
+
+bool executeCompactCzi(const CCmdLineOptions& options)
+{
+    return CExecuteCompactCzi::execute(options);
+}
@@ -0,0 +1,8 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+#include "cmdlineoptions.h"
+
+bool executeCompactCzi(const CCmdLineOptions& options);
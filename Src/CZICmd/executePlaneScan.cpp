@@ -5,10 +5,109 @@
 #include "executePlaneScan.h"
 #include "executeBase.h"
 #include "SaveBitmap.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using namespace std;
 using namespace libCZI;
 
+/// A bounded (blocking) queue used to pass the rendered tiles from the render workers to the writers. If the queue
+/// is full, "Push" blocks - so the number of rendered tiles waiting to be written (and thus the memory usage) is bounded.
+template <typename t_item>
+class CBoundedQueue
+{
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_variable_;
+    std::deque<t_item> items_;
+    size_t capacity_;
+    bool closed_;
+    bool aborted_;
+public:
+    explicit CBoundedQueue(size_t capacity) : capacity_((std::max)(capacity, static_cast<size_t>(1))), closed_(false), aborted_(false)
+    {
+    }
+
+    CBoundedQueue(const CBoundedQueue&) = delete;
+    CBoundedQueue& operator=(const CBoundedQueue&) = delete;
+
+    /// Adds an item to the queue, waiting for free space if the queue is full.
+    ///
+    /// \param  item    The item.
+    ///
+    /// \returns True if successful; false if the queue was aborted.
+    bool Push(t_item item)
+    {
+        unique_lock<mutex> lck(this->mutex_);
+        this->condition_variable_.wait(lck, [this]() { return this->aborted_ || this->items_.size() < this->capacity_; });
+        if (this->aborted_)
+        {
+            return false;
+        }
+
+        this->items_.push_back(std::move(item));
+        lck.unlock();
+        this->condition_variable_.notify_all();
+        return true;
+    }
+
+    /// Removes an item from the queue, waiting for an item to become available if the queue is empty.
+    ///
+    /// \param [out] item   The item.
+    ///
+    /// \returns True if successful; false if the queue was closed (and is empty) or was aborted.
+    bool Pop(t_item* item)
+    {
+        unique_lock<mutex> lck(this->mutex_);
+        this->condition_variable_.wait(lck, [this]() { return this->aborted_ || this->closed_ || !this->items_.empty(); });
+        if (this->aborted_ || this->items_.empty())
+        {
+            return false;
+        }
+
+        *item = std::move(this->items_.front());
+        this->items_.pop_front();
+        lck.unlock();
+        this->condition_variable_.notify_all();
+        return true;
+    }
+
+    /// Signals that no more items will be added. The items already in the queue can still be retrieved.
+    void Close()
+    {
+        {
+            lock_guard<mutex> lck(this->mutex_);
+            this->closed_ = true;
+        }
+
+        this->condition_variable_.notify_all();
+    }
+
+    /// Aborts the operation - all items in the queue are discarded, and all waiting calls return immediately.
+    void Abort()
+    {
+        {
+            lock_guard<mutex> lck(this->mutex_);
+            this->aborted_ = true;
+            this->items_.clear();
+        }
+
+        this->condition_variable_.notify_all();
+    }
+};
+
+/// This operation scans a plane with a rectangle of a given size, and writes the content of each rectangle to a PNG-file.
+/// The operation is organized as a pipeline: a number of render workers (given with the "--threads" option) get the tiles
+/// from the scaling-tile-accessor, and the rendered tiles are passed to the same number of writers which encode and write
+/// the PNG-files. The tiles are rendered in the order of a Hilbert curve over the tile grid, so that tiles rendered at about
+/// the same time are close to each other. This only pays off if a subblock-cache is used (given with the "--cachesize" option),
+/// which is then shared by all render workers, so that they can re-use the decoded subblocks.
 class CExecutePlaneScan : public CExecuteBase
 {
 protected:
@@ -17,6 +116,15 @@ protected:
         shared_ptr<ISubBlockCache> cache;
         ISubBlockCache::PruneOptions prune_options;
     };
+
+    struct RenderedTile
+    {
+        wstring filename;
+        shared_ptr<IBitmapData> bitmap;
+    };
+
+    /// The number of rendered tiles (per writer) which may be queued for writing.
+    static constexpr size_t TilesQueuedPerWriter = 2;
 public:
     static bool execute(const CCmdLineOptions& options)
     {
@@ -35,33 +143,117 @@ public:
         }
         const auto tile_size_for_plane_scan = options.GetTileSizeForPlaneScan();
         const IntSize tileSize = { get<0>(tile_size_for_plane_scan), get<1>(tile_size_for_plane_scan) };
-        const auto saver = CSaveBitmapFactory::CreateSaveBitmapObj(nullptr);
+        const vector<IntRect> tiles = CExecutePlaneScan::GetTilesInHilbertOrder(roi, tileSize);
 
-        for (int y = 0; y < (roi.h + static_cast<int>(tileSize.h) - 1) / static_cast<int>(tileSize.h); ++y)
+        const int number_of_threads = options.GetNumberOfThreads() > 0 ? options.GetNumberOfThreads() : (std::max)(1, static_cast<int>(thread::hardware_concurrency()));
+        CBoundedQueue<RenderedTile> queue(number_of_threads * TilesQueuedPerWriter);
+        atomic<size_t> next_tile{ 0 };
+        mutex exception_mutex;
+        exception_ptr first_exception;
+        const auto handle_exception = [&]()
         {
-            for (int x = 0; x < (roi.w + static_cast<int>(tileSize.w) - 1) / static_cast<int>(tileSize.w); ++x)
             {
-                IntRect tileRect =
+                lock_guard<mutex> lck(exception_mutex);
+                if (!first_exception)
                 {
-                    roi.x + x * static_cast<int>(tileSize.w),
-                    roi.y + y * static_cast<int>(tileSize.h),
-                    min(static_cast<int>(tileSize.w), roi.w - x * static_cast<int>(tileSize.w)),
-                    min(static_cast<int>(tileSize.h), roi.h - y * static_cast<int>(tileSize.h))
-                };
+                    first_exception = current_exception();
+                }
+            }
+
+            // stop the render workers and the writers as soon as possible
+            next_tile.store(tiles.size());
+            queue.Abort();
+        };
 
-                CExecutePlaneScan::WriteRoi(accessor, coordinate, tileRect, cache_context, saver, options);
+        vector<thread> writers;
+        vector<thread> render_workers;
+        const auto join_threads = [&]()
+        {
+            for (auto& render_worker : render_workers)
+            {
+                render_worker.join();
             }
+
+            queue.Close();
+            for (auto& writer : writers)
+            {
+                writer.join();
+            }
+        };
+
+        try
+        {
+            for (int i = 0; i < number_of_threads; ++i)
+            {
+                writers.emplace_back(
+                    [&]()
+                    {
+                        try
+                        {
+                            const auto saver = CSaveBitmapFactory::CreateSaveBitmapObj(nullptr);
+                            RenderedTile rendered_tile;
+                            while (queue.Pop(&rendered_tile))
+                            {
+                                saver->Save(rendered_tile.filename.c_str(), SaveDataFormat::PNG, rendered_tile.bitmap.get());
+                                rendered_tile = RenderedTile();
+                            }
+                        }
+                        catch (...)
+                        {
+                            handle_exception();
+                        }
+                    });
+            }
+
+            for (int i = 0; i < number_of_threads; ++i)
+            {
+                render_workers.emplace_back(
+                    [&]()
+                    {
+                        try
+                        {
+                            for (size_t tile_index = next_tile.fetch_add(1); tile_index < tiles.size(); tile_index = next_tile.fetch_add(1))
+                            {
+                                RenderedTile rendered_tile;
+                                rendered_tile.bitmap = CExecutePlaneScan::RenderRoi(accessor, coordinate, tiles[tile_index], cache_context, options);
+                                rendered_tile.filename = CExecutePlaneScan::GetFileName(options, tiles[tile_index]);
+                                if (!queue.Push(std::move(rendered_tile)))
+                                {
+                                    break;
+                                }
+                            }
+                        }
+                        catch (...)
+                        {
+                            handle_exception();
+                        }
+                    });
+            }
+        }
+        catch (...)
+        {
+            // starting a thread failed - stop and join the threads which have been started already
+            next_tile.store(tiles.size());
+            queue.Abort();
+            join_threads();
+            throw;
+        }
+
+        join_threads();
+
+        if (first_exception)
+        {
+            rethrow_exception(first_exception);
         }
 
         return true;
     }
 protected:
-    static void WriteRoi(
+    static shared_ptr<IBitmapData> RenderRoi(
         const shared_ptr<ISingleChannelScalingTileAccessor>& accessor,
         const CDimCoordinate& plane_coordinate,
         const IntRect& roi,
         const CacheContext& cache_context,
-        const shared_ptr<ISaveBitmap>& saver,
         const CCmdLineOptions& options)
     {
         libCZI::ISingleChannelScalingTileAccessor::Options scstaOptions;
@@ -71,15 +263,90 @@ protected:
         scstaOptions.subBlockCache = cache_context.cache;
         scstaOptions.useVisibilityCheckOptimization = options.GetUseVisibilityCheckOptimization();
 
-        const auto bitmap = accessor->Get(roi, &plane_coordinate, options.GetZoom(), &scstaOptions);
+        auto bitmap = accessor->Get(roi, &plane_coordinate, options.GetZoom(), &scstaOptions);
 
         if (cache_context.cache)
         {
             cache_context.cache->Prune(cache_context.prune_options);
         }
 
-        const auto filename = GetFileName(options, roi);
-        saver->Save(filename.c_str(), SaveDataFormat::PNG, bitmap.get());
+        return bitmap;
+    }
+
+    /// Divides the specified ROI into tiles of the specified size and returns them ordered along a Hilbert curve
+    /// over the tile grid.
+    ///
+    /// \param  roi         The region-of-interest.
+    /// \param  tile_size   The size of the tiles.
+    ///
+    /// \returns The tiles in the order of a Hilbert curve.
+    static vector<IntRect> GetTilesInHilbertOrder(const IntRect& roi, const IntSize& tile_size)
+    {
+        struct TileWithCurveIndex
+        {
+            uint64_t curve_index;
+            IntRect rect;
+        };
+
+        vector<TileWithCurveIndex> tiles;
+        for (int y = 0; y < (roi.h + static_cast<int>(tile_size.h) - 1) / static_cast<int>(tile_size.h); ++y)
+        {
+            for (int x = 0; x < (roi.w + static_cast<int>(tile_size.w) - 1) / static_cast<int>(tile_size.w); ++x)
+            {
+                IntRect tileRect =
+                {
+                    roi.x + x * static_cast<int>(tile_size.w),
+                    roi.y + y * static_cast<int>(tile_size.h),
+                    min(static_cast<int>(tile_size.w), roi.w - x * static_cast<int>(tile_size.w)),
+                    min(static_cast<int>(tile_size.h), roi.h - y * static_cast<int>(tile_size.h))
+                };
+
+                tiles.push_back(TileWithCurveIndex{ CExecutePlaneScan::CalcHilbertIndex(x, y), tileRect });
+            }
+        }
+
+        // the curve-index is unique for each tile, so the order is well-defined
+        sort(tiles.begin(), tiles.end(), [](const TileWithCurveIndex& a, const TileWithCurveIndex& b)->bool { return a.curve_index < b.curve_index; });
+        vector<IntRect> result;
+        result.reserve(tiles.size());
+        for (const auto& tile : tiles)
+        {
+            result.push_back(tile.rect);
+        }
+
+        return result;
+    }
+
+    /// Calculates the index of the specified point on a Hilbert curve (covering the range of 2^32 x 2^32).
+    ///
+    /// \param  x   The x coordinate.
+    /// \param  y   The y coordinate.
+    ///
+    /// \returns The index of the point on the Hilbert curve.
+    static uint64_t CalcHilbertIndex(uint32_t x, uint32_t y)
+    {
+        // c.f. https://en.wikipedia.org/wiki/Hilbert_curve
+        uint64_t index = 0;
+        for (uint64_t s = static_cast<uint64_t>(1) << 31; s > 0; s /= 2)
+        {
+            const uint32_t rx = (x & s) != 0 ? 1 : 0;
+            const uint32_t ry = (y & s) != 0 ? 1 : 0;
+            index += s * s * ((3 * rx) ^ ry);
+
+            // rotate the quadrant (with n=2^32, "n-1-x" is the bitwise complement)
+            if (ry == 0)
+            {
+                if (rx == 1)
+                {
+                    x = ~x;
+                    y = ~y;
+                }
+
+                swap(x, y);
+            }
+        }
+
+        return index;
     }
 
     static wstring GetFileName(const CCmdLineOptions& options, const IntRect& roi)
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "executeRewriteCzi.h"
+#include "executeBase.h"
+#include <sstream>
+
+using namespace std;
+using namespace libCZI;
+
+/// This operation copies the content of a CZI-file (subblocks, attachments and the metadata-segment) into a new
+/// CZI-file. The data is copied "as is" (i.e. without re-encoding), and the subblocks are laid out in the order
+/// given by the option "--subblock-layout". The copying is done with "libCZI::CompactCzi".
+class CExecuteRewriteCzi : public CExecuteBase
+{
+public:
+    static bool execute(const CCmdLineOptions& options)
+    {
+        const auto output_filename = options.MakeOutputFilename(L"", L"czi");
+
+        CompactCziOptions compact_options;
+        compact_options.subblock_layout = options.GetSubBlockLayoutForRewrite();
+
+        // the rewritten document gets the file-GUID given on the command line, or a new one
+        compact_options.keep_file_guid = false;
+        if (options.GetIsFileGuidValid())
+        {
+            compact_options.file_guid = options.GetFileGuid();
+        }
+
+        // with a spatial layout, the subblocks are actually written when the writer is closed (i.e. before returning from "CompactCzi")
+        const auto statistics = libCZI::CompactCzi(
+            CExecuteBase::CreateSourceStream(options),
+            libCZI::CreateOutputStreamForFile(output_filename.c_str(), true),
+            &compact_options);
+
+        stringstream ss;
+        ss << "Rewrote " << statistics.subblock_count << " subblock(s) and " << statistics.attachment_count << " attachment(s).";
+        options.GetLog()->WriteLineStdOut(ss.str());
+        return true;
+    }
+};
+
+bool executeRewriteCzi(const CCmdLineOptions& options)
+{
+    return CExecuteRewriteCzi::execute(options);
+}
@@ -0,0 +1,277 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "executeTranscodeCzi.h"
+#include "executeBase.h"
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace libCZI;
+
+/// This class reads and decodes the subblocks of a CZI-document on a number of worker threads. The decoded subblocks
+/// are handed out in the order given at construction, and only a limited number of subblocks are decoded ahead of the
+/// one handed out last, which bounds the memory consumption.
+class CParallelSubBlockDecoder
+{
+public:
+    struct DecodedSubBlock
+    {
+        std::shared_ptr<libCZI::ISubBlock> sub_block;
+        std::shared_ptr<libCZI::IBitmapData> bitmap;
+        std::exception_ptr exception;   ///< If decoding failed, this gives the exception which occurred.
+    };
+private:
+    std::shared_ptr<libCZI::ICZIReader> reader_;
+    std::vector<int> indices_;          ///< The indices of the subblocks to be decoded (in the order they are handed out).
+    size_t max_decoded_ahead_;          ///< The maximum number of subblocks which are decoded but not yet handed out.
+
+    std::mutex mutex_;
+    std::condition_variable condition_variable_;
+    size_t next_to_decode_;             ///< The position (in "indices_") of the next subblock to be decoded.
+    size_t next_to_hand_out_;           ///< The position (in "indices_") of the next subblock to be handed out.
+    std::map<size_t, DecodedSubBlock> decoded_;
+    bool shutdown_;
+    std::vector<std::thread> threads_;
+public:
+    CParallelSubBlockDecoder(std::shared_ptr<libCZI::ICZIReader> reader, std::vector<int> indices, int number_of_threads, size_t max_decoded_ahead)
+        : reader_(std::move(reader)), indices_(std::move(indices)), max_decoded_ahead_((std::max)(max_decoded_ahead, static_cast<size_t>(1))),
+        next_to_decode_(0), next_to_hand_out_(0), shutdown_(false)
+    {
+        try
+        {
+            for (int i = 0; i < number_of_threads; ++i)
+            {
+                this->threads_.emplace_back([this]() { this->WorkerThread(); });
+            }
+        }
+        catch (...)
+        {
+            // the destructor is not run if the constructor throws, so we have to stop the threads already started here
+            this->ShutdownAndJoinThreads();
+            throw;
+        }
+    }
+
+    ~CParallelSubBlockDecoder()
+    {
+        this->ShutdownAndJoinThreads();
+    }
+
+    CParallelSubBlockDecoder(const CParallelSubBlockDecoder&) = delete;
+    CParallelSubBlockDecoder& operator=(const CParallelSubBlockDecoder&) = delete;
+
+    /// Gets the next decoded subblock (in the order given at construction), waiting for it to be decoded if necessary.
+    /// If decoding the subblock failed, the exception is re-thrown here.
+    ///
+    /// \param [out] decoded_sub_block The decoded subblock.
+    ///
+    /// \returns True if successful; false if all subblocks have been handed out.
+    bool TryGetNext(DecodedSubBlock* decoded_sub_block)
+    {
+        unique_lock<mutex> lck(this->mutex_);
+        if (this->next_to_hand_out_ >= this->indices_.size())
+        {
+            return false;
+        }
+
+        this->condition_variable_.wait(lck, [this]() { return this->decoded_.find(this->next_to_hand_out_) != this->decoded_.end(); });
+        const auto it = this->decoded_.find(this->next_to_hand_out_);
+        *decoded_sub_block = std::move(it->second);
+        this->decoded_.erase(it);
+        ++this->next_to_hand_out_;
+        lck.unlock();
+
+        // a worker may now proceed with the next subblock
+        this->condition_variable_.notify_all();
+        if (decoded_sub_block->exception)
+        {
+            rethrow_exception(decoded_sub_block->exception);
+        }
+
+        return true;
+    }
+
+private:
+    void ShutdownAndJoinThreads()
+    {
+        {
+            lock_guard<mutex> lck(this->mutex_);
+            this->shutdown_ = true;
+        }
+
+        this->condition_variable_.notify_all();
+        for (auto& thread : this->threads_)
+        {
+            thread.join();
+        }
+    }
+
+    void WorkerThread()
+    {
+        for (;;)
+        {
+            size_t position;
+            {
+                unique_lock<mutex> lck(this->mutex_);
+                this->condition_variable_.wait(
+                    lck,
+                    [this]()
+                    {
+                        return this->shutdown_ ||
+                            this->next_to_decode_ >= this->indices_.size() ||
+                            this->next_to_decode_ < this->next_to_hand_out_ + this->max_decoded_ahead_;
+                    });
+                if (this->shutdown_ || this->next_to_decode_ >= this->indices_.size())
+                {
+                    return;
+                }
+
+                position = this->next_to_decode_++;
+            }
+
+            DecodedSubBlock decoded_sub_block;
+            try
+            {
+                decoded_sub_block.sub_block = this->reader_->ReadSubBlock(this->indices_[position]);
+                decoded_sub_block.bitmap = decoded_sub_block.sub_block->CreateBitmap();
+            }
+            catch (...)
+            {
+                decoded_sub_block.exception = current_exception();
+            }
+
+            {
+                lock_guard<mutex> lck(this->mutex_);
+                this->decoded_[position] = std::move(decoded_sub_block);
+            }
+
+            this->condition_variable_.notify_all();
+        }
+    }
+};
+
+/// This operation transcodes a CZI-file, i.e. all subblocks are decoded and re-encoded with the compression given with
+/// the option "--compressionopts" (which defaults to "zstd1"). Attachments and the metadata-segment are copied as is.
+/// The decoding is done on a number of worker threads, and the compression is done by the writer (with the same number
+/// of threads). Subblocks are written in the order of the source document.
+class CExecuteTranscodeCzi : public CExecuteBase
+{
+private:
+    /// The number of subblocks (per thread) which are decoded ahead of the subblock which is currently passed to the writer.
+    static constexpr size_t SubBlocksDecodedAheadPerThread = 2;
+public:
+    static bool execute(const CCmdLineOptions& options)
+    {
+        const auto start_time = chrono::steady_clock::now();
+        const auto reader = CExecuteBase::CreateAndOpenCziReader(options);
+
+        const auto output_filename = options.MakeOutputFilename(L"", L"czi");
+        const auto output_stream = libCZI::CreateOutputStreamForFile(output_filename.c_str(), true);
+
+        const int number_of_threads = options.GetNumberOfThreads() > 0 ? options.GetNumberOfThreads() : (std::max)(1, static_cast<int>(thread::hardware_concurrency()));
+
+        CZIWriterOptions writer_options;
+        writer_options.allow_duplicate_subblocks = true;
+        writer_options.number_of_compression_threads = number_of_threads;
+        const auto writer = libCZI::CreateCZIWriter(&writer_options);
+        const auto writer_info = make_shared<CCziWriterInfo>(options.GetIsFileGuidValid() ? options.GetFileGuid() : libCZI::GUID{ 0,0,0,{ 0,0,0,0,0,0,0,0 } });
+        writer->Create(output_stream, writer_info);
+
+        const auto sub_blocks_statistics = CExecuteTranscodeCzi::TranscodeSubBlocks(reader, writer.get(), options, number_of_threads);
+        const int attachment_count = libCZI::CopyAttachments(reader.get(), writer.get());
+        libCZI::CopyMetadataSegment(reader.get(), writer.get());
+        writer->Close();
+
+        const double elapsed_seconds = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+        const double source_megabytes = static_cast<double>(sub_blocks_statistics.source_data_size) / (1024 * 1024);
+        const double decoded_megabytes = static_cast<double>(sub_blocks_statistics.decoded_data_size) / (1024 * 1024);
+        stringstream ss;
+        ss << "Transcoded " << sub_blocks_statistics.count << " subblock(s) and copied " << attachment_count << " attachment(s) in "
+            << fixed << setprecision(2) << elapsed_seconds << "s using " << number_of_threads << " thread(s)." << endl;
+        ss << " source subblock-data: " << source_megabytes << " MB (" << (elapsed_seconds > 0 ? source_megabytes / elapsed_seconds : 0) << " MB/s)" << endl;
+        ss << " decoded bitmaps     : " << decoded_megabytes << " MB (" << (elapsed_seconds > 0 ? decoded_megabytes / elapsed_seconds : 0) << " MB/s)";
+        options.GetLog()->WriteLineStdOut(ss.str());
+        return true;
+    }
+private:
+    struct TranscodeStatistics
+    {
+        int count;
+        std::uint64_t source_data_size;     ///< The size of the (compressed) data of the subblocks in the source document.
+        std::uint64_t decoded_data_size;    ///< The size of the decoded bitmaps.
+    };
+
+    static TranscodeStatistics TranscodeSubBlocks(const shared_ptr<ICZIReader>& reader, ICziWriter* writer, const CCmdLineOptions& options, int number_of_threads)
+    {
+        const CompressionMode compression_mode = options.GetCompressionMode() != CompressionMode::Invalid ? options.GetCompressionMode() : CompressionMode::Zstd1;
+        const auto compression_parameters = options.GetCompressionParameters();
+
+        vector<int> indices;
+        reader->EnumerateSubBlocks(
+            [&](int index, const SubBlockInfo&)->bool
+            {
+                indices.push_back(index);
+                return true;
+            });
+
+        TranscodeStatistics statistics{ 0, 0, 0 };
+        CParallelSubBlockDecoder decoder(reader, std::move(indices), number_of_threads, number_of_threads * SubBlocksDecodedAheadPerThread);
+        CParallelSubBlockDecoder::DecodedSubBlock decoded_sub_block;
+        while (decoder.TryGetNext(&decoded_sub_block))
+        {
+            const auto& info = decoded_sub_block.sub_block->GetSubBlockInfo();
+
+            AddSubBlockInfoUncompressedBitmap add_info;
+            add_info.Clear();
+            add_info.coordinate = info.coordinate;
+            add_info.mIndexValid = info.IsMindexValid();
+            add_info.mIndex = info.mIndex;
+            add_info.x = info.logicalRect.x;
+            add_info.y = info.logicalRect.y;
+            add_info.logicalWidth = info.logicalRect.w;
+            add_info.logicalHeight = info.logicalRect.h;
+            add_info.pyramid_type = info.pyramidType;
+            add_info.SetCompressionMode(compression_mode);
+            add_info.compressionParameters = compression_parameters;
+            add_info.bitmap = decoded_sub_block.bitmap;
+
+            // the subblock-metadata and the subblock-attachment are copied by the writer, so we need not keep them alive
+            size_t size;
+            const void* ptr;
+            decoded_sub_block.sub_block->DangerousGetRawData(ISubBlock::MemBlkType::Metadata, ptr, size);
+            add_info.ptrSbBlkMetadata = ptr;
+            add_info.sbBlkMetadataSize = static_cast<uint32_t>(size);
+            decoded_sub_block.sub_block->DangerousGetRawData(ISubBlock::MemBlkType::Attachment, ptr, size);
+            add_info.ptrSbBlkAttachment = ptr;
+            add_info.sbBlkAttachmentSize = static_cast<uint32_t>(size);
+
+            writer->AsyncAddSubBlock(add_info);
+
+            decoded_sub_block.sub_block->DangerousGetRawData(ISubBlock::MemBlkType::Data, ptr, size);
+            statistics.source_data_size += size;
+            const auto bitmap_size = decoded_sub_block.bitmap->GetSize();
+            statistics.decoded_data_size += static_cast<uint64_t>(bitmap_size.w) * bitmap_size.h * Utils::GetBytesPerPixel(decoded_sub_block.bitmap->GetPixelType());
+            ++statistics.count;
+
+            // release our references, so that the memory is freed once the subblock has been written
+            decoded_sub_block = CParallelSubBlockDecoder::DecodedSubBlock();
+        }
+
+        writer->Flush();
+        return statistics;
+    }
+};
+
+bool executeTranscodeCzi(const CCmdLineOptions& options)
+{
+    return CExecuteTranscodeCzi::execute(options);
+}
@@ -172,7 +172,38 @@ using namespace std;
     throw std::logic_error("It seems that this conversion is not implemented...");
 }
 
+/*static*/void CBitmapOperations::CopyWithLookUpTable(libCZI::PixelType srcPixelType, const void* srcPtr, int srcStride, libCZI::PixelType dstPixelType, void* dstPtr, int dstStride, int width, int height, const std::uint8_t* lookUpTable, bool drawTileBorder)
+{
+    if (lookUpTable == nullptr)
+    {
+        Copy(srcPixelType, srcPtr, srcStride, dstPixelType, dstPtr, dstStride, width, height, drawTileBorder);
+        return;
+    }
+
+    if (dstPixelType == PixelType::Gray8)
+    {
+        switch (srcPixelType)
+        {
+        case PixelType::Gray8:
+            Copy<PixelType::Gray8, PixelType::Gray8, CConvGray8ToGray8WithLookUpTable>(CConvGray8ToGray8WithLookUpTable(lookUpTable), srcPtr, srcStride, dstPtr, dstStride, width, height, drawTileBorder);
+            return;
+        case PixelType::Gray16:
+            Copy<PixelType::Gray16, PixelType::Gray8, CConvGray16ToGray8WithLookUpTable>(CConvGray16ToGray8WithLookUpTable(lookUpTable), srcPtr, srcStride, dstPtr, dstStride, width, height, drawTileBorder);
+            return;
+        default:
+            break;
+        }
+    }
+
+    ThrowUnsupportedConversion(srcPixelType, dstPixelType);
+}
+
 /*static*/void CBitmapOperations::CopyWithOffset(const CopyWithOffsetInfo& info)
+{
+    CopyWithOffset(info, nullptr);
+}
+
+/*static*/void CBitmapOperations::CopyWithOffset(const CopyWithOffsetInfo& info, const std::uint8_t* lookUpTable)
 {
     const IntRect srcRect = IntRect{ info.xOffset,info.yOffset,info.srcWidth,info.srcHeight };
     const IntRect dstRect = IntRect{ 0,0,info.dstWidth,info.dstHeight };
@@ -186,14 +217,20 @@ using namespace std;
     void* ptrDestination = static_cast<char*>(info.dstPtr) + intersection.y * static_cast<size_t>(info.dstStride) + intersection.x * static_cast<size_t>(CziUtils::GetBytesPerPel(info.dstPixelType));
     const void* ptrSource = static_cast<const char*>(info.srcPtr) + (std::max)(-info.yOffset, 0) * static_cast<size_t>(info.srcStride) + (std::max)(-info.xOffset, 0) * static_cast<size_t>(CziUtils::GetBytesPerPel(info.srcPixelType));
 
-    Copy(
+    CopyWithLookUpTable(
         info.srcPixelType, ptrSource, info.srcStride,
         info.dstPixelType, ptrDestination, info.dstStride,
         intersection.w, intersection.h,
+        lookUpTable,
         info.drawTileBorder);
 }
 
 /*static*/void CBitmapOperations::NNResize(libCZI::IBitmapData* bmSrc, libCZI::IBitmapData* bmDest, const DblRect& roiSrc, const DblRect& roiDst)
+{
+    NNResize(bmSrc, bmDest, roiSrc, roiDst, nullptr);
+}
+
+/*static*/void CBitmapOperations::NNResize(libCZI::IBitmapData* bmSrc, libCZI::IBitmapData* bmDest, const DblRect& roiSrc, const DblRect& roiDst, const std::uint8_t* lookUpTable)
 {
     ScopedBitmapLockerP lckSrc{ bmSrc };
     ScopedBitmapLockerP lckDst{ bmDest };
@@ -215,7 +252,7 @@ using namespace std;
     resizeInfo.dstRoiH = roiDst.h;
     resizeInfo.dstWidth = bmDest->GetWidth();
     resizeInfo.dstHeight = bmDest->GetHeight();
-    NNScale2(bmSrc->GetPixelType(), bmDest->GetPixelType(), resizeInfo);
+    NNScale2WithLookUpTable(bmSrc->GetPixelType(), bmDest->GetPixelType(), resizeInfo, lookUpTable);
 }
 
 /*static*/void CBitmapOperations::NNResize(libCZI::IBitmapData* bmSrc, libCZI::IBitmapData* bmDst)
@@ -251,28 +288,42 @@ using namespace std;
 
 /*static*/void CBitmapOperations::Fill(libCZI::IBitmapData* bm, const libCZI::RgbFloatColor& floatColor)
 {
+    CBitmapOperations::Fill(bm, IntRect{ 0, 0, static_cast<int>(bm->GetWidth()), static_cast<int>(bm->GetHeight()) }, floatColor);
+}
+
+/*static*/void CBitmapOperations::Fill(libCZI::IBitmapData* bm, const libCZI::IntRect& rect, const libCZI::RgbFloatColor& floatColor)
+{
+    const IntRect rect_clipped = rect.Intersect(IntRect{ 0, 0, static_cast<int>(bm->GetWidth()), static_cast<int>(bm->GetHeight()) });
+    if (!rect_clipped.IsValid() || !rect_clipped.IsNonEmpty())
+    {
+        return;
+    }
+
     ScopedBitmapLockerP lck{ bm };
+    void* ptr = static_cast<char*>(lck.ptrDataRoi) + rect_clipped.y * static_cast<ptrdiff_t>(lck.stride) + rect_clipped.x * static_cast<ptrdiff_t>(CziUtils::GetBytesPerPel(bm->GetPixelType()));
+    const int w = rect_clipped.w;
+    const int h = rect_clipped.h;
 
     switch (bm->GetPixelType())
     {
     case PixelType::Gray8:
-        Fill_Gray8(bm->GetWidth(), bm->GetHeight(), lck.ptrDataRoi, lck.stride, Utilities::clampToByte((255 * (floatColor.r + floatColor.g + floatColor.b)) / 3));
+        Fill_Gray8(w, h, ptr, lck.stride, Utilities::clampToByte((255 * (floatColor.r + floatColor.g + floatColor.b)) / 3));
         break;
     case PixelType::Gray16:
-        Fill_Gray16(bm->GetWidth(), bm->GetHeight(), lck.ptrDataRoi, lck.stride, Utilities::clampToUShort((65535 * (floatColor.r + floatColor.g + floatColor.b)) / 3));
+        Fill_Gray16(w, h, ptr, lck.stride, Utilities::clampToUShort((65535 * (floatColor.r + floatColor.g + floatColor.b)) / 3));
         break;
     case PixelType::Gray32Float:
-        Fill_GrayFloat(bm->GetWidth(), bm->GetHeight(), lck.ptrDataRoi, lck.stride, (floatColor.r + floatColor.g + floatColor.b) / 3);
+        Fill_GrayFloat(w, h, ptr, lck.stride, (floatColor.r + floatColor.g + floatColor.b) / 3);
         break;
     case PixelType::Bgr24:
-        Fill_Bgr24(bm->GetWidth(), bm->GetHeight(), lck.ptrDataRoi, lck.stride, Utilities::clampToByte(255 * floatColor.b), Utilities::clampToByte(255 * floatColor.g), Utilities::clampToByte(255 * floatColor.r));
+        Fill_Bgr24(w, h, ptr, lck.stride, Utilities::clampToByte(255 * floatColor.b), Utilities::clampToByte(255 * floatColor.g), Utilities::clampToByte(255 * floatColor.r));
         break;
     case PixelType::Bgra32:
         // Setting a fixed value of 255 to the alpha channel.
-        Fill_Bgra32(bm->GetWidth(), bm->GetHeight(), lck.ptrDataRoi, lck.stride, Utilities::clampToByte(255 * floatColor.b), Utilities::clampToByte(255 * floatColor.g), Utilities::clampToByte(255 * floatColor.r), 255);
+        Fill_Bgra32(w, h, ptr, lck.stride, Utilities::clampToByte(255 * floatColor.b), Utilities::clampToByte(255 * floatColor.g), Utilities::clampToByte(255 * floatColor.r), 255);
         break;
     case PixelType::Bgr48:
-        Fill_Bgr48(bm->GetWidth(), bm->GetHeight(), lck.ptrDataRoi, lck.stride, Utilities::clampToUShort(65535 * floatColor.b), Utilities::clampToUShort(65535 * floatColor.g), Utilities::clampToUShort(65535 * floatColor.r));
+        Fill_Bgr48(w, h, ptr, lck.stride, Utilities::clampToUShort(65535 * floatColor.b), Utilities::clampToUShort(65535 * floatColor.g), Utilities::clampToUShort(65535 * floatColor.r));
         break;
     default:
         throw runtime_error("Sorry, this pixeltype isn't implemented yet.");
@@ -290,13 +341,11 @@ using namespace std;
 
 /*static*/void CBitmapOperations::Fill_Gray16(int w, int h, void* ptr, int stride, std::uint16_t val)
 {
+    const auto fill_line = CpuDispatch::GetKernels().fillGray16Line;
     for (int y = 0; y < h; ++y)
     {
         std::uint16_t* p = reinterpret_cast<std::uint16_t*>(static_cast<char*>(ptr) + (y * static_cast<ptrdiff_t>(stride)));
-        for (int x = 0; x < w; ++x)
-        {
-            *(p + x) = val;
-        }
+        (*fill_line)(p, w, val);
     }
 }
 
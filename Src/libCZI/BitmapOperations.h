@@ -20,6 +20,18 @@ namespace libCZI {
 
             static void NNResize(libCZI::IBitmapData* bmSrc, libCZI::IBitmapData* bmDest, const libCZI::DblRect& roiSrc, const libCZI::DblRect& roiDst);
 
+            /// Nearest-neighbor resize where the pixels are mapped through the specified look-up table while being
+            /// written to the destination. The look-up table is indexed with the source pixel value, so it must have
+            /// 256 elements for a Gray8-source and 65536 elements for a Gray16-source. The destination must be Gray8.
+            /// If the look-up table is null, this is equivalent to the overload without look-up table.
+            ///
+            /// \param [in] bmSrc       The source bitmap.
+            /// \param [in] bmDest      The destination bitmap.
+            /// \param roiSrc           The ROI in the source bitmap.
+            /// \param roiDst           The ROI in the destination bitmap.
+            /// \param lookUpTable      The look-up table (may be null).
+            static void NNResize(libCZI::IBitmapData* bmSrc, libCZI::IBitmapData* bmDest, const libCZI::DblRect& roiSrc, const libCZI::DblRect& roiDst, const std::uint8_t* lookUpTable);
+
             template <typename tFlt>
             struct NNResizeInfo2
             {
@@ -39,6 +51,9 @@ namespace libCZI {
             template <typename tFlt>
             static void NNScale2(libCZI::PixelType tSrcPixelType, libCZI::PixelType tDstPixelType, const NNResizeInfo2<tFlt>& resizeInfo);
 
+            template <typename tFlt>
+            static void NNScale2WithLookUpTable(libCZI::PixelType srcPixelType, libCZI::PixelType dstPixelType, const NNResizeInfo2<tFlt>& resizeInfo, const std::uint8_t* lookUpTable);
+
             /// This structure gathers the information needed to copy a source bitmap into
             /// a destination bitmap at a specified offset.
             struct CopyWithOffsetInfo
@@ -60,7 +75,18 @@ namespace libCZI {
             };
 
             static void CopyWithOffset(const CopyWithOffsetInfo& info);
+
+            /// Copy the source bitmap into the destination bitmap at the specified offset, where the pixels are
+            /// mapped through the specified look-up table (for the requirements on the look-up table, c.f. the
+            /// look-up-table overload of NNResize). If the look-up table is null, this is equivalent to the
+            /// overload without look-up table.
+            ///
+            /// \param info         The information describing the copy operation.
+            /// \param lookUpTable  The look-up table (may be null).
+            static void CopyWithOffset(const CopyWithOffsetInfo& info, const std::uint8_t* lookUpTable);
+
             static void Copy(libCZI::PixelType srcPixelType, const void* srcPtr, int srcStride, libCZI::PixelType dstPixelType, void* dstPtr, int dstStride, int width, int height, bool drawTileBorder);
+            static void CopyWithLookUpTable(libCZI::PixelType srcPixelType, const void* srcPtr, int srcStride, libCZI::PixelType dstPixelType, void* dstPtr, int dstStride, int width, int height, const std::uint8_t* lookUpTable, bool drawTileBorder);
 
             template <libCZI::PixelType tSrcPixelType, libCZI::PixelType tDstPixelType>
             static void Copy(const void* srcPtr, int srcStride, void* dstPtr, int dstStride, int width, int height, bool drawTileBorder);
@@ -73,6 +99,14 @@ namespace libCZI {
 
             static void Fill(libCZI::IBitmapData* bm, const libCZI::RgbFloatColor& floatColor);
 
+            /// Fill the specified rectangle of the bitmap with the specified color. The rectangle is clipped to the extent
+            /// of the bitmap.
+            ///
+            /// \param [in] bm          The bitmap.
+            /// \param      rect        The rectangle (in pixel coordinates of the bitmap) to be filled.
+            /// \param      floatColor  The color.
+            static void Fill(libCZI::IBitmapData* bm, const libCZI::IntRect& rect, const libCZI::RgbFloatColor& floatColor);
+
             static void Fill_Gray8(int w, int h, void* ptr, int stride, std::uint8_t val);
             static void Fill_Gray16(int w, int h, void* ptr, int stride, std::uint16_t val);
             static void Fill_Bgr24(int w, int h, void* ptr, int stride, std::uint8_t b, std::uint8_t g, std::uint8_t r);
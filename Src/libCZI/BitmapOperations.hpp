@@ -6,6 +6,7 @@
 
 #include "BitmapOperations.h"
 #include "CziUtils.h"
+#include "cpu_dispatch.h"
 
 #include <cmath>
 #include <cstring>
@@ -202,6 +203,36 @@ namespace libCZI
             }
         };
 
+        /// Pixel converter Gray8 -> Gray8 where the source value is mapped through a look-up table with 256 elements.
+        struct CConvGray8ToGray8WithLookUpTable
+        {
+            const std::uint8_t* lookUpTable;
+
+            explicit CConvGray8ToGray8WithLookUpTable(const std::uint8_t* lookUpTable) : lookUpTable(lookUpTable) {}
+
+            void ConvertPixel(void* ptrDest, const void* ptrSrc) const
+            {
+                const std::uint8_t* src = (const std::uint8_t*)ptrSrc;
+                std::uint8_t* dst = (std::uint8_t*)ptrDest;
+                *dst = this->lookUpTable[*src];
+            }
+        };
+
+        /// Pixel converter Gray16 -> Gray8 where the source value is mapped through a look-up table with 65536 elements.
+        struct CConvGray16ToGray8WithLookUpTable
+        {
+            const std::uint8_t* lookUpTable;
+
+            explicit CConvGray16ToGray8WithLookUpTable(const std::uint8_t* lookUpTable) : lookUpTable(lookUpTable) {}
+
+            void ConvertPixel(void* ptrDest, const void* ptrSrc) const
+            {
+                const std::uint16_t* src = (const std::uint16_t*)ptrSrc;
+                std::uint8_t* dst = (std::uint8_t*)ptrDest;
+                *dst = this->lookUpTable[*src];
+            }
+        };
+
         struct CConvBgr24ToGray32Float
         {
             void ConvertPixel(void* ptrDest, const void* ptrSrc) const
@@ -347,7 +378,15 @@ namespace libCZI
         template <>
         inline void CBitmapOperations::Copy<libCZI::PixelType::Gray8, libCZI::PixelType::Gray16>(const void* srcPtr, int srcStride, void* dstPtr, int dstStride, int width, int height, bool drawTileBorder)
         {
-            Copy<libCZI::PixelType::Gray8, libCZI::PixelType::Gray16, CConvGray8ToGray16>(CConvGray8ToGray16(), srcPtr, srcStride, dstPtr, dstStride, width, height, drawTileBorder);
+            (void)drawTileBorder;
+            const auto convert_line = CpuDispatch::GetKernels().convertGray8ToGray16Line;
+            for (int y = 0; y < height; ++y)
+            {
+                (*convert_line)(
+                    static_cast<const std::uint8_t*>(srcPtr) + y * static_cast<std::ptrdiff_t>(srcStride),
+                    reinterpret_cast<std::uint16_t*>(static_cast<char*>(dstPtr) + y * static_cast<std::ptrdiff_t>(dstStride)),
+                    width);
+            }
         }
         template <>
         inline void CBitmapOperations::Copy<libCZI::PixelType::Gray8, libCZI::PixelType::Gray32Float>(const void* srcPtr, int srcStride, void* dstPtr, int dstStride, int width, int height, bool drawTileBorder)
@@ -372,7 +411,15 @@ namespace libCZI
         template <>
         inline void CBitmapOperations::Copy<libCZI::PixelType::Gray16, libCZI::PixelType::Gray8>(const void* srcPtr, int srcStride, void* dstPtr, int dstStride, int width, int height, bool drawTileBorder)
         {
-            Copy<libCZI::PixelType::Gray16, libCZI::PixelType::Gray8, CConvGray16ToGray8>(CConvGray16ToGray8(), srcPtr, srcStride, dstPtr, dstStride, width, height, drawTileBorder);
+            (void)drawTileBorder;
+            const auto convert_line = CpuDispatch::GetKernels().convertGray16ToGray8Line;
+            for (int y = 0; y < height; ++y)
+            {
+                (*convert_line)(
+                    reinterpret_cast<const std::uint16_t*>(static_cast<const char*>(srcPtr) + y * static_cast<std::ptrdiff_t>(srcStride)),
+                    static_cast<std::uint8_t*>(dstPtr) + y * static_cast<std::ptrdiff_t>(dstStride),
+                    width);
+            }
         }
         template <>
         inline void CBitmapOperations::Copy<libCZI::PixelType::Gray16, libCZI::PixelType::Gray32Float>(const void* srcPtr, int srcStride, void* dstPtr, int dstStride, int width, int height, bool drawTileBorder)
@@ -596,5 +643,32 @@ namespace libCZI
                 ThrowUnsupportedConversion(srcPixelType, dstPixelType);
             }
         }
+
+        template <typename tFlt>
+        void CBitmapOperations::NNScale2WithLookUpTable(libCZI::PixelType srcPixelType, libCZI::PixelType dstPixelType, const NNResizeInfo2<tFlt>& resizeInfo, const std::uint8_t* lookUpTable)
+        {
+            if (lookUpTable == nullptr)
+            {
+                NNScale2(srcPixelType, dstPixelType, resizeInfo);
+                return;
+            }
+
+            if (dstPixelType != libCZI::PixelType::Gray8)
+            {
+                ThrowUnsupportedConversion(srcPixelType, dstPixelType);
+            }
+
+            switch (srcPixelType)
+            {
+            case libCZI::PixelType::Gray8:
+                InternalNNScale2<libCZI::PixelType::Gray8, libCZI::PixelType::Gray8, CConvGray8ToGray8WithLookUpTable>(CConvGray8ToGray8WithLookUpTable(lookUpTable), resizeInfo);
+                break;
+            case libCZI::PixelType::Gray16:
+                InternalNNScale2<libCZI::PixelType::Gray16, libCZI::PixelType::Gray8, CConvGray16ToGray8WithLookUpTable>(CConvGray16ToGray8WithLookUpTable(lookUpTable), resizeInfo);
+                break;
+            default:
+                ThrowUnsupportedConversion(srcPixelType, dstPixelType);
+            }
+        }
     } // namespace detail
 } // namespace libCZI
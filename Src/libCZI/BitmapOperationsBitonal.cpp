@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include "inc_libCZI_Config.h"
 #include "BitmapOperations.h"
@@ -409,6 +411,165 @@ void BitmapOperationsBitonal::BitonalDecimate(
 
 namespace
 {
+    /// Utilities for scanning a line of a bitonal mask "span-wise" - the mask is read in chunks of 64 bits, and
+    /// chunks where all bits are set (or all bits are cleared) are dealt with as a whole. Only for chunks with
+    /// mixed content we have to look at the individual bits.
+    class BitonalLineScanner
+    {
+    public:
+        /// Reads 'count' consecutive bits from the specified line of a bitonal bitmap, starting at the
+        /// specified bit position. The result is "MSB-aligned", i.e. the first bit is found in bit 63 of
+        /// the result, and bits beyond 'count' are zero.
+        ///
+        /// \param 	line			Pointer to the line of the bitonal bitmap.
+        /// \param 	bit_position	The bit position (i.e. the x-coordinate) of the first bit to read.
+        /// \param 	count			The number of bits to read, must be in the range 1 to 64.
+        ///
+        /// \returns	The bits, MSB-aligned.
+        static std::uint64_t ReadBits(const std::uint8_t* line, int bit_position, int count)
+        {
+            const std::uint8_t* ptr = line + bit_position / 8;
+            const int shift = bit_position % 8;
+            const int bytes_to_read = (shift + count + 7) / 8;
+
+            std::uint64_t value = 0;
+            const int bytes_for_value = (std::min)(bytes_to_read, 8);
+            for (int i = 0; i < bytes_for_value; ++i)
+            {
+                value |= static_cast<std::uint64_t>(ptr[i]) << (56 - 8 * i);
+            }
+
+            if (shift != 0)
+            {
+                value <<= shift;
+                if (bytes_to_read > 8)
+                {
+                    value |= static_cast<std::uint64_t>(ptr[8]) >> (8 - shift);
+                }
+            }
+
+            return value & MaskForBitCount(count);
+        }
+
+        /// Gets a value with the 'count' most-significant bits set (where count must be in the range 1 to 64).
+        static std::uint64_t MaskForBitCount(int count)
+        {
+            return count >= 64 ? ~static_cast<std::uint64_t>(0) : ~(~static_cast<std::uint64_t>(0) >> count);
+        }
+
+        /// Enumerate the runs of set bits in the specified line of a bitonal bitmap. The functor is called
+        /// with the start (relative to 'bit_offset') and the length of each maximal run of set bits.
+        ///
+        /// \param 	line	  	Pointer to the line of the bitonal bitmap.
+        /// \param 	bit_offset	The bit position (i.e. the x-coordinate) where to start.
+        /// \param 	width	  	The number of bits to examine.
+        /// \param 	on_run	  	Functor with signature "void(int start, int length)" which is called for each run of set bits.
+        template <typename tOnRun>
+        static void ForEachRunOfSetBits(const void* line, int bit_offset, int width, tOnRun on_run)
+        {
+            const std::uint8_t* line_bytes = static_cast<const std::uint8_t*>(line);
+            int run_start = -1;
+            for (int x = 0; x < width; x += 64)
+            {
+                const int count = (std::min)(64, width - x);
+                const std::uint64_t all_set = MaskForBitCount(count);
+                const std::uint64_t bits = ReadBits(line_bytes, bit_offset + x, count);
+                if (bits == all_set)
+                {
+                    if (run_start < 0)
+                    {
+                        run_start = x;
+                    }
+
+                    continue;
+                }
+
+                if (bits == 0)
+                {
+                    if (run_start >= 0)
+                    {
+                        on_run(run_start, x - run_start);
+                        run_start = -1;
+                    }
+
+                    continue;
+                }
+
+                // this is the "mixed case", here we have to look at the individual bits
+                for (int i = 0; i < count; ++i)
+                {
+                    if ((bits & (static_cast<std::uint64_t>(1) << (63 - i))) != 0)
+                    {
+                        if (run_start < 0)
+                        {
+                            run_start = x + i;
+                        }
+                    }
+                    else if (run_start >= 0)
+                    {
+                        on_run(run_start, x + i - run_start);
+                        run_start = -1;
+                    }
+                }
+            }
+
+            if (run_start >= 0)
+            {
+                on_run(run_start, width - run_start);
+            }
+        }
+
+        /// Determines whether all bits in the specified rectangle of a bitonal bitmap are set.
+        ///
+        /// \param 	ptr	   	Pointer to the bitonal bitmap.
+        /// \param 	stride 	The stride (in units of bytes).
+        /// \param 	x	   	The x-coordinate of the top-left corner of the rectangle.
+        /// \param 	y	   	The y-coordinate of the top-left corner of the rectangle.
+        /// \param 	width  	The width of the rectangle.
+        /// \param 	height 	The height of the rectangle.
+        ///
+        /// \returns	True if all bits in the rectangle are set; false otherwise.
+        static bool AreAllBitsSet(const void* ptr, int stride, int x, int y, int width, int height)
+        {
+            for (int line = 0; line < height; ++line)
+            {
+                const std::uint8_t* line_bytes = static_cast<const std::uint8_t*>(ptr) + (y + line) * static_cast<std::ptrdiff_t>(stride);
+                for (int i = 0; i < width; i += 64)
+                {
+                    const int count = (std::min)(64, width - i);
+                    if (ReadBits(line_bytes, x + i, count) != MaskForBitCount(count))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+    };
+
+    /// Search for the smallest value in the range [first, last) for which the predicate is true - the predicate
+    /// must be monotonic (i.e. if it is true for some value, it must be true for all larger values). If the
+    /// predicate is false for all values in the range, 'last' is returned.
+    template <typename tPredicate>
+    int FindFirstInMonotonicRange(int first, int last, tPredicate predicate)
+    {
+        while (first < last)
+        {
+            const int middle = first + (last - first) / 2;
+            if (predicate(middle))
+            {
+                last = middle;
+            }
+            else
+            {
+                first = middle + 1;
+            }
+        }
+
+        return first;
+    }
+
     template <typename tFlt>
     struct NNResizeMaskAwareInfo2
     {
@@ -450,9 +611,43 @@ namespace
         const int dstYStartClipped = (std::max)(static_cast<int>(std::ceil(yMin)), dstYStart);
         const int dstYEndClipped = (std::min)(static_cast<int>(std::ceil(yMax)), dstYEnd);
 
+        if (dstXStartClipped > dstXEndClipped)
+        {
+            return;
+        }
+
         const auto srcWidthOverDstWidth = resize_info.srcRoiW / resize_info.dstRoiW;
         const auto srcHeightOverDstHeight = resize_info.srcRoiH / resize_info.dstRoiH;
 
+        // this gives the x-coordinate in the source for a given x-coordinate in the destination - note that
+        //  this function is monotonic (non-decreasing)
+        const auto get_source_x = [&](int x) -> long
+            {
+                const tFlt srcX = (x - resize_info.dstRoiX) * srcWidthOverDstWidth + resize_info.srcRoiX;
+                const long srcXInt = lround(srcX);
+                if (srcXInt < 0)
+                {
+                    return 0;
+                }
+                else if (srcXInt >= resize_info.srcWidth)
+                {
+                    return resize_info.srcWidth - 1;
+                }
+
+                return srcXInt;
+            };
+
+        // The source-pixels which are relevant for this operation are in the range [srcXMin, srcXMax], and pixels
+        //  for which there is no corresponding pixel in the mask are considered "masked out".
+        const int srcXMin = static_cast<int>(get_source_x(dstXStartClipped));
+        const int srcXMax = (std::min)(static_cast<int>(get_source_x(dstXEndClipped)), resize_info.maskWidth - 1);
+
+        // We determine the runs of valid pixels in the mask (for a source line), and then process the corresponding
+        //  destination pixels without having to check the mask for each pixel. The runs are cached, as for upscaling
+        //  the same source line is used for multiple destination lines.
+        std::vector<std::pair<int, int>> runs;
+        long runs_source_line = -1;
+
         for (int y = dstYStartClipped; y <= dstYEndClipped; ++y)
         {
             tFlt srcY = (y - resize_info.dstRoiY) * srcHeightOverDstHeight + resize_info.srcRoiY;
@@ -466,29 +661,43 @@ namespace
                 srcYInt = resize_info.srcHeight - 1;
             }
 
+            if (srcYInt >= resize_info.maskHeight || srcXMin > srcXMax)
+            {
+                continue;
+            }
+
+            if (srcYInt != runs_source_line)
+            {
+                runs.clear();
+                BitonalLineScanner::ForEachRunOfSetBits(
+                    static_cast<const std::uint8_t*>(resize_info.srcMaskPtr) + srcYInt * static_cast<size_t>(resize_info.srcMaskStride),
+                    srcXMin,
+                    srcXMax - srcXMin + 1,
+                    [&](int start, int length)->void
+                    {
+                        runs.emplace_back(srcXMin + start, srcXMin + start + length);
+                    });
+                runs_source_line = srcYInt;
+            }
+
             const char* pSrcLine = (static_cast<const char*>(resize_info.srcPtr) + srcYInt * static_cast<size_t>(resize_info.srcStride));
             char* pDstLine = static_cast<char*>(resize_info.dstPtr) + y * static_cast<size_t>(resize_info.dstStride);
-            for (int x = dstXStartClipped; x <= dstXEndClipped; ++x)
+            int x = dstXStartClipped;
+            for (const auto& run : runs)
             {
-                // now transform this pixel into the source-ROI
-                tFlt srcX = (x - resize_info.dstRoiX) * srcWidthOverDstWidth + resize_info.srcRoiX;
-                long srcXInt = lround(srcX);
-                if (srcXInt < 0)
-                {
-                    srcXInt = 0;
-                }
-                else if (srcXInt >= resize_info.srcWidth)
+                // find the range of destination pixels which map into this run of valid source pixels
+                x = FindFirstInMonotonicRange(x, dstXEndClipped + 1, [&](int v)->bool {return get_source_x(v) >= run.first; });
+                const int x_end = FindFirstInMonotonicRange(x, dstXEndClipped + 1, [&](int v)->bool {return get_source_x(v) >= run.second; });
+                for (; x < x_end; ++x)
                 {
-                    srcXInt = resize_info.srcWidth - 1;
+                    const char* pSrc = pSrcLine + get_source_x(x) * static_cast<size_t>(bytesPerPelSrc);
+                    char* pDst = pDstLine + x * static_cast<size_t>(bytesPerPelDest);
+                    conv.ConvertPixel(pDst, pSrc);
                 }
 
-                if (srcXInt < resize_info.maskWidth &&
-                    srcYInt < resize_info.maskHeight &&
-                    BitmapOperationsBitonal::GetPixelFromBitonalUnchecked(srcXInt, srcYInt, resize_info.srcMaskPtr, resize_info.srcMaskStride))
+                if (x > dstXEndClipped)
                 {
-                    const char* pSrc = pSrcLine + srcXInt * static_cast<size_t>(bytesPerPelSrc);
-                    char* pDst = pDstLine + x * static_cast<size_t>(bytesPerPelDest);
-                    conv.ConvertPixel(pDst, pSrc);
+                    break;
                 }
             }
         }
@@ -633,6 +842,36 @@ namespace
     }
 }
 
+namespace
+{
+    template <typename tFlt>
+    void NNScaleMaskAware2WithLookUpTable(libCZI::PixelType source_pixel_type, libCZI::PixelType destination_pixel_type, const NNResizeMaskAwareInfo2<tFlt>& resize_info, const std::uint8_t* look_up_table)
+    {
+        if (look_up_table == nullptr)
+        {
+            NNScaleMaskAware2<tFlt>(source_pixel_type, destination_pixel_type, resize_info);
+            return;
+        }
+
+        if (destination_pixel_type != libCZI::PixelType::Gray8)
+        {
+            ThrowUnsupportedConversion(source_pixel_type, destination_pixel_type);
+        }
+
+        switch (source_pixel_type)
+        {
+        case libCZI::PixelType::Gray8:
+            InternalNNScaleMaskAware2<libCZI::PixelType::Gray8, libCZI::PixelType::Gray8, CConvGray8ToGray8WithLookUpTable>(CConvGray8ToGray8WithLookUpTable(look_up_table), resize_info);
+            break;
+        case libCZI::PixelType::Gray16:
+            InternalNNScaleMaskAware2<libCZI::PixelType::Gray16, libCZI::PixelType::Gray8, CConvGray16ToGray8WithLookUpTable>(CConvGray16ToGray8WithLookUpTable(look_up_table), resize_info);
+            break;
+        default:
+            ThrowUnsupportedConversion(source_pixel_type, destination_pixel_type);
+        }
+    }
+}
+
 namespace
 {
     struct CopyParameters
@@ -650,6 +889,21 @@ namespace
         bool drawTileBorder;
     };
 
+    /// Enumerate the runs of valid pixels (according to the mask) in the specified line. The runs are reported with
+    /// x-coordinates relative to the start of the line (i.e. relative to the source bitmap).
+    template <typename tOnRun>
+    void ForEachRunOfValidPixels(const CopyParameters& parameters, int y, int x_start, int width, tOnRun on_run)
+    {
+        BitonalLineScanner::ForEachRunOfSetBits(
+            static_cast<const std::uint8_t*>(parameters.srcMaskPtr) + (y + parameters.maskOffsetY) * static_cast<std::ptrdiff_t>(parameters.srcMaskStride),
+            x_start + parameters.maskOffsetX,
+            width,
+            [&](int start, int length)->void
+            {
+                on_run(x_start + start, length);
+            });
+    }
+
     template <libCZI::PixelType tSrcDstPixelType>
     void CopySamePixelTypeWithMask(const CopyParameters& parameters)
     {
@@ -662,16 +916,15 @@ namespace
             {
                 char* dest = static_cast<char*>(parameters.dstPtr) + y * static_cast<std::ptrdiff_t>(parameters.dstStride);
                 const char* src = static_cast<const char*>(parameters.srcPtr) + y * static_cast<std::ptrdiff_t>(parameters.srcStride);
-
-                for (int x = 0; x < parameters.width; ++x)
-                {
-                    if (BitmapOperationsBitonal::GetPixelFromBitonalUnchecked(x + parameters.maskOffsetX, y + parameters.maskOffsetY, parameters.srcMaskPtr, parameters.srcMaskStride))
+                ForEachRunOfValidPixels(
+                    parameters,
+                    y,
+                    0,
+                    parameters.width,
+                    [&](int start, int length)->void
                     {
-                        char* destPixel = dest + x * bytes_per_pel;
-                        const char* srcPixel = src + x * bytes_per_pel;
-                        memcpy(destPixel, srcPixel, bytes_per_pel);
-                    }
-                }
+                        memcpy(dest + start * static_cast<size_t>(bytes_per_pel), src + start * static_cast<size_t>(bytes_per_pel), length * static_cast<size_t>(bytes_per_pel));
+                    });
             }
         }
         else
@@ -682,14 +935,17 @@ namespace
                 char* dest = static_cast<char*>(parameters.dstPtr) + y * static_cast<std::ptrdiff_t>(parameters.dstStride);
                 const char* src = static_cast<const char*>(parameters.srcPtr) + y * static_cast<std::ptrdiff_t>(parameters.srcStride);
                 memset(dest, 0, bytes_per_pel);
-                for (int x = 1; x < parameters.width - 1; ++x)
+                if (parameters.width > 2)
                 {
-                    if (BitmapOperationsBitonal::GetPixelFromBitonalUnchecked(x + parameters.maskOffsetX, y + parameters.maskOffsetY, parameters.srcMaskPtr, parameters.srcMaskStride))
-                    {
-                        char* dest_pixel = dest + x * bytes_per_pel;
-                        const char* src_pixel = src + x * bytes_per_pel;
-                        memcpy(dest_pixel, src_pixel, bytes_per_pel);
-                    }
+                    ForEachRunOfValidPixels(
+                        parameters,
+                        y,
+                        1,
+                        parameters.width - 2,
+                        [&](int start, int length)->void
+                        {
+                            memcpy(dest + start * static_cast<size_t>(bytes_per_pel), src + start * static_cast<size_t>(bytes_per_pel), length * static_cast<size_t>(bytes_per_pel));
+                        });
                 }
 
                 memset(dest + bytes_to_copy - bytes_per_pel, 0, bytes_per_pel);
@@ -702,21 +958,50 @@ namespace
     template <libCZI::PixelType tSrcPixelType, libCZI::PixelType tDstPixelType, typename tPixelConverter>
     void CopyWithMask(const tPixelConverter& conv, const CopyParameters& parameters)
     {
+        constexpr auto bytes_per_pel_source = CziUtils::BytesPerPel<tSrcPixelType>();
+        constexpr auto bytes_per_pel_destination = CziUtils::BytesPerPel<tDstPixelType>();
+
         // TODO: -implement "drawBorder"
         for (int y = 0; y < parameters.height; ++y)
         {
             char* dest = static_cast<char*>(parameters.dstPtr) + y * static_cast<std::ptrdiff_t>(parameters.dstStride);
             const char* src = static_cast<const char*>(parameters.srcPtr) + y * static_cast<std::ptrdiff_t>(parameters.srcStride);
-            for (int x = 0; x < parameters.width; ++x)
-            {
-                if (BitmapOperationsBitonal::GetPixelFromBitonalUnchecked(x + parameters.maskOffsetX, y + parameters.maskOffsetY, parameters.srcMaskPtr, parameters.srcMaskStride))
+            ForEachRunOfValidPixels(
+                parameters,
+                y,
+                0,
+                parameters.width,
+                [&](int start, int length)->void
                 {
-                    conv.ConvertPixel(dest, src);
-                }
-            }
+                    char* dest_pixel = dest + start * static_cast<size_t>(bytes_per_pel_destination);
+                    const char* src_pixel = src + start * static_cast<size_t>(bytes_per_pel_source);
+                    for (int x = 0; x < length; ++x)
+                    {
+                        conv.ConvertPixel(dest_pixel, src_pixel);
+                        dest_pixel += bytes_per_pel_destination;
+                        src_pixel += bytes_per_pel_source;
+                    }
+                });
+        }
+    }
 
-            dest += CziUtils::BytesPerPel<tDstPixelType>();;
-            src += CziUtils::BytesPerPel<tSrcPixelType>();;
+    /// Copy with mask, where the runs of valid pixels are converted with a line kernel (c.f. CpuDispatch).
+    template <typename tSrcElement, typename tDstElement>
+    void CopyWithMaskUsingLineKernel(void(*convert_line)(const tSrcElement*, tDstElement*, size_t), const CopyParameters& parameters)
+    {
+        for (int y = 0; y < parameters.height; ++y)
+        {
+            tDstElement* dest = reinterpret_cast<tDstElement*>(static_cast<char*>(parameters.dstPtr) + y * static_cast<std::ptrdiff_t>(parameters.dstStride));
+            const tSrcElement* src = reinterpret_cast<const tSrcElement*>(static_cast<const char*>(parameters.srcPtr) + y * static_cast<std::ptrdiff_t>(parameters.srcStride));
+            ForEachRunOfValidPixels(
+                parameters,
+                y,
+                0,
+                parameters.width,
+                [&](int start, int length)->void
+                {
+                    (*convert_line)(src + start, dest + start, length);
+                });
         }
     }
 
@@ -756,7 +1041,7 @@ namespace
     }
     template <> void CopyWithMask<libCZI::PixelType::Gray8, libCZI::PixelType::Gray16>(const CopyParameters& parameters)
     {
-        CopyWithMask<libCZI::PixelType::Gray8, libCZI::PixelType::Gray16, CConvGray8ToGray16>(CConvGray8ToGray16(), parameters);
+        CopyWithMaskUsingLineKernel(CpuDispatch::GetKernels().convertGray8ToGray16Line, parameters);
     }
     template <> void CopyWithMask<libCZI::PixelType::Gray8, libCZI::PixelType::Gray32Float>(const CopyParameters& parameters)
     {
@@ -776,7 +1061,7 @@ namespace
     }
     template <> void CopyWithMask<libCZI::PixelType::Gray16, libCZI::PixelType::Gray8>(const CopyParameters& parameters)
     {
-        CopyWithMask<libCZI::PixelType::Gray16, libCZI::PixelType::Gray8, CConvGray16ToGray8>(CConvGray16ToGray8(), parameters);
+        CopyWithMaskUsingLineKernel(CpuDispatch::GetKernels().convertGray16ToGray8Line, parameters);
     }
     template <> void CopyWithMask<libCZI::PixelType::Gray16, libCZI::PixelType::Gray32Float>(const CopyParameters& parameters)
     {
@@ -917,6 +1202,32 @@ namespace
 
         throw std::logic_error("It seems that this conversion is not implemented...");
     }
+
+    void CopyWithMaskAndLookUpTable(libCZI::PixelType source_pixel_type, libCZI::PixelType destination_pixel_type, const CopyParameters& parameters, const std::uint8_t* look_up_table)
+    {
+        if (look_up_table == nullptr)
+        {
+            CopyWithMask(source_pixel_type, destination_pixel_type, parameters);
+            return;
+        }
+
+        if (destination_pixel_type == PixelType::Gray8)
+        {
+            switch (source_pixel_type)
+            {
+            case PixelType::Gray8:
+                CopyWithMask<PixelType::Gray8, PixelType::Gray8, CConvGray8ToGray8WithLookUpTable>(CConvGray8ToGray8WithLookUpTable(look_up_table), parameters);
+                return;
+            case PixelType::Gray16:
+                CopyWithMask<PixelType::Gray16, PixelType::Gray8, CConvGray16ToGray8WithLookUpTable>(CConvGray16ToGray8WithLookUpTable(look_up_table), parameters);
+                return;
+            default:
+                break;
+            }
+        }
+
+        ThrowUnsupportedConversion(source_pixel_type, destination_pixel_type);
+    }
 }
 
 /*static*/void BitmapOperationsBitonal::NNResizeMaskAware(
@@ -925,6 +1236,17 @@ namespace
     libCZI::IBitmapData* bmDest,
     const libCZI::DblRect& roiSrc,
     const libCZI::DblRect& roiDst)
+{
+    NNResizeMaskAware(bmSrc, bmSrcMask, bmDest, roiSrc, roiDst, nullptr);
+}
+
+/*static*/void BitmapOperationsBitonal::NNResizeMaskAware(
+    libCZI::IBitmapData* bmSrc,
+    libCZI::IBitonalBitmapData* bmSrcMask,
+    libCZI::IBitmapData* bmDest,
+    const libCZI::DblRect& roiSrc,
+    const libCZI::DblRect& roiDst,
+    const std::uint8_t* lookUpTable)
 {
     // Implement the nearest neighbor resizing with mask awareness 
     ScopedBitmapLockerP lckSrc{ bmSrc };
@@ -952,14 +1274,19 @@ namespace
     resizeInfo.dstRoiH = roiDst.h;
     resizeInfo.dstWidth = bmDest->GetWidth();
     resizeInfo.dstHeight = bmDest->GetHeight();
-    NNScaleMaskAware2<double>(bmSrc->GetPixelType(), bmDest->GetPixelType(), resizeInfo);
+    NNScaleMaskAware2WithLookUpTable<double>(bmSrc->GetPixelType(), bmDest->GetPixelType(), resizeInfo, lookUpTable);
 }
 
 /*static*/void BitmapOperationsBitonal::CopyWithOffsetAndMask(const CopyWithOffsetAndMaskInfo& info)
+{
+    CopyWithOffsetAndMask(info, nullptr);
+}
+
+/*static*/void BitmapOperationsBitonal::CopyWithOffsetAndMask(const CopyWithOffsetAndMaskInfo& info, const std::uint8_t* lookUpTable)
 {
     if (info.maskPtr == nullptr)
     {
-        CBitmapOperations::CopyWithOffset(info);
+        CBitmapOperations::CopyWithOffset(info, lookUpTable);
         return;
     }
 
@@ -995,7 +1322,14 @@ namespace
     copy_parameters.maskOffsetY = top_left_src_bitmap.y;
     copy_parameters.drawTileBorder = info.drawTileBorder;
 
-    CopyWithMask(info.srcPixelType, info.dstPixelType, copy_parameters);
+    // If the mask is "all valid" for the region we are about to copy, we can use the (faster) operation without a mask.
+    if (BitonalLineScanner::AreAllBitsSet(info.maskPtr, info.maskStride, top_left_src_bitmap.x, top_left_src_bitmap.y, intersection.w, intersection.h))
+    {
+        CBitmapOperations::CopyWithLookUpTable(info.srcPixelType, ptr_source, info.srcStride, info.dstPixelType, ptr_destination, info.dstStride, intersection.w, intersection.h, lookUpTable, info.drawTileBorder);
+        return;
+    }
+
+    CopyWithMaskAndLookUpTable(info.srcPixelType, info.dstPixelType, copy_parameters, lookUpTable);
 }
 
 /*static*/void BitmapOperationsBitonal::Set(std::uint32_t width, std::uint32_t height, void* ptrData, std::uint32_t stride, bool value)
@@ -156,6 +156,17 @@ namespace libCZI
                 const libCZI::DblRect& roiSrc,
                 const libCZI::DblRect& roiDst);
 
+            /// Mask-aware nearest-neighbor resize where the pixels are mapped through the specified look-up table
+            /// while being written to the destination (c.f. CBitmapOperations::NNResize for the requirements on
+            /// the look-up table). If the look-up table is null, this is equivalent to the overload without look-up table.
+            static void NNResizeMaskAware(
+                libCZI::IBitmapData* bmSrc,
+                libCZI::IBitonalBitmapData* bmSrcMask,
+                libCZI::IBitmapData* bmDest,
+                const libCZI::DblRect& roiSrc,
+                const libCZI::DblRect& roiDst,
+                const std::uint8_t* lookUpTable);
+
             /// This structure gathers the information needed to copy a source bitmap with a specified mask into
             /// a destination bitmap at a specified offset.
             struct CopyWithOffsetAndMaskInfo : CBitmapOperations::CopyWithOffsetInfo
@@ -176,6 +187,14 @@ namespace libCZI
             /// \param 	info	The information.
             static void CopyWithOffsetAndMask(const CopyWithOffsetAndMaskInfo& info);
 
+            /// Copies the specified source bitmap into the specified destination bitmap at the specified offset, using the specified mask,
+            /// where the pixels are mapped through the specified look-up table (c.f. CBitmapOperations::CopyWithOffset). If the look-up
+            /// table is null, this is equivalent to the overload without look-up table.
+            ///
+            /// \param 	info	   	The information.
+            /// \param 	lookUpTable	The look-up table (may be null).
+            static void CopyWithOffsetAndMask(const CopyWithOffsetAndMaskInfo& info, const std::uint8_t* lookUpTable);
+
             static void Copy(
                     libCZI::PixelType srcPixelType,
                     const void* srcPtr,
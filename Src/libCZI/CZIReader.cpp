@@ -2,6 +2,9 @@
 //
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
 #include <utility>
 #include "CZIReader.h"
 #include "CziParse.h"
@@ -36,11 +39,17 @@ static CCZIParse::SubblockDirectoryParseOptions GetParseOptionsFromOpenOptions(c
 CCZIReader::CCZIReader() :
     isOperational(false),
     default_frame_of_reference(CZIFrameOfReference::Invalid),
-    sub_block_directory_info_policy_(ICZIReader::OpenOptions::SubBlockDirectoryInfoPolicy::SubBlockDirectoryPrecedence)
+    sub_block_directory_info_policy_(ICZIReader::OpenOptions::SubBlockDirectoryInfoPolicy::SubBlockDirectoryPrecedence),
+    cacheSharedSubBlockSegments(false),
+    sharedSubBlockSegmentsDetermined(false),
+    followAppendedSegments(false),
+    nextScanPosition(0),
+    processedSubBlockDirectoryPosition(0),
+    performanceCounters(make_shared<PerformanceCounters>())
 {
 }
 
-/*virtual */void CCZIReader::Open(const std::shared_ptr<libCZI::IStream>& stream, const ICZIReader::OpenOptions* options)
+/*virtual */void CCZIReader::Open(const std::shared_ptr<libCZI::IStream>& stream_to_open, const ICZIReader::OpenOptions* options)
 {
     if (this->isOperational == true)
     {
@@ -50,17 +59,31 @@ CCZIReader::CCZIReader() :
     if (options == nullptr)
     {
         constexpr auto default_options = OpenOptions{};
-        return CCZIReader::Open(stream, &default_options);
+        return CCZIReader::Open(stream_to_open, &default_options);
     }
 
+    // all read operations are done through a wrapper which maintains the stream-related performance counters
+    const shared_ptr<IStream> stream = make_shared<CInstrumentedInputStream>(stream_to_open, this->performanceCounters);
+
+    this->parseOptions = GetParseOptionsFromOpenOptions(*options);
+    this->followAppendedSegments = options->follow_appended_segments;
     this->hdrSegmentData = CCZIParse::ReadFileHeaderSegmentData(stream.get());
-    this->subBlkDir = CCZIParse::ReadSubBlockDirectory(stream.get(), this->hdrSegmentData.GetSubBlockDirectoryPosition(), GetParseOptionsFromOpenOptions(*options));
-    const auto attachmentPos = this->hdrSegmentData.GetAttachmentDirectoryPosition();
-    if (attachmentPos != 0)
+    if (this->followAppendedSegments)
+    {
+        // scanning the segments is done with the stream-member
+        this->stream = stream;
+        this->OpenForFollowingAppendedSegments(stream.get());
+    }
+    else
     {
-        // we should be operational without an attachment-directory as well I suppose.
-        // TODO: how to determine whether there is "no attachment-directory" - is the check for 0 sufficient?
-        this->attachmentDir = CCZIParse::ReadAttachmentsDirectory(stream.get(), attachmentPos);
+        this->subBlkDir = CCZIParse::ReadSubBlockDirectory(stream.get(), this->hdrSegmentData.GetSubBlockDirectoryPosition(), this->parseOptions);
+        const auto attachmentPos = this->hdrSegmentData.GetAttachmentDirectoryPosition();
+        if (attachmentPos != 0)
+        {
+            // we should be operational without an attachment-directory as well I suppose.
+            // TODO: how to determine whether there is "no attachment-directory" - is the check for 0 sufficient?
+            this->attachmentDir = CCZIParse::ReadAttachmentsDirectory(stream.get(), attachmentPos);
+        }
     }
 
     this->stream = stream;
@@ -76,10 +99,241 @@ CCZIReader::CCZIReader() :
     }
 
     this->sub_block_directory_info_policy_ = options->subBlockDirectoryInfoPolicy;
+    this->cacheSharedSubBlockSegments = options->cache_shared_subblock_segments;
+    if (this->cacheSharedSubBlockSegments)
+    {
+        this->DetermineSharedSubBlockSegments();
+    }
 
     this->SetOperationalState(true);
 }
 
+void CCZIReader::OpenForFollowingAppendedSegments(libCZI::IStream* stream)
+{
+    if (this->hdrSegmentData.GetIsSubBlockDirectoryPositionValid())
+    {
+        // the document has a subblock-directory already, so we read it (and the attachment-directory) as usual, and scanning
+        // for segments appended later on starts after the last segment known
+        this->subBlkDir = CCZIParse::ReadSubBlockDirectory(stream, this->hdrSegmentData.GetSubBlockDirectoryPosition(), this->parseOptions);
+        if (this->hdrSegmentData.GetIsAttachmentDirectoryPositionValid())
+        {
+            this->attachmentDir = CCZIParse::ReadAttachmentsDirectory(stream, this->hdrSegmentData.GetAttachmentDirectoryPosition());
+        }
+
+        this->processedSubBlockDirectoryPosition = this->hdrSegmentData.GetSubBlockDirectoryPosition();
+        this->nextScanPosition = this->DetermineEndOfKnownSegments(stream);
+    }
+    else
+    {
+        // there is no subblock-directory (yet), so all subblocks and attachments are found by scanning the segments
+        this->subBlkDir = CCziSubBlockDirectory();
+        this->subBlkDir.AddingFinished();
+        this->attachmentDir = CCziAttachmentsDirectory();
+        this->processedSubBlockDirectoryPosition = 0;
+        this->nextScanPosition = 0;
+    }
+
+    this->ScanAppendedSegments();
+}
+
+std::uint64_t CCZIReader::DetermineEndOfKnownSegments(libCZI::IStream* stream)
+{
+    // segments do not overlap, so the segment with the largest file-position is the one which ends last
+    std::uint64_t lastSegmentPosition = this->hdrSegmentData.GetSubBlockDirectoryPosition();
+    if (this->hdrSegmentData.GetIsAttachmentDirectoryPositionValid())
+    {
+        lastSegmentPosition = (std::max)(lastSegmentPosition, this->hdrSegmentData.GetAttachmentDirectoryPosition());
+    }
+
+    if (this->hdrSegmentData.GetIsMetadataPositionPositionValid())
+    {
+        lastSegmentPosition = (std::max)(lastSegmentPosition, this->hdrSegmentData.GetMetadataPosition());
+    }
+
+    this->subBlkDir.EnumSubBlocks(
+        [&](int, const CCziSubBlockDirectory::SubBlkEntry& entry)->bool
+        {
+            lastSegmentPosition = (std::max)(lastSegmentPosition, static_cast<std::uint64_t>(entry.FilePosition));
+            return true;
+        });
+
+    this->attachmentDir.EnumAttachments(
+        [&](int, const CCziAttachmentsDirectory::AttachmentEntry& entry)->bool
+        {
+            lastSegmentPosition = (std::max)(lastSegmentPosition, static_cast<std::uint64_t>(entry.FilePosition));
+            return true;
+        });
+
+    const auto segmentSizes = CCZIParse::ReadSegmentHeaderAny(stream, lastSegmentPosition);
+    return lastSegmentPosition + sizeof(SegmentHeader) + segmentSizes.AllocatedSize;
+}
+
+int CCZIReader::ScanAppendedSegments()
+{
+    int subBlocksAdded = 0;
+    for (;;)
+    {
+        std::uint8_t segmentId[16];
+        CCZIParse::SegmentSizes segmentSizes;
+        if (!CCZIParse::TryReadHeaderOfCompleteSegment(this->stream.get(), this->nextScanPosition, segmentId, &segmentSizes))
+        {
+            // we reached the end of the document (or a segment which is not yet completely written)
+            break;
+        }
+
+        if (memcmp(segmentId, CCZIParse::SUBBLKMAGIC, sizeof(segmentId)) == 0)
+        {
+            CCZIParse::ReadDirectoryEntryOfSubBlockSegment(
+                this->stream.get(),
+                this->nextScanPosition,
+                [&](const CCziSubBlockDirectoryBase::SubBlkEntry& entry)->void
+                {
+                    this->subBlkDir.AppendSubBlock(entry);
+                    ++subBlocksAdded;
+                },
+                this->parseOptions);
+        }
+        else if (memcmp(segmentId, CCZIParse::ATTACHMENTBLKMAGIC, sizeof(segmentId)) == 0)
+        {
+            CCZIParse::ReadDirectoryEntryOfAttachmentSegment(
+                this->stream.get(),
+                this->nextScanPosition,
+                [&](const CCziAttachmentsDirectoryBase::AttachmentEntry& entry)->void
+                {
+                    this->attachmentDir.AddAttachmentEntry(entry);
+                });
+        }
+        else if (memcmp(segmentId, CCZIParse::METADATASEGMENTMAGIC, sizeof(segmentId)) == 0)
+        {
+            this->hdrSegmentData.SetMetadataPosition(this->nextScanPosition);
+        }
+
+        // all other segments (file-header, directories, deleted segments) are skipped
+        this->nextScanPosition += sizeof(SegmentHeader) + segmentSizes.AllocatedSize;
+    }
+
+    return subBlocksAdded;
+}
+
+int CCZIReader::MergeSubBlockDirectory(std::uint64_t subBlockDirectoryPosition)
+{
+    // the directory contains the entries found by scanning as well - so we index the entries we have by their file-position,
+    // and add only those entries of the directory we do not know already (which are e.g. entries referring to a segment
+    // shared with another entry)
+    unordered_multimap<std::uint64_t, int> indexByFilePosition;
+    this->subBlkDir.EnumSubBlocks(
+        [&](int index, const CCziSubBlockDirectory::SubBlkEntry& entry)->bool
+        {
+            indexByFilePosition.emplace(entry.FilePosition, index);
+            return true;
+        });
+
+    int subBlocksAdded = 0;
+    CCZIParse::ReadSubBlockDirectory(
+        this->stream.get(),
+        subBlockDirectoryPosition,
+        [&](const CCziSubBlockDirectoryBase::SubBlkEntry& entry)->void
+        {
+            const auto range = indexByFilePosition.equal_range(entry.FilePosition);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                CCziSubBlockDirectory::SubBlkEntry existingEntry;
+                this->subBlkDir.TryGetSubBlock(it->second, existingEntry);
+                if (existingEntry.mIndex == entry.mIndex && existingEntry.x == entry.x && existingEntry.y == entry.y &&
+                    CCziSubBlockDirectoryBase::CompareForEquality_Coordinate(existingEntry, entry))
+                {
+                    return;
+                }
+            }
+
+            this->subBlkDir.AppendSubBlock(entry);
+            ++subBlocksAdded;
+        },
+        this->parseOptions,
+        nullptr);
+
+    return subBlocksAdded;
+}
+
+/*virtual*/int CCZIReader::Refresh()
+{
+    this->ThrowIfNotOperational();
+    if (!this->followAppendedSegments)
+    {
+        throw logic_error("CZIReader was not opened in follow mode (c.f. 'OpenOptions::follow_appended_segments').");
+    }
+
+    int subBlocksAdded = this->ScanAppendedSegments();
+
+    // if the writer has finished in the meantime, the file-header gives the final metadata-segment and the subblock-directory
+    const auto currentHdrSegmentData = CCZIParse::ReadFileHeaderSegmentData(this->stream.get());
+    if (currentHdrSegmentData.GetIsMetadataPositionPositionValid())
+    {
+        this->hdrSegmentData.SetMetadataPosition(currentHdrSegmentData.GetMetadataPosition());
+    }
+
+    if (currentHdrSegmentData.GetIsSubBlockDirectoryPositionValid() &&
+        currentHdrSegmentData.GetSubBlockDirectoryPosition() != this->processedSubBlockDirectoryPosition)
+    {
+        subBlocksAdded += this->MergeSubBlockDirectory(currentHdrSegmentData.GetSubBlockDirectoryPosition());
+        this->processedSubBlockDirectoryPosition = currentHdrSegmentData.GetSubBlockDirectoryPosition();
+    }
+
+    if (subBlocksAdded > 0)
+    {
+        if (this->cacheSharedSubBlockSegments)
+        {
+            this->DetermineSharedSubBlockSegments();
+        }
+        else
+        {
+            unique_lock<mutex> lock(this->sharedSubBlockSegmentsMutex);
+            this->sharedSubBlockSegmentsDetermined = false;
+        }
+    }
+
+    return subBlocksAdded;
+}
+
+void CCZIReader::DetermineSharedSubBlockSegments()
+{
+    unordered_map<uint64_t, int> referenceCount;
+    this->subBlkDir.EnumSubBlocks(
+        [&](int, const CCziSubBlockDirectory::SubBlkEntry& entry)->bool
+        {
+            ++referenceCount[entry.FilePosition];
+            return true;
+        });
+
+    this->sharedSubBlockSegments.clear();
+    for (const auto& item : referenceCount)
+    {
+        if (item.second > 1)
+        {
+            this->sharedSubBlockSegments[item.first] = make_unique<SharedSubBlockSegment>();
+        }
+    }
+}
+
+bool CCZIReader::IsSharedSubBlockSegment(std::uint64_t filePosition)
+{
+    if (this->cacheSharedSubBlockSegments)
+    {
+        return this->sharedSubBlockSegments.find(filePosition) != this->sharedSubBlockSegments.cend();
+    }
+
+    // without caching, the shared segments are only determined on demand (i.e. if there is a discrepancy between
+    //  the subblock-directory and a subblock-header), so that documents without deduplication do not pay for it
+    unique_lock<mutex> lock(this->sharedSubBlockSegmentsMutex);
+    if (!this->sharedSubBlockSegmentsDetermined)
+    {
+        this->DetermineSharedSubBlockSegments();
+        this->sharedSubBlockSegmentsDetermined = true;
+    }
+
+    return this->sharedSubBlockSegments.find(filePosition) != this->sharedSubBlockSegments.cend();
+}
+
 /*virtual*/FileHeaderInfo CCZIReader::GetFileHeaderInfo()
 {
     this->ThrowIfNotOperational();
@@ -320,6 +574,37 @@ CCZIReader::CCZIReader() :
 
 std::shared_ptr<ISubBlock> CCZIReader::ReadSubBlock(const CCziSubBlockDirectory::SubBlkEntry& entry)
 {
+    // For a segment which is referenced by more than one directory-entry (i.e. a deduplicated subblock), the segment-header
+    //  describes only one of them. So, in this case the directory-entry is authoritative, and only the properties describing
+    //  the content (pixel type, compression and physical size) are checked for a discrepancy.
+    SharedSubBlockSegment* sharedSegment = nullptr;
+    if (this->cacheSharedSubBlockSegments)
+    {
+        const auto sharedSegmentIterator = this->sharedSubBlockSegments.find(entry.FilePosition);
+        sharedSegment = sharedSegmentIterator != this->sharedSubBlockSegments.cend() ? sharedSegmentIterator->second.get() : nullptr;
+    }
+
+    const bool checkForDiscrepancy = static_cast<std::underlying_type<OpenOptions::SubBlockDirectoryInfoPolicy>::type>(this->sub_block_directory_info_policy_ & OpenOptions::SubBlockDirectoryInfoPolicy::IgnoreDiscrepancy) == 0;
+    if (sharedSegment != nullptr)
+    {
+        unique_lock<mutex> lock(sharedSegment->mutex);
+        if (sharedSegment->subBlock)
+        {
+            const auto& sharedInfo = sharedSegment->subBlock->GetSubBlockInfo();
+            if (checkForDiscrepancy &&
+                (CziUtils::PixelTypeFromInt(entry.PixelType) != sharedInfo.pixelType ||
+                    entry.Compression != sharedInfo.compressionModeRaw ||
+                    entry.storedWidth != static_cast<int>(sharedInfo.physicalSize.w) || entry.storedHeight != static_cast<int>(sharedInfo.physicalSize.h)))
+            {
+                throw LibCZICZIParseException(
+                    "CZIReader::ReadSubBlock: SubBlock-directory and sub-block information do not match.",
+                    LibCZICZIParseException::ErrorCode::SubBlockDirectoryToSubBlockHeaderMismatch);
+            }
+
+            return make_shared<CCziSubBlock>(CziReaderCommon::ConvertToSubBlockInfo(entry), *sharedSegment->subBlock);
+        }
+    }
+
     const CCZIParse::SubBlockStorageAllocate allocateInfo{ ::malloc, ::free };
 
     // For thread-safety, we need to ensure that we hold a reference to the stream for the whole duration of the call, 
@@ -337,6 +622,8 @@ std::shared_ptr<ISubBlock> CCZIReader::ReadSubBlock(const CCziSubBlockDirectory:
     }
 
     auto subBlkData = CCZIParse::ReadSubBlock(stream_reference.get(), entry.FilePosition, allocateInfo);
+    this->performanceCounters->Increment(PerformanceCounter::SubBlocksRead);
+    AddToGlobalPerformanceCounter(PerformanceCounter::SubBlocksRead, 1);
 
     // RAII wrapper to ensure memory cleanup in case of exceptions
     auto dataDeleter = [freeFunc = allocateInfo.free](void* ptr) { if (ptr) { freeFunc(ptr); } };
@@ -348,15 +635,21 @@ std::shared_ptr<ISubBlock> CCZIReader::ReadSubBlock(const CCziSubBlockDirectory:
     // - whether we want to use the information from the sub-block-directory or the sub-block-header.
     // - whether we want to ignore discrepancies between the two.
 
-    if (static_cast<std::underlying_type<OpenOptions::SubBlockDirectoryInfoPolicy>::type>(this->sub_block_directory_info_policy_ & OpenOptions::SubBlockDirectoryInfoPolicy::IgnoreDiscrepancy) == 0)
+    // A discrepancy in the position (coordinate, M-index and logical rectangle) is expected for a shared segment - we
+    //  only determine whether the segment is shared if we find such a discrepancy.
+    const bool positionMatches =
+        Utils::Compare(&entry.coordinate, &subBlkData.coordinate) == 0 &&
+        Utils::IsValidMindex(entry.mIndex) == Utils::IsValidMindex(subBlkData.mIndex) && (!Utils::IsValidMindex(subBlkData.mIndex) || entry.mIndex == subBlkData.mIndex) &&
+        entry.x == subBlkData.logicalRect.x && entry.y == subBlkData.logicalRect.y && entry.width == subBlkData.logicalRect.w && entry.height == subBlkData.logicalRect.h;
+    const bool isSharedSegment = sharedSegment != nullptr || (!positionMatches && this->IsSharedSubBlockSegment(entry.FilePosition));
+
+    if (checkForDiscrepancy)
     {
         // check whether the information in the sub-block-directory and the sub-block-header match, and if not, throw an exception
         if (entry.PixelType != subBlkData.pixelType ||
             entry.Compression != subBlkData.compression ||
-            Utils::Compare(&entry.coordinate, &subBlkData.coordinate) != 0 ||
-            (Utils::IsValidMindex(entry.mIndex) != Utils::IsValidMindex(subBlkData.mIndex) || (Utils::IsValidMindex(subBlkData.mIndex) && entry.mIndex != subBlkData.mIndex)) ||
-            entry.x != subBlkData.logicalRect.x || entry.y != subBlkData.logicalRect.y || entry.width != subBlkData.logicalRect.w || entry.height != subBlkData.logicalRect.h ||
-            entry.storedWidth != static_cast<int>(subBlkData.physicalSize.w) || entry.storedHeight != static_cast<int>(subBlkData.physicalSize.h))
+            entry.storedWidth != static_cast<int>(subBlkData.physicalSize.w) || entry.storedHeight != static_cast<int>(subBlkData.physicalSize.h) ||
+            (!isSharedSegment && !positionMatches))
         {
             throw LibCZICZIParseException(
                 "CZIReader::ReadSubBlock: SubBlock-directory and sub-block information do not match.",
@@ -365,7 +658,8 @@ std::shared_ptr<ISubBlock> CCZIReader::ReadSubBlock(const CCziSubBlockDirectory:
     }
 
     libCZI::SubBlockInfo info;
-    if ((this->sub_block_directory_info_policy_ & OpenOptions::SubBlockDirectoryInfoPolicy::PrecedenceMask) == OpenOptions::SubBlockDirectoryInfoPolicy::SubBlockDirectoryPrecedence)
+    if (isSharedSegment ||
+        (this->sub_block_directory_info_policy_ & OpenOptions::SubBlockDirectoryInfoPolicy::PrecedenceMask) == OpenOptions::SubBlockDirectoryInfoPolicy::SubBlockDirectoryPrecedence)
     {
         // the sub-block-directory information takes precedence, which is the default behavior and specified to be the authoritative information.
         info.pixelType = CziUtils::PixelTypeFromInt(entry.PixelType);
@@ -394,6 +688,19 @@ std::shared_ptr<ISubBlock> CCZIReader::ReadSubBlock(const CCziSubBlockDirectory:
     attachmentGuard.release();
     metadataGuard.release();
 
+    if (sharedSegment != nullptr)
+    {
+        unique_lock<mutex> lock(sharedSegment->mutex);
+        if (sharedSegment->subBlock)
+        {
+            // another thread has read the segment concurrently, so we use its data (and its shared bitmap)
+            return make_shared<CCziSubBlock>(info, *sharedSegment->subBlock);
+        }
+
+        sub_block->SetSharedBitmap(make_shared<CCziSubBlock::SharedBitmap>());
+        sharedSegment->subBlock = sub_block;
+    }
+
     return sub_block;
 }
 
@@ -444,6 +751,11 @@ std::shared_ptr<libCZI::IMetadataSegment> CCZIReader::ReadMetadataSegment(std::u
     return std::make_shared<CCziMetadataSegment>(metaDataSegmentData, free);
 }
 
+/*virtual*/libCZI::PerformanceCountersSnapshot CCZIReader::GetPerformanceCounters()
+{
+    return this->performanceCounters->GetSnapshot();
+}
+
 void CCZIReader::ThrowIfNotOperational() const
 {
     if (this->isOperational == false)
@@ -7,10 +7,14 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include "libCZI.h"
 #include "CziSubBlockDirectory.h"
 #include "CziAttachmentsDirectory.h"
 #include "FileHeaderSegmentData.h"
+#include "CziSubBlock.h"
+#include "CziParse.h"
+#include "Instrumentation.h"
 
 namespace libCZI
 {
@@ -28,6 +32,43 @@ namespace libCZI
             bool    isOperational;  ///<    If true, then stream, hdrSegmentData and subBlkDir can be considered valid and operational
             libCZI::CZIFrameOfReference default_frame_of_reference;
             libCZI::ICZIReader::OpenOptions::SubBlockDirectoryInfoPolicy sub_block_directory_info_policy_;
+
+            /// A subblock-segment which is referenced by more than one entry in the subblock-directory (which is the case
+            /// for deduplicated subblocks).
+            struct SharedSubBlockSegment
+            {
+                std::mutex mutex;                           ///< Mutex protecting access to "subBlock".
+                std::shared_ptr<CCziSubBlock> subBlock;     ///< The subblock read from the segment (if caching is enabled and it has been read already).
+            };
+
+            /// The shared subblock-segments (with their file-position as key). If caching is enabled, this map is populated in "Open" (and
+            /// updated in "Refresh") and not modified otherwise, so it can be accessed concurrently. Otherwise, it is only populated
+            /// (guarded by "sharedSubBlockSegmentsMutex") when a discrepancy between a subblock-directory entry and its subblock-header
+            /// is found, in order to determine whether this is due to the segment being shared.
+            std::unordered_map<std::uint64_t, std::unique_ptr<SharedSubBlockSegment>> sharedSubBlockSegments;
+            bool cacheSharedSubBlockSegments;
+
+            /// Mutex protecting "sharedSubBlockSegments" and "sharedSubBlockSegmentsDetermined" if caching is disabled.
+            std::mutex sharedSubBlockSegmentsMutex;
+
+            /// If caching is disabled, this indicates whether "sharedSubBlockSegments" is up-to-date.
+            bool sharedSubBlockSegmentsDetermined;
+
+            /// If true, then the document was opened in "follow mode" (c.f. "OpenOptions::follow_appended_segments").
+            bool followAppendedSegments;
+
+            /// The parse-options used when opening the document (which are also used for the segments found with "Refresh").
+            CCZIParse::SubblockDirectoryParseOptions parseOptions;
+
+            /// In follow mode, the file-position where scanning for appended segments continues.
+            std::uint64_t nextScanPosition;
+
+            /// In follow mode, the file-position of the subblock-directory which has been merged into our subblock-directory
+            /// (or 0 if there was none so far).
+            std::uint64_t processedSubBlockDirectoryPosition;
+
+            /// The performance counters of this reader (which are shared with the instrumented stream wrapping the stream passed to "Open").
+            std::shared_ptr<PerformanceCounters> performanceCounters;
         public:
             CCZIReader();
             ~CCZIReader() override = default;
@@ -50,6 +91,8 @@ namespace libCZI
             libCZI::FileHeaderInfo GetFileHeaderInfo() override;
             std::shared_ptr<libCZI::IMetadataSegment> ReadMetadataSegment() override;
             std::shared_ptr<libCZI::IAccessor> CreateAccessor(libCZI::AccessorType accessorType) override;
+            int Refresh() override;
+            libCZI::PerformanceCountersSnapshot GetPerformanceCounters() override;
             void Close() override;
 
             // interface IAttachmentRepository
@@ -64,6 +107,14 @@ namespace libCZI
             std::shared_ptr<libCZI::IAttachment> ReadAttachment(const CCziAttachmentsDirectory::AttachmentEntry& entry);
             std::shared_ptr<libCZI::IMetadataSegment> ReadMetadataSegment(std::uint64_t position);
 
+            void DetermineSharedSubBlockSegments();
+            bool IsSharedSubBlockSegment(std::uint64_t filePosition);
+
+            void OpenForFollowingAppendedSegments(libCZI::IStream* stream);
+            std::uint64_t DetermineEndOfKnownSegments(libCZI::IStream* stream);
+            int ScanAppendedSegments();
+            int MergeSubBlockDirectory(std::uint64_t subBlockDirectoryPosition);
+
             void ThrowIfNotOperational() const;
             void SetOperationalState(bool operational);
         };
@@ -9,6 +9,7 @@
 #include "inc_libCZI_Config.h"
 #include "CziSubBlock.h"
 #include "decoder_zstd.h"
+#include "Instrumentation.h"
 
 using namespace libCZI;
 using namespace libCZI::detail;
@@ -177,11 +178,20 @@ std::shared_ptr<libCZI::IBitmapData> libCZI::CreateBitmapFromSubBlock(ISubBlock*
     switch (subBlk->GetSubBlockInfo().GetCompressionMode())
     {
     case CompressionMode::JpgXr:
+    {
+        ScopedPerformanceTimer timer(PerformanceTimer::DecodeJpgXr);
         return CreateBitmapFromSubBlock_JpgXr(subBlk, options != nullptr ? options->handle_jpgxr_bitmap_mismatch : true);
+    }
     case CompressionMode::Zstd0:
+    {
+        ScopedPerformanceTimer timer(PerformanceTimer::DecodeZStd0);
         return CreateBitmapFromSubBlock_ZStd0(subBlk, options != nullptr ? options->handle_zstd_data_size_mismatch : true);
+    }
     case CompressionMode::Zstd1:
+    {
+        ScopedPerformanceTimer timer(PerformanceTimer::DecodeZStd1);
         return CreateBitmapFromSubBlock_ZStd1(subBlk, options != nullptr ? options->handle_zstd_data_size_mismatch : true);
+    }
     case CompressionMode::UnCompressed:
         return CreateBitmapFromSubBlock_Uncompressed(subBlk, options != nullptr ? options->handle_uncompressed_data_size_mismatch : true);
     default:    // silence warnings
@@ -0,0 +1,305 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "CziCompaction.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include "inc_libCZI_Config.h"
+#include "utilities.h"
+#if LIBCZI_WINDOWSAPI_AVAILABLE
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace libCZI;
+using namespace libCZI::detail;
+
+/*static*/libCZI::CompactCziStatistics CCziCompaction::Compact(const std::shared_ptr<libCZI::IStream>& source, const std::shared_ptr<libCZI::IOutputStream>& destination, const libCZI::CompactCziOptions& options)
+{
+    if (!source)
+    {
+        throw invalid_argument("source");
+    }
+
+    if (!destination)
+    {
+        throw invalid_argument("destination");
+    }
+
+    const auto reader = CreateCZIReader();
+    reader->Open(source);
+
+    CZIWriterOptions writer_options;
+
+    // we copy the document as it is, so duplicate subblocks in the source are to be retained
+    writer_options.allow_duplicate_subblocks = true;
+    writer_options.subblock_layout = options.subblock_layout;
+    writer_options.deduplicate_subblocks = options.deduplicate_subblocks;
+    const auto writer = CreateCZIWriter(&writer_options);
+
+    const GUID file_guid = options.keep_file_guid ? reader->GetFileHeaderInfo().fileGuid : options.file_guid;
+    writer->Create(destination, make_shared<CCziWriterInfo>(file_guid));
+
+    CompactCziStatistics statistics;
+    statistics.subblock_count = CCziCompaction::CopySubBlocks(reader.get(), writer.get());
+    statistics.attachment_count = CCziCompaction::CopyAttachments(reader.get(), writer.get());
+    statistics.metadata_segment_copied = CCziCompaction::CopyMetadata(reader.get(), writer.get());
+
+    // note that with a spatial layout, the subblocks are only written out here
+    writer->Close();
+    reader->Close();
+    return statistics;
+}
+
+/*static*/libCZI::CompactCziStatistics CCziCompaction::CompactFile(std::shared_ptr<libCZI::IStream> source, const wchar_t* destination_filename, const libCZI::CompactCziOptions& options)
+{
+    if (destination_filename == nullptr)
+    {
+        throw invalid_argument("destination_filename");
+    }
+
+    const wstring destination(destination_filename);
+    const wstring temporary_filename = destination + L".partial";
+    try
+    {
+        // the output-stream is destroyed (and the file is closed) at the end of this statement
+        const auto statistics = CCziCompaction::Compact(source, CreateOutputStreamForFile(temporary_filename.c_str(), true), options);
+
+        // release the source, so that the file it refers to is closed before it is replaced (in case it is the destination)
+        source.reset();
+
+        // the content of the temporary file must be on disk before the rename, otherwise the destination may end up
+        //  truncated or empty after a power loss
+        CCziCompaction::FlushFileToDisk(temporary_filename);
+        CCziCompaction::ReplaceFileAtomically(temporary_filename, destination);
+        return statistics;
+    }
+    catch (...)
+    {
+        CCziCompaction::TryDeleteFile(temporary_filename);
+        throw;
+    }
+}
+
+/*static*/int CCziCompaction::CopySubBlocks(libCZI::ICZIReader* reader, libCZI::ICziWriter* writer)
+{
+    int count = 0;
+    reader->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            const auto sub_block = reader->ReadSubBlock(index);
+
+            AddSubBlockInfo add_info;
+            add_info.Clear();
+            add_info.coordinate = info.coordinate;
+            add_info.mIndexValid = info.IsMindexValid();
+            add_info.mIndex = info.mIndex;
+            add_info.x = info.logicalRect.x;
+            add_info.y = info.logicalRect.y;
+            add_info.logicalWidth = info.logicalRect.w;
+            add_info.logicalHeight = info.logicalRect.h;
+            add_info.physicalWidth = info.physicalSize.w;
+            add_info.physicalHeight = info.physicalSize.h;
+            add_info.PixelType = info.pixelType;
+            add_info.pyramid_type = info.pyramidType;
+            add_info.compressionModeRaw = info.compressionModeRaw;
+
+            const void* ptr;
+            size_t size;
+            sub_block->DangerousGetRawData(ISubBlock::MemBlkType::Data, ptr, size);
+            add_info.sizeData = size;
+            add_info.getData = CCziCompaction::CreateGetDataFunctor(ptr, size);
+            sub_block->DangerousGetRawData(ISubBlock::MemBlkType::Metadata, ptr, size);
+            add_info.sizeMetadata = size;
+            add_info.getMetaData = CCziCompaction::CreateGetDataFunctor(ptr, size);
+            sub_block->DangerousGetRawData(ISubBlock::MemBlkType::Attachment, ptr, size);
+            add_info.sizeAttachment = size;
+            add_info.getAttachment = CCziCompaction::CreateGetDataFunctor(ptr, size);
+
+            writer->SyncAddSubBlock(add_info);
+            ++count;
+            return true;
+        });
+
+    return count;
+}
+
+/*static*/int CCziCompaction::CopyAttachments(libCZI::ICZIReader* reader, libCZI::ICziWriter* writer)
+{
+    int count = 0;
+    reader->EnumerateAttachments(
+        [&](int index, const AttachmentInfo& info)->bool
+        {
+            const auto attachment = reader->ReadAttachment(index);
+
+            AddAttachmentInfo add_info;
+            add_info.Clear();
+            add_info.contentGuid = info.contentGuid;
+            add_info.SetContentFileType(info.contentFileType);
+            add_info.SetName(info.name.c_str());
+
+            const void* ptr;
+            size_t size;
+            attachment->DangerousGetRawData(ptr, size);
+            if (size > (numeric_limits<uint32_t>::max)())
+            {
+                throw runtime_error("The size of an attachment exceeds the maximum supported size.");
+            }
+
+            add_info.ptrData = ptr;
+            add_info.dataSize = static_cast<uint32_t>(size);
+            writer->SyncAddAttachment(add_info);
+            ++count;
+            return true;
+        });
+
+    return count;
+}
+
+/*static*/bool CCziCompaction::CopyMetadata(libCZI::ICZIReader* reader, libCZI::ICziWriter* writer)
+{
+    shared_ptr<IMetadataSegment> metadata_segment;
+    try
+    {
+        metadata_segment = reader->ReadMetadataSegment();
+    }
+    catch (LibCZISegmentNotPresent&)
+    {
+        // the source document has no metadata-segment, so there is nothing to copy
+        return false;
+    }
+
+    WriteMetadataInfo metadata_info;
+    metadata_info.Clear();
+    const void* ptr;
+    size_t size;
+    metadata_segment->DangerousGetRawData(IMetadataSegment::MemBlkType::XmlMetadata, ptr, size);
+    metadata_info.szMetadata = static_cast<const char*>(ptr);
+    metadata_info.szMetadataSize = size;
+    metadata_segment->DangerousGetRawData(IMetadataSegment::MemBlkType::Attachment, ptr, size);
+    metadata_info.ptrAttachment = ptr;
+    metadata_info.attachmentSize = size;
+    writer->SyncWriteMetadata(metadata_info);
+    return true;
+}
+
+/*static*/std::function<bool(int callCnt, size_t offset, const void*& ptr, size_t& size)> CCziCompaction::CreateGetDataFunctor(const void* ptrData, size_t sizeData)
+{
+    return
+        [=](int, size_t offset, const void*& ptr, size_t& size)->bool
+        {
+            if (offset >= sizeData)
+            {
+                return false;
+            }
+
+            ptr = static_cast<const uint8_t*>(ptrData) + offset;
+            size = sizeData - offset;
+            return true;
+        };
+}
+
+/*static*/void CCziCompaction::FlushFileToDisk(const std::wstring& filename)
+{
+#if LIBCZI_WINDOWSAPI_AVAILABLE
+    const HANDLE handle = CreateFileW(filename.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        ostringstream ss;
+        ss << "Error opening the file \"" << Utilities::convertWchar_tToUtf8(filename.c_str()) << "\" (GetLastError=" << GetLastError() << ")";
+        throw runtime_error(ss.str());
+    }
+
+    const BOOL success = FlushFileBuffers(handle);
+    const DWORD last_error = GetLastError();
+    CloseHandle(handle);
+    if (success == FALSE)
+    {
+        ostringstream ss;
+        ss << "Error flushing the file \"" << Utilities::convertWchar_tToUtf8(filename.c_str()) << "\" (GetLastError=" << last_error << ")";
+        throw runtime_error(ss.str());
+    }
+#else
+    const auto filename_utf8 = Utilities::convertWchar_tToUtf8(filename.c_str());
+    const int file_descriptor = open(filename_utf8.c_str(), O_RDWR);
+    if (file_descriptor < 0)
+    {
+        const auto err = errno;
+        ostringstream ss;
+        ss << "Error opening the file \"" << filename_utf8 << "\" -> errno=" << err << " (" << strerror(err) << ")";
+        throw runtime_error(ss.str());
+    }
+
+    const int r = fsync(file_descriptor);
+    const auto err = errno;
+    close(file_descriptor);
+    if (r != 0)
+    {
+        ostringstream ss;
+        ss << "Error flushing the file \"" << filename_utf8 << "\" -> errno=" << err << " (" << strerror(err) << ")";
+        throw runtime_error(ss.str());
+    }
+#endif
+}
+
+/*static*/void CCziCompaction::ReplaceFileAtomically(const std::wstring& source, const std::wstring& destination)
+{
+#if LIBCZI_WINDOWSAPI_AVAILABLE
+    if (MoveFileExW(source.c_str(), destination.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) == FALSE)
+    {
+        ostringstream ss;
+        ss << "Error renaming the file \"" << Utilities::convertWchar_tToUtf8(source.c_str()) << "\" to \"" << Utilities::convertWchar_tToUtf8(destination.c_str()) << "\" (GetLastError=" << GetLastError() << ")";
+        throw runtime_error(ss.str());
+    }
+#else
+    const auto source_utf8 = Utilities::convertWchar_tToUtf8(source.c_str());
+    const auto destination_utf8 = Utilities::convertWchar_tToUtf8(destination.c_str());
+    if (rename(source_utf8.c_str(), destination_utf8.c_str()) != 0)
+    {
+        const auto err = errno;
+        ostringstream ss;
+        ss << "Error renaming the file \"" << source_utf8 << "\" to \"" << destination_utf8 << "\" -> errno=" << err << " (" << strerror(err) << ")";
+        throw runtime_error(ss.str());
+    }
+
+    // the rename is only persistent once the directory containing the file has been flushed
+    const auto position_of_last_separator = destination_utf8.find_last_of('/');
+    const string directory = position_of_last_separator == string::npos ? string(".") :
+        (position_of_last_separator == 0 ? string("/") : destination_utf8.substr(0, position_of_last_separator));
+    const int directory_descriptor = open(directory.c_str(), O_RDONLY);
+    if (directory_descriptor < 0)
+    {
+        const auto err = errno;
+        ostringstream ss;
+        ss << "Error opening the directory \"" << directory << "\" -> errno=" << err << " (" << strerror(err) << ")";
+        throw runtime_error(ss.str());
+    }
+
+    const int r = fsync(directory_descriptor);
+    const auto err = errno;
+    close(directory_descriptor);
+    if (r != 0)
+    {
+        ostringstream ss;
+        ss << "Error flushing the directory \"" << directory << "\" -> errno=" << err << " (" << strerror(err) << ")";
+        throw runtime_error(ss.str());
+    }
+#endif
+}
+
+/*static*/void CCziCompaction::TryDeleteFile(const std::wstring& filename)
+{
+#if LIBCZI_WINDOWSAPI_AVAILABLE
+    DeleteFileW(filename.c_str());
+#else
+    remove(Utilities::convertWchar_tToUtf8(filename.c_str()).c_str());
+#endif
+}
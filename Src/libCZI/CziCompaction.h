@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "libCZI.h"
+
+namespace libCZI
+{
+    namespace detail
+    {
+        /// This class implements the operation "libCZI::CompactCzi" - the source is read with a CZI-reader, and all subblocks,
+        /// attachments and the metadata-segment are copied (without re-encoding) into a new document with a CZI-writer.
+        class CCziCompaction
+        {
+        public:
+            static libCZI::CompactCziStatistics Compact(const std::shared_ptr<libCZI::IStream>& source, const std::shared_ptr<libCZI::IOutputStream>& destination, const libCZI::CompactCziOptions& options);
+
+            /// Implements the operation "libCZI::CompactCziFile" - the document is compacted into a temporary file, which is
+            /// flushed to disk and then replaces the destination file.
+            static libCZI::CompactCziStatistics CompactFile(std::shared_ptr<libCZI::IStream> source, const wchar_t* destination_filename, const libCZI::CompactCziOptions& options);
+
+            /// Implements the operation "libCZI::CopyAttachments".
+            static int CopyAttachments(libCZI::ICZIReader* reader, libCZI::ICziWriter* writer);
+
+            /// Implements the operation "libCZI::CopyMetadataSegment".
+            static bool CopyMetadata(libCZI::ICZIReader* reader, libCZI::ICziWriter* writer);
+        private:
+            static int CopySubBlocks(libCZI::ICZIReader* reader, libCZI::ICziWriter* writer);
+
+            /// Creates a functor (for use with "AddSubBlockInfo") which delivers the specified memory-block in one piece.
+            static std::function<bool(int callCnt, size_t offset, const void*& ptr, size_t& size)> CreateGetDataFunctor(const void* ptrData, size_t sizeData);
+
+            /// Writes all buffered data of the specified file to the storage device.
+            static void FlushFileToDisk(const std::wstring& filename);
+
+            /// Renames the file "source" to "destination", where an existing file "destination" is replaced atomically. On
+            /// POSIX-systems, the directory containing "destination" is flushed afterwards, so that the rename is persistent.
+            static void ReplaceFileAtomically(const std::wstring& source, const std::wstring& destination);
+
+            /// Deletes the specified file, errors are ignored.
+            static void TryDeleteFile(const std::wstring& filename);
+        };
+    } // namespace detail
+} // namespace libCZI
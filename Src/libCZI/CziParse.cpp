@@ -836,6 +836,181 @@ using namespace libCZI::detail;
     return true;
 }
 
+/*static*/bool CCZIParse::TryReadHeaderOfCompleteSegment(libCZI::IStream* str, std::uint64_t pos, std::uint8_t* segmentId, SegmentSizes* segmentSizes)
+{
+    SegmentHeader segmentHdr;
+    std::uint64_t bytesRead;
+    try
+    {
+        str->Read(pos, &segmentHdr, sizeof(segmentHdr), &bytesRead);
+    }
+    catch (const std::exception&)
+    {
+        std::throw_with_nested(LibCZIIOException("Error reading SegmentHeader", pos, sizeof(segmentHdr)));
+    }
+
+    if (bytesRead != sizeof(segmentHdr))
+    {
+        return false;
+    }
+
+    // a segment-Id consisting of zeroes only indicates that the segment-header has not been written (yet)
+    static const std::uint8_t ZeroId[sizeof(segmentHdr.Id)] = {};
+    if (memcmp(segmentHdr.Id, ZeroId, sizeof(segmentHdr.Id)) == 0)
+    {
+        return false;
+    }
+
+    ConvertToHostByteOrder::Convert(&segmentHdr);
+    if (segmentHdr.AllocatedSize < 0 || segmentHdr.UsedSize < 0 || segmentHdr.UsedSize > segmentHdr.AllocatedSize)
+    {
+        return false;
+    }
+
+    // a used size of zero means that the whole allocated size is in use
+    const std::int64_t usedSize = segmentHdr.UsedSize > 0 ? segmentHdr.UsedSize : segmentHdr.AllocatedSize;
+    if (usedSize > 0)
+    {
+        // check whether the last byte of the segment's data is present
+        std::uint8_t lastByte;
+        try
+        {
+            str->Read(pos + sizeof(segmentHdr) + usedSize - 1, &lastByte, 1, &bytesRead);
+        }
+        catch (const std::exception&)
+        {
+            std::throw_with_nested(LibCZIIOException("Error reading segment data", pos + sizeof(segmentHdr) + usedSize - 1, 1));
+        }
+
+        if (bytesRead != 1)
+        {
+            return false;
+        }
+    }
+
+    if (segmentId != nullptr)
+    {
+        memcpy(segmentId, segmentHdr.Id, sizeof(segmentHdr.Id));
+    }
+
+    if (segmentSizes != nullptr)
+    {
+        segmentSizes->AllocatedSize = segmentHdr.AllocatedSize;
+        segmentSizes->UsedSize = segmentHdr.UsedSize;
+    }
+
+    return true;
+}
+
+/*static*/void CCZIParse::ReadDirectoryEntryOfSubBlockSegment(libCZI::IStream* str, std::uint64_t offset, const std::function<void(const CCziSubBlockDirectoryBase::SubBlkEntry&)>& addFunc, const SubblockDirectoryParseOptions& options)
+{
+    SubBlockSegment subBlckSegment;
+    std::uint64_t bytesRead;
+    const uint64_t MinSizeSubBlockSegment = sizeof(SegmentHeader) + SIZE_SUBBLOCKDATA_MINIMUM;
+    try
+    {
+        str->Read(offset, &subBlckSegment, MinSizeSubBlockSegment, &bytesRead);
+    }
+    catch (const std::exception&)
+    {
+        std::throw_with_nested(LibCZIIOException("Error reading SubBlock-Segment", offset, MinSizeSubBlockSegment));
+    }
+
+    if (bytesRead != MinSizeSubBlockSegment)
+    {
+        CCZIParse::ThrowNotEnoughDataRead(offset, MinSizeSubBlockSegment, bytesRead);
+    }
+
+    ConvertToHostByteOrder::Convert(&subBlckSegment);
+    if (memcmp(subBlckSegment.header.Id, CCZIParse::SUBBLKMAGIC, 16) != 0)
+    {
+        CCZIParse::ThrowIllegalData(offset, "Invalid SubBlock-magic");
+    }
+
+    if (subBlckSegment.data.entrySchema[0] != 'D' || subBlckSegment.data.entrySchema[1] != 'V')
+    {
+        CCZIParse::ThrowIllegalData(offset, "Unsupported schema of the directory-entry in the SubBlock-segment");
+    }
+
+    ConvertToHostByteOrder::Convert(&subBlckSegment.data.entryDV);
+    if (subBlckSegment.data.entryDV.DimensionCount > MAXDIMENSIONS)
+    {
+        CCZIParse::ThrowIllegalData(
+            offset + sizeof(SegmentHeader) + SIZE_SUBBLOCKDATA_FIXEDPART + offsetof(SubBlockDirectoryEntryDV, DimensionCount),
+            "Invalid 'DimensionCount'");
+    }
+
+    const uint64_t lengthSubblockSegmentData = SIZE_SUBBLOCKDATA_FIXEDPART + 32 + subBlckSegment.data.entryDV.DimensionCount * sizeof(DimensionEntryDV);
+    if (lengthSubblockSegmentData + sizeof(SegmentHeader) > MinSizeSubBlockSegment)
+    {
+        const uint64_t remainingBytesToRead = lengthSubblockSegmentData + sizeof(SegmentHeader) - MinSizeSubBlockSegment;
+        try
+        {
+            str->Read(offset + MinSizeSubBlockSegment, reinterpret_cast<uint8_t*>(&subBlckSegment) + MinSizeSubBlockSegment, remainingBytesToRead, &bytesRead);
+        }
+        catch (const std::exception&)
+        {
+            std::throw_with_nested(LibCZIIOException("Error reading additional data from SubBlock-Segment", offset + MinSizeSubBlockSegment, remainingBytesToRead));
+        }
+
+        if (bytesRead != remainingBytesToRead)
+        {
+            CCZIParse::ThrowNotEnoughDataRead(offset + MinSizeSubBlockSegment, remainingBytesToRead, bytesRead);
+        }
+    }
+
+    ConvertToHostByteOrder::Convert(subBlckSegment.data.entryDV.DimensionEntries, subBlckSegment.data.entryDV.DimensionCount);
+    CCZIParse::AddEntryToSubBlockDirectory(
+        &subBlckSegment.data.entryDV,
+        [&](const CCziSubBlockDirectoryBase::SubBlkEntry& entry)->void
+        {
+            // the file-position in the embedded entry is not meaningful, so we set it to the position of the segment
+            CCziSubBlockDirectoryBase::SubBlkEntry entryWithFilePosition = entry;
+            entryWithFilePosition.FilePosition = offset;
+            addFunc(entryWithFilePosition);
+        },
+        options);
+}
+
+/*static*/void CCZIParse::ReadDirectoryEntryOfAttachmentSegment(libCZI::IStream* str, std::uint64_t offset, const std::function<void(const CCziAttachmentsDirectoryBase::AttachmentEntry&)>& addFunc)
+{
+    AttachmentSegment attchmntSegment;
+    std::uint64_t bytesRead;
+    try
+    {
+        str->Read(offset, &attchmntSegment, sizeof(attchmntSegment), &bytesRead);
+    }
+    catch (const std::exception&)
+    {
+        std::throw_with_nested(LibCZIIOException("Error reading Attachment-Segment", offset, sizeof(attchmntSegment)));
+    }
+
+    if (bytesRead != sizeof(attchmntSegment))
+    {
+        CCZIParse::ThrowNotEnoughDataRead(offset, sizeof(attchmntSegment), bytesRead);
+    }
+
+    ConvertToHostByteOrder::Convert(&attchmntSegment);
+    if (memcmp(attchmntSegment.header.Id, CCZIParse::ATTACHMENTBLKMAGIC, 16) != 0)
+    {
+        CCZIParse::ThrowIllegalData(offset, "Invalid Attachment-magic");
+    }
+
+    const AttachmentEntryA1* pSrc = &attchmntSegment.data.entry;
+    if (!CheckAttachmentSchemaType(reinterpret_cast<const char*>(&pSrc->SchemaType[0]), 2))
+    {
+        CCZIParse::ThrowIllegalData(offset, "Unsupported schema of the directory-entry in the Attachment-segment");
+    }
+
+    CCziAttachmentsDirectoryBase::AttachmentEntry ae;
+    ae.FilePosition = offset;
+    ae.ContentGuid = pSrc->ContentGuid;
+    memcpy(&ae.ContentFileType[0], &pSrc->ContentFileType[0], sizeof(AttachmentEntryA1::ContentFileType));
+    memcpy(&ae.Name[0], &pSrc->Name[0], sizeof(AttachmentEntryA1::Name));
+    ae.Name[sizeof(AttachmentEntryA1::Name) - 1] = '\0';
+    addFunc(ae);
+}
+
 /*static*/CCZIParse::SegmentSizes CCZIParse::ReadSegmentHeader(CCZIParse::SegmentType type, libCZI::IStream* str, std::uint64_t pos)
 {
     const std::uint8_t* pMagic;
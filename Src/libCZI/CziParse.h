@@ -205,6 +205,35 @@ namespace libCZI
 
             static CCZIParse::SegmentSizes ReadSegmentHeader(SegmentType type, libCZI::IStream* str, std::uint64_t pos);
             static CCZIParse::SegmentSizes ReadSegmentHeaderAny(libCZI::IStream* str, std::uint64_t pos);
+
+            /// Reads the segment-header at the specified position and checks whether the segment is complete, i.e. whether all of its
+            /// data (as given by the used size) is present in the stream. This is used for scanning a document which is still being
+            /// written, where the last segment may be only partially written (or not at all).
+            ///
+            /// \param [in]  str          The stream to read from.
+            /// \param       pos          The position of the segment-header.
+            /// \param [out] segmentId    If non-null, the segment-Id (16 bytes) is copied here.
+            /// \param [out] segmentSizes If non-null, the sizes of the segment are put here.
+            ///
+            /// \returns True if a complete segment was found at the specified position; false otherwise.
+            static bool TryReadHeaderOfCompleteSegment(libCZI::IStream* str, std::uint64_t pos, std::uint8_t* segmentId, SegmentSizes* segmentSizes);
+
+            /// Reads the directory-entry which is embedded in the subblock-segment at the specified position. The entry passed
+            /// to "addFunc" has its file-position set to the position of the segment.
+            ///
+            /// \param [in] str     The stream to read from.
+            /// \param      offset  The position of the subblock-segment.
+            /// \param      addFunc The function which is called with the directory-entry.
+            /// \param      options Options controlling the parsing of the directory-entry.
+            static void ReadDirectoryEntryOfSubBlockSegment(libCZI::IStream* str, std::uint64_t offset, const std::function<void(const CCziSubBlockDirectoryBase::SubBlkEntry&)>& addFunc, const SubblockDirectoryParseOptions& options);
+
+            /// Reads the directory-entry which is embedded in the attachment-segment at the specified position. The entry passed
+            /// to "addFunc" has its file-position set to the position of the segment.
+            ///
+            /// \param [in] str     The stream to read from.
+            /// \param      offset  The position of the attachment-segment.
+            /// \param      addFunc The function which is called with the directory-entry.
+            static void ReadDirectoryEntryOfAttachmentSegment(libCZI::IStream* str, std::uint64_t offset, const std::function<void(const CCziAttachmentsDirectoryBase::AttachmentEntry&)>& addFunc);
         private:
             static void ParseThroughDirectoryEntries(int count, const std::function<void(int, void*)>& funcRead, const std::function<void(const SubBlockDirectoryEntryDE*, const SubBlockDirectoryEntryDV*)>& funcAddEntry);
 
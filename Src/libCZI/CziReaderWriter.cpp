@@ -12,6 +12,7 @@
 #include "CziSubBlock.h"
 #include "CziAttachment.h"
 #include "CziReaderCommon.h"
+#include "StreamImpl.h"
 
 using namespace libCZI;
 using namespace libCZI::detail;
@@ -78,6 +79,26 @@ void ICziReaderWriter::ReplaceSubBlock(int key, const libCZI::AddSubBlockInfoStr
 //--------------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------------
 
+CCziReaderWriter::CCziReaderWriter(const libCZI::CZIReaderWriterOptions& options) : readerWriterOptions(options)
+{
+}
+
+CCziReaderWriter::~CCziReaderWriter()
+{
+    // Without "Close", the document is not finalized - but the data which has been written so far is put out (on a best-effort
+    //  basis), so that the state of the stream is the same as without write-combining.
+    if (this->writeCombiningStream)
+    {
+        try
+        {
+            this->writeCombiningStream->Flush();
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
 /*virtual*/void CCziReaderWriter::Create(std::shared_ptr<libCZI::IInputOutputStream> stream, std::shared_ptr<libCZI::ICziReaderWriterInfo> info)
 {
     this->ThrowIfAlreadyInitialized();
@@ -90,7 +111,18 @@ void ICziReaderWriter::ReplaceSubBlock(int key, const libCZI::AddSubBlockInfoStr
         this->info = info;
     }
 
-    this->stream = stream;
+    if (this->readerWriterOptions.write_combining_buffer_size > 0 &&
+        (this->readerWriterOptions.use_write_combining_buffer_for_all_streams || IsStockFileInputOutputStream(stream.get())))
+    {
+        // we coalesce the (many small) write-operations with a write-combining buffer
+        this->writeCombiningStream = make_shared<CWriteCombiningInputOutputStream>(stream, this->readerWriterOptions.write_combining_buffer_size);
+        this->stream = this->writeCombiningStream;
+    }
+    else
+    {
+        this->stream = stream;
+    }
+
     try
     {
         this->ReadCziStructure();
@@ -98,6 +130,7 @@ void ICziReaderWriter::ReplaceSubBlock(int key, const libCZI::AddSubBlockInfoStr
     catch (...)
     {
         this->stream.reset();
+        this->writeCombiningStream.reset();
         this->info.reset();
         throw;
     }
@@ -191,6 +224,12 @@ void ICziReaderWriter::ReplaceSubBlock(int key, const libCZI::AddSubBlockInfoStr
         throw LibCZIReaderWriteException("invalid id specified in \"RemoveSubBlock\"", LibCZIReaderWriteException::ErrorType::InvalidSubBlkId);
     }
 
+    if (this->ReleaseSharedSubBlockSegment(sbEntryExisting.FilePosition))
+    {
+        // the segment is still referenced by another directory-entry
+        return;
+    }
+
     CWriterUtils::MarkDeletedInfo mdi;
     mdi.segmentPos = sbEntryExisting.FilePosition;
     mdi.writeFunc = std::bind(&CCziReaderWriter::WriteToOutputStream, this, placeholders::_1, placeholders::_2, placeholders::_3, placeholders::_4, placeholders::_5);
@@ -244,15 +283,40 @@ void ICziReaderWriter::ReplaceSubBlock(int key, const libCZI::AddSubBlockInfoStr
     return metaDataSegment;
 }
 
+/*virtual*/void CCziReaderWriter::Commit()
+{
+    this->ThrowIfNotOperational();
+    this->Finish();
+    this->FlushWriteCombiningBuffer();
+}
+
 /*virtual*/void CCziReaderWriter::Close()
 {
     this->ThrowIfNotOperational();
     this->Finish();
+    this->FlushWriteCombiningBuffer();
+}
+
+void CCziReaderWriter::FlushWriteCombiningBuffer()
+{
+    if (this->writeCombiningStream)
+    {
+        try
+        {
+            this->writeCombiningStream->Flush();
+        }
+        catch (const std::exception&)
+        {
+            std::throw_with_nested(LibCZIIOException("Error writing the write-combining buffer to the output-stream", 0, 0));
+        }
+    }
 }
 
 void CCziReaderWriter::Finish()
 {
-    if (this->sbBlkDirectory.IsModified())
+    this->UpdateHeadersOfFormerlySharedSubBlockSegments();
+
+    if (this->sbBlkDirectory.IsModified() && !this->TryUpdateSubBlockDirectoryInPlace())
     {
         this->EnsureNextSegmentInfo();
         CWriterUtils::SubBlkDirWriteInfo sbBlkDirWriteInfo;
@@ -270,6 +334,7 @@ void CCziReaderWriter::Finish()
         }
 
         sbBlkDirWriteInfo.segmentPosForNewSegment = this->nextSegmentInfo.GetNextSegmentPos();
+        sbBlkDirWriteInfo.reserveForNewSegment = this->CalcReserveForSubBlockDirectory();
         sbBlkDirWriteInfo.enumEntriesFunc = [&](const std::function<void(size_t, const CCziSubBlockDirectoryBase::SubBlkEntry&)>& f)->void
             {
                 this->sbBlkDirectory.EnumEntries(
@@ -333,6 +398,46 @@ void CCziReaderWriter::Finish()
     {
         this->UpdateFileHeader();
     }
+
+    if (this->sbBlkDirectory.IsModified())
+    {
+        this->sbBlkDirectory.SetPersisted();
+    }
+
+    this->attachmentDirectory.SetModified(false);
+}
+
+bool CCziReaderWriter::TryUpdateSubBlockDirectoryInPlace()
+{
+    if (!this->subBlockDirectorySegment.IsValid() || !this->sbBlkDirectory.IsIncrementalUpdatePossible())
+    {
+        return false;
+    }
+
+    CWriterUtils::SubBlkDirUpdateInfo updateInfo;
+    updateInfo.segmentPos = this->subBlockDirectorySegment.GetFilePos();
+    updateInfo.allocatedSize = this->subBlockDirectorySegment.GetAllocatedSize();
+    updateInfo.enumEntriesFunc = [&](const std::function<void(const CCziSubBlockDirectoryBase::SubBlkEntry*, const CCziSubBlockDirectoryBase::SubBlkEntry&, bool)>& f)->void
+        {
+            this->sbBlkDirectory.EnumEntriesForIncrementalUpdate(f);
+        };
+    updateInfo.writeFunc = std::bind(&CCziReaderWriter::WriteToOutputStream, this, placeholders::_1, placeholders::_2, placeholders::_3, placeholders::_4, placeholders::_5);
+    return CWriterUtils::TryUpdateSubBlkDirectoryInPlace(updateInfo);
+}
+
+std::uint64_t CCziReaderWriter::CalcReserveForSubBlockDirectory()
+{
+    // we reserve a fraction of the current size of the subblock-directory, so that subsequently added subblocks can be
+    //  added to the existing segment (without the need to write a new one)
+    uint64_t sizeOfEntries = 0;
+    this->sbBlkDirectory.EnumEntries(
+        [&](int, const CCziSubBlockDirectoryBase::SubBlkEntry& entry)->bool
+        {
+            sizeOfEntries += CWriterUtils::CalcSizeOfSubBlockDirectoryEntryDV(entry);
+            return true;
+        });
+
+    return sizeOfEntries * SubBlockDirectoryReservePercent / 100;
 }
 
 void CCziReaderWriter::UpdateFileHeader()
@@ -350,10 +455,77 @@ void CCziReaderWriter::UpdateFileHeader()
     fhs.data.MetadataPosition = this->metadataSegment.GetFilePos();
     fhs.data.AttachmentDirectoryPosition = this->attachmentDirectorySegment.GetFilePos();
 
+    this->hdrSegmentData = CFileHeaderSegmentData(&fhs.data);
     ConvertToHostByteOrder::Convert(&fhs);
     this->WriteToOutputStream(0, &fhs, sizeof(fhs), nullptr, "FileHeader");
 }
 
+void CCziReaderWriter::DetermineSharedSubBlockSegments()
+{
+    this->sharedSubBlockSegments.clear();
+    this->subBlockSegmentsToUpdate.clear();
+    this->sbBlkDirectory.EnumEntries(
+        [&](int, const CCziSubBlockDirectoryBase::SubBlkEntry& entry)->bool
+        {
+            ++this->sharedSubBlockSegments[entry.FilePosition];
+            return true;
+        });
+
+    for (auto it = this->sharedSubBlockSegments.begin(); it != this->sharedSubBlockSegments.end();)
+    {
+        if (it->second < 2)
+        {
+            it = this->sharedSubBlockSegments.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+bool CCziReaderWriter::ReleaseSharedSubBlockSegment(std::uint64_t filePosition)
+{
+    const auto it = this->sharedSubBlockSegments.find(filePosition);
+    if (it == this->sharedSubBlockSegments.end())
+    {
+        return false;
+    }
+
+    if (--it->second < 2)
+    {
+        this->sharedSubBlockSegments.erase(it);
+        this->subBlockSegmentsToUpdate.insert(filePosition);
+    }
+
+    return true;
+}
+
+void CCziReaderWriter::UpdateHeadersOfFormerlySharedSubBlockSegments()
+{
+    if (this->subBlockSegmentsToUpdate.empty())
+    {
+        return;
+    }
+
+    CWriterUtils::SubBlockSegmentEntryWriteInfo writeInfo;
+    writeInfo.writeFunc = std::bind(&CCziReaderWriter::WriteToOutputStream, this, placeholders::_1, placeholders::_2, placeholders::_3, placeholders::_4, placeholders::_5);
+    this->sbBlkDirectory.EnumEntries(
+        [&](int, const CCziSubBlockDirectoryBase::SubBlkEntry& entry)->bool
+        {
+            // if the remaining entry has been removed or replaced in the meantime, then the segment is not found here (which is fine)
+            if (this->subBlockSegmentsToUpdate.erase(entry.FilePosition) > 0)
+            {
+                writeInfo.segmentPos = entry.FilePosition;
+                CWriterUtils::WriteSubBlockSegmentDirectoryEntry(writeInfo, entry);
+            }
+
+            return !this->subBlockSegmentsToUpdate.empty();
+        });
+
+    this->subBlockSegmentsToUpdate.clear();
+}
+
 void CCziReaderWriter::ReadCziStructure()
 {
     FileHeaderSegmentData fileHeaderSegment;
@@ -401,7 +573,25 @@ void CCziReaderWriter::ReadCziStructure()
             CCZIParse::SubblockDirectoryParseOptions{},
             &sbBlkDirSegmentSize);
 
-        this->sbBlkDirectory.SetModified(false);
+        // the subblock-directory in the file can only be updated incrementally if it is laid out exactly like we would write
+        //  it (i.e. if it contains only entries of schema "DV")
+        uint64_t sizeOfEntries = 0;
+        this->sbBlkDirectory.EnumEntries(
+            [&](int, const CCziSubBlockDirectoryBase::SubBlkEntry& entry)->bool
+            {
+                sizeOfEntries += CWriterUtils::CalcSizeOfSubBlockDirectoryEntryDV(entry);
+                return true;
+            });
+        if (static_cast<uint64_t>(sbBlkDirSegmentSize.UsedSize) == sizeof(SubBlockDirectorySegmentData) + sizeOfEntries)
+        {
+            this->sbBlkDirectory.SetPersisted();
+        }
+        else
+        {
+            this->sbBlkDirectory.SetModified(false);
+        }
+
+        this->DetermineSharedSubBlockSegments();
 
         this->subBlockDirectorySegment.SetPositionAndAllocatedSize(this->hdrSegmentData.GetSubBlockDirectoryPosition(), sbBlkDirSegmentSize.AllocatedSize, false);
 
@@ -527,11 +717,17 @@ std::tuple<bool, std::uint64_t, CCziSubBlockDirectoryBase::SubBlkEntry> CCziRead
     CWriterUtils::CalculateSegmentDataSize(addSubBlockInfo, nullptr, &usedSizeAddedSbBlk);
     // usedSizeAddedSbBlk <- the size we require for the newly to be added subblock (including the SegmentHeader)
 
+    if (this->ReleaseSharedSubBlockSegment(subBlkEntry.FilePosition))
+    {
+        // the existing segment is still referenced by another directory-entry, so it must be left untouched
+        return this->ReplaceSubBlockAddNewAtEnd(addSubBlockInfo, subBlkEntry, false);
+    }
+
     const auto existingSbBlkSize = this->ReadSegmentHdrOfSubBlock(subBlkEntry.FilePosition);
 
     if (existingSbBlkSize.AllocatedSize + sizeof(SegmentHeader) < usedSizeAddedSbBlk)
     {
-        return this->ReplaceSubBlockAddNewAtEnd(addSubBlockInfo, subBlkEntry);
+        return this->ReplaceSubBlockAddNewAtEnd(addSubBlockInfo, subBlkEntry, true);
     }
     else
     {
@@ -555,7 +751,7 @@ std::tuple<bool, std::uint64_t, CCziSubBlockDirectoryBase::SubBlkEntry> CCziRead
     return make_tuple(false, sizeOfSbBlk, entry);
 }
 
-std::tuple<bool, std::uint64_t, CCziSubBlockDirectoryBase::SubBlkEntry> CCziReaderWriter::ReplaceSubBlockAddNewAtEnd(const libCZI::AddSubBlockInfo& addSubBlockInfo, const CCziSubBlockDirectoryBase::SubBlkEntry& subBlkEntry)
+std::tuple<bool, std::uint64_t, CCziSubBlockDirectoryBase::SubBlkEntry> CCziReaderWriter::ReplaceSubBlockAddNewAtEnd(const libCZI::AddSubBlockInfo& addSubBlockInfo, const CCziSubBlockDirectoryBase::SubBlkEntry& subBlkEntry, bool markExistingSegmentAsDeleted)
 {
     this->EnsureNextSegmentInfo();
     CWriterUtils::WriteInfo wi;
@@ -565,10 +761,13 @@ std::tuple<bool, std::uint64_t, CCziSubBlockDirectoryBase::SubBlkEntry> CCziRead
 
     auto sizeOfSbBlk = CWriterUtils::WriteSubBlock(wi, addSubBlockInfo);
 
-    CWriterUtils::MarkDeletedInfo mdi;
-    mdi.segmentPos = subBlkEntry.FilePosition;
-    mdi.writeFunc = std::bind(&CCziReaderWriter::WriteToOutputStream, this, placeholders::_1, placeholders::_2, placeholders::_3, placeholders::_4, placeholders::_5);
-    CWriterUtils::WriteDeletedSegment(mdi);
+    if (markExistingSegmentAsDeleted)
+    {
+        CWriterUtils::MarkDeletedInfo mdi;
+        mdi.segmentPos = subBlkEntry.FilePosition;
+        mdi.writeFunc = std::bind(&CCziReaderWriter::WriteToOutputStream, this, placeholders::_1, placeholders::_2, placeholders::_3, placeholders::_4, placeholders::_5);
+        CWriterUtils::WriteDeletedSegment(mdi);
+    }
 
     CCziSubBlockDirectoryBase::SubBlkEntry entry = CWriterUtils::SubBlkEntryFromAddSubBlockInfo(addSubBlockInfo);
     entry.FilePosition = wi.segmentPos;
@@ -671,6 +870,14 @@ void CCziReaderWriter::WriteToOutputStream(std::uint64_t offset, const void* pv,
 
     auto subBlkData = CCZIParse::ReadSubBlock(this->stream.get(), entry.FilePosition, allocateInfo);
 
+    if (this->sharedSubBlockSegments.find(entry.FilePosition) != this->sharedSubBlockSegments.cend() ||
+        this->subBlockSegmentsToUpdate.find(entry.FilePosition) != this->subBlockSegmentsToUpdate.cend())
+    {
+        // the segment-header describes only one of the subblocks referring to a shared segment (or it has not yet been updated
+        // for the only remaining subblock referring to a formerly shared segment), so we use the directory-entry here
+        return std::make_shared<CCziSubBlock>(CziReaderCommon::ConvertToSubBlockInfo(entry), subBlkData, free);
+    }
+
     libCZI::SubBlockInfo info;
     info.pixelType = CziUtils::PixelTypeFromInt(subBlkData.pixelType);
     info.compressionModeRaw = subBlkData.compression;
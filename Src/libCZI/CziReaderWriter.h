@@ -6,6 +6,8 @@
 
 #include <memory>
 #include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include "libCZI.h"
 #include "CziSubBlockDirectory.h"
 #include "CziAttachmentsDirectory.h"
@@ -14,6 +16,7 @@
 #include "libCZI_ReadWrite.h"
 #include "FileHeaderSegmentData.h"
 #include "CziParse.h"
+#include "WriteCombiningOutputStream.h"
 
 namespace libCZI
 {
@@ -23,14 +26,36 @@ namespace libCZI
         class CCziReaderWriter : public libCZI::ICziReaderWriter
         {
         private:
+            /// When a new subblock-directory-segment is written, this percentage of its size is allocated in addition, so that
+            /// subblocks added later on can be added to the existing segment.
+            static constexpr std::uint64_t SubBlockDirectoryReservePercent = 25;
+
+            libCZI::CZIReaderWriterOptions readerWriterOptions;
             std::shared_ptr<libCZI::IInputOutputStream> stream;
             std::shared_ptr<libCZI::ICziReaderWriterInfo> info;
 
+            /// The write-combining buffer wrapping the stream (only present if buffering is in use, in which case
+            /// "stream" refers to this object).
+            std::shared_ptr<CWriteCombiningInputOutputStream> writeCombiningStream;
+
             CFileHeaderSegmentData hdrSegmentData;
             CReaderWriterCziSubBlockDirectory sbBlkDirectory;
             CReaderWriterCziAttachmentsDirectory attachmentDirectory;
 
+            /// The subblock-segments which are referenced by more than one directory-entry (which is the case for deduplicated
+            /// subblocks), with the file-position as key and the number of references as value. Such a segment must not be
+            /// overwritten or marked as deleted as long as it is referenced by another entry.
+            std::unordered_map<std::uint64_t, int> sharedSubBlockSegments;
+
+            /// The subblock-segments which have been shared, but are now referenced by a single directory-entry only. For those
+            /// the directory-entry embedded in the segment-header is updated (with the remaining entry) when finishing.
+            std::unordered_set<std::uint64_t> subBlockSegmentsToUpdate;
+
         public:
+            CCziReaderWriter() = default;
+            explicit CCziReaderWriter(const libCZI::CZIReaderWriterOptions& options);
+            ~CCziReaderWriter() override;
+
             void Create(std::shared_ptr<libCZI::IInputOutputStream> stream, std::shared_ptr<libCZI::ICziReaderWriterInfo> info) override;
             void ReplaceSubBlock(int key, const libCZI::AddSubBlockInfo& addSbBlkInfo) override;
             void RemoveSubBlock(int key) override;
@@ -42,6 +67,7 @@ namespace libCZI
             std::shared_ptr<libCZI::IMetadataSegment> ReadMetadataSegment() override;
             libCZI::FileHeaderInfo GetFileHeaderInfo() override;
 
+            void Commit() override;
             void Close() override;
 
             // interface ISubBlockRepository
@@ -63,13 +89,23 @@ namespace libCZI
 
         private:
             void Finish();
+            bool TryUpdateSubBlockDirectoryInPlace();
+            std::uint64_t CalcReserveForSubBlockDirectory();
+            void FlushWriteCombiningBuffer();
 
             void ReadCziStructure();
+            void DetermineSharedSubBlockSegments();
+
+            /// Releases a reference to the specified subblock-segment (i.e. a directory-entry referring to it is removed or modified).
+            /// \param filePosition The file-position of the segment.
+            /// \returns True if the segment is still referenced by another directory-entry (and must therefore be left untouched); false otherwise.
+            bool ReleaseSharedSubBlockSegment(std::uint64_t filePosition);
+            void UpdateHeadersOfFormerlySharedSubBlockSegments();
             libCZI::GUID UpdateFileHeaderGuid();
             void DetermineNextSubBlockOffset();
 
             std::tuple<bool, std::uint64_t, CCziSubBlockDirectoryBase::SubBlkEntry> ReplaceSubBlock(const libCZI::AddSubBlockInfo& addSubBlockInfo, const CCziSubBlockDirectoryBase::SubBlkEntry& subBlkEntry);
-            std::tuple<bool, std::uint64_t, CCziSubBlockDirectoryBase::SubBlkEntry> ReplaceSubBlockAddNewAtEnd(const libCZI::AddSubBlockInfo& addSubBlockInfo, const CCziSubBlockDirectoryBase::SubBlkEntry& subBlkEntry);
+            std::tuple<bool, std::uint64_t, CCziSubBlockDirectoryBase::SubBlkEntry> ReplaceSubBlockAddNewAtEnd(const libCZI::AddSubBlockInfo& addSubBlockInfo, const CCziSubBlockDirectoryBase::SubBlkEntry& subBlkEntry, bool markExistingSegmentAsDeleted);
             std::tuple<bool, std::uint64_t, CCziSubBlockDirectoryBase::SubBlkEntry> ReplaceSubBlockInplace(const libCZI::AddSubBlockInfo& addSubBlockInfo, const CCziSubBlockDirectoryBase::SubBlkEntry& subBlkEntry, std::uint64_t existingSegmentAllocatedSize);
 
             std::tuple<bool, std::uint64_t, CCziAttachmentsDirectoryBase::AttachmentEntry> ReplaceAttachment(const libCZI::AddAttachmentInfo& addAttchmntInfo, const CCziAttachmentsDirectoryBase::AttachmentEntry& attchmntInfo);
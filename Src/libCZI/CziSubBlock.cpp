@@ -4,6 +4,8 @@
 
 #include "CziSubBlock.h"
 #include "CziUtils.h"
+#include "BitmapOperations.h"
+#include "bitmapData.h"
 
 using namespace libCZI;
 using namespace libCZI::detail;
@@ -20,6 +22,19 @@ CCziSubBlock::CCziSubBlock(const libCZI::SubBlockInfo& info, const CCZIParse::Su
 {
 }
 
+CCziSubBlock::CCziSubBlock(const libCZI::SubBlockInfo& info, const CCziSubBlock& other)
+    :
+    spData(other.spData),
+    spAttachment(other.spAttachment),
+    spMetadata(other.spMetadata),
+    dataSize(other.dataSize),
+    attachmentSize(other.attachmentSize),
+    metaDataSize(other.metaDataSize),
+    info(info),
+    sharedBitmap(other.sharedBitmap)
+{
+}
+
 /*virtual*/const SubBlockInfo& CCziSubBlock::GetSubBlockInfo() const
 {
     return this->info;
@@ -78,5 +93,36 @@ CCziSubBlock::CCziSubBlock(const libCZI::SubBlockInfo& info, const CCZIParse::Su
 
 /*virtual*/std::shared_ptr<IBitmapData> CCziSubBlock::CreateBitmap(const CreateBitmapOptions* options)
 {
+    if (options == nullptr && this->sharedBitmap)
+    {
+        // the bitmap is decoded only once (for all subblocks sharing the segment), and each caller gets its own copy of
+        //  it - so that a caller modifying the bitmap does not affect the others
+        std::shared_ptr<IBitmapData> decodedBitmap;
+        {
+            std::unique_lock<std::mutex> lock(this->sharedBitmap->mutex);
+            if (!this->sharedBitmap->bitmap)
+            {
+                this->sharedBitmap->bitmap = CreateBitmapFromSubBlock(this, options);
+            }
+
+            decodedBitmap = this->sharedBitmap->bitmap;
+        }
+
+        auto bitmap = CStdBitmapData::Create(decodedBitmap->GetPixelType(), decodedBitmap->GetWidth(), decodedBitmap->GetHeight());
+        ScopedBitmapLockerSP lockSource{ decodedBitmap };
+        ScopedBitmapLockerSP lockDestination{ bitmap };
+        CBitmapOperations::Copy(
+            decodedBitmap->GetPixelType(),
+            lockSource.ptrDataRoi,
+            static_cast<int>(lockSource.stride),
+            bitmap->GetPixelType(),
+            lockDestination.ptrDataRoi,
+            static_cast<int>(lockDestination.stride),
+            static_cast<int>(bitmap->GetWidth()),
+            static_cast<int>(bitmap->GetHeight()),
+            false);
+        return bitmap;
+    }
+
     return CreateBitmapFromSubBlock(this, options);
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include "libCZI.h"
 #include "CziParse.h"
 
@@ -15,15 +16,37 @@ namespace libCZI
 
         class CCziSubBlock : public  libCZI::ISubBlock
         {
+        public:
+            /// The decoded bitmap of a subblock-segment which is shared by several subblocks (which is the case for
+            /// deduplicated subblocks, where more than one directory-entry refers to the same segment).
+            struct SharedBitmap
+            {
+                std::mutex mutex;
+                std::shared_ptr<libCZI::IBitmapData> bitmap;
+            };
         private:
             std::shared_ptr<const void> spData, spAttachment, spMetadata;
             std::uint64_t   dataSize;
             std::uint32_t   attachmentSize;
             std::uint32_t   metaDataSize;
             libCZI::SubBlockInfo    info;
+            std::shared_ptr<SharedBitmap> sharedBitmap;
         public:
             CCziSubBlock(const libCZI::SubBlockInfo& info, const CCZIParse::SubBlockData& data, const std::function<void(void*)>& deleter);
 
+            /// Constructs a subblock with the specified information, which shares its data (and the shared bitmap, if any) with the specified subblock.
+            ///
+            /// \param  info    The subblock-information.
+            /// \param  other   The subblock to share the data with.
+            CCziSubBlock(const libCZI::SubBlockInfo& info, const CCziSubBlock& other);
+
+            /// Sets the shared bitmap - if set, the bitmap decoded by "CreateBitmap" (without options) is stored there, and
+            /// subsequent calls (of this object or of the subblocks sharing the data with it) return a copy of it (instead of
+            /// decoding the data again).
+            ///
+            /// \param  sharedBitmap    The shared bitmap.
+            void SetSharedBitmap(std::shared_ptr<SharedBitmap> sharedBitmap) { this->sharedBitmap = std::move(sharedBitmap); }
+
             // interface ISubBlock
             const libCZI::SubBlockInfo& GetSubBlockInfo() const override;
             void DangerousGetRawData(libCZI::ISubBlock::MemBlkType type, const void*& ptr, size_t& size) const override;
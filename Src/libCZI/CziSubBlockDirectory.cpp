@@ -4,6 +4,7 @@
 
 #include "CziSubBlockDirectory.h"
 #include "CziUtils.h"
+#include "SubBlockDirectoryRuns.h"
 #include <cstddef>
 
 using namespace libCZI;
@@ -389,6 +390,19 @@ void CCziSubBlockDirectory::AddingFinished()
     this->sblkStatistics.Consolidate();
 }
 
+int CCziSubBlockDirectory::AppendSubBlock(const SubBlkEntry& entry)
+{
+    if (this->state != State::AddingFinished)
+    {
+        throw std::logic_error("Appending subblocks is only allowed after adding was finished.");
+    }
+
+    this->subBlks.push_back(entry);
+    this->sblkStatistics.UpdateStatistics(entry);
+    this->sblkStatistics.Consolidate();
+    return static_cast<int>(this->subBlks.size()) - 1;
+}
+
 const libCZI::SubBlockStatistics& CCziSubBlockDirectory::GetStatistics() const
 {
     return this->sblkStatistics.GetStatistics();
@@ -443,25 +457,105 @@ bool PixelTypeForChannelIndexStatistic::TryGetPixelTypeForNoChannelIndex(int* pi
 
 //----------------------------------------------------------------------------------------------
 
-CWriterCziSubBlockDirectory::CWriterCziSubBlockDirectory(bool allow_duplicate_subblocks)
+CWriterCziSubBlockDirectory::CWriterCziSubBlockDirectory(bool allow_duplicate_subblocks, std::uint32_t max_entries_in_memory /*= 0*/)
     : subBlkEntryComparison{ allow_duplicate_subblocks },
-    subBlks(subBlkEntryComparison)
+    subBlks(subBlkEntryComparison),
+    max_entries_in_memory_(max_entries_in_memory)
 {
 }
 
+CWriterCziSubBlockDirectory::CWriterCziSubBlockDirectory(CWriterCziSubBlockDirectory&& other) noexcept = default;
+CWriterCziSubBlockDirectory& CWriterCziSubBlockDirectory::operator=(CWriterCziSubBlockDirectory&& other) noexcept = default;
+CWriterCziSubBlockDirectory::~CWriterCziSubBlockDirectory() = default;
+
 bool CWriterCziSubBlockDirectory::TryAddSubBlock(const SubBlkEntry& entry)
 {
+    if (this->runs_)
+    {
+        // we have to check the entries in memory as well as the entries which have been spilled to the temporary file
+        if (this->subBlks.find(entry) != this->subBlks.cend() ||
+            this->runs_->Contains(entry, this->subBlkEntryComparison.Hash(entry)))
+        {
+            return false;
+        }
+    }
+
     auto insert = this->subBlks.insert(entry);
 
     if (insert.second)
     {
         this->sblkStatistics.UpdateStatistics(entry);
         this->pixelTypeForChannel.AddSbBlk(entry);
+
+        if (this->max_entries_in_memory_ > 0 && this->subBlks.size() >= this->max_entries_in_memory_)
+        {
+            this->SpillEntries();
+        }
     }
 
     return insert.second;
 }
 
+void CWriterCziSubBlockDirectory::SpillEntries()
+{
+    if (!this->runs_)
+    {
+        const auto comparison = this->subBlkEntryComparison;
+        this->runs_ = make_unique<CSubBlockDirectoryRuns>(
+            [comparison](const SubBlkEntry& a, const SubBlkEntry& b)->bool
+            {
+                return comparison(a, b);
+            });
+    }
+
+    for (const auto& entry : this->subBlks)
+    {
+        this->runs_->Append(entry, this->subBlkEntryComparison.Hash(entry));
+    }
+
+    this->runs_->EndRun();
+    this->subBlks.clear();
+}
+
+std::uint64_t CWriterCziSubBlockDirectory::SubBlkEntryCompare::Hash(const SubBlkEntry& entry) const
+{
+    // Note that the zoom is not included here, since it is compared with a tolerance in the comparison - so, entries which
+    //  only differ in zoom have the same hash (which is fine).
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const auto combine = [&hash](uint64_t value)->void
+        {
+            // FNV-1a-like combination of 64-bit values
+            hash ^= value;
+            hash *= 0x100000001b3ull;
+            hash ^= hash >> 29;
+        };
+
+    entry.coordinate.EnumValidDimensions(
+        [&](libCZI::DimensionIndex dim, int value)->bool
+        {
+            combine(static_cast<uint64_t>(dim));
+            combine(static_cast<uint32_t>(value));
+            return true;
+        });
+
+    if (entry.IsMIndexValid())
+    {
+        combine(static_cast<uint32_t>(entry.mIndex));
+    }
+    else
+    {
+        combine(static_cast<uint32_t>(entry.x));
+        combine(static_cast<uint32_t>(entry.y));
+    }
+
+    if (this->include_file_position_)
+    {
+        combine(entry.FilePosition);
+    }
+
+    return hash;
+}
+
 bool CWriterCziSubBlockDirectory::SubBlkEntryCompare::operator()(const SubBlkEntry& a, const SubBlkEntry& b) const
 {
     // returns true if the first argument goes before the second argument in the strict weak ordering it defines, 
@@ -559,12 +653,54 @@ bool CWriterCziSubBlockDirectory::SubBlkEntryCompare::operator()(const SubBlkEnt
 bool CWriterCziSubBlockDirectory::EnumEntries(const std::function<bool(size_t index, const SubBlkEntry&)>& func) const
 {
     size_t index = 0;
-    for (auto it = this->subBlks.cbegin(); it != this->subBlks.cend(); ++it)
+    if (!this->runs_)
+    {
+        for (auto it = this->subBlks.cbegin(); it != this->subBlks.cend(); ++it)
+        {
+            if (!func(index++, *it))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // merge the spilled runs and the entries in memory (which are all sorted) - the number of runs is expected to be
+    //  moderate, so we simply search for the smallest entry among the heads of the runs
+    auto cursors = this->runs_->CreateCursors();
+    auto it = this->subBlks.cbegin();
+    for (;;)
     {
-        if (!func(index++, *it))
+        const SubBlkEntry* smallest = it != this->subBlks.cend() ? &*it : nullptr;
+        CSubBlockDirectoryRuns::RunCursor* cursorWithSmallest = nullptr;
+        for (auto& cursor : cursors)
+        {
+            if (!cursor.IsAtEnd() && (smallest == nullptr || this->subBlkEntryComparison(cursor.GetCurrent(), *smallest)))
+            {
+                smallest = &cursor.GetCurrent();
+                cursorWithSmallest = &cursor;
+            }
+        }
+
+        if (smallest == nullptr)
+        {
+            break;
+        }
+
+        if (!func(index++, *smallest))
         {
             return false;
         }
+
+        if (cursorWithSmallest != nullptr)
+        {
+            cursorWithSmallest->MoveNext();
+        }
+        else
+        {
+            ++it;
+        }
     }
 
     return true;
@@ -638,6 +774,43 @@ bool CReaderWriterCziSubBlockDirectory::EnumEntries(const std::function<bool(int
     return true;
 }
 
+void CReaderWriterCziSubBlockDirectory::SetPersisted()
+{
+    this->persistedEntriesUnchanged = true;
+    this->persistedKeyEnd = this->nextSbBlkIndex;
+    this->persistedStateOfModifiedEntries.clear();
+    this->SetModified(false);
+}
+
+bool CReaderWriterCziSubBlockDirectory::EnumEntriesForIncrementalUpdate(const std::function<void(const SubBlkEntry* persistedEntry, const SubBlkEntry& entry, bool isModified)>& func) const
+{
+    if (!this->persistedEntriesUnchanged)
+    {
+        return false;
+    }
+
+    for (auto it = this->subBlks.cbegin(); it != this->subBlks.cend(); ++it)
+    {
+        if (it->first >= this->persistedKeyEnd)
+        {
+            func(nullptr, it->second, false);
+            continue;
+        }
+
+        const auto persistedState = this->persistedStateOfModifiedEntries.find(it->first);
+        if (persistedState != this->persistedStateOfModifiedEntries.cend())
+        {
+            func(&persistedState->second, it->second, true);
+        }
+        else
+        {
+            func(&it->second, it->second, false);
+        }
+    }
+
+    return true;
+}
+
 bool CReaderWriterCziSubBlockDirectory::TryGetSubBlock(int key, SubBlkEntry* entry) const
 {
     const auto& it = this->subBlks.find(key);
@@ -662,6 +835,12 @@ bool CReaderWriterCziSubBlockDirectory::TryModifySubBlock(int key, const SubBlkE
         return false;
     }
 
+    if (it->first < this->persistedKeyEnd)
+    {
+        // note that "insert" does nothing if the key already exists, so we keep the state as persisted
+        this->persistedStateOfModifiedEntries.insert(std::pair<int, SubBlkEntry>(it->first, it->second));
+    }
+
     it->second = entry;
     this->SetModified(true);
 
@@ -685,6 +864,11 @@ bool CReaderWriterCziSubBlockDirectory::TryRemoveSubBlock(int key, SubBlkEntry*
         *entry = it->second;
     }
 
+    if (it->first < this->persistedKeyEnd)
+    {
+        this->persistedEntriesUnchanged = false;
+    }
+
     this->subBlks.erase(it);
     this->SetModified(true);
 
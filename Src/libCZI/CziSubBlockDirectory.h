@@ -9,6 +9,7 @@
 #include <map>
 #include <functional>
 #include <set>
+#include <memory>
 #include "libCZI.h"
 
 namespace libCZI
@@ -102,6 +103,19 @@ namespace libCZI
             void AddSubBlock(const SubBlkEntry& entry);
             void AddingFinished();
 
+            /// Appends an entry after adding was finished (which is used when following a document which is still being written).
+            /// The statistics are updated accordingly.
+            ///
+            /// \param  entry   The entry.
+            ///
+            /// \returns The index of the new entry.
+            int AppendSubBlock(const SubBlkEntry& entry);
+
+            /// Gets the number of entries.
+            ///
+            /// \returns The number of entries.
+            int GetSubBlockCount() const { return static_cast<int>(this->subBlks.size()); }
+
             void EnumSubBlocks(const std::function<bool(int index, const SubBlkEntry&)>& func);
             bool TryGetSubBlock(int index, SubBlkEntry& entry) const;
         };
@@ -129,6 +143,11 @@ namespace libCZI
             const std::map<int, int>& GetChannelIndexPixelTypeMap() const { return this->pixelTypePerChannelIndex; }
         };
 
+        class CSubBlockDirectoryRuns;
+
+        /// The subblock-directory used by the writer. It keeps the entries ordered and checks for duplicates when adding. Optionally,
+        /// the number of entries held in memory can be limited - when this limit is reached, the entries are spilled (as a sorted run)
+        /// to a temporary file, and the runs are merged when enumerating the entries.
         class CWriterCziSubBlockDirectory : public CCziSubBlockDirectoryBase
         {
         private:
@@ -143,7 +162,16 @@ namespace libCZI
             PixelTypeForChannelIndexStatisticCreate pixelTypeForChannel;
         public:
             CWriterCziSubBlockDirectory() = delete;
-            CWriterCziSubBlockDirectory(bool allow_duplicate_subblocks);
+
+            /// Constructor.
+            ///
+            /// \param  allow_duplicate_subblocks   True if duplicate subblocks (i.e. subblocks with the same coordinate) are allowed.
+            /// \param  max_entries_in_memory       The maximum number of entries held in memory, if 0 there is no limit.
+            CWriterCziSubBlockDirectory(bool allow_duplicate_subblocks, std::uint32_t max_entries_in_memory = 0);
+            CWriterCziSubBlockDirectory(CWriterCziSubBlockDirectory&& other) noexcept;
+            CWriterCziSubBlockDirectory& operator=(CWriterCziSubBlockDirectory&& other) noexcept;
+            ~CWriterCziSubBlockDirectory();
+
             bool TryAddSubBlock(const SubBlkEntry& entry);
 
             bool EnumEntries(const std::function<bool(size_t index, const SubBlkEntry&)>& func) const;
@@ -159,12 +187,22 @@ namespace libCZI
                 SubBlkEntryCompare(bool include_file_position) : include_file_position_(include_file_position) {}
                 bool include_file_position_{ false };
                 bool operator() (const SubBlkEntry& a, const SubBlkEntry& b) const;
+
+                /// Calculates a hash of the entry, where entries which are equal (according to this comparison) have the same hash.
+                std::uint64_t Hash(const SubBlkEntry& entry) const;
             };
 
             /// This object is used to implement the "less-comparison" for the set.
             SubBlkEntryCompare subBlkEntryComparison;
 
             std::set<SubBlkEntry, SubBlkEntryCompare> subBlks;
+
+            std::uint32_t max_entries_in_memory_;
+
+            /// The runs of entries which have been spilled to a temporary file (or null if no entries have been spilled).
+            std::unique_ptr<CSubBlockDirectoryRuns> runs_;
+
+            void SpillEntries();
         };
 
         class CReaderWriterCziSubBlockDirectory : public CCziSubBlockDirectoryBase
@@ -184,12 +222,43 @@ namespace libCZI
             std::map<int, SubBlkEntry> subBlks;
 
             bool isModified;
+
+            /// Indicates whether the entries which have been persisted (i.e. which are present in the subblock-directory-segment
+            /// in the file) are still present, i.e. no persisted entry has been removed (and the directory can therefore be updated
+            /// incrementally).
+            bool persistedEntriesUnchanged;
+
+            /// The entries with a key smaller than this have been persisted, the others have been added since.
+            int persistedKeyEnd;
+
+            /// The persisted state of entries which have been modified since the subblock-directory was persisted (with the key as key).
+            std::map<int, SubBlkEntry> persistedStateOfModifiedEntries;
         public:
-            CReaderWriterCziSubBlockDirectory() :sbBlkStatisticsCurrent(true), sbBlkStatisticsConsolidated(false), nextSbBlkIndex(0), isModified(false) {}
+            CReaderWriterCziSubBlockDirectory() :sbBlkStatisticsCurrent(true), sbBlkStatisticsConsolidated(false), nextSbBlkIndex(0), isModified(false), persistedEntriesUnchanged(false), persistedKeyEnd(0) {}
 
             bool IsModified()const { return this->isModified; }
             void SetModified(bool modified) { this->isModified = modified; }
 
+            /// Marks the current state as persisted, i.e. as being identical to the subblock-directory-segment in the file (in
+            /// the order of the keys). The modified-flag is cleared.
+            void SetPersisted();
+
+            /// Query if the subblock-directory-segment in the file can be updated incrementally, which is the case if the current
+            /// state has been persisted before (c.f. "SetPersisted"), and no persisted entry has been removed since.
+            ///
+            /// \returns    True if an incremental update is possible; false otherwise.
+            bool IsIncrementalUpdatePossible() const { return this->persistedEntriesUnchanged; }
+
+            /// Enumerates the entries (in the order of the keys) together with their persisted state, which allows to update the
+            /// subblock-directory-segment in the file incrementally. This is only possible if no persisted entry has been removed,
+            /// otherwise false is returned (and the functor is not called).
+            ///
+            /// \param  func    The functor which is called for each entry - it is passed the persisted state of the entry (or
+            ///                 nullptr if the entry has been added since), the current entry and whether the entry has been modified.
+            ///
+            /// \returns    True if the entries were enumerated; false if an incremental update is not possible.
+            bool EnumEntriesForIncrementalUpdate(const std::function<void(const SubBlkEntry* persistedEntry, const SubBlkEntry& entry, bool isModified)>& func) const;
+
             void AddSubBlock(const SubBlkEntry& entry, int* key = nullptr);
 
             bool TryGetSubBlock(int key, SubBlkEntry* entry) const;
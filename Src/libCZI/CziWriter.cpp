@@ -9,6 +9,10 @@
 #include "libCZI_exceptions.h"
 #include "CziMetadataBuilder.h"
 #include "utilities.h"
+#include "StreamImpl.h"
+#include "SpatialSubBlockOrder.h"
+#include "Site.h"
+#include "bitmapData.h"
 
 using namespace libCZI;
 using namespace libCZI::detail;
@@ -461,6 +465,22 @@ void libCZI::ICziWriter::SyncAddSubBlock(const AddSubBlockInfoStridedBitmap& add
     info.writeFunc(info.segmentPos, CCZIParse::DELETEDSEGMENTMAGIC, sizeof(CCZIParse::DELETEDSEGMENTMAGIC), &bytesWritten, "DELETE SEGMENT");
 }
 
+/*static*/void CWriterUtils::WriteSubBlockSegmentDirectoryEntry(const SubBlockSegmentEntryWriteInfo& info, const CCziSubBlockDirectoryBase::SubBlkEntry& entry)
+{
+    SubBlockDirectoryEntryDV entryDv;
+    const size_t sizeOfEntry = CWriterUtils::FillSubBlockDirectoryEntryDV(&entryDv, entry);
+
+    // the directory-entry in the segment-header does not carry the file-position (c.f. "FillSubBlockDirectoryEntryDv")
+    entryDv.FilePosition = 0;
+
+    const int dimensionCount = entryDv.DimensionCount;
+    ConvertToHostByteOrder::Convert(&entryDv);
+    ConvertToHostByteOrder::Convert(entryDv.DimensionEntries, dimensionCount);
+
+    uint64_t bytesWritten;
+    info.writeFunc(info.segmentPos + sizeof(SegmentHeader) + SIZE_SUBBLOCKDATA_FIXEDPART, &entryDv, sizeOfEntry, &bytesWritten, "SubBlockDirectoryEntry");
+}
+
 /*static*/std::uint64_t CWriterUtils::WriteZeroes(const WriteInfo& info, std::uint64_t filePos, std::uint64_t count)
 {
     return CWriterUtils::WriteZeroes(info.writeFunc, filePos, count);
@@ -549,6 +569,25 @@ void libCZI::ICziWriter::SyncAddSubBlock(const AddSubBlockInfoStridedBitmap& add
     return 0;
 }
 
+/*static*/std::vector<std::uint8_t> CWriterUtils::CopySubBlockPart(size_t size, const std::function<bool(int callCnt, size_t offset, const void*& ptr, size_t& size)>& getFunc, const char* nameOfPart)
+{
+    vector<uint8_t> part(size);
+    WriteInfo info;
+    info.segmentPos = 0;
+    info.useSpecifiedAllocatedSize = false;
+    info.writeFunc = [&](std::uint64_t offset, const void* pv, std::uint64_t sizeToWrite, std::uint64_t* ptrBytesWritten, const char*)->void
+        {
+            memcpy(part.data() + offset, pv, static_cast<size_t>(sizeToWrite));
+            if (ptrBytesWritten != nullptr)
+            {
+                *ptrBytesWritten = sizeToWrite;
+            }
+        };
+
+    CWriterUtils::WriteSubBlkDataGeneric(info, 0, size, getFunc, nameOfPart);
+    return part;
+}
+
 /*static*/size_t CWriterUtils::CalcSizeOfSubBlockDirectoryEntryDV(const CCziSubBlockDirectoryBase::SubBlkEntry& entry)
 {
     int numberOfDimensionEntries = 2;   // we always have X AND Y
@@ -680,6 +719,7 @@ void libCZI::ICziWriter::SyncAddSubBlock(const AddSubBlockInfoStridedBitmap& add
     if (!reUsedExistingSegment)
     {
         subBlkDirPos = info.segmentPosForNewSegment;
+        upSbBlkDirSegment->header.AllocatedSize = CWriterUtils::AlignSegmentSize(upSbBlkDirSegment->header.UsedSize + info.reserveForNewSegment);
     }
 
     uint64_t bytesWritten;
@@ -696,6 +736,85 @@ void libCZI::ICziWriter::SyncAddSubBlock(const AddSubBlockInfoStridedBitmap& add
     return make_tuple(subBlkDirPos, static_cast<std::uint64_t>(sbBlkDirSegmentHeaderAllocatedSize));
 }
 
+/*static*/bool CWriterUtils::TryUpdateSubBlkDirectoryInPlace(const SubBlkDirUpdateInfo& info)
+{
+    // first, determine the offsets of the modified entries (and check whether their size is unchanged) and the size of the new entries
+    bool updatePossible = true;
+    uint64_t sizeOfPersistedEntries = 0;
+    uint64_t sizeOfNewEntries = 0;
+    int entryCount = 0;
+    vector<tuple<uint64_t, CCziSubBlockDirectoryBase::SubBlkEntry>> modifiedEntries;
+    vector<CCziSubBlockDirectoryBase::SubBlkEntry> newEntries;
+    info.enumEntriesFunc(
+        [&](const CCziSubBlockDirectoryBase::SubBlkEntry* persistedEntry, const CCziSubBlockDirectoryBase::SubBlkEntry& entry, bool isModified)->void
+        {
+            ++entryCount;
+            if (persistedEntry == nullptr)
+            {
+                sizeOfNewEntries += CalcSizeOfSubBlockDirectoryEntryDV(entry);
+                newEntries.push_back(entry);
+                return;
+            }
+
+            const auto sizeOfPersistedEntry = CalcSizeOfSubBlockDirectoryEntryDV(*persistedEntry);
+            if (isModified)
+            {
+                if (CalcSizeOfSubBlockDirectoryEntryDV(entry) != sizeOfPersistedEntry)
+                {
+                    updatePossible = false;
+                }
+
+                modifiedEntries.emplace_back(sizeOfPersistedEntries, entry);
+            }
+
+            sizeOfPersistedEntries += sizeOfPersistedEntry;
+        });
+
+    const uint64_t usedSize = sizeof(SubBlockDirectorySegmentData) + sizeOfPersistedEntries + sizeOfNewEntries;
+    if (!updatePossible || usedSize > info.allocatedSize)
+    {
+        return false;
+    }
+
+    const uint64_t posOfEntries = info.segmentPos + sizeof(SubBlockDirectorySegment);
+    SubBlockDirectoryEntryDV entryDv;
+    for (const auto& modifiedEntry : modifiedEntries)
+    {
+        const size_t sizeOfEntry = CWriterUtils::FillSubBlockDirectoryEntryDV(&entryDv, get<1>(modifiedEntry));
+        const int dimensionCount = entryDv.DimensionCount;
+        ConvertToHostByteOrder::Convert(&entryDv);
+        ConvertToHostByteOrder::Convert(entryDv.DimensionEntries, dimensionCount);
+        info.writeFunc(posOfEntries + get<0>(modifiedEntry), &entryDv, sizeOfEntry, nullptr, "SubBlockDirEntry");
+    }
+
+    if (!newEntries.empty())
+    {
+        std::unique_ptr<std::uint8_t[]> newEntriesData(new std::uint8_t[static_cast<size_t>(sizeOfNewEntries)]);
+        size_t offset = 0;
+        for (const auto& newEntry : newEntries)
+        {
+            auto* ptrEntryDv = reinterpret_cast<SubBlockDirectoryEntryDV*>(newEntriesData.get() + offset);
+            offset += CWriterUtils::FillSubBlockDirectoryEntryDV(ptrEntryDv, newEntry);
+            const int dimensionCount = ptrEntryDv->DimensionCount;
+            ConvertToHostByteOrder::Convert(ptrEntryDv);
+            ConvertToHostByteOrder::Convert(ptrEntryDv->DimensionEntries, dimensionCount);
+        }
+
+        info.writeFunc(posOfEntries + sizeOfPersistedEntries, newEntriesData.get(), sizeOfNewEntries, nullptr, "SubBlockDirEntries");
+
+        // and finally, update the segment-header and the entry-count
+        SubBlockDirectorySegment sbBlkDirSegment{};
+        memcpy(sbBlkDirSegment.header.Id, CCZIParse::SUBBLKDIRMAGIC, 16);
+        sbBlkDirSegment.header.AllocatedSize = info.allocatedSize;
+        sbBlkDirSegment.header.UsedSize = usedSize;
+        sbBlkDirSegment.data.EntryCount = entryCount;
+        ConvertToHostByteOrder::Convert(&sbBlkDirSegment);
+        info.writeFunc(info.segmentPos, &sbBlkDirSegment, sizeof(sbBlkDirSegment), nullptr, "SubBlockDir");
+    }
+
+    return true;
+}
+
 /*static*/std::tuple<std::uint64_t, std::uint64_t> CWriterUtils::WriteAttachmentDirectory(const AttachmentDirWriteInfo& info)
 {
     AttachmentDirectorySegment attchmntDirSegment{};
@@ -900,19 +1019,40 @@ CCziWriter::CCziWriter() : CCziWriter(CZIWriterOptions{})
 {}
 
 CCziWriter::CCziWriter(const libCZI::CZIWriterOptions& options) 
-    : cziWriterOptions(options), sbBlkDirectory{options.allow_duplicate_subblocks}, nextSegmentPos(0)
+    : cziWriterOptions(options), sbBlkDirectory{ options.allow_duplicate_subblocks, options.max_subblock_directory_entries_in_memory }, nextSegmentPos(0)
 {
 }
 
 CCziWriter::~CCziWriter()
 {
+    // Without "Close", the document is not finalized - but the data which has been written so far is put out (on a best-effort
+    //  basis), so that the state of the stream is the same as without write-combining.
+    if (this->writeCombiningStream)
+    {
+        try
+        {
+            this->writeCombiningStream->Flush();
+        }
+        catch (...)
+        {
+        }
+    }
 }
 
 /*virtual*/void CCziWriter::Create(std::shared_ptr<libCZI::IOutputStream> stream, std::shared_ptr<libCZI::ICziWriterInfo> info)
 {
     this->ThrowIfAlreadyInitialized();
 
-    this->stream = stream;
+    if (this->cziWriterOptions.write_combining_buffer_size > 0 &&
+        (this->cziWriterOptions.use_write_combining_buffer_for_all_streams || IsStockFileOutputStream(stream.get())))
+    {
+        this->writeCombiningStream = make_shared<CWriteCombiningOutputStream>(stream, this->cziWriterOptions.write_combining_buffer_size);
+        this->stream = this->writeCombiningStream;
+    }
+    else
+    {
+        this->stream = stream;
+    }
 
     if (info)
     {
@@ -938,6 +1078,27 @@ CCziWriter::~CCziWriter()
 
     this->nextSegmentPos = sizeof(FileHeaderSegment);
 
+    this->deduplicationStatistics = SubBlockDeduplicationStatistics();
+    if (this->cziWriterOptions.deduplicate_subblocks)
+    {
+        this->deduplicator = make_unique<CSubBlockDeduplicator>();
+    }
+
+    if (this->cziWriterOptions.generate_pyramid)
+    {
+        CPyramidBuilder::Options pyramidOptions;
+        pyramidOptions.minificationFactor = this->cziWriterOptions.pyramid_minification_factor;
+        pyramidOptions.tileSize = this->cziWriterOptions.pyramid_tile_size;
+        pyramidOptions.compressionMode = this->cziWriterOptions.pyramid_compression_mode;
+        pyramidOptions.compressionParameters = this->cziWriterOptions.pyramid_compression_parameters;
+        this->pyramidBuilder = make_unique<CPyramidBuilder>(
+            pyramidOptions,
+            [this](CSubBlockCompressionPipeline::Job&& job)->void
+            {
+                this->SubmitToCompressionPipeline(std::move(job));
+            });
+    }
+
     size_t s;
     if (this->info->TryGetReservedSizeForMetadataSegment(&s))
     {
@@ -959,15 +1120,225 @@ CCziWriter::~CCziWriter()
 {
     this->ThrowIfNotOperational();
 
+    // subblocks added before (with "AsyncAddSubBlock") must be written first, so that the order is preserved
+    this->FlushPendingSubBlocks();
+
+    // the pyramid builder needs the uncompressed bitmap, so a (layer-0) subblock has to be decoded here
+    shared_ptr<IBitmapData> bitmapForPyramid;
+    if (this->pyramidBuilder && CPyramidBuilder::IsLayer0SubBlock(addSbBlkInfo))
+    {
+        CWriterUtils::CheckAddSubBlockArguments(addSbBlkInfo);
+        bitmapForPyramid = CCziWriter::DecodeSubBlock(addSbBlkInfo);
+    }
+
+    this->AddSubBlock(addSbBlkInfo);
+
+    if (bitmapForPyramid)
+    {
+        this->pyramidBuilder->AddSubBlock(addSbBlkInfo, bitmapForPyramid);
+    }
+}
+
+/*virtual*/void CCziWriter::AsyncAddSubBlock(const libCZI::AddSubBlockInfoUncompressedBitmap& addSbBlkInfo)
+{
+    this->ThrowIfNotOperational();
+
+    if (!addSbBlkInfo.bitmap)
+    {
+        throw std::invalid_argument("'bitmap' must be non-null");
+    }
+
+    if (addSbBlkInfo.sbBlkMetadataSize > 0 && addSbBlkInfo.ptrSbBlkMetadata == nullptr)
+    {
+        throw std::invalid_argument("'ptrSbBlkMetadata' must be non-null");
+    }
+
+    if (addSbBlkInfo.sbBlkAttachmentSize > 0 && addSbBlkInfo.ptrSbBlkAttachment == nullptr)
+    {
+        throw std::invalid_argument("'ptrSbBlkAttachment' must be non-null");
+    }
+
+    switch (addSbBlkInfo.GetCompressionMode())
+    {
+    case CompressionMode::UnCompressed:
+    case CompressionMode::Zstd0:
+    case CompressionMode::Zstd1:
+    case CompressionMode::JpgXr:
+        break;
+    default:
+        throw std::invalid_argument("unsupported compression-mode");
+    }
+
+    CSubBlockCompressionPipeline::Job job;
+    job.info = addSbBlkInfo;
+    const auto bitmapSize = addSbBlkInfo.bitmap->GetSize();
+    job.info.PixelType = addSbBlkInfo.bitmap->GetPixelType();
+    job.info.physicalWidth = static_cast<int>(bitmapSize.w);
+    job.info.physicalHeight = static_cast<int>(bitmapSize.h);
+
+    // check the arguments and the coordinate now, so that those errors are reported with the call in question
+    const AddSubBlockInfo addSbInfoForCheck(job.info);
+    CWriterUtils::CheckAddSubBlockArguments(addSbInfoForCheck);
+    this->ThrowIfCoordinateIsOutOfBounds(addSbInfoForCheck);
+
+    job.bitmap = addSbBlkInfo.bitmap;
+    job.compressionParameters = addSbBlkInfo.compressionParameters;
+    if (addSbBlkInfo.sbBlkMetadataSize > 0)
+    {
+        const auto* ptr = static_cast<const uint8_t*>(addSbBlkInfo.ptrSbBlkMetadata);
+        job.metadata.assign(ptr, ptr + addSbBlkInfo.sbBlkMetadataSize);
+    }
+
+    if (addSbBlkInfo.sbBlkAttachmentSize > 0)
+    {
+        const auto* ptr = static_cast<const uint8_t*>(addSbBlkInfo.ptrSbBlkAttachment);
+        job.attachment.assign(ptr, ptr + addSbBlkInfo.sbBlkAttachmentSize);
+    }
+
+    if (this->pyramidBuilder)
+    {
+        this->pyramidBuilder->AddSubBlock(job.info, job.bitmap);
+    }
+
+    this->SubmitToCompressionPipeline(std::move(job));
+}
+
+void CCziWriter::SubmitToCompressionPipeline(CSubBlockCompressionPipeline::Job&& job)
+{
+    if (!this->compressionPipeline)
+    {
+        this->compressionPipeline = make_unique<CSubBlockCompressionPipeline>(
+            this->cziWriterOptions.number_of_compression_threads,
+            this->cziWriterOptions.max_memory_for_pending_subblocks);
+    }
+
+    this->compressionPipeline->Submit(
+        std::move(job),
+        [this](const CSubBlockCompressionPipeline::Result& result)->void
+        {
+            this->AddSubBlockFromCompressionResult(result);
+        });
+}
+
+/*virtual*/void CCziWriter::Flush()
+{
+    this->ThrowIfNotOperational();
+    this->FlushPendingSubBlocks();
+    this->FlushWriteCombiningBuffer();
+}
+
+void CCziWriter::FlushPendingSubBlocks()
+{
+    if (this->compressionPipeline)
+    {
+        this->compressionPipeline->Drain(
+            [this](const CSubBlockCompressionPipeline::Result& result)->void
+            {
+                this->AddSubBlockFromCompressionResult(result);
+            });
+    }
+}
+
+void CCziWriter::FlushWriteCombiningBuffer()
+{
+    if (this->writeCombiningStream)
+    {
+        try
+        {
+            this->writeCombiningStream->Flush();
+        }
+        catch (const std::exception&)
+        {
+            std::throw_with_nested(LibCZIIOException("Error writing the write-combining buffer to the output-stream", 0, 0));
+        }
+    }
+}
+
+void CCziWriter::AddSubBlockFromCompressionResult(const CSubBlockCompressionPipeline::Result& result)
+{
+    if (result.error)
+    {
+        rethrow_exception(result.error);
+    }
+
+    AddSubBlockInfo addSbInfo(result.job.info);
+    addSbInfo.sizeMetadata = result.job.metadata.size();
+    addSbInfo.getMetaData = [&](int callCnt, size_t offset, const void*& ptr, size_t& size)->bool
+        {
+            (void)offset;
+            return SetIfCallCountZero(callCnt, result.job.metadata.data(), result.job.metadata.size(), ptr, size);
+        };
+    addSbInfo.sizeAttachment = result.job.attachment.size();
+    addSbInfo.getAttachment = [&](int callCnt, size_t offset, const void*& ptr, size_t& size)->bool
+        {
+            (void)offset;
+            return SetIfCallCountZero(callCnt, result.job.attachment.data(), result.job.attachment.size(), ptr, size);
+        };
+
+    if (result.compressedData)
+    {
+        addSbInfo.sizeData = result.compressedData->GetSizeOfData();
+        addSbInfo.getData = [&](int callCnt, size_t offset, const void*& ptr, size_t& size)->bool
+            {
+                (void)offset;
+                return SetIfCallCountZero(callCnt, result.compressedData->GetPtr(), result.compressedData->GetSizeOfData(), ptr, size);
+            };
+        this->AddSubBlock(addSbInfo);
+    }
+    else
+    {
+        ScopedBitmapLockerSP lockedBitmap{ result.job.bitmap };
+        const size_t lineSize = static_cast<size_t>(addSbInfo.physicalWidth) * CziUtils::GetBytesPerPel(addSbInfo.PixelType);
+        const int linesCount = addSbInfo.physicalHeight;
+        addSbInfo.sizeData = lineSize * linesCount;
+        addSbInfo.getData = [&](int callCnt, size_t offset, const void*& ptr, size_t& size)->bool
+            {
+                (void)offset;
+                if (callCnt < linesCount)
+                {
+                    ptr = static_cast<const uint8_t*>(lockedBitmap.ptrDataRoi) + static_cast<size_t>(callCnt) * lockedBitmap.stride;
+                    size = lineSize;
+                    return true;
+                }
+
+                return false;
+            };
+        this->AddSubBlock(addSbInfo);
+    }
+}
+
+void CCziWriter::AddSubBlock(const libCZI::AddSubBlockInfo& addSbBlkInfo)
+{
     // check arguments
     CWriterUtils::CheckAddSubBlockArguments(addSbBlkInfo);
 
     this->ThrowIfCoordinateIsOutOfBounds(addSbBlkInfo);
 
     CCziSubBlockDirectoryBase::SubBlkEntry entry = CWriterUtils::SubBlkEntryFromAddSubBlockInfo(addSbBlkInfo);
+
+    // if the subblocks are to be laid out in a spatial order, the subblock is held back until the writer is closed - in this case, the
+    //  file-position in the directory is a placeholder (the index in the list of deferred subblocks) for the time being
+    if (this->cziWriterOptions.subblock_layout != CZIWriterSubBlockLayout::InOrderOfAddition)
+    {
+        entry.FilePosition = this->deferredSubBlocks.size();
+        if (!this->sbBlkDirectory.TryAddSubBlock(entry))
+        {
+            throw LibCZIWriteException("Could not add subblock because it already exists", LibCZIWriteException::ErrorType::AddCoordinateAlreadyExisting);
+        }
+
+        this->AddDeferredSubBlock(addSbBlkInfo, entry);
+        return;
+    }
+
+    if (this->deduplicator)
+    {
+        // the content of the subblock is needed for determining whether an identical subblock has been written before
+        this->WriteSubBlockDeduplicated(CCziWriter::CopySubBlock(addSbBlkInfo), entry, this->sbBlkDirectory);
+        return;
+    }
+
     entry.FilePosition = this->nextSegmentPos;
-    bool b = this->sbBlkDirectory.TryAddSubBlock(entry);
-    if (b == false)
+    if (!this->sbBlkDirectory.TryAddSubBlock(entry))
     {
         throw LibCZIWriteException("Could not add subblock because it already exists", LibCZIWriteException::ErrorType::AddCoordinateAlreadyExisting);
     }
@@ -975,9 +1346,199 @@ CCziWriter::~CCziWriter()
     this->WriteSubBlock(addSbBlkInfo);
 }
 
+void CCziWriter::WriteSubBlockDeduplicated(const SubBlockCopy& subBlock, CCziSubBlockDirectoryBase::SubBlkEntry entry, CWriterCziSubBlockDirectory& directory)
+{
+    const auto key = CSubBlockDeduplicator::CalculateKey(entry, subBlock.data, subBlock.metadata, subBlock.attachment);
+    uint64_t existingSegmentPosition, existingSegmentSize;
+    const bool isDuplicate = this->deduplicator->TryGetSegment(key, &existingSegmentPosition, &existingSegmentSize);
+
+    entry.FilePosition = isDuplicate ? existingSegmentPosition : this->nextSegmentPos;
+    if (!directory.TryAddSubBlock(entry))
+    {
+        throw LibCZIWriteException("Could not add subblock because it already exists", LibCZIWriteException::ErrorType::AddCoordinateAlreadyExisting);
+    }
+
+    if (isDuplicate)
+    {
+        // the directory-entry refers to the segment which has been written for the identical subblock
+        this->deduplicator->AddDuplicate(existingSegmentSize);
+        return;
+    }
+
+    const auto segmentPosition = this->nextSegmentPos;
+    this->WriteSubBlock(CCziWriter::CreateAddSubBlockInfo(subBlock));
+    this->deduplicator->AddSegment(key, segmentPosition, this->nextSegmentPos - segmentPosition);
+}
+
+/*static*/std::shared_ptr<libCZI::IBitmapData> CCziWriter::DecodeSubBlock(const libCZI::AddSubBlockInfo& addSbBlkInfo)
+{
+    const auto data = CWriterUtils::CopySubBlockPart(addSbBlkInfo.sizeData, addSbBlkInfo.getData, "SubBlockData");
+    const auto width = static_cast<uint32_t>(addSbBlkInfo.physicalWidth);
+    const auto height = static_cast<uint32_t>(addSbBlkInfo.physicalHeight);
+    switch (addSbBlkInfo.GetCompressionMode())
+    {
+    case CompressionMode::UnCompressed:
+    {
+        // the stride with an uncompressed bitmap in CZI is exactly the line-size
+        const size_t lineSize = static_cast<size_t>(width) * CziUtils::GetBytesPerPel(addSbBlkInfo.PixelType);
+        if (data.size() < lineSize * height)
+        {
+            throw invalid_argument("insufficient size of subblock data");
+        }
+
+        auto bitmap = CStdBitmapData::Create(addSbBlkInfo.PixelType, width, height);
+        ScopedBitmapLockerSP lockedBitmap{ bitmap };
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            memcpy(static_cast<uint8_t*>(lockedBitmap.ptrDataRoi) + static_cast<size_t>(y) * lockedBitmap.stride, data.data() + y * lineSize, lineSize);
+        }
+
+        return bitmap;
+    }
+    case CompressionMode::JpgXr:
+        return GetSite()->GetDecoder(ImageDecoderType::JPXR_JxrLib, nullptr)->Decode(data.data(), data.size(), addSbBlkInfo.PixelType, width, height);
+    case CompressionMode::Zstd0:
+        return GetSite()->GetDecoder(ImageDecoderType::ZStd0, nullptr)->Decode(data.data(), data.size(), addSbBlkInfo.PixelType, width, height);
+    case CompressionMode::Zstd1:
+        return GetSite()->GetDecoder(ImageDecoderType::ZStd1, nullptr)->Decode(data.data(), data.size(), addSbBlkInfo.PixelType, width, height);
+    default:
+        throw invalid_argument("the compression mode of the subblock is not supported for generating the pyramid");
+    }
+}
+
+/*static*/CCziWriter::SubBlockCopy CCziWriter::CopySubBlock(const libCZI::AddSubBlockInfo& addSbBlkInfo)
+{
+    SubBlockCopy subBlock;
+    subBlock.info = addSbBlkInfo;
+    subBlock.data = CWriterUtils::CopySubBlockPart(addSbBlkInfo.sizeData, addSbBlkInfo.getData, "SubBlockData");
+    subBlock.metadata = CWriterUtils::CopySubBlockPart(addSbBlkInfo.sizeMetadata, addSbBlkInfo.getMetaData, "SubBlockMetadata");
+    subBlock.attachment = CWriterUtils::CopySubBlockPart(addSbBlkInfo.sizeAttachment, addSbBlkInfo.getAttachment, "SubBlockAttachment");
+    return subBlock;
+}
+
+/*static*/libCZI::AddSubBlockInfo CCziWriter::CreateAddSubBlockInfo(const SubBlockCopy& subBlock)
+{
+    // note: the functors refer to the data in "subBlock", so the object must outlive the AddSubBlockInfo returned
+    AddSubBlockInfo addSbInfo(subBlock.info);
+    addSbInfo.sizeData = subBlock.data.size();
+    addSbInfo.getData = [&subBlock](int callCnt, size_t offset, const void*& ptr, size_t& size)->bool
+        {
+            (void)offset;
+            return SetIfCallCountZero(callCnt, subBlock.data.data(), subBlock.data.size(), ptr, size);
+        };
+    addSbInfo.sizeMetadata = subBlock.metadata.size();
+    addSbInfo.getMetaData = [&subBlock](int callCnt, size_t offset, const void*& ptr, size_t& size)->bool
+        {
+            (void)offset;
+            return SetIfCallCountZero(callCnt, subBlock.metadata.data(), subBlock.metadata.size(), ptr, size);
+        };
+    addSbInfo.sizeAttachment = subBlock.attachment.size();
+    addSbInfo.getAttachment = [&subBlock](int callCnt, size_t offset, const void*& ptr, size_t& size)->bool
+        {
+            (void)offset;
+            return SetIfCallCountZero(callCnt, subBlock.attachment.data(), subBlock.attachment.size(), ptr, size);
+        };
+
+    return addSbInfo;
+}
+
+/*static*/libCZI::AddSubBlockInfoBase CCziWriter::AddSubBlockInfoFromEntry(const CCziSubBlockDirectoryBase::SubBlkEntry& entry)
+{
+    AddSubBlockInfoBase info;
+    info.coordinate = entry.coordinate;
+    info.mIndexValid = entry.IsMIndexValid();
+    if (info.mIndexValid)
+    {
+        info.mIndex = entry.mIndex;
+    }
+
+    info.x = entry.x;
+    info.y = entry.y;
+    info.logicalWidth = entry.width;
+    info.logicalHeight = entry.height;
+    info.physicalWidth = entry.storedWidth;
+    info.physicalHeight = entry.storedHeight;
+    info.PixelType = CziUtils::PixelTypeFromInt(entry.PixelType);
+    info.pyramid_type = CziUtils::PyramidTypeFromByte(entry.pyramid_type_from_spare);
+    info.compressionModeRaw = entry.Compression;
+    return info;
+}
+
+void CCziWriter::AddDeferredSubBlock(const libCZI::AddSubBlockInfo& addSbBlkInfo, const CCziSubBlockDirectoryBase::SubBlkEntry& entry)
+{
+    if (!this->deferredSubBlockSpool)
+    {
+        this->deferredSubBlockSpool = make_unique<CSubBlockSpool>();
+    }
+
+    // the parts are copied one after the other, so that only one part of one subblock is held in memory at a time
+    DeferredSubBlock deferredSubBlock;
+    auto part = CWriterUtils::CopySubBlockPart(addSbBlkInfo.sizeData, addSbBlkInfo.getData, "SubBlockData");
+    deferredSubBlock.sizeData = part.size();
+    deferredSubBlock.positionData = this->deferredSubBlockSpool->Append(part.data(), part.size());
+    part = CWriterUtils::CopySubBlockPart(addSbBlkInfo.sizeMetadata, addSbBlkInfo.getMetaData, "SubBlockMetadata");
+    deferredSubBlock.sizeMetadata = part.size();
+    deferredSubBlock.positionMetadata = this->deferredSubBlockSpool->Append(part.data(), part.size());
+    part = CWriterUtils::CopySubBlockPart(addSbBlkInfo.sizeAttachment, addSbBlkInfo.getAttachment, "SubBlockAttachment");
+    deferredSubBlock.sizeAttachment = part.size();
+    deferredSubBlock.positionAttachment = this->deferredSubBlockSpool->Append(part.data(), part.size());
+
+    this->deferredSubBlocks.push_back(deferredSubBlock);
+    this->deferredSubBlockEntries.push_back(entry);
+}
+
+CCziWriter::SubBlockCopy CCziWriter::ReadDeferredSubBlock(size_t index) const
+{
+    const auto& deferredSubBlock = this->deferredSubBlocks[index];
+    SubBlockCopy subBlock;
+    subBlock.info = CCziWriter::AddSubBlockInfoFromEntry(this->deferredSubBlockEntries[index]);
+    subBlock.data.resize(static_cast<size_t>(deferredSubBlock.sizeData));
+    this->deferredSubBlockSpool->Read(deferredSubBlock.positionData, subBlock.data.data(), deferredSubBlock.sizeData);
+    subBlock.metadata.resize(static_cast<size_t>(deferredSubBlock.sizeMetadata));
+    this->deferredSubBlockSpool->Read(deferredSubBlock.positionMetadata, subBlock.metadata.data(), deferredSubBlock.sizeMetadata);
+    subBlock.attachment.resize(static_cast<size_t>(deferredSubBlock.sizeAttachment));
+    this->deferredSubBlockSpool->Read(deferredSubBlock.positionAttachment, subBlock.attachment.data(), deferredSubBlock.sizeAttachment);
+    return subBlock;
+}
+
+void CCziWriter::WriteDeferredSubBlocks()
+{
+    if (this->deferredSubBlocks.empty())
+    {
+        return;
+    }
+
+    const auto order = CSpatialSubBlockOrder::DetermineOrder(this->deferredSubBlockEntries, this->cziWriterOptions.subblock_layout);
+
+    // the directory is re-created with the actual file-positions
+    CWriterCziSubBlockDirectory directory{ this->cziWriterOptions.allow_duplicate_subblocks, this->cziWriterOptions.max_subblock_directory_entries_in_memory };
+    for (const auto index : order)
+    {
+        // the content is read back from the spool, so only one subblock is held in memory at a time
+        const auto deferredSubBlock = this->ReadDeferredSubBlock(index);
+        if (this->deduplicator)
+        {
+            this->WriteSubBlockDeduplicated(deferredSubBlock, this->deferredSubBlockEntries[index], directory);
+        }
+        else
+        {
+            auto entry = this->deferredSubBlockEntries[index];
+            entry.FilePosition = this->nextSegmentPos;
+            directory.TryAddSubBlock(entry);
+            this->WriteSubBlock(CCziWriter::CreateAddSubBlockInfo(deferredSubBlock));
+        }
+    }
+
+    this->sbBlkDirectory = std::move(directory);
+    this->deferredSubBlocks.clear();
+    this->deferredSubBlockEntries.clear();
+    this->deferredSubBlockSpool.reset();
+}
+
 /*virtual*/void CCziWriter::SyncAddAttachment(const libCZI::AddAttachmentInfo& addAttachmentInfo)
 {
     this->ThrowIfNotOperational();
+    this->FlushPendingSubBlocks();
 
     // check arguments
     CWriterUtils::CheckAddAttachmentArguments(addAttachmentInfo);
@@ -996,6 +1557,7 @@ CCziWriter::~CCziWriter()
 /*virtual*/void CCziWriter::SyncWriteMetadata(const libCZI::WriteMetadataInfo& metadataInfo)
 {
     this->ThrowIfNotOperational();
+    this->FlushPendingSubBlocks();
 
     // check arguments
     CWriterUtils::CheckWriteMetadataArguments(metadataInfo);
@@ -1007,6 +1569,7 @@ CCziWriter::~CCziWriter()
 /*virtual*/std::shared_ptr<libCZI::ICziMetadataBuilder> CCziWriter::GetPreparedMetadata(const PrepareMetadataInfo& info)
 {
     this->ThrowIfNotOperational();
+    this->FlushPendingSubBlocks();
     auto spMdBuilder = libCZI::CreateMetadataBuilder();
     MetadataUtils::WriteFillWithSubBlockStatistics(spMdBuilder.get(), this->sbBlkDirectory.GetStatistics());
     CMetadataPrepareHelper::FillDimensionChannel(
@@ -1025,12 +1588,42 @@ CCziWriter::~CCziWriter()
     return s;
 }
 
+/*virtual*/SubBlockDeduplicationStatistics CCziWriter::GetDeduplicationStatistics() const
+{
+    return this->deduplicator ? this->deduplicator->GetStatistics() : this->deduplicationStatistics;
+}
+
 /*virtual*/void CCziWriter::Close()
 {
     this->ThrowIfNotOperational();
+    if (this->pyramidBuilder)
+    {
+        this->pyramidBuilder->Finish();
+        this->pyramidBuilder.reset();
+    }
+
+    this->FlushPendingSubBlocks();
+    this->compressionPipeline.reset();
+    this->WriteDeferredSubBlocks();
+    if (this->deduplicator)
+    {
+        this->deduplicationStatistics = this->deduplicator->GetStatistics();
+        this->deduplicator.reset();
+        if (GetSite()->IsEnabled(LOGLEVEL_INFORMATION))
+        {
+            stringstream ss;
+            ss << "CZIWriter: subblock-deduplication - " << this->deduplicationStatistics.subBlocksWritten << " subblock(s) written, "
+                << this->deduplicationStatistics.subBlocksDeduplicated << " subblock(s) deduplicated, "
+                << this->deduplicationStatistics.bytesSaved << " bytes saved.";
+            GetSite()->Log(LOGLEVEL_INFORMATION, ss.str());
+        }
+    }
+
     this->Finish();
+    this->FlushWriteCombiningBuffer();
+    this->writeCombiningStream.reset();
     this->nextSegmentPos = 0;
-    this->sbBlkDirectory = CWriterCziSubBlockDirectory{ this->cziWriterOptions.allow_duplicate_subblocks };
+    this->sbBlkDirectory = CWriterCziSubBlockDirectory{ this->cziWriterOptions.allow_duplicate_subblocks, this->cziWriterOptions.max_subblock_directory_entries_in_memory };
     this->attachmentDirectory = CWriterCziAttachmentsDirectory();
     this->metadataSegment.Invalidate();
     this->subBlockDirectorySegment.Invalidate();
@@ -7,11 +7,17 @@
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 #include "libCZI.h"
 #include "CziSubBlockDirectory.h"
 #include "CziAttachmentsDirectory.h"
 #include "CziStructs.h"
 #include "CziUtils.h"
+#include "SubBlockCompressionPipeline.h"
+#include "PyramidBuilder.h"
+#include "WriteCombiningOutputStream.h"
+#include "SubBlockDeduplicator.h"
+#include "SubBlockSpool.h"
 
 namespace libCZI
 {
@@ -174,12 +180,44 @@ namespace libCZI
 
                 std::uint64_t           segmentPosForNewSegment;
 
+                /// The number of bytes to be allocated in addition (for future additions) if a new segment is written.
+                std::uint64_t           reserveForNewSegment{ 0 };
+
                 std::function<void(const std::function<void(size_t, const CCziSubBlockDirectoryBase::SubBlkEntry&)>&)> enumEntriesFunc;
 
                 std::function<void(std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* ptrBytesWritten, const char* nameOfPartToWrite)> writeFunc;
             };
             static std::tuple<std::uint64_t, std::uint64_t> WriteSubBlkDirectory(const SubBlkDirWriteInfo& info);
 
+            struct SubBlkDirUpdateInfo
+            {
+                std::uint64_t           segmentPos;         ///< The file-position of the existing subblock-directory-segment.
+                std::uint64_t           allocatedSize;      ///< The allocated size of the existing subblock-directory-segment.
+
+                /// Functor enumerating the entries (in the order as persisted) - for each entry, the persisted state (or nullptr
+                /// if it is a new entry), the current state and whether the entry has been modified is given.
+                std::function<void(const std::function<void(const CCziSubBlockDirectoryBase::SubBlkEntry* persistedEntry, const CCziSubBlockDirectoryBase::SubBlkEntry& entry, bool isModified)>&)> enumEntriesFunc;
+
+                std::function<void(std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* ptrBytesWritten, const char* nameOfPartToWrite)> writeFunc;
+            };
+
+            /// Attempts to update an existing subblock-directory-segment in place - only the modified entries are overwritten, and
+            /// new entries are appended (after the existing ones). This is possible if the size of the modified entries is unchanged,
+            /// and if the new entries fit into the allocated size of the segment. If this is not the case, false is returned, and
+            /// nothing is written.
+            ///
+            /// \param  info    Information describing the existing segment and the changes.
+            ///
+            /// \returns    True if the segment was updated; false otherwise.
+            static bool TryUpdateSubBlkDirectoryInPlace(const SubBlkDirUpdateInfo& info);
+
+            /// Calculates the size of the directory-entry (of schema "DV") for the specified subblock in bytes.
+            ///
+            /// \param  entry   The subblock-directory-entry.
+            ///
+            /// \returns    The size of the directory-entry in bytes.
+            static size_t CalcSizeOfSubBlockDirectoryEntryDV(const CCziSubBlockDirectoryBase::SubBlkEntry& entry);
+
             struct AttachmentDirWriteInfo
             {
                 bool                    markAsDeletedIfExistingSegmentIsNotUsed;
@@ -202,6 +240,21 @@ namespace libCZI
             };
             static void WriteDeletedSegment(const MarkDeletedInfo& info);
 
+            struct SubBlockSegmentEntryWriteInfo
+            {
+                std::uint64_t   segmentPos;
+                std::function<void(std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* ptrBytesWritten, const char* nameOfPartToWrite)> writeFunc;
+            };
+
+            /// Overwrites the directory-entry which is embedded in the header of an existing subblock-segment. This is used when
+            /// a segment which was shared by multiple directory-entries (c.f. deduplication) is referenced by a single entry only,
+            /// so that the segment-header is consistent with this entry again. The number of dimension-entries must be the same
+            /// as in the existing segment-header (which is ensured by the deduplication).
+            ///
+            /// \param  info    Information about the segment and the write-function.
+            /// \param  entry   The directory-entry to be written into the segment-header.
+            static void WriteSubBlockSegmentDirectoryEntry(const SubBlockSegmentEntryWriteInfo& info, const CCziSubBlockDirectoryBase::SubBlkEntry& entry);
+
             static void CheckAddSubBlockArguments(const libCZI::AddSubBlockInfo& addSbBlkInfo);
             static CCziSubBlockDirectoryBase::SubBlkEntry SubBlkEntryFromAddSubBlockInfo(const libCZI::AddSubBlockInfo& addSbBlkInfo);
             static void CheckAddAttachmentArguments(const libCZI::AddAttachmentInfo& addAttachmentInfo);
@@ -212,6 +265,17 @@ namespace libCZI
             static bool CalculateSegmentDataSize(const libCZI::AddAttachmentInfo& addAttchmntInfo, std::uint64_t* pAllocatedSize, std::uint64_t* pUsedSize);
 
             static std::uint64_t AlignSegmentSize(std::uint64_t usedSize);
+
+            /// Retrieves a part of a subblock (i.e. the data, the metadata or the attachment) from the specified functor (as
+            /// given with AddSubBlockInfo) and copies it into a vector. If the functor does not provide "size" bytes, then the
+            /// data is filled up with zeroes (i.e. the same content as written by "WriteSubBlock" is returned).
+            ///
+            /// \param  size                The size of the part in bytes.
+            /// \param  getFunc             The functor delivering the data.
+            /// \param  nameOfPart          Name of the part (used for error messages).
+            ///
+            /// \returns    A vector containing the data.
+            static std::vector<std::uint8_t> CopySubBlockPart(size_t size, const std::function<bool(int callCnt, size_t offset, const void*& ptr, size_t& size)>& getFunc, const char* nameOfPart);
         private:
             static size_t CalcSubBlockSegmentDataSize(const libCZI::AddSubBlockInfo& addSbBlkInfo);
             static size_t CalcSubBlockDirectoryEntryDVSize(const libCZI::AddSubBlockInfo& addSbBlkInfo);
@@ -232,7 +296,6 @@ namespace libCZI
             static size_t WriteSubBlkData(const WriteInfo& info, const libCZI::AddSubBlockInfo& addSbBlkInfo, std::uint64_t filePos);
             static size_t WriteSubBlkAttachment(const WriteInfo& info, const libCZI::AddSubBlockInfo& addSbBlkInfo, std::uint64_t filePos);
 
-            static size_t CalcSizeOfSubBlockDirectoryEntryDV(const CCziSubBlockDirectoryBase::SubBlkEntry& entry);
             static int CalcCountOfDimensionsEntriesInDirectoryEntryDV(const CCziSubBlockDirectoryBase::SubBlkEntry& entry);
         };
 
@@ -247,6 +310,50 @@ namespace libCZI
 
             std::uint64_t nextSegmentPos;
 
+            /// The pipeline for compressing subblocks added with "AsyncAddSubBlock". It is created on first use.
+            std::unique_ptr<CSubBlockCompressionPipeline> compressionPipeline;
+
+            /// The object creating the pyramid subblocks (only present if pyramid generation is enabled).
+            std::unique_ptr<CPyramidBuilder> pyramidBuilder;
+
+            /// The write-combining buffer wrapping the output-stream (only present if buffering is in use, in which case
+            /// "stream" refers to this object).
+            std::shared_ptr<CWriteCombiningOutputStream> writeCombiningStream;
+
+            /// The object keeping track of the segments written (only present if subblock-deduplication is enabled).
+            std::unique_ptr<CSubBlockDeduplicator> deduplicator;
+
+            /// The statistics of the deduplication - this is updated with "Close" (so that it is available after "Close").
+            libCZI::SubBlockDeduplicationStatistics deduplicationStatistics;
+
+            /// A copy of a subblock's content - this is used if the content is needed for deduplication, and when writing a subblock
+            /// which has been held back.
+            struct SubBlockCopy
+            {
+                libCZI::AddSubBlockInfoBase info;
+                std::vector<std::uint8_t> data;
+                std::vector<std::uint8_t> metadata;
+                std::vector<std::uint8_t> attachment;
+            };
+
+            /// The location of the content of a subblock held back in the spool (c.f. "deferredSubBlockSpool").
+            struct DeferredSubBlock
+            {
+                std::uint64_t positionData;
+                std::uint64_t sizeData;
+                std::uint64_t positionMetadata;
+                std::uint64_t sizeMetadata;
+                std::uint64_t positionAttachment;
+                std::uint64_t sizeAttachment;
+            };
+
+            /// If the subblocks are to be laid out in a spatial order, they are held back until the writer is closed. Only the
+            /// directory-entries (where the file-position is the index in "deferredSubBlocks") are kept in memory, whereas the
+            /// content of the subblocks is stored in a temporary file. This object is created on first use.
+            std::unique_ptr<CSubBlockSpool> deferredSubBlockSpool;
+            std::vector<DeferredSubBlock> deferredSubBlocks;
+            std::vector<CCziSubBlockDirectoryBase::SubBlkEntry> deferredSubBlockEntries;
+
             class CziWriterInfoWrapper : public libCZI::ICziWriterInfo
             {
             private:
@@ -270,14 +377,32 @@ namespace libCZI
             ~CCziWriter() override;
 
             void SyncAddSubBlock(const libCZI::AddSubBlockInfo& addSbBlkInfo) override;
+            void AsyncAddSubBlock(const libCZI::AddSubBlockInfoUncompressedBitmap& addSbBlkInfo) override;
+            void Flush() override;
             void SyncAddAttachment(const libCZI::AddAttachmentInfo& addAttachmentInfo) override;
             void SyncWriteMetadata(const libCZI::WriteMetadataInfo& metadataInfo) override;
             std::shared_ptr<libCZI::ICziMetadataBuilder> GetPreparedMetadata(const libCZI::PrepareMetadataInfo& info) override;
             libCZI::SubBlockStatistics GetStatistics() const override;
+            libCZI::SubBlockDeduplicationStatistics GetDeduplicationStatistics() const override;
             void Close() override;
 
         private:
+            void AddSubBlock(const libCZI::AddSubBlockInfo& addSbBlkInfo);
+            void AddSubBlockFromCompressionResult(const CSubBlockCompressionPipeline::Result& result);
+            void SubmitToCompressionPipeline(CSubBlockCompressionPipeline::Job&& job);
+            void FlushPendingSubBlocks();
+            void FlushWriteCombiningBuffer();
+            void AddDeferredSubBlock(const libCZI::AddSubBlockInfo& addSbBlkInfo, const CCziSubBlockDirectoryBase::SubBlkEntry& entry);
+            SubBlockCopy ReadDeferredSubBlock(size_t index) const;
+            void WriteDeferredSubBlocks();
+
             void WriteSubBlock(const libCZI::AddSubBlockInfo& addSbBlkInfo);
+            void WriteSubBlockDeduplicated(const SubBlockCopy& subBlock, CCziSubBlockDirectoryBase::SubBlkEntry entry, CWriterCziSubBlockDirectory& directory);
+
+            static SubBlockCopy CopySubBlock(const libCZI::AddSubBlockInfo& addSbBlkInfo);
+            static std::shared_ptr<libCZI::IBitmapData> DecodeSubBlock(const libCZI::AddSubBlockInfo& addSbBlkInfo);
+            static libCZI::AddSubBlockInfo CreateAddSubBlockInfo(const SubBlockCopy& subBlock);
+            static libCZI::AddSubBlockInfoBase AddSubBlockInfoFromEntry(const CCziSubBlockDirectoryBase::SubBlkEntry& entry);
 
             void WriteAttachment(const libCZI::AddAttachmentInfo& addAttachmentInfo);
 
@@ -53,6 +53,8 @@ namespace libCZI
             std::uint64_t GetMetadataPosition() const { return this->metadataPosition; }
             libCZI::GUID GetFileGuid()const { return this->fileGuid; }
 
+            void SetMetadataPosition(std::uint64_t position) { this->metadataPosition = position; }
+
             bool GetIsSubBlockDirectoryPositionValid()const
             {
                 return  this->subBlockDirectoryPosition != (std::numeric_limits<decltype(subBlockDirectoryPosition)>::max)() && this->subBlockDirectoryPosition != 0;
@@ -0,0 +1,314 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "Instrumentation.h"
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace libCZI;
+using namespace libCZI::detail;
+using namespace std;
+
+namespace
+{
+    mutex trace_event_sink_mutex;
+    shared_ptr<ITraceEventSink> trace_event_sink;
+    atomic<bool> trace_event_sink_is_set{ false };
+
+    /// The point in time which is used as origin for the timestamps of the trace-events.
+    const chrono::steady_clock::time_point trace_event_epoch = chrono::steady_clock::now();
+
+    /// A trace-event sink which writes the events in the JSON array format of the "Chrome Trace Event Format" to a stream.
+    class CChromeTraceEventSink : public ITraceEventSink
+    {
+    private:
+        shared_ptr<IOutputStream> stream_;
+        mutex mutex_;
+        uint64_t position_{ 0 };
+        bool is_first_event_{ true };
+    public:
+        explicit CChromeTraceEventSink(shared_ptr<IOutputStream> stream) : stream_(std::move(stream))
+        {
+            this->Write("[\n");
+        }
+
+        void AddCompleteEvent(const char* name, const char* category, uint64_t timestamp_microseconds, uint64_t duration_microseconds, uint64_t thread_id) override
+        {
+            ostringstream text;
+            text << "{\"name\":\"";
+            CChromeTraceEventSink::WriteEscaped(text, name);
+            text << "\",\"cat\":\"";
+            CChromeTraceEventSink::WriteEscaped(text, category);
+            text << "\",\"ph\":\"X\",\"ts\":" << timestamp_microseconds << ",\"dur\":" << duration_microseconds << ",\"pid\":1,\"tid\":" << thread_id << "}";
+
+            lock_guard<mutex> lock(this->mutex_);
+            this->Write(this->is_first_event_ ? text.str() : ",\n" + text.str());
+            this->is_first_event_ = false;
+        }
+
+        ~CChromeTraceEventSink() override
+        {
+            try
+            {
+                this->Write("\n]\n");
+            }
+            catch (...)
+            {
+                // we must not throw from the destructor, and an unterminated array is still a valid trace-event file
+            }
+        }
+    private:
+        void Write(const string& text)
+        {
+            // the stream may write less than requested, so we continue with the remainder (and give up if no progress is made)
+            uint64_t total_bytes_written = 0;
+            while (total_bytes_written < text.size())
+            {
+                uint64_t bytes_written = 0;
+                this->stream_->Write(this->position_, text.c_str() + total_bytes_written, text.size() - total_bytes_written, &bytes_written);
+                if (bytes_written == 0)
+                {
+                    throw runtime_error("Error writing the trace-events to the output-stream.");
+                }
+
+                this->position_ += bytes_written;
+                total_bytes_written += bytes_written;
+            }
+        }
+
+        static void WriteEscaped(ostringstream& text, const char* str)
+        {
+            for (; *str != '\0'; ++str)
+            {
+                const auto c = static_cast<unsigned char>(*str);
+                if (c == '"' || c == '\\')
+                {
+                    text << '\\' << *str;
+                }
+                else if (c < 0x20)
+                {
+                    // control characters must be escaped in a JSON string
+                    char escaped[7];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    text << escaped;
+                }
+                else
+                {
+                    text << *str;
+                }
+            }
+        }
+    };
+}
+
+void PerformanceCounters::AddDuration(libCZI::PerformanceTimer timer, std::uint64_t nanoseconds)
+{
+    AtomicDurationHistogram& histogram = this->timers_[static_cast<size_t>(timer)];
+    histogram.count.fetch_add(1, memory_order_relaxed);
+    histogram.total_nanoseconds.fetch_add(nanoseconds, memory_order_relaxed);
+    histogram.buckets[PerformanceCounters::GetBucketIndex(nanoseconds)].fetch_add(1, memory_order_relaxed);
+}
+
+libCZI::PerformanceCountersSnapshot PerformanceCounters::GetSnapshot() const
+{
+    PerformanceCountersSnapshot snapshot;
+    for (size_t i = 0; i < static_cast<size_t>(PerformanceCounter::Count); ++i)
+    {
+        snapshot.counters[i] = this->counters_[i].load(memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(PerformanceTimer::Count); ++i)
+    {
+        snapshot.timers[i].count = this->timers_[i].count.load(memory_order_relaxed);
+        snapshot.timers[i].total_nanoseconds = this->timers_[i].total_nanoseconds.load(memory_order_relaxed);
+        for (int bucket = 0; bucket < DurationHistogram::kBucketCount; ++bucket)
+        {
+            snapshot.timers[i].buckets[bucket] = this->timers_[i].buckets[bucket].load(memory_order_relaxed);
+        }
+    }
+
+    return snapshot;
+}
+
+void PerformanceCounters::Reset()
+{
+    for (auto& counter : this->counters_)
+    {
+        counter.store(0, memory_order_relaxed);
+    }
+
+    for (auto& histogram : this->timers_)
+    {
+        histogram.count.store(0, memory_order_relaxed);
+        histogram.total_nanoseconds.store(0, memory_order_relaxed);
+        for (auto& bucket : histogram.buckets)
+        {
+            bucket.store(0, memory_order_relaxed);
+        }
+    }
+}
+
+/*static*/int PerformanceCounters::GetBucketIndex(std::uint64_t nanoseconds)
+{
+    // bucket 0 is for "less than 1 microsecond", bucket i is for [2^(i-1), 2^i) microseconds
+    uint64_t microseconds = nanoseconds / 1000;
+    int bucket = 0;
+    while (microseconds > 0 && bucket < DurationHistogram::kBucketCount - 1)
+    {
+        microseconds >>= 1;
+        ++bucket;
+    }
+
+    return bucket;
+}
+
+PerformanceCounters& libCZI::detail::GetGlobalCounters()
+{
+    static PerformanceCounters global_performance_counters;
+    return global_performance_counters;
+}
+
+bool libCZI::detail::IsTracingEnabled()
+{
+    return trace_event_sink_is_set.load(memory_order_relaxed);
+}
+
+void libCZI::detail::ReportTraceEvent(libCZI::PerformanceTimer timer, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::duration duration)
+{
+    shared_ptr<ITraceEventSink> sink;
+    {
+        lock_guard<mutex> lock(trace_event_sink_mutex);
+        sink = trace_event_sink;
+    }
+
+    if (sink)
+    {
+        const auto timestamp = start > trace_event_epoch ? chrono::duration_cast<chrono::microseconds>(start - trace_event_epoch).count() : 0;
+        sink->AddCompleteEvent(
+            GetPerformanceTimerName(timer),
+            "libCZI",
+            static_cast<uint64_t>(timestamp),
+            static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(duration).count()),
+            static_cast<uint64_t>(hash<thread::id>()(this_thread::get_id())));
+    }
+}
+
+ScopedPerformanceTimer::~ScopedPerformanceTimer()
+{
+    const auto duration = chrono::steady_clock::now() - this->start_;
+    const auto nanoseconds = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(duration).count());
+    GetGlobalCounters().AddDuration(this->timer_, nanoseconds);
+    if (this->additional_counters_ != nullptr)
+    {
+        this->additional_counters_->AddDuration(this->timer_, nanoseconds);
+    }
+
+    if (IsTracingEnabled())
+    {
+        try
+        {
+            ReportTraceEvent(this->timer_, this->start_, duration);
+        }
+        catch (...)
+        {
+            // a failing trace-event sink must not affect the operation being traced
+        }
+    }
+}
+
+void CInstrumentedInputStream::Read(std::uint64_t offset, void* pv, std::uint64_t size, std::uint64_t* ptrBytesRead)
+{
+    uint64_t bytes_read = 0;
+    {
+        ScopedPerformanceTimer timer(PerformanceTimer::StreamRead, this->counters_.get());
+        this->stream_->Read(offset, pv, size, &bytes_read);
+    }
+
+    this->counters_->Increment(PerformanceCounter::StreamReadCalls);
+    this->counters_->Add(PerformanceCounter::StreamReadBytes, bytes_read);
+    GetGlobalCounters().Increment(PerformanceCounter::StreamReadCalls);
+    GetGlobalCounters().Add(PerformanceCounter::StreamReadBytes, bytes_read);
+
+    if (ptrBytesRead != nullptr)
+    {
+        *ptrBytesRead = bytes_read;
+    }
+}
+
+const char* libCZI::GetPerformanceCounterName(PerformanceCounter counter)
+{
+    switch (counter)
+    {
+    case PerformanceCounter::StreamReadCalls:
+        return "StreamReadCalls";
+    case PerformanceCounter::StreamReadBytes:
+        return "StreamReadBytes";
+    case PerformanceCounter::SubBlocksRead:
+        return "SubBlocksRead";
+    case PerformanceCounter::SubBlockCacheHits:
+        return "SubBlockCacheHits";
+    case PerformanceCounter::SubBlockCacheMisses:
+        return "SubBlockCacheMisses";
+    case PerformanceCounter::TilesCulledByVisibilityCheck:
+        return "TilesCulledByVisibilityCheck";
+    default:
+        return "invalid";
+    }
+}
+
+const char* libCZI::GetPerformanceTimerName(PerformanceTimer timer)
+{
+    switch (timer)
+    {
+    case PerformanceTimer::StreamRead:
+        return "StreamRead";
+    case PerformanceTimer::DecodeJpgXr:
+        return "DecodeJpgXr";
+    case PerformanceTimer::DecodeZStd0:
+        return "DecodeZStd0";
+    case PerformanceTimer::DecodeZStd1:
+        return "DecodeZStd1";
+    case PerformanceTimer::NNResize:
+        return "NNResize";
+    case PerformanceTimer::SingleChannelAccessorGet:
+        return "SingleChannelAccessorGet";
+    case PerformanceTimer::MultiChannelComposition:
+        return "MultiChannelComposition";
+    default:
+        return "invalid";
+    }
+}
+
+libCZI::PerformanceCountersSnapshot libCZI::GetGlobalPerformanceCounters()
+{
+    return libCZI::detail::GetGlobalCounters().GetSnapshot();
+}
+
+void libCZI::ResetGlobalPerformanceCounters()
+{
+    libCZI::detail::GetGlobalCounters().Reset();
+}
+
+void libCZI::SetTraceEventSink(const std::shared_ptr<ITraceEventSink>& sink)
+{
+    lock_guard<mutex> lock(trace_event_sink_mutex);
+    trace_event_sink = sink;
+    trace_event_sink_is_set.store(static_cast<bool>(sink), memory_order_relaxed);
+}
+
+std::shared_ptr<ITraceEventSink> libCZI::CreateChromeTraceEventSink(const std::shared_ptr<libCZI::IOutputStream>& stream)
+{
+    if (!stream)
+    {
+        throw invalid_argument("stream must not be null");
+    }
+
+    return make_shared<CChromeTraceEventSink>(stream);
+}
@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "libCZI.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace libCZI
+{
+    namespace detail
+    {
+        /// A set of performance counters and duration histograms. All operations are lock-free (and use relaxed memory
+        /// ordering), so this can be updated concurrently from multiple threads at low cost.
+        class PerformanceCounters
+        {
+        private:
+            struct AtomicDurationHistogram
+            {
+                std::atomic<std::uint64_t> count{ 0 };
+                std::atomic<std::uint64_t> total_nanoseconds{ 0 };
+                std::atomic<std::uint64_t> buckets[libCZI::DurationHistogram::kBucketCount] = {};
+            };
+
+            std::atomic<std::uint64_t> counters_[static_cast<size_t>(libCZI::PerformanceCounter::Count)] = {};
+            AtomicDurationHistogram timers_[static_cast<size_t>(libCZI::PerformanceTimer::Count)];
+        public:
+            PerformanceCounters() = default;
+            PerformanceCounters(const PerformanceCounters&) = delete;
+            PerformanceCounters& operator=(const PerformanceCounters&) = delete;
+
+            void Add(libCZI::PerformanceCounter counter, std::uint64_t value)
+            {
+                this->counters_[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+            }
+
+            void Increment(libCZI::PerformanceCounter counter)
+            {
+                this->Add(counter, 1);
+            }
+
+            void AddDuration(libCZI::PerformanceTimer timer, std::uint64_t nanoseconds);
+
+            libCZI::PerformanceCountersSnapshot GetSnapshot() const;
+
+            void Reset();
+
+            /// Gets the index of the histogram-bucket for the specified duration.
+            ///
+            /// \param  nanoseconds The duration in nanoseconds.
+            ///
+            /// \returns The index of the bucket.
+            static int GetBucketIndex(std::uint64_t nanoseconds);
+        };
+
+        /// Gets the global (process-wide) performance counters.
+        ///
+        /// \returns The global performance counters.
+        PerformanceCounters& GetGlobalCounters();
+
+        /// Increments the specified global counter by the specified value.
+        ///
+        /// \param  counter The counter.
+        /// \param  value   The value to add.
+        inline void AddToGlobalPerformanceCounter(libCZI::PerformanceCounter counter, std::uint64_t value)
+        {
+            GetGlobalCounters().Add(counter, value);
+        }
+
+        /// Gets the time elapsed since the specified point in time, in nanoseconds.
+        ///
+        /// \param  start   The start point in time.
+        ///
+        /// \returns The number of nanoseconds elapsed since the specified point in time.
+        inline std::uint64_t GetNanosecondsSince(std::chrono::steady_clock::time_point start)
+        {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        /// Determines whether a trace-event sink is currently set.
+        ///
+        /// \returns True if trace-events are to be reported; false otherwise.
+        bool IsTracingEnabled();
+
+        /// Reports the specified span to the trace-event sink (if there is one).
+        ///
+        /// \param  timer       The timer identifying the operation.
+        /// \param  start       The start of the span.
+        /// \param  duration    The duration of the span.
+        void ReportTraceEvent(libCZI::PerformanceTimer timer, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::duration duration);
+
+        /// A RAII-helper which measures the time between construction and destruction, and adds the duration to the global
+        /// duration histogram (and optionally to an additional set of counters), and reports it to the trace-event sink.
+        class ScopedPerformanceTimer
+        {
+        private:
+            libCZI::PerformanceTimer timer_;
+            PerformanceCounters* additional_counters_;
+            std::chrono::steady_clock::time_point start_;
+        public:
+            explicit ScopedPerformanceTimer(libCZI::PerformanceTimer timer, PerformanceCounters* additional_counters = nullptr)
+                : timer_(timer), additional_counters_(additional_counters), start_(std::chrono::steady_clock::now())
+            {
+            }
+
+            ScopedPerformanceTimer(const ScopedPerformanceTimer&) = delete;
+            ScopedPerformanceTimer& operator=(const ScopedPerformanceTimer&) = delete;
+
+            ~ScopedPerformanceTimer();
+        };
+
+        /// An input stream which is forwarding all calls to the specified stream, and records the number of calls, the
+        /// number of bytes read and the duration of the read operations (globally and in the specified counters).
+        class CInstrumentedInputStream : public libCZI::IStream
+        {
+        private:
+            std::shared_ptr<libCZI::IStream> stream_;
+            std::shared_ptr<PerformanceCounters> counters_;
+        public:
+            CInstrumentedInputStream(std::shared_ptr<libCZI::IStream> stream, std::shared_ptr<PerformanceCounters> counters)
+                : stream_(std::move(stream)), counters_(std::move(counters))
+            {
+            }
+
+            void Read(std::uint64_t offset, void* pv, std::uint64_t size, std::uint64_t* ptrBytesRead) override;
+        };
+    } // namespace detail
+} // namespace libCZI
@@ -6,6 +6,7 @@
 #include "libCZI_Utilities.h"
 #include <cmath>
 #include "Site.h"
+#include "Instrumentation.h"
 
 using namespace libCZI;
 using namespace libCZI::detail;
@@ -1294,6 +1295,7 @@ public:
     libCZI::IBitmapData* const* srcBitmaps,
     const ChannelInfo* channelInfos)
 {
+    ScopedPerformanceTimer timer(PerformanceTimer::MultiChannelComposition);
     CMultiChannelCompositor2::ComposeMultiChannel_Bgr24(dest, channelCount, srcBitmaps, channelInfos);
 }
 
@@ -1304,6 +1306,7 @@ public:
     libCZI::IBitmapData* const* srcBitmaps,
     const ChannelInfo* channelInfos)
 {
+    ScopedPerformanceTimer timer(PerformanceTimer::MultiChannelComposition);
     CMultiChannelCompositor2::ComposeMultiChannel_Bgra32(dest, channelCount, srcBitmaps, channelInfos, alphaVal);
 }
 
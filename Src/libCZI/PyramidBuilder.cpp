@@ -0,0 +1,289 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "PyramidBuilder.h"
+#include "bitmapData.h"
+#include "CziUtils.h"
+#include <cstring>
+#include <stdexcept>
+
+using namespace libCZI;
+using namespace libCZI::detail;
+using namespace std;
+
+namespace
+{
+    IntRect UnionOfRectangles(const IntRect& a, const IntRect& b)
+    {
+        if (!a.IsValid())
+        {
+            return b;
+        }
+
+        if (!b.IsValid())
+        {
+            return a;
+        }
+
+        const int x1 = (std::min)(a.x, b.x);
+        const int y1 = (std::min)(a.y, b.y);
+        const int x2 = (std::max)(a.x + a.w, b.x + b.w);
+        const int y2 = (std::max)(a.y + a.h, b.y + b.h);
+        return IntRect{ x1, y1, x2 - x1, y2 - y1 };
+    }
+}
+
+CPyramidBuilder::CPyramidBuilder(const Options& options, std::function<void(CSubBlockCompressionPipeline::Job&&)> emitSubBlock)
+    : options(options), emitSubBlock(std::move(emitSubBlock))
+{
+    if (options.minificationFactor != 2 && options.minificationFactor != 3)
+    {
+        throw invalid_argument("The minification factor for pyramid generation must be 2 or 3.");
+    }
+
+    if (options.tileSize < 16)
+    {
+        throw invalid_argument("The tile size for pyramid generation must be at least 16.");
+    }
+
+    switch (options.compressionMode)
+    {
+    case CompressionMode::UnCompressed:
+    case CompressionMode::Zstd0:
+    case CompressionMode::Zstd1:
+    case CompressionMode::JpgXr:
+        break;
+    default:
+        throw invalid_argument("The compression mode for pyramid generation is not supported.");
+    }
+}
+
+/*static*/bool CPyramidBuilder::IsLayer0SubBlock(const libCZI::AddSubBlockInfoBase& info)
+{
+    return info.logicalWidth == info.physicalWidth && info.logicalHeight == info.physicalHeight &&
+        info.pyramid_type == SubBlockPyramidType::None &&
+        info.physicalWidth > 0 && info.physicalHeight > 0;
+}
+
+void CPyramidBuilder::AddSubBlock(const libCZI::AddSubBlockInfoBase& info, const std::shared_ptr<libCZI::IBitmapData>& bitmap)
+{
+    if (!CPyramidBuilder::IsLayer0SubBlock(info))
+    {
+        return;
+    }
+
+    auto it = this->planes.find(info.coordinate);
+    if (it == this->planes.end())
+    {
+        Plane plane;
+        plane.coordinate = info.coordinate;
+        plane.pixelType = info.PixelType;
+        plane.extentLayer0.Invalidate();
+        it = this->planes.emplace(info.coordinate, std::move(plane)).first;
+    }
+    else if (it->second.pixelType != info.PixelType)
+    {
+        throw invalid_argument("For pyramid generation, all subblocks of a plane must have the same pixel type.");
+    }
+
+    const IntRect rect{ info.x, info.y, info.physicalWidth, info.physicalHeight };
+    it->second.extentLayer0 = UnionOfRectangles(it->second.extentLayer0, rect);
+    this->Contribute(it->second, 1, bitmap, rect, 1);
+}
+
+void CPyramidBuilder::Finish()
+{
+    for (auto& item : this->planes)
+    {
+        Plane& plane = item.second;
+        for (int layer = 1; static_cast<size_t>(layer) <= plane.layers.size(); ++layer)
+        {
+            if (!this->IsLayerRequired(plane, layer))
+            {
+                // if this layer is not required, then all layers above are not required either
+                break;
+            }
+
+            // emitting a tile may add tiles to the next layer (and may grow the "layers"-vector), so we take
+            //  the tiles out before iterating
+            const TilesOfLayer tiles = std::move(plane.layers[layer - 1]);
+            plane.layers[layer - 1].clear();
+            for (const auto& tile : tiles)
+            {
+                this->EmitTile(plane, layer, tile.second);
+            }
+        }
+    }
+
+    this->planes.clear();
+}
+
+void CPyramidBuilder::Contribute(Plane& plane, int layer, const std::shared_ptr<libCZI::IBitmapData>& source, const libCZI::IntRect& sourceRect, std::uint32_t sourceCount)
+{
+    const int f = this->options.minificationFactor;
+    const int tileSize = static_cast<int>(this->options.tileSize);
+
+    // The pixel (x,y) of this layer is taken from the pixel (x*f, y*f) of the layer below. So, we determine
+    //  the range of pixels in this layer for which the source pixel is within the source rectangle.
+    const int x0 = static_cast<int>(CPyramidBuilder::CeilDiv(sourceRect.x, f));
+    const int x1 = static_cast<int>(CPyramidBuilder::CeilDiv(sourceRect.x + sourceRect.w, f));
+    const int y0 = static_cast<int>(CPyramidBuilder::CeilDiv(sourceRect.y, f));
+    const int y1 = static_cast<int>(CPyramidBuilder::CeilDiv(sourceRect.y + sourceRect.h, f));
+    if (x1 <= x0 || y1 <= y0)
+    {
+        return;
+    }
+
+    if (plane.layers.size() < static_cast<size_t>(layer))
+    {
+        plane.layers.resize(layer);
+    }
+
+    const uint8_t bytesPerPel = CziUtils::GetBytesPerPel(plane.pixelType);
+    const IntRect contributionRect{ x0, y0, x1 - x0, y1 - y0 };
+
+    ScopedBitmapLockerSP lockedSource{ source };
+    const int tileYStart = static_cast<int>(CPyramidBuilder::FloorDiv(y0, tileSize));
+    const int tileYEnd = static_cast<int>(CPyramidBuilder::FloorDiv(y1 - 1, tileSize));
+    const int tileXStart = static_cast<int>(CPyramidBuilder::FloorDiv(x0, tileSize));
+    const int tileXEnd = static_cast<int>(CPyramidBuilder::FloorDiv(x1 - 1, tileSize));
+    for (int tileY = tileYStart; tileY <= tileYEnd; ++tileY)
+    {
+        for (int tileX = tileXStart; tileX <= tileXEnd; ++tileX)
+        {
+            TilesOfLayer& tiles = plane.layers[layer - 1];
+            const auto key = make_pair(tileY, tileX);
+            auto it = tiles.find(key);
+            if (it == tiles.end())
+            {
+                it = tiles.emplace(key, Tile(IntRect{ tileX * tileSize, tileY * tileSize, tileSize, tileSize })).first;
+                it->second.bitmap = this->CreateTileBitmap(plane.pixelType);
+            }
+
+            Tile& tile = it->second;
+            const IntRect rect = contributionRect.Intersect(tile.rect);
+            {
+                ScopedBitmapLockerSP lockedTile{ tile.bitmap };
+                for (int y = rect.y; y < rect.y + rect.h; ++y)
+                {
+                    const uint8_t* ptrSrcLine = static_cast<const uint8_t*>(lockedSource.ptrDataRoi) + static_cast<size_t>(y * f - sourceRect.y) * lockedSource.stride;
+                    uint8_t* ptrDst = static_cast<uint8_t*>(lockedTile.ptrDataRoi) + static_cast<size_t>(y - tile.rect.y) * lockedTile.stride + static_cast<size_t>(rect.x - tile.rect.x) * bytesPerPel;
+                    for (int x = rect.x; x < rect.x + rect.w; ++x)
+                    {
+                        memcpy(ptrDst, ptrSrcLine + static_cast<size_t>(x * f - sourceRect.x) * bytesPerPel, bytesPerPel);
+                        ptrDst += bytesPerPel;
+                    }
+                }
+            }
+
+            tile.coverage.AddRectangle(rect);
+            tile.boundingBox = UnionOfRectangles(tile.boundingBox, rect);
+            tile.sourceCount += sourceCount;
+
+            if (tile.coverage.IsCompletelyCovered())
+            {
+                // Note: we need to remove the tile from the map before emitting it, because emitting it may modify the
+                //  "layers"-vector (and thereby invalidate the reference "tiles")
+                const Tile completedTile = std::move(tile);
+                plane.layers[layer - 1].erase(key);
+                this->EmitTile(plane, layer, completedTile);
+            }
+        }
+    }
+}
+
+void CPyramidBuilder::EmitTile(Plane& plane, int layer, const Tile& tile)
+{
+    const IntRect& boundingBox = tile.boundingBox;
+    if (!boundingBox.IsValid() || !boundingBox.IsNonEmpty())
+    {
+        return;
+    }
+
+    // crop the tile to the part which actually has been covered
+    const uint8_t bytesPerPel = CziUtils::GetBytesPerPel(plane.pixelType);
+    auto bitmap = CStdBitmapData::Create(plane.pixelType, boundingBox.w, boundingBox.h);
+    {
+        ScopedBitmapLockerSP lockedTile{ tile.bitmap };
+        ScopedBitmapLockerSP lockedDestination{ bitmap };
+        for (int y = 0; y < boundingBox.h; ++y)
+        {
+            memcpy(
+                static_cast<uint8_t*>(lockedDestination.ptrDataRoi) + static_cast<size_t>(y) * lockedDestination.stride,
+                static_cast<const uint8_t*>(lockedTile.ptrDataRoi) + static_cast<size_t>(boundingBox.y - tile.rect.y + y) * lockedTile.stride + static_cast<size_t>(boundingBox.x - tile.rect.x) * bytesPerPel,
+                static_cast<size_t>(boundingBox.w) * bytesPerPel);
+        }
+    }
+
+    const int64_t scale = this->GetScaleOfLayer(layer);
+    CSubBlockCompressionPipeline::Job job;
+    job.info.coordinate = plane.coordinate;
+    job.info.mIndexValid = false;
+    job.info.x = static_cast<int>(boundingBox.x * scale);
+    job.info.y = static_cast<int>(boundingBox.y * scale);
+    job.info.logicalWidth = static_cast<int>(boundingBox.w * scale);
+    job.info.logicalHeight = static_cast<int>(boundingBox.h * scale);
+    job.info.physicalWidth = boundingBox.w;
+    job.info.physicalHeight = boundingBox.h;
+    job.info.PixelType = plane.pixelType;
+    job.info.pyramid_type = tile.sourceCount > 1 ? SubBlockPyramidType::MultiSubBlock : SubBlockPyramidType::SingleSubBlock;
+    job.info.SetCompressionMode(this->options.compressionMode);
+    job.bitmap = bitmap;
+    job.compressionParameters = this->options.compressionParameters;
+    this->emitSubBlock(std::move(job));
+
+    // and this tile is now a contribution to the next layer
+    this->Contribute(plane, layer + 1, bitmap, boundingBox, tile.sourceCount);
+}
+
+bool CPyramidBuilder::IsLayerRequired(const Plane& plane, int layer) const
+{
+    // a layer is required if the extent of the plane in the layer below does not fit into a single tile
+    const IntRect& extent = plane.extentLayer0;
+    if (!extent.IsValid() || !extent.IsNonEmpty())
+    {
+        return false;
+    }
+
+    const int64_t scale = this->GetScaleOfLayer(layer - 1);
+    const int64_t width = CPyramidBuilder::CeilDiv(extent.x + static_cast<int64_t>(extent.w), scale) - CPyramidBuilder::CeilDiv(extent.x, scale);
+    const int64_t height = CPyramidBuilder::CeilDiv(extent.y + static_cast<int64_t>(extent.h), scale) - CPyramidBuilder::CeilDiv(extent.y, scale);
+    return width > this->options.tileSize || height > this->options.tileSize;
+}
+
+std::int64_t CPyramidBuilder::GetScaleOfLayer(int layer) const
+{
+    int64_t scale = 1;
+    for (int i = 0; i < layer; ++i)
+    {
+        scale *= this->options.minificationFactor;
+    }
+
+    return scale;
+}
+
+std::shared_ptr<libCZI::IBitmapData> CPyramidBuilder::CreateTileBitmap(libCZI::PixelType pixelType) const
+{
+    auto bitmap = CStdBitmapData::Create(pixelType, this->options.tileSize, this->options.tileSize);
+    ScopedBitmapLockerSP lockedBitmap{ bitmap };
+    const size_t lineSize = static_cast<size_t>(this->options.tileSize) * CziUtils::GetBytesPerPel(pixelType);
+    for (uint32_t y = 0; y < this->options.tileSize; ++y)
+    {
+        memset(static_cast<uint8_t*>(lockedBitmap.ptrDataRoi) + static_cast<size_t>(y) * lockedBitmap.stride, 0, lineSize);
+    }
+
+    return bitmap;
+}
+
+/*static*/std::int64_t CPyramidBuilder::FloorDiv(std::int64_t a, std::int64_t b)
+{
+    const int64_t q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+/*static*/std::int64_t CPyramidBuilder::CeilDiv(std::int64_t a, std::int64_t b)
+{
+    const int64_t q = a / b;
+    return (a % b != 0 && ((a < 0) == (b < 0))) ? q + 1 : q;
+}
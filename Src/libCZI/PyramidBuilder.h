@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "libCZI.h"
+#include "SubBlockCompressionPipeline.h"
+#include "utilities.h"
+
+namespace libCZI
+{
+    namespace detail
+    {
+        /// This class is used to create pyramid layers "on the fly" while layer-0 subblocks are added to a CZI. For each plane
+        /// (i.e. for each coordinate), the pyramid layers are divided into tiles (of size "tileSize" x "tileSize" pixels), and the
+        /// tiles are filled (by nearest-neighbor-downsampling, i.e. with the same scheme as used by the scaling accessor) as the
+        /// layer-0 subblocks come in. When a tile is completely covered, it is emitted (as a pyramid subblock) and released, and it
+        /// contributes to the tile of the next pyramid layer. Tiles which are not completely covered (e.g. at the border of the
+        /// mosaic) are emitted with "Finish". So, memory is needed only for the tiles which are "in progress" (which is proportional to the
+        /// perimeter of the mosaic rather than its area for the common case of a scan in raster order).
+        /// Pyramid layers are created until the extent of the plane (in the respective layer) fits into a single tile. Pyramid subblocks
+        /// are cropped to the part of the tile which actually has been covered, and they are emitted without an M-index.
+        class CPyramidBuilder
+        {
+        public:
+            /// Options controlling the operation.
+            struct Options
+            {
+                std::uint8_t minificationFactor;    ///< The minification factor between adjacent pyramid layers (must be 2 or 3).
+                std::uint32_t tileSize;             ///< The (maximum) width and height of the pyramid subblocks in pixels.
+                libCZI::CompressionMode compressionMode;    ///< The compression mode for the pyramid subblocks.
+                std::shared_ptr<libCZI::ICompressParameters> compressionParameters; ///< The compression parameters for the pyramid subblocks (may be null).
+            };
+
+            /// Constructor. An invalid_argument-exception is thrown if the options are not valid.
+            ///
+            /// \param  options         The options.
+            /// \param  emitSubBlock    The functor which is called for each pyramid subblock created.
+            CPyramidBuilder(const Options& options, std::function<void(CSubBlockCompressionPipeline::Job&&)> emitSubBlock);
+
+            /// Query whether the specified subblock is considered by the pyramid builder, i.e. whether it is a layer-0 subblock
+            /// (where the logical size is equal to the physical size and where the pyramid type is "None").
+            ///
+            /// \param  info    Information describing the subblock.
+            ///
+            /// \returns True if the subblock is a layer-0 subblock; false otherwise.
+            static bool IsLayer0SubBlock(const libCZI::AddSubBlockInfoBase& info);
+
+            /// Adds a (layer-0) subblock. Subblocks which are not on layer-0 (c.f. "IsLayer0SubBlock") are ignored.
+            ///
+            /// \param  info    Information describing the subblock.
+            /// \param  bitmap  The (uncompressed) bitmap of the subblock.
+            void AddSubBlock(const libCZI::AddSubBlockInfoBase& info, const std::shared_ptr<libCZI::IBitmapData>& bitmap);
+
+            /// Emits all tiles which are still pending, and release all resources.
+            void Finish();
+        private:
+            struct Tile
+            {
+                explicit Tile(const libCZI::IntRect& rect) : rect(rect), coverage(rect), sourceCount(0)
+                {
+                    boundingBox.Invalidate();
+                }
+
+                libCZI::IntRect rect;                       ///< The rectangle of the tile (in pixel coordinates of the pyramid layer).
+                std::shared_ptr<libCZI::IBitmapData> bitmap;
+                RoiCoverageTracker coverage;
+                libCZI::IntRect boundingBox;                ///< The bounding box of the part of the tile which has been covered so far.
+                std::uint32_t sourceCount;                  ///< The number of subblocks (of the layer below) contributing to this tile.
+            };
+
+            /// The tiles of a pyramid layer - the key is (tile-index in y, tile-index in x), so that the tiles are ordered "row-major".
+            typedef std::map<std::pair<int, int>, Tile> TilesOfLayer;
+
+            struct Plane
+            {
+                libCZI::CDimCoordinate coordinate;
+                libCZI::PixelType pixelType;
+                libCZI::IntRect extentLayer0;
+
+                /// The tiles of the pyramid layers, at index 0 we find layer 1, at index 1 layer 2 and so on.
+                std::vector<TilesOfLayer> layers;
+            };
+
+            struct CoordinateLess
+            {
+                bool operator()(const libCZI::CDimCoordinate& a, const libCZI::CDimCoordinate& b) const
+                {
+                    return libCZI::Utils::Compare(&a, &b) < 0;
+                }
+            };
+
+            Options options;
+            std::function<void(CSubBlockCompressionPipeline::Job&&)> emitSubBlock;
+            std::map<libCZI::CDimCoordinate, Plane, CoordinateLess> planes;
+
+            void Contribute(Plane& plane, int layer, const std::shared_ptr<libCZI::IBitmapData>& source, const libCZI::IntRect& sourceRect, std::uint32_t sourceCount);
+            void EmitTile(Plane& plane, int layer, const Tile& tile);
+            bool IsLayerRequired(const Plane& plane, int layer) const;
+            std::int64_t GetScaleOfLayer(int layer) const;
+            std::shared_ptr<libCZI::IBitmapData> CreateTileBitmap(libCZI::PixelType pixelType) const;
+
+            static std::int64_t FloorDiv(std::int64_t a, std::int64_t b);
+            static std::int64_t CeilDiv(std::int64_t a, std::int64_t b);
+        };
+    } // namespace detail
+} // namespace libCZI
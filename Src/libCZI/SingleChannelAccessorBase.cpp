@@ -6,11 +6,62 @@
 #include "BitmapOperations.h"
 #include "libCZI_Pixels.h"
 #include "utilities.h"
+#include "Instrumentation.h"
 
 using namespace std;
 using namespace libCZI;
 using namespace libCZI::detail;
 
+CGradationLookUpTableProvider::CGradationLookUpTableProvider(const libCZI::AccessorGradation& gradation, libCZI::PixelType destinationPixelType)
+    : gradation(gradation)
+{
+    if (this->gradation.enabled && destinationPixelType != PixelType::Gray8)
+    {
+        throw invalid_argument("A gradation can only be applied if the destination pixeltype is Gray8.");
+    }
+}
+
+const std::uint8_t* CGradationLookUpTableProvider::GetLookUpTable(libCZI::PixelType sourcePixelType)
+{
+    if (!this->gradation.enabled)
+    {
+        return nullptr;
+    }
+
+    vector<uint8_t>* look_up_table;
+    int look_up_table_element_count;
+    switch (sourcePixelType)
+    {
+    case PixelType::Gray8:
+        look_up_table = &this->lookUpTableGray8;
+        look_up_table_element_count = 256;
+        break;
+    case PixelType::Gray16:
+        look_up_table = &this->lookUpTableGray16;
+        look_up_table_element_count = 65536;
+        break;
+    default:
+        throw invalid_argument("A gradation can only be applied if the source pixeltype is Gray8 or Gray16.");
+    }
+
+    if (this->gradation.lookUpTableElementCount != 0)
+    {
+        if (this->gradation.lookUpTableElementCount != look_up_table_element_count || this->gradation.ptrLookUpTable == nullptr)
+        {
+            throw invalid_argument("The look-up table of the gradation does not match the source pixeltype.");
+        }
+
+        return this->gradation.ptrLookUpTable;
+    }
+
+    if (look_up_table->empty())
+    {
+        *look_up_table = Utils::Create8BitLookUpTableFromGamma(look_up_table_element_count, this->gradation.blackPoint, this->gradation.whitePoint, 1.0f);
+    }
+
+    return look_up_table->data();
+}
+
 bool CSingleChannelAccessorBase::TryGetPixelType(const libCZI::IDimCoordinate* planeCoordinate, libCZI::PixelType& pixeltype)
 {
     int c = (numeric_limits<int>::min)();
@@ -30,6 +81,33 @@ bool CSingleChannelAccessorBase::TryGetPixelType(const libCZI::IDimCoordinate* p
     }
 }
 
+/*static*/void CSingleChannelAccessorBase::ClearUncoveredArea(libCZI::IBitmapData* bm, const libCZI::RgbFloatColor& floatColor, int count, const std::function<libCZI::IntRect(int)>& get_rect_of_tile)
+{
+    if (isnan(floatColor.r) || isnan(floatColor.g) || isnan(floatColor.b))
+    {
+        return;
+    }
+
+    RoiCoverageTracker coverage_tracker(IntRect{ 0, 0, static_cast<int>(bm->GetWidth()), static_cast<int>(bm->GetHeight()) });
+    for (int i = 0; i < count && !coverage_tracker.IsCompletelyCovered(); ++i)
+    {
+        coverage_tracker.AddRectangle(get_rect_of_tile(i));
+    }
+
+    if (coverage_tracker.GetCoveredArea() == 0)
+    {
+        // nothing is covered, so we can as well fill the whole bitmap in one go
+        CBitmapOperations::Fill(bm, floatColor);
+        return;
+    }
+
+    coverage_tracker.EnumerateUncoveredRectangles(
+        [&](const IntRect& rect)->void
+        {
+            CBitmapOperations::Fill(bm, rect, floatColor);
+        });
+}
+
 void CSingleChannelAccessorBase::CheckPlaneCoordinates(const libCZI::IDimCoordinate* planeCoordinate) const
 {
     // planeCoordinate must not contain S
@@ -92,19 +170,24 @@ std::vector<int> CSingleChannelAccessorBase::CheckForVisibility(const libCZI::In
         get_subblock_index,
         [this](int subblock_index) -> IntRect
             {
-                SubBlockInfo subblock_info;
-                const bool result = this->sbBlkRepository->TryGetSubBlockInfo(subblock_index, &subblock_info);
-                if (!result)
-                {
-                    stringstream ss;
-                    ss << "SubBlockInfo not found in repository for subblock index " << subblock_index << ".";
-                    throw LibCZIAccessorException(ss.str().c_str(), LibCZIAccessorException::ErrorType::InternalInconsistency);
-                }
-
-                return subblock_info.logicalRect;
+                return this->GetLogicalRectOfSubBlock(subblock_index);
             });
 }
 
+libCZI::IntRect CSingleChannelAccessorBase::GetLogicalRectOfSubBlock(int subblock_index) const
+{
+    SubBlockInfo subblock_info;
+    const bool result = this->sbBlkRepository->TryGetSubBlockInfo(subblock_index, &subblock_info);
+    if (!result)
+    {
+        stringstream ss;
+        ss << "SubBlockInfo not found in repository for subblock index " << subblock_index << ".";
+        throw LibCZIAccessorException(ss.str().c_str(), LibCZIAccessorException::ErrorType::InternalInconsistency);
+    }
+
+    return subblock_info.logicalRect;
+}
+
 /*static*/std::vector<int> CSingleChannelAccessorBase::CheckForVisibilityCore(const libCZI::IntRect& roi, int count, const std::function<int(int)>& get_subblock_index, const std::function<libCZI::IntRect(int)>& get_rect_of_subblock)
 {
     std::vector<int> result;
@@ -115,23 +198,19 @@ std::vector<int> CSingleChannelAccessorBase::CheckForVisibility(const libCZI::In
         return result;
     }
 
-    const int64_t total_pixel_count = static_cast<int64_t>(roi.w) * roi.h;
     result.reserve(count);
-    RectangleCoverageCalculator coverage_calculator;
-    int64_t covered_pixel_count = 0;
+    RoiCoverageTracker coverage_tracker(roi);
     for (int i = count - 1; i >= 0; --i) // we start at the end, because that is the subblock which is rendered last (and thus is on top)
     {
         const int subblock_index = get_subblock_index(i);
-        coverage_calculator.AddRectangle(get_rect_of_subblock(subblock_index));
-        const int64_t new_covered_pixel_count = coverage_calculator.CalcAreaOfIntersectionWithRectangle(roi);
-        if (new_covered_pixel_count > covered_pixel_count)  // if the covered pixel count has increased, it means that this subblock covers some new pixels,
-        {                                                   //  some pixels which were not overdrawn by all the previous ones
+        const int64_t newly_covered_pixel_count = coverage_tracker.AddRectangle(get_rect_of_subblock(subblock_index));
+        if (newly_covered_pixel_count > 0)  // if the covered pixel count has increased, it means that this subblock covers some new pixels,
+        {                                   //  some pixels which were not overdrawn by all the previous ones
             // this means - when drawing this subblock, some new pixels will be covered which were not covered before,
             //  so we need to draw this subblock, therefore we add it to our result vector
             result.push_back(i);
 
-            covered_pixel_count = new_covered_pixel_count;
-            if (new_covered_pixel_count == total_pixel_count)
+            if (coverage_tracker.IsCompletelyCovered())
             {
                 // if the whole ROI is covered now, then we are done
                 break;
@@ -139,6 +218,8 @@ std::vector<int> CSingleChannelAccessorBase::CheckForVisibility(const libCZI::In
         }
     }
 
+    AddToGlobalPerformanceCounter(PerformanceCounter::TilesCulledByVisibilityCheck, static_cast<uint64_t>(count) - result.size());
+
     // now, reverse the result vector, so that the subblocks are in the order in which they are to be rendered
     std::reverse(result.begin(), result.end());
     return result;
@@ -149,15 +230,16 @@ std::vector<int> CSingleChannelAccessorBase::CheckForVisibility(const libCZI::In
     const std::shared_ptr<libCZI::ISubBlockCacheOperation>& cache,
     int sub_block_index,
     bool only_add_compressed_sub_blocks_to_cache,
-    bool mask_aware_mode)
+    bool mask_aware_mode,
+    libCZI::AccessorStatistics* statistics)
 {
     SubBlockData result;
 
     // if no cache-object is given, then we simply read the subblock and create a bitmap from it
     if (!cache)
     {
-        const auto subblock = sub_block_repository->ReadSubBlock(sub_block_index);
-        result.bitmap = subblock->CreateBitmap();
+        const auto subblock = CSingleChannelAccessorBase::ReadSubBlock(sub_block_repository, sub_block_index, statistics);
+        result.bitmap = CSingleChannelAccessorBase::CreateBitmapFromSubBlock(subblock, statistics);
         result.subBlockInfo = subblock->GetSubBlockInfo();
         result.mask = mask_aware_mode ? CSingleChannelAccessorBase::TryToGetMaskBitmapFromSubBlock(subblock) : nullptr;
     }
@@ -166,6 +248,12 @@ std::vector<int> CSingleChannelAccessorBase::CheckForVisibility(const libCZI::In
         const auto bitmap_from_cache = cache->Get(sub_block_index);
         if (bitmap_from_cache.IsValid())
         {
+            AddToGlobalPerformanceCounter(PerformanceCounter::SubBlockCacheHits, 1);
+            if (statistics != nullptr)
+            {
+                ++statistics->subBlocksFromCache;
+            }
+
             const bool b = sub_block_repository->TryGetSubBlockInfo(sub_block_index, &result.subBlockInfo);
             if (!b)
             {
@@ -179,8 +267,9 @@ std::vector<int> CSingleChannelAccessorBase::CheckForVisibility(const libCZI::In
         }
         else
         {
-            const auto subblock = sub_block_repository->ReadSubBlock(sub_block_index);
-            result.bitmap = subblock->CreateBitmap();
+            AddToGlobalPerformanceCounter(PerformanceCounter::SubBlockCacheMisses, 1);
+            const auto subblock = CSingleChannelAccessorBase::ReadSubBlock(sub_block_repository, sub_block_index, statistics);
+            result.bitmap = CSingleChannelAccessorBase::CreateBitmapFromSubBlock(subblock, statistics);
             result.mask = mask_aware_mode ? CSingleChannelAccessorBase::TryToGetMaskBitmapFromSubBlock(subblock) : nullptr;
             result.subBlockInfo = subblock->GetSubBlockInfo();
             if (!only_add_compressed_sub_blocks_to_cache || result.subBlockInfo.GetCompressionMode() != CompressionMode::UnCompressed)
@@ -193,6 +282,37 @@ std::vector<int> CSingleChannelAccessorBase::CheckForVisibility(const libCZI::In
     return result;
 }
 
+/*static*/std::shared_ptr<libCZI::ISubBlock> CSingleChannelAccessorBase::ReadSubBlock(const std::shared_ptr<libCZI::ISubBlockRepository>& sub_block_repository, int sub_block_index, libCZI::AccessorStatistics* statistics)
+{
+    if (statistics == nullptr)
+    {
+        return sub_block_repository->ReadSubBlock(sub_block_index);
+    }
+
+    const auto start = chrono::steady_clock::now();
+    auto sub_block = sub_block_repository->ReadSubBlock(sub_block_index);
+    statistics->readNanoseconds += GetNanosecondsSince(start);
+    ++statistics->subBlocksReadFromStream;
+    const void* ptr_data;
+    size_t size_data;
+    sub_block->DangerousGetRawData(ISubBlock::MemBlkType::Data, ptr_data, size_data);
+    statistics->compressedBytesRead += size_data;
+    return sub_block;
+}
+
+/*static*/std::shared_ptr<libCZI::IBitmapData> CSingleChannelAccessorBase::CreateBitmapFromSubBlock(const std::shared_ptr<libCZI::ISubBlock>& sub_block, libCZI::AccessorStatistics* statistics)
+{
+    if (statistics == nullptr)
+    {
+        return sub_block->CreateBitmap();
+    }
+
+    const auto start = chrono::steady_clock::now();
+    auto bitmap = sub_block->CreateBitmap();
+    statistics->decodeNanoseconds += GetNanosecondsSince(start);
+    return bitmap;
+}
+
 /*static*/std::shared_ptr<libCZI::IBitonalBitmapData> CSingleChannelAccessorBase::TryToGetMaskBitmapFromSubBlock(const std::shared_ptr<libCZI::ISubBlock>& sub_block)
 {
     auto sub_block_metadata = CreateSubBlockMetadataFromSubBlock(sub_block.get());
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "libCZI.h"
 
 namespace libCZI
@@ -12,6 +13,33 @@ namespace libCZI
     namespace detail
     {
 
+        /// This class provides the look-up tables for applying a gradation (c.f. libCZI::AccessorGradation) while composing
+        /// tiles. The look-up table depends on the pixel type of the source, and it is created (at most once per pixel type)
+        /// when it is requested for the first time. An instance is intended to be used for the duration of one accessor-call.
+        class CGradationLookUpTableProvider
+        {
+        private:
+            libCZI::AccessorGradation gradation;
+            std::vector<std::uint8_t> lookUpTableGray8;
+            std::vector<std::uint8_t> lookUpTableGray16;
+        public:
+            /// Constructor. If the gradation is enabled, the destination pixel type must be Gray8, otherwise an
+            /// invalid_argument-exception is thrown.
+            ///
+            /// \param  gradation               The gradation.
+            /// \param  destinationPixelType    The pixel type of the destination bitmap.
+            CGradationLookUpTableProvider(const libCZI::AccessorGradation& gradation, libCZI::PixelType destinationPixelType);
+
+            /// Gets the look-up table to be used for a source bitmap of the specified pixel type. If the gradation is not
+            /// enabled, then null is returned. If the gradation cannot be applied to the specified pixel type (or the
+            /// size of the look-up table given with the gradation does not match), an invalid_argument-exception is thrown.
+            ///
+            /// \param  sourcePixelType The pixel type of the source bitmap.
+            ///
+            /// \returns    Pointer to the look-up table (or null if the gradation is not enabled).
+            const std::uint8_t* GetLookUpTable(libCZI::PixelType sourcePixelType);
+        };
+
         class CSingleChannelAccessorBase
         {
         protected:
@@ -26,6 +54,19 @@ namespace libCZI
 
             static void Clear(libCZI::IBitmapData* bm, const libCZI::RgbFloatColor& floatColor);
 
+            /// Clear the part of the bitmap which is not covered by any of the specified tiles with the specified color. This is
+            /// intended to be used (instead of 'Clear') before composing the tiles, in which case the result is the same as
+            /// clearing the whole bitmap - provided that the tiles are opaque (i.e. no mask is applied) and are drawn exactly
+            /// within the rectangles given here.
+            /// If any of R, G or B is NaN, then nothing is done.
+            ///
+            /// \param [in] bm              The bitmap.
+            /// \param      floatColor      The color to fill with.
+            /// \param      count           The number of tiles (specifying how many times the 'get_rect_of_tile'-functor is being called).
+            /// \param      get_rect_of_tile Functor which gives the rectangle (in pixel coordinates of the bitmap) of the tile for the
+            ///                             specified index (in the range 0 to count-1).
+            static void ClearUncoveredArea(libCZI::IBitmapData* bm, const libCZI::RgbFloatColor& floatColor, int count, const std::function<libCZI::IntRect(int)>& get_rect_of_tile);
+
             void CheckPlaneCoordinates(const libCZI::IDimCoordinate* planeCoordinate) const;
 
             /// This method is used to do a visibility test of a list of subblocks. The mode of operation is as follows:
@@ -50,6 +91,14 @@ namespace libCZI
             ///             given here, then the result is guaranteed to be the same as if all subblocks were rendered.
             std::vector<int> CheckForVisibility(const libCZI::IntRect& roi, int count, const std::function<int(int)>& get_subblock_index) const;
 
+            /// Gets the logical rectangle of the specified subblock (from the subblock repository). If the subblock is not found,
+            /// an exception is thrown.
+            ///
+            /// \param  subblock_index  The subblock index.
+            ///
+            /// \returns    The logical rectangle of the subblock.
+            libCZI::IntRect GetLogicalRectOfSubBlock(int subblock_index) const;
+
             /// Do a visibility check for a list of subblocks. This is the core method, which is used by the public method 'CheckForVisibility'.
             /// What this function does, is:
             /// - The method is given a ROI, and the number of subblocks to check.    
@@ -112,6 +161,8 @@ namespace libCZI
             /// \param  mask_aware_mode                 When true, attempts to extract and include mask information
             ///                                         from the subblock's attachment data. When false, the mask
             ///                                         field in the returned data will be nullptr.
+            /// \param  statistics                      If non-null, the counters and durations for reading, decoding and
+            ///                                         cache usage are added here.
             ///
             /// \returns                                A SubBlockData structure containing:
             ///                                         - bitmap: The decoded pixel data as IBitmapData
@@ -131,9 +182,13 @@ namespace libCZI
                 const std::shared_ptr<libCZI::ISubBlockCacheOperation>& cache,
                 int sub_block_index,
                 bool only_add_compressed_sub_blocks_to_cache,
-                bool mask_aware_mode);
+                bool mask_aware_mode,
+                libCZI::AccessorStatistics* statistics = nullptr);
 
             static std::shared_ptr<libCZI::IBitonalBitmapData> TryToGetMaskBitmapFromSubBlock(const std::shared_ptr<libCZI::ISubBlock>& sub_block);
+        private:
+            static std::shared_ptr<libCZI::ISubBlock> ReadSubBlock(const std::shared_ptr<libCZI::ISubBlockRepository>& sub_block_repository, int sub_block_index, libCZI::AccessorStatistics* statistics);
+            static std::shared_ptr<libCZI::IBitmapData> CreateBitmapFromSubBlock(const std::shared_ptr<libCZI::ISubBlock>& sub_block, libCZI::AccessorStatistics* statistics);
         };
 
     } // namespace detail
@@ -5,7 +5,9 @@
 #include <cmath>
 #include "SingleChannelPyramidLevelTileAccessor.h"
 #include "utilities.h"
+#include "SingleChannelTileCompositor.h"
 #include "Site.h"
+#include "Instrumentation.h"
 
 using namespace libCZI;
 using namespace libCZI::detail;
@@ -75,12 +77,13 @@ CSingleChannelPyramidLevelTileAccessor::CSingleChannelPyramidLevelTileAccessor(c
 
 void CSingleChannelPyramidLevelTileAccessor::InternalGet(libCZI::IBitmapData* pDest, int xPos, int yPos, int sizeOfPixelOnLayer0, const libCZI::IDimCoordinate* planeCoordinate, const PyramidLayerInfo& pyramidInfo, const Options& options)
 {
+    ScopedPerformanceTimer timer(PerformanceTimer::SingleChannelAccessorGet);
     this->CheckPlaneCoordinates(planeCoordinate);
-    Clear(pDest, options.backGroundColor);
     const auto sizeBitmap = pDest->GetSize();
     const auto subSet = GetSubBlocksSubset(IntRect{ xPos,yPos,static_cast<int>(sizeBitmap.w) * sizeOfPixelOnLayer0,static_cast<int>(sizeBitmap.h) * sizeOfPixelOnLayer0 }, planeCoordinate, pyramidInfo, options.sceneFilter.get(), options.sortByM);
     if (subSet.empty())
-    {	// no subblocks were found in the requested plane/ROI, so there is nothing to do
+    {	// no subblocks were found in the requested plane/ROI, so there is nothing to do (besides clearing the background)
+        Clear(pDest, options.backGroundColor);
         return;
     }
 
@@ -88,6 +91,24 @@ void CSingleChannelPyramidLevelTileAccessor::InternalGet(libCZI::IBitmapData* pD
     // ok, now we just have to look at our requested pyramid-layer
     const auto& indices = byLayer.at(pyramidInfo.pyramidLayerNo).indices;
 
+    if (options.maskAware)
+    {
+        // with masks, the tiles are not necessarily opaque, so we need to clear the whole bitmap
+        Clear(pDest, options.backGroundColor);
+    }
+    else
+    {
+        // only clear the part of the bitmap which is not going to be covered by a tile anyway
+        ClearUncoveredArea(
+            pDest,
+            options.backGroundColor,
+            static_cast<int>(indices.size()),
+            [&](int index)->IntRect
+            {
+                return CalcTileRectInDestination(subSet.at(indices.at(index)), xPos, yPos, sizeOfPixelOnLayer0);
+            });
+    }
+
     // and now... copy...
     this->ComposeTiles(pDest, xPos, yPos, sizeOfPixelOnLayer0, static_cast<int>(indices.size()), options,
         [&](int idx)->SbInfo
@@ -98,35 +119,67 @@ void CSingleChannelPyramidLevelTileAccessor::InternalGet(libCZI::IBitmapData* pD
 
 void CSingleChannelPyramidLevelTileAccessor::ComposeTiles(libCZI::IBitmapData* bm, int xPos, int yPos, int sizeOfPixel, int bitmapCnt, const Options& options, const std::function<SbInfo(int)>& getSbInfo)
 {
-    Compositors::ComposeSingleTileOptions composeOptions;
-    composeOptions.Clear();
-    composeOptions.drawTileBorder = options.drawTileBorder;
+    // the look-up tables for the gradation (if any) are created (at most) once for this call, and then used for all tiles
+    CGradationLookUpTableProvider gradation_look_up_tables(options.gradation, bm->GetPixelType());
 
-    Compositors::ComposeSingleChannelTilesMaskAware(
-        [&](int index, std::shared_ptr<libCZI::IBitmapData>& out_bitmap, std::shared_ptr<libCZI::IBitonalBitmapData>& out_mask_bitmap, int& tile_x_position, int& tile_y_position)->bool
-        {
-            if (index < bitmapCnt)
+    const auto compose_sub_block = [&](const SbInfo& sub_block_info)->void
+    {
+        const auto subblock_bitmap_data = CSingleChannelAccessorBase::GetSubBlockDataIncludingMaskForSubBlockIndex(
+                this->sbBlkRepository,
+                options.subBlockCache,
+                sub_block_info.index,
+                options.onlyUseSubBlockCacheForCompressedData,
+                options.maskAware);
+        CSingleChannelTileCompositor::ComposeMaskAware(
+            bm,
+            subblock_bitmap_data.bitmap.get(),
+            subblock_bitmap_data.mask.get(),
+            (subblock_bitmap_data.subBlockInfo.logicalRect.x - xPos) / sizeOfPixel,
+            (subblock_bitmap_data.subBlockInfo.logicalRect.y - yPos) / sizeOfPixel,
+            options.drawTileBorder,
+            gradation_look_up_tables.GetLookUpTable(subblock_bitmap_data.bitmap->GetPixelType()));
+    };
+
+    if (options.useVisibilityCheckOptimization)
+    {
+        // The visibility check is done in the coordinate system of the destination bitmap, where the position of a tile is
+        //  determined exactly as it is done when drawing it (and its extent is given by the physical size).
+        const auto indices_of_visible_tiles = CSingleChannelAccessorBase::CheckForVisibilityCore(
+            { 0, 0, static_cast<int>(bm->GetWidth()), static_cast<int>(bm->GetHeight()) },
+            bitmapCnt,
+            [](int index)->int
             {
-                const SbInfo sub_block_info = getSbInfo(index);
-                const auto subblock_bitmap_data = CSingleChannelAccessorBase::GetSubBlockDataIncludingMaskForSubBlockIndex(
-                        this->sbBlkRepository,
-                        options.subBlockCache,
-                        sub_block_info.index,
-                        options.onlyUseSubBlockCacheForCompressedData,
-                        options.maskAware);
-                out_bitmap = subblock_bitmap_data.bitmap;
-                out_mask_bitmap = subblock_bitmap_data.mask;
-                tile_x_position = (subblock_bitmap_data.subBlockInfo.logicalRect.x - xPos) / sizeOfPixel;
-                tile_y_position = (subblock_bitmap_data.subBlockInfo.logicalRect.y - yPos) / sizeOfPixel;
-                return true;
-            }
+                return index;
+            },
+            [&](int index)->IntRect
+            {
+                return CalcTileRectInDestination(getSbInfo(index), xPos, yPos, sizeOfPixel);
+            });
 
-            return false;
-        },
-        bm,
-        0,
-        0,
-        &composeOptions);
+        for (const int index : indices_of_visible_tiles)
+        {
+            compose_sub_block(getSbInfo(index));
+        }
+    }
+    else
+    {
+        for (int index = 0; index < bitmapCnt; ++index)
+        {
+            compose_sub_block(getSbInfo(index));
+        }
+    }
+}
+
+/*static*/libCZI::IntRect CSingleChannelPyramidLevelTileAccessor::CalcTileRectInDestination(const SbInfo& sbInfo, int xPos, int yPos, int sizeOfPixel)
+{
+    // this must give exactly the position where the tile is drawn in 'ComposeTiles'
+    return IntRect
+    {
+        (sbInfo.logicalRect.x - xPos) / sizeOfPixel,
+        (sbInfo.logicalRect.y - yPos) / sizeOfPixel,
+        static_cast<int>(sbInfo.physicalSize.w),
+        static_cast<int>(sbInfo.physicalSize.h)
+    };
 }
 
 libCZI::IntRect CSingleChannelPyramidLevelTileAccessor::CalcDestinationRectFromSourceRect(const libCZI::IntRect& roi, const PyramidLayerInfo& pyramidInfo)
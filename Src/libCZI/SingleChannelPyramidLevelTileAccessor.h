@@ -48,6 +48,9 @@ namespace libCZI
 
             static int CalcSizeOfPixelOnLayer0(const PyramidLayerInfo& pyramidInfo);
 
+            /// Calculate the rectangle (in pixel coordinates of the destination bitmap) where the specified tile is drawn.
+            static libCZI::IntRect CalcTileRectInDestination(const SbInfo& sbInfo, int xPos, int yPos, int sizeOfPixel);
+
             std::map<int, SbByLayer> CalcByLayer(const std::vector<SbInfo>& sbinfo, int minificationFactor);
 
             std::vector<SbInfo> GetSubBlocksSubset(const libCZI::IntRect& roi, const libCZI::IDimCoordinate* planeCoordinate, const PyramidLayerInfo& pyramidInfo, const libCZI::IIndexSet* sceneFilter, bool sortByM);
@@ -7,6 +7,7 @@
 #include "BitmapOperations.h"
 #include "BitmapOperationsBitonal.h"
 #include "Site.h"
+#include "Instrumentation.h"
 
 using namespace libCZI;
 using namespace libCZI::detail;
@@ -82,14 +83,15 @@ CSingleChannelScalingTileAccessor::CSingleChannelScalingTileAccessor(const std::
     return IntSize{ static_cast<uint32_t>(roi.w * zoom),static_cast<uint32_t>(roi.h * zoom) };
 }
 
-void CSingleChannelScalingTileAccessor::ScaleBlt(libCZI::IBitmapData* bmDest, float zoom, const libCZI::IntRect& roi, const SbInfo& sbInfo, const libCZI::ISingleChannelScalingTileAccessor::Options& options)
+void CSingleChannelScalingTileAccessor::ScaleBlt(libCZI::IBitmapData* bmDest, float zoom, const libCZI::IntRect& roi, const SbInfo& sbInfo, const libCZI::ISingleChannelScalingTileAccessor::Options& options, CGradationLookUpTableProvider& gradationLookUpTables)
 {
     auto subblock_bitmap_data = CSingleChannelAccessorBase::GetSubBlockDataIncludingMaskForSubBlockIndex(
                                                                             this->sbBlkRepository,
                                                                             options.subBlockCache,
                                                                             sbInfo.index,
                                                                             options.onlyUseSubBlockCacheForCompressedData,
-                                                                            options.maskAware);
+                                                                            options.maskAware,
+                                                                            options.statistics);
     if (GetSite()->IsEnabled(LOGLEVEL_CHATTYINFORMATION))
     {
         stringstream ss;
@@ -99,6 +101,8 @@ void CSingleChannelScalingTileAccessor::ScaleBlt(libCZI::IBitmapData* bmDest, fl
 
     const auto& source = subblock_bitmap_data.bitmap;
     const auto& source_mask = subblock_bitmap_data.mask;
+    const std::uint8_t* look_up_table = gradationLookUpTables.GetLookUpTable(source->GetPixelType());
+    const auto start_of_scale = chrono::steady_clock::now();
 
     // In order not to run into trouble with floating point precision, if the scale is exactly 1, we refrain from using the scaling operation
     //  and do instead a simple copy operation. This should ensure a pixel-accurate result if zoom is exactly 1.
@@ -127,11 +131,11 @@ void CSingleChannelScalingTileAccessor::ScaleBlt(libCZI::IBitmapData* bmDest, fl
             info.maskStride = maskLck.stride;
             info.maskWidth = source_mask->GetWidth();
             info.maskHeight = source_mask->GetHeight();
-            BitmapOperationsBitonal::CopyWithOffsetAndMask(info);
+            BitmapOperationsBitonal::CopyWithOffsetAndMask(info, look_up_table);
         }
         else
         {
-            CBitmapOperations::CopyWithOffset(info);
+            CBitmapOperations::CopyWithOffset(info, look_up_table);
         }
     }
     else
@@ -162,15 +166,21 @@ void CSingleChannelScalingTileAccessor::ScaleBlt(libCZI::IBitmapData* bmDest, fl
         dstRoi.w *= bmDest->GetWidth();
         dstRoi.h *= bmDest->GetHeight();
 
+        ScopedPerformanceTimer timer(PerformanceTimer::NNResize);
         if (options.maskAware && source_mask)
         {
-            BitmapOperationsBitonal::NNResizeMaskAware(source.get(), source_mask.get(), bmDest, srcRoi, dstRoi);
+            BitmapOperationsBitonal::NNResizeMaskAware(source.get(), source_mask.get(), bmDest, srcRoi, dstRoi, look_up_table);
         }
         else
         {
-            CBitmapOperations::NNResize(source.get(), bmDest, srcRoi, dstRoi);
+            CBitmapOperations::NNResize(source.get(), bmDest, srcRoi, dstRoi, look_up_table);
         }
     }
+
+    if (options.statistics != nullptr)
+    {
+        options.statistics->scaleNanoseconds += GetNanosecondsSince(start_of_scale);
+    }
 }
 
 int CSingleChannelScalingTileAccessor::GetIdxOf1stSubBlockWithZoomGreater(const std::vector<SbInfo>& sbBlks, const std::vector<int>& byZoom, float zoom)
@@ -285,8 +295,17 @@ std::vector<CSingleChannelScalingTileAccessor::SbInfo> CSingleChannelScalingTile
 
 void CSingleChannelScalingTileAccessor::InternalGet(libCZI::IBitmapData* bmDest, const libCZI::IntRect& roi, const libCZI::IDimCoordinate* planeCoordinate, float zoom, const libCZI::ISingleChannelScalingTileAccessor::Options& options)
 {
+    ScopedPerformanceTimer timer(PerformanceTimer::SingleChannelAccessorGet);
+    const auto start = chrono::steady_clock::now();
+    if (options.statistics != nullptr)
+    {
+        options.statistics->Clear();
+    }
+
     this->CheckPlaneCoordinates(planeCoordinate);
-    Clear(bmDest, options.backGroundColor);
+
+    // the look-up tables for the gradation (if any) are created (at most) once for this call, and then used for all tiles
+    CGradationLookUpTableProvider gradation_look_up_tables(options.gradation, bmDest->GetPixelType());
     std::vector<int> scenesInvolved = this->DetermineInvolvedScenes(roi, options.sceneFilter.get());
 
     if (GetSite()->IsEnabled(LOGLEVEL_CHATTYINFORMATION))
@@ -319,24 +338,96 @@ void CSingleChannelScalingTileAccessor::InternalGet(libCZI::IBitmapData* bmDest,
     }
 
 
+    // the subblocks to be painted are determined first (pointing into the sets below), so that we know which part of the
+    //  destination is going to be covered before clearing it
+    std::vector<const SbInfo*> subBlocksToPaint;
+    SubSetSortedByZoom sbSetSortedByZoom;
+    std::vector<std::tuple<int, SubSetSortedByZoom>> sbSetSortedByZoomPerScene;
     if (scenesInvolved.size() <= 1)
     {
         // we only have to deal with a single scene (or: the document does not include a scene-dimension at all), in this
         //  case we do not have group by scene and save some cycles
-        auto sbSetsortedByZoom = this->GetSubSetFilteredBySceneSortedByZoom(roi, planeCoordinate, scenesInvolved, options.sortByM);
-        this->Paint(bmDest, roi, sbSetsortedByZoom, zoom, options);
+        sbSetSortedByZoom = this->GetSubSetFilteredBySceneSortedByZoom(roi, planeCoordinate, scenesInvolved, options.sortByM);
+        if (options.statistics != nullptr)
+        {
+            options.statistics->subBlocksEnumerated = static_cast<uint32_t>(sbSetSortedByZoom.subBlocks.size());
+            options.statistics->enumerateNanoseconds = GetNanosecondsSince(start);
+        }
+
+        this->DetermineSubBlocksToPaint(roi, sbSetSortedByZoom, zoom, options, subBlocksToPaint);
     }
     else
     {
-        const auto sbSetSortedByZoomPerScene = this->GetSubSetSortedByZoomPerScene(scenesInvolved, roi, planeCoordinate, options.sortByM);
+        sbSetSortedByZoomPerScene = this->GetSubSetSortedByZoomPerScene(scenesInvolved, roi, planeCoordinate, options.sortByM);
+        if (options.statistics != nullptr)
+        {
+            for (const auto& it : sbSetSortedByZoomPerScene)
+            {
+                options.statistics->subBlocksEnumerated += static_cast<uint32_t>(get<1>(it).subBlocks.size());
+            }
+
+            options.statistics->enumerateNanoseconds = GetNanosecondsSince(start);
+        }
+
         for (const auto& it : sbSetSortedByZoomPerScene)
         {
-            this->Paint(bmDest, roi, get<1>(it), zoom, options);
+            this->DetermineSubBlocksToPaint(roi, get<1>(it), zoom, options, subBlocksToPaint);
         }
     }
+
+    CSingleChannelScalingTileAccessor::ClearDestination(bmDest, roi, zoom, subBlocksToPaint, options);
+
+    for (const SbInfo* sbInfo : subBlocksToPaint)
+    {
+        if (GetSite()->IsEnabled(LOGLEVEL_CHATTYINFORMATION))
+        {
+            stringstream ss;
+            ss << " Drawing subblock: idx=" << sbInfo->index << " Log.: " << sbInfo->logicalRect << " Phys.Size: " << sbInfo->physicalSize;
+            GetSite()->Log(LOGLEVEL_CHATTYINFORMATION, ss);
+        }
+
+        this->ScaleBlt(bmDest, zoom, roi, *sbInfo, options, gradation_look_up_tables);
+    }
+
+    if (options.statistics != nullptr)
+    {
+        options.statistics->totalNanoseconds = GetNanosecondsSince(start);
+    }
 }
 
-void CSingleChannelScalingTileAccessor::Paint(libCZI::IBitmapData* bmDest, const libCZI::IntRect& roi, const SubSetSortedByZoom& sbSetSortedByZoom, float zoom, const libCZI::ISingleChannelScalingTileAccessor::Options& options)
+/*static*/void CSingleChannelScalingTileAccessor::ClearDestination(libCZI::IBitmapData* bmDest, const libCZI::IntRect& roi, float zoom, const std::vector<const SbInfo*>& subBlocksToPaint, const libCZI::ISingleChannelScalingTileAccessor::Options& options)
+{
+    // We only clear the part which is not covered by a tile if
+    // - the zoom is exactly 1: then the tiles are copied (not resized), and the area covered by a tile is exactly known.
+    //   With a resize, the destination footprint of a tile is subject to rounding, and gaps of one pixel could remain uncleared.
+    // - mask-aware mode is not enabled: with a mask, a tile is not necessarily opaque, so pixels within its rectangle may
+    //   be left untouched.
+    if (zoom != 1 || options.maskAware)
+    {
+        Clear(bmDest, options.backGroundColor);
+        return;
+    }
+
+    ClearUncoveredArea(
+        bmDest,
+        options.backGroundColor,
+        static_cast<int>(subBlocksToPaint.size()),
+        [&](int index)->IntRect
+        {
+            // with a zoom of 1, the source bitmap (of physical size) is copied to the position of the logical rect - we take the
+            //  extent of both rectangles which is covered for sure
+            const SbInfo* sbInfo = subBlocksToPaint[index];
+            return IntRect
+            {
+                sbInfo->logicalRect.x - roi.x,
+                sbInfo->logicalRect.y - roi.y,
+                min(sbInfo->logicalRect.w, static_cast<int>(sbInfo->physicalSize.w)),
+                min(sbInfo->logicalRect.h, static_cast<int>(sbInfo->physicalSize.h))
+            };
+        });
+}
+
+void CSingleChannelScalingTileAccessor::DetermineSubBlocksToPaint(const libCZI::IntRect& roi, const SubSetSortedByZoom& sbSetSortedByZoom, float zoom, const libCZI::ISingleChannelScalingTileAccessor::Options& options, std::vector<const SbInfo*>& subBlocksToPaint)
 {
     // make the pyramid-layer limit a bit smaller (5% smaller) so that right at the edge of a pyramid layer, we do not
     //  exclude subblocks which happen to have an inaccurate zoom-level (e.g. due to quantization)
@@ -372,20 +463,12 @@ void CSingleChannelScalingTileAccessor::Paint(libCZI::IBitmapData* bmDest, const
     {
         for (auto it = start_iterator; it != end_iterator; ++it)
         {
-            const SbInfo& sbInfo = sbSetSortedByZoom.subBlocks.at(*it);
-
-            if (GetSite()->IsEnabled(LOGLEVEL_CHATTYINFORMATION))
-            {
-                stringstream ss;
-                ss << " Drawing subblock: idx=" << sbInfo.index << " Log.: " << sbInfo.logicalRect << " Phys.Size: " << sbInfo.physicalSize;
-                GetSite()->Log(LOGLEVEL_CHATTYINFORMATION, ss);
-            }
-
-            this->ScaleBlt(bmDest, zoom, roi, sbInfo, options);
+            subBlocksToPaint.push_back(&sbSetSortedByZoom.subBlocks.at(*it));
         }
     }
     else
     {
+        const auto start_of_visibility_check = chrono::steady_clock::now();
         const auto indices_of_visible_tiles = this->CheckForVisibility(
             roi,
             static_cast<int>(distance(start_iterator, end_iterator)),           // how many subblocks we have in the range [start_iterator, end_iterator)
@@ -396,20 +479,18 @@ void CSingleChannelScalingTileAccessor::Paint(libCZI::IBitmapData* bmDest, const
                 return sbSetSortedByZoom.subBlocks[*(start_iterator + index)].index;
             });
 
-        // Now, draw only the subblocks which are visible - the vector "indices_of_visible_tiles" contains the indices "as they were passed to the lambda".
+        if (options.statistics != nullptr)
+        {
+            options.statistics->enumerateNanoseconds += GetNanosecondsSince(start_of_visibility_check);
+            options.statistics->subBlocksCulled += static_cast<uint32_t>(static_cast<size_t>(distance(start_iterator, end_iterator)) - indices_of_visible_tiles.size());
+        }
+
+        // Now, take only the subblocks which are visible - the vector "indices_of_visible_tiles" contains the indices "as they were passed to the lambda".
         for (const auto i : indices_of_visible_tiles)
         {
             // dereference the iterator (advanced by the index from out loop variable), this gives us an index into the
             // subBlocks-vector
-            const SbInfo& sbInfo = sbSetSortedByZoom.subBlocks.at(*(start_iterator + i));
-            if (GetSite()->IsEnabled(LOGLEVEL_CHATTYINFORMATION))
-            {
-                stringstream ss;
-                ss << " Drawing subblock: idx=" << sbInfo.index << " Log.: " << sbInfo.logicalRect << " Phys.Size: " << sbInfo.physicalSize;
-                GetSite()->Log(LOGLEVEL_CHATTYINFORMATION, ss);
-            }
-
-            this->ScaleBlt(bmDest, zoom, roi, sbInfo, options);
+            subBlocksToPaint.push_back(&sbSetSortedByZoom.subBlocks.at(*(start_iterator + i)));
         }
     }
 }
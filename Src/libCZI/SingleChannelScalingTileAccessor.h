@@ -43,7 +43,7 @@ namespace libCZI
             static std::vector<int> CreateSortByZoom(const std::vector<SbInfo>& sbBlks, bool sortByM);
             std::vector<SbInfo> GetSubSet(const libCZI::IntRect& roi, const libCZI::IDimCoordinate* planeCoordinate, const std::vector<int>* allowedScenes);
             static int GetIdxOf1stSubBlockWithZoomGreater(const std::vector<SbInfo>& sbBlks, const std::vector<int>& byZoom, float zoom);
-            void ScaleBlt(libCZI::IBitmapData* bmDest, float zoom, const libCZI::IntRect& roi, const SbInfo& sbInfo, const libCZI::ISingleChannelScalingTileAccessor::Options& options);
+            void ScaleBlt(libCZI::IBitmapData* bmDest, float zoom, const libCZI::IntRect& roi, const SbInfo& sbInfo, const libCZI::ISingleChannelScalingTileAccessor::Options& options, CGradationLookUpTableProvider& gradationLookUpTables);
 
             void InternalGet(libCZI::IBitmapData* bmDest, const libCZI::IntRect& roi, const libCZI::IDimCoordinate* planeCoordinate, float zoom, const libCZI::ISingleChannelScalingTileAccessor::Options& options);
 
@@ -60,7 +60,13 @@ namespace libCZI
             SubSetSortedByZoom GetSubSetFilteredBySceneSortedByZoom(const libCZI::IntRect& roi, const libCZI::IDimCoordinate* planeCoordinate, const std::vector<int>& allowedScenes, bool sortByM);
 
             std::vector<std::tuple<int, SubSetSortedByZoom>> GetSubSetSortedByZoomPerScene(const std::vector<int>& scenes, const libCZI::IntRect& roi, const libCZI::IDimCoordinate* planeCoordinate, bool sortByM);
-            void Paint(libCZI::IBitmapData* bmDest, const libCZI::IntRect& roi, const SubSetSortedByZoom& sbSetSortedByZoom, float zoom, const libCZI::ISingleChannelScalingTileAccessor::Options& options);
+
+            /// Determine the subblocks (from the specified set) which are to be painted for the specified ROI and zoom, and append them
+            /// (in the order in which they are to be painted) to the vector 'subBlocksToPaint'.
+            void DetermineSubBlocksToPaint(const libCZI::IntRect& roi, const SubSetSortedByZoom& sbSetSortedByZoom, float zoom, const libCZI::ISingleChannelScalingTileAccessor::Options& options, std::vector<const SbInfo*>& subBlocksToPaint);
+
+            /// Clear the destination bitmap before the specified subblocks are painted into it.
+            static void ClearDestination(libCZI::IBitmapData* bmDest, const libCZI::IntRect& roi, float zoom, const std::vector<const SbInfo*>& subBlocksToPaint, const libCZI::ISingleChannelScalingTileAccessor::Options& options);
         };
 
     } // namespace detail
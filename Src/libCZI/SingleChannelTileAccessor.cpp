@@ -8,6 +8,7 @@
 #include "SingleChannelTileCompositor.h"
 #include "Site.h"
 #include "bitmapData.h"
+#include "Instrumentation.h"
 
 using namespace libCZI;
 using namespace libCZI::detail;
@@ -47,9 +48,26 @@ CSingleChannelTileAccessor::CSingleChannelTileAccessor(const std::shared_ptr<ISu
 
 void CSingleChannelTileAccessor::ComposeTiles(libCZI::IBitmapData* pBm, int xPos, int yPos, const std::vector<IndexAndM>& subBlocksSet, const ISingleChannelTileAccessor::Options& options)
 {
-    Compositors::ComposeSingleTileOptions composeOptions;
-    composeOptions.Clear();
-    composeOptions.drawTileBorder = options.drawTileBorder;
+    // the look-up tables for the gradation (if any) are created (at most) once for this call, and then used for all tiles
+    CGradationLookUpTableProvider gradation_look_up_tables(options.gradation, pBm->GetPixelType());
+
+    const auto compose_sub_block = [&](int sub_block_index)->void
+        {
+            const auto subblock_data = CSingleChannelAccessorBase::GetSubBlockDataIncludingMaskForSubBlockIndex(
+                this->sbBlkRepository,
+                options.subBlockCache,
+                sub_block_index,
+                options.onlyUseSubBlockCacheForCompressedData,
+                options.maskAware);
+            CSingleChannelTileCompositor::ComposeMaskAware(
+                pBm,
+                subblock_data.bitmap.get(),
+                subblock_data.mask.get(),
+                subblock_data.subBlockInfo.logicalRect.x - xPos,
+                subblock_data.subBlockInfo.logicalRect.y - yPos,
+                options.drawTileBorder,
+                gradation_look_up_tables.GetLookUpTable(subblock_data.bitmap->GetPixelType()));
+        };
 
     if (options.useVisibilityCheckOptimization)
     {
@@ -67,58 +85,17 @@ void CSingleChannelTileAccessor::ComposeTiles(libCZI::IBitmapData* pBm, int xPos
                 return subBlocksSet[index].index;
             });
 
-
-        Compositors::ComposeSingleChannelTilesMaskAware(
-                [&](int index, std::shared_ptr<libCZI::IBitmapData>& spBm, std::shared_ptr<libCZI::IBitonalBitmapData>& spMask, int& xPosTile, int& yPosTile)->bool
-                {
-                    if (index < static_cast<int>(indices_of_visible_tiles.size()))
-                    {
-                        const auto subblock_data = CSingleChannelAccessorBase::GetSubBlockDataIncludingMaskForSubBlockIndex(
-                            this->sbBlkRepository,
-                            options.subBlockCache,
-                            subBlocksSet[indices_of_visible_tiles[index]].index,
-                            options.onlyUseSubBlockCacheForCompressedData,
-                            options.maskAware);
-                        spBm = subblock_data.bitmap;
-                        spMask = subblock_data.mask;
-                        xPosTile = subblock_data.subBlockInfo.logicalRect.x;
-                        yPosTile = subblock_data.subBlockInfo.logicalRect.y;
-                        return true;
-                    }
-
-                    return false;
-                },
-                pBm,
-                xPos,
-                yPos,
-                &composeOptions);
+        for (const int index : indices_of_visible_tiles)
+        {
+            compose_sub_block(subBlocksSet[index].index);
+        }
     }
     else
     {
-        Compositors::ComposeSingleChannelTilesMaskAware(
-            [&](int index, std::shared_ptr<libCZI::IBitmapData>& spBm, std::shared_ptr<libCZI::IBitonalBitmapData>& spMask, int& xPosTile, int& yPosTile)->bool
-            {
-                if (index < static_cast<int>(subBlocksSet.size()))
-                {
-                    const auto subblock_data = CSingleChannelAccessorBase::GetSubBlockDataIncludingMaskForSubBlockIndex(
-                        this->sbBlkRepository,
-                        options.subBlockCache,
-                        subBlocksSet[index].index,
-                        options.onlyUseSubBlockCacheForCompressedData,
-                        options.maskAware);
-                    spBm = subblock_data.bitmap;
-                    spMask = subblock_data.mask;
-                    xPosTile = subblock_data.subBlockInfo.logicalRect.x;
-                    yPosTile = subblock_data.subBlockInfo.logicalRect.y;
-                    return true;
-                }
-
-                return false;
-            },
-            pBm,
-            xPos,
-            yPos,
-            &composeOptions);
+        for (const auto& sub_block : subBlocksSet)
+        {
+            compose_sub_block(sub_block.index);
+        }
     }
 }
 
@@ -131,12 +108,31 @@ void CSingleChannelTileAccessor::InternalGet(int xPos, int yPos, libCZI::IBitmap
         return;
     }
 
+    ScopedPerformanceTimer timer(PerformanceTimer::SingleChannelAccessorGet);
     this->CheckPlaneCoordinates(planeCoordinate);
-    Clear(pBm, pOptions->backGroundColor);
     const IntSize sizeBm = pBm->GetSize();
     const IntRect roi{ xPos,yPos,static_cast<int>(sizeBm.w),static_cast<int>(sizeBm.h) };
     const std::vector<IndexAndM> subBlocksSet = this->GetSubBlocksSubset(roi, planeCoordinate, pOptions->sortByM);
 
+    if (pOptions->maskAware)
+    {
+        // with masks, the tiles are not necessarily opaque, so we need to clear the whole bitmap
+        Clear(pBm, pOptions->backGroundColor);
+    }
+    else
+    {
+        // only clear the part of the bitmap which is not going to be covered by a tile anyway
+        ClearUncoveredArea(
+            pBm,
+            pOptions->backGroundColor,
+            static_cast<int>(subBlocksSet.size()),
+            [&](int index)->IntRect
+            {
+                const IntRect logical_rect = this->GetLogicalRectOfSubBlock(subBlocksSet[index].index);
+                return IntRect{ logical_rect.x - xPos, logical_rect.y - yPos, logical_rect.w, logical_rect.h };
+            });
+    }
+
     this->ComposeTiles(pBm, xPos, yPos, subBlocksSet, *pOptions);
 }
 
@@ -11,6 +11,11 @@ using namespace libCZI;
 using namespace libCZI::detail;
 
 /*static*/void CSingleChannelTileCompositor::Compose(libCZI::IBitmapData* dest, libCZI::IBitmapData* source, int x, int y, bool drawTileBorder)
+{
+    CSingleChannelTileCompositor::Compose(dest, source, x, y, drawTileBorder, nullptr);
+}
+
+/*static*/void CSingleChannelTileCompositor::Compose(libCZI::IBitmapData* dest, libCZI::IBitmapData* source, int x, int y, bool drawTileBorder, const std::uint8_t* lookUpTable)
 {
     const ScopedBitmapLockerP source_locker{ source };
     const ScopedBitmapLockerP destination_locker{ dest };
@@ -31,15 +36,20 @@ using namespace libCZI::detail;
 
     info.drawTileBorder = drawTileBorder;
 
-    CBitmapOperations::CopyWithOffset(info);
+    CBitmapOperations::CopyWithOffset(info, lookUpTable);
 }
 
 /*static*/void CSingleChannelTileCompositor::ComposeMaskAware(libCZI::IBitmapData* dest, libCZI::IBitmapData* source, libCZI::IBitonalBitmapData* sourceMask, int x, int y, bool drawTileBorder)
+{
+    CSingleChannelTileCompositor::ComposeMaskAware(dest, source, sourceMask, x, y, drawTileBorder, nullptr);
+}
+
+/*static*/void CSingleChannelTileCompositor::ComposeMaskAware(libCZI::IBitmapData* dest, libCZI::IBitmapData* source, libCZI::IBitonalBitmapData* sourceMask, int x, int y, bool drawTileBorder, const std::uint8_t* lookUpTable)
 {
     if (sourceMask == nullptr)
     {
         // No mask - just do a normal compose
-        CSingleChannelTileCompositor::Compose(dest, source, x, y, drawTileBorder);
+        CSingleChannelTileCompositor::Compose(dest, source, x, y, drawTileBorder, lookUpTable);
         return;
     }
 
@@ -68,7 +78,7 @@ using namespace libCZI::detail;
     info.maskWidth = sourceMask->GetWidth();
     info.maskHeight = sourceMask->GetHeight();
 
-    BitmapOperationsBitonal::CopyWithOffsetAndMask(info);
+    BitmapOperationsBitonal::CopyWithOffsetAndMask(info, lookUpTable);
 }
 
 /*-----------------------------------------------------------------------------------------------*/
@@ -15,7 +15,12 @@ namespace libCZI
         {
         public:
             static void Compose(libCZI::IBitmapData* dest, libCZI::IBitmapData* source, int x, int y, bool drawTileBorder);
+            static void Compose(libCZI::IBitmapData* dest, libCZI::IBitmapData* source, int x, int y, bool drawTileBorder, const std::uint8_t* lookUpTable);
             static void ComposeMaskAware(libCZI::IBitmapData* dest, libCZI::IBitmapData* source, libCZI::IBitonalBitmapData* sourceMask, int x, int y, bool drawTileBorder);
+
+            /// Compose the source bitmap (taking into account the mask if it is non-null) into the destination bitmap, where the
+            /// pixels are mapped through the specified look-up table (which may be null, c.f. CBitmapOperations::CopyWithOffset).
+            static void ComposeMaskAware(libCZI::IBitmapData* dest, libCZI::IBitmapData* source, libCZI::IBitonalBitmapData* sourceMask, int x, int y, bool drawTileBorder, const std::uint8_t* lookUpTable);
         };
 
     }  // namespace detail
@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "SpatialSubBlockOrder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+using namespace libCZI;
+using namespace libCZI::detail;
+
+/*static*/std::vector<size_t> CSpatialSubBlockOrder::DetermineOrder(const std::vector<CCziSubBlockDirectoryBase::SubBlkEntry>& entries, libCZI::CZIWriterSubBlockLayout layout)
+{
+    vector<size_t> order(entries.size());
+    iota(order.begin(), order.end(), 0);
+    if (layout == CZIWriterSubBlockLayout::InOrderOfAddition || entries.empty())
+    {
+        return order;
+    }
+
+    // first, group the subblocks by plane and pyramid-layer
+    const auto compareByPlaneAndLayer = [&](size_t a, size_t b)->int
+        {
+            const int c = Utils::Compare(&entries[a].coordinate, &entries[b].coordinate);
+            if (c != 0)
+            {
+                return c;
+            }
+
+            const int layerA = CSpatialSubBlockOrder::GetLayerKey(entries[a]);
+            const int layerB = CSpatialSubBlockOrder::GetLayerKey(entries[b]);
+            return layerA < layerB ? -1 : (layerA > layerB ? 1 : 0);
+        };
+
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)->bool { return compareByPlaneAndLayer(a, b) < 0; });
+
+    // now, determine the position on the space-filling curve for each subblock (within its group)
+    vector<uint64_t> curveIndex(entries.size());
+    for (size_t groupStart = 0; groupStart < order.size();)
+    {
+        size_t groupEnd = groupStart + 1;
+        while (groupEnd < order.size() && compareByPlaneAndLayer(order[groupStart], order[groupEnd]) == 0)
+        {
+            ++groupEnd;
+        }
+
+        int64_t minX = (numeric_limits<int64_t>::max)(), minY = (numeric_limits<int64_t>::max)();
+        int64_t cellWidth = (numeric_limits<int64_t>::max)(), cellHeight = (numeric_limits<int64_t>::max)();
+        for (size_t i = groupStart; i < groupEnd; ++i)
+        {
+            const auto& entry = entries[order[i]];
+            minX = (min)(minX, static_cast<int64_t>(entry.x));
+            minY = (min)(minY, static_cast<int64_t>(entry.y));
+            cellWidth = (min)(cellWidth, static_cast<int64_t>(entry.width));
+            cellHeight = (min)(cellHeight, static_cast<int64_t>(entry.height));
+        }
+
+        cellWidth = (max)(cellWidth, static_cast<int64_t>(1));
+        cellHeight = (max)(cellHeight, static_cast<int64_t>(1));
+        for (size_t i = groupStart; i < groupEnd; ++i)
+        {
+            const auto& entry = entries[order[i]];
+            const auto cellX = static_cast<uint32_t>((min)((entry.x - minX) / cellWidth, static_cast<int64_t>((numeric_limits<uint32_t>::max)())));
+            const auto cellY = static_cast<uint32_t>((min)((entry.y - minY) / cellHeight, static_cast<int64_t>((numeric_limits<uint32_t>::max)())));
+            curveIndex[order[i]] = layout == CZIWriterSubBlockLayout::PlaneThenMortonOrder ?
+                CSpatialSubBlockOrder::CalcMortonIndex(cellX, cellY) :
+                CSpatialSubBlockOrder::CalcHilbertIndex(cellX, cellY);
+        }
+
+        groupStart = groupEnd;
+    }
+
+    // and sort by plane, pyramid-layer and then the position on the curve - if two subblocks end up with the same index
+    //  on the curve, we order them by their position (and then keep the order of addition)
+    stable_sort(
+        order.begin(),
+        order.end(),
+        [&](size_t a, size_t b)->bool
+        {
+            const int c = compareByPlaneAndLayer(a, b);
+            if (c != 0)
+            {
+                return c < 0;
+            }
+
+            if (curveIndex[a] != curveIndex[b])
+            {
+                return curveIndex[a] < curveIndex[b];
+            }
+
+            if (entries[a].y != entries[b].y)
+            {
+                return entries[a].y < entries[b].y;
+            }
+
+            return entries[a].x < entries[b].x;
+        });
+
+    return order;
+}
+
+/*static*/std::uint64_t CSpatialSubBlockOrder::CalcHilbertIndex(std::uint32_t x, std::uint32_t y)
+{
+    // c.f. https://en.wikipedia.org/wiki/Hilbert_curve
+    uint64_t index = 0;
+    for (uint64_t s = static_cast<uint64_t>(1) << 31; s > 0; s /= 2)
+    {
+        const uint32_t rx = (x & s) != 0 ? 1 : 0;
+        const uint32_t ry = (y & s) != 0 ? 1 : 0;
+        index += s * s * ((3 * rx) ^ ry);
+
+        // rotate the quadrant (with n=2^32, "n-1-x" is the bitwise complement)
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = ~x;
+                y = ~y;
+            }
+
+            swap(x, y);
+        }
+    }
+
+    return index;
+}
+
+/*static*/std::uint64_t CSpatialSubBlockOrder::CalcMortonIndex(std::uint32_t x, std::uint32_t y)
+{
+    const auto spreadBits = [](uint64_t v)->uint64_t
+        {
+            v = (v | (v << 16)) & 0x0000ffff0000ffffULL;
+            v = (v | (v << 8)) & 0x00ff00ff00ff00ffULL;
+            v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+            v = (v | (v << 2)) & 0x3333333333333333ULL;
+            v = (v | (v << 1)) & 0x5555555555555555ULL;
+            return v;
+        };
+
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+/*static*/int CSpatialSubBlockOrder::GetLayerKey(const CCziSubBlockDirectoryBase::SubBlkEntry& entry)
+{
+    // for layer-0, the logical size is equal to the physical size - for pyramid-layers, the ratio gives the "zoom" of the
+    //  layer, we use the rounded ratio as key (so that subblocks of the same layer are grouped together even if the ratio
+    //  is not precisely the same for all of them)
+    if (entry.storedWidth <= 0 || entry.width <= entry.storedWidth)
+    {
+        return 1;
+    }
+
+    return static_cast<int>(lround(static_cast<double>(entry.width) / entry.storedWidth));
+}
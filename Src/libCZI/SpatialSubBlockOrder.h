@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "libCZI.h"
+#include "CziSubBlockDirectory.h"
+
+namespace libCZI
+{
+    namespace detail
+    {
+        /// This class determines a spatial order for a set of subblocks - i.e. an order in which subblocks which are likely to be read together
+        /// are adjacent. The subblocks are first ordered by plane (i.e. by their coordinate), then by pyramid-layer, and within a pyramid-layer of a
+        /// plane they are ordered along a space-filling curve over the tile position. The tile position is determined by dividing the position of
+        /// the subblock by the (smallest) logical size of the subblocks in the respective layer.
+        class CSpatialSubBlockOrder
+        {
+        public:
+            /// Determine the order in which the specified subblocks are to be laid out.
+            ///
+            /// \param  entries The subblocks.
+            /// \param  layout  The layout - if this is "InOrderOfAddition", then the identity is returned.
+            ///
+            /// \returns    A vector with the indices (into "entries") in the order in which the subblocks are to be laid out.
+            static std::vector<size_t> DetermineOrder(const std::vector<CCziSubBlockDirectoryBase::SubBlkEntry>& entries, libCZI::CZIWriterSubBlockLayout layout);
+
+            /// Calculates the index of the specified point on a Hilbert curve (covering the range of 2^32 x 2^32).
+            ///
+            /// \param  x   The x coordinate.
+            /// \param  y   The y coordinate.
+            ///
+            /// \returns    The index of the point on the Hilbert curve.
+            static std::uint64_t CalcHilbertIndex(std::uint32_t x, std::uint32_t y);
+
+            /// Calculates the index of the specified point on a Z-order curve (Morton order) - i.e. the bits of the coordinates are
+            /// interleaved, where the bits of the x-coordinate are at the even positions.
+            ///
+            /// \param  x   The x coordinate.
+            /// \param  y   The y coordinate.
+            ///
+            /// \returns    The index of the point on the Z-order curve.
+            static std::uint64_t CalcMortonIndex(std::uint32_t x, std::uint32_t y);
+        private:
+            static int GetLayerKey(const CCziSubBlockDirectoryBase::SubBlkEntry& entry);
+        };
+    } // namespace detail
+} // namespace libCZI
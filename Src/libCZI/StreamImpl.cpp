@@ -476,3 +476,41 @@ void CSimpleInputOutputStreamImpl::Write(std::uint64_t offset, const void* pv, s
         *ptrBytesRead = bytesRead;
     }
 }
+
+//----------------------------------------------------------------------------
+
+bool libCZI::detail::IsStockFileOutputStream(const libCZI::IOutputStream* stream)
+{
+#if LIBCZI_WINDOWSAPI_AVAILABLE
+    if (dynamic_cast<const CSimpleOutputStreamImplWindows*>(stream) != nullptr)
+    {
+        return true;
+    }
+#endif
+#if LIBCZI_USE_PREADPWRITEBASED_STREAMIMPL
+    if (dynamic_cast<const COutputStreamImplPwrite*>(stream) != nullptr)
+    {
+        return true;
+    }
+#endif
+
+    return dynamic_cast<const CSimpleOutputStreamStreams*>(stream) != nullptr;
+}
+
+bool libCZI::detail::IsStockFileInputOutputStream(const libCZI::IInputOutputStream* stream)
+{
+#if LIBCZI_WINDOWSAPI_AVAILABLE
+    if (dynamic_cast<const CSimpleInputOutputStreamImplWindows*>(stream) != nullptr)
+    {
+        return true;
+    }
+#endif
+#if LIBCZI_USE_PREADPWRITEBASED_STREAMIMPL
+    if (dynamic_cast<const CInputOutputStreamImplPreadPwrite*>(stream) != nullptr)
+    {
+        return true;
+    }
+#endif
+
+    return dynamic_cast<const CSimpleInputOutputStreamImpl*>(stream) != nullptr;
+}
@@ -117,5 +117,20 @@ namespace libCZI
             void Write(std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* ptrBytesWritten) override;
         };
 
+        /// Query if the specified output-stream is one of the stock file-stream implementations (i.e. an object created
+        /// by "CreateOutputStreamForFile").
+        ///
+        /// \param  stream  The stream.
+        ///
+        /// \returns    True if the stream is a stock file-stream implementation, false otherwise.
+        bool IsStockFileOutputStream(const libCZI::IOutputStream* stream);
+
+        /// Query if the specified input-output-stream is one of the stock file-stream implementations (i.e. an object created
+        /// by "CreateInputOutputStreamForFile").
+        ///
+        /// \param  stream  The stream.
+        ///
+        /// \returns    True if the stream is a stock file-stream implementation, false otherwise.
+        bool IsStockFileInputOutputStream(const libCZI::IInputOutputStream* stream);
     } // namespace detail
 } // namespace libCZI
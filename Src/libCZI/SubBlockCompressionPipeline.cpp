@@ -0,0 +1,208 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "SubBlockCompressionPipeline.h"
+#include "CziUtils.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+using namespace libCZI;
+using namespace libCZI::detail;
+using namespace std;
+
+CSubBlockCompressionPipeline::CSubBlockCompressionPipeline(std::uint32_t numberOfThreads, std::uint64_t maxMemoryForPendingJobs)
+    : maxMemoryForPendingJobs(maxMemoryForPendingJobs)
+{
+    try
+    {
+        this->workers.reserve(numberOfThreads);
+        for (uint32_t i = 0; i < numberOfThreads; ++i)
+        {
+            this->workers.emplace_back(&CSubBlockCompressionPipeline::WorkerThread, this);
+        }
+    }
+    catch (...)
+    {
+        // the destructor is not run if the constructor throws, so we have to stop the workers started so far here
+        this->StopAndJoinWorkers();
+        throw;
+    }
+}
+
+CSubBlockCompressionPipeline::~CSubBlockCompressionPipeline()
+{
+    this->StopAndJoinWorkers();
+}
+
+void CSubBlockCompressionPipeline::StopAndJoinWorkers()
+{
+    {
+        lock_guard<std::mutex> lock(this->stateMutex);
+        this->stopWorkers = true;
+        this->workQueue.clear();
+    }
+
+    this->conditionWorkAvailable.notify_all();
+    for (auto& worker : this->workers)
+    {
+        worker.join();
+    }
+}
+
+void CSubBlockCompressionPipeline::Submit(Job&& job, const std::function<void(const Result&)>& deliver)
+{
+    auto entry = make_shared<Entry>();
+    entry->memoryUsage = CSubBlockCompressionPipeline::EstimateMemoryUsage(job);
+    entry->result.job = std::move(job);
+
+    unique_lock<std::mutex> lock(this->stateMutex);
+
+    // apply back-pressure - we allow at least one job to be pending (irrespective of its size)
+    while (!this->pendingEntries.empty() && this->memoryUsageOfPendingEntries + entry->memoryUsage > this->maxMemoryForPendingJobs)
+    {
+        this->DeliverOldestEntry(lock, deliver);
+    }
+
+    this->pendingEntries.push_back(entry);
+    this->memoryUsageOfPendingEntries += entry->memoryUsage;
+
+    if (this->workers.empty())
+    {
+        // no worker threads, so we compress synchronously
+        lock.unlock();
+        CSubBlockCompressionPipeline::CompressEntry(*entry);
+        lock.lock();
+        entry->done = true;
+    }
+    else
+    {
+        this->workQueue.push_back(entry);
+        this->conditionWorkAvailable.notify_one();
+    }
+
+    while (!this->pendingEntries.empty() && this->pendingEntries.front()->done)
+    {
+        this->DeliverOldestEntry(lock, deliver);
+    }
+}
+
+void CSubBlockCompressionPipeline::Drain(const std::function<void(const Result&)>& deliver)
+{
+    unique_lock<std::mutex> lock(this->stateMutex);
+    while (!this->pendingEntries.empty())
+    {
+        this->DeliverOldestEntry(lock, deliver);
+    }
+}
+
+bool CSubBlockCompressionPipeline::HasPendingJobs() const
+{
+    lock_guard<std::mutex> lock(this->stateMutex);
+    return !this->pendingEntries.empty();
+}
+
+void CSubBlockCompressionPipeline::DeliverOldestEntry(std::unique_lock<std::mutex>& lock, const std::function<void(const Result&)>& deliver)
+{
+    auto entry = this->pendingEntries.front();
+    this->conditionJobDone.wait(lock, [&entry]() { return entry->done; });
+    this->pendingEntries.pop_front();
+
+    // note that we "account" the memory for the entry until it has been delivered
+    lock.unlock();
+    try
+    {
+        deliver(entry->result);
+    }
+    catch (...)
+    {
+        lock.lock();
+        this->memoryUsageOfPendingEntries -= entry->memoryUsage;
+        lock.unlock();
+        throw;
+    }
+
+    lock.lock();
+    this->memoryUsageOfPendingEntries -= entry->memoryUsage;
+}
+
+void CSubBlockCompressionPipeline::WorkerThread()
+{
+    for (;;)
+    {
+        shared_ptr<Entry> entry;
+        {
+            unique_lock<std::mutex> lock(this->stateMutex);
+            this->conditionWorkAvailable.wait(lock, [this]() { return this->stopWorkers || !this->workQueue.empty(); });
+            if (this->stopWorkers)
+            {
+                return;
+            }
+
+            entry = this->workQueue.front();
+            this->workQueue.pop_front();
+        }
+
+        CSubBlockCompressionPipeline::CompressEntry(*entry);
+
+        {
+            lock_guard<std::mutex> lock(this->stateMutex);
+            entry->done = true;
+        }
+
+        this->conditionJobDone.notify_all();
+    }
+}
+
+/*static*/void CSubBlockCompressionPipeline::CompressEntry(Entry& entry)
+{
+    try
+    {
+        entry.result.compressedData = CSubBlockCompressionPipeline::Compress(entry.result.job);
+        if (entry.result.compressedData)
+        {
+            // the bitmap is not needed anymore, so release it as early as possible
+            entry.result.job.bitmap.reset();
+        }
+    }
+    catch (...)
+    {
+        entry.result.error = current_exception();
+    }
+}
+
+/*static*/std::uint64_t CSubBlockCompressionPipeline::EstimateMemoryUsage(const Job& job)
+{
+    return static_cast<uint64_t>(job.info.physicalWidth) * job.info.physicalHeight * CziUtils::GetBytesPerPel(job.info.PixelType) +
+        job.metadata.size() +
+        job.attachment.size();
+}
+
+/*static*/std::shared_ptr<libCZI::IMemoryBlock> CSubBlockCompressionPipeline::Compress(const Job& job)
+{
+    const auto compressionMode = job.info.GetCompressionMode();
+    if (compressionMode == CompressionMode::UnCompressed)
+    {
+        return nullptr;
+    }
+
+    ScopedBitmapLockerSP lockedBitmap{ job.bitmap };
+    const auto width = static_cast<uint32_t>(job.info.physicalWidth);
+    const auto height = static_cast<uint32_t>(job.info.physicalHeight);
+    switch (compressionMode)
+    {
+    case CompressionMode::Zstd0:
+        return ZstdCompress::CompressZStd0Alloc(width, height, lockedBitmap.stride, job.info.PixelType, lockedBitmap.ptrDataRoi, job.compressionParameters.get());
+    case CompressionMode::Zstd1:
+        return ZstdCompress::CompressZStd1Alloc(width, height, lockedBitmap.stride, job.info.PixelType, lockedBitmap.ptrDataRoi, job.compressionParameters.get());
+    case CompressionMode::JpgXr:
+        return JxrLibCompress::Compress(job.info.PixelType, width, height, lockedBitmap.stride, lockedBitmap.ptrDataRoi, job.compressionParameters.get());
+    default:
+        break;
+    }
+
+    stringstream ss;
+    ss << "The compression mode '" << Utils::CompressionModeToInformalString(compressionMode) << "' is not supported.";
+    throw invalid_argument(ss.str());
+}
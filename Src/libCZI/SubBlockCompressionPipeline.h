@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "libCZI.h"
+
+namespace libCZI
+{
+    namespace detail
+    {
+        /// This class implements the compression of subblocks on a pool of worker threads. Jobs are compressed concurrently,
+        /// but the results are delivered strictly in the order in which the jobs have been submitted. The delivery (i.e. the
+        /// call into the "deliver"-functor) always happens on the thread calling into "Submit" or "Drain" - so the consumer
+        /// of the results (e.g. the writer) does not need to be thread-safe.
+        /// The amount of memory which is held by jobs not yet delivered is bounded - if the limit would be exceeded by
+        /// submitting a new job, then "Submit" blocks until enough jobs have been delivered (at least one job is always
+        /// allowed to be pending).
+        /// Note that the methods of this class must not be called concurrently.
+        class CSubBlockCompressionPipeline
+        {
+        public:
+            /// This structure describes a subblock to be compressed (and then written).
+            struct Job
+            {
+                libCZI::AddSubBlockInfoBase info;           ///< Information about the subblock (the compression mode is taken from here).
+                std::shared_ptr<libCZI::IBitmapData> bitmap;///< The (uncompressed) bitmap.
+                std::shared_ptr<libCZI::ICompressParameters> compressionParameters; ///< The compression parameters (may be null).
+                std::vector<std::uint8_t> metadata;         ///< The subblock-metadata (a copy of it).
+                std::vector<std::uint8_t> attachment;       ///< The subblock-attachment (a copy of it).
+            };
+
+            /// This structure gives the result of the compression of a job.
+            struct Result
+            {
+                Job job;                                    ///< The job.
+
+                /// The compressed data. In case of "compression mode uncompressed", this is null and the data is
+                /// to be taken from the bitmap in the job.
+                std::shared_ptr<libCZI::IMemoryBlock> compressedData;
+
+                /// If the compression failed, this is the exception which occurred (and null otherwise).
+                std::exception_ptr error;
+            };
+
+            /// Constructor.
+            ///
+            /// \param  numberOfThreads             The number of worker threads. If this is 0, then the compression is done synchronously (on the thread calling "Submit").
+            /// \param  maxMemoryForPendingJobs     The maximum amount of memory (in bytes) which is to be held by jobs not yet delivered.
+            CSubBlockCompressionPipeline(std::uint32_t numberOfThreads, std::uint64_t maxMemoryForPendingJobs);
+
+            /// Destructor. Jobs which have not been delivered yet are discarded.
+            ~CSubBlockCompressionPipeline();
+
+            /// Submits a job. Before the job is queued, results are delivered (in submission order) until the memory limit allows
+            /// to add the job (which may involve waiting for pending jobs to complete). After the job has been queued, all results
+            /// which are readily available (i.e. without waiting) are delivered.
+            /// If the "deliver"-functor throws an exception, the exception is propagated to the caller, and the result in question
+            /// is discarded.
+            ///
+            /// \param          job     The job.
+            /// \param          deliver The functor which is called for delivering the results.
+            void Submit(Job&& job, const std::function<void(const Result&)>& deliver);
+
+            /// Waits for all jobs to complete and delivers all results (in submission order).
+            ///
+            /// \param  deliver The functor which is called for delivering the results.
+            void Drain(const std::function<void(const Result&)>& deliver);
+
+            /// Query if there are jobs which have not been delivered yet.
+            ///
+            /// \returns    True if there are pending jobs, false otherwise.
+            bool HasPendingJobs() const;
+
+            /// Gets an estimate for the amount of memory (in bytes) required for holding the specified job.
+            ///
+            /// \param  job The job.
+            ///
+            /// \returns    The estimated size of the job in bytes.
+            static std::uint64_t EstimateMemoryUsage(const Job& job);
+
+            /// Compress the specified job (i.e. create the subblock data as specified by the compression mode).
+            ///
+            /// \param  job The job.
+            ///
+            /// \returns    The compressed data, or null in case of "compression mode uncompressed".
+            static std::shared_ptr<libCZI::IMemoryBlock> Compress(const Job& job);
+
+            CSubBlockCompressionPipeline(const CSubBlockCompressionPipeline&) = delete;
+            CSubBlockCompressionPipeline& operator=(const CSubBlockCompressionPipeline&) = delete;
+        private:
+            struct Entry
+            {
+                Result result;
+                std::uint64_t memoryUsage{ 0 };
+                bool done{ false };
+            };
+
+            std::uint64_t maxMemoryForPendingJobs;
+
+            mutable std::mutex stateMutex;
+            std::condition_variable conditionWorkAvailable;
+            std::condition_variable conditionJobDone;
+            bool stopWorkers{ false };
+
+            std::deque<std::shared_ptr<Entry>> pendingEntries;  ///< All entries not yet delivered, in submission order.
+            std::deque<std::shared_ptr<Entry>> workQueue;       ///< The entries which have not yet been picked up by a worker.
+            std::uint64_t memoryUsageOfPendingEntries{ 0 };
+
+            std::vector<std::thread> workers;
+
+            void WorkerThread();
+            static void CompressEntry(Entry& entry);
+
+            /// Signal the worker threads to stop (discarding the entries not yet picked up) and join all of them.
+            void StopAndJoinWorkers();
+
+            /// Wait until the oldest pending entry is done, remove it from the list and deliver it. The lock is held when
+            /// calling this method, and it is held when this method returns (unless an exception is thrown).
+            void DeliverOldestEntry(std::unique_lock<std::mutex>& lock, const std::function<void(const Result&)>& deliver);
+        };
+    } // namespace detail
+} // namespace libCZI
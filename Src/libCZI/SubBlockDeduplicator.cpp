@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "SubBlockDeduplicator.h"
+#include <cstring>
+#include "MD5Sum.h"
+
+using namespace libCZI;
+using namespace libCZI::detail;
+using namespace std;
+
+bool CSubBlockDeduplicator::Key::operator==(const Key& other) const
+{
+    return memcmp(this->hash, other.hash, sizeof(this->hash)) == 0 &&
+        this->dataSize == other.dataSize &&
+        this->metadataSize == other.metadataSize &&
+        this->attachmentSize == other.attachmentSize &&
+        this->compression == other.compression &&
+        this->pixelType == other.pixelType &&
+        this->storedWidth == other.storedWidth &&
+        this->storedHeight == other.storedHeight &&
+        this->pyramidType == other.pyramidType &&
+        this->dimensionCount == other.dimensionCount;
+}
+
+size_t CSubBlockDeduplicator::KeyHash::operator()(const Key& key) const
+{
+    // the MD5-hash is uniformly distributed, so we can simply use (the first bytes of) it
+    size_t hash;
+    memcpy(&hash, key.hash, sizeof(hash));
+    return hash;
+}
+
+/*static*/CSubBlockDeduplicator::Key CSubBlockDeduplicator::CalculateKey(const CCziSubBlockDirectoryBase::SubBlkEntry& entry, const std::vector<std::uint8_t>& data, const std::vector<std::uint8_t>& metadata, const std::vector<std::uint8_t>& attachment)
+{
+    CMd5Sum md5sum;
+    md5sum.update(data.data(), data.size());
+    md5sum.update(metadata.data(), metadata.size());
+    md5sum.update(attachment.data(), attachment.size());
+    md5sum.complete();
+
+    Key key;
+    md5sum.getHash(reinterpret_cast<char*>(key.hash));
+    key.dataSize = data.size();
+    key.metadataSize = metadata.size();
+    key.attachmentSize = attachment.size();
+    key.compression = entry.Compression;
+    key.pixelType = entry.PixelType;
+    key.storedWidth = entry.storedWidth;
+    key.storedHeight = entry.storedHeight;
+    key.pyramidType = entry.pyramid_type_from_spare;
+    key.dimensionCount = entry.coordinate.GetValidDimensionsCount() + (entry.IsMIndexValid() ? 1 : 0);
+    return key;
+}
+
+bool CSubBlockDeduplicator::TryGetSegment(const Key& key, std::uint64_t* filePosition, std::uint64_t* segmentSize) const
+{
+    const auto it = this->segments.find(key);
+    if (it == this->segments.cend())
+    {
+        return false;
+    }
+
+    if (filePosition != nullptr)
+    {
+        *filePosition = it->second.filePosition;
+    }
+
+    if (segmentSize != nullptr)
+    {
+        *segmentSize = it->second.size;
+    }
+
+    return true;
+}
+
+void CSubBlockDeduplicator::AddSegment(const Key& key, std::uint64_t filePosition, std::uint64_t segmentSize)
+{
+    this->segments[key] = Segment{ filePosition, segmentSize };
+    ++this->statistics.subBlocksWritten;
+}
+
+void CSubBlockDeduplicator::AddDuplicate(std::uint64_t segmentSize)
+{
+    ++this->statistics.subBlocksDeduplicated;
+    this->statistics.bytesSaved += segmentSize;
+}
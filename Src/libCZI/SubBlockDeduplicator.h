@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "libCZI.h"
+#include "CziSubBlockDirectory.h"
+
+namespace libCZI
+{
+    namespace detail
+    {
+        /// This class keeps track of the subblock-segments which have been written, identified by a hash of their content. It is used
+        /// by the writer in order to determine whether a subblock with identical content has been written before, in which case
+        /// the directory-entry of the new subblock can refer to the existing segment.
+        /// The content of a subblock is identified by an MD5-hash over its data, its metadata and its attachment, and in addition
+        /// the pixel type, the compression, the physical size, the pyramid type and the number of dimension-entries must be equal.
+        /// Note that those properties are contained in the subblock-directory-entry as well as in the segment-header, and readers
+        /// check them for consistency (and the number of dimension-entries determines the size of the segment-header).
+        class CSubBlockDeduplicator
+        {
+        public:
+            /// The key identifying the content of a subblock-segment.
+            struct Key
+            {
+                std::uint8_t hash[16];          ///< The MD5-hash of the data, the metadata and the attachment.
+                std::uint64_t dataSize;
+                std::uint64_t metadataSize;
+                std::uint64_t attachmentSize;
+                std::int32_t compression;
+                std::int32_t pixelType;
+                std::int32_t storedWidth;
+                std::int32_t storedHeight;
+                std::uint8_t pyramidType;
+                std::int32_t dimensionCount;    ///< The number of dimension-entries in the directory-entry.
+
+                bool operator==(const Key& other) const;
+            };
+
+            /// Calculates the key for the specified subblock.
+            ///
+            /// \param  entry       The directory-entry of the subblock.
+            /// \param  data        The data of the subblock.
+            /// \param  metadata    The metadata of the subblock.
+            /// \param  attachment  The attachment of the subblock.
+            ///
+            /// \returns The calculated key.
+            static Key CalculateKey(const CCziSubBlockDirectoryBase::SubBlkEntry& entry, const std::vector<std::uint8_t>& data, const std::vector<std::uint8_t>& metadata, const std::vector<std::uint8_t>& attachment);
+
+            /// Attempts to find a segment with the specified key.
+            ///
+            /// \param          key             The key.
+            /// \param [out]    filePosition    If non-null and successful, the file-position of the segment is put here.
+            /// \param [out]    segmentSize     If non-null and successful, the size of the segment (in bytes, including the segment-header) is put here.
+            ///
+            /// \returns True if a segment with the specified key has been written before; false otherwise.
+            bool TryGetSegment(const Key& key, std::uint64_t* filePosition, std::uint64_t* segmentSize) const;
+
+            /// Adds the information about a segment which has been written.
+            ///
+            /// \param  key             The key.
+            /// \param  filePosition    The file-position of the segment.
+            /// \param  segmentSize     The size of the segment (in bytes, including the segment-header).
+            void AddSegment(const Key& key, std::uint64_t filePosition, std::uint64_t segmentSize);
+
+            /// Records that a subblock has been added which refers to an existing segment.
+            ///
+            /// \param  segmentSize The size of the existing segment (in bytes, including the segment-header).
+            void AddDuplicate(std::uint64_t segmentSize);
+
+            /// Gets the statistics about the deduplication so far.
+            ///
+            /// \returns The statistics.
+            const libCZI::SubBlockDeduplicationStatistics& GetStatistics() const { return this->statistics; }
+        private:
+            struct KeyHash
+            {
+                size_t operator()(const Key& key) const;
+            };
+
+            struct Segment
+            {
+                std::uint64_t filePosition;
+                std::uint64_t size;
+            };
+
+            std::unordered_map<Key, Segment, KeyHash> segments;
+            libCZI::SubBlockDeduplicationStatistics statistics;
+        };
+    } // namespace detail
+} // namespace libCZI
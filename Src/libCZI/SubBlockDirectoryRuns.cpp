@@ -0,0 +1,298 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "SubBlockDirectoryRuns.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+using namespace libCZI;
+using namespace libCZI::detail;
+
+CSubBlockDirectoryRuns::CSubBlockDirectoryRuns(LessFunc less)
+    : less(std::move(less)), fp(nullptr), recordCount(0), currentRunStart(0)
+{
+    this->fp = tmpfile();
+    if (this->fp == nullptr)
+    {
+        const auto err = errno;
+        ostringstream ss;
+        ss << "Creating a temporary file for the subblock-directory failed, errno=" << err << ".";
+        throw std::runtime_error(ss.str());
+    }
+
+    this->writeBuffer.reserve(RecordsPerBlock);
+}
+
+CSubBlockDirectoryRuns::~CSubBlockDirectoryRuns()
+{
+    fclose(this->fp);
+}
+
+void CSubBlockDirectoryRuns::Append(const CCziSubBlockDirectoryBase::SubBlkEntry& entry, std::uint64_t hash)
+{
+    Record record;
+    CSubBlockDirectoryRuns::RecordFromEntry(entry, record);
+    this->writeBuffer.push_back(record);
+    ++this->recordCount;
+    this->AddToFilter(hash);
+    if (this->writeBuffer.size() >= RecordsPerBlock)
+    {
+        this->FlushWriteBuffer();
+    }
+}
+
+void CSubBlockDirectoryRuns::EndRun()
+{
+    this->FlushWriteBuffer();
+    if (this->recordCount > this->currentRunStart)
+    {
+        this->runs.emplace_back(this->currentRunStart, this->recordCount);
+        this->currentRunStart = this->recordCount;
+    }
+}
+
+bool CSubBlockDirectoryRuns::Contains(const CCziSubBlockDirectoryBase::SubBlkEntry& entry, std::uint64_t hash) const
+{
+    if (!this->IsPossiblyInFilter(hash))
+    {
+        return false;
+    }
+
+    for (const auto& run : this->runs)
+    {
+        if (this->ContainsInRun(entry, run.first, run.second))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<CSubBlockDirectoryRuns::RunCursor> CSubBlockDirectoryRuns::CreateCursors() const
+{
+    std::vector<RunCursor> cursors;
+    cursors.reserve(this->runs.size());
+    for (const auto& run : this->runs)
+    {
+        cursors.emplace_back(this, run.first, run.second);
+    }
+
+    return cursors;
+}
+
+void CSubBlockDirectoryRuns::FlushWriteBuffer()
+{
+    if (this->writeBuffer.empty())
+    {
+        return;
+    }
+
+    const uint64_t index = this->recordCount - this->writeBuffer.size();
+    CSubBlockDirectoryRuns::Seek(this->fp, index * sizeof(Record));
+    const size_t recordsWritten = fwrite(this->writeBuffer.data(), sizeof(Record), this->writeBuffer.size(), this->fp);
+    if (recordsWritten != this->writeBuffer.size())
+    {
+        const auto err = errno;
+        ostringstream ss;
+        ss << "Writing to the temporary file for the subblock-directory failed, errno=" << err << ".";
+        throw std::runtime_error(ss.str());
+    }
+
+    this->writeBuffer.clear();
+}
+
+void CSubBlockDirectoryRuns::ReadRecords(std::uint64_t index, size_t count, Record* records) const
+{
+    CSubBlockDirectoryRuns::Seek(this->fp, index * sizeof(Record));
+    const size_t recordsRead = fread(records, sizeof(Record), count, this->fp);
+    if (recordsRead != count)
+    {
+        const auto err = errno;
+        ostringstream ss;
+        ss << "Reading from the temporary file for the subblock-directory failed, errno=" << err << ".";
+        throw std::runtime_error(ss.str());
+    }
+}
+
+bool CSubBlockDirectoryRuns::ContainsInRun(const CCziSubBlockDirectoryBase::SubBlkEntry& entry, std::uint64_t start, std::uint64_t end) const
+{
+    // binary search for the first element which is not less than "entry"
+    while (start < end)
+    {
+        const uint64_t mid = start + (end - start) / 2;
+        Record record;
+        this->ReadRecords(mid, 1, &record);
+        CCziSubBlockDirectoryBase::SubBlkEntry entryMid;
+        CSubBlockDirectoryRuns::EntryFromRecord(record, entryMid);
+        if (this->less(entryMid, entry))
+        {
+            start = mid + 1;
+        }
+        else if (this->less(entry, entryMid))
+        {
+            end = mid;
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void CSubBlockDirectoryRuns::AddToFilter(std::uint64_t hash)
+{
+    if (this->filter.empty())
+    {
+        this->filter.resize(FilterSizeInBits / 64, 0);
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const auto bitIndex = CSubBlockDirectoryRuns::GetFilterBitIndex(hash, i);
+        this->filter[bitIndex / 64] |= (1ull << (bitIndex % 64));
+    }
+}
+
+bool CSubBlockDirectoryRuns::IsPossiblyInFilter(std::uint64_t hash) const
+{
+    if (this->filter.empty())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const auto bitIndex = CSubBlockDirectoryRuns::GetFilterBitIndex(hash, i);
+        if ((this->filter[bitIndex / 64] & (1ull << (bitIndex % 64))) == 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*static*/std::uint64_t CSubBlockDirectoryRuns::GetFilterBitIndex(std::uint64_t hash, int i)
+{
+    // "double hashing" - the second hash is derived from the first one by a mixing-function (from "SplitMix64")
+    uint64_t hash2 = hash + 0x9e3779b97f4a7c15ull;
+    hash2 = (hash2 ^ (hash2 >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash2 = (hash2 ^ (hash2 >> 27)) * 0x94d049bb133111ebull;
+    hash2 = hash2 ^ (hash2 >> 31);
+    return (hash + i * (hash2 | 1)) % FilterSizeInBits;
+}
+
+/*static*/void CSubBlockDirectoryRuns::RecordFromEntry(const CCziSubBlockDirectoryBase::SubBlkEntry& entry, Record& record)
+{
+    // the record is written to the temporary file as it is, so we clear it completely (including the padding bytes)
+    memset(&record, 0, sizeof(record));
+    for (int i = 0; i < static_cast<int>(sizeof(record.coordinate) / sizeof(record.coordinate[0])); ++i)
+    {
+        int value;
+        if (entry.coordinate.TryGetPosition(static_cast<DimensionIndex>(i + static_cast<int>(DimensionIndex::MinDim)), &value))
+        {
+            record.coordinate[i] = value;
+            record.validDimensions |= (1u << i);
+        }
+    }
+
+    record.mIndex = entry.mIndex;
+    record.x = entry.x;
+    record.y = entry.y;
+    record.width = entry.width;
+    record.height = entry.height;
+    record.storedWidth = entry.storedWidth;
+    record.storedHeight = entry.storedHeight;
+    record.pixelType = entry.PixelType;
+    record.compression = entry.Compression;
+    record.filePosition = entry.FilePosition;
+    record.pyramidType = entry.pyramid_type_from_spare;
+}
+
+/*static*/void CSubBlockDirectoryRuns::EntryFromRecord(const Record& record, CCziSubBlockDirectoryBase::SubBlkEntry& entry)
+{
+    entry.coordinate.Clear();
+    for (int i = 0; i < static_cast<int>(sizeof(record.coordinate) / sizeof(record.coordinate[0])); ++i)
+    {
+        if ((record.validDimensions & (1u << i)) != 0)
+        {
+            entry.coordinate.Set(static_cast<DimensionIndex>(i + static_cast<int>(DimensionIndex::MinDim)), record.coordinate[i]);
+        }
+    }
+
+    entry.mIndex = record.mIndex;
+    entry.x = record.x;
+    entry.y = record.y;
+    entry.width = record.width;
+    entry.height = record.height;
+    entry.storedWidth = record.storedWidth;
+    entry.storedHeight = record.storedHeight;
+    entry.PixelType = record.pixelType;
+    entry.Compression = record.compression;
+    entry.FilePosition = record.filePosition;
+    entry.pyramid_type_from_spare = record.pyramidType;
+}
+
+/*static*/void CSubBlockDirectoryRuns::Seek(FILE* fp, std::uint64_t offset)
+{
+#if defined(_WIN32)
+    int r = _fseeki64(fp, offset, SEEK_SET);
+#else
+    int r = fseeko(fp, offset, SEEK_SET);
+#endif
+
+    if (r != 0)
+    {
+        const auto err = errno;
+        ostringstream ss;
+        ss << "Seek to file-position " << offset << " in the temporary file for the subblock-directory failed, errno=" << err << ".";
+        throw std::runtime_error(ss.str());
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+
+CSubBlockDirectoryRuns::RunCursor::RunCursor(const CSubBlockDirectoryRuns* runs, std::uint64_t start, std::uint64_t end)
+    : runs(runs), position(start), end(end), indexInBuffer(0)
+{
+    this->ReadCurrent();
+}
+
+bool CSubBlockDirectoryRuns::RunCursor::IsAtEnd() const
+{
+    return this->indexInBuffer >= this->buffer.size();
+}
+
+void CSubBlockDirectoryRuns::RunCursor::MoveNext()
+{
+    ++this->indexInBuffer;
+    this->ReadCurrent();
+}
+
+void CSubBlockDirectoryRuns::RunCursor::ReadCurrent()
+{
+    if (this->indexInBuffer >= this->buffer.size())
+    {
+        // the buffer is exhausted, so we read the next block of the run
+        const size_t count = static_cast<size_t>((std::min)(static_cast<uint64_t>(RecordsPerBlock), this->end - this->position));
+        this->buffer.resize(count);
+        this->indexInBuffer = 0;
+        if (count == 0)
+        {
+            return;
+        }
+
+        this->runs->ReadRecords(this->position, count, this->buffer.data());
+        this->position += count;
+    }
+
+    CSubBlockDirectoryRuns::EntryFromRecord(this->buffer[this->indexInBuffer], this->current);
+}
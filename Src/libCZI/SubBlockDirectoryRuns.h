@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "CziSubBlockDirectory.h"
+
+namespace libCZI
+{
+    namespace detail
+    {
+        /// This class is used by the subblock-directory of the writer in order to keep its memory consumption bounded. Sorted runs
+        /// of subblock-directory-entries are "spilled" into a temporary file (which is deleted automatically when the object is
+        /// destroyed). The runs can be searched for an entry, and they can be enumerated in a merged (sorted) order. In addition, a
+        /// Bloom-filter (of fixed size) over a hash of the entries in the runs is maintained, which allows to skip the search in
+        /// the runs for most of the entries.
+        class CSubBlockDirectoryRuns
+        {
+        public:
+            /// The "less-comparison" which defines the order of the entries within a run.
+            typedef std::function<bool(const CCziSubBlockDirectoryBase::SubBlkEntry&, const CCziSubBlockDirectoryBase::SubBlkEntry&)> LessFunc;
+
+            /// The record as stored in the temporary file (in host byte order).
+            struct Record
+            {
+                std::int32_t coordinate[static_cast<int>(libCZI::DimensionIndex::MaxDim) - static_cast<int>(libCZI::DimensionIndex::MinDim) + 1];
+                std::uint32_t validDimensions;  ///< Bit-field indicating which elements of "coordinate" are valid.
+                std::int32_t mIndex;
+                std::int32_t x;
+                std::int32_t y;
+                std::int32_t width;
+                std::int32_t height;
+                std::int32_t storedWidth;
+                std::int32_t storedHeight;
+                std::int32_t pixelType;
+                std::int32_t compression;
+                std::uint64_t filePosition;
+                std::uint8_t pyramidType;
+            };
+
+            /// A cursor for reading a run sequentially.
+            class RunCursor
+            {
+            private:
+                const CSubBlockDirectoryRuns* runs;
+                std::uint64_t position;     ///< The index (in the temporary file) of the next record to be read into the buffer.
+                std::uint64_t end;          ///< The index (in the temporary file) of the record after the last record of the run.
+                std::vector<Record> buffer;
+                size_t indexInBuffer;
+                CCziSubBlockDirectoryBase::SubBlkEntry current;
+            public:
+                RunCursor(const CSubBlockDirectoryRuns* runs, std::uint64_t start, std::uint64_t end);
+
+                /// Query if the end of the run has been reached. If not, then "GetCurrent" gives the current entry.
+                /// \returns True if the end of the run has been reached; false otherwise.
+                bool IsAtEnd() const;
+                const CCziSubBlockDirectoryBase::SubBlkEntry& GetCurrent() const { return this->current; }
+                void MoveNext();
+            private:
+                void ReadCurrent();
+            };
+
+            /// Constructor.
+            ///
+            /// \param  less    The "less-comparison" defining the order of the entries within a run. Two entries are considered as
+            ///                 being equal if neither of them is less than the other.
+            explicit CSubBlockDirectoryRuns(LessFunc less);
+            ~CSubBlockDirectoryRuns();
+
+            CSubBlockDirectoryRuns(const CSubBlockDirectoryRuns&) = delete;
+            CSubBlockDirectoryRuns& operator=(const CSubBlockDirectoryRuns&) = delete;
+
+            /// Appends an entry to the current run. The entries must be appended in sorted order. A new run is started
+            /// with the first call after "EndRun".
+            ///
+            /// \param  entry   The entry.
+            /// \param  hash    The hash of the entry (which must be the same for entries considered equal), which is added to the filter.
+            void Append(const CCziSubBlockDirectoryBase::SubBlkEntry& entry, std::uint64_t hash);
+
+            /// Finishes the current run.
+            void EndRun();
+
+            /// Query if one of the runs contains an entry which is equal to the specified one.
+            ///
+            /// \param  entry   The entry.
+            /// \param  hash    The hash of the entry.
+            ///
+            /// \returns True if an equal entry is contained; false otherwise.
+            bool Contains(const CCziSubBlockDirectoryBase::SubBlkEntry& entry, std::uint64_t hash) const;
+
+            /// Creates cursors for all runs.
+            ///
+            /// \returns    A vector with a cursor for each run.
+            std::vector<RunCursor> CreateCursors() const;
+
+            /// Gets the total number of entries in all runs.
+            std::uint64_t GetEntryCount() const { return this->recordCount; }
+        private:
+            /// The number of records which are written or read with one file-operation.
+            static constexpr size_t RecordsPerBlock = 4096;
+
+            /// The size of the Bloom-filter in bits - this is chosen so that the rate of false positives stays reasonably small
+            /// for ~20 million entries.
+            static constexpr std::uint64_t FilterSizeInBits = 128ull * 1024 * 1024;
+
+            LessFunc less;
+            FILE* fp;
+            std::uint64_t recordCount;
+
+            /// The runs which are complete - the start (index of the first record) and the end (index after the last record).
+            std::vector<std::pair<std::uint64_t, std::uint64_t>> runs;
+            std::uint64_t currentRunStart;
+
+            std::vector<Record> writeBuffer;
+            std::vector<std::uint64_t> filter;
+
+            void FlushWriteBuffer();
+            void ReadRecords(std::uint64_t index, size_t count, Record* records) const;
+            bool ContainsInRun(const CCziSubBlockDirectoryBase::SubBlkEntry& entry, std::uint64_t start, std::uint64_t end) const;
+            void AddToFilter(std::uint64_t hash);
+            bool IsPossiblyInFilter(std::uint64_t hash) const;
+            static std::uint64_t GetFilterBitIndex(std::uint64_t hash, int i);
+
+            static void RecordFromEntry(const CCziSubBlockDirectoryBase::SubBlkEntry& entry, Record& record);
+            static void EntryFromRecord(const Record& record, CCziSubBlockDirectoryBase::SubBlkEntry& entry);
+            static void Seek(FILE* fp, std::uint64_t offset);
+        };
+    } // namespace detail
+} // namespace libCZI
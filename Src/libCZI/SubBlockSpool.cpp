@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "SubBlockSpool.h"
+#include <cerrno>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+using namespace libCZI::detail;
+
+CSubBlockSpool::CSubBlockSpool()
+    : fp(nullptr), size(0)
+{
+    this->fp = tmpfile();
+    if (this->fp == nullptr)
+    {
+        const auto err = errno;
+        ostringstream ss;
+        ss << "Creating a temporary file for the subblocks held back failed, errno=" << err << ".";
+        throw std::runtime_error(ss.str());
+    }
+}
+
+CSubBlockSpool::~CSubBlockSpool()
+{
+    fclose(this->fp);
+}
+
+std::uint64_t CSubBlockSpool::Append(const void* pv, std::uint64_t size)
+{
+    const uint64_t position = this->size;
+    if (size > 0)
+    {
+        CSubBlockSpool::Seek(this->fp, position);
+        const size_t bytesWritten = fwrite(pv, 1, static_cast<size_t>(size), this->fp);
+        if (bytesWritten != size)
+        {
+            const auto err = errno;
+            ostringstream ss;
+            ss << "Writing to the temporary file for the subblocks held back failed, errno=" << err << ".";
+            throw std::runtime_error(ss.str());
+        }
+
+        this->size += size;
+    }
+
+    return position;
+}
+
+void CSubBlockSpool::Read(std::uint64_t position, void* pv, std::uint64_t size) const
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    CSubBlockSpool::Seek(this->fp, position);
+    const size_t bytesRead = fread(pv, 1, static_cast<size_t>(size), this->fp);
+    if (bytesRead != size)
+    {
+        const auto err = errno;
+        ostringstream ss;
+        ss << "Reading from the temporary file for the subblocks held back failed, errno=" << err << ".";
+        throw std::runtime_error(ss.str());
+    }
+}
+
+/*static*/void CSubBlockSpool::Seek(FILE* fp, std::uint64_t offset)
+{
+#if defined(_WIN32)
+    int r = _fseeki64(fp, offset, SEEK_SET);
+#else
+    int r = fseeko(fp, offset, SEEK_SET);
+#endif
+
+    if (r != 0)
+    {
+        const auto err = errno;
+        ostringstream ss;
+        ss << "Seek to file-position " << offset << " in the temporary file for the subblocks held back failed, errno=" << err << ".";
+        throw std::runtime_error(ss.str());
+    }
+}
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+namespace libCZI
+{
+    namespace detail
+    {
+        /// This class is used by the writer in order to hold back the content of subblocks (which are written in a different order
+        /// than they are added) without keeping it in memory. The content is appended to a temporary file (which is deleted
+        /// automatically when the object is destroyed), and it can be read back in any order.
+        class CSubBlockSpool
+        {
+        public:
+            CSubBlockSpool();
+            ~CSubBlockSpool();
+
+            CSubBlockSpool(const CSubBlockSpool&) = delete;
+            CSubBlockSpool& operator=(const CSubBlockSpool&) = delete;
+
+            /// Appends the specified data to the temporary file.
+            ///
+            /// \param  pv      Pointer to the data.
+            /// \param  size    The size of the data in bytes.
+            ///
+            /// \returns    The position (in the temporary file) where the data was written.
+            std::uint64_t Append(const void* pv, std::uint64_t size);
+
+            /// Reads data (which has been appended before) from the temporary file.
+            ///
+            /// \param          position    The position (in the temporary file) of the data.
+            /// \param [out]    pv          Pointer to the buffer which receives the data.
+            /// \param          size        The size of the data in bytes.
+            void Read(std::uint64_t position, void* pv, std::uint64_t size) const;
+        private:
+            FILE* fp;
+            std::uint64_t size;     ///< The size of the data appended so far.
+
+            static void Seek(FILE* fp, std::uint64_t offset);
+        };
+    } // namespace detail
+} // namespace libCZI
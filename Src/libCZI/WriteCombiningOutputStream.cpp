@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "WriteCombiningOutputStream.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+using namespace libCZI;
+using namespace libCZI::detail;
+
+CWriteCombiningBuffer::CWriteCombiningBuffer(std::uint64_t bufferSize)
+    : bufferSize(bufferSize), bufferStartOffset(0), bufferUsedSize(0)
+{
+    if (bufferSize == 0 || bufferSize > (numeric_limits<size_t>::max)())
+    {
+        throw invalid_argument("Invalid size for the write-combining buffer.");
+    }
+
+    this->buffer.reset(new uint8_t[static_cast<size_t>(bufferSize)]);
+}
+
+void CWriteCombiningBuffer::Write(libCZI::IOutputStream* stream, std::uint64_t offset, const void* pv, std::uint64_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    if (!this->IsEmpty())
+    {
+        // check whether the data can go into the buffer - this is the case if it starts within the buffered range (or
+        //  immediately after it) and if it ends within the capacity of the buffer
+        if (offset >= this->bufferStartOffset &&
+            offset <= this->bufferStartOffset + this->bufferUsedSize &&
+            offset + size <= this->bufferStartOffset + this->bufferSize)
+        {
+            const uint64_t offsetInBuffer = offset - this->bufferStartOffset;
+            memcpy(this->buffer.get() + offsetInBuffer, pv, static_cast<size_t>(size));
+            this->bufferUsedSize = (max)(this->bufferUsedSize, offsetInBuffer + size);
+            return;
+        }
+
+        if (!this->IsOverlappingWithBufferedRange(offset, size) && offset != this->bufferStartOffset + this->bufferUsedSize)
+        {
+            // the data does not touch the buffered range, so we can write it directly (and keep the buffer)
+            CWriteCombiningBuffer::WriteToStream(stream, offset, pv, size);
+            return;
+        }
+
+        this->Flush(stream);
+    }
+
+    if (size >= this->bufferSize)
+    {
+        CWriteCombiningBuffer::WriteToStream(stream, offset, pv, size);
+        return;
+    }
+
+    memcpy(this->buffer.get(), pv, static_cast<size_t>(size));
+    this->bufferStartOffset = offset;
+    this->bufferUsedSize = size;
+}
+
+void CWriteCombiningBuffer::Flush(libCZI::IOutputStream* stream)
+{
+    if (!this->IsEmpty())
+    {
+        // note that we clear the buffer before writing, so that we do not write the data again if the write-operation failed
+        const uint64_t size = this->bufferUsedSize;
+        this->bufferUsedSize = 0;
+        CWriteCombiningBuffer::WriteToStream(stream, this->bufferStartOffset, this->buffer.get(), size);
+    }
+}
+
+bool CWriteCombiningBuffer::IsOverlappingWithBufferedRange(std::uint64_t offset, std::uint64_t size) const
+{
+    if (this->IsEmpty() || size == 0)
+    {
+        return false;
+    }
+
+    return offset < this->bufferStartOffset + this->bufferUsedSize && this->bufferStartOffset < offset + size;
+}
+
+/*static*/void CWriteCombiningBuffer::WriteToStream(libCZI::IOutputStream* stream, std::uint64_t offset, const void* pv, std::uint64_t size)
+{
+    uint64_t bytesWritten = 0;
+    stream->Write(offset, pv, size, &bytesWritten);
+    if (bytesWritten != size)
+    {
+        stringstream ss;
+        ss << "Not enough data written at offset " << offset << " -> bytes to write: " << size << " bytes, actually written " << bytesWritten << " bytes.";
+        throw runtime_error(ss.str());
+    }
+}
+
+//----------------------------------------------------------------------------
+
+CWriteCombiningOutputStream::CWriteCombiningOutputStream(std::shared_ptr<libCZI::IOutputStream> stream, std::uint64_t bufferSize)
+    : stream(std::move(stream)), buffer(bufferSize)
+{
+}
+
+void CWriteCombiningOutputStream::Flush()
+{
+    this->buffer.Flush(this->stream.get());
+}
+
+/*virtual*/void CWriteCombiningOutputStream::Write(std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* ptrBytesWritten)
+{
+    this->buffer.Write(this->stream.get(), offset, pv, size);
+    if (ptrBytesWritten != nullptr)
+    {
+        *ptrBytesWritten = size;
+    }
+}
+
+//----------------------------------------------------------------------------
+
+CWriteCombiningInputOutputStream::CWriteCombiningInputOutputStream(std::shared_ptr<libCZI::IInputOutputStream> stream, std::uint64_t bufferSize)
+    : stream(std::move(stream)), buffer(bufferSize)
+{
+}
+
+void CWriteCombiningInputOutputStream::Flush()
+{
+    this->buffer.Flush(this->stream.get());
+}
+
+/*virtual*/void CWriteCombiningInputOutputStream::Read(std::uint64_t offset, void* pv, std::uint64_t size, std::uint64_t* ptrBytesRead)
+{
+    if (this->buffer.IsOverlappingWithBufferedRange(offset, size))
+    {
+        this->buffer.Flush(this->stream.get());
+    }
+
+    this->stream->Read(offset, pv, size, ptrBytesRead);
+}
+
+/*virtual*/void CWriteCombiningInputOutputStream::Write(std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* ptrBytesWritten)
+{
+    this->buffer.Write(this->stream.get(), offset, pv, size);
+    if (ptrBytesWritten != nullptr)
+    {
+        *ptrBytesWritten = size;
+    }
+}
@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "libCZI.h"
+
+namespace libCZI
+{
+    namespace detail
+    {
+        /// This class implements a write-combining buffer. It holds a contiguous range of the output-stream in memory, and writes
+        /// which fall into (or extend) this range are coalesced in the buffer. So, a sequence of small writes (like the segment
+        /// header, the metadata, the data and the attachment of a subblock) results in a single write to the underlying stream.
+        /// Writes which patch data already in the buffer (e.g. updating a header which has been written before) are also
+        /// handled in the buffer. Writes which do not overlap the buffered range are passed through to the underlying stream
+        /// unchanged, and writes larger than the buffer are passed through as well (after flushing the buffer if necessary).
+        /// Note that this class is NOT thread-safe.
+        class CWriteCombiningBuffer
+        {
+        private:
+            std::unique_ptr<std::uint8_t[]> buffer;
+            std::uint64_t bufferSize;
+            std::uint64_t bufferStartOffset;    ///< The position in the stream of the first byte in the buffer.
+            std::uint64_t bufferUsedSize;       ///< The number of bytes in the buffer which are in use.
+        public:
+            CWriteCombiningBuffer() = delete;
+
+            /// Constructor.
+            ///
+            /// \param  bufferSize  The size of the buffer in bytes. This must be greater than zero.
+            explicit CWriteCombiningBuffer(std::uint64_t bufferSize);
+
+            /// Writes the specified data. The data is either put into the buffer, or it is written to the specified stream.
+            ///
+            /// \param [in] stream  The underlying stream.
+            /// \param      offset  The offset into the stream where to start the write-operation.
+            /// \param      pv      Pointer to the data.
+            /// \param      size    The size of the data.
+            void Write(libCZI::IOutputStream* stream, std::uint64_t offset, const void* pv, std::uint64_t size);
+
+            /// Writes the content of the buffer to the specified stream (if the buffer is not empty), and then clears the buffer.
+            /// An exception is thrown if the underlying stream reports that it did not write all data.
+            ///
+            /// \param [in] stream  The underlying stream.
+            void Flush(libCZI::IOutputStream* stream);
+
+            /// Query if the specified range of the stream overlaps with the range held in the buffer.
+            ///
+            /// \param  offset  The offset into the stream.
+            /// \param  size    The size of the range.
+            ///
+            /// \returns    True if the range overlaps with the buffered range, false otherwise.
+            bool IsOverlappingWithBufferedRange(std::uint64_t offset, std::uint64_t size) const;
+
+            /// Query if the buffer is empty.
+            ///
+            /// \returns    True if the buffer is empty, false otherwise.
+            bool IsEmpty() const { return this->bufferUsedSize == 0; }
+        private:
+            static void WriteToStream(libCZI::IOutputStream* stream, std::uint64_t offset, const void* pv, std::uint64_t size);
+        };
+
+        /// An output-stream decorator which coalesces writes with a write-combining buffer (c.f. CWriteCombiningBuffer).
+        /// The data held in the buffer is written to the underlying stream only when calling "Flush" (or when the buffer needs to
+        /// be re-used) - the destructor does NOT flush the buffer. Note that this implementation is NOT thread-safe.
+        class CWriteCombiningOutputStream : public libCZI::IOutputStream
+        {
+        private:
+            std::shared_ptr<libCZI::IOutputStream> stream;
+            CWriteCombiningBuffer buffer;
+        public:
+            CWriteCombiningOutputStream() = delete;
+
+            /// Constructor.
+            ///
+            /// \param  stream      The underlying stream.
+            /// \param  bufferSize  The size of the write-combining buffer in bytes.
+            CWriteCombiningOutputStream(std::shared_ptr<libCZI::IOutputStream> stream, std::uint64_t bufferSize);
+
+            /// Writes the content of the buffer to the underlying stream.
+            void Flush();
+        public: // interface libCZI::IOutputStream
+            void Write(std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* ptrBytesWritten) override;
+        };
+
+        /// An input-output-stream decorator which coalesces writes with a write-combining buffer (c.f. CWriteCombiningBuffer).
+        /// If a read-operation overlaps with the data held in the buffer, the buffer is flushed before reading, so that
+        /// read-operations always see the data written before. As with CWriteCombiningOutputStream, the destructor does NOT flush
+        /// the buffer. Note that this implementation is NOT thread-safe.
+        class CWriteCombiningInputOutputStream : public libCZI::IInputOutputStream
+        {
+        private:
+            std::shared_ptr<libCZI::IInputOutputStream> stream;
+            CWriteCombiningBuffer buffer;
+        public:
+            CWriteCombiningInputOutputStream() = delete;
+
+            /// Constructor.
+            ///
+            /// \param  stream      The underlying stream.
+            /// \param  bufferSize  The size of the write-combining buffer in bytes.
+            CWriteCombiningInputOutputStream(std::shared_ptr<libCZI::IInputOutputStream> stream, std::uint64_t bufferSize);
+
+            /// Writes the content of the buffer to the underlying stream.
+            void Flush();
+        public: // interface libCZI::IInputOutputStream
+            void Read(std::uint64_t offset, void* pv, std::uint64_t size, std::uint64_t* ptrBytesRead) override;
+            void Write(std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* ptrBytesWritten) override;
+        };
+    } // namespace detail
+} // namespace libCZI
@@ -0,0 +1,237 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "cpu_dispatch.h"
+#include "inc_libCZI_Config.h"
+#include "utilities.h"
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+
+#if LIBCZI_HAS_AVXINTRINSICS && defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
+using namespace std;
+using namespace libCZI::detail;
+
+namespace
+{
+#if LIBCZI_HAS_AVXINTRINSICS
+    // from https://software.intel.com/content/www/us/en/develop/articles/how-to-detect-new-instruction-support-in-the-4th-generation-intel-core-processor-family.html
+    void run_cpuid(uint32_t eax, uint32_t ecx, uint32_t* abcd)
+    {
+#if defined(_MSC_VER)
+        __cpuidex(reinterpret_cast<int*>(abcd), eax, ecx);
+#else
+        uint32_t ebx, edx;
+# if defined( __i386__ ) && defined ( __PIC__ )
+        /* in case of PIC under 32-bit EBX cannot be clobbered */
+        __asm__("movl %%ebx, %%edi \n\t cpuid \n\t xchgl %%ebx, %%edi" : "=D" (ebx),
+# else
+        __asm__("cpuid" : "+b" (ebx),
+# endif
+            "+a" (eax), "+c" (ecx), "=d" (edx));
+        abcd[0] = eax; abcd[1] = ebx; abcd[2] = ecx; abcd[3] = edx;
+#endif
+    }
+
+    uint32_t get_xcr0()
+    {
+        uint32_t xcr0;
+#if defined(_MSC_VER)
+        xcr0 = static_cast<uint32_t>(_xgetbv(0));  /* min VS2010 SP1 compiler is required */
+#else
+        __asm__("xgetbv" : "=a" (xcr0) : "c" (0) : "%edx");
+#endif
+        return xcr0;
+    }
+
+    bool check_4th_gen_intel_core_features()
+    {
+        uint32_t abcd[4];
+        constexpr uint32_t fma_movbe_osxsave_mask = ((1 << 12) | (1 << 22) | (1 << 27));
+        constexpr uint32_t avx2_bmi12_mask = (1 << 5) | (1 << 3) | (1 << 8);
+
+        /*  CPUID.(EAX=01H, ECX=0H):ECX.FMA[bit 12]==1   &&
+            CPUID.(EAX=01H, ECX=0H):ECX.MOVBE[bit 22]==1 &&
+            CPUID.(EAX=01H, ECX=0H):ECX.OSXSAVE[bit 27]==1 */
+        run_cpuid(1, 0, abcd);
+        if ((abcd[2] & fma_movbe_osxsave_mask) != fma_movbe_osxsave_mask)
+            return false;
+
+        /* checking if xmm and ymm state are enabled in XCR0 */
+        if ((get_xcr0() & 6) != 6)
+            return false;
+
+        /*  CPUID.(EAX=07H, ECX=0H):EBX.AVX2[bit 5]==1  &&
+            CPUID.(EAX=07H, ECX=0H):EBX.BMI1[bit 3]==1  &&
+            CPUID.(EAX=07H, ECX=0H):EBX.BMI2[bit 8]==1  */
+        run_cpuid(7, 0, abcd);
+        if ((abcd[1] & avx2_bmi12_mask) != avx2_bmi12_mask)
+            return false;
+
+        /* CPUID.(EAX=80000001H):ECX.LZCNT[bit 5]==1 */
+        run_cpuid(0x80000001, 0, abcd);
+        if ((abcd[2] & (1 << 5)) == 0)
+            return false;
+
+        return true;
+    }
+#endif
+
+    InstructionSet DetectInstructionSet()
+    {
+#if LIBCZI_HAS_AVXINTRINSICS
+        return check_4th_gen_intel_core_features() ? InstructionSet::AVX2 : InstructionSet::Generic;
+#elif LIBCZI_HAS_NEOININTRINSICS
+        // if NEON-intrinsics are available, then we can assume that NEON is supported (it is mandatory with ARMv8)
+        return InstructionSet::NEON;
+#else
+        return InstructionSet::Generic;
+#endif
+    }
+
+    void ConvertGray16ToGray8Line_C(const std::uint16_t* source, std::uint8_t* destination, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            destination[i] = static_cast<uint8_t>(source[i] >> 8);
+        }
+    }
+
+    void ConvertGray8ToGray16Line_C(const std::uint8_t* source, std::uint16_t* destination, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            destination[i] = source[i];
+        }
+    }
+
+    void FillGray16Line_C(std::uint16_t* destination, size_t count, std::uint16_t value)
+    {
+        std::fill(destination, destination + count, value);
+    }
+
+    const PixelKernels kKernelsGeneric =
+    {
+        InstructionSet::Generic,
+        &LoHiBytePackUnpack::LoHiByteUnpackStrided_C,
+        &LoHiBytePackUnpack::LoHiBytePackStrided_C,
+        &ConvertGray16ToGray8Line_C,
+        &ConvertGray8ToGray16Line_C,
+        &FillGray16Line_C,
+    };
+
+#if LIBCZI_HAS_AVXINTRINSICS
+    const PixelKernels kKernelsAvx2 =
+    {
+        InstructionSet::AVX2,
+        &kernels_avx2::LoHiByteUnpackStrided,
+        &kernels_avx2::LoHiBytePackStrided,
+        &kernels_avx2::ConvertGray16ToGray8Line,
+        &kernels_avx2::ConvertGray8ToGray16Line,
+        &kernels_avx2::FillGray16Line,
+    };
+#endif
+
+#if LIBCZI_HAS_NEOININTRINSICS
+    const PixelKernels kKernelsNeon =
+    {
+        InstructionSet::NEON,
+        &kernels_neon::LoHiByteUnpackStrided,
+        &kernels_neon::LoHiBytePackStrided,
+        &kernels_neon::ConvertGray16ToGray8Line,
+        &kernels_neon::ConvertGray8ToGray16Line,
+        &kernels_neon::FillGray16Line,
+    };
+#endif
+
+    /// The instruction set which has been forced (if this is null, then the detected one is to be used).
+    std::atomic<const PixelKernels*> forced_kernels{ nullptr };
+}
+
+/*static*/const PixelKernels& CpuDispatch::GetKernels()
+{
+    const PixelKernels* forced = forced_kernels.load(std::memory_order_acquire);
+    if (forced != nullptr)
+    {
+        return *forced;
+    }
+
+    static const PixelKernels& detected_kernels = CpuDispatch::GetKernelsForInstructionSet(CpuDispatch::GetDetectedInstructionSet());
+    return detected_kernels;
+}
+
+/*static*/InstructionSet CpuDispatch::GetDetectedInstructionSet()
+{
+    static const InstructionSet detected_instruction_set = DetectInstructionSet();
+    return detected_instruction_set;
+}
+
+/*static*/bool CpuDispatch::IsInstructionSetUsable(InstructionSet instructionSet)
+{
+    const InstructionSet detected = CpuDispatch::GetDetectedInstructionSet();
+    switch (instructionSet)
+    {
+    case InstructionSet::Generic:
+        return true;
+    case InstructionSet::AVX2:
+        return detected == InstructionSet::AVX2;
+    case InstructionSet::NEON:
+        return detected == InstructionSet::NEON;
+    }
+
+    return false;
+}
+
+/*static*/void CpuDispatch::ForceInstructionSet(InstructionSet instructionSet)
+{
+    if (!CpuDispatch::IsInstructionSetUsable(instructionSet))
+    {
+        stringstream ss;
+        ss << "The instruction set '" << CpuDispatch::InstructionSetToInformalString(instructionSet) << "' cannot be used on this machine.";
+        throw invalid_argument(ss.str());
+    }
+
+    forced_kernels.store(&CpuDispatch::GetKernelsForInstructionSet(instructionSet), std::memory_order_release);
+}
+
+/*static*/void CpuDispatch::ResetForcedInstructionSet()
+{
+    forced_kernels.store(nullptr, std::memory_order_release);
+}
+
+/*static*/const char* CpuDispatch::InstructionSetToInformalString(InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+    case InstructionSet::Generic:
+        return "Generic";
+    case InstructionSet::AVX2:
+        return "AVX2";
+    case InstructionSet::NEON:
+        return "NEON";
+    }
+
+    return "invalid";
+}
+
+/*static*/const PixelKernels& CpuDispatch::GetKernelsForInstructionSet(InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+#if LIBCZI_HAS_AVXINTRINSICS
+    case InstructionSet::AVX2:
+        return kKernelsAvx2;
+#endif
+#if LIBCZI_HAS_NEOININTRINSICS
+    case InstructionSet::NEON:
+        return kKernelsNeon;
+#endif
+    default:
+        return kKernelsGeneric;
+    }
+}
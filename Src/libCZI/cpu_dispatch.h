@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace libCZI
+{
+    namespace detail
+    {
+        /// The instruction set extensions which are distinguished when choosing the implementation of a pixel kernel.
+        enum class InstructionSet : std::uint8_t
+        {
+            Generic = 0,    ///< Plain C++ (no intrinsics).
+            AVX2 = 1,       ///< x86/x64 with AVX2 (and BMI1/BMI2, FMA, MOVBE, LZCNT).
+            NEON = 2,       ///< ARM with NEON.
+        };
+
+        /// This structure gathers the function pointers of the pixel kernels for which specialized implementations are available.
+        /// The line kernels (with suffix "Line") operate on a contiguous run of pixels.
+        struct PixelKernels
+        {
+            /// The instruction set this set of kernels has been selected for.
+            InstructionSet instructionSet;
+
+            void(*loHiByteUnpackStrided)(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst);
+            void(*loHiBytePackStrided)(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest);
+
+            /// Convert Gray16 to Gray8 by taking the high byte of each pixel.
+            void(*convertGray16ToGray8Line)(const std::uint16_t* source, std::uint8_t* destination, size_t count);
+
+            /// Convert Gray8 to Gray16 by zero-extending each pixel.
+            void(*convertGray8ToGray16Line)(const std::uint8_t* source, std::uint16_t* destination, size_t count);
+
+            /// Fill the specified number of Gray16-pixels with the specified value.
+            void(*fillGray16Line)(std::uint16_t* destination, size_t count, std::uint16_t value);
+        };
+
+        /// This class is the central place for choosing the implementation of the pixel kernels at runtime. The CPU features are
+        /// detected once, and the kernels for the best instruction set (which is supported by the CPU and for which code has been
+        /// compiled in) are used. For testing, the instruction set can be overridden (restricted to a subset of the supported ones).
+        class CpuDispatch
+        {
+        public:
+            /// Gets the set of kernels to be used.
+            ///
+            /// \returns    The set of kernels to be used.
+            static const PixelKernels& GetKernels();
+
+            /// Gets the best instruction set which is supported by the CPU and for which kernels are available in this build.
+            ///
+            /// \returns    The detected instruction set.
+            static InstructionSet GetDetectedInstructionSet();
+
+            /// Query whether the specified instruction set can be used (i.e. it is supported by the CPU, and kernels
+            /// have been compiled in for it).
+            ///
+            /// \param  instructionSet  The instruction set.
+            ///
+            /// \returns    True if the instruction set can be used, false otherwise.
+            static bool IsInstructionSetUsable(InstructionSet instructionSet);
+
+            /// Force the kernels for the specified instruction set to be used (instead of the detected one). This is intended for testing
+            /// and benchmarking. If the specified instruction set cannot be used, an invalid_argument-exception is thrown.
+            /// Note that this operation is not synchronized with kernels being executed concurrently.
+            ///
+            /// \param  instructionSet  The instruction set.
+            static void ForceInstructionSet(InstructionSet instructionSet);
+
+            /// Reset a previously forced instruction set, so that the kernels for the detected instruction set are used again.
+            static void ResetForcedInstructionSet();
+
+            /// Gets an informal string for the specified instruction set.
+            ///
+            /// \param  instructionSet  The instruction set.
+            ///
+            /// \returns    A static string with the name of the instruction set.
+            static const char* InstructionSetToInformalString(InstructionSet instructionSet);
+
+        private:
+            static const PixelKernels& GetKernelsForInstructionSet(InstructionSet instructionSet);
+        };
+
+        // Note: the following functions are only defined if the respective intrinsics are available (c.f. LIBCZI_HAS_AVXINTRINSICS
+        //        and LIBCZI_HAS_NEOININTRINSICS), and they must only be called through the dispatcher.
+
+        /// The AVX2-implementations of the kernels (in a module which is compiled with AVX2-code-generation enabled).
+        namespace kernels_avx2
+        {
+            void LoHiByteUnpackStrided(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst);
+            void LoHiBytePackStrided(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest);
+            void ConvertGray16ToGray8Line(const std::uint16_t* source, std::uint8_t* destination, size_t count);
+            void ConvertGray8ToGray16Line(const std::uint8_t* source, std::uint16_t* destination, size_t count);
+            void FillGray16Line(std::uint16_t* destination, size_t count, std::uint16_t value);
+        }
+
+        /// The NEON-implementations of the kernels.
+        namespace kernels_neon
+        {
+            void LoHiByteUnpackStrided(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst);
+            void LoHiBytePackStrided(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest);
+            void ConvertGray16ToGray8Line(const std::uint16_t* source, std::uint8_t* destination, size_t count);
+            void ConvertGray8ToGray16Line(const std::uint8_t* source, std::uint16_t* destination, size_t count);
+            void FillGray16Line(std::uint16_t* destination, size_t count, std::uint16_t value);
+        }
+    } // namespace detail
+} // namespace libCZI
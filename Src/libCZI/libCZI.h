@@ -23,6 +23,7 @@
 #include "libCZI_Site.h"
 #include "libCZI_compress.h"
 #include "libCZI_StreamsLib.h"
+#include "libCZI_Instrumentation.h"
 
 // virtual d'tor -> https://isocpp.org/wiki/faq/virtual-functions#virtual-dtors
 
@@ -102,6 +103,19 @@ namespace libCZI
     /// \return The newly created CZI-reader.
     LIBCZI_API std::shared_ptr<ICZIReader> CreateCZIReader();
 
+    /// This enum specifies the order in which a CZI-writer object lays out the subblock segments in the file.
+    enum class CZIWriterSubBlockLayout : std::uint8_t
+    {
+        /// The subblocks are written in the order in which they are added.
+        InOrderOfAddition = 0,
+
+        /// The subblocks are ordered by plane (and pyramid-layer), and within a plane they are ordered along a Z-order curve (Morton order) over the tile position.
+        PlaneThenMortonOrder = 1,
+
+        /// The subblocks are ordered by plane (and pyramid-layer), and within a plane they are ordered along a Hilbert curve over the tile position.
+        PlaneThenHilbertOrder = 2,
+    };
+
     /// Options controlling the operation of a CZI-writer object. Those options are set at construction
     /// time and cannot be mutated afterwards.
     struct CZIWriterOptions
@@ -109,6 +123,67 @@ namespace libCZI
         /// True if the writer should allow that duplicate subblocks are added. In general, it is
         /// not recommended to bypass the check for duplicate subblocks.
         bool allow_duplicate_subblocks{ false };
+
+        /// The number of worker threads used for compressing subblocks added with "ICziWriter::AsyncAddSubBlock". If this
+        /// is 0, then the compression is done synchronously (on the thread calling "AsyncAddSubBlock").
+        std::uint32_t number_of_compression_threads{ 0 };
+
+        /// The maximum amount of memory (in bytes) held by subblocks which have been added with "ICziWriter::AsyncAddSubBlock",
+        /// but which have not yet been written. If this limit is reached, "AsyncAddSubBlock" blocks until enough subblocks
+        /// have been written out. Note that at least one subblock is always allowed to be pending, irrespective of its size.
+        std::uint64_t max_memory_for_pending_subblocks{ 256 * 1024 * 1024 };
+
+        /// If true, then the writer creates pyramid layers for the layer-0 subblocks added. Subblocks added with "ICziWriter::SyncAddSubBlock"
+        /// are decoded for this purpose, so the compression mode of those subblocks must be one of the modes supported for decoding (uncompressed,
+        /// JPG-XR or zstd). The pyramid subblocks are created incrementally while the layer-0 subblocks are added, and they are compressed and
+        /// written along with them. Pyramid tiles which are not completely
+        /// covered by layer-0 subblocks (e.g. at the border of the mosaic) are written when the writer is closed.
+        bool generate_pyramid{ false };
+
+        /// The minification factor between adjacent pyramid layers, this must be either 2 or 3.
+        std::uint8_t pyramid_minification_factor{ 2 };
+
+        /// The (maximum) width and height of pyramid subblocks in pixels. Pyramid layers are created until the extent of
+        /// the plane fits into a single tile.
+        std::uint32_t pyramid_tile_size{ 1024 };
+
+        /// The compression mode used for the pyramid subblocks. Supported are the same compression modes as with "ICziWriter::AsyncAddSubBlock".
+        libCZI::CompressionMode pyramid_compression_mode{ libCZI::CompressionMode::Zstd1 };
+
+        /// The compression parameters used for the pyramid subblocks. If this is null, then default parameters are used.
+        std::shared_ptr<libCZI::ICompressParameters> pyramid_compression_parameters;
+
+        /// The size (in bytes) of the write-combining buffer used by the writer. Contiguous writes (e.g. the segment header, the
+        /// metadata, the data and the attachment of a subblock) are coalesced in this buffer, so that they result in
+        /// a small number of large write-operations on the output-stream. If this is 0, then no buffering is done.
+        std::uint32_t write_combining_buffer_size{ 4 * 1024 * 1024 };
+
+        /// If false, then the write-combining buffer is only used with the stock file-streams (i.e. output-streams created with
+        /// "CreateOutputStreamForFile"). If true, it is used with any output-stream. Note that with the write-combining buffer
+        /// in use, data may not have been written to the output-stream before "ICziWriter::Flush" or "ICziWriter::Close" is called.
+        bool use_write_combining_buffer_for_all_streams{ false };
+
+        /// The order in which the subblocks are laid out in the file. With a spatial order, subblocks which are likely to be read together
+        /// (i.e. neighboring tiles of the same plane) are stored contiguously. Note that in this case all subblocks are held in memory
+        /// (in their compressed form) until the writer is closed, and they are written out only then.
+        CZIWriterSubBlockLayout subblock_layout{ CZIWriterSubBlockLayout::InOrderOfAddition };
+
+        /// If true, then subblocks with identical content are stored only once in the file - the directory-entry of such a subblock
+        /// refers to the segment which has been written for the first subblock with this content. Subblocks are considered identical
+        /// if the hash (MD5) of their (compressed) data, metadata and attachment is equal, and if they have the same pixel type,
+        /// compression, physical size and pyramid type. This is useful e.g. for mosaics with many identical (e.g. empty) background
+        /// tiles. Statistics about the deduplication can be retrieved with "ICziWriter::GetDeduplicationStatistics".
+        /// Note that the segment-header of a shared segment contains the coordinate of the subblock it was written for, so
+        /// readers which are not aware of shared segments will report a discrepancy between subblock-directory and subblock-header.
+        bool deduplicate_subblocks{ false };
+
+        /// The maximum number of subblock-directory-entries which are held in memory by the writer. If this number is reached, the
+        /// entries are written (as a sorted run) to a temporary file, and the runs are merged when the subblock-directory is written
+        /// out. This keeps the memory consumption of the writer bounded for documents with a very large number of subblocks (at
+        /// the cost of some additional file-I/O). The check for duplicate subblocks is still done for all subblocks (where a
+        /// fixed-size filter is used to avoid most of the lookups in the temporary file). If 0, there is no limit and all entries
+        /// are held in memory.
+        std::uint32_t max_subblock_directory_entries_in_memory{ 0 };
     };
 
     /// Creates a new instance of the CZI-writer class.
@@ -117,10 +192,106 @@ namespace libCZI
     /// \returns The newly created CZI-writer.
     LIBCZI_API std::shared_ptr<ICziWriter> CreateCZIWriter(const CZIWriterOptions* options = nullptr);
 
+    /// Options controlling the operation of a CZI-reader-writer object. Those options are set at construction
+    /// time and cannot be mutated afterwards.
+    struct CZIReaderWriterOptions
+    {
+        /// The size (in bytes) of the write-combining buffer used by the reader-writer (c.f. "CZIWriterOptions::write_combining_buffer_size").
+        /// If this is 0, then no buffering is done.
+        std::uint32_t write_combining_buffer_size{ 4 * 1024 * 1024 };
+
+        /// If false, then the write-combining buffer is only used with the stock file-streams (i.e. input-output-streams created with
+        /// "CreateInputOutputStreamForFile"). If true, it is used with any input-output-stream. Note that with the write-combining buffer
+        /// in use, data may not have been written to the stream before "ICziReaderWriter::Commit" or "ICziReaderWriter::Close" is called.
+        bool use_write_combining_buffer_for_all_streams{ false };
+    };
+
     /// Creates a new instance of the CZI-reader-writer class.
     /// \return The newly created CZI-reader-writer.
     LIBCZI_API std::shared_ptr<ICziReaderWriter> CreateCZIReaderWriter();
 
+    /// Creates a new instance of the CZI-reader-writer class.
+    /// \param  options Options for controlling the operation. This argument may be null, in which case default options are used.
+    /// \returns The newly created CZI-reader-writer.
+    LIBCZI_API std::shared_ptr<ICziReaderWriter> CreateCZIReaderWriter(const CZIReaderWriterOptions* options);
+
+    /// Options controlling the operation of "CompactCzi".
+    struct CompactCziOptions
+    {
+        /// The order in which the subblocks are laid out in the destination (c.f. "CZIWriterOptions::subblock_layout"). With
+        /// "InOrderOfAddition", the subblocks are written in the order of the subblock-directory of the source.
+        CZIWriterSubBlockLayout subblock_layout{ CZIWriterSubBlockLayout::InOrderOfAddition };
+
+        /// If true, then subblocks with identical content are stored only once in the destination (c.f. "CZIWriterOptions::deduplicate_subblocks").
+        /// Note that subblock-segments which are shared in the source are only shared in the destination if this option is set,
+        /// otherwise compacting a deduplicated document can result in a larger document. Therefore, this is enabled by default.
+        bool deduplicate_subblocks{ true };
+
+        /// If true, then the file-GUID of the source is used for the destination. Otherwise, the GUID "file_guid" is used.
+        bool keep_file_guid{ true };
+
+        /// The file-GUID for the destination, only used if "keep_file_guid" is false. If this is GUID_NULL, then a new GUID is created.
+        libCZI::GUID file_guid{ 0, 0, 0, { 0, 0, 0, 0, 0, 0, 0, 0 } };
+    };
+
+    /// Information about the result of the "CompactCzi"-operation.
+    struct CompactCziStatistics
+    {
+        int subblock_count{ 0 };                ///< The number of subblocks copied to the destination.
+        int attachment_count{ 0 };              ///< The number of attachments copied to the destination.
+        bool metadata_segment_copied{ false };  ///< True if the source contains a metadata-segment (which was copied to the destination).
+    };
+
+    /// Creates a compacted copy of a CZI-document. All "live" segments of the source (i.e. the subblocks and attachments which
+    /// are referenced by the directories, and the metadata-segment) are written contiguously into the destination, whereas
+    /// unused space (e.g. "DELETED" segments left behind by the CZI-reader-writer, or unused space at the end of
+    /// segments) is not carried over. Optionally, the subblocks are reordered for locality of access. The data is copied
+    /// "as is" (i.e. without re-encoding). The source is not modified - in order to replace a document with its compacted
+    /// version in a crash-safe way, use "CompactCziFile".
+    ///
+    /// \param  source      The stream containing the source CZI-document.
+    /// \param  destination The stream to which the compacted document is written. It is expected to be empty.
+    /// \param  options     (Optional) Options controlling the operation. If null, default options are used.
+    ///
+    /// \returns Information about the operation.
+    LIBCZI_API CompactCziStatistics CompactCzi(std::shared_ptr<IStream> source, std::shared_ptr<IOutputStream> destination, const CompactCziOptions* options = nullptr);
+
+    /// Creates a compacted copy of a CZI-document (c.f. "CompactCzi") in the specified file, where an existing file is replaced
+    /// in a crash-safe way. The compacted document is written into a temporary file (the destination filename with the suffix
+    /// ".partial" appended), which is flushed to disk and then atomically renamed to the destination filename. On POSIX-systems,
+    /// the directory containing the file is flushed afterwards. So, if the operation is interrupted (e.g. by a crash or a
+    /// power loss), the destination file contains either the old or the complete new document. The destination may be the file
+    /// the source stream refers to. In this case, the source stream must not be referenced elsewhere, since it is released
+    /// (and therefore the file is closed) before the file is replaced. If the operation fails, the temporary file is deleted
+    /// and an exception is thrown.
+    ///
+    /// \param  source               The stream containing the source CZI-document.
+    /// \param  destination_filename The filename of the compacted document.
+    /// \param  options              (Optional) Options controlling the operation. If null, default options are used.
+    ///
+    /// \returns Information about the operation.
+    LIBCZI_API CompactCziStatistics CompactCziFile(std::shared_ptr<IStream> source, const wchar_t* destination_filename, const CompactCziOptions* options = nullptr);
+
+    /// Copies all attachments of the document opened with the specified reader to the specified writer. The attachments are
+    /// copied "as is", i.e. the content-GUID, the content-file-type, the name and the data are retained. This is one of the
+    /// steps of "CompactCzi", and it can be used in order to implement similar operations.
+    ///
+    /// \param  reader  The reader (which must be opened).
+    /// \param  writer  The writer (which must be created).
+    ///
+    /// \returns The number of attachments which were copied.
+    LIBCZI_API int CopyAttachments(ICZIReader* reader, ICziWriter* writer);
+
+    /// Copies the metadata-segment of the document opened with the specified reader to the specified writer. The segment is
+    /// copied "as is" (i.e. the XML-metadata and the metadata-attachment). This is one of the steps of "CompactCzi", and it
+    /// can be used in order to implement similar operations.
+    ///
+    /// \param  reader  The reader (which must be opened).
+    /// \param  writer  The writer (which must be created).
+    ///
+    /// \returns True if the source document contains a metadata-segment (which was copied); false otherwise.
+    LIBCZI_API bool CopyMetadataSegment(ICZIReader* reader, ICziWriter* writer);
+
     /// This structure defines how to handle mismatches and discrepancies between sub-block information and the
     /// actual pixel data. Please see the documentation about "Resolution Protocol for Ambiguous or Contradictory Information"
     /// for details. For libCZI until version 0.63.2 the behavior was to throw an exception in case of a discrepancy
@@ -792,8 +963,29 @@ namespace libCZI
             /// This bitfield is used to specify the policy which information is considered authoritative in the construction of a sub-block -
             /// either the information in the sub-block directory or in the sub-block header. Also, it controls how to handle a discrepancy
             /// in this respect - either throw an exception if a discrepancy is encountered or ignore it.
+            /// Note that for a sub-block segment which is referenced by more than one entry in the sub-block directory (which is
+            /// the case for CZIs written with subblock-deduplication, c.f. "CZIWriterOptions::deduplicate_subblocks"), the sub-block
+            /// directory is always authoritative, and only the pixel type, the compression and the physical size are checked for a
+            /// discrepancy.
             SubBlockDirectoryInfoPolicy subBlockDirectoryInfoPolicy{ SubBlockDirectoryInfoPolicy::SubBlockDirectoryPrecedence };
 
+            /// If true, then a sub-block segment which is referenced by more than one entry in the sub-block directory (c.f.
+            /// "CZIWriterOptions::deduplicate_subblocks") is read only once, and its bitmap is decoded only once (when
+            /// "ISubBlock::CreateBitmap" is called without options) - all sub-blocks referencing the segment share the data, and
+            /// "CreateBitmap" returns a copy of the decoded bitmap. Note that in this case the data and the bitmap are held in memory
+            /// until the reader is destroyed, and that the shared segments are determined (by scanning the sub-block directory)
+            /// when opening the document.
+            bool cache_shared_subblock_segments{ false };
+
+            /// If true, then the document is opened in "follow mode", which allows to open a document which is still being written
+            /// (e.g. by an acquisition in progress) and to pick up segments which are appended later on by calling "ICZIReader::Refresh".
+            /// In this mode, the document is not required to contain a subblock-directory (yet) - in this case the subblock-segments
+            /// and attachment-segments are found by scanning the segments of the document. Segments which are only partially written
+            /// are ignored until they are complete. Note that only segments appended at the end of the document are detected, modifications
+            /// of existing segments (as done by the CZI-reader-writer) are not. Also note that the CZI-writer may buffer data before it
+            /// writes it to the stream (c.f. "ICziWriter::Flush").
+            bool follow_appended_segments{ false };
+
             /// Sets the default.
             void SetDefault()
             {
@@ -801,6 +993,8 @@ namespace libCZI
                 this->ignore_sizem_for_pyramid_subblocks = false;
                 this->default_frame_of_reference = libCZI::CZIFrameOfReference::Invalid;
                 this->subBlockDirectoryInfoPolicy = SubBlockDirectoryInfoPolicy::SubBlockDirectoryPrecedence;
+                this->cache_shared_subblock_segments = false;
+                this->follow_appended_segments = false;
             }
         };
 
@@ -837,6 +1031,38 @@ namespace libCZI
         /// \return The accessor (of the requested type).
         virtual std::shared_ptr<IAccessor> CreateAccessor(AccessorType accessorType) = 0;
 
+        /// Picks up the segments which have been appended to the document since it was opened (or since the last call to
+        /// "Refresh"). This is only allowed if the document was opened in "follow mode" (c.f. "OpenOptions::follow_appended_segments"),
+        /// otherwise an exception of type std::logic_error is thrown. New subblocks are appended to the subblock-directory, i.e. the
+        /// indices of the existing subblocks do not change. If the file-header of the document has been updated (e.g. because the
+        /// writer finished), then the metadata-segment and the subblock-directory given there are picked up as well.
+        /// Only data which has actually been written to the stream can be picked up - if the document is written with a
+        /// write-combining buffer (c.f. "CZIWriterOptions::write_combining_buffer_size"), then segments held in the buffer
+        /// are not visible. So, the writer must either be created with "write_combining_buffer_size" set to 0, or it must
+        /// call "ICziWriter::Flush" after adding the segments which are to be picked up.
+        /// \remark
+        /// This method must not be called concurrently with other methods of the reader (and accessors created from it must not be used
+        /// concurrently with a call to it).
+        /// The default implementation throws an exception of type std::logic_error.
+        ///
+        /// \returns The number of subblocks which were added.
+        virtual int Refresh()
+        {
+            throw std::logic_error("Refresh is not implemented");
+        }
+
+        /// Gets a snapshot of the performance counters of this reader. The counters maintained per reader are the stream-related
+        /// counters (PerformanceCounter::StreamReadCalls, PerformanceCounter::StreamReadBytes and the timer PerformanceTimer::StreamRead)
+        /// and PerformanceCounter::SubBlocksRead - all other counters are only maintained globally (c.f. libCZI::GetGlobalPerformanceCounters)
+        /// and are reported as zero here.
+        /// The default implementation throws an exception of type std::logic_error.
+        ///
+        /// \returns The performance counters of this reader.
+        virtual PerformanceCountersSnapshot GetPerformanceCounters()
+        {
+            throw std::logic_error("GetPerformanceCounters is not implemented");
+        }
+
         /// Closes CZI-reader. The underlying stream-object will be released, and further calls to
         /// other methods will fail. The stream is also closed when the object is destroyed, so it
         /// is usually not necessary to explicitly call `Close`. Note that the stream is not closed
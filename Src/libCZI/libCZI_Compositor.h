@@ -176,6 +176,49 @@ namespace libCZI
         ISubBlockCache& operator=(ISubBlockCache&&) noexcept = delete;
     };
 
+    /// This structure describes a gradation (a mapping of the source pixel values to 8-bit values) which an accessor
+    /// applies while it is composing the tiles. This allows to create a display-ready Gray8-bitmap from a Gray8-
+    /// or Gray16-plane in a single pass, without the need to create an intermediate composite in the source pixel type
+    /// (and then applying the gradation in a second pass).\n
+    /// The gradation is either given as black-point/white-point (in which case the gradation curve is a straight line
+    /// between black-point and white-point) or as a look-up table. In case of a look-up table being specified,
+    /// black-point/white-point is not used.\n
+    /// The gradation can only be used if the source pixel type is Gray8 or Gray16 and the destination pixel type is Gray8.
+    /// For other combinations of pixel types, an exception is thrown.
+    struct AccessorGradation
+    {
+        /// True if the gradation is to be applied; if false, then all other members are not used.
+        bool enabled;
+
+        /// The black point - it is a float between 0 and 1, where 0 corresponds to the lowest pixel value
+        /// (of the pixeltype of the source) and 1 to the highest pixel value (of the pixeltype of the source).
+        /// All pixel values below the black point are mapped to 0.
+        float blackPoint;
+
+        /// The white point - it is a float between 0 and 1, where 0 corresponds to the lowest pixel value
+        /// (of the pixeltype of the source) and 1 to the highest pixel value (of the pixeltype of the source).
+        /// All pixel value above the white pointer are mapped to 255.
+        float whitePoint;
+
+        /// Number of elements in the look-up table. If 0, then the look-up table is not used. For a Gray8-source, the
+        /// size of the look-up table must be 256, and for a Gray16-source it must be 65536.
+        int lookUpTableElementCount;
+
+        /// The pointer to the look-up table. If lookUpTableElementCount is <> 0, then this pointer
+        /// must be valid (for the duration of the accessor-call).
+        const std::uint8_t* ptrLookUpTable;
+
+        /// Clears this object to its blank state (i.e. the gradation is disabled).
+        void Clear()
+        {
+            this->enabled = false;
+            this->blackPoint = 0;
+            this->whitePoint = 1;
+            this->lookUpTableElementCount = 0;
+            this->ptrLookUpTable = nullptr;
+        }
+    };
+
     /// The base interface (all accessor interfaces must derive from this).
     class IAccessor
     {
@@ -240,6 +283,10 @@ namespace libCZI
             /// If true, then masks (if present) are taken into account when composing the tile-composite.
             bool maskAware;
 
+            /// The gradation which is to be applied while composing the tiles. If enabled, the pixels of the tiles are
+            /// mapped through the gradation while being written into the destination bitmap (which must then be Gray8).
+            AccessorGradation gradation;
+
             /// Clears this object to its blank state.
             void Clear()
             {
@@ -251,6 +298,7 @@ namespace libCZI
                 this->subBlockCache.reset();
                 this->onlyUseSubBlockCacheForCompressedData = true;
                 this->maskAware = false;
+                this->gradation.Clear();
             }
         };
 
@@ -378,6 +426,12 @@ namespace libCZI
             /// Otherwise, the Z-order is arbitrary.
             bool sortByM;
 
+            /// If true, then the tile-visibility-check-optimization is used. When doing the multi-tile composition,
+            /// all relevant tiles are checked whether they are visible in the destination bitmap. If a tile is not visible, then
+            /// the corresponding sub-block is not read. This can speed up the operation considerably. The result is the same as
+            /// without this optimization - i.e. there should be no reason to turn it off besides potential bugs.
+            bool useVisibilityCheckOptimization;
+
             /// If true, then a one-pixel wide boundary will be drawn around 
             /// each tile (in black color).
             bool drawTileBorder;
@@ -396,11 +450,17 @@ namespace libCZI
             /// If true, then masks (if present) are taken into account when composing the tile-composite.
             bool maskAware;
 
+            /// The gradation which is to be applied while composing the tiles. If enabled, the pixels of the tiles are
+            /// mapped through the gradation while being written into the destination bitmap (which must then be Gray8).
+            AccessorGradation gradation;
+
             /// Clears this object to its blank state.
             void Clear()
             {
+                this->gradation.Clear();
                 this->drawTileBorder = false;
                 this->sortByM = true;
+                this->useVisibilityCheckOptimization = false;
                 this->backGroundColor.r = this->backGroundColor.g = this->backGroundColor.b = std::numeric_limits<float>::quiet_NaN();
                 this->sceneFilter.reset();
                 this->subBlockCache.reset();
@@ -487,6 +547,38 @@ namespace libCZI
         }
     };
 
+    /// Statistics about a single request to an accessor. If a pointer to an instance of this structure is given with the
+    /// accessor options, then the accessor fills it in (the structure is cleared at the start of the request). The durations
+    /// are given in nanoseconds and are the sum over all sub-blocks processed.
+    struct AccessorStatistics
+    {
+        std::uint32_t subBlocksEnumerated;      ///< The number of sub-blocks found on the plane and intersecting with the ROI (before any further filtering).
+        std::uint32_t subBlocksCulled;          ///< The number of sub-blocks which were skipped because the visibility check found them to be overdrawn.
+        std::uint32_t subBlocksReadFromStream;  ///< The number of sub-blocks which were read from the stream (and decoded).
+        std::uint32_t subBlocksFromCache;       ///< The number of sub-blocks which were served from the sub-block cache.
+        std::uint64_t compressedBytesRead;      ///< The number of bytes of (possibly compressed) pixel data of the sub-blocks read from the stream.
+        std::uint64_t enumerateNanoseconds;     ///< The time spent for determining the sub-blocks to be drawn.
+        std::uint64_t readNanoseconds;          ///< The time spent for reading sub-blocks from the stream.
+        std::uint64_t decodeNanoseconds;        ///< The time spent for decoding sub-blocks.
+        std::uint64_t scaleNanoseconds;         ///< The time spent for scaling (or copying) sub-blocks into the destination bitmap.
+        std::uint64_t totalNanoseconds;         ///< The total time spent for the request.
+
+        /// Clears this object (i.e. all values are set to zero).
+        void Clear()
+        {
+            this->subBlocksEnumerated = 0;
+            this->subBlocksCulled = 0;
+            this->subBlocksReadFromStream = 0;
+            this->subBlocksFromCache = 0;
+            this->compressedBytesRead = 0;
+            this->enumerateNanoseconds = 0;
+            this->readNanoseconds = 0;
+            this->decodeNanoseconds = 0;
+            this->scaleNanoseconds = 0;
+            this->totalNanoseconds = 0;
+        }
+    };
+
     /// Interface for single channel scaling tile accessors.
     /// This accessor creates a multi-tile composite of a single channel (and a single plane) with a given zoom-factor.
     /// It will use pyramid sub-blocks (if present) in order to create the destination bitmap. In this operation, it will use
@@ -533,9 +625,19 @@ namespace libCZI
             /// If true, then masks (if present) are taken into account when composing the tile-composite.
             bool maskAware;
 
+            /// The gradation which is to be applied while composing the tiles. If enabled, the pixels of the tiles are
+            /// mapped through the gradation while being written into the destination bitmap (which must then be Gray8).
+            AccessorGradation gradation;
+
+            /// If non-null, then statistics about the request are put here. Note that the same options-object must not be used
+            /// for concurrent requests if this is given.
+            AccessorStatistics* statistics;
+
             /// Clears this object to its blank state.
             void Clear()
             {
+                this->statistics = nullptr;
+                this->gradation.Clear();
                 this->drawTileBorder = false;
                 this->sortByM = true;
                 this->backGroundColor.r = this->backGroundColor.g = this->backGroundColor.b = std::numeric_limits<float>::quiet_NaN();
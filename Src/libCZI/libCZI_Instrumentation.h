@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "ImportExport.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+namespace libCZI
+{
+    class IOutputStream;
+
+    /// The counters maintained by libCZI's instrumentation layer.
+    enum class PerformanceCounter : std::uint8_t
+    {
+        StreamReadCalls = 0,            ///< The number of calls to IStream::Read (issued by a CZI-reader).
+        StreamReadBytes,                ///< The number of bytes read from the stream (issued by a CZI-reader).
+        SubBlocksRead,                  ///< The number of sub-blocks read.
+        SubBlockCacheHits,              ///< The number of lookups in a sub-block cache which found the requested sub-block.
+        SubBlockCacheMisses,            ///< The number of lookups in a sub-block cache which did not find the requested sub-block.
+        TilesCulledByVisibilityCheck,   ///< The number of sub-blocks which were not drawn because the visibility check found them to be completely overdrawn.
+
+        Count                           ///< The number of counters (this is not a valid counter).
+    };
+
+    /// The timed operations maintained by libCZI's instrumentation layer. For each of them, a histogram of the
+    /// durations is recorded.
+    enum class PerformanceTimer : std::uint8_t
+    {
+        StreamRead = 0,             ///< A call to IStream::Read (issued by a CZI-reader).
+        DecodeJpgXr,                ///< Decoding a sub-block with the decoder of type ImageDecoderType::JPXR_JxrLib.
+        DecodeZStd0,                ///< Decoding a sub-block with the decoder of type ImageDecoderType::ZStd0.
+        DecodeZStd1,                ///< Decoding a sub-block with the decoder of type ImageDecoderType::ZStd1.
+        NNResize,                   ///< The nearest-neighbor scaling of a sub-block into the destination bitmap (done by the scaling-tile-accessor).
+        SingleChannelAccessorGet,   ///< A call to "Get" of a single-channel accessor (including reading, decoding and composing the sub-blocks).
+        MultiChannelComposition,    ///< The composition of a multi-channel image (with the functions in libCZI::Compositors).
+
+        Count                       ///< The number of timers (this is not a valid timer).
+    };
+
+    /// A histogram of durations. The buckets are logarithmically spaced: bucket 0 counts durations less than 1 microsecond, bucket i (for
+    /// 0 < i < kBucketCount - 1) counts durations in the range [2^(i-1), 2^i) microseconds, and the last bucket counts all longer durations.
+    struct DurationHistogram
+    {
+        static constexpr int kBucketCount = 24; ///< The number of buckets.
+
+        std::uint64_t count;                    ///< The number of durations recorded.
+        std::uint64_t total_nanoseconds;        ///< The sum of all durations recorded, in nanoseconds.
+        std::uint64_t buckets[kBucketCount];    ///< The buckets of the histogram.
+    };
+
+    /// A snapshot of the performance counters. Note that the values are read one after the other while other threads may
+    /// be updating them, so the snapshot is not guaranteed to be consistent across counters.
+    struct PerformanceCountersSnapshot
+    {
+        std::uint64_t counters[static_cast<size_t>(PerformanceCounter::Count)];         ///< The values of the counters, indexed by PerformanceCounter.
+        DurationHistogram timers[static_cast<size_t>(PerformanceTimer::Count)];         ///< The duration histograms, indexed by PerformanceTimer.
+
+        /// Gets the value of the specified counter.
+        ///
+        /// \param  counter The counter.
+        ///
+        /// \returns The value of the counter.
+        std::uint64_t GetCounter(PerformanceCounter counter) const
+        {
+            return this->counters[static_cast<size_t>(counter)];
+        }
+
+        /// Gets the duration histogram of the specified timer.
+        ///
+        /// \param  timer   The timer.
+        ///
+        /// \returns The histogram.
+        const DurationHistogram& GetTimer(PerformanceTimer timer) const
+        {
+            return this->timers[static_cast<size_t>(timer)];
+        }
+    };
+
+    /// Gets a human-readable name for the specified counter.
+    ///
+    /// \param  counter The counter.
+    ///
+    /// \returns A static string with the name of the counter.
+    LIBCZI_API const char* GetPerformanceCounterName(PerformanceCounter counter);
+
+    /// Gets a human-readable name for the specified timer.
+    ///
+    /// \param  timer   The timer.
+    ///
+    /// \returns A static string with the name of the timer.
+    LIBCZI_API const char* GetPerformanceTimerName(PerformanceTimer timer);
+
+    /// Gets a snapshot of the global (i.e. process-wide) performance counters. The global counters are the aggregate
+    /// over all objects of libCZI.
+    ///
+    /// \returns The snapshot of the global performance counters.
+    LIBCZI_API PerformanceCountersSnapshot GetGlobalPerformanceCounters();
+
+    /// Resets the global performance counters to zero.
+    LIBCZI_API void ResetGlobalPerformanceCounters();
+
+    /// Interface for a receiver of trace-events. libCZI reports a "span" (an operation with a start time and a duration)
+    /// for each timed operation (c.f. PerformanceTimer) to the sink. Note that the methods of this interface are called
+    /// concurrently from arbitrary threads.
+    class LIBCZI_API ITraceEventSink
+    {
+    public:
+        /// Reports a span which has completed.
+        ///
+        /// \param  name                    The name of the operation (a static string).
+        /// \param  category                The category of the operation (a static string).
+        /// \param  timestamp_microseconds  The start of the span, in microseconds (relative to an arbitrary, but fixed, point in time).
+        /// \param  duration_microseconds   The duration of the span, in microseconds.
+        /// \param  thread_id               An identification of the thread which executed the operation.
+        virtual void AddCompleteEvent(const char* name, const char* category, std::uint64_t timestamp_microseconds, std::uint64_t duration_microseconds, std::uint64_t thread_id) = 0;
+
+        virtual ~ITraceEventSink() = default;
+
+        // non-copyable and non-moveable
+        ITraceEventSink() = default;
+        ITraceEventSink(const ITraceEventSink&) = delete;             // copy constructor
+        ITraceEventSink& operator=(const ITraceEventSink&) = delete;  // copy assignment
+        ITraceEventSink(ITraceEventSink&&) = delete;                  // move constructor
+        ITraceEventSink& operator=(ITraceEventSink&&) = delete;       // move assignment
+    };
+
+    /// Sets the (process-wide) trace-event sink. If null is passed in, tracing is disabled (which is the default).
+    ///
+    /// \param  sink    The sink (or null in order to disable tracing).
+    LIBCZI_API void SetTraceEventSink(const std::shared_ptr<ITraceEventSink>& sink);
+
+    /// Creates a trace-event sink which writes the events in the "Chrome Trace Event Format" (the JSON array format) to
+    /// the specified stream. The resulting file can be loaded into "chrome://tracing" or "https://ui.perfetto.dev". The
+    /// array is terminated when the sink object is destroyed (but a file which is not terminated can be loaded as well).
+    ///
+    /// \param  stream  The stream to write the trace-events to.
+    ///
+    /// \returns The newly created trace-event sink.
+    LIBCZI_API std::shared_ptr<ITraceEventSink> CreateChromeTraceEventSink(const std::shared_ptr<libCZI::IOutputStream>& stream);
+}
@@ -11,6 +11,7 @@
 #include "StreamImpl.h"
 #include "CziWriter.h"
 #include "CziReaderWriter.h"
+#include "CziCompaction.h"
 #include "CziMetadataBuilder.h"
 #include "SubblockMetadata.h"
 #include "inc_libCZI_Config.h"
@@ -71,6 +72,56 @@ std::shared_ptr<ICziReaderWriter> libCZI::CreateCZIReaderWriter()
     return std::make_shared<CCziReaderWriter>();
 }
 
+std::shared_ptr<ICziReaderWriter> libCZI::CreateCZIReaderWriter(const CZIReaderWriterOptions* options)
+{
+    if (options == nullptr)
+    {
+        return std::make_shared<CCziReaderWriter>();
+    }
+
+    return std::make_shared<CCziReaderWriter>(*options);
+}
+
+libCZI::CompactCziStatistics libCZI::CompactCzi(std::shared_ptr<IStream> source, std::shared_ptr<IOutputStream> destination, const CompactCziOptions* options)
+{
+    return CCziCompaction::Compact(source, destination, options != nullptr ? *options : CompactCziOptions());
+}
+
+int libCZI::CopyAttachments(ICZIReader* reader, ICziWriter* writer)
+{
+    if (reader == nullptr)
+    {
+        throw std::invalid_argument("reader");
+    }
+
+    if (writer == nullptr)
+    {
+        throw std::invalid_argument("writer");
+    }
+
+    return CCziCompaction::CopyAttachments(reader, writer);
+}
+
+bool libCZI::CopyMetadataSegment(ICZIReader* reader, ICziWriter* writer)
+{
+    if (reader == nullptr)
+    {
+        throw std::invalid_argument("reader");
+    }
+
+    if (writer == nullptr)
+    {
+        throw std::invalid_argument("writer");
+    }
+
+    return CCziCompaction::CopyMetadata(reader, writer);
+}
+
+libCZI::CompactCziStatistics libCZI::CompactCziFile(std::shared_ptr<IStream> source, const wchar_t* destination_filename, const CompactCziOptions* options)
+{
+    return CCziCompaction::CompactFile(std::move(source), destination_filename, options != nullptr ? *options : CompactCziOptions());
+}
+
 std::shared_ptr<libCZI::ICziMetadata> libCZI::CreateMetaFromMetadataSegment(IMetadataSegment* metadataSegment)
 {
     return std::make_shared<CCziMetadata>(metadataSegment);
@@ -99,6 +99,18 @@ namespace libCZI
         /// \return The file header information.
         virtual FileHeaderInfo GetFileHeaderInfo() = 0;
 
+        /// Writes out the directory-segments and the file-header, so that the file is a valid CZI reflecting all modifications made
+        /// so far - the object remains operational, i.e. further modifications can be made after this call. This allows to batch
+        /// many modifications (e.g. ReplaceSubBlock or SyncAddSubBlock) and to commit them at chosen points. If subblocks were only
+        /// modified or added, the subblock-directory-segment is updated in place where possible (i.e. only the changed entries are
+        /// written), otherwise it is rewritten. When a new subblock-directory-segment is written, some space is reserved in it for
+        /// subblocks added later on.
+        /// The default implementation throws an exception of type std::logic_error.
+        virtual void Commit()
+        {
+            throw std::logic_error("Commit is not implemented");
+        }
+
         /// Finalizes the CZI (ie. writes out the final directory-segments) and closes the file.
         /// Note that this method must be called explicitely in order to get a valid CZI - calling the destructor alone will
         /// close the file immediately without finalization.
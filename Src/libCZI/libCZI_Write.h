@@ -341,6 +341,33 @@ namespace libCZI
         void Clear() override;
     };
 
+    /// This struct defines the data to be added to the subblock segment with the method "ICziWriter::AsyncAddSubBlock".
+    /// Contrary to the other variants, the bitmap is given uncompressed, and the writer performs the compression (as specified
+    /// by the compression mode and the compression parameters). The fields "PixelType", "physicalWidth" and "physicalHeight"
+    /// are ignored, they are taken from the bitmap. Supported compression modes are "UnCompressed", "Zstd0", "Zstd1" and "JpgXr".
+    struct LIBCZI_API AddSubBlockInfoUncompressedBitmap : public AddSubBlockInfoBase
+    {
+        /// Default constructor
+        AddSubBlockInfoUncompressedBitmap() :ptrSbBlkMetadata(nullptr), sbBlkMetadataSize(0), ptrSbBlkAttachment(nullptr), sbBlkAttachmentSize(0)
+        {}
+
+        /// The bitmap to be put into the subblock. The bitmap must not be modified until the subblock has been written (i.e. until
+        /// "ICziWriter::Flush" returned).
+        std::shared_ptr<libCZI::IBitmapData> bitmap;
+
+        /// The parameters controlling the compression. This may be null, in which case default parameters are used.
+        std::shared_ptr<libCZI::ICompressParameters> compressionParameters;
+
+        const void* ptrSbBlkMetadata;       ///< Pointer to the subblock-metadata. The data is copied, so it need not be valid after "AsyncAddSubBlock" returned.
+        std::uint32_t sbBlkMetadataSize;    ///< The size of the subblock-metadata in bytes. If this is 0, then ptrSbBlkMetadata is not used (and no sub-block-metadata written).
+
+        const void* ptrSbBlkAttachment;     ///< Pointer to the subblock-attachment. The data is copied, so it need not be valid after "AsyncAddSubBlock" returned.
+        std::uint32_t sbBlkAttachmentSize;  ///< The size of the subblock-attachment in bytes. If this is 0, then ptrSbBlkAttachment is not used (and no sub-block-attachment written).
+
+        /// Clears this object to its blank/initial state.
+        void Clear() override;
+    };
+
     /// This struct describes an attachment to be added to a CZI-file.
     struct LIBCZI_API AddAttachmentInfo
     {
@@ -409,8 +436,16 @@ namespace libCZI
         std::function<std::tuple<std::string, std::tuple<bool, std::string>>(int)> funcGenerateIdAndNameForChannel;
     };
 
+    /// Statistics about the deduplication of subblocks (c.f. "CZIWriterOptions::deduplicate_subblocks").
+    struct SubBlockDeduplicationStatistics
+    {
+        std::uint64_t subBlocksWritten{ 0 };        ///< The number of subblock-segments which have been written.
+        std::uint64_t subBlocksDeduplicated{ 0 };   ///< The number of subblocks which refer to a segment written for an identical subblock.
+        std::uint64_t bytesSaved{ 0 };              ///< The number of bytes saved, i.e. the sum of the sizes of the segments which did not need to be written.
+    };
+
     /// This interface is used in order to write a CZI-file. The sequence of operations is: the object is initialized
-    /// by calling the Create-method. Then use SyncAddSubBlock, SyncAddAttachment and SyncWriteMetadata to put data
+    /// by calling the Create-method. Then use SyncAddSubBlock (or AsyncAddSubBlock), SyncAddAttachment and SyncWriteMetadata to put data
     /// into the document. Finally, call Close which will finalized the document.
     /// Note that this object is not thread-safe. Calls into any of the functions must be synchronized, i. e. at no
     /// point in time we may execute different methods (or the same method for that matter) concurrently. The class by
@@ -451,15 +486,58 @@ namespace libCZI
         /// \return The "pre-filled" metadata object if successful.
         virtual std::shared_ptr<libCZI::ICziMetadataBuilder> GetPreparedMetadata(const PrepareMetadataInfo& info) = 0;
 
+        /// Adds the specified (uncompressed) bitmap as a subblock to the CZI-file, where the compression is done by the writer. 
+        /// The compression is executed on a pool of worker threads (c.f. "CZIWriterOptions::number_of_compression_threads"), and
+        /// this method returns before the subblock has been written. The subblocks are written in the order in which they have been
+        /// submitted (so the resulting file is identical to the one created by compressing the bitmaps and adding them with "SyncAddSubBlock").
+        /// The amount of memory held by pending subblocks is bounded (c.f. "CZIWriterOptions::max_memory_for_pending_subblocks"), if
+        /// this limit is reached, this method blocks until enough pending subblocks have been written.
+        /// The arguments and the coordinate (with respect to the bounds) are checked immediately. However, errors which occur
+        /// during compression or writing (including the check for duplicate subblocks) are reported (in the form of an exception) 
+        /// with the call which writes out the subblock - which may be a later call to this method, or a call to "Flush" (or
+        /// any of the other methods of this interface, which all flush pending subblocks before operating). In this case the
+        /// exception may concern a subblock added earlier, and the writer should be considered to be in an undefined state.
+        /// Only the compression overlaps with the caller - all writes to the output-stream happen on the thread calling into
+        /// the writer, so the output-stream need not be thread-safe.
+        /// This method must not be called concurrently with other method-invocations of this object.
+        /// The default implementation throws an exception of type std::logic_error (for implementations of this interface
+        /// which do not support it).
+        /// \param addSbBlkInfo Information describing the subblock to be added.
+        virtual void AsyncAddSubBlock(const AddSubBlockInfoUncompressedBitmap& addSbBlkInfo)
+        {
+            (void)addSbBlkInfo;
+            throw std::logic_error("AsyncAddSubBlock is not implemented");
+        }
+
+        /// Waits until all subblocks added with "AsyncAddSubBlock" have been written out, and writes the content of the
+        /// write-combining buffer (c.f. "CZIWriterOptions::write_combining_buffer_size") to the output-stream. In case of
+        /// an error (which may concern any subblock pending), an exception is thrown.
+        /// The default implementation does nothing (as there is nothing pending if "AsyncAddSubBlock" is not supported).
+        virtual void Flush() {}
+
         /// Finalizes the CZI (i.e. writes out the final directory-segments) and closes the file.
+        /// Pending subblocks (added with "AsyncAddSubBlock") are written before.
         /// Note that this method must be called explicitly in order to get a valid CZI - calling the destructor alone will
         /// close the file immediately without finalization.
         virtual void Close() = 0;
 
         /// Gets the statistics about the sub-blocks. This statistics is aggregated from the subblocks as they are added.
+        /// Note that subblocks added with "AsyncAddSubBlock" are only included after they have been written (e.g. after
+        /// calling "Flush").
         /// \return The sub-block statistics.
         virtual libCZI::SubBlockStatistics GetStatistics() const = 0;
 
+        /// Gets the statistics about the deduplication of subblocks (c.f. "CZIWriterOptions::deduplicate_subblocks"). If deduplication
+        /// is not enabled, all counts are zero. The statistics are final once "Close" has been called, and they remain available
+        /// after "Close". With a spatial subblock layout (c.f. "CZIWriterOptions::subblock_layout"), the subblocks are only written
+        /// (and deduplicated) with "Close".
+        /// The default implementation throws an exception of type std::logic_error.
+        /// \return The deduplication statistics.
+        virtual libCZI::SubBlockDeduplicationStatistics GetDeduplicationStatistics() const
+        {
+            throw std::logic_error("GetDeduplicationStatistics is not implemented");
+        }
+
         virtual ~ICziWriter() = default;
 
         /// This helper method uses the structure 'AddSubBlockInfoMemPtr' in order to describe the subblock to be added. What it does is
@@ -519,6 +597,17 @@ namespace libCZI
         this->sbBlkAttachmentSize = 0;
     }
 
+    inline void AddSubBlockInfoUncompressedBitmap::Clear()
+    {
+        this->AddSubBlockInfoBase::Clear();
+        this->bitmap.reset();
+        this->compressionParameters.reset();
+        this->ptrSbBlkMetadata = nullptr;
+        this->sbBlkMetadataSize = 0;
+        this->ptrSbBlkAttachment = nullptr;
+        this->sbBlkAttachmentSize = 0;
+    }
+
     inline void AddSubBlockInfo::Clear()
     {
         this->AddSubBlockInfoBase::Clear();
@@ -4,6 +4,7 @@
 
 #include "utilities.h"
 #include "inc_libCZI_Config.h"
+#include "cpu_dispatch.h"
 #include <locale>
 #include <codecvt>
 #include <sstream>
@@ -576,19 +577,17 @@ tString trimImpl(const tString& str, const tString& whitespace)
     }
 }
 
-#if !LIBCZI_HAS_NEOININTRINSICS && !LIBCZI_HAS_AVXINTRINSICS
 /*static*/void LoHiBytePackUnpack::LoHiByteUnpackStrided(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst)
 {
     LoHiBytePackUnpack::CheckLoHiByteUnpackArgumentsAndThrow(wordCount, stride, ptrSrc, ptrDst);
-    LoHiByteUnpackStrided_C(ptrSrc, wordCount, stride, lineCount, ptrDst);
+    (*CpuDispatch::GetKernels().loHiByteUnpackStrided)(ptrSrc, wordCount, stride, lineCount, ptrDst);
 }
 
 /*static*/void LoHiBytePackUnpack::LoHiBytePackStrided(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest)
 {
     LoHiBytePackUnpack::CheckLoHiBytePackArgumentsAndThrow(ptrSrc, sizeSrc, width, height, stride, dest);
-    LoHiBytePackStrided_C(ptrSrc, sizeSrc, width, height, stride, dest);
+    (*CpuDispatch::GetKernels().loHiBytePackStrided)(ptrSrc, sizeSrc, width, height, stride, dest);
 }
-#endif
 
 void RectangleCoverageCalculator::AddRectangle(const libCZI::IntRect& rectangle)
 {
@@ -742,3 +741,163 @@ bool RectangleCoverageCalculator::IsCompletelyCovered(const libCZI::IntRect& que
 
     return this->CalcAreaOfIntersectionWithRectangle(query_rectangle) == static_cast<int64_t>(query_rectangle.w) * query_rectangle.h;
 }
+
+RoiCoverageTracker::RoiCoverageTracker(const libCZI::IntRect& roi) :
+    roi_(roi), covered_area_(0)
+{
+    if (roi.IsValid() && roi.IsNonEmpty())
+    {
+        this->bands_.insert(make_pair(roi.y, Band{ {}, 0 }));
+    }
+}
+
+std::int64_t RoiCoverageTracker::AddRectangle(const libCZI::IntRect& rectangle)
+{
+    if (this->bands_.empty() || !rectangle.IsValid())
+    {
+        return 0;
+    }
+
+    const libCZI::IntRect clipped = this->roi_.Intersect(rectangle);
+    if (!clipped.IsValid() || !clipped.IsNonEmpty())
+    {
+        return 0;
+    }
+
+    const int y_end = clipped.y + clipped.h;
+    const int roi_y_end = this->roi_.y + this->roi_.h;
+    this->SplitBandAt(clipped.y);
+    this->SplitBandAt(y_end);
+
+    std::int64_t newly_covered_area = 0;
+    for (auto band = this->bands_.find(clipped.y); band != this->bands_.end() && band->first < y_end; ++band)
+    {
+        if (band->second.coveredLength == this->roi_.w)
+        {
+            // this band is already completely covered, nothing to do
+            continue;
+        }
+
+        const auto next_band = std::next(band);
+        const int band_height = (next_band != this->bands_.end() ? next_band->first : roi_y_end) - band->first;
+        const int newly_covered_length = RoiCoverageTracker::AddIntervalToBand(band->second, clipped.x, clipped.x + clipped.w);
+        newly_covered_area += static_cast<std::int64_t>(newly_covered_length) * band_height;
+    }
+
+    this->MergeCompletelyCoveredBands(clipped.y, y_end);
+    this->covered_area_ += newly_covered_area;
+    return newly_covered_area;
+}
+
+bool RoiCoverageTracker::IsCompletelyCovered() const
+{
+    return this->bands_.empty() || this->covered_area_ == static_cast<std::int64_t>(this->roi_.w) * this->roi_.h;
+}
+
+void RoiCoverageTracker::EnumerateUncoveredRectangles(const std::function<void(const libCZI::IntRect&)>& func) const
+{
+    const int roi_x_end = this->roi_.x + this->roi_.w;
+    const int roi_y_end = this->roi_.y + this->roi_.h;
+    for (auto band = this->bands_.cbegin(); band != this->bands_.cend(); ++band)
+    {
+        if (band->second.coveredLength == this->roi_.w)
+        {
+            continue;
+        }
+
+        const auto next_band = std::next(band);
+        const int band_height = (next_band != this->bands_.cend() ? next_band->first : roi_y_end) - band->first;
+
+        // report the gaps between the covered intervals
+        int x = this->roi_.x;
+        for (const auto& interval : band->second.intervals)
+        {
+            if (interval.first > x)
+            {
+                func(libCZI::IntRect{ x, band->first, interval.first - x, band_height });
+            }
+
+            x = interval.second;
+        }
+
+        if (x < roi_x_end)
+        {
+            func(libCZI::IntRect{ x, band->first, roi_x_end - x, band_height });
+        }
+    }
+}
+
+void RoiCoverageTracker::SplitBandAt(int y)
+{
+    // precondition: y is within the ROI (or equal to the bottom edge of the ROI, in which case there is nothing to do)
+    if (y >= this->roi_.y + this->roi_.h)
+    {
+        return;
+    }
+
+    auto band = this->bands_.upper_bound(y);
+    --band;     // this is safe because the first band always starts at the top of the ROI
+    if (band->first != y)
+    {
+        this->bands_.insert(band, make_pair(y, band->second));
+    }
+}
+
+void RoiCoverageTracker::MergeCompletelyCoveredBands(int y_start, int y_end)
+{
+    // we look at the range from the band before the one starting at y_start up to (and including) the band starting at y_end
+    auto band = this->bands_.find(y_start);
+    if (band != this->bands_.begin())
+    {
+        --band;
+    }
+
+    const auto end = this->bands_.upper_bound(y_end);
+    while (band != end)
+    {
+        auto next_band = std::next(band);
+        if (next_band == end)
+        {
+            break;
+        }
+
+        if (band->second.coveredLength == this->roi_.w && next_band->second.coveredLength == this->roi_.w)
+        {
+            this->bands_.erase(next_band);
+        }
+        else
+        {
+            band = next_band;
+        }
+    }
+}
+
+/*static*/int RoiCoverageTracker::AddIntervalToBand(Band& band, int x_start, int x_end)
+{
+    // find the first interval which overlaps with or is adjacent to [x_start, x_end)
+    auto interval = band.intervals.upper_bound(x_start);
+    if (interval != band.intervals.begin())
+    {
+        const auto previous_interval = std::prev(interval);
+        if (previous_interval->second >= x_start)
+        {
+            interval = previous_interval;
+        }
+    }
+
+    int merged_start = x_start;
+    int merged_end = x_end;
+    int already_covered_length = 0;
+    while (interval != band.intervals.end() && interval->first <= x_end)
+    {
+        already_covered_length += (std::max)(0, (std::min)(interval->second, x_end) - (std::max)(interval->first, x_start));
+        merged_start = (std::min)(merged_start, interval->first);
+        merged_end = (std::max)(merged_end, interval->second);
+        interval = band.intervals.erase(interval);
+    }
+
+    band.intervals.insert(interval, make_pair(merged_start, merged_end));
+    const int newly_covered_length = x_end - x_start - already_covered_length;
+    band.coveredLength += newly_covered_length;
+    return newly_covered_length;
+}
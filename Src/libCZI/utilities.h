@@ -162,9 +162,11 @@ namespace libCZI
         public:
             static void LoHiByteUnpackStrided(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst);
             static void LoHiBytePackStrided(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest);
-        protected:
+
+            // the plain C++-implementations (which are used by the kernel-dispatcher if no specialized implementation is available)
             static void LoHiByteUnpackStrided_C(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst);
             static void LoHiBytePackStrided_C(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest);
+        protected:
             static void CheckLoHiBytePackArgumentsAndThrow(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest);
             static void CheckLoHiByteUnpackArgumentsAndThrow(std::uint32_t width, std::uint32_t stride, const void* source, void* dest);
         };
@@ -304,5 +306,68 @@ namespace libCZI
             static int SplitUpIntoNonOverlapping(const libCZI::IntRect& rectangle_a, const libCZI::IntRect& rectangle_b, std::array<libCZI::IntRect, 4>& result);
         };
 
+        /// This class keeps track of the area of a fixed region-of-interest which is covered by a set of rectangles, where
+        /// the rectangles are added one after the other and the covered area is updated incrementally. In contrast to
+        /// RectangleCoverageCalculator, there is no need to recalculate the covered area after each addition, and the cost of
+        /// adding a rectangle does not depend on the number of rectangles added before, but only on the number of distinct
+        /// "horizontal bands" it spans.
+        /// The state is a partitioning of the ROI into horizontal bands (delimited by the top and bottom edges of the rectangles
+        /// added so far), and for each band, a sorted list of non-overlapping covered x-intervals. Adjacent bands which
+        /// are completely covered are merged, so that the structure does not grow when the ROI is filled up (which is
+        /// the typical case for a mosaic).
+        class RoiCoverageTracker
+        {
+        private:
+            struct Band
+            {
+                /// The covered intervals - key is the start x-coordinate (inclusive), value the end x-coordinate (exclusive).
+                /// The intervals are disjoint and not adjacent.
+                std::map<int, int> intervals;
+
+                /// The total length of the covered intervals.
+                int coveredLength;
+            };
+
+            libCZI::IntRect roi_;
+
+            /// The bands - key is the start y-coordinate (inclusive), the band extends to the start of the next band (or
+            /// to the bottom of the ROI for the last one).
+            std::map<int, Band> bands_;
+
+            std::int64_t covered_area_;
+        public:
+            /// Constructor.
+            ///
+            /// \param  roi The region-of-interest. If it is not valid or empty, then it is considered completely covered.
+            explicit RoiCoverageTracker(const libCZI::IntRect& roi);
+
+            /// Adds a rectangle and returns the area (within the ROI) which was not covered before and is covered now.
+            ///
+            /// \param  rectangle   The rectangle to be added.
+            ///
+            /// \returns    The number of pixels (within the ROI) which are newly covered by this rectangle.
+            std::int64_t AddRectangle(const libCZI::IntRect& rectangle);
+
+            /// Gets the area of the ROI which is covered by the rectangles added so far.
+            ///
+            /// \returns    The covered area.
+            std::int64_t GetCoveredArea() const { return this->covered_area_; }
+
+            /// Query if the ROI is completely covered by the rectangles added so far.
+            ///
+            /// \returns    True if the ROI is completely covered; false otherwise.
+            bool IsCompletelyCovered() const;
+
+            /// Enumerate rectangles which (together) give the part of the ROI which is not covered by the rectangles added so far.
+            /// The rectangles reported are non-overlapping.
+            ///
+            /// \param  func    The functor which is called for each uncovered rectangle.
+            void EnumerateUncoveredRectangles(const std::function<void(const libCZI::IntRect&)>& func) const;
+        private:
+            void SplitBandAt(int y);
+            void MergeCompletelyCoveredBands(int y_start, int y_end);
+            static int AddIntervalToBand(Band& band, int x_start, int x_end);
+        };
+
     }   // namespace detail
 }   // namespace libCZI
@@ -5,136 +5,23 @@
 #include <stdexcept>
 #include <cstdint>
 #include "inc_libCZI_Config.h"
-#include "utilities.h"
+#include "cpu_dispatch.h"
 
 using namespace std;
 using namespace libCZI::detail;
 
+// This module contains the SIMD-implementations of the kernels which are selected at runtime by "CpuDispatch" (c.f. cpu_dispatch.h).
+
 #if LIBCZI_HAS_AVXINTRINSICS
 
 // Note: On x86/x64 (and GCC/Clang) this module is compiled with the switch "-mavx2", which means that AVX may be used
 //        for code-generation (aside from intrinsics). We employ the model of "runtime detection of AVX-capabilities" here,
 //        so there must not be any AVX-code in any execution path. So, we must be careful that no code in this part is executed
-//        without a prior runtime detection of AVX-capabilities.
-
-#if defined(_MSC_VER)
-# include <intrin.h>
-#endif
+//        without a prior runtime detection of AVX-capabilities (which is done in cpu_dispatch.cpp).
 
 #include <immintrin.h>
 
-// from https://software.intel.com/content/www/us/en/develop/articles/how-to-detect-new-instruction-support-in-the-4th-generation-intel-core-processor-family.html
-static void run_cpuid(uint32_t eax, uint32_t ecx, uint32_t* abcd)
-{
-#if defined(_MSC_VER)
-    __cpuidex(reinterpret_cast<int*>(abcd), eax, ecx);
-#else
-    uint32_t ebx, edx;
-# if defined( __i386__ ) && defined ( __PIC__ )
-    /* in case of PIC under 32-bit EBX cannot be clobbered */
-    __asm__("movl %%ebx, %%edi \n\t cpuid \n\t xchgl %%ebx, %%edi" : "=D" (ebx),
-# else
-    __asm__("cpuid" : "+b" (ebx),
-# endif
-        "+a" (eax), "+c" (ecx), "=d" (edx));
-    abcd[0] = eax; abcd[1] = ebx; abcd[2] = ecx; abcd[3] = edx;
-#endif
-}
-
-static int check_xcr0_ymm()
-{
-    uint32_t xcr0;
-#if defined(_MSC_VER)
-    xcr0 = static_cast<uint32_t>(_xgetbv(0));  /* min VS2010 SP1 compiler is required */
-#else
-    __asm__("xgetbv" : "=a" (xcr0) : "c" (0) : "%edx");
-#endif
-    return ((xcr0 & 6) == 6); /* checking if xmm and ymm state are enabled in XCR0 */
-}
-
-
-static int check_4th_gen_intel_core_features()
-{
-    uint32_t abcd[4];
-    constexpr uint32_t fma_movbe_osxsave_mask = ((1 << 12) | (1 << 22) | (1 << 27));
-    constexpr uint32_t avx2_bmi12_mask = (1 << 5) | (1 << 3) | (1 << 8);
-
-    /*  CPUID.(EAX=01H, ECX=0H):ECX.FMA[bit 12]==1   &&
-        CPUID.(EAX=01H, ECX=0H):ECX.MOVBE[bit 22]==1 &&
-        CPUID.(EAX=01H, ECX=0H):ECX.OSXSAVE[bit 27]==1 */
-    run_cpuid(1, 0, abcd);
-    if ((abcd[2] & fma_movbe_osxsave_mask) != fma_movbe_osxsave_mask)
-        return 0;
-
-    if (!check_xcr0_ymm())
-        return 0;
-
-    /*  CPUID.(EAX=07H, ECX=0H):EBX.AVX2[bit 5]==1  &&
-        CPUID.(EAX=07H, ECX=0H):EBX.BMI1[bit 3]==1  &&
-        CPUID.(EAX=07H, ECX=0H):EBX.BMI2[bit 8]==1  */
-    run_cpuid(7, 0, abcd);
-    if ((abcd[1] & avx2_bmi12_mask) != avx2_bmi12_mask)
-        return 0;
-
-    /* CPUID.(EAX=80000001H):ECX.LZCNT[bit 5]==1 */
-    run_cpuid(0x80000001, 0, abcd);
-    if ((abcd[2] & (1 << 5)) == 0)
-        return 0;
-
-    return 1;
-}
-
-static bool CheckWhetherCpuSupportsAVX2()
-{
-    static int avx2Supported = -1;
-
-    if (avx2Supported == 0)
-    {
-        return false;
-    }
-    else if (avx2Supported == 1)
-    {
-        return true;
-    }
-    else
-    {
-        avx2Supported = (check_4th_gen_intel_core_features() > 0) ? 1 : 0;
-        return (avx2Supported == 1);
-    }
-}
-
-class LoHiBytePackUnpackAvx : public LoHiBytePackUnpack
-{
-public:
-    typedef void(*pfnLoHiByteUnpackStrided_t)(const void*, std::uint32_t, std::uint32_t, std::uint32_t, void*);
-    typedef void(*pfnLoHiBytePackStrided_t)(const void*, size_t, std::uint32_t, std::uint32_t, std::uint32_t, void*);
-
-    static pfnLoHiByteUnpackStrided_t pfnLoHiByteUnpackStrided;
-    static pfnLoHiBytePackStrided_t pfnLoHiBytePackStrided;
-
-    static void LoHiByteUnpackStrided_Choose(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst);
-    static void LoHiBytePackStrided_Choose(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest);
-
-    static void LoHiByteUnpackStrided_AVX(const void* source, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* dest);
-    static void LoHiBytePackStrided_AVX(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest);
-};
-
-LoHiBytePackUnpackAvx::pfnLoHiByteUnpackStrided_t LoHiBytePackUnpackAvx::pfnLoHiByteUnpackStrided = &LoHiBytePackUnpackAvx::LoHiByteUnpackStrided_Choose;
-LoHiBytePackUnpackAvx::pfnLoHiBytePackStrided_t LoHiBytePackUnpackAvx::pfnLoHiBytePackStrided = &LoHiBytePackUnpackAvx::LoHiBytePackStrided_Choose;
-
-/*static*/void LoHiBytePackUnpack::LoHiByteUnpackStrided(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst)
-{
-    LoHiBytePackUnpack::CheckLoHiByteUnpackArgumentsAndThrow(wordCount, stride, ptrSrc, ptrDst);
-    (*LoHiBytePackUnpackAvx::pfnLoHiByteUnpackStrided)(ptrSrc, wordCount, stride, lineCount, ptrDst);
-}
-
-/*static*/void LoHiBytePackUnpack::LoHiBytePackStrided(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest)
-{
-    LoHiBytePackUnpack::CheckLoHiBytePackArgumentsAndThrow(ptrSrc, sizeSrc, width, height, stride, dest);
-    (*LoHiBytePackUnpackAvx::pfnLoHiBytePackStrided)(ptrSrc, sizeSrc, width, height, stride, dest);
-}
-
-/*static*/void LoHiBytePackUnpackAvx::LoHiByteUnpackStrided_AVX(const void* source, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* dest)
+void kernels_avx2::LoHiByteUnpackStrided(const void* source, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* dest)
 {
     static const __m128i shuffleConst128 = _mm_set_epi8(
         0xf, 0xd, 0xb, 0x9,
@@ -174,7 +61,7 @@ LoHiBytePackUnpackAvx::pfnLoHiBytePackStrided_t LoHiBytePackUnpackAvx::pfnLoHiBy
     _mm256_zeroall();
 }
 
-/*static*/void LoHiBytePackUnpackAvx::LoHiBytePackStrided_AVX(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest)
+void kernels_avx2::LoHiBytePackStrided(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest)
 {
     const uint8_t* pSrc = static_cast<const uint8_t*>(ptrSrc);
 
@@ -207,42 +94,72 @@ LoHiBytePackUnpackAvx::pfnLoHiBytePackStrided_t LoHiBytePackUnpackAvx::pfnLoHiBy
     _mm256_zeroall();
 }
 
-/*static*/void LoHiBytePackUnpackAvx::LoHiByteUnpackStrided_Choose(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst)
+void kernels_avx2::ConvertGray16ToGray8Line(const std::uint16_t* source, std::uint8_t* destination, size_t count)
 {
-    if (CheckWhetherCpuSupportsAVX2())
+    const size_t countOver32 = count / 32;
+    for (size_t i = 0; i < countOver32; ++i)
     {
-        LoHiBytePackUnpackAvx::pfnLoHiByteUnpackStrided = LoHiBytePackUnpackAvx::LoHiByteUnpackStrided_AVX;
+        const __m256i a = _mm256_srli_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source)), 8);
+        const __m256i b = _mm256_srli_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + 16)), 8);
+
+        // the pack-operation works "per 128-bit-lane", so we need to fix up the order of the 64-bit-blocks afterwards
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination), packed);
+        source += 32;
+        destination += 32;
     }
-    else
+
+    for (size_t i = 0; i < count % 32; ++i)
     {
-        LoHiBytePackUnpackAvx::pfnLoHiByteUnpackStrided = LoHiBytePackUnpackAvx::LoHiByteUnpackStrided_C;
+        *destination++ = static_cast<uint8_t>(*source++ >> 8);
     }
 
-    (*LoHiBytePackUnpackAvx::pfnLoHiByteUnpackStrided)(ptrSrc, wordCount, stride, lineCount, ptrDst);
+    _mm256_zeroupper();
 }
 
-/*static*/void LoHiBytePackUnpackAvx::LoHiBytePackStrided_Choose(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest)
+void kernels_avx2::ConvertGray8ToGray16Line(const std::uint8_t* source, std::uint16_t* destination, size_t count)
 {
-    if (CheckWhetherCpuSupportsAVX2())
+    const size_t countOver16 = count / 16;
+    for (size_t i = 0; i < countOver16; ++i)
     {
-        LoHiBytePackUnpackAvx::pfnLoHiBytePackStrided = LoHiBytePackUnpackAvx::LoHiBytePackStrided_AVX;
+        const __m256i widened = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination), widened);
+        source += 16;
+        destination += 16;
     }
-    else
+
+    for (size_t i = 0; i < count % 16; ++i)
     {
-        LoHiBytePackUnpackAvx::pfnLoHiBytePackStrided = LoHiBytePackUnpackAvx::LoHiBytePackStrided_C;
+        *destination++ = *source++;
     }
 
-    (*LoHiBytePackUnpackAvx::pfnLoHiBytePackStrided)(ptrSrc, sizeSrc, width, height, stride, dest);
+    _mm256_zeroupper();
+}
+
+void kernels_avx2::FillGray16Line(std::uint16_t* destination, size_t count, std::uint16_t value)
+{
+    const __m256i v = _mm256_set1_epi16(static_cast<short>(value));
+    const size_t countOver16 = count / 16;
+    for (size_t i = 0; i < countOver16; ++i)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination), v);
+        destination += 16;
+    }
+
+    for (size_t i = 0; i < count % 16; ++i)
+    {
+        *destination++ = value;
+    }
+
+    _mm256_zeroupper();
 }
 
 #elif LIBCZI_HAS_NEOININTRINSICS
 
 #include <arm_neon.h>
 
-/*static*/void LoHiBytePackUnpack::LoHiByteUnpackStrided(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst)
+void kernels_neon::LoHiByteUnpackStrided(const void* ptrSrc, std::uint32_t wordCount, std::uint32_t stride, std::uint32_t lineCount, void* ptrDst)
 {
-    LoHiBytePackUnpack::CheckLoHiByteUnpackArgumentsAndThrow(wordCount, stride, ptrSrc, ptrDst);
-
     uint8_t* pDst = static_cast<uint8_t*>(ptrDst);
     const uint32_t widthOver8 = wordCount / 8;
     const uint32_t widthModulo8 = wordCount % 8;
@@ -271,10 +188,8 @@ LoHiBytePackUnpackAvx::pfnLoHiBytePackStrided_t LoHiBytePackUnpackAvx::pfnLoHiBy
     }
 }
 
-/*static*/void LoHiBytePackUnpack::LoHiBytePackStrided(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest)
+void kernels_neon::LoHiBytePackStrided(const void* ptrSrc, size_t sizeSrc, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* dest)
 {
-    LoHiBytePackUnpack::CheckLoHiBytePackArgumentsAndThrow(ptrSrc, sizeSrc, width, height, stride, dest);
-
     const uint8_t* pSrc = static_cast<const uint8_t*>(ptrSrc);
 
     const size_t halfLength = sizeSrc / 2;
@@ -303,4 +218,56 @@ LoHiBytePackUnpackAvx::pfnLoHiBytePackStrided_t LoHiBytePackUnpackAvx::pfnLoHiBy
         }
     }
 }
+
+void kernels_neon::ConvertGray16ToGray8Line(const std::uint16_t* source, std::uint8_t* destination, size_t count)
+{
+    const size_t countOver16 = count / 16;
+    for (size_t i = 0; i < countOver16; ++i)
+    {
+        const uint8x8_t a = vshrn_n_u16(vld1q_u16(source), 8);
+        const uint8x8_t b = vshrn_n_u16(vld1q_u16(source + 8), 8);
+        vst1q_u8(destination, vcombine_u8(a, b));
+        source += 16;
+        destination += 16;
+    }
+
+    for (size_t i = 0; i < count % 16; ++i)
+    {
+        *destination++ = static_cast<uint8_t>(*source++ >> 8);
+    }
+}
+
+void kernels_neon::ConvertGray8ToGray16Line(const std::uint8_t* source, std::uint16_t* destination, size_t count)
+{
+    const size_t countOver16 = count / 16;
+    for (size_t i = 0; i < countOver16; ++i)
+    {
+        const uint8x16_t a = vld1q_u8(source);
+        vst1q_u16(destination, vmovl_u8(vget_low_u8(a)));
+        vst1q_u16(destination + 8, vmovl_u8(vget_high_u8(a)));
+        source += 16;
+        destination += 16;
+    }
+
+    for (size_t i = 0; i < count % 16; ++i)
+    {
+        *destination++ = *source++;
+    }
+}
+
+void kernels_neon::FillGray16Line(std::uint16_t* destination, size_t count, std::uint16_t value)
+{
+    const uint16x8_t v = vdupq_n_u16(value);
+    const size_t countOver8 = count / 8;
+    for (size_t i = 0; i < countOver8; ++i)
+    {
+        vst1q_u16(destination, v);
+        destination += 8;
+    }
+
+    for (size_t i = 0; i < count % 8; ++i)
+    {
+        *destination++ = value;
+    }
+}
 #endif
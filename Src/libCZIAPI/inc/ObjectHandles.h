@@ -55,3 +55,9 @@ typedef ObjectHandle DisplaySettingsHandle;
 
 /// Defines an alias representing the handle of a "channel display settings" object.
 typedef ObjectHandle ChannelDisplaySettingsHandle;
+
+/// Defines an alias representing the handle of a sub-block cache object.
+typedef ObjectHandle SubBlockCacheObjectHandle;
+
+/// Defines an alias representing the handle of a pending read-request of an asynchronous external input stream.
+typedef ObjectHandle ExternalStreamReadRequestHandle;
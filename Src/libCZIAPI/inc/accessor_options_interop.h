@@ -4,7 +4,45 @@
 
 #pragma once
 
+#include "ObjectHandles.h"
+#include <cstdint>
+
 #pragma pack(push, 4)
+/// This structure gives statistics about a single accessor request (c.f. the field 'statistics' in 'AccessorOptionsExInterop').
+/// The durations are given in nanoseconds and are the sum over all sub-blocks processed.
+struct AccessorStatisticsInterop
+{
+    /// The number of sub-blocks found on the plane and intersecting with the ROI (before any further filtering).
+    std::uint32_t sub_blocks_enumerated;
+
+    /// The number of sub-blocks which were skipped because the visibility check found them to be overdrawn.
+    std::uint32_t sub_blocks_culled;
+
+    /// The number of sub-blocks which were read from the stream (and decoded).
+    std::uint32_t sub_blocks_read_from_stream;
+
+    /// The number of sub-blocks which were served from the sub-block cache.
+    std::uint32_t sub_blocks_from_cache;
+
+    /// The number of bytes of (possibly compressed) pixel data of the sub-blocks read from the stream.
+    std::uint64_t compressed_bytes_read;
+
+    /// The time spent for determining the sub-blocks to be drawn.
+    std::uint64_t enumerate_nanoseconds;
+
+    /// The time spent for reading sub-blocks from the stream.
+    std::uint64_t read_nanoseconds;
+
+    /// The time spent for decoding sub-blocks.
+    std::uint64_t decode_nanoseconds;
+
+    /// The time spent for scaling (or copying) sub-blocks into the destination bitmap.
+    std::uint64_t scale_nanoseconds;
+
+    /// The total time spent for the request.
+    std::uint64_t total_nanoseconds;
+};
+
 /// This structure is used to pass the accessor options to libCZIAPI.
 struct AccessorOptionsInterop
 {
@@ -59,4 +97,32 @@ struct AccessorOptionsInterop
     const char* additional_parameters;
 };
 
+/// This structure gives extended options for the accessor (in addition to 'AccessorOptionsInterop'), it is used with
+/// 'libCZI_SingleChannelTileAccessorGetEx', 'libCZI_SingleChannelTileAccessorGetIntoBuffer' and 'libCZI_SingleChannelTileAccessorGetBatch'.
+/// The structure is size-prefixed - the field 'size_of_structure' must be set to sizeof(AccessorOptionsExInterop). New fields
+/// will only be added at the end of the structure, and fields beyond the size given by the caller are treated as not present
+/// (i.e. their default is used), so that a caller compiled against an older version of this structure continues to work.
+struct AccessorOptionsExInterop
+{
+    /// The size of this structure in bytes (as known to the caller), i.e. sizeof(AccessorOptionsExInterop).
+    std::uint32_t size_of_structure;
+
+    /// Handle of a sub-block cache object (c.f. 'libCZI_CreateSubBlockCache') which is to be used by the accessor, or
+    /// kInvalidObjectHandle if no cache is to be used. Bitmaps which are read by the accessor are added to the cache, and
+    /// bitmaps which are in the cache already are taken from there (instead of reading and decoding the sub-block again).
+    /// Note that the cache is not pruned automatically, this must be done by calling 'libCZI_SubBlockCachePrune'.
+    SubBlockCacheObjectHandle sub_block_cache;
+
+    /// If true, then only bitmaps from sub-blocks with compressed data are added to the cache. For uncompressed
+    /// data, the time for reading the bitmap can be negligible, so the benefit of caching might not outweigh the
+    /// increased memory usage. This field is only relevant if 'sub_block_cache' is valid. If the field is not present
+    /// (as determined by 'size_of_structure'), then the default is true.
+    bool only_use_sub_block_cache_for_compressed_data;
+
+    /// If non-null, then statistics about the request are put here (if the request is successful). This is supported
+    /// by 'libCZI_SingleChannelTileAccessorGetEx' and 'libCZI_SingleChannelTileAccessorGetIntoBuffer'. It is ignored
+    /// by 'libCZI_SingleChannelTileAccessorGetBatch' (where the requests are processed concurrently).
+    AccessorStatisticsInterop* statistics;
+};
+
 #pragma pack(pop)
@@ -26,4 +26,15 @@ struct BitmapLockInfoInterop
     std::uint64_t size;         ///< The size of the bitmap data (pointed to by `ptrDataRoi`) in bytes.
 };
 
+/// This structure describes a memory buffer (owned by the caller) which is to be used as the destination
+/// for a bitmap.
+struct BitmapBufferInterop
+{
+    std::uint32_t width;        ///< The width of the bitmap in pixels.
+    std::uint32_t height;       ///< The height of the bitmap in pixels.
+    std::int32_t pixel_type;    ///< The pixel type of the bitmap.
+    std::uint32_t stride;       ///< The stride of the bitmap data (pointed to by `data`) in bytes.
+    void* data;                 ///< Pointer to the first (top-left) pixel of the bitmap. The buffer must have a size of at least `stride` * `height` bytes.
+};
+
 #pragma pack(pop)
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+// In this file we provide the declarations of the data structures of the DLPack-specification (https://github.com/dmlc/dlpack)
+// and of the Arrow C Data Interface (https://arrow.apache.org/docs/format/CDataInterface.html). Both specifications define
+// an ABI which is stable, and both are intended to be included (copied) into a producer's code. Note that those structures
+// are used with their natural alignment, so they must not be declared within a "#pragma pack"-section.
+// If the "official" headers are included before this file, then the declarations here are skipped.
+
+#ifndef DLPACK_DLPACK_H_
+
+/// The device type in DLDevice (only the device types relevant for libCZIAPI are given here).
+typedef enum : std::int32_t
+{
+    kDLCPU = 1,     ///< CPU device.
+} DLDeviceType;
+
+/// A device (on which the data of a DLTensor resides).
+typedef struct
+{
+    DLDeviceType device_type;   ///< The device type.
+    std::int32_t device_id;     ///< The device index.
+} DLDevice;
+
+/// The type code options of DLDataType.
+typedef enum
+{
+    kDLInt = 0U,            ///< Signed integer.
+    kDLUInt = 1U,           ///< Unsigned integer.
+    kDLFloat = 2U,          ///< IEEE floating point.
+    kDLOpaqueHandle = 3U,   ///< Opaque handle type.
+    kDLBfloat = 4U,         ///< bfloat16.
+    kDLComplex = 5U,        ///< Complex number (C/C++/Python layout: compact struct per complex number).
+    kDLBool = 6U,           ///< Boolean.
+} DLDataTypeCode;
+
+/// The data type of the elements of a DLTensor.
+typedef struct
+{
+    std::uint8_t code;      ///< Type code of base types, c.f. DLDataTypeCode.
+    std::uint8_t bits;      ///< Number of bits.
+    std::uint16_t lanes;    ///< Number of lanes in the type, used for vector types.
+} DLDataType;
+
+/// Plain C tensor object, does not manage memory.
+typedef struct
+{
+    void* data;                 ///< The data pointer.
+    DLDevice device;            ///< The device of the tensor.
+    std::int32_t ndim;          ///< Number of dimensions.
+    DLDataType dtype;           ///< The data type of the pointer.
+    std::int64_t* shape;        ///< The shape of the tensor.
+    std::int64_t* strides;      ///< Strides of the tensor (in number of elements, not bytes).
+    std::uint64_t byte_offset;  ///< The offset in bytes to the beginning pointer to data.
+} DLTensor;
+
+/// C tensor object, manages memory of DLTensor. This data structure is intended to facilitate the borrowing of DLTensor by
+/// another framework. The consumer calls the deleter when it is done with the tensor.
+typedef struct DLManagedTensor
+{
+    DLTensor dl_tensor;                             ///< DLTensor which is being memory managed.
+    void* manager_ctx;                              ///< The context of the original host framework of DLManagedTensor.
+    void (*deleter)(struct DLManagedTensor* self);  ///< Destructor - this should be called to destruct the manager_ctx which backs the DLManagedTensor.
+} DLManagedTensor;
+
+#endif
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+/// The schema (i.e. the type) of exported data, as defined by the Arrow C Data Interface.
+struct ArrowSchema
+{
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    std::int64_t flags;
+    std::int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+/// The exported data, as defined by the Arrow C Data Interface.
+struct ArrowArray
+{
+    // Array data description
+    std::int64_t length;
+    std::int64_t null_count;
+    std::int64_t offset;
+    std::int64_t n_buffers;
+    std::int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
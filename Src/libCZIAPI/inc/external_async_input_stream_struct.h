@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "external_stream_error_information_struct.h"
+#include "ObjectHandles.h"
+
+#include <cstdint>
+
+#pragma pack(push, 4)
+
+/// This structure contains information about externally provided functions for reading data from an input stream in
+/// an asynchronous (callback-driven) fashion, and it is used to construct a stream-object to be used with libCZI.
+/// With this kind of stream, libCZI issues a read-request (by calling 'begin_read_function'), and the host completes
+/// the request at a later point in time (from an arbitrary thread) by calling 'libCZI_CompleteExternalStreamRead'.
+/// This allows the host to serve the requests with asynchronous I/O, without blocking one of its threads for the
+/// duration of the read-operation. Multiple read-requests may be outstanding at the same time.
+/// Note on lifetime: The function pointers must remain valid until the function 'close_function' is called. The lifetime
+/// may extend beyond calling the 'libCZI_ReleaseInputStream' function for the corresponding stream-object.
+struct ExternalAsyncInputStreamStructInterop
+{
+    /// A user parameter which is passed to the callback function.
+    std::uintptr_t opaque_handle1;
+
+    /// A user parameter which is passed to the callback function.
+    std::uintptr_t opaque_handle2;
+
+    /// The maximum number of read-requests which may be outstanding at the same time. If this is 0 (or negative), then
+    /// the number of outstanding read-requests is not limited.
+    std::int32_t max_outstanding_reads;
+
+    /// Function pointer used to start a read-operation.
+    /// This function might be called from an arbitrary thread, and it may be called concurrently from multiple threads.
+    /// It should not block; instead it is expected to start the read-operation and return immediately. When the read-operation
+    /// has finished, 'libCZI_CompleteExternalStreamRead' must be called with the specified request-handle (exactly once).
+    /// The buffer 'pv' remains valid until 'libCZI_CompleteExternalStreamRead' is called.
+    /// A 0 as return value indicates that the read-operation has been started. A non-zero value indicates a non-recoverable
+    /// error - in this case, the read-operation is considered not started, and 'libCZI_CompleteExternalStreamRead' must
+    /// not be called for the request-handle. The error_info parameter may be used to give additional error information.
+    ///
+    /// \param          opaque_handle1  The value of the opaque_handle1 field of the ExternalAsyncInputStreamStructInterop.
+    /// \param          opaque_handle2  The value of the opaque_handle2 field of the ExternalAsyncInputStreamStructInterop.
+    /// \param          offset          The offset in the stream where to start reading from.
+    /// \param [out]    pv              Pointer to the buffer where the data is to be stored.
+    /// \param          size            The size of the buffer (and the number of bytes to be read from the stream).
+    /// \param          request         The handle identifying this read-request, which is to be passed to 'libCZI_CompleteExternalStreamRead'.
+    /// \param [out]    error_info      If non-null, in case of an error (i.e. return value <>0), this parameter may be used to report additional error information.
+    std::int32_t(*begin_read_function)(
+        std::uintptr_t opaque_handle1,
+        std::uintptr_t opaque_handle2,
+        std::uint64_t offset,
+        void* pv,
+        std::uint64_t size,
+        ExternalStreamReadRequestHandle request,
+        ExternalStreamErrorInfoInterop* error_info);
+
+    /// Function pointer used to close the stream. This function is called only once, and up until this function is called,
+    /// the begin_read_function pointer must remain valid and operational. This function is not called while read-requests
+    /// are outstanding.
+    ///
+    /// \param  opaque_handle1  The value of the opaque_handle1 field of the ExternalAsyncInputStreamStructInterop.
+    /// \param  opaque_handle2  The value of the opaque_handle2 field of the ExternalAsyncInputStreamStructInterop.
+    void(*close_function)(std::uintptr_t opaque_handle1, std::uintptr_t opaque_handle2);
+};
+
+#pragma pack(pop)
@@ -10,12 +10,15 @@
 #include "versioninfo_structs.h"
 #include "inputstream_class_info_struct.h"
 #include "external_input_stream_struct.h"
+#include "external_async_input_stream_struct.h"
 #include "external_output_stream_struct.h"
 #include "reader_open_info_struct.h"
 #include "subblock_statistics_struct.h"
 #include "MetadataAsXml_struct.h"
 #include "bitmap_structs.h"
 #include "subblock_info_interop.h"
+#include "subblock_info_columns_interop.h"
+#include "dlpack_arrow_interop.h"
 #include "attachment_info_interop.h"
 #include "fileheader_info_interop.h"
 #include "add_subblock_info_interop.h"
@@ -24,6 +27,9 @@
 #include "accessor_options_interop.h"
 #include "composition_channel_info_interop.h"
 #include "scaling_info_interop.h"
+#include "subblock_cache_interop.h"
+#include "tile_accessor_request_interop.h"
+#include "performance_counters_interop.h"
 
 #include <cstdint>
 
@@ -94,6 +100,22 @@ EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReaderGetFileHeaderInfo(CziRead
 /// \returns    An error-code indicating success or failure of the operation.
 EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReaderReadSubBlock(CziReaderObjectHandle reader_object, std::int32_t index, SubBlockObjectHandle* sub_block_object);
 
+/// Reads the sub-blocks identified by the specified indices. The sub-blocks are read concurrently (with the specified number
+/// of threads), which allows for multiple read-operations to be outstanding at the same time - this is beneficial for streams
+/// with a high latency (e.g. streams created with 'libCZI_CreateInputStreamFromExternalAsync'). If there is no sub-block
+/// present for an index, the corresponding handle is set to 'kInvalidObjectHandle'. If the operation fails, all
+/// handles are set to 'kInvalidObjectHandle' (and no sub-block objects need to be released).
+///
+/// \param          reader_object       The reader object.
+/// \param          count               The number of sub-blocks to read.
+/// \param          indices             Array (of size 'count') with the indices of the sub-blocks to read.
+/// \param [out]    sub_block_objects   Array (of size 'count') where the handles of the sub-block objects are put.
+/// \param          number_of_threads   The maximum number of sub-blocks to be read concurrently. If this is 0 (or negative),
+///                                     then the number of hardware threads is used.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReaderReadSubBlocks(CziReaderObjectHandle reader_object, std::int32_t count, const std::int32_t* indices, SubBlockObjectHandle* sub_block_objects, std::int32_t number_of_threads);
+
 /// Get statistics about the sub-blocks in the CZI-document. This function provides a simple version of the statistics, the
 /// information retrieved does not include the per-scene statistics.
 ///
@@ -183,6 +205,17 @@ EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReaderGetAttachmentInfoFromDire
 /// \returns  An error-code indicating success or failure of the operation.
 EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReaderReadAttachment(CziReaderObjectHandle reader_object, std::int32_t index, AttachmentObjectHandle* attachment_object);
 
+/// Get the performance counters of the specified reader-object. Those counters are maintained per reader-object and
+/// give the number of read-calls to the stream (and their durations), the number of bytes read and the number of
+/// sub-blocks read by this reader. The other counters and timers are only maintained globally (c.f. 'libCZI_GetGlobalPerformanceCounters')
+/// and are reported as zero here.
+///
+/// \param          reader_object           The reader object.
+/// \param [out]    performance_counters    If successful, the performance counters are put here.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReaderGetPerformanceCounters(CziReaderObjectHandle reader_object, PerformanceCountersInterop* performance_counters);
+
 /// Release the specified reader-object. After this function is called, the handle is no
 /// longer valid.
 ///
@@ -253,6 +286,32 @@ EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_CreateInputStreamFromFileUTF8(c
 /// \returns    An error-code indicating success or failure of the operation.
 EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_CreateInputStreamFromExternal(const ExternalInputStreamStructInterop* external_input_stream_struct, InputStreamObjectHandle* stream_object);
 
+/// Create an input stream object which is using externally provided functions for reading the data
+/// asynchronously. Read-requests are started with the 'begin_read_function' and must be completed
+/// by calling 'libCZI_CompleteExternalStreamRead'. Please refer to the documentation of
+/// 'ExternalAsyncInputStreamStructInterop' for more information.
+///
+/// \param          external_async_input_stream_struct  Structure containing the information about the externally provided functions.
+/// \param [out]    stream_object                       If successful, the handle to the newly created input stream object is put here.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_CreateInputStreamFromExternalAsync(const ExternalAsyncInputStreamStructInterop* external_async_input_stream_struct, InputStreamObjectHandle* stream_object);
+
+/// Complete a read-request which was started with the 'begin_read_function' of an asynchronous external input stream.
+/// This function may be called from an arbitrary thread, and it must be called exactly once for each read-request
+/// which was started successfully. After this function returns, the request-handle is no longer valid - calling it again
+/// with the same handle (or with the handle of a request for which the 'begin_read_function' returned an error) gives
+/// 'LibCZIApi_ErrorCode_InvalidHandle'.
+///
+/// \param  request     The handle of the read-request (as passed to the 'begin_read_function').
+/// \param  bytes_read  The number of bytes which have actually been read (and put into the buffer).
+/// \param  error_info  If null, the read-operation is reported as successful. Otherwise, the read-operation failed, and the
+///                     structure gives information about the error. Ownership of the error message is transferred
+///                     to libCZI (i.e. it must be allocated with 'libCZI_AllocateMemory' and must not be freed by the caller).
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_CompleteExternalStreamRead(ExternalStreamReadRequestHandle request, std::uint64_t bytes_read, const ExternalStreamErrorInfoInterop* error_info);
+
 /// Release the specified input stream object. After this function is called, the handle is no
 /// longer valid. Note that calling this function will only decrement the usage count of the
 /// underlying object; whereas the object itself (and the resources it holds) will only be
@@ -320,6 +379,41 @@ EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReleaseSubBlock(SubBlockObjectH
 /// \returns An error-code indicating success or failure of the operation.
 EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_TryGetSubBlockInfoForIndex(CziReaderObjectHandle reader_object, std::int32_t index, SubBlockInfoInterop* sub_block_info_interop);
 
+/// Get information about all sub-blocks (or a subset of them) with a single call. The information is put into caller-provided
+/// arrays ("columns"), described by the 'columns' structure. Optionally, the sub-blocks can be filtered by a plane coordinate (then
+/// only sub-blocks whose coordinate has the same values for all dimensions given in the plane coordinate are reported) and by a
+/// region of interest (then only sub-blocks whose logical rectangle intersects with the ROI are reported). The sub-blocks are
+/// reported in the order of the sub-block directory.
+/// If the number of sub-blocks matching the filter is larger than the capacity of the columns, then only the first 'capacity'
+/// sub-blocks are put into the columns. The total number of matching sub-blocks is always returned in 'count', so
+/// calling this function with a capacity of zero can be used to determine the required size of the columns.
+///
+/// \param          reader_object       The reader object.
+/// \param          plane_coordinate    The plane coordinate to filter by - may be null, in which case no filtering by plane is done.
+/// \param          roi                 The region of interest to filter by - may be null, in which case no filtering by ROI is done.
+/// \param          columns             The columns to be filled.
+/// \param [out]    count               The total number of sub-blocks matching the filter.
+///
+/// \returns An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReaderGetSubBlockInfoColumns(CziReaderObjectHandle reader_object, const CoordinateInterop* plane_coordinate, const IntRectInterop* roi, const SubBlockInfoColumnsInterop* columns, std::int32_t* count);
+
+/// Export information about all sub-blocks (or a subset of them) as a table in the format of the "Arrow C Data Interface"
+/// (c.f. https://arrow.apache.org/docs/format/CDataInterface.html). The table is exported as a struct-array, with one field
+/// for each column. The columns are "index", one column for each dimension in use (named "Z", "C", "T" and so on, where
+/// null indicates that the dimension is not present for the sub-block), "logical_x", "logical_y", "logical_w", "logical_h",
+/// "physical_w", "physical_h", "m_index" (null if the M-index is not valid), "pixel_type", "compression_mode_raw",
+/// "file_position" and "pyramid_type". The filtering by plane coordinate and ROI is the same as with 'libCZI_ReaderGetSubBlockInfoColumns'.
+/// The consumer is responsible for calling the release-callbacks of the schema and the array.
+///
+/// \param          reader_object       The reader object.
+/// \param          plane_coordinate    The plane coordinate to filter by - may be null, in which case no filtering by plane is done.
+/// \param          roi                 The region of interest to filter by - may be null, in which case no filtering by ROI is done.
+/// \param [out]    schema              If successful, the schema of the table is put here.
+/// \param [out]    array               If successful, the data of the table is put here.
+///
+/// \returns An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReaderExportSubBlockInfoAsArrow(CziReaderObjectHandle reader_object, const CoordinateInterop* plane_coordinate, const IntRectInterop* roi, ArrowSchema* schema, ArrowArray* array);
+
 // sub-block functions end here
 // ****************************************************************************************************
 
@@ -395,6 +489,19 @@ EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_BitmapUnlock(BitmapObjectHandle
 /// \returns A LibCZIApiErrorCode.
 EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_BitmapCopyTo(BitmapObjectHandle bitmap_object, std::uint32_t width, std::uint32_t height, std::int32_t pixel_type, std::uint32_t stride, void* ptr);
 
+/// Export the specified bitmap object as a DLPack-tensor (c.f. https://github.com/dmlc/dlpack), which refers to the pixel data
+/// of the bitmap without copying it. The shape of the tensor is (height, width) for grayscale pixel types, and
+/// (height, width, number of channels) for color pixel types, where the channels are in the order B, G, R (and A).
+/// The tensor keeps the bitmap locked and alive until the deleter of the tensor is called (which is the responsibility of the
+/// consumer of the tensor). The bitmap object itself can be released independently of the tensor.
+///
+/// \param          bitmap_object   The bitmap object.
+/// \param [out]    managed_tensor  If successful, a pointer to the newly created DLPack-tensor is put here.
+///
+/// \returns An error-code indicating success or failure of the operation. If the pixel type of the bitmap cannot be
+///          represented as a DLPack-tensor, then 'LibCZIApi_ErrorCode_InvalidArgument' is returned.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_BitmapExportAsDLPack(BitmapObjectHandle bitmap_object, DLManagedTensor** managed_tensor);
+
 /// Release the specified bitmap object.
 /// It is a fatal error trying to release a bitmap object that is still locked.
 ///
@@ -667,6 +774,58 @@ EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_SingleChannelTileAccessorCalcSi
 /// \returns    An error-code indicating success or failure of the operation.
 EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_SingleChannelTileAccessorGet(SingleChannelScalingTileAccessorObjectHandle accessor_object, const CoordinateInterop* coordinate, const IntRectInterop* roi, float zoom, const AccessorOptionsInterop* options, BitmapObjectHandle* bitmap_object);
 
+/// Gets the tile bitmap of the specified plane and the specified roi with the specified zoom factor. This is the same as
+/// 'libCZI_SingleChannelTileAccessorGet', with additional options given by an 'AccessorOptionsExInterop' structure (e.g.
+/// a sub-block cache to be used).
+///
+/// \param  accessor_object         Handle to the tile accessor object. This object is responsible for managing the access to the tiles within the specified plane.
+/// \param  coordinate              Pointer to a `CoordinateInterop` structure that specifies the coordinates within the plane from which the tile bitmap is to be retrieved.
+/// \param  roi                     The region of interest that defines within the plane for which the tile bitmap is requested.
+/// \param  zoom                    A floating-point value representing the zoom factor.
+/// \param  options                 A pointer to an AccessorOptionsInterop structure that may contain additional options for accessing the tile bitmap.
+/// \param  options_ex              A pointer to an AccessorOptionsExInterop structure with extended options (which may be null). Its field
+///                                 'size_of_structure' must be set, otherwise 'LibCZIApi_ErrorCode_InvalidArgument' is returned.
+/// \param  bitmap_object [out]     If the operation is successful, the created bitmap object will be put here.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_SingleChannelTileAccessorGetEx(SingleChannelScalingTileAccessorObjectHandle accessor_object, const CoordinateInterop* coordinate, const IntRectInterop* roi, float zoom, const AccessorOptionsInterop* options, const AccessorOptionsExInterop* options_ex, BitmapObjectHandle* bitmap_object);
+
+/// Gets the tile bitmap of the specified plane and the specified roi with the specified zoom factor, and renders it
+/// directly into the caller-supplied buffer. Other than with 'libCZI_SingleChannelTileAccessorGet', no bitmap object is
+/// created, so the allocation and the copy of the bitmap (with 'libCZI_BitmapCopyTo') is avoided.
+/// The width and height of the destination must be equal to the size reported by 'libCZI_SingleChannelTileAccessorCalcSize'
+/// for the ROI and the zoom, and the pixel data is converted to the pixel type of the destination.
+///
+/// \param  accessor_object         Handle to the tile accessor object.
+/// \param  coordinate              Pointer to a `CoordinateInterop` structure that specifies the coordinates within the plane from which the tile bitmap is to be retrieved.
+/// \param  roi                     The region of interest that defines within the plane for which the tile bitmap is requested.
+/// \param  zoom                    A floating-point value representing the zoom factor.
+/// \param  options                 A pointer to an AccessorOptionsInterop structure that may contain additional options for accessing the tile bitmap.
+/// \param  options_ex              A pointer to an AccessorOptionsExInterop structure with extended options (which may be null).
+/// \param  destination             The caller-supplied buffer where the tile bitmap is rendered into.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_SingleChannelTileAccessorGetIntoBuffer(SingleChannelScalingTileAccessorObjectHandle accessor_object, const CoordinateInterop* coordinate, const IntRectInterop* roi, float zoom, const AccessorOptionsInterop* options, const AccessorOptionsExInterop* options_ex, const BitmapBufferInterop* destination);
+
+/// Processes a batch of tile requests, where each tile bitmap is rendered directly into a caller-supplied buffer (as
+/// with 'libCZI_SingleChannelTileAccessorGetIntoBuffer'). The requests are processed concurrently on multiple threads.
+/// The outcome of each request is reported in its field 'result'. A request failing does not stop the processing of
+/// the other requests. If the operation is aborted (e.g. because a thread could not be started), then the requests which
+/// were not processed report an error.
+///
+/// \param  accessor_object         Handle to the tile accessor object.
+/// \param  count                   The number of requests in the array 'requests'.
+/// \param  requests [in,out]       Pointer to an array of 'count' requests.
+/// \param  options                 A pointer to an AccessorOptionsInterop structure that may contain additional options for accessing the tile bitmap.
+///                                 The same options are used for all requests.
+/// \param  options_ex              A pointer to an AccessorOptionsExInterop structure with extended options (which may be null).
+///                                 The same options are used for all requests. Its field 'statistics' is ignored.
+/// \param  number_of_threads       The number of threads to use. If less than or equal to zero, then the number of hardware threads is used.
+///
+/// \returns    An error-code indicating success or failure of the operation. If the arguments are valid, then LibCZIApi_ErrorCode_OK is returned
+///             if all requests succeeded, and the error-code of the first failed request otherwise.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_SingleChannelTileAccessorGetBatch(SingleChannelScalingTileAccessorObjectHandle accessor_object, std::int32_t count, SingleChannelTileAccessorRequestInterop* requests, const AccessorOptionsInterop* options, const AccessorOptionsExInterop* options_ex, std::int32_t number_of_threads);
+
 /// Release the specified accessor object.
 ///
 /// \param  accessor_object      The accessor object.
@@ -677,6 +836,78 @@ EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReleaseCreateSingleChannelTileA
 // SingleChannelScalingTileAccessor  functions end here
 // ****************************************************************************************************
 
+// ****************************************************************************************************
+// SubBlockCache functions begin here
+
+/// Create a sub-block cache object. The cache can be passed to 'libCZI_SingleChannelTileAccessorGetEx' (with the
+/// field 'sub_block_cache' of the 'AccessorOptionsExInterop' structure), and it can be shared between multiple
+/// accessors and multiple calls. The cache is not pruned automatically, use 'libCZI_SubBlockCachePrune' in order to
+/// limit its memory usage.
+///
+/// \param  sub_block_cache_object [out]    If the operation is successful, a handle to the newly created sub-block cache object is put here.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_CreateSubBlockCache(SubBlockCacheObjectHandle* sub_block_cache_object);
+
+/// Get statistics about the specified sub-block cache object.
+///
+/// \param  sub_block_cache_object  The sub-block cache object.
+/// \param  mask                    A bit-mask specifying which items are to be retrieved (a combination of 'kSubBlockCacheStatisticsMemoryUsage'
+///                                 and 'kSubBlockCacheStatisticsElementsCount').
+/// \param  statistics [out]        If successful, the statistics are put here. The field 'validity_mask' indicates which fields are valid.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_SubBlockCacheGetStatistics(SubBlockCacheObjectHandle sub_block_cache_object, std::uint8_t mask, SubBlockCacheStatisticsInterop* statistics);
+
+/// Prune the specified sub-block cache object, i.e. remove elements from the cache (starting with the least recently
+/// accessed ones) until the conditions given with the prune options are met.
+///
+/// \param  sub_block_cache_object  The sub-block cache object.
+/// \param  prune_options           The prune options.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_SubBlockCachePrune(SubBlockCacheObjectHandle sub_block_cache_object, const SubBlockCachePruneOptionsInterop* prune_options);
+
+/// Release the specified sub-block cache object. Note that the cache is kept alive as long as it is in use by an accessor operation.
+///
+/// \param  sub_block_cache_object  The sub-block cache object.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ReleaseSubBlockCache(SubBlockCacheObjectHandle sub_block_cache_object);
+
+// SubBlockCache functions end here
+// ****************************************************************************************************
+
+// ****************************************************************************************************
+// Instrumentation functions begin here
+
+/// Get a snapshot of the global (i.e. process-wide) performance counters. The global counters are the aggregate
+/// over all objects of libCZI.
+///
+/// \param [out]    performance_counters    If successful, the performance counters are put here.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_GetGlobalPerformanceCounters(PerformanceCountersInterop* performance_counters);
+
+/// Reset the global performance counters to zero.
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_ResetGlobalPerformanceCounters();
+
+/// Enable or disable the output of trace-events. If a valid output-stream object is given, then for each timed
+/// operation an event (in the JSON array format of the "Chrome Trace Event Format") is written to the stream. The
+/// resulting file can be loaded into "chrome://tracing" or "https://ui.perfetto.dev". If 'kInvalidObjectHandle' is
+/// given, then tracing is disabled (and the JSON array in a previously set stream is terminated). The output-stream
+/// object may be released after this call, the stream is kept alive as long as it is in use.
+///
+/// \param  output_stream_object    The output stream object (or 'kInvalidObjectHandle' in order to disable tracing).
+///
+/// \returns    An error-code indicating success or failure of the operation.
+EXTERNALLIBCZIAPI_API(LibCZIApiErrorCode) libCZI_SetChromeTraceEventSink(OutputStreamObjectHandle output_stream_object);
+
+// Instrumentation functions end here
+// ****************************************************************************************************
+
 // ****************************************************************************************************
 // Compositor functions begin here
 
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+#pragma pack(push, 4)
+
+/// The number of counters in the 'counters' array of 'PerformanceCountersInterop'.
+const std::int32_t kPerformanceCounterCount = 6;
+
+/// The number of timers in the 'timers' array of 'PerformanceCountersInterop'.
+const std::int32_t kPerformanceTimerCount = 7;
+
+/// The number of buckets in a 'DurationHistogramInterop'.
+const std::int32_t kDurationHistogramBucketCount = 24;
+
+/// Index (into 'PerformanceCountersInterop::counters') of the number of read-calls to the stream.
+const std::int32_t kPerformanceCounter_StreamReadCalls = 0;
+
+/// Index (into 'PerformanceCountersInterop::counters') of the number of bytes read from the stream.
+const std::int32_t kPerformanceCounter_StreamReadBytes = 1;
+
+/// Index (into 'PerformanceCountersInterop::counters') of the number of sub-blocks read.
+const std::int32_t kPerformanceCounter_SubBlocksRead = 2;
+
+/// Index (into 'PerformanceCountersInterop::counters') of the number of lookups in a sub-block cache which found the sub-block.
+const std::int32_t kPerformanceCounter_SubBlockCacheHits = 3;
+
+/// Index (into 'PerformanceCountersInterop::counters') of the number of lookups in a sub-block cache which did not find the sub-block.
+const std::int32_t kPerformanceCounter_SubBlockCacheMisses = 4;
+
+/// Index (into 'PerformanceCountersInterop::counters') of the number of sub-blocks skipped because of the visibility check.
+const std::int32_t kPerformanceCounter_TilesCulledByVisibilityCheck = 5;
+
+/// Index (into 'PerformanceCountersInterop::timers') of the timer for stream read-calls.
+const std::int32_t kPerformanceTimer_StreamRead = 0;
+
+/// Index (into 'PerformanceCountersInterop::timers') of the timer for decoding JPG-XR compressed sub-blocks.
+const std::int32_t kPerformanceTimer_DecodeJpgXr = 1;
+
+/// Index (into 'PerformanceCountersInterop::timers') of the timer for decoding zstd0 compressed sub-blocks.
+const std::int32_t kPerformanceTimer_DecodeZStd0 = 2;
+
+/// Index (into 'PerformanceCountersInterop::timers') of the timer for decoding zstd1 compressed sub-blocks.
+const std::int32_t kPerformanceTimer_DecodeZStd1 = 3;
+
+/// Index (into 'PerformanceCountersInterop::timers') of the timer for the nearest-neighbor scaling of sub-blocks.
+const std::int32_t kPerformanceTimer_NNResize = 4;
+
+/// Index (into 'PerformanceCountersInterop::timers') of the timer for a request to a single-channel tile accessor (including reading and decoding).
+const std::int32_t kPerformanceTimer_SingleChannelAccessorGet = 5;
+
+/// Index (into 'PerformanceCountersInterop::timers') of the timer for multi-channel composition.
+const std::int32_t kPerformanceTimer_MultiChannelComposition = 6;
+
+/// This structure gives a histogram of durations. Bucket 0 counts durations less than 1 microsecond, bucket i counts durations
+/// in the range [2^(i-1), 2^i) microseconds, and the last bucket counts all longer durations.
+struct DurationHistogramInterop
+{
+    /// The number of durations recorded.
+    std::uint64_t count;
+
+    /// The sum of all durations recorded, in nanoseconds.
+    std::uint64_t total_nanoseconds;
+
+    /// The buckets of the histogram.
+    std::uint64_t buckets[kDurationHistogramBucketCount];
+};
+
+/// This structure gives a snapshot of performance counters (c.f. 'libCZI_GetGlobalPerformanceCounters' and
+/// 'libCZI_ReaderGetPerformanceCounters').
+struct PerformanceCountersInterop
+{
+    /// The values of the counters, indexed by the 'kPerformanceCounter_*' constants.
+    std::uint64_t counters[kPerformanceCounterCount];
+
+    /// The duration histograms, indexed by the 'kPerformanceTimer_*' constants.
+    DurationHistogramInterop timers[kPerformanceTimerCount];
+};
+
+#pragma pack(pop)
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+#pragma pack(push, 4)
+
+/// Bit-mask value for the field 'memory_usage' in 'SubBlockCacheStatisticsInterop' (c.f. 'libCZI_SubBlockCacheGetStatistics').
+const std::uint8_t kSubBlockCacheStatisticsMemoryUsage = 1;
+
+/// Bit-mask value for the field 'elements_count' in 'SubBlockCacheStatisticsInterop' (c.f. 'libCZI_SubBlockCacheGetStatistics').
+const std::uint8_t kSubBlockCacheStatisticsElementsCount = 2;
+
+/// This structure gives statistics about a sub-block cache object.
+struct SubBlockCacheStatisticsInterop
+{
+    /// A bit-mask which indicates which fields are valid. Bit 0 (kSubBlockCacheStatisticsMemoryUsage) indicates that
+    /// 'memory_usage' is valid, bit 1 (kSubBlockCacheStatisticsElementsCount) indicates that 'elements_count' is valid.
+    std::uint8_t validity_mask;
+
+    /// The memory usage of all elements in the cache (in bytes).
+    std::uint64_t memory_usage;
+
+    /// The number of elements in the cache.
+    std::uint32_t elements_count;
+};
+
+/// This structure gives the options for pruning a sub-block cache object (c.f. 'libCZI_SubBlockCachePrune'). Elements
+/// are evicted from the cache (starting with the least recently accessed ones) until both conditions are met.
+struct SubBlockCachePruneOptionsInterop
+{
+    /// The maximum memory usage (in bytes) for the cache. Use the maximum value of the type if no limit is desired.
+    std::uint64_t max_memory_usage;
+
+    /// The maximum number of sub-blocks in the cache. Use the maximum value of the type if no limit is desired.
+    std::uint32_t max_sub_block_count;
+};
+
+#pragma pack(pop)
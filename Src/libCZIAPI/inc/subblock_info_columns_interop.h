@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "misc_types.h"
+
+#pragma pack(push, 4)
+
+/// This structure describes a set of caller-provided arrays ("columns") which are filled with information about
+/// sub-blocks by the function 'libCZI_ReaderGetSubBlockInfoColumns'. All columns must have (at least) 'capacity'
+/// elements, and the element at position 'i' in each column refers to the same sub-block. Any of the column-pointers
+/// may be null, in which case this column is not filled.
+struct SubBlockInfoColumnsInterop
+{
+    /// The number of elements available in each of the columns.
+    std::int32_t capacity;
+
+    /// Column receiving the index of the sub-block.
+    std::int32_t* index;
+
+    /// Column receiving a bitfield indicating which dimensions are valid in the coordinate of the sub-block. Bit-position `i`
+    /// corresponds to dimension `i+1` (so, the convention is the same as with `CoordinateInterop`).
+    std::uint32_t* dimensions_valid;
+
+    /// Columns receiving the coordinate of the sub-block - there is one column for each dimension, and the column at
+    /// position `i` corresponds to dimension `i+1` (so, `coordinate[0]` is for dimension Z, `coordinate[1]` for dimension C, and so on).
+    /// Other than with `CoordinateInterop`, the values are not compacted. If the dimension is not valid for the sub-block,
+    /// then the value 'numeric_limits<int32_t>::min()' is put into the column.
+    std::int32_t* coordinate[kMaxDimensionCount];
+
+    std::int32_t* logical_rect_x;           ///< Column receiving the x-coordinate of the logical rectangle.
+    std::int32_t* logical_rect_y;           ///< Column receiving the y-coordinate of the logical rectangle.
+    std::int32_t* logical_rect_w;           ///< Column receiving the width of the logical rectangle.
+    std::int32_t* logical_rect_h;           ///< Column receiving the height of the logical rectangle.
+    std::int32_t* physical_size_w;          ///< Column receiving the width of the physical size.
+    std::int32_t* physical_size_h;          ///< Column receiving the height of the physical size.
+
+    /// Column receiving the M-index. If the M-index is not valid, then the value 'numeric_limits<int32_t>::min()' is put into the column.
+    std::int32_t* m_index;
+
+    std::int32_t* pixel_type;               ///< Column receiving the pixel type.
+    std::int32_t* compression_mode_raw;     ///< Column receiving the (raw) compression mode identification.
+    std::uint64_t* file_position;           ///< Column receiving the file position of the sub-block segment.
+    std::uint8_t* pyramid_type;             ///< Column receiving the pyramid type (0=none, 1=single sub-block, 2=multi sub-block, 255=invalid).
+};
+
+#pragma pack(pop)
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "errorcodes.h"
+#include "misc_types.h"
+#include "bitmap_structs.h"
+
+#pragma pack(push, 4)
+
+/// This structure describes a single request which is part of a batch of requests given to 'libCZI_SingleChannelTileAccessorGetBatch'.
+struct SingleChannelTileAccessorRequestInterop
+{
+    /// The coordinate of the plane from which the tile bitmap is to be retrieved.
+    CoordinateInterop coordinate;
+
+    /// The region of interest (within the plane) for which the tile bitmap is requested.
+    IntRectInterop roi;
+
+    /// The zoom factor.
+    float zoom;
+
+    /// The caller-supplied buffer where the tile bitmap is rendered into. The width and height of the buffer must
+    /// be equal to the size reported by 'libCZI_SingleChannelTileAccessorCalcSize' for the ROI and the zoom.
+    BitmapBufferInterop destination;
+
+    /// [out] The result of this request - it is set to 'LibCZIApi_ErrorCode_OK' if the request was processed successfully,
+    /// or to an error-code otherwise.
+    LibCZIApiErrorCode result;
+};
+
+#pragma pack(pop)
@@ -0,0 +1,367 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#include "exporthelpers.h"
+
+#include <limits>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+
+using namespace libCZI;
+using namespace std;
+
+namespace
+{
+    /// The context of a DLPack-tensor created by us - the bitmap is locked as long as the tensor is alive.
+    struct DLManagedTensorContext
+    {
+        DLManagedTensor managed_tensor;
+        shared_ptr<IBitmapData> bitmap;
+        int64_t shape[3];
+        int64_t strides[3];
+    };
+
+    /// Determines the DLPack-data-type of a component and the number of components for the specified pixel type.
+    ///
+    /// \param          pixel_type          The pixel type.
+    /// \param [out]    data_type           The data type of a component.
+    /// \param [out]    number_of_channels  The number of components (channels) of a pixel.
+    ///
+    /// \returns    True if the pixel type is supported; false otherwise.
+    bool TryGetDLDataTypeForPixelType(PixelType pixel_type, DLDataType& data_type, int& number_of_channels)
+    {
+        data_type.lanes = 1;
+        switch (pixel_type)
+        {
+        case PixelType::Gray8:
+            data_type.code = kDLUInt; data_type.bits = 8; number_of_channels = 1;
+            return true;
+        case PixelType::Gray16:
+            data_type.code = kDLUInt; data_type.bits = 16; number_of_channels = 1;
+            return true;
+        case PixelType::Gray32Float:
+            data_type.code = kDLFloat; data_type.bits = 32; number_of_channels = 1;
+            return true;
+        case PixelType::Gray64Float:
+            data_type.code = kDLFloat; data_type.bits = 64; number_of_channels = 1;
+            return true;
+        case PixelType::Bgr24:
+            data_type.code = kDLUInt; data_type.bits = 8; number_of_channels = 3;
+            return true;
+        case PixelType::Bgr48:
+            data_type.code = kDLUInt; data_type.bits = 16; number_of_channels = 3;
+            return true;
+        case PixelType::Bgr96Float:
+            data_type.code = kDLFloat; data_type.bits = 32; number_of_channels = 3;
+            return true;
+        case PixelType::Bgra32:
+            data_type.code = kDLUInt; data_type.bits = 8; number_of_channels = 4;
+            return true;
+        case PixelType::Gray64ComplexFloat:
+            // 16 bytes per pixel, i.e. a pair of doubles
+            data_type.code = kDLComplex; data_type.bits = 128; number_of_channels = 1;
+            return true;
+        case PixelType::Bgr192ComplexFloat:
+            // 24 bytes per pixel, i.e. three pairs of floats
+            data_type.code = kDLComplex; data_type.bits = 64; number_of_channels = 3;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /// The private data of the schemas (the root as well as the children) we export.
+    struct ArrowSchemaPrivateData
+    {
+        string format;
+        string name;
+        vector<unique_ptr<ArrowSchema>> children;
+        vector<ArrowSchema*> children_pointers;
+    };
+
+    /// The private data of the arrays (the root as well as the children) we export.
+    struct ArrowArrayPrivateData
+    {
+        shared_ptr<void> data;
+        vector<uint8_t> validity;
+        vector<const void*> buffers;
+        vector<unique_ptr<ArrowArray>> children;
+        vector<ArrowArray*> children_pointers;
+    };
+
+    void ReleaseArrowSchema(ArrowSchema* schema)
+    {
+        auto private_data = static_cast<ArrowSchemaPrivateData*>(schema->private_data);
+        for (auto child : private_data->children_pointers)
+        {
+            // a child may have been moved by the consumer, in which case its release-callback is null
+            if (child->release != nullptr)
+            {
+                child->release(child);
+            }
+        }
+
+        delete private_data;
+        schema->release = nullptr;
+    }
+
+    void ReleaseArrowArray(ArrowArray* array)
+    {
+        auto private_data = static_cast<ArrowArrayPrivateData*>(array->private_data);
+        for (auto child : private_data->children_pointers)
+        {
+            if (child->release != nullptr)
+            {
+                child->release(child);
+            }
+        }
+
+        delete private_data;
+        array->release = nullptr;
+    }
+
+    /// A column of the table to be exported.
+    struct ArrowColumn
+    {
+        const char* name;
+        const char* format;
+        bool nullable;
+        shared_ptr<void> data;
+        vector<uint8_t> validity;
+        int64_t null_count;
+    };
+
+    /// Creates a column from the specified sub-blocks.
+    ///
+    /// \tparam t       The type of the elements of the column.
+    /// \tparam tGetter The type of the getter-functor. It is called with a sub-block and must return true if the value is valid (and
+    ///                 put it into its second argument), or false if the value is null.
+    template <typename t, typename tGetter>
+    ArrowColumn CreateArrowColumn(const char* name, const char* format, bool nullable, const vector<pair<int, DirectorySubBlockInfo>>& sub_blocks, tGetter getter)
+    {
+        ArrowColumn column;
+        column.name = name;
+        column.format = format;
+        column.nullable = nullable;
+        column.null_count = 0;
+
+        auto values = make_shared<vector<t>>(sub_blocks.size());
+        vector<uint8_t> validity((sub_blocks.size() + 7) / 8, 0);
+        for (size_t i = 0; i < sub_blocks.size(); ++i)
+        {
+            if (getter(sub_blocks[i], (*values)[i]))
+            {
+                validity[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+            }
+            else
+            {
+                (*values)[i] = t{};
+                ++column.null_count;
+            }
+        }
+
+        if (column.null_count > 0)
+        {
+            // if there are no nulls, then the validity-bitmap may be omitted
+            column.validity = std::move(validity);
+        }
+
+        column.data = shared_ptr<void>(values, values->data());
+        return column;
+    }
+}
+
+/*static*/DLManagedTensor* ExportHelpers::CreateDLManagedTensor(const std::shared_ptr<libCZI::IBitmapData>& bitmap)
+{
+    DLDataType data_type;
+    int number_of_channels;
+    if (!TryGetDLDataTypeForPixelType(bitmap->GetPixelType(), data_type, number_of_channels))
+    {
+        ostringstream string_stream;
+        string_stream << "The pixel type \"" << Utils::PixelTypeToInformalString(bitmap->GetPixelType()) << "\" cannot be exported as DLPack-tensor.";
+        throw invalid_argument(string_stream.str());
+    }
+
+    unique_ptr<DLManagedTensorContext> context(new DLManagedTensorContext());
+    context->bitmap = bitmap;
+    const auto size = bitmap->GetSize();
+
+    const BitmapLockInfo lock_info = bitmap->Lock();
+    const uint32_t bytes_per_element = data_type.bits / 8;
+    if (lock_info.stride % bytes_per_element != 0)
+    {
+        bitmap->Unlock();
+        throw invalid_argument("The stride of the bitmap is not a multiple of the size of an element.");
+    }
+
+    DLTensor& tensor = context->managed_tensor.dl_tensor;
+    tensor.data = lock_info.ptrDataRoi;
+    tensor.device.device_type = kDLCPU;
+    tensor.device.device_id = 0;
+    tensor.ndim = number_of_channels == 1 ? 2 : 3;
+    tensor.dtype = data_type;
+    tensor.shape = context->shape;
+    tensor.strides = context->strides;
+    tensor.byte_offset = 0;
+    context->shape[0] = size.h;
+    context->shape[1] = size.w;
+    context->shape[2] = number_of_channels;
+    context->strides[0] = lock_info.stride / bytes_per_element;
+    context->strides[1] = number_of_channels;
+    context->strides[2] = 1;
+
+    context->managed_tensor.manager_ctx = context.get();
+    context->managed_tensor.deleter = [](DLManagedTensor* self)->void
+        {
+            auto context = static_cast<DLManagedTensorContext*>(self->manager_ctx);
+            context->bitmap->Unlock();
+            delete context;
+        };
+
+    return &context.release()->managed_tensor;
+}
+
+/*static*/void ExportHelpers::ExportSubBlockInfoAsArrow(const std::vector<std::pair<int, libCZI::DirectorySubBlockInfo>>& sub_blocks, ArrowSchema* schema, ArrowArray* array)
+{
+    vector<ArrowColumn> columns;
+    columns.emplace_back(CreateArrowColumn<int32_t>("index", "i", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool { value = sub_block.first; return true; }));
+
+    static const char* const kDimensionNames[] = { "Z", "C", "T", "R", "S", "I", "H", "V", "B" };
+    static_assert(sizeof(kDimensionNames) / sizeof(kDimensionNames[0]) == static_cast<int>(DimensionIndex::MaxDim) - static_cast<int>(DimensionIndex::MinDim) + 1, "The number of dimension names is not as expected.");
+    for (int i = static_cast<int>(DimensionIndex::MinDim); i <= static_cast<int>(DimensionIndex::MaxDim); ++i)
+    {
+        const auto dimension = static_cast<DimensionIndex>(i);
+        bool is_dimension_used = false;
+        for (const auto& sub_block : sub_blocks)
+        {
+            if (sub_block.second.coordinate.IsValid(dimension))
+            {
+                is_dimension_used = true;
+                break;
+            }
+        }
+
+        if (is_dimension_used)
+        {
+            columns.emplace_back(CreateArrowColumn<int32_t>(
+                kDimensionNames[i - static_cast<int>(DimensionIndex::MinDim)],
+                "i",
+                true,
+                sub_blocks,
+                [dimension](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool
+                {
+                    int position;
+                    const bool valid = sub_block.second.coordinate.TryGetPosition(dimension, &position);
+                    value = position;
+                    return valid;
+                }));
+        }
+    }
+
+    columns.emplace_back(CreateArrowColumn<int32_t>("logical_x", "i", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool { value = sub_block.second.logicalRect.x; return true; }));
+    columns.emplace_back(CreateArrowColumn<int32_t>("logical_y", "i", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool { value = sub_block.second.logicalRect.y; return true; }));
+    columns.emplace_back(CreateArrowColumn<int32_t>("logical_w", "i", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool { value = sub_block.second.logicalRect.w; return true; }));
+    columns.emplace_back(CreateArrowColumn<int32_t>("logical_h", "i", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool { value = sub_block.second.logicalRect.h; return true; }));
+    columns.emplace_back(CreateArrowColumn<int32_t>("physical_w", "i", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool { value = static_cast<int32_t>(sub_block.second.physicalSize.w); return true; }));
+    columns.emplace_back(CreateArrowColumn<int32_t>("physical_h", "i", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool { value = static_cast<int32_t>(sub_block.second.physicalSize.h); return true; }));
+    columns.emplace_back(CreateArrowColumn<int32_t>("m_index", "i", true, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool { value = sub_block.second.mIndex; return sub_block.second.IsMindexValid(); }));
+    columns.emplace_back(CreateArrowColumn<int32_t>("pixel_type", "i", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool { value = static_cast<int32_t>(sub_block.second.pixelType); return true; }));
+    columns.emplace_back(CreateArrowColumn<int32_t>("compression_mode_raw", "i", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, int32_t& value)->bool { value = sub_block.second.compressionModeRaw; return true; }));
+    columns.emplace_back(CreateArrowColumn<uint64_t>("file_position", "L", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, uint64_t& value)->bool { value = sub_block.second.filePosition; return true; }));
+    columns.emplace_back(CreateArrowColumn<uint8_t>("pyramid_type", "C", false, sub_blocks, [](const pair<int, DirectorySubBlockInfo>& sub_block, uint8_t& value)->bool { value = static_cast<uint8_t>(sub_block.second.pyramidType); return true; }));
+
+    // now, construct the schema and the array - first the root (which is a struct), then a child for each column. The root
+    //  is set up first, so that in case of an error we can use the release-callbacks in order to clean up.
+    auto schema_private_data = new ArrowSchemaPrivateData();
+    schema_private_data->format = "+s";
+    schema_private_data->children.reserve(columns.size());
+    schema_private_data->children_pointers.reserve(columns.size());
+    schema->format = schema_private_data->format.c_str();
+    schema->name = schema_private_data->name.c_str();
+    schema->metadata = nullptr;
+    schema->flags = 0;
+    schema->n_children = 0;
+    schema->children = nullptr;
+    schema->dictionary = nullptr;
+    schema->release = ReleaseArrowSchema;
+    schema->private_data = schema_private_data;
+
+    ArrowArrayPrivateData* array_private_data = nullptr;
+    try
+    {
+        array_private_data = new ArrowArrayPrivateData();
+    }
+    catch (...)
+    {
+        schema->release(schema);
+        throw;
+    }
+
+    array_private_data->buffers.push_back(nullptr);
+    array_private_data->children.reserve(columns.size());
+    array_private_data->children_pointers.reserve(columns.size());
+    array->length = static_cast<int64_t>(sub_blocks.size());
+    array->null_count = 0;
+    array->offset = 0;
+    array->n_buffers = 1;
+    array->n_children = 0;
+    array->buffers = array_private_data->buffers.data();
+    array->children = nullptr;
+    array->dictionary = nullptr;
+    array->release = ReleaseArrowArray;
+    array->private_data = array_private_data;
+
+    try
+    {
+        for (auto& column : columns)
+        {
+            unique_ptr<ArrowSchemaPrivateData> child_schema_private_data(new ArrowSchemaPrivateData());
+            child_schema_private_data->format = column.format;
+            child_schema_private_data->name = column.name;
+            unique_ptr<ArrowSchema> child_schema(new ArrowSchema());
+            child_schema->format = child_schema_private_data->format.c_str();
+            child_schema->name = child_schema_private_data->name.c_str();
+            child_schema->metadata = nullptr;
+            child_schema->flags = column.nullable ? ARROW_FLAG_NULLABLE : 0;
+            child_schema->n_children = 0;
+            child_schema->children = nullptr;
+            child_schema->dictionary = nullptr;
+            child_schema->release = ReleaseArrowSchema;
+            child_schema->private_data = child_schema_private_data.release();
+            schema_private_data->children_pointers.push_back(child_schema.get());
+            schema_private_data->children.push_back(std::move(child_schema));
+
+            unique_ptr<ArrowArrayPrivateData> child_array_private_data(new ArrowArrayPrivateData());
+            child_array_private_data->data = std::move(column.data);
+            child_array_private_data->validity = std::move(column.validity);
+            child_array_private_data->buffers.push_back(child_array_private_data->validity.empty() ? nullptr : child_array_private_data->validity.data());
+            child_array_private_data->buffers.push_back(child_array_private_data->data.get());
+            unique_ptr<ArrowArray> child_array(new ArrowArray());
+            child_array->length = static_cast<int64_t>(sub_blocks.size());
+            child_array->null_count = column.null_count;
+            child_array->offset = 0;
+            child_array->n_buffers = 2;
+            child_array->n_children = 0;
+            child_array->buffers = child_array_private_data->buffers.data();
+            child_array->children = nullptr;
+            child_array->dictionary = nullptr;
+            child_array->release = ReleaseArrowArray;
+            child_array->private_data = child_array_private_data.release();
+            array_private_data->children_pointers.push_back(child_array.get());
+            array_private_data->children.push_back(std::move(child_array));
+        }
+    }
+    catch (...)
+    {
+        schema->release(schema);
+        array->release(array);
+        throw;
+    }
+
+    schema->n_children = static_cast<int64_t>(schema_private_data->children_pointers.size());
+    schema->children = schema_private_data->children_pointers.data();
+    array->n_children = static_cast<int64_t>(array_private_data->children_pointers.size());
+    array->children = array_private_data->children_pointers.data();
+}
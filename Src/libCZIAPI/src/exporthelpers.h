@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <libCZI.h>
+#include "../inc/dlpack_arrow_interop.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+/// Here we gather the functionality for exporting data in the "DLPack"- and "Arrow C Data Interface"-format, which allows
+/// for consumers (like PyTorch, NumPy or PyArrow) to use the data without copying it.
+class ExportHelpers
+{
+public:
+    /// Creates a DLPack-tensor referring to the pixel data of the specified bitmap. The bitmap is kept locked (and alive) until
+    /// the deleter of the tensor is called. The shape of the tensor is (height, width) for grayscale pixel types, and
+    /// (height, width, number of channels) for color pixel types (where the channels are in the order B, G, R(, A)).
+    /// An invalid_argument exception is thrown if the pixel type is not supported or if the stride of the bitmap cannot
+    /// be expressed in units of the element type.
+    ///
+    /// \param  bitmap  The bitmap.
+    ///
+    /// \returns    The newly created DLPack-tensor.
+    static DLManagedTensor* CreateDLManagedTensor(const std::shared_ptr<libCZI::IBitmapData>& bitmap);
+
+    /// Exports the specified sub-block information as a table in the "Arrow C Data Interface"-format. The table is exported as
+    /// a struct-array, where each field is a column. Columns for the dimensions are only present if the dimension is used by
+    /// at least one sub-block, and they are nullable.
+    ///
+    /// \param          sub_blocks  The sub-blocks to export (the index of the sub-block and its information).
+    /// \param [out]    schema      The schema is put here. The caller is responsible for calling the release-callback.
+    /// \param [out]    array       The data is put here. The caller is responsible for calling the release-callback.
+    static void ExportSubBlockInfoAsArrow(const std::vector<std::pair<int, libCZI::DirectorySubBlockInfo>>& sub_blocks, ArrowSchema* schema, ArrowArray* array);
+};
@@ -9,9 +9,17 @@
 #include <libCZI.h>
 
 #include "parameterhelpers.h"
+#include "exporthelpers.h"
 
 #include <limits>
 #include <algorithm>
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 using namespace libCZI;
 using namespace std;
@@ -94,6 +102,41 @@ namespace
             destination.m_index = numeric_limits<int32_t>::min();
         }
     }
+
+    void CopyFromAccessorStatisticsToAccessorStatisticsInterop(const libCZI::AccessorStatistics& source, AccessorStatisticsInterop& destination)
+    {
+        destination.sub_blocks_enumerated = source.subBlocksEnumerated;
+        destination.sub_blocks_culled = source.subBlocksCulled;
+        destination.sub_blocks_read_from_stream = source.subBlocksReadFromStream;
+        destination.sub_blocks_from_cache = source.subBlocksFromCache;
+        destination.compressed_bytes_read = source.compressedBytesRead;
+        destination.enumerate_nanoseconds = source.enumerateNanoseconds;
+        destination.read_nanoseconds = source.readNanoseconds;
+        destination.decode_nanoseconds = source.decodeNanoseconds;
+        destination.scale_nanoseconds = source.scaleNanoseconds;
+        destination.total_nanoseconds = source.totalNanoseconds;
+    }
+
+    void CopyFromPerformanceCountersSnapshotToPerformanceCountersInterop(const libCZI::PerformanceCountersSnapshot& source, PerformanceCountersInterop& destination)
+    {
+        static_assert(kPerformanceCounterCount == static_cast<int32_t>(PerformanceCounter::Count), "the number of performance counters is found to differ from expectation");
+        static_assert(kPerformanceTimerCount == static_cast<int32_t>(PerformanceTimer::Count), "the number of performance timers is found to differ from expectation");
+        static_assert(kDurationHistogramBucketCount == DurationHistogram::kBucketCount, "the number of histogram buckets is found to differ from expectation");
+        for (int32_t i = 0; i < kPerformanceCounterCount; ++i)
+        {
+            destination.counters[i] = source.counters[i];
+        }
+
+        for (int32_t i = 0; i < kPerformanceTimerCount; ++i)
+        {
+            destination.timers[i].count = source.timers[i].count;
+            destination.timers[i].total_nanoseconds = source.timers[i].total_nanoseconds;
+            for (int32_t bucket = 0; bucket < kDurationHistogramBucketCount; ++bucket)
+            {
+                destination.timers[i].buckets[bucket] = source.timers[i].buckets[bucket];
+            }
+        }
+    }
 }
 
 void libCZI_Free(void* data)
@@ -387,6 +430,126 @@ LibCZIApiErrorCode libCZI_ReaderReadSubBlock(CziReaderObjectHandle reader_object
     }
 }
 
+LibCZIApiErrorCode libCZI_ReaderReadSubBlocks(CziReaderObjectHandle reader_object, std::int32_t count, const std::int32_t* indices, SubBlockObjectHandle* sub_block_objects, std::int32_t number_of_threads)
+{
+    if (reader_object == kInvalidObjectHandle || count < 0 || (count > 0 && (indices == nullptr || sub_block_objects == nullptr)))
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    auto shared_czi_reader_wrapping_object = reinterpret_cast<SharedPtrWrapper<ICZIReader>*>(reader_object);
+    if (!shared_czi_reader_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    fill(sub_block_objects, sub_block_objects + count, kInvalidObjectHandle);
+
+    ICZIReader* reader = shared_czi_reader_wrapping_object->shared_ptr_.get();
+
+    try
+    {
+        vector<shared_ptr<ISubBlock>> sub_blocks(count);
+
+        // the indices are handed out to the worker threads with an atomic counter, and processing stops at the first error
+        atomic<int32_t> next_index{ 0 };
+        atomic<LibCZIApiErrorCode> result{ LibCZIApi_ErrorCode_OK };
+        const auto worker = [&]()
+            {
+                for (;;)
+                {
+                    const int32_t index = next_index++;
+                    if (index >= count || result.load() != LibCZIApi_ErrorCode_OK)
+                    {
+                        break;
+                    }
+
+                    try
+                    {
+                        sub_blocks[index] = reader->ReadSubBlock(indices[index]);
+                    }
+                    catch (const std::bad_alloc&)
+                    {
+                        result = LibCZIApi_ErrorCode_OutOfMemory;
+                    }
+                    catch (const std::exception&)
+                    {
+                        result = LibCZIApi_ErrorCode_UnspecifiedError;
+                    }
+                }
+            };
+
+        if (number_of_threads <= 0)
+        {
+            number_of_threads = static_cast<int32_t>((std::max)(1u, thread::hardware_concurrency()));
+        }
+
+        number_of_threads = (std::min)(number_of_threads, count);
+
+        vector<thread> threads;
+        const auto join_threads = [&threads]()
+            {
+                for (auto& t : threads)
+                {
+                    t.join();
+                }
+            };
+
+        try
+        {
+            for (int32_t i = 1; i < number_of_threads; ++i)
+            {
+                threads.emplace_back(worker);
+            }
+        }
+        catch (...)
+        {
+            // setting the result to an error makes the threads which have been started already stop, and they
+            //  must be joined before the exception leaves this scope (otherwise the destructor of std::thread
+            //  terminates the process)
+            result = LibCZIApi_ErrorCode_UnspecifiedError;
+            join_threads();
+            throw;
+        }
+
+        // the calling thread takes part in the processing
+        worker();
+        join_threads();
+
+        if (result.load() != LibCZIApi_ErrorCode_OK)
+        {
+            return result.load();
+        }
+
+        vector<unique_ptr<SharedPtrWrapper<ISubBlock>>> wrapping_objects(count);
+        for (int32_t i = 0; i < count; ++i)
+        {
+            if (sub_blocks[i])
+            {
+                wrapping_objects[i].reset(new SharedPtrWrapper<ISubBlock>{ sub_blocks[i] });
+            }
+        }
+
+        for (int32_t i = 0; i < count; ++i)
+        {
+            if (wrapping_objects[i])
+            {
+                sub_block_objects[i] = reinterpret_cast<SubBlockObjectHandle>(wrapping_objects[i].release());
+            }
+        }
+
+        return LibCZIApi_ErrorCode_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return LibCZIApi_ErrorCode_OutOfMemory;
+    }
+    catch (const std::exception&)
+    {
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+}
+
 LibCZIApiErrorCode libCZI_ReaderGetMetadataSegment(CziReaderObjectHandle reader_object, MetadataSegmentObjectHandle* metadata_segment_object)
 {
     if (reader_object == kInvalidObjectHandle)
@@ -507,6 +670,31 @@ LibCZIApiErrorCode libCZI_ReaderReadAttachment(CziReaderObjectHandle reader_obje
     }
 }
 
+LibCZIApiErrorCode libCZI_ReaderGetPerformanceCounters(CziReaderObjectHandle reader_object, PerformanceCountersInterop* performance_counters)
+{
+    if (reader_object == kInvalidObjectHandle || performance_counters == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    auto shared_czi_reader_wrapping_object = reinterpret_cast<SharedPtrWrapper<ICZIReader>*>(reader_object);
+    if (!shared_czi_reader_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    try
+    {
+        const auto snapshot = shared_czi_reader_wrapping_object->shared_ptr_->GetPerformanceCounters();
+        CopyFromPerformanceCountersSnapshotToPerformanceCountersInterop(snapshot, *performance_counters);
+        return LibCZIApi_ErrorCode_OK;
+    }
+    catch (const std::exception&)
+    {
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+}
+
 LibCZIApiErrorCode libCZI_ReleaseReader(CziReaderObjectHandle reader_object)
 {
     if (reader_object == kInvalidObjectHandle)
@@ -654,6 +842,23 @@ LibCZIApiErrorCode libCZI_CreateInputStreamFromFileUTF8(const char* filename, In
 
 namespace
 {
+    /// Throws an exception reporting an error of an external input stream. If the error information contains an
+    /// error message, the message is included in the exception (and the memory of the message is freed).
+    ///
+    /// \param  error_info  Information describing the error.
+    [[noreturn]] void ThrowExternalInputStreamError(const ExternalStreamErrorInfoInterop& error_info)
+    {
+        if (error_info.error_message != kInvalidObjectHandle)
+        {
+            ostringstream error_message;
+            error_message << "Error reading from external input stream. Error code: " << error_info.error_code << ". Error message: \"" << reinterpret_cast<const char*>(error_info.error_message) << "\"";
+            libCZI_Free(reinterpret_cast<void*>(error_info.error_message));
+            throw runtime_error(error_message.str());
+        }
+
+        throw runtime_error("Error reading from external input stream.");
+    }
+
     /// This class implements the IStream-interface based on two externally provided
     /// functions.
     class InputStreamWrapper : public IStream
@@ -685,17 +890,7 @@ namespace
 
             if (return_code != 0)
             {
-                if (error_info.error_message != kInvalidObjectHandle)
-                {
-                    ostringstream error_message;
-                    error_message << "Error reading from external input stream. Error code: " << error_info.error_code << ". Error message: \"" << reinterpret_cast<const char*>(error_info.error_message) << "\"";
-                    libCZI_Free(reinterpret_cast<void*>(error_info.error_message));
-                    throw runtime_error(error_message.str());
-                }
-                else
-                {
-                    throw runtime_error("Error reading from external input stream.");
-                }
+                ThrowExternalInputStreamError(error_info);
             }
         }
 
@@ -705,6 +900,173 @@ namespace
         }
     };
 
+    /// The state of a read-request of an asynchronous external input stream. The host signals completion
+    /// with 'libCZI_CompleteExternalStreamRead'.
+    struct PendingExternalStreamRead
+    {
+        std::mutex mutex;
+        std::condition_variable completed_condition;
+        bool completed{ false };
+        bool failed{ false };
+        std::uint64_t bytes_read{ 0 };
+        ExternalStreamErrorInfoInterop error_info{};
+    };
+
+    /// The registry of the outstanding read-requests of asynchronous external input streams. The request-handle handed out
+    /// to the host is an opaque id (and not a pointer), so that a handle which is invalid, or which has been completed
+    /// already, is detected reliably (instead of dereferencing a dangling pointer).
+    class PendingExternalStreamReadRegistry
+    {
+    private:
+        std::mutex mutex_;
+        std::intptr_t next_id_{ 1 };
+        std::unordered_map<std::intptr_t, std::shared_ptr<PendingExternalStreamRead>> pending_reads_;
+    public:
+        static PendingExternalStreamReadRegistry& GetInstance()
+        {
+            static PendingExternalStreamReadRegistry instance;
+            return instance;
+        }
+
+        /// Adds the specified read-request to the registry.
+        ///
+        /// \param  pending_read    The read-request.
+        ///
+        /// \returns    The handle identifying the read-request.
+        ExternalStreamReadRequestHandle Add(std::shared_ptr<PendingExternalStreamRead> pending_read)
+        {
+            lock_guard<mutex> lock(this->mutex_);
+            const auto id = this->next_id_++;
+            this->pending_reads_.emplace(id, std::move(pending_read));
+            return static_cast<ExternalStreamReadRequestHandle>(id);
+        }
+
+        /// Removes the read-request with the specified handle from the registry.
+        ///
+        /// \param  request The handle of the read-request.
+        ///
+        /// \returns    The read-request if it was found; null otherwise.
+        std::shared_ptr<PendingExternalStreamRead> Remove(ExternalStreamReadRequestHandle request)
+        {
+            lock_guard<mutex> lock(this->mutex_);
+            const auto it = this->pending_reads_.find(static_cast<std::intptr_t>(request));
+            if (it == this->pending_reads_.end())
+            {
+                return nullptr;
+            }
+
+            auto pending_read = std::move(it->second);
+            this->pending_reads_.erase(it);
+            return pending_read;
+        }
+    };
+
+    /// This class implements the IStream-interface based on externally provided functions, where the
+    /// read-operation is started by calling a function, and the host signals completion later on (by
+    /// calling 'libCZI_CompleteExternalStreamRead'). The calling thread (a libCZI-thread) waits for the
+    /// completion, so that concurrent calls to "Read" result in multiple outstanding read-requests.
+    class AsyncInputStreamWrapper : public IStream
+    {
+    private:
+        ExternalAsyncInputStreamStructInterop external_async_input_stream_struct_;
+
+        std::mutex outstanding_reads_mutex_;
+        std::condition_variable outstanding_reads_condition_;
+        std::int32_t outstanding_reads_count_{ 0 };
+    public:
+        AsyncInputStreamWrapper(const ExternalAsyncInputStreamStructInterop& async_input_stream_struct)
+            : external_async_input_stream_struct_(async_input_stream_struct)
+        {
+        }
+
+        void Read(std::uint64_t offset, void* pv, std::uint64_t size, std::uint64_t* ptrBytesRead) override
+        {
+            if (ptrBytesRead != nullptr)
+            {
+                *ptrBytesRead = numeric_limits<uint64_t>::max();
+            }
+
+            this->AcquireReadSlot();
+
+            shared_ptr<PendingExternalStreamRead> pending_read;
+            ExternalStreamReadRequestHandle request;
+            try
+            {
+                pending_read = make_shared<PendingExternalStreamRead>();
+                request = PendingExternalStreamReadRegistry::GetInstance().Add(pending_read);
+            }
+            catch (...)
+            {
+                this->ReleaseReadSlot();
+                throw;
+            }
+
+            ExternalStreamErrorInfoInterop error_info = {};
+            auto return_code = this->external_async_input_stream_struct_.begin_read_function(
+                this->external_async_input_stream_struct_.opaque_handle1,
+                this->external_async_input_stream_struct_.opaque_handle2,
+                offset,
+                pv,
+                size,
+                request,
+                &error_info);
+
+            if (return_code != 0)
+            {
+                // the read-operation is considered not started, so a (erroneous) later completion of the request must
+                //  be rejected - this is ensured by removing it from the registry
+                PendingExternalStreamReadRegistry::GetInstance().Remove(request);
+                this->ReleaseReadSlot();
+                ThrowExternalInputStreamError(error_info);
+            }
+
+            {
+                unique_lock<mutex> lock(pending_read->mutex);
+                pending_read->completed_condition.wait(lock, [&pending_read]() { return pending_read->completed; });
+            }
+
+            this->ReleaseReadSlot();
+
+            if (pending_read->failed)
+            {
+                ThrowExternalInputStreamError(pending_read->error_info);
+            }
+
+            if (ptrBytesRead != nullptr)
+            {
+                *ptrBytesRead = pending_read->bytes_read;
+            }
+        }
+
+        ~AsyncInputStreamWrapper() override
+        {
+            this->external_async_input_stream_struct_.close_function(this->external_async_input_stream_struct_.opaque_handle1, this->external_async_input_stream_struct_.opaque_handle2);
+        }
+    private:
+        void AcquireReadSlot()
+        {
+            unique_lock<mutex> lock(this->outstanding_reads_mutex_);
+            if (this->external_async_input_stream_struct_.max_outstanding_reads > 0)
+            {
+                this->outstanding_reads_condition_.wait(
+                    lock,
+                    [this]() { return this->outstanding_reads_count_ < this->external_async_input_stream_struct_.max_outstanding_reads; });
+            }
+
+            ++this->outstanding_reads_count_;
+        }
+
+        void ReleaseReadSlot()
+        {
+            {
+                unique_lock<mutex> lock(this->outstanding_reads_mutex_);
+                --this->outstanding_reads_count_;
+            }
+
+            this->outstanding_reads_condition_.notify_one();
+        }
+    };
+
     /// This class implements the IOutputStream-interface based on two externally provided
     /// functions.
     class OutputStreamWrapper : public IOutputStream
@@ -776,6 +1138,63 @@ LibCZIApiErrorCode libCZI_CreateInputStreamFromExternal(const ExternalInputStrea
     return LibCZIApi_ErrorCode_OK;
 }
 
+LibCZIApiErrorCode libCZI_CreateInputStreamFromExternalAsync(const ExternalAsyncInputStreamStructInterop* external_async_input_stream_struct, InputStreamObjectHandle* stream_object)
+{
+    if (external_async_input_stream_struct == nullptr || stream_object == nullptr ||
+        external_async_input_stream_struct->begin_read_function == nullptr || external_async_input_stream_struct->close_function == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    *stream_object = kInvalidObjectHandle;
+
+    try
+    {
+        auto stream = make_shared<AsyncInputStreamWrapper>(*external_async_input_stream_struct);
+        auto shared_stream_wrapping_object = new SharedPtrWrapper<IStream>{ stream };
+        *stream_object = reinterpret_cast<InputStreamObjectHandle>(shared_stream_wrapping_object);
+        return LibCZIApi_ErrorCode_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return LibCZIApi_ErrorCode_OutOfMemory;
+    }
+    catch (const std::exception&)
+    {
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+}
+
+LibCZIApiErrorCode libCZI_CompleteExternalStreamRead(ExternalStreamReadRequestHandle request, std::uint64_t bytes_read, const ExternalStreamErrorInfoInterop* error_info)
+{
+    if (request == kInvalidObjectHandle)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    // the request is removed from the registry here, so a duplicate (or late) completion is reported as invalid handle
+    const auto pending_read = PendingExternalStreamReadRegistry::GetInstance().Remove(request);
+    if (!pending_read)
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    {
+        lock_guard<mutex> lock(pending_read->mutex);
+        pending_read->bytes_read = bytes_read;
+        if (error_info != nullptr)
+        {
+            pending_read->failed = true;
+            pending_read->error_info = *error_info;
+        }
+
+        pending_read->completed = true;
+    }
+
+    pending_read->completed_condition.notify_one();
+    return LibCZIApi_ErrorCode_OK;
+}
+
 LibCZIApiErrorCode libCZI_ReleaseInputStream(InputStreamObjectHandle stream_object)
 {
     if (stream_object == kInvalidObjectHandle)
@@ -956,24 +1375,252 @@ LibCZIApiErrorCode libCZI_TryGetSubBlockInfoForIndex(CziReaderObjectHandle reade
     }
 }
 
-//****************************************************************************************************
-
-LibCZIApiErrorCode libCZI_BitmapGetInfo(BitmapObjectHandle bitmap_object, BitmapInfoInterop* bitmap_info)
+namespace
 {
-    if (bitmap_object == kInvalidObjectHandle || bitmap_info == nullptr)
-    {
-        return LibCZIApi_ErrorCode_InvalidArgument;
-    }
-    auto shared_bitmap_wrapping_object = reinterpret_cast<SharedPtrWrapper<IBitmapData>*>(bitmap_object);
-    if (!shared_bitmap_wrapping_object->IsValid())
+    /// Query if the coordinate of a sub-block matches the plane coordinate, i.e. all dimensions given in the plane
+    /// coordinate must be present in the coordinate of the sub-block and have the same value.
+    bool IsInPlane(const IDimCoordinate& plane_coordinate, const IDimCoordinate& sub_block_coordinate)
     {
-        return LibCZIApi_ErrorCode_InvalidHandle;
+        for (int i = static_cast<int>(libCZI::DimensionIndex::MinDim); i <= static_cast<int>(libCZI::DimensionIndex::MaxDim); ++i)
+        {
+            int plane_value;
+            if (plane_coordinate.TryGetPosition(static_cast<DimensionIndex>(i), &plane_value))
+            {
+                int sub_block_value;
+                if (!sub_block_coordinate.TryGetPosition(static_cast<DimensionIndex>(i), &sub_block_value) || sub_block_value != plane_value)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
     }
 
-    const auto extent = shared_bitmap_wrapping_object->shared_ptr_->GetSize();
-    bitmap_info->pixelType = static_cast<int32_t>(shared_bitmap_wrapping_object->shared_ptr_->GetPixelType());
-    bitmap_info->width = extent.w;
-    bitmap_info->height = extent.h;
+    void CopyFromDirectorySubBlockInfoToColumns(int index, const DirectorySubBlockInfo& source, const SubBlockInfoColumnsInterop& columns, int row)
+    {
+        if (columns.index != nullptr)
+        {
+            columns.index[row] = index;
+        }
+
+        uint32_t dimensions_valid = 0;
+        for (int i = 0; i < kMaxDimensionCount; ++i)
+        {
+            int value;
+            if (source.coordinate.TryGetPosition(static_cast<DimensionIndex>(i + static_cast<int>(libCZI::DimensionIndex::MinDim)), &value))
+            {
+                dimensions_valid |= (1u << i);
+            }
+            else
+            {
+                value = numeric_limits<int32_t>::min();
+            }
+
+            if (columns.coordinate[i] != nullptr)
+            {
+                columns.coordinate[i][row] = value;
+            }
+        }
+
+        if (columns.dimensions_valid != nullptr)
+        {
+            columns.dimensions_valid[row] = dimensions_valid;
+        }
+
+        if (columns.logical_rect_x != nullptr)
+        {
+            columns.logical_rect_x[row] = source.logicalRect.x;
+        }
+
+        if (columns.logical_rect_y != nullptr)
+        {
+            columns.logical_rect_y[row] = source.logicalRect.y;
+        }
+
+        if (columns.logical_rect_w != nullptr)
+        {
+            columns.logical_rect_w[row] = source.logicalRect.w;
+        }
+
+        if (columns.logical_rect_h != nullptr)
+        {
+            columns.logical_rect_h[row] = source.logicalRect.h;
+        }
+
+        if (columns.physical_size_w != nullptr)
+        {
+            columns.physical_size_w[row] = static_cast<int32_t>(source.physicalSize.w);
+        }
+
+        if (columns.physical_size_h != nullptr)
+        {
+            columns.physical_size_h[row] = static_cast<int32_t>(source.physicalSize.h);
+        }
+
+        if (columns.m_index != nullptr)
+        {
+            columns.m_index[row] = source.IsMindexValid() ? source.mIndex : numeric_limits<int32_t>::min();
+        }
+
+        if (columns.pixel_type != nullptr)
+        {
+            columns.pixel_type[row] = static_cast<int32_t>(source.pixelType);
+        }
+
+        if (columns.compression_mode_raw != nullptr)
+        {
+            columns.compression_mode_raw[row] = source.compressionModeRaw;
+        }
+
+        if (columns.file_position != nullptr)
+        {
+            columns.file_position[row] = source.filePosition;
+        }
+
+        if (columns.pyramid_type != nullptr)
+        {
+            columns.pyramid_type[row] = static_cast<uint8_t>(source.pyramidType);
+        }
+    }
+}
+
+namespace
+{
+    /// Enumerates the sub-blocks of the specified reader, optionally filtered by a plane coordinate and a ROI.
+    ///
+    /// \param  reader              The reader.
+    /// \param  plane_coordinate    The plane coordinate to filter by (may be null).
+    /// \param  roi                 The ROI to filter by (may be null).
+    /// \param  func_enum           The functor which is called for each sub-block matching the filter.
+    void EnumerateSubBlocksInPlaneAndRoi(ICZIReader* reader, const CoordinateInterop* plane_coordinate, const IntRectInterop* roi, const std::function<void(int, const DirectorySubBlockInfo&)>& func_enum)
+    {
+        CDimCoordinate libczi_plane_coordinate;
+        if (plane_coordinate != nullptr)
+        {
+            libczi_plane_coordinate = ParameterHelpers::ConvertCoordinateInteropToDimCoordinate(*plane_coordinate);
+        }
+
+        IntRect libczi_roi{};
+        if (roi != nullptr)
+        {
+            libczi_roi = IntRect{ roi->x, roi->y, roi->w, roi->h };
+        }
+
+        reader->EnumerateSubBlocksEx(
+            [&](int index, const DirectorySubBlockInfo& info)->bool
+            {
+                if (plane_coordinate != nullptr && !IsInPlane(libczi_plane_coordinate, info.coordinate))
+                {
+                    return true;
+                }
+
+                if (roi != nullptr && !libczi_roi.IntersectsWith(info.logicalRect))
+                {
+                    return true;
+                }
+
+                func_enum(index, info);
+                return true;
+            });
+    }
+}
+
+LibCZIApiErrorCode libCZI_ReaderGetSubBlockInfoColumns(CziReaderObjectHandle reader_object, const CoordinateInterop* plane_coordinate, const IntRectInterop* roi, const SubBlockInfoColumnsInterop* columns, std::int32_t* count)
+{
+    if (reader_object == kInvalidObjectHandle || columns == nullptr || columns->capacity < 0 || count == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    auto shared_czi_reader_wrapping_object = reinterpret_cast<SharedPtrWrapper<ICZIReader>*>(reader_object);
+    if (!shared_czi_reader_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    try
+    {
+        int32_t number_of_matches = 0;
+        EnumerateSubBlocksInPlaneAndRoi(
+            shared_czi_reader_wrapping_object->shared_ptr_.get(),
+            plane_coordinate,
+            roi,
+            [&](int index, const DirectorySubBlockInfo& info)->void
+            {
+                if (number_of_matches < columns->capacity)
+                {
+                    CopyFromDirectorySubBlockInfoToColumns(index, info, *columns, number_of_matches);
+                }
+
+                ++number_of_matches;
+            });
+
+        *count = number_of_matches;
+        return LibCZIApi_ErrorCode_OK;
+    }
+    catch (const std::exception&)
+    {
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+}
+
+LibCZIApiErrorCode libCZI_ReaderExportSubBlockInfoAsArrow(CziReaderObjectHandle reader_object, const CoordinateInterop* plane_coordinate, const IntRectInterop* roi, ArrowSchema* schema, ArrowArray* array)
+{
+    if (reader_object == kInvalidObjectHandle || schema == nullptr || array == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    auto shared_czi_reader_wrapping_object = reinterpret_cast<SharedPtrWrapper<ICZIReader>*>(reader_object);
+    if (!shared_czi_reader_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    try
+    {
+        vector<pair<int, DirectorySubBlockInfo>> sub_blocks;
+        EnumerateSubBlocksInPlaneAndRoi(
+            shared_czi_reader_wrapping_object->shared_ptr_.get(),
+            plane_coordinate,
+            roi,
+            [&](int index, const DirectorySubBlockInfo& info)->void
+            {
+                sub_blocks.emplace_back(index, info);
+            });
+
+        ExportHelpers::ExportSubBlockInfoAsArrow(sub_blocks, schema, array);
+        return LibCZIApi_ErrorCode_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return LibCZIApi_ErrorCode_OutOfMemory;
+    }
+    catch (const std::exception&)
+    {
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+}
+
+//****************************************************************************************************
+
+LibCZIApiErrorCode libCZI_BitmapGetInfo(BitmapObjectHandle bitmap_object, BitmapInfoInterop* bitmap_info)
+{
+    if (bitmap_object == kInvalidObjectHandle || bitmap_info == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+    auto shared_bitmap_wrapping_object = reinterpret_cast<SharedPtrWrapper<IBitmapData>*>(bitmap_object);
+    if (!shared_bitmap_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    const auto extent = shared_bitmap_wrapping_object->shared_ptr_->GetSize();
+    bitmap_info->pixelType = static_cast<int32_t>(shared_bitmap_wrapping_object->shared_ptr_->GetPixelType());
+    bitmap_info->width = extent.w;
+    bitmap_info->height = extent.h;
 
     return LibCZIApi_ErrorCode_OK;
 }
@@ -1061,6 +1708,38 @@ LibCZIApiErrorCode libCZI_ReleaseBitmap(BitmapObjectHandle bitmap_object)
     return LibCZIApi_ErrorCode_OK;
 }
 
+LibCZIApiErrorCode libCZI_BitmapExportAsDLPack(BitmapObjectHandle bitmap_object, DLManagedTensor** managed_tensor)
+{
+    if (bitmap_object == kInvalidObjectHandle || managed_tensor == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    auto shared_bitmap_wrapping_object = reinterpret_cast<SharedPtrWrapper<IBitmapData>*>(bitmap_object);
+    if (!shared_bitmap_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    try
+    {
+        *managed_tensor = ExportHelpers::CreateDLManagedTensor(shared_bitmap_wrapping_object->shared_ptr_);
+        return LibCZIApi_ErrorCode_OK;
+    }
+    catch (const std::invalid_argument&)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return LibCZIApi_ErrorCode_OutOfMemory;
+    }
+    catch (const std::exception&)
+    {
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+}
+
 LibCZIApiErrorCode libCZI_BitmapCopyTo(BitmapObjectHandle bitmap_object, std::uint32_t width, std::uint32_t height, std::int32_t pixel_type, std::uint32_t stride, void* ptr)
 {
     if (bitmap_object == kInvalidObjectHandle || ptr == nullptr)
@@ -1909,7 +2588,182 @@ LibCZIApiErrorCode libCZI_SingleChannelTileAccessorCalcSize(SingleChannelScaling
     }
 }
 
+namespace
+{
+    /// This class implements the IBitmapData-interface for a memory buffer which is owned by the caller.
+    class ExternalBufferBitmap : public IBitmapData
+    {
+    private:
+        PixelType pixel_type_;
+        std::uint32_t width_;
+        std::uint32_t height_;
+        std::uint32_t stride_;
+        void* data_;
+        std::atomic<int> lock_count_{ 0 };
+    public:
+        ExternalBufferBitmap(PixelType pixel_type, std::uint32_t width, std::uint32_t height, std::uint32_t stride, void* data)
+            : pixel_type_(pixel_type), width_(width), height_(height), stride_(stride), data_(data)
+        {
+        }
+
+        PixelType GetPixelType() const override
+        {
+            return this->pixel_type_;
+        }
+
+        IntSize GetSize() const override
+        {
+            return IntSize{ this->width_, this->height_ };
+        }
+
+        BitmapLockInfo Lock() override
+        {
+            ++this->lock_count_;
+            BitmapLockInfo bitmap_lock_info;
+            bitmap_lock_info.ptrData = this->data_;
+            bitmap_lock_info.ptrDataRoi = this->data_;
+            bitmap_lock_info.stride = this->stride_;
+            bitmap_lock_info.size = static_cast<std::uint64_t>(this->stride_) * this->height_;
+            return bitmap_lock_info;
+        }
+
+        void Unlock() override
+        {
+            --this->lock_count_;
+        }
+
+        int GetLockCount() const override
+        {
+            return this->lock_count_.load();
+        }
+    };
+
+    /// Gets whether the field (of the extended accessor options) ending at the specified offset is within the
+    /// size of the structure given by the caller.
+    ///
+    /// \param  options_ex      The extended accessor options.
+    /// \param  end_of_field    The offset (in bytes) of the end of the field.
+    ///
+    /// \returns    True if the field is present; false otherwise.
+    bool IsFieldPresentInAccessorOptionsEx(const AccessorOptionsExInterop* options_ex, size_t end_of_field)
+    {
+        return options_ex->size_of_structure >= end_of_field;
+    }
+
+    /// Converts the accessor options (given as interop-structs) into the libCZI-options, and resolves the handle of the
+    /// sub-block cache (if specified).
+    ///
+    /// \param          options         The accessor options (which may be null).
+    /// \param          options_ex      The extended accessor options (which may be null).
+    /// \param [out]    libczi_options  The libCZI accessor options.
+    ///
+    /// \returns    An error-code indicating success or failure of the operation.
+    LibCZIApiErrorCode ConvertAccessorOptions(const AccessorOptionsInterop* options, const AccessorOptionsExInterop* options_ex, ISingleChannelScalingTileAccessor::Options& libczi_options)
+    {
+        libczi_options = ParameterHelpers::ConvertSingleChannelScalingTileAccessorOptionsInteropToLibCZI(options);
+        if (options_ex == nullptr)
+        {
+            return LibCZIApi_ErrorCode_OK;
+        }
+
+        if (options_ex->size_of_structure < sizeof(options_ex->size_of_structure))
+        {
+            return LibCZIApi_ErrorCode_InvalidArgument;
+        }
+
+        if (IsFieldPresentInAccessorOptionsEx(options_ex, offsetof(AccessorOptionsExInterop, sub_block_cache) + sizeof(options_ex->sub_block_cache)) &&
+            options_ex->sub_block_cache != kInvalidObjectHandle)
+        {
+            auto shared_sub_block_cache_wrapping_object = reinterpret_cast<SharedPtrWrapper<ISubBlockCache>*>(options_ex->sub_block_cache);
+            if (!shared_sub_block_cache_wrapping_object->IsValid())
+            {
+                return LibCZIApi_ErrorCode_InvalidHandle;
+            }
+
+            libczi_options.subBlockCache = shared_sub_block_cache_wrapping_object->shared_ptr_;
+        }
+
+        if (IsFieldPresentInAccessorOptionsEx(options_ex, offsetof(AccessorOptionsExInterop, only_use_sub_block_cache_for_compressed_data) + sizeof(options_ex->only_use_sub_block_cache_for_compressed_data)))
+        {
+            libczi_options.onlyUseSubBlockCacheForCompressedData = options_ex->only_use_sub_block_cache_for_compressed_data;
+        }
+
+        return LibCZIApi_ErrorCode_OK;
+    }
+
+    /// Gets the destination for the statistics of the request from the extended accessor options.
+    ///
+    /// \param  options_ex  The extended accessor options (which may be null).
+    ///
+    /// \returns    The destination for the statistics, or null if no statistics are requested.
+    AccessorStatisticsInterop* GetStatisticsFromAccessorOptionsEx(const AccessorOptionsExInterop* options_ex)
+    {
+        if (options_ex == nullptr ||
+            !IsFieldPresentInAccessorOptionsEx(options_ex, offsetof(AccessorOptionsExInterop, statistics) + sizeof(options_ex->statistics)))
+        {
+            return nullptr;
+        }
+
+        return options_ex->statistics;
+    }
+
+    /// Renders the specified tile into the specified caller-supplied buffer.
+    ///
+    /// \param  accessor        The accessor.
+    /// \param  coordinate      The plane coordinate.
+    /// \param  roi             The region of interest.
+    /// \param  zoom            The zoom factor.
+    /// \param  libczi_options  The accessor options.
+    /// \param  destination     The caller-supplied buffer.
+    ///
+    /// \returns    An error-code indicating success or failure of the operation.
+    LibCZIApiErrorCode SingleChannelTileAccessorGetIntoBuffer(ISingleChannelScalingTileAccessor* accessor, const CoordinateInterop& coordinate, const IntRectInterop& roi, float zoom, const ISingleChannelScalingTileAccessor::Options& libczi_options, const BitmapBufferInterop& destination)
+    {
+        if (destination.data == nullptr)
+        {
+            return LibCZIApi_ErrorCode_InvalidArgument;
+        }
+
+        try
+        {
+            const auto pixel_type = static_cast<PixelType>(destination.pixel_type);
+            const uint64_t line_length = static_cast<uint64_t>(Utils::GetBytesPerPixel(pixel_type)) * destination.width;
+            if (destination.stride < line_length)
+            {
+                return LibCZIApi_ErrorCode_InvalidArgument;
+            }
+
+            const auto libczi_coordinate = ParameterHelpers::ConvertCoordinateInteropToDimCoordinate(coordinate);
+            ExternalBufferBitmap destination_bitmap(pixel_type, destination.width, destination.height, destination.stride, destination.data);
+            accessor->Get(
+                &destination_bitmap,
+                IntRectAndFrameOfReference{ CZIFrameOfReference::RawSubBlockCoordinateSystem, IntRect{ roi.x, roi.y, roi.w, roi.h } },
+                &libczi_coordinate,
+                zoom,
+                &libczi_options);
+            return LibCZIApi_ErrorCode_OK;
+        }
+        catch (const std::invalid_argument&)
+        {
+            return LibCZIApi_ErrorCode_InvalidArgument;
+        }
+        catch (const std::bad_alloc&)
+        {
+            return LibCZIApi_ErrorCode_OutOfMemory;
+        }
+        catch (const std::exception&)
+        {
+            return LibCZIApi_ErrorCode_UnspecifiedError;
+        }
+    }
+}
+
 LibCZIApiErrorCode libCZI_SingleChannelTileAccessorGet(SingleChannelScalingTileAccessorObjectHandle accessor_object, const CoordinateInterop* coordinate, const IntRectInterop* roi, float zoom, const AccessorOptionsInterop* options, BitmapObjectHandle* bitmap_object)
+{
+    return libCZI_SingleChannelTileAccessorGetEx(accessor_object, coordinate, roi, zoom, options, nullptr, bitmap_object);
+}
+
+LibCZIApiErrorCode libCZI_SingleChannelTileAccessorGetEx(SingleChannelScalingTileAccessorObjectHandle accessor_object, const CoordinateInterop* coordinate, const IntRectInterop* roi, float zoom, const AccessorOptionsInterop* options, const AccessorOptionsExInterop* options_ex, BitmapObjectHandle* bitmap_object)
 {
     if (accessor_object == kInvalidObjectHandle || coordinate == nullptr || roi == nullptr || bitmap_object == nullptr)
     {
@@ -1924,11 +2778,27 @@ LibCZIApiErrorCode libCZI_SingleChannelTileAccessorGet(SingleChannelScalingTileA
 
     IntRect libczi_roi{ roi->x, roi->y, roi->w, roi->h };
     const auto libczi_coordinate = ParameterHelpers::ConvertCoordinateInteropToDimCoordinate(*coordinate);
-    const auto libczi_options = ParameterHelpers::ConvertSingleChannelScalingTileAccessorOptionsInteropToLibCZI(options);
+    ISingleChannelScalingTileAccessor::Options libczi_options;
+    const auto error_code = ConvertAccessorOptions(options, options_ex, libczi_options);
+    if (error_code != LibCZIApi_ErrorCode_OK)
+    {
+        return error_code;
+    }
+
+    AccessorStatistics statistics;
+    AccessorStatisticsInterop* statistics_interop = GetStatisticsFromAccessorOptionsEx(options_ex);
+    if (statistics_interop != nullptr)
+    {
+        libczi_options.statistics = &statistics;
+    }
 
     try
     {
         auto result_bitmap = shared_accessor_wrapping_object->shared_ptr_->Get(libczi_roi, &libczi_coordinate, zoom, &libczi_options);
+        if (libczi_options.statistics != nullptr)
+        {
+            CopyFromAccessorStatisticsToAccessorStatisticsInterop(statistics, *statistics_interop);
+        }
 
         auto shared_bitmap_wrapping_object = new SharedPtrWrapper<IBitmapData>{ result_bitmap };
         *bitmap_object = reinterpret_cast<BitmapObjectHandle>(shared_bitmap_wrapping_object);
@@ -1945,6 +2815,148 @@ LibCZIApiErrorCode libCZI_SingleChannelTileAccessorGet(SingleChannelScalingTileA
     }
 }
 
+LibCZIApiErrorCode libCZI_SingleChannelTileAccessorGetIntoBuffer(SingleChannelScalingTileAccessorObjectHandle accessor_object, const CoordinateInterop* coordinate, const IntRectInterop* roi, float zoom, const AccessorOptionsInterop* options, const AccessorOptionsExInterop* options_ex, const BitmapBufferInterop* destination)
+{
+    if (accessor_object == kInvalidObjectHandle || coordinate == nullptr || roi == nullptr || destination == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    auto shared_accessor_wrapping_object = reinterpret_cast<SharedPtrWrapper<ISingleChannelScalingTileAccessor>*>(accessor_object);
+    if (!shared_accessor_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    ISingleChannelScalingTileAccessor::Options libczi_options;
+    const auto error_code = ConvertAccessorOptions(options, options_ex, libczi_options);
+    if (error_code != LibCZIApi_ErrorCode_OK)
+    {
+        return error_code;
+    }
+
+    AccessorStatistics statistics;
+    AccessorStatisticsInterop* statistics_interop = GetStatisticsFromAccessorOptionsEx(options_ex);
+    if (statistics_interop != nullptr)
+    {
+        libczi_options.statistics = &statistics;
+    }
+
+    const auto result = SingleChannelTileAccessorGetIntoBuffer(shared_accessor_wrapping_object->shared_ptr_.get(), *coordinate, *roi, zoom, libczi_options, *destination);
+    if (result == LibCZIApi_ErrorCode_OK && libczi_options.statistics != nullptr)
+    {
+        CopyFromAccessorStatisticsToAccessorStatisticsInterop(statistics, *statistics_interop);
+    }
+
+    return result;
+}
+
+LibCZIApiErrorCode libCZI_SingleChannelTileAccessorGetBatch(SingleChannelScalingTileAccessorObjectHandle accessor_object, std::int32_t count, SingleChannelTileAccessorRequestInterop* requests, const AccessorOptionsInterop* options, const AccessorOptionsExInterop* options_ex, std::int32_t number_of_threads)
+{
+    if (accessor_object == kInvalidObjectHandle || count < 0 || (count > 0 && requests == nullptr))
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    auto shared_accessor_wrapping_object = reinterpret_cast<SharedPtrWrapper<ISingleChannelScalingTileAccessor>*>(accessor_object);
+    if (!shared_accessor_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    ISingleChannelScalingTileAccessor::Options libczi_options;
+    const auto error_code = ConvertAccessorOptions(options, options_ex, libczi_options);
+    if (error_code != LibCZIApi_ErrorCode_OK)
+    {
+        return error_code;
+    }
+
+    // the options are shared by all requests (which run concurrently), so the per-request statistics are not supported here
+    libczi_options.statistics = nullptr;
+    ISingleChannelScalingTileAccessor* accessor = shared_accessor_wrapping_object->shared_ptr_.get();
+
+    // a request which is not processed (because the operation is aborted) reports an error
+    for (int32_t i = 0; i < count; ++i)
+    {
+        requests[i].result = LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+
+    // the requests are handed out to the worker threads with an atomic counter, the options are shared (read-only) by all threads
+    atomic<int32_t> next_request_index{ 0 };
+    atomic<bool> abort_requested{ false };
+    const auto worker = [&]()
+        {
+            while (!abort_requested.load())
+            {
+                const int32_t index = next_request_index++;
+                if (index >= count)
+                {
+                    break;
+                }
+
+                SingleChannelTileAccessorRequestInterop& request = requests[index];
+                request.result = SingleChannelTileAccessorGetIntoBuffer(accessor, request.coordinate, request.roi, request.zoom, libczi_options, request.destination);
+            }
+        };
+
+    if (number_of_threads <= 0)
+    {
+        number_of_threads = static_cast<int32_t>((std::max)(1u, thread::hardware_concurrency()));
+    }
+
+    number_of_threads = (std::min)(number_of_threads, count);
+
+    vector<thread> threads;
+    const auto join_threads = [&threads]()
+        {
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+        };
+
+    // if starting a thread fails, then the threads which have been started already must be stopped and joined before
+    //  we return (otherwise the destructor of std::thread terminates the process, and the workers would access the
+    //  requests after we returned)
+    const auto abort_and_join_threads = [&]()
+        {
+            abort_requested.store(true);
+            join_threads();
+        };
+
+    try
+    {
+        for (int32_t i = 1; i < number_of_threads; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        abort_and_join_threads();
+        return LibCZIApi_ErrorCode_OutOfMemory;
+    }
+    catch (const std::exception&)
+    {
+        abort_and_join_threads();
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+
+    // the calling thread takes part in the processing
+    worker();
+    join_threads();
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        if (requests[i].result != LibCZIApi_ErrorCode_OK)
+        {
+            return requests[i].result;
+        }
+    }
+
+    return LibCZIApi_ErrorCode_OK;
+}
+
 LibCZIApiErrorCode libCZI_ReleaseCreateSingleChannelTileAccessor(SingleChannelScalingTileAccessorObjectHandle accessor_object)
 {
     if (accessor_object == kInvalidObjectHandle)
@@ -1965,6 +2977,176 @@ LibCZIApiErrorCode libCZI_ReleaseCreateSingleChannelTileAccessor(SingleChannelSc
 
 //****************************************************************************************************
 
+LibCZIApiErrorCode libCZI_CreateSubBlockCache(SubBlockCacheObjectHandle* sub_block_cache_object)
+{
+    if (sub_block_cache_object == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    try
+    {
+        auto sub_block_cache = libCZI::CreateSubBlockCache();
+        auto shared_sub_block_cache_wrapping_object = new SharedPtrWrapper<ISubBlockCache>{ sub_block_cache };
+        *sub_block_cache_object = reinterpret_cast<SubBlockCacheObjectHandle>(shared_sub_block_cache_wrapping_object);
+        return LibCZIApi_ErrorCode_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return LibCZIApi_ErrorCode_OutOfMemory;
+    }
+    catch (const std::exception&)
+    {
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+}
+
+LibCZIApiErrorCode libCZI_SubBlockCacheGetStatistics(SubBlockCacheObjectHandle sub_block_cache_object, std::uint8_t mask, SubBlockCacheStatisticsInterop* statistics)
+{
+    if (sub_block_cache_object == kInvalidObjectHandle || statistics == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    auto shared_sub_block_cache_wrapping_object = reinterpret_cast<SharedPtrWrapper<ISubBlockCache>*>(sub_block_cache_object);
+    if (!shared_sub_block_cache_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    std::uint8_t libczi_mask = 0;
+    if ((mask & kSubBlockCacheStatisticsMemoryUsage) != 0)
+    {
+        libczi_mask |= ISubBlockCacheStatistics::kMemoryUsage;
+    }
+
+    if ((mask & kSubBlockCacheStatisticsElementsCount) != 0)
+    {
+        libczi_mask |= ISubBlockCacheStatistics::kElementsCount;
+    }
+
+    try
+    {
+        const auto libczi_statistics = shared_sub_block_cache_wrapping_object->shared_ptr_->GetStatistics(libczi_mask);
+        statistics->validity_mask = 0;
+        statistics->memory_usage = 0;
+        statistics->elements_count = 0;
+        if ((libczi_statistics.validityMask & ISubBlockCacheStatistics::kMemoryUsage) != 0)
+        {
+            statistics->validity_mask |= kSubBlockCacheStatisticsMemoryUsage;
+            statistics->memory_usage = libczi_statistics.memoryUsage;
+        }
+
+        if ((libczi_statistics.validityMask & ISubBlockCacheStatistics::kElementsCount) != 0)
+        {
+            statistics->validity_mask |= kSubBlockCacheStatisticsElementsCount;
+            statistics->elements_count = libczi_statistics.elementsCount;
+        }
+
+        return LibCZIApi_ErrorCode_OK;
+    }
+    catch (const std::exception&)
+    {
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+}
+
+LibCZIApiErrorCode libCZI_SubBlockCachePrune(SubBlockCacheObjectHandle sub_block_cache_object, const SubBlockCachePruneOptionsInterop* prune_options)
+{
+    if (sub_block_cache_object == kInvalidObjectHandle || prune_options == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    auto shared_sub_block_cache_wrapping_object = reinterpret_cast<SharedPtrWrapper<ISubBlockCache>*>(sub_block_cache_object);
+    if (!shared_sub_block_cache_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    ISubBlockCacheControl::PruneOptions libczi_prune_options;
+    libczi_prune_options.maxMemoryUsage = prune_options->max_memory_usage;
+    libczi_prune_options.maxSubBlockCount = prune_options->max_sub_block_count;
+
+    try
+    {
+        shared_sub_block_cache_wrapping_object->shared_ptr_->Prune(libczi_prune_options);
+        return LibCZIApi_ErrorCode_OK;
+    }
+    catch (const std::exception&)
+    {
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+}
+
+LibCZIApiErrorCode libCZI_ReleaseSubBlockCache(SubBlockCacheObjectHandle sub_block_cache_object)
+{
+    if (sub_block_cache_object == kInvalidObjectHandle)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    auto shared_sub_block_cache_wrapping_object = reinterpret_cast<SharedPtrWrapper<ISubBlockCache>*>(sub_block_cache_object);
+    if (!shared_sub_block_cache_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    shared_sub_block_cache_wrapping_object->Invalidate();
+    delete shared_sub_block_cache_wrapping_object;
+    return LibCZIApi_ErrorCode_OK;
+}
+
+//****************************************************************************************************
+
+LibCZIApiErrorCode libCZI_GetGlobalPerformanceCounters(PerformanceCountersInterop* performance_counters)
+{
+    if (performance_counters == nullptr)
+    {
+        return LibCZIApi_ErrorCode_InvalidArgument;
+    }
+
+    CopyFromPerformanceCountersSnapshotToPerformanceCountersInterop(GetGlobalPerformanceCounters(), *performance_counters);
+    return LibCZIApi_ErrorCode_OK;
+}
+
+LibCZIApiErrorCode libCZI_ResetGlobalPerformanceCounters()
+{
+    ResetGlobalPerformanceCounters();
+    return LibCZIApi_ErrorCode_OK;
+}
+
+LibCZIApiErrorCode libCZI_SetChromeTraceEventSink(OutputStreamObjectHandle output_stream_object)
+{
+    if (output_stream_object == kInvalidObjectHandle)
+    {
+        SetTraceEventSink(nullptr);
+        return LibCZIApi_ErrorCode_OK;
+    }
+
+    auto shared_output_stream_wrapping_object = reinterpret_cast<SharedPtrWrapper<IOutputStream>*>(output_stream_object);
+    if (!shared_output_stream_wrapping_object->IsValid())
+    {
+        return LibCZIApi_ErrorCode_InvalidHandle;
+    }
+
+    try
+    {
+        SetTraceEventSink(CreateChromeTraceEventSink(shared_output_stream_wrapping_object->shared_ptr_));
+        return LibCZIApi_ErrorCode_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return LibCZIApi_ErrorCode_OutOfMemory;
+    }
+    catch (const std::exception&)
+    {
+        return LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+}
+
+//****************************************************************************************************
+
 LibCZIApiErrorCode libCZI_CompositorDoMultiChannelComposition(std::int32_t channelCount, const BitmapObjectHandle* source_bitmaps, const CompositionChannelInfoInterop* channel_info, BitmapObjectHandle* bitmap_object)
 {
     if (channelCount <= 0)
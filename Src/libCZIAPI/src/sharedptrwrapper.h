@@ -22,6 +22,7 @@ constexpr uint32_t kMagicISingleChannelScalingTileAccessor = 0xE34C94D7u;
 constexpr uint32_t kMagicICziMultiDimensionDocumentInfo = 0x3A4A3D7Au;
 constexpr uint32_t kMagicIDisplaySettings = 0xE67C5A4Cu;
 constexpr uint32_t kMagicIChannelDisplaySetting = 0x88265932u;
+constexpr uint32_t kMagicISubBlockCache = 0x5C1B7E3Du;
 
 // In this file we define a generic template class that can be used to wrap a shared pointer to an object.
 // This is used to provide a handle to an object, and we use a magic value to check if the handle is still valid.
@@ -218,3 +219,12 @@ struct SharedPtrWrapper<libCZI::IChannelDisplaySetting> : SharedPtrWrapperBase<l
         SharedPtrWrapperBase(std::move(shared_ptr)) {
     }
 };
+
+/// Partial template specialization for ISubBlockCache objects.
+template <>
+struct SharedPtrWrapper<libCZI::ISubBlockCache> : SharedPtrWrapperBase<libCZI::ISubBlockCache, kMagicISubBlockCache>
+{
+    explicit SharedPtrWrapper(std::shared_ptr<libCZI::ISubBlockCache> shared_ptr) :
+        SharedPtrWrapperBase(std::move(shared_ptr)) {
+    }
+};
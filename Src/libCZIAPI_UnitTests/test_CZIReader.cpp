@@ -9,8 +9,118 @@
 #include "utilities.h"
 #include "MemoryInputStream.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 using namespace std;
 
+namespace
+{
+    /// This class emulates a host serving the read-requests of an asynchronous external input stream - the requests
+    /// are queued, and they are completed on a separate thread.
+    class AsyncMemoryInputStreamHost
+    {
+    private:
+        struct ReadRequest
+        {
+            uint64_t offset;
+            void* pv;
+            uint64_t size;
+            ExternalStreamReadRequestHandle request;
+        };
+
+        MemoryInputStream memory_input_stream_;
+        mutex mutex_;
+        condition_variable condition_;
+        deque<ReadRequest> requests_;
+        bool terminate_{ false };
+        int outstanding_requests_{ 0 };
+        int max_outstanding_requests_{ 0 };
+        int total_requests_{ 0 };
+        ExternalStreamReadRequestHandle last_completed_request_{ kInvalidObjectHandle };
+        thread worker_thread_;
+    public:
+        AsyncMemoryInputStreamHost(const void* data, size_t size)
+            : memory_input_stream_(data, size), worker_thread_([this]() { this->Run(); })
+        {
+        }
+
+        ~AsyncMemoryInputStreamHost()
+        {
+            {
+                lock_guard<mutex> lock(this->mutex_);
+                this->terminate_ = true;
+            }
+
+            this->condition_.notify_all();
+            this->worker_thread_.join();
+        }
+
+        void BeginRead(uint64_t offset, void* pv, uint64_t size, ExternalStreamReadRequestHandle request)
+        {
+            {
+                lock_guard<mutex> lock(this->mutex_);
+                this->requests_.push_back(ReadRequest{ offset, pv, size, request });
+                ++this->outstanding_requests_;
+                ++this->total_requests_;
+                this->max_outstanding_requests_ = (std::max)(this->max_outstanding_requests_, this->outstanding_requests_);
+            }
+
+            this->condition_.notify_all();
+        }
+
+        int GetMaxOutstandingRequests()
+        {
+            lock_guard<mutex> lock(this->mutex_);
+            return this->max_outstanding_requests_;
+        }
+
+        int GetTotalRequests()
+        {
+            lock_guard<mutex> lock(this->mutex_);
+            return this->total_requests_;
+        }
+
+        ExternalStreamReadRequestHandle GetLastCompletedRequest()
+        {
+            lock_guard<mutex> lock(this->mutex_);
+            return this->last_completed_request_;
+        }
+    private:
+        void Run()
+        {
+            for (;;)
+            {
+                ReadRequest read_request;
+                {
+                    unique_lock<mutex> lock(this->mutex_);
+                    this->condition_.wait(lock, [this]() { return this->terminate_ || !this->requests_.empty(); });
+                    if (this->requests_.empty())
+                    {
+                        return;
+                    }
+
+                    read_request = this->requests_.front();
+                    this->requests_.pop_front();
+                    --this->outstanding_requests_;
+                }
+
+                uint64_t bytes_read = 0;
+                ExternalStreamErrorInfoInterop error_info = {};
+                const int32_t return_code = this->memory_input_stream_.Read(read_request.offset, read_request.pv, read_request.size, &bytes_read, &error_info);
+                libCZI_CompleteExternalStreamRead(read_request.request, bytes_read, return_code == 0 ? nullptr : &error_info);
+                {
+                    lock_guard<mutex> lock(this->mutex_);
+                    this->last_completed_request_ = read_request.request;
+                }
+            }
+        }
+    };
+}
+
 TEST(CZIAPI_Reader, ConstructExternalInputStreamAndOpenCZIAndCheck)
 {
     CziReaderObjectHandle reader_object;
@@ -306,3 +416,320 @@ TEST(CZIAPI_Reader, ConstructExternalInputStreamAndTryGetSubBlockInfoForIndex)
 
     ASSERT_EQ(1, input_stream_release_call_count) << "The 'external input-stream-object' is not released as expected.";
 }
+
+TEST(CZIAPI_Reader, ConstructMultiSceneCziAndGetSubBlockInfoColumns)
+{
+    map<int, Utilities::MosaicInfo> per_scene_mosaic_info
+    {
+        {0,{ 5,5,{ {0,0,1}, {10,10,2}, {10,0,3}, {0,10,4}} }},
+        {1,{ 3,3,{ {20,20,3}, {23,20,4}} }},
+        {2,{ 2,2,{ {30,30,5}} }}
+    };
+
+    auto czi_data = Utilities::CreateMultiSceneMosaicCzi(per_scene_mosaic_info);
+    auto memory_input_stream_handler_object = new MemoryInputStream(get<0>(czi_data).get(), get<1>(czi_data));
+
+    ExternalInputStreamStructInterop external_input_stream_struct = {};
+    external_input_stream_struct.opaque_handle1 = reinterpret_cast<uintptr_t>(memory_input_stream_handler_object);
+    external_input_stream_struct.read_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2, uint64_t offset, void* pv, uint64_t size, uint64_t* ptrBytesRead, ExternalStreamErrorInfoInterop* error_info) -> int32_t
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            return memory_input_stream_handler->Read(offset, pv, size, ptrBytesRead, error_info);
+        };
+    external_input_stream_struct.close_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2)->void
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            delete memory_input_stream_handler;
+        };
+
+    InputStreamObjectHandle stream_object;
+    LibCZIApiErrorCode error_code = libCZI_CreateInputStreamFromExternal(&external_input_stream_struct, &stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    CziReaderObjectHandle reader_object;
+    error_code = libCZI_CreateReader(&reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    ReaderOpenInfoInterop reader_open_info;
+    reader_open_info.streamObject = stream_object;
+    error_code = libCZI_ReaderOpen(reader_object, &reader_open_info);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseInputStream(stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    // with a capacity of zero, we only get the number of sub-blocks
+    SubBlockInfoColumnsInterop columns = {};
+    int32_t count = -1;
+    error_code = libCZI_ReaderGetSubBlockInfoColumns(reader_object, nullptr, nullptr, &columns, &count);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    ASSERT_EQ(count, 7);
+
+    vector<int32_t> index(count), scene(count), channel(count), x(count), y(count), w(count), physical_w(count), m_index(count), pixel_type(count);
+    vector<uint32_t> dimensions_valid(count);
+    vector<uint64_t> file_position(count);
+    columns.capacity = count;
+    columns.index = index.data();
+    columns.dimensions_valid = dimensions_valid.data();
+    columns.coordinate[kDimensionC - 1] = channel.data();
+    columns.coordinate[kDimensionS - 1] = scene.data();
+    columns.logical_rect_x = x.data();
+    columns.logical_rect_y = y.data();
+    columns.logical_rect_w = w.data();
+    columns.physical_size_w = physical_w.data();
+    columns.m_index = m_index.data();
+    columns.pixel_type = pixel_type.data();
+    columns.file_position = file_position.data();
+    error_code = libCZI_ReaderGetSubBlockInfoColumns(reader_object, nullptr, nullptr, &columns, &count);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    ASSERT_EQ(count, 7);
+
+    // compare the information in the columns with the information retrieved for the individual sub-blocks
+    for (int i = 0; i < count; ++i)
+    {
+        SubBlockInfoInterop info;
+        error_code = libCZI_TryGetSubBlockInfoForIndex(reader_object, index[i], &info);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+        EXPECT_EQ(dimensions_valid[i], (1u << (kDimensionC - 1)) | (1u << (kDimensionS - 1)));
+        EXPECT_EQ(channel[i], 0);
+        EXPECT_EQ(x[i], info.logical_rect.x);
+        EXPECT_EQ(y[i], info.logical_rect.y);
+        EXPECT_EQ(w[i], info.logical_rect.w);
+        EXPECT_EQ(physical_w[i], info.physical_size.w);
+        EXPECT_EQ(m_index[i], info.m_index);
+        EXPECT_EQ(pixel_type[i], info.pixel_type);
+        EXPECT_GT(file_position[i], 0u);
+
+        const libCZI::CDimCoordinate dim_coordinate = Utilities::ConvertCoordinateInterop(info.coordinate);
+        int scene_index;
+        ASSERT_TRUE(dim_coordinate.TryGetPosition(libCZI::DimensionIndex::S, &scene_index));
+        EXPECT_EQ(scene[i], scene_index);
+    }
+
+    // filter by plane - only scene 1
+    CoordinateInterop plane_coordinate = {};
+    plane_coordinate.dimensions_valid = (1u << (kDimensionS - 1));
+    plane_coordinate.value[0] = 1;
+    error_code = libCZI_ReaderGetSubBlockInfoColumns(reader_object, &plane_coordinate, nullptr, &columns, &count);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    ASSERT_EQ(count, 2);
+    EXPECT_EQ(scene[0], 1);
+    EXPECT_EQ(scene[1], 1);
+
+    // filter by ROI - only the sub-block at (0,0) intersects
+    IntRectInterop roi{ 0, 0, 5, 5 };
+    error_code = libCZI_ReaderGetSubBlockInfoColumns(reader_object, nullptr, &roi, &columns, &count);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    ASSERT_EQ(count, 1);
+    EXPECT_EQ(x[0], 0);
+    EXPECT_EQ(y[0], 0);
+    EXPECT_EQ(scene[0], 0);
+
+    // if the capacity is too small, the total number is reported nevertheless
+    columns.capacity = 2;
+    error_code = libCZI_ReaderGetSubBlockInfoColumns(reader_object, nullptr, nullptr, &columns, &count);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    ASSERT_EQ(count, 7);
+
+    error_code = libCZI_ReleaseReader(reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+}
+
+TEST(CZIAPI_Reader, ConstructMultiSceneCziAndExportSubBlockInfoAsArrow)
+{
+    map<int, Utilities::MosaicInfo> per_scene_mosaic_info
+    {
+        {0,{ 5,5,{ {0,0,1}, {10,10,2}, {10,0,3}, {0,10,4}} }},
+        {1,{ 3,3,{ {20,20,3}, {23,20,4}} }},
+        {2,{ 2,2,{ {30,30,5}} }}
+    };
+
+    auto czi_data = Utilities::CreateMultiSceneMosaicCzi(per_scene_mosaic_info);
+    auto memory_input_stream_handler_object = new MemoryInputStream(get<0>(czi_data).get(), get<1>(czi_data));
+
+    ExternalInputStreamStructInterop external_input_stream_struct = {};
+    external_input_stream_struct.opaque_handle1 = reinterpret_cast<uintptr_t>(memory_input_stream_handler_object);
+    external_input_stream_struct.read_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2, uint64_t offset, void* pv, uint64_t size, uint64_t* ptrBytesRead, ExternalStreamErrorInfoInterop* error_info) -> int32_t
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            return memory_input_stream_handler->Read(offset, pv, size, ptrBytesRead, error_info);
+        };
+    external_input_stream_struct.close_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2)->void
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            delete memory_input_stream_handler;
+        };
+
+    InputStreamObjectHandle stream_object;
+    LibCZIApiErrorCode error_code = libCZI_CreateInputStreamFromExternal(&external_input_stream_struct, &stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    CziReaderObjectHandle reader_object;
+    error_code = libCZI_CreateReader(&reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    ReaderOpenInfoInterop reader_open_info;
+    reader_open_info.streamObject = stream_object;
+    error_code = libCZI_ReaderOpen(reader_object, &reader_open_info);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseInputStream(stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    ArrowSchema schema = {};
+    ArrowArray array = {};
+    error_code = libCZI_ReaderExportSubBlockInfoAsArrow(reader_object, nullptr, nullptr, &schema, &array);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    ASSERT_NE(schema.release, nullptr);
+    ASSERT_NE(array.release, nullptr);
+
+    EXPECT_STREQ(schema.format, "+s");
+    ASSERT_EQ(array.length, 7);
+    ASSERT_EQ(schema.n_children, array.n_children);
+
+    // the document uses the dimensions C and S, so we expect columns for those (and only those) dimensions
+    map<string, int> column_index_by_name;
+    for (int i = 0; i < schema.n_children; ++i)
+    {
+        column_index_by_name[schema.children[i]->name] = i;
+        EXPECT_EQ(array.children[i]->length, 7);
+    }
+
+    EXPECT_EQ(column_index_by_name.count("C"), 1u);
+    EXPECT_EQ(column_index_by_name.count("S"), 1u);
+    EXPECT_EQ(column_index_by_name.count("Z"), 0u);
+    EXPECT_EQ(column_index_by_name.count("T"), 0u);
+
+    const ArrowArray* index_column = array.children[column_index_by_name["index"]];
+    const ArrowArray* scene_column = array.children[column_index_by_name["S"]];
+    const ArrowArray* x_column = array.children[column_index_by_name["logical_x"]];
+    const ArrowArray* m_index_column = array.children[column_index_by_name["m_index"]];
+    const ArrowArray* file_position_column = array.children[column_index_by_name["file_position"]];
+    EXPECT_STREQ(schema.children[column_index_by_name["file_position"]]->format, "L");
+    ASSERT_EQ(index_column->n_buffers, 2);
+    EXPECT_EQ(scene_column->null_count, 0);
+
+    for (int i = 0; i < 7; ++i)
+    {
+        const int32_t sub_block_index = static_cast<const int32_t*>(index_column->buffers[1])[i];
+        SubBlockInfoInterop info;
+        error_code = libCZI_TryGetSubBlockInfoForIndex(reader_object, sub_block_index, &info);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+        EXPECT_EQ(static_cast<const int32_t*>(x_column->buffers[1])[i], info.logical_rect.x);
+        EXPECT_EQ(static_cast<const int32_t*>(m_index_column->buffers[1])[i], info.m_index);
+        EXPECT_GT(static_cast<const uint64_t*>(file_position_column->buffers[1])[i], 0u);
+
+        const libCZI::CDimCoordinate dim_coordinate = Utilities::ConvertCoordinateInterop(info.coordinate);
+        int scene_index;
+        ASSERT_TRUE(dim_coordinate.TryGetPosition(libCZI::DimensionIndex::S, &scene_index));
+        EXPECT_EQ(static_cast<const int32_t*>(scene_column->buffers[1])[i], scene_index);
+    }
+
+    schema.release(&schema);
+    array.release(&array);
+    EXPECT_EQ(schema.release, nullptr);
+    EXPECT_EQ(array.release, nullptr);
+
+    // with a filter for scene 2, we expect a single row
+    CoordinateInterop plane_coordinate = {};
+    plane_coordinate.dimensions_valid = (1u << (kDimensionS - 1));
+    plane_coordinate.value[0] = 2;
+    error_code = libCZI_ReaderExportSubBlockInfoAsArrow(reader_object, &plane_coordinate, nullptr, &schema, &array);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    EXPECT_EQ(array.length, 1);
+    schema.release(&schema);
+    array.release(&array);
+
+    error_code = libCZI_ReleaseReader(reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+}
+
+TEST(CZIAPI_Reader, ConstructAsyncExternalInputStreamAndReadSubBlocksConcurrently)
+{
+    map<int, Utilities::MosaicInfo> per_scene_mosaic_info
+    {
+        {0,{ 5,5,{ {0,0,1}, {10,10,2}, {10,0,3}, {0,10,4}} }},
+        {1,{ 3,3,{ {20,20,3}, {23,20,4}} }},
+        {2,{ 2,2,{ {30,30,5}} }}
+    };
+
+    auto czi_data = Utilities::CreateMultiSceneMosaicCzi(per_scene_mosaic_info);
+    auto host = new AsyncMemoryInputStreamHost(get<0>(czi_data).get(), get<1>(czi_data));
+
+    ExternalAsyncInputStreamStructInterop external_async_input_stream_struct = {};
+    external_async_input_stream_struct.opaque_handle1 = reinterpret_cast<uintptr_t>(host);
+    external_async_input_stream_struct.max_outstanding_reads = 2;
+    external_async_input_stream_struct.begin_read_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2, uint64_t offset, void* pv, uint64_t size, ExternalStreamReadRequestHandle request, ExternalStreamErrorInfoInterop* error_info) -> int32_t
+        {
+            (void)opaque_handle2;
+            (void)error_info;
+            reinterpret_cast<AsyncMemoryInputStreamHost*>(opaque_handle1)->BeginRead(offset, pv, size, request);
+            return 0;
+        };
+    external_async_input_stream_struct.close_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2)->void
+        {
+            (void)opaque_handle1;
+            (void)opaque_handle2;
+        };
+
+    InputStreamObjectHandle stream_object;
+    LibCZIApiErrorCode error_code = libCZI_CreateInputStreamFromExternalAsync(&external_async_input_stream_struct, &stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    CziReaderObjectHandle reader_object;
+    error_code = libCZI_CreateReader(&reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    ReaderOpenInfoInterop reader_open_info;
+    reader_open_info.streamObject = stream_object;
+    error_code = libCZI_ReaderOpen(reader_object, &reader_open_info);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseInputStream(stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    const int32_t indices[] = { 0, 1, 2, 3, 4, 5, 6, 1000 };
+    constexpr int32_t count = sizeof(indices) / sizeof(indices[0]);
+    SubBlockObjectHandle sub_block_objects[count];
+    error_code = libCZI_ReaderReadSubBlocks(reader_object, count, indices, sub_block_objects, 4);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    for (int32_t i = 0; i < count - 1; ++i)
+    {
+        ASSERT_NE(sub_block_objects[i], kInvalidObjectHandle);
+
+        SubBlockInfoInterop sub_block_info;
+        error_code = libCZI_SubBlockGetInfo(sub_block_objects[i], &sub_block_info);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+        SubBlockInfoInterop sub_block_info_from_directory;
+        error_code = libCZI_TryGetSubBlockInfoForIndex(reader_object, indices[i], &sub_block_info_from_directory);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+        EXPECT_EQ(sub_block_info.logical_rect.x, sub_block_info_from_directory.logical_rect.x);
+        EXPECT_EQ(sub_block_info.logical_rect.y, sub_block_info_from_directory.logical_rect.y);
+
+        error_code = libCZI_ReleaseSubBlock(sub_block_objects[i]);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    }
+
+    // there is no sub-block with index 1000
+    EXPECT_EQ(sub_block_objects[count - 1], kInvalidObjectHandle);
+
+    error_code = libCZI_ReleaseReader(reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    EXPECT_GT(host->GetTotalRequests(), 0);
+    EXPECT_LE(host->GetMaxOutstandingRequests(), 2);
+    const auto last_completed_request = host->GetLastCompletedRequest();
+    delete host;
+
+    // a request-handle which is not valid (anymore) is to be rejected
+    error_code = libCZI_CompleteExternalStreamRead(kInvalidObjectHandle, 0, nullptr);
+    EXPECT_EQ(LibCZIApi_ErrorCode_InvalidArgument, error_code);
+    ASSERT_NE(last_completed_request, kInvalidObjectHandle);
+    error_code = libCZI_CompleteExternalStreamRead(last_completed_request, 0, nullptr);
+    EXPECT_EQ(LibCZIApi_ErrorCode_InvalidHandle, error_code);
+}
@@ -216,3 +216,491 @@ TEST(CZIAPI_Accessors, SingleChannelScalingTileAccessorScenario1)
     error_code = libCZI_ReleaseReader(reader_object);
     ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
 }
+
+TEST(CZIAPI_Accessors, SingleChannelScalingTileAccessorWithSubBlockCache)
+{
+    auto czi_data = CreateCziWithSingleSubBlockWithMask();
+
+    auto memory_input_stream_handler_object = new MemoryInputStream(get<0>(czi_data).get(), get<1>(czi_data));
+
+    ExternalInputStreamStructInterop external_input_stream_struct = {};
+    external_input_stream_struct.opaque_handle1 = reinterpret_cast<uintptr_t>(memory_input_stream_handler_object);
+    external_input_stream_struct.read_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2, uint64_t offset, void* pv, uint64_t size, uint64_t* ptrBytesRead, ExternalStreamErrorInfoInterop* error_info) -> int32_t
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            return memory_input_stream_handler->Read(offset, pv, size, ptrBytesRead, error_info);
+        };
+    external_input_stream_struct.close_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2)->void
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            delete memory_input_stream_handler;
+        };
+
+    InputStreamObjectHandle stream_object;
+    LibCZIApiErrorCode error_code = libCZI_CreateInputStreamFromExternal(&external_input_stream_struct, &stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    CziReaderObjectHandle reader_object;
+    error_code = libCZI_CreateReader(&reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    ReaderOpenInfoInterop reader_open_info;
+    reader_open_info.streamObject = stream_object;
+    error_code = libCZI_ReaderOpen(reader_object, &reader_open_info);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseInputStream(stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    SingleChannelScalingTileAccessorObjectHandle accessor_object;
+    error_code = libCZI_CreateSingleChannelTileAccessor(reader_object, &accessor_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    SubBlockCacheObjectHandle sub_block_cache_object = kInvalidObjectHandle;
+    error_code = libCZI_CreateSubBlockCache(&sub_block_cache_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    SubBlockCacheStatisticsInterop statistics = {};
+    error_code = libCZI_SubBlockCacheGetStatistics(sub_block_cache_object, kSubBlockCacheStatisticsMemoryUsage | kSubBlockCacheStatisticsElementsCount, &statistics);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    EXPECT_EQ(statistics.validity_mask, kSubBlockCacheStatisticsMemoryUsage | kSubBlockCacheStatisticsElementsCount);
+    EXPECT_EQ(statistics.elements_count, 0u);
+    EXPECT_EQ(statistics.memory_usage, 0u);
+
+    CoordinateInterop coordinate = {};
+    coordinate.dimensions_valid = kDimensionC;
+    coordinate.value[0] = 0; // C=0
+    IntRectInterop roi = {};
+    roi.x = 0;
+    roi.y = 0;
+    roi.w = 4;
+    roi.h = 4;
+
+    AccessorStatisticsInterop accessor_statistics = {};
+    AccessorOptionsExInterop accessor_options_ex = {};
+    accessor_options_ex.size_of_structure = sizeof(accessor_options_ex);
+    accessor_options_ex.sub_block_cache = sub_block_cache_object;
+    accessor_options_ex.only_use_sub_block_cache_for_compressed_data = false;  // the sub-block in the document is uncompressed
+    accessor_options_ex.statistics = &accessor_statistics;
+
+    // we do the same request twice - the first one populates the cache, the second one is served from the cache
+    for (int i = 0; i < 2; ++i)
+    {
+        BitmapObjectHandle bitmap_object = kInvalidObjectHandle;
+        error_code = libCZI_SingleChannelTileAccessorGetEx(accessor_object, &coordinate, &roi, 1.0f, nullptr, &accessor_options_ex, &bitmap_object);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+        EXPECT_EQ(accessor_statistics.sub_blocks_enumerated, 1u);
+        EXPECT_EQ(accessor_statistics.sub_blocks_read_from_stream, i == 0 ? 1u : 0u);
+        EXPECT_EQ(accessor_statistics.sub_blocks_from_cache, i == 0 ? 0u : 1u);
+        EXPECT_EQ(accessor_statistics.compressed_bytes_read, i == 0 ? 16u : 0u);
+
+        BitmapLockInfoInterop lock_info = {};
+        error_code = libCZI_BitmapLock(bitmap_object, &lock_info);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+        static const uint8_t expected_result[16] = { 1, 2, 3, 4 , 5, 6, 7, 8, 9, 10, 11, 12,13, 14, 15, 16 };
+        const uint8_t* line = static_cast<const uint8_t*>(lock_info.ptrDataRoi);
+        for (int y = 0; y < 4; ++y)
+        {
+            ASSERT_EQ(memcmp(line, expected_result + y * 4, 4), 0);
+            line += lock_info.stride;
+        }
+
+        error_code = libCZI_BitmapUnlock(bitmap_object);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+        error_code = libCZI_ReleaseBitmap(bitmap_object);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+        statistics = {};
+        error_code = libCZI_SubBlockCacheGetStatistics(sub_block_cache_object, kSubBlockCacheStatisticsMemoryUsage | kSubBlockCacheStatisticsElementsCount, &statistics);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+        EXPECT_EQ(statistics.elements_count, 1u);
+        EXPECT_GT(statistics.memory_usage, 0u);
+    }
+
+    // the extended options are size-prefixed, so a structure without its size is rejected
+    AccessorOptionsExInterop accessor_options_ex_without_size = accessor_options_ex;
+    accessor_options_ex_without_size.size_of_structure = 0;
+    BitmapObjectHandle bitmap_object = kInvalidObjectHandle;
+    error_code = libCZI_SingleChannelTileAccessorGetEx(accessor_object, &coordinate, &roi, 1.0f, nullptr, &accessor_options_ex_without_size, &bitmap_object);
+    EXPECT_EQ(LibCZIApi_ErrorCode_InvalidArgument, error_code);
+
+    SubBlockCachePruneOptionsInterop prune_options = {};
+    prune_options.max_memory_usage = 0;
+    prune_options.max_sub_block_count = 0;
+    error_code = libCZI_SubBlockCachePrune(sub_block_cache_object, &prune_options);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    statistics = {};
+    error_code = libCZI_SubBlockCacheGetStatistics(sub_block_cache_object, kSubBlockCacheStatisticsElementsCount, &statistics);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    EXPECT_EQ(statistics.validity_mask, kSubBlockCacheStatisticsElementsCount);
+    EXPECT_EQ(statistics.elements_count, 0u);
+
+    // the cache can be released independently of the accessor which has been using it
+    error_code = libCZI_ReleaseSubBlockCache(sub_block_cache_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseCreateSingleChannelTileAccessor(accessor_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseReader(reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+}
+
+TEST(CZIAPI_Accessors, SingleChannelScalingTileAccessorGetIntoBufferAndBatch)
+{
+    auto czi_data = CreateCziWithSingleSubBlockWithMask();
+
+    auto memory_input_stream_handler_object = new MemoryInputStream(get<0>(czi_data).get(), get<1>(czi_data));
+
+    ExternalInputStreamStructInterop external_input_stream_struct = {};
+    external_input_stream_struct.opaque_handle1 = reinterpret_cast<uintptr_t>(memory_input_stream_handler_object);
+    external_input_stream_struct.read_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2, uint64_t offset, void* pv, uint64_t size, uint64_t* ptrBytesRead, ExternalStreamErrorInfoInterop* error_info) -> int32_t
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            return memory_input_stream_handler->Read(offset, pv, size, ptrBytesRead, error_info);
+        };
+    external_input_stream_struct.close_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2)->void
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            delete memory_input_stream_handler;
+        };
+
+    InputStreamObjectHandle stream_object;
+    LibCZIApiErrorCode error_code = libCZI_CreateInputStreamFromExternal(&external_input_stream_struct, &stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    CziReaderObjectHandle reader_object;
+    error_code = libCZI_CreateReader(&reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    ReaderOpenInfoInterop reader_open_info;
+    reader_open_info.streamObject = stream_object;
+    error_code = libCZI_ReaderOpen(reader_object, &reader_open_info);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseInputStream(stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    SingleChannelScalingTileAccessorObjectHandle accessor_object;
+    error_code = libCZI_CreateSingleChannelTileAccessor(reader_object, &accessor_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    CoordinateInterop coordinate = {};
+    coordinate.dimensions_valid = kDimensionC;
+    coordinate.value[0] = 0; // C=0
+    IntRectInterop roi = {};
+    roi.x = 0;
+    roi.y = 0;
+    roi.w = 4;
+    roi.h = 4;
+
+    // render into a buffer with a stride larger than the line length, and check that the padding is not touched
+    static const uint8_t expected_result[16] = { 1, 2, 3, 4 , 5, 6, 7, 8, 9, 10, 11, 12,13, 14, 15, 16 };
+    uint8_t buffer[4 * 8];
+    memset(buffer, 0xaa, sizeof(buffer));
+    BitmapBufferInterop destination = {};
+    destination.width = 4;
+    destination.height = 4;
+    destination.pixel_type = 0; // Gray8
+    destination.stride = 8;
+    destination.data = buffer;
+    error_code = libCZI_SingleChannelTileAccessorGetIntoBuffer(accessor_object, &coordinate, &roi, 1.0f, nullptr, nullptr, &destination);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    for (int y = 0; y < 4; ++y)
+    {
+        ASSERT_EQ(memcmp(buffer + y * 8, expected_result + y * 4, 4), 0);
+        for (int x = 4; x < 8; ++x)
+        {
+            ASSERT_EQ(buffer[y * 8 + x], 0xaa);
+        }
+    }
+
+    // a buffer with a size not matching the ROI is rejected
+    destination.width = 3;
+    error_code = libCZI_SingleChannelTileAccessorGetIntoBuffer(accessor_object, &coordinate, &roi, 1.0f, nullptr, nullptr, &destination);
+    EXPECT_EQ(LibCZIApi_ErrorCode_InvalidArgument, error_code);
+
+    // now, a batch of requests - every request is for a 2x2 quadrant of the sub-block
+    const int kRequestCount = 4;
+    uint8_t batch_buffers[kRequestCount][4];
+    SingleChannelTileAccessorRequestInterop requests[kRequestCount] = {};
+    for (int i = 0; i < kRequestCount; ++i)
+    {
+        requests[i].coordinate = coordinate;
+        requests[i].roi.x = (i % 2) * 2;
+        requests[i].roi.y = (i / 2) * 2;
+        requests[i].roi.w = 2;
+        requests[i].roi.h = 2;
+        requests[i].zoom = 1.0f;
+        requests[i].destination.width = 2;
+        requests[i].destination.height = 2;
+        requests[i].destination.pixel_type = 0; // Gray8
+        requests[i].destination.stride = 2;
+        requests[i].destination.data = batch_buffers[i];
+        requests[i].result = LibCZIApi_ErrorCode_UnspecifiedError;
+    }
+
+    // the statistics are not supported for a batch, so they must be left untouched
+    AccessorStatisticsInterop accessor_statistics = {};
+    accessor_statistics.sub_blocks_enumerated = 0xcafe;
+    AccessorOptionsExInterop accessor_options_ex = {};
+    accessor_options_ex.size_of_structure = sizeof(accessor_options_ex);
+    accessor_options_ex.statistics = &accessor_statistics;
+    error_code = libCZI_SingleChannelTileAccessorGetBatch(accessor_object, kRequestCount, requests, nullptr, &accessor_options_ex, 2);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    EXPECT_EQ(accessor_statistics.sub_blocks_enumerated, 0xcafeu);
+    for (int i = 0; i < kRequestCount; ++i)
+    {
+        EXPECT_EQ(LibCZIApi_ErrorCode_OK, requests[i].result);
+        const int x = (i % 2) * 2;
+        const int y = (i / 2) * 2;
+        EXPECT_EQ(batch_buffers[i][0], expected_result[y * 4 + x]);
+        EXPECT_EQ(batch_buffers[i][1], expected_result[y * 4 + x + 1]);
+        EXPECT_EQ(batch_buffers[i][2], expected_result[(y + 1) * 4 + x]);
+        EXPECT_EQ(batch_buffers[i][3], expected_result[(y + 1) * 4 + x + 1]);
+    }
+
+    // a failing request is reported individually, and the other requests are still processed
+    requests[2].destination.data = nullptr;
+    error_code = libCZI_SingleChannelTileAccessorGetBatch(accessor_object, kRequestCount, requests, nullptr, nullptr, 0);
+    EXPECT_EQ(LibCZIApi_ErrorCode_InvalidArgument, error_code);
+    EXPECT_EQ(LibCZIApi_ErrorCode_OK, requests[0].result);
+    EXPECT_EQ(LibCZIApi_ErrorCode_OK, requests[1].result);
+    EXPECT_EQ(LibCZIApi_ErrorCode_InvalidArgument, requests[2].result);
+    EXPECT_EQ(LibCZIApi_ErrorCode_OK, requests[3].result);
+
+    error_code = libCZI_ReleaseCreateSingleChannelTileAccessor(accessor_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseReader(reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+}
+
+TEST(CZIAPI_Accessors, SingleChannelScalingTileAccessorAndExportAsDLPack)
+{
+    auto czi_data = CreateCziWithSingleSubBlockWithMask();
+
+    auto memory_input_stream_handler_object = new MemoryInputStream(get<0>(czi_data).get(), get<1>(czi_data));
+
+    ExternalInputStreamStructInterop external_input_stream_struct = {};
+    external_input_stream_struct.opaque_handle1 = reinterpret_cast<uintptr_t>(memory_input_stream_handler_object);
+    external_input_stream_struct.read_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2, uint64_t offset, void* pv, uint64_t size, uint64_t* ptrBytesRead, ExternalStreamErrorInfoInterop* error_info) -> int32_t
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            return memory_input_stream_handler->Read(offset, pv, size, ptrBytesRead, error_info);
+        };
+    external_input_stream_struct.close_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2)->void
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            delete memory_input_stream_handler;
+        };
+
+    InputStreamObjectHandle stream_object;
+    LibCZIApiErrorCode error_code = libCZI_CreateInputStreamFromExternal(&external_input_stream_struct, &stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    CziReaderObjectHandle reader_object;
+    error_code = libCZI_CreateReader(&reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    ReaderOpenInfoInterop reader_open_info;
+    reader_open_info.streamObject = stream_object;
+    error_code = libCZI_ReaderOpen(reader_object, &reader_open_info);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseInputStream(stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    SingleChannelScalingTileAccessorObjectHandle accessor_object;
+    error_code = libCZI_CreateSingleChannelTileAccessor(reader_object, &accessor_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    CoordinateInterop coordinate = {};
+    coordinate.dimensions_valid = kDimensionC;
+    coordinate.value[0] = 0; // C=0
+    IntRectInterop roi = {};
+    roi.x = 0;
+    roi.y = 0;
+    roi.w = 4;
+    roi.h = 4;
+
+    BitmapObjectHandle bitmap_object = kInvalidObjectHandle;
+    error_code = libCZI_SingleChannelTileAccessorGet(accessor_object, &coordinate, &roi, 1.0f, nullptr, &bitmap_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    DLManagedTensor* managed_tensor = nullptr;
+    error_code = libCZI_BitmapExportAsDLPack(bitmap_object, &managed_tensor);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    ASSERT_NE(managed_tensor, nullptr);
+
+    // the tensor keeps the bitmap alive, so we can release the bitmap object here already
+    error_code = libCZI_ReleaseBitmap(bitmap_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    const DLTensor& tensor = managed_tensor->dl_tensor;
+    EXPECT_EQ(tensor.device.device_type, kDLCPU);
+    ASSERT_EQ(tensor.ndim, 2);
+    EXPECT_EQ(tensor.dtype.code, kDLUInt);
+    EXPECT_EQ(tensor.dtype.bits, 8);
+    EXPECT_EQ(tensor.dtype.lanes, 1);
+    EXPECT_EQ(tensor.shape[0], 4);
+    EXPECT_EQ(tensor.shape[1], 4);
+    EXPECT_GE(tensor.strides[0], 4);
+    EXPECT_EQ(tensor.strides[1], 1);
+
+    static const uint8_t expected_result[16] = { 1, 2, 3, 4 , 5, 6, 7, 8, 9, 10, 11, 12,13, 14, 15, 16 };
+    for (int y = 0; y < 4; ++y)
+    {
+        const uint8_t* line = static_cast<const uint8_t*>(tensor.data) + tensor.byte_offset + y * tensor.strides[0];
+        ASSERT_EQ(memcmp(line, expected_result + y * 4, 4), 0);
+    }
+
+    managed_tensor->deleter(managed_tensor);
+
+    error_code = libCZI_ReleaseCreateSingleChannelTileAccessor(accessor_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseReader(reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+}
+
+TEST(CZIAPI_Accessors, SingleChannelScalingTileAccessorWithPerformanceCountersAndTraceEvents)
+{
+    auto czi_data = CreateCziWithSingleSubBlockWithMask();
+
+    auto memory_input_stream_handler_object = new MemoryInputStream(get<0>(czi_data).get(), get<1>(czi_data));
+
+    ExternalInputStreamStructInterop external_input_stream_struct = {};
+    external_input_stream_struct.opaque_handle1 = reinterpret_cast<uintptr_t>(memory_input_stream_handler_object);
+    external_input_stream_struct.read_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2, uint64_t offset, void* pv, uint64_t size, uint64_t* ptrBytesRead, ExternalStreamErrorInfoInterop* error_info) -> int32_t
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            return memory_input_stream_handler->Read(offset, pv, size, ptrBytesRead, error_info);
+        };
+    external_input_stream_struct.close_function = [](uintptr_t opaque_handle1, uintptr_t opaque_handle2)->void
+        {
+            (void)opaque_handle2;
+            auto memory_input_stream_handler = reinterpret_cast<MemoryInputStream*>(opaque_handle1);
+            delete memory_input_stream_handler;
+        };
+
+    InputStreamObjectHandle stream_object;
+    LibCZIApiErrorCode error_code = libCZI_CreateInputStreamFromExternal(&external_input_stream_struct, &stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    CziReaderObjectHandle reader_object;
+    error_code = libCZI_CreateReader(&reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    ReaderOpenInfoInterop reader_open_info;
+    reader_open_info.streamObject = stream_object;
+    error_code = libCZI_ReaderOpen(reader_object, &reader_open_info);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseInputStream(stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    SingleChannelScalingTileAccessorObjectHandle accessor_object;
+    error_code = libCZI_CreateSingleChannelTileAccessor(reader_object, &accessor_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    SubBlockCacheObjectHandle sub_block_cache_object = kInvalidObjectHandle;
+    error_code = libCZI_CreateSubBlockCache(&sub_block_cache_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    // direct the trace-events into a memory-stream
+    unique_ptr<MemoryOutputStream> trace_output_stream = make_unique<MemoryOutputStream>(0);
+    ExternalOutputStreamStructInterop external_output_stream_struct = {};
+    external_output_stream_struct.opaque_handle1 = reinterpret_cast<std::uintptr_t>(trace_output_stream.get());
+    external_output_stream_struct.write_function = [](std::uintptr_t opaque_handle1, std::uintptr_t opaque_handle2, std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* out_bytes_written, ExternalStreamErrorInfoInterop* error_info) -> std::int32_t
+        {
+            (void)opaque_handle2;
+            (void)error_info;
+            reinterpret_cast<MemoryOutputStream*>(opaque_handle1)->Write(offset, pv, size, out_bytes_written);
+            return 0;
+        };
+    external_output_stream_struct.close_function = [](std::uintptr_t opaque_handle1, std::uintptr_t opaque_handle2) -> void
+        {
+            (void)opaque_handle1;
+            (void)opaque_handle2;
+        };
+
+    OutputStreamObjectHandle output_stream_object = kInvalidObjectHandle;
+    error_code = libCZI_CreateOutputStreamFromExternal(&external_output_stream_struct, &output_stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    error_code = libCZI_SetChromeTraceEventSink(output_stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    error_code = libCZI_ReleaseOutputStream(output_stream_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ResetGlobalPerformanceCounters();
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    CoordinateInterop coordinate = {};
+    coordinate.dimensions_valid = kDimensionC;
+    coordinate.value[0] = 0; // C=0
+    IntRectInterop roi = {};
+    roi.x = 0;
+    roi.y = 0;
+    roi.w = 4;
+    roi.h = 4;
+
+    AccessorOptionsExInterop accessor_options_ex = {};
+    accessor_options_ex.size_of_structure = sizeof(accessor_options_ex);
+    accessor_options_ex.sub_block_cache = sub_block_cache_object;
+    accessor_options_ex.only_use_sub_block_cache_for_compressed_data = false;  // the sub-block in the document is uncompressed
+
+    // we do the same request twice (with a zoom other than 1, so that the sub-block is scaled) - the first one
+    // populates the cache, the second one is served from the cache
+    for (int i = 0; i < 2; ++i)
+    {
+        BitmapObjectHandle bitmap_object = kInvalidObjectHandle;
+        error_code = libCZI_SingleChannelTileAccessorGetEx(accessor_object, &coordinate, &roi, 0.5f, nullptr, &accessor_options_ex, &bitmap_object);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+        error_code = libCZI_ReleaseBitmap(bitmap_object);
+        ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    }
+
+    PerformanceCountersInterop global_performance_counters = {};
+    error_code = libCZI_GetGlobalPerformanceCounters(&global_performance_counters);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    EXPECT_EQ(global_performance_counters.counters[kPerformanceCounter_SubBlocksRead], 1u);
+    EXPECT_EQ(global_performance_counters.counters[kPerformanceCounter_SubBlockCacheMisses], 1u);
+    EXPECT_EQ(global_performance_counters.counters[kPerformanceCounter_SubBlockCacheHits], 1u);
+    EXPECT_EQ(global_performance_counters.timers[kPerformanceTimer_SingleChannelAccessorGet].count, 2u);
+    EXPECT_EQ(global_performance_counters.timers[kPerformanceTimer_NNResize].count, 2u);
+
+    PerformanceCountersInterop reader_performance_counters = {};
+    error_code = libCZI_ReaderGetPerformanceCounters(reader_object, &reader_performance_counters);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    EXPECT_EQ(reader_performance_counters.counters[kPerformanceCounter_SubBlocksRead], 1u);
+    EXPECT_GT(reader_performance_counters.counters[kPerformanceCounter_StreamReadCalls], 0u);
+    EXPECT_EQ(reader_performance_counters.timers[kPerformanceTimer_StreamRead].count, reader_performance_counters.counters[kPerformanceCounter_StreamReadCalls]);
+
+    // disabling tracing terminates the JSON array
+    error_code = libCZI_SetChromeTraceEventSink(kInvalidObjectHandle);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+    const string trace(trace_output_stream->GetDataC(), trace_output_stream->GetDataSize());
+    EXPECT_EQ(trace.substr(0, 2), "[\n");
+    EXPECT_EQ(trace.substr(trace.size() - 3), "\n]\n");
+    EXPECT_NE(trace.find("{\"name\":\"NNResize\""), string::npos);
+
+    error_code = libCZI_ReleaseSubBlockCache(sub_block_cache_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseCreateSingleChannelTileAccessor(accessor_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+
+    error_code = libCZI_ReleaseReader(reader_object);
+    ASSERT_EQ(LibCZIApi_ErrorCode_OK, error_code);
+}
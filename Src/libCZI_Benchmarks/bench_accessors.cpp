@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <benchmark/benchmark.h>
+#include "benchmark_utilities.h"
+
+using namespace libCZI;
+using namespace std;
+
+namespace
+{
+    /// Gets a reader for a (zstd1-compressed) document with 16x16 overlapping tiles of size 512x512. There are two
+    /// identical layers of those tiles, so that the tiles of the lower layer are completely overdrawn (and are
+    /// culled by the visibility check). The document is created once and then re-used.
+    shared_ptr<ICZIReader> GetReaderForOverlappingTilesDocument()
+    {
+        static const shared_ptr<CMemInputOutputStream> document = []()
+        {
+            SyntheticCziParameters parameters;
+            parameters.tile_width = parameters.tile_height = 512;
+            parameters.tiles_x = parameters.tiles_y = 16;
+            parameters.overlap = 64;
+            parameters.layers = 2;
+            parameters.compression_mode = CompressionMode::Zstd1;
+            return BenchmarkUtilities::CreateSyntheticCzi(parameters);
+        }();
+
+        auto reader = CreateCZIReader();
+        reader->Open(document);
+        return reader;
+    }
+}
+
+/// Get a viewport (of 1024x1024 pixels in the output) from the scaling-tile-accessor, with the zoom given
+/// in per-mille (range(0)), and with the visibility-check (range(1)) and a sub-block cache (range(2))
+/// enabled or disabled.
+static void BM_ScalingAccessorViewport(benchmark::State& state)
+{
+    const float zoom = static_cast<float>(state.range(0)) / 1000;
+    const auto reader = GetReaderForOverlappingTilesDocument();
+    const auto accessor = reader->CreateSingleChannelScalingTileAccessor();
+    const auto statistics = reader->GetStatistics();
+
+    ISingleChannelScalingTileAccessor::Options options;
+    options.Clear();
+    options.useVisibilityCheckOptimization = state.range(1) != 0;
+    if (state.range(2) != 0)
+    {
+        options.subBlockCache = CreateSubBlockCache();
+    }
+
+    // a viewport (in the center of the document) which results in an output of 1024x1024 pixels
+    const int roi_size = static_cast<int>(1024 / zoom);
+    const IntRect roi
+    {
+        statistics.boundingBoxLayer0Only.x + (statistics.boundingBoxLayer0Only.w - roi_size) / 2,
+        statistics.boundingBoxLayer0Only.y + (statistics.boundingBoxLayer0Only.h - roi_size) / 2,
+        roi_size,
+        roi_size
+    };
+
+    const CDimCoordinate plane_coordinate{ { DimensionIndex::C, 0 } };
+    AccessorStatistics accessor_statistics;
+    options.statistics = &accessor_statistics;
+    for (auto _ : state)
+    {
+        const auto bitmap = accessor->Get(roi, &plane_coordinate, zoom, &options);
+        benchmark::DoNotOptimize(bitmap.get());
+    }
+
+    state.counters["subblocks_read"] = accessor_statistics.subBlocksReadFromStream;
+    state.counters["subblocks_culled"] = accessor_statistics.subBlocksCulled;
+    state.counters["subblocks_from_cache"] = accessor_statistics.subBlocksFromCache;
+}
+
+BENCHMARK(BM_ScalingAccessorViewport)
+    ->ArgNames({ "zoom_permille", "visibility_check", "cache" })
+    ->ArgsProduct({ { 1000, 500, 250, 125 }, { 0, 1 }, { 0, 1 } })
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <benchmark/benchmark.h>
+#include "benchmark_utilities.h"
+#include <vector>
+
+using namespace libCZI;
+using namespace std;
+
+/// Scale a 1024x1024 bitmap with nearest-neighbor interpolation to a 512x512 bitmap (of the same pixel type). The
+/// number of items processed is the number of destination pixels.
+static void BM_NNResize(benchmark::State& state, PixelType pixel_type)
+{
+    const auto source = BenchmarkUtilities::CreateBitmapWithPattern(pixel_type, 1024, 1024);
+    const auto destination = GetDefaultSiteObject(SiteObjectType::Default)->CreateBitmap(pixel_type, 512, 512);
+    const DblRect roi_source{ 0, 0, 1024, 1024 };
+    const DblRect roi_destination{ 0, 0, 512, 512 };
+    for (auto _ : state)
+    {
+        libCZI::detail::CBitmapOperations::NNResize(source.get(), destination.get(), roi_source, roi_destination);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * 512 * 512);
+}
+
+BENCHMARK_CAPTURE(BM_NNResize, gray8, PixelType::Gray8)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_NNResize, gray16, PixelType::Gray16)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_NNResize, gray32float, PixelType::Gray32Float)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_NNResize, bgr24, PixelType::Bgr24)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_NNResize, bgr48, PixelType::Bgr48)->Unit(benchmark::kMicrosecond);
+
+/// Compose the specified number of channels (of the specified pixel type, with tinting) into a Bgr24 bitmap of
+/// size 1024x1024. The number of items processed is the number of destination pixels.
+static void BM_ComposeMultiChannel(benchmark::State& state, PixelType pixel_type)
+{
+    const int channel_count = static_cast<int>(state.range(0));
+    static const Rgb8Color tinting_colors[] = { { 0xff, 0, 0 }, { 0, 0xff, 0 }, { 0, 0, 0xff }, { 0xff, 0xff, 0 } };
+    vector<shared_ptr<IBitmapData>> channels;
+    vector<IBitmapData*> channel_pointers;
+    vector<Compositors::ChannelInfo> channel_infos;
+    for (int c = 0; c < channel_count; ++c)
+    {
+        channels.emplace_back(BenchmarkUtilities::CreateBitmapWithPattern(pixel_type, 1024, 1024, c));
+        channel_pointers.emplace_back(channels.back().get());
+        Compositors::ChannelInfo channel_info;
+        channel_info.Clear();
+        channel_info.weight = 1;
+        channel_info.enableTinting = true;
+        channel_info.tinting.color = tinting_colors[c % (sizeof(tinting_colors) / sizeof(tinting_colors[0]))];
+        channel_info.blackPoint = 0.1f;
+        channel_info.whitePoint = 0.9f;
+        channel_infos.emplace_back(channel_info);
+    }
+
+    const auto destination = GetDefaultSiteObject(SiteObjectType::Default)->CreateBitmap(PixelType::Bgr24, 1024, 1024);
+    for (auto _ : state)
+    {
+        Compositors::ComposeMultiChannel_Bgr24(destination.get(), channel_count, channel_pointers.data(), channel_infos.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * 1024 * 1024);
+}
+
+BENCHMARK_CAPTURE(BM_ComposeMultiChannel, gray8, PixelType::Gray8)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ComposeMultiChannel, gray16, PixelType::Gray16)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMicrosecond);
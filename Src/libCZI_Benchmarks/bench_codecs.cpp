@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <benchmark/benchmark.h>
+#include "benchmark_utilities.h"
+
+using namespace libCZI;
+using namespace std;
+
+namespace
+{
+    constexpr uint32_t kCodecBitmapWidth = 1024;
+    constexpr uint32_t kCodecBitmapHeight = 1024;
+
+    ImageDecoderType GetDecoderType(CompressionMode compression_mode)
+    {
+        switch (compression_mode)
+        {
+        case CompressionMode::Zstd0:
+            return ImageDecoderType::ZStd0;
+        case CompressionMode::Zstd1:
+            return ImageDecoderType::ZStd1;
+        case CompressionMode::JpgXr:
+        default:
+            return ImageDecoderType::JPXR_JxrLib;
+        }
+    }
+
+    void SetBytesProcessed(benchmark::State& state, PixelType pixel_type)
+    {
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * kCodecBitmapWidth * kCodecBitmapHeight * Utils::GetBytesPerPixel(pixel_type));
+    }
+}
+
+/// Compress a bitmap with the specified compression mode. The throughput is given in terms of uncompressed bytes.
+static void BM_Encode(benchmark::State& state, CompressionMode compression_mode, PixelType pixel_type)
+{
+    const auto bitmap = BenchmarkUtilities::CreateBitmapWithPattern(pixel_type, kCodecBitmapWidth, kCodecBitmapHeight);
+    size_t compressed_size = 0;
+    for (auto _ : state)
+    {
+        const auto compressed = BenchmarkUtilities::CompressBitmap(bitmap.get(), compression_mode);
+        compressed_size = compressed->GetSizeOfData();
+        benchmark::DoNotOptimize(compressed->GetPtr());
+    }
+
+    SetBytesProcessed(state, pixel_type);
+    state.counters["compressed_size"] = static_cast<double>(compressed_size);
+}
+
+/// Decompress a bitmap with the decoder of the default site-object. The throughput is given in terms of uncompressed bytes.
+static void BM_Decode(benchmark::State& state, CompressionMode compression_mode, PixelType pixel_type)
+{
+    const auto bitmap = BenchmarkUtilities::CreateBitmapWithPattern(pixel_type, kCodecBitmapWidth, kCodecBitmapHeight);
+    const auto compressed = BenchmarkUtilities::CompressBitmap(bitmap.get(), compression_mode);
+    const auto decoder = GetDefaultSiteObject(SiteObjectType::Default)->GetDecoder(GetDecoderType(compression_mode), nullptr);
+    for (auto _ : state)
+    {
+        const auto decoded = decoder->Decode(compressed->GetPtr(), compressed->GetSizeOfData(), pixel_type, kCodecBitmapWidth, kCodecBitmapHeight);
+        benchmark::DoNotOptimize(decoded.get());
+    }
+
+    SetBytesProcessed(state, pixel_type);
+}
+
+BENCHMARK_CAPTURE(BM_Encode, zstd0_gray8, CompressionMode::Zstd0, PixelType::Gray8)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Encode, zstd0_gray16, CompressionMode::Zstd0, PixelType::Gray16)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Encode, zstd0_bgr24, CompressionMode::Zstd0, PixelType::Bgr24)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Encode, zstd1_gray8, CompressionMode::Zstd1, PixelType::Gray8)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Encode, zstd1_gray16, CompressionMode::Zstd1, PixelType::Gray16)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Encode, zstd1_bgr24, CompressionMode::Zstd1, PixelType::Bgr24)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Encode, jxr_gray8, CompressionMode::JpgXr, PixelType::Gray8)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Encode, jxr_gray16, CompressionMode::JpgXr, PixelType::Gray16)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Encode, jxr_bgr24, CompressionMode::JpgXr, PixelType::Bgr24)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_Decode, zstd0_gray8, CompressionMode::Zstd0, PixelType::Gray8)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Decode, zstd0_gray16, CompressionMode::Zstd0, PixelType::Gray16)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Decode, zstd0_bgr24, CompressionMode::Zstd0, PixelType::Bgr24)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Decode, zstd1_gray8, CompressionMode::Zstd1, PixelType::Gray8)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Decode, zstd1_gray16, CompressionMode::Zstd1, PixelType::Gray16)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Decode, zstd1_bgr24, CompressionMode::Zstd1, PixelType::Bgr24)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Decode, jxr_gray8, CompressionMode::JpgXr, PixelType::Gray8)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Decode, jxr_gray16, CompressionMode::JpgXr, PixelType::Gray16)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Decode, jxr_bgr24, CompressionMode::JpgXr, PixelType::Bgr24)->Unit(benchmark::kMillisecond);
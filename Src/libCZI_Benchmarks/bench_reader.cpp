@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <benchmark/benchmark.h>
+#include "benchmark_utilities.h"
+
+using namespace libCZI;
+using namespace std;
+
+namespace
+{
+    /// Gets a document with "tiles_per_side * tiles_per_side" small sub-blocks (so that the size of the sub-block
+    /// directory dominates). The documents are created once and then re-used.
+    shared_ptr<CMemInputOutputStream> GetDocumentWithManySubBlocks(int tiles_per_side)
+    {
+        static map<int, shared_ptr<CMemInputOutputStream>> documents;
+        auto& document = documents[tiles_per_side];
+        if (!document)
+        {
+            SyntheticCziParameters parameters;
+            parameters.tile_width = parameters.tile_height = 16;
+            parameters.tiles_x = parameters.tiles_y = static_cast<uint32_t>(tiles_per_side);
+            document = BenchmarkUtilities::CreateSyntheticCzi(parameters);
+        }
+
+        return document;
+    }
+}
+
+/// Open a document, i.e. parse the file-header and the sub-block directory.
+static void BM_ReaderOpen(benchmark::State& state)
+{
+    const int tiles_per_side = static_cast<int>(state.range(0));
+    const auto stream = GetDocumentWithManySubBlocks(tiles_per_side);
+    for (auto _ : state)
+    {
+        const auto reader = CreateCZIReader();
+        reader->Open(stream);
+        benchmark::DoNotOptimize(reader.get());
+    }
+
+    state.SetItemsProcessed(state.iterations() * tiles_per_side * tiles_per_side);
+    state.counters["subblocks"] = static_cast<double>(tiles_per_side * tiles_per_side);
+}
+
+BENCHMARK(BM_ReaderOpen)->Arg(16)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
+
+/// Enumerate the sub-blocks of a plane which intersect with a ROI (covering about a quarter of the plane).
+static void BM_ReaderEnumSubset(benchmark::State& state)
+{
+    const int tiles_per_side = static_cast<int>(state.range(0));
+    const auto reader = CreateCZIReader();
+    reader->Open(GetDocumentWithManySubBlocks(tiles_per_side));
+    const CDimCoordinate plane_coordinate{ { DimensionIndex::C, 0 } };
+    const IntRect roi{ tiles_per_side * 4, tiles_per_side * 4, tiles_per_side * 8, tiles_per_side * 8 };
+    int count = 0;
+    for (auto _ : state)
+    {
+        count = 0;
+        reader->EnumSubset(&plane_coordinate, &roi, true, [&](int, const SubBlockInfo&)->bool { ++count; return true; });
+        benchmark::DoNotOptimize(count);
+    }
+
+    state.counters["subblocks_found"] = count;
+}
+
+BENCHMARK(BM_ReaderEnumSubset)->Arg(16)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
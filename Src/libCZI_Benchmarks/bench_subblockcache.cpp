@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <benchmark/benchmark.h>
+#include "benchmark_utilities.h"
+#include <vector>
+
+using namespace libCZI;
+using namespace std;
+
+namespace
+{
+    constexpr int kCacheSubBlockCount = 1024;
+
+    /// Gets the cache which is shared by all threads of the benchmark "BM_SubBlockCacheContention". The cache
+    /// is pre-populated with "kCacheSubBlockCount" (small) bitmaps.
+    shared_ptr<ISubBlockCache> GetSharedCache()
+    {
+        static const shared_ptr<ISubBlockCache> cache = []()
+        {
+            auto sub_block_cache = CreateSubBlockCache();
+            const auto bitmap = BenchmarkUtilities::CreateBitmapWithPattern(PixelType::Gray8, 64, 64);
+            for (int i = 0; i < kCacheSubBlockCount; ++i)
+            {
+                sub_block_cache->Add(i, bitmap);
+            }
+
+            return sub_block_cache;
+        }();
+
+        return cache;
+    }
+}
+
+/// Concurrent access to a sub-block cache - every thread is doing lookups (for sub-blocks which are all present in
+/// the cache), and one out of eight operations is an Add-operation (replacing an existing entry).
+static void BM_SubBlockCacheContention(benchmark::State& state)
+{
+    const auto cache = GetSharedCache();
+    const auto bitmap = BenchmarkUtilities::CreateBitmapWithPattern(PixelType::Gray8, 64, 64, static_cast<uint32_t>(state.thread_index()));
+    uint32_t index = static_cast<uint32_t>(state.thread_index()) * 7919;
+    for (auto _ : state)
+    {
+        index = index * 1664525u + 1013904223u;
+        const int subblock_index = static_cast<int>((index >> 8) % kCacheSubBlockCount);
+        if ((index & 7) == 0)
+        {
+            cache->Add(subblock_index, bitmap);
+        }
+        else
+        {
+            auto item = cache->Get(subblock_index);
+            benchmark::DoNotOptimize(item.bitmap.get());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SubBlockCacheContention)->Threads(1)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark_utilities.h"
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace libCZI;
+using namespace std;
+
+/*static*/std::shared_ptr<libCZI::IBitmapData> BenchmarkUtilities::CreateBitmapWithPattern(libCZI::PixelType pixel_type, std::uint32_t width, std::uint32_t height, std::uint32_t seed)
+{
+    auto bitmap = GetDefaultSiteObject(SiteObjectType::Default)->CreateBitmap(pixel_type, width, height);
+    const uint8_t bytes_per_pixel = Utils::GetBytesPerPixel(pixel_type);
+    const bool is_16bit = pixel_type == PixelType::Gray16 || pixel_type == PixelType::Bgr48;
+
+    // a simple linear congruential generator is sufficient here (and gives reproducible results across platforms)
+    uint32_t state = seed * 2654435761u + 1;
+    ScopedBitmapLockerSP locker{ bitmap };
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        uint8_t* line = static_cast<uint8_t*>(locker.ptrDataRoi) + static_cast<size_t>(y) * locker.stride;
+        if (is_16bit)
+        {
+            uint16_t* line16 = reinterpret_cast<uint16_t*>(line);
+            const uint32_t samples = width * bytes_per_pixel / 2;
+            for (uint32_t i = 0; i < samples; ++i)
+            {
+                state = state * 1664525u + 1013904223u;
+                line16[i] = static_cast<uint16_t>(((i + y) * 16) + ((state >> 24) & 0x3f));
+            }
+        }
+        else
+        {
+            const uint32_t samples = width * bytes_per_pixel;
+            for (uint32_t i = 0; i < samples; ++i)
+            {
+                state = state * 1664525u + 1013904223u;
+                line[i] = static_cast<uint8_t>((i + y) / 4 + ((state >> 24) & 0x0f));
+            }
+        }
+    }
+
+    return bitmap;
+}
+
+/*static*/std::shared_ptr<libCZI::IMemoryBlock> BenchmarkUtilities::CompressBitmap(libCZI::IBitmapData* bitmap, libCZI::CompressionMode compression_mode)
+{
+    ScopedBitmapLockerP locker{ bitmap };
+    const auto allocate_temp_buffer = [](size_t size)->void* { return malloc(size); };
+    const auto free_temp_buffer = [](void* ptr)->void { free(ptr); };
+    switch (compression_mode)
+    {
+    case CompressionMode::Zstd0:
+        return ZstdCompress::CompressZStd0Alloc(bitmap->GetWidth(), bitmap->GetHeight(), locker.stride, bitmap->GetPixelType(), locker.ptrDataRoi, allocate_temp_buffer, free_temp_buffer, nullptr);
+    case CompressionMode::Zstd1:
+        return ZstdCompress::CompressZStd1Alloc(bitmap->GetWidth(), bitmap->GetHeight(), locker.stride, bitmap->GetPixelType(), locker.ptrDataRoi, allocate_temp_buffer, free_temp_buffer, nullptr);
+    case CompressionMode::JpgXr:
+        return JxrLibCompress::Compress(bitmap->GetPixelType(), bitmap->GetWidth(), bitmap->GetHeight(), locker.stride, locker.ptrDataRoi, nullptr);
+    default:
+        throw invalid_argument("unsupported compression mode");
+    }
+}
+
+/*static*/std::shared_ptr<CMemInputOutputStream> BenchmarkUtilities::CreateSyntheticCzi(const SyntheticCziParameters& parameters)
+{
+    const auto writer = CreateCZIWriter();
+    auto stream = make_shared<CMemInputOutputStream>(0);
+    const auto writer_info = make_shared<CCziWriterInfo>(
+        GUID{ 0x1234567,0x89ab,0xcdef,{ 1,2,3,4,5,6,7,8 } },
+        CDimBounds{ { DimensionIndex::C, 0, static_cast<int>(parameters.channel_count) } },
+        0,
+        static_cast<int>(parameters.tiles_x * parameters.tiles_y * parameters.layers - 1));
+    writer->Create(stream, writer_info);
+
+    // we use the same bitmap for all tiles of a channel, this makes creating large documents fast
+    for (uint32_t c = 0; c < parameters.channel_count; ++c)
+    {
+        const auto bitmap = BenchmarkUtilities::CreateBitmapWithPattern(parameters.pixel_type, parameters.tile_width, parameters.tile_height, c);
+        shared_ptr<IMemoryBlock> compressed_data;
+        if (parameters.compression_mode != CompressionMode::UnCompressed)
+        {
+            compressed_data = BenchmarkUtilities::CompressBitmap(bitmap.get(), parameters.compression_mode);
+        }
+
+        ScopedBitmapLockerSP locker{ bitmap };
+        int m_index = 0;
+        for (uint32_t layer = 0; layer < parameters.layers; ++layer)
+        {
+            for (uint32_t tile_y = 0; tile_y < parameters.tiles_y; ++tile_y)
+            {
+                for (uint32_t tile_x = 0; tile_x < parameters.tiles_x; ++tile_x)
+                {
+                    AddSubBlockInfoBase sub_block_info_base;
+                    sub_block_info_base.Clear();
+                    sub_block_info_base.coordinate.Set(DimensionIndex::C, static_cast<int>(c));
+                    sub_block_info_base.mIndexValid = true;
+                    sub_block_info_base.mIndex = m_index++;
+                    sub_block_info_base.x = static_cast<int>(tile_x * (parameters.tile_width - parameters.overlap));
+                    sub_block_info_base.y = static_cast<int>(tile_y * (parameters.tile_height - parameters.overlap));
+                    sub_block_info_base.logicalWidth = sub_block_info_base.physicalWidth = static_cast<int>(parameters.tile_width);
+                    sub_block_info_base.logicalHeight = sub_block_info_base.physicalHeight = static_cast<int>(parameters.tile_height);
+                    sub_block_info_base.PixelType = parameters.pixel_type;
+                    sub_block_info_base.SetCompressionMode(parameters.compression_mode);
+
+                    if (compressed_data)
+                    {
+                        AddSubBlockInfoMemPtr add_sub_block_info;
+                        static_cast<AddSubBlockInfoBase&>(add_sub_block_info) = sub_block_info_base;
+                        add_sub_block_info.ptrData = compressed_data->GetPtr();
+                        add_sub_block_info.dataSize = static_cast<uint32_t>(compressed_data->GetSizeOfData());
+                        writer->SyncAddSubBlock(add_sub_block_info);
+                    }
+                    else
+                    {
+                        AddSubBlockInfoStridedBitmap add_sub_block_info;
+                        static_cast<AddSubBlockInfoBase&>(add_sub_block_info) = sub_block_info_base;
+                        add_sub_block_info.ptrBitmap = locker.ptrDataRoi;
+                        add_sub_block_info.strideBitmap = locker.stride;
+                        writer->SyncAddSubBlock(add_sub_block_info);
+                    }
+                }
+            }
+        }
+    }
+
+    const auto metadata_builder = writer->GetPreparedMetadata(PrepareMetadataInfo{});
+    const auto& metadata_xml = metadata_builder->GetXml();
+    WriteMetadataInfo write_metadata_info;
+    write_metadata_info.Clear();
+    write_metadata_info.szMetadata = metadata_xml.c_str();
+    write_metadata_info.szMetadataSize = metadata_xml.size() + 1;
+    writer->SyncWriteMetadata(write_metadata_info);
+    writer->Close();
+    return stream;
+}
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "../libCZI/libCZI.h"
+#include "../libCZI_UnitTests/MemInputOutputStream.h"
+#include <cstdint>
+#include <memory>
+
+/// Parameters describing a synthetic CZI-document (created in memory). The document contains a grid of tiles
+/// (on pyramid-layer 0) for each channel, and the tiles are overlapping by the specified amount. The grid can be
+/// repeated (with increasing M-index), so that the tiles of the lower layers are completely overdrawn.
+struct SyntheticCziParameters
+{
+    std::uint32_t tile_width{ 256 };        ///< The width of a tile in pixels.
+    std::uint32_t tile_height{ 256 };       ///< The height of a tile in pixels.
+    std::uint32_t tiles_x{ 8 };             ///< The number of tiles in x-direction.
+    std::uint32_t tiles_y{ 8 };             ///< The number of tiles in y-direction.
+    std::uint32_t overlap{ 0 };             ///< The overlap of adjacent tiles in pixels.
+    std::uint32_t layers{ 1 };              ///< The number of (identical) grids of tiles placed on top of each other.
+    std::uint32_t channel_count{ 1 };       ///< The number of channels.
+    libCZI::PixelType pixel_type{ libCZI::PixelType::Gray8 };                       ///< The pixel type of the sub-blocks.
+    libCZI::CompressionMode compression_mode{ libCZI::CompressionMode::UnCompressed }; ///< The compression mode (UnCompressed, Zstd0, Zstd1 or JpgXr).
+};
+
+class BenchmarkUtilities
+{
+public:
+    /// Creates a bitmap of the specified pixel type and size and fills it with a deterministic pattern. The pattern is a
+    /// gradient with some noise added, so that the data is compressible to a realistic degree.
+    ///
+    /// \param  pixel_type  The pixel type.
+    /// \param  width       The width.
+    /// \param  height      The height.
+    /// \param  seed        The seed for the noise (so that different bitmaps can be created).
+    ///
+    /// \returns The newly created bitmap.
+    static std::shared_ptr<libCZI::IBitmapData> CreateBitmapWithPattern(libCZI::PixelType pixel_type, std::uint32_t width, std::uint32_t height, std::uint32_t seed = 0);
+
+    /// Compresses the specified bitmap with the specified compression mode (with default parameters).
+    ///
+    /// \param  bitmap              The bitmap.
+    /// \param  compression_mode    The compression mode (Zstd0, Zstd1 or JpgXr).
+    ///
+    /// \returns The compressed data.
+    static std::shared_ptr<libCZI::IMemoryBlock> CompressBitmap(libCZI::IBitmapData* bitmap, libCZI::CompressionMode compression_mode);
+
+    /// Creates a synthetic CZI-document in memory.
+    ///
+    /// \param  parameters  The parameters describing the document.
+    ///
+    /// \returns A stream containing the CZI-document.
+    static std::shared_ptr<CMemInputOutputStream> CreateSyntheticCzi(const SyntheticCziParameters& parameters);
+};
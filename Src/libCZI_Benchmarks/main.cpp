@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    // Unless an output format is given on the command line, the results are reported in JSON format, so
+    // that runs can be compared (e.g. with the script "compare.py" which comes with Google Benchmark).
+    static char json_format_argument[] = "--benchmark_format=json";
+    std::vector<char*> arguments(argv, argv + argc);
+    const bool format_given = std::any_of(
+        arguments.cbegin(),
+        arguments.cend(),
+        [](const char* argument)->bool { return strncmp(argument, "--benchmark_format", 18) == 0; });
+    if (!format_given)
+    {
+        arguments.push_back(json_format_argument);
+    }
+
+    int argument_count = static_cast<int>(arguments.size());
+    benchmark::Initialize(&argument_count, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(argument_count, arguments.data()))
+    {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -2,8 +2,10 @@
 //
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
-#include "include_gtest.h"
 #include "MemInputOutputStream.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 CMemInputOutputStream::CMemInputOutputStream(size_t initialSize) :ptr(nullptr), allocatedSize(initialSize), usedSize(0)
 {
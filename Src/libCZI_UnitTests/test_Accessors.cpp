@@ -743,3 +743,262 @@ TEST(Accessor, CreateDocumentAndCheckSingleChannelScalingAccessorWithSubBlockCac
         EXPECT_EQ(pixel_x1_y1, 4);
     }
 }
+
+/// Creates a synthetic CZI document (with pixeltype Gray16) with four overlapping subblocks with random content and returns it as a blob.
+static tuple<shared_ptr<void>, size_t> CreateGray16CziWithFourOverlappingSubblocksAndGetAsBlob()
+{
+    auto writer = CreateCZIWriter();
+    auto outStream = make_shared<CMemOutputStream>(0);
+
+    auto spWriterInfo = make_shared<CCziWriterInfo >(
+        GUID{ 0x1234567,0x89ab,0xcdef,{ 1,2,3,4,5,6,7,8 } },
+        CDimBounds{ { DimensionIndex::C, 0, 1 } },
+        0, 3);
+    writer->Create(outStream, spWriterInfo);
+
+    static constexpr array<IntPoint, 4> positions{ { {0, 0}, {40, 0}, {0, 40}, {40, 40} } };
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        auto bitmap = CreateRandomBitmap(PixelType::Gray16, 64, 64);
+        AddSubBlockInfoStridedBitmap addSbBlkInfo;
+        addSbBlkInfo.Clear();
+        addSbBlkInfo.coordinate.Set(DimensionIndex::C, 0);
+        addSbBlkInfo.mIndexValid = true;
+        addSbBlkInfo.mIndex = static_cast<int>(i);
+        addSbBlkInfo.x = positions[i].x;
+        addSbBlkInfo.y = positions[i].y;
+        addSbBlkInfo.logicalWidth = bitmap->GetWidth();
+        addSbBlkInfo.logicalHeight = bitmap->GetHeight();
+        addSbBlkInfo.physicalWidth = bitmap->GetWidth();
+        addSbBlkInfo.physicalHeight = bitmap->GetHeight();
+        addSbBlkInfo.PixelType = bitmap->GetPixelType();
+        ScopedBitmapLockerSP lock_info_bitmap{ bitmap };
+        addSbBlkInfo.ptrBitmap = lock_info_bitmap.ptrDataRoi;
+        addSbBlkInfo.strideBitmap = lock_info_bitmap.stride;
+        writer->SyncAddSubBlock(addSbBlkInfo);
+    }
+
+    PrepareMetadataInfo prepare_metadata_info;
+    auto metaDataBuilder = writer->GetPreparedMetadata(prepare_metadata_info);
+    WriteMetadataInfo write_metadata_info;
+    write_metadata_info.Clear();
+    const auto& strMetadata = metaDataBuilder->GetXml();
+    write_metadata_info.szMetadata = strMetadata.c_str();
+    write_metadata_info.szMetadataSize = strMetadata.size() + 1;
+    writer->SyncWriteMetadata(write_metadata_info);
+    writer->Close();
+    writer.reset();
+
+    size_t czi_document_size = 0;
+    shared_ptr<void> czi_document_data = outStream->GetCopy(&czi_document_size);
+    return make_tuple(czi_document_data, czi_document_size);
+}
+
+/// Apply the look-up table to the specified Gray16-bitmap, and return a Gray8-bitmap.
+static shared_ptr<IBitmapData> ApplyLookUpTableToGray16Bitmap(const shared_ptr<IBitmapData>& source, const vector<uint8_t>& look_up_table)
+{
+    auto destination = CreateGray8BitmapAndFill(source->GetWidth(), source->GetHeight(), 0);
+    const ScopedBitmapLockerSP lock_source{ source };
+    const ScopedBitmapLockerSP lock_destination{ destination };
+    for (uint32_t y = 0; y < source->GetHeight(); ++y)
+    {
+        const uint16_t* source_line = reinterpret_cast<const uint16_t*>(static_cast<const uint8_t*>(lock_source.ptrDataRoi) + static_cast<size_t>(y) * lock_source.stride);
+        uint8_t* destination_line = static_cast<uint8_t*>(lock_destination.ptrDataRoi) + static_cast<size_t>(y) * lock_destination.stride;
+        for (uint32_t x = 0; x < source->GetWidth(); ++x)
+        {
+            destination_line[x] = look_up_table[source_line[x]];
+        }
+    }
+
+    return destination;
+}
+
+TEST(Accessor, SingleChannelTileAccessorWithGradationAndCompareToTwoPassResult)
+{
+    auto czi_document_as_blob = CreateGray16CziWithFourOverlappingSubblocksAndGetAsBlob();
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+
+    const auto accessor = reader->CreateSingleChannelTileAccessor();
+    const CDimCoordinate plane_coordinate{ {DimensionIndex::C, 0} };
+    ISingleChannelTileAccessor::Options options;
+    options.Clear();
+    options.backGroundColor = RgbFloatColor{ 0,0,0 };
+    const auto composite_gray16 = accessor->Get(PixelType::Gray16, IntRect{ 5,5,90,90 }, &plane_coordinate, &options);
+
+    options.gradation.enabled = true;
+    options.gradation.blackPoint = 0.2f;
+    options.gradation.whitePoint = 0.7f;
+    const auto composite_with_gradation = accessor->Get(PixelType::Gray8, IntRect{ 5,5,90,90 }, &plane_coordinate, &options);
+
+    const auto expected = ApplyLookUpTableToGray16Bitmap(composite_gray16, Utils::Create8BitLookUpTableFromGamma(65536, 0.2f, 0.7f, 1.0f));
+    EXPECT_TRUE(AreBitmapDataEqual(composite_with_gradation, expected));
+}
+
+TEST(Accessor, SingleChannelPyramidLayerTileAccessorWithGradationAndCompareToTwoPassResult)
+{
+    auto czi_document_as_blob = CreateGray16CziWithFourOverlappingSubblocksAndGetAsBlob();
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+
+    const auto accessor = reader->CreateSingleChannelPyramidLayerTileAccessor();
+    const CDimCoordinate plane_coordinate{ {DimensionIndex::C, 0} };
+    const ISingleChannelPyramidLayerTileAccessor::PyramidLayerInfo pyramid_layer_info{ 2, 0 };
+    ISingleChannelPyramidLayerTileAccessor::Options options;
+    options.Clear();
+    options.backGroundColor = RgbFloatColor{ 0,0,0 };
+    const auto composite_gray16 = accessor->Get(PixelType::Gray16, IntRect{ 5,5,90,90 }, &plane_coordinate, pyramid_layer_info, &options);
+
+    options.gradation.enabled = true;
+    options.gradation.blackPoint = 0.1f;
+    options.gradation.whitePoint = 0.8f;
+    const auto composite_with_gradation = accessor->Get(PixelType::Gray8, IntRect{ 5,5,90,90 }, &plane_coordinate, pyramid_layer_info, &options);
+
+    const auto expected = ApplyLookUpTableToGray16Bitmap(composite_gray16, Utils::Create8BitLookUpTableFromGamma(65536, 0.1f, 0.8f, 1.0f));
+    EXPECT_TRUE(AreBitmapDataEqual(composite_with_gradation, expected));
+}
+
+/// Check that the destination bitmap contains the background color outside the rectangle (given in pixel coordinates of
+/// the destination) 'covered_rect', and inside it the content of the bitmap 'content'.
+static void CheckBitmapWithPartiallyClearedBackground(IBitmapData* destination, const IntRect& covered_rect, const shared_ptr<IBitmapData>& content, uint16_t background)
+{
+    ScopedBitmapLockerP lock_destination{ destination };
+    const ScopedBitmapLockerSP lock_content{ content };
+    for (int y = 0; y < static_cast<int>(destination->GetHeight()); ++y)
+    {
+        const uint16_t* p = reinterpret_cast<const uint16_t*>(static_cast<const uint8_t*>(lock_destination.ptrDataRoi) + y * static_cast<size_t>(lock_destination.stride));
+        for (int x = 0; x < static_cast<int>(destination->GetWidth()); ++x)
+        {
+            if (x >= covered_rect.x && x < covered_rect.x + covered_rect.w && y >= covered_rect.y && y < covered_rect.y + covered_rect.h)
+            {
+                const uint16_t* p_content = reinterpret_cast<const uint16_t*>(static_cast<const uint8_t*>(lock_content.ptrDataRoi) + (y - covered_rect.y) * static_cast<size_t>(lock_content.stride));
+                ASSERT_EQ(p[x], p_content[x - covered_rect.x]) << "at x=" << x << " y=" << y;
+            }
+            else
+            {
+                ASSERT_EQ(p[x], background) << "at x=" << x << " y=" << y;
+            }
+        }
+    }
+}
+
+TEST(Accessor, SingleChannelTileAccessorWithRoiPartiallyCoveredAndCheckBackground)
+{
+    auto czi_document_as_blob = CreateGray16CziWithFourOverlappingSubblocksAndGetAsBlob();
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+
+    const auto accessor = reader->CreateSingleChannelTileAccessor();
+    const CDimCoordinate plane_coordinate{ {DimensionIndex::C, 0} };
+    ISingleChannelTileAccessor::Options options;
+    options.Clear();
+    const auto composite_of_tiles = accessor->Get(PixelType::Gray16, IntRect{ 0,0,104,104 }, &plane_coordinate, &options);
+
+    // the destination is pre-filled with some arbitrary value, all of it must then be overwritten (either with background or with tiles)
+    const auto destination = detail::CStdBitmapData::Create(PixelType::Gray16, 140, 130);
+    detail::CBitmapOperations::Fill(destination.get(), RgbFloatColor{ 0.3f, 0.3f, 0.3f });
+    options.backGroundColor = RgbFloatColor{ 1, 1, 1 };
+    accessor->Get(destination.get(), -20, -10, &plane_coordinate, &options);
+    CheckBitmapWithPartiallyClearedBackground(destination.get(), IntRect{ 20, 10, 104, 104 }, composite_of_tiles, 0xffff);
+}
+
+TEST(Accessor, SingleChannelPyramidLayerTileAccessorWithRoiPartiallyCoveredAndCheckBackground)
+{
+    auto czi_document_as_blob = CreateGray16CziWithFourOverlappingSubblocksAndGetAsBlob();
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+
+    const auto accessor = reader->CreateSingleChannelPyramidLayerTileAccessor();
+    const CDimCoordinate plane_coordinate{ {DimensionIndex::C, 0} };
+    const ISingleChannelPyramidLayerTileAccessor::PyramidLayerInfo pyramid_layer_info{ 2, 0 };
+    ISingleChannelPyramidLayerTileAccessor::Options options;
+    options.Clear();
+    const auto composite_of_tiles = accessor->Get(PixelType::Gray16, IntRect{ 0,0,104,104 }, &plane_coordinate, pyramid_layer_info, &options);
+
+    const auto destination = detail::CStdBitmapData::Create(PixelType::Gray16, 140, 130);
+    detail::CBitmapOperations::Fill(destination.get(), RgbFloatColor{ 0.3f, 0.3f, 0.3f });
+    options.backGroundColor = RgbFloatColor{ 1, 1, 1 };
+    accessor->Get(destination.get(), -20, -10, &plane_coordinate, pyramid_layer_info, &options);
+    CheckBitmapWithPartiallyClearedBackground(destination.get(), IntRect{ 20, 10, 104, 104 }, composite_of_tiles, 0xffff);
+}
+
+TEST(Accessor, SingleChannelScalingTileAccessorWithRoiPartiallyCoveredAndCheckBackground)
+{
+    auto czi_document_as_blob = CreateGray16CziWithFourOverlappingSubblocksAndGetAsBlob();
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+
+    const auto accessor = reader->CreateSingleChannelScalingTileAccessor();
+    const CDimCoordinate plane_coordinate{ {DimensionIndex::C, 0} };
+    ISingleChannelScalingTileAccessor::Options options;
+    options.Clear();
+    const auto composite_of_tiles = accessor->Get(PixelType::Gray16, IntRect{ 0,0,104,104 }, &plane_coordinate, 1.f, &options);
+
+    // with a zoom of 1, only the part which is not covered by tiles is cleared - all of the destination must then be overwritten
+    const auto destination = detail::CStdBitmapData::Create(PixelType::Gray16, 140, 130);
+    detail::CBitmapOperations::Fill(destination.get(), RgbFloatColor{ 0.3f, 0.3f, 0.3f });
+    options.backGroundColor = RgbFloatColor{ 1, 1, 1 };
+    accessor->Get(destination.get(), IntRectAndFrameOfReference{ CZIFrameOfReference::RawSubBlockCoordinateSystem, IntRect{ -20, -10, 140, 130 } }, &plane_coordinate, 1.f, &options);
+    CheckBitmapWithPartiallyClearedBackground(destination.get(), IntRect{ 20, 10, 104, 104 }, composite_of_tiles, 0xffff);
+}
+
+TEST(Accessor, SingleChannelScalingTileAccessorWithGradationAndCompareToTwoPassResult)
+{
+    auto czi_document_as_blob = CreateGray16CziWithFourOverlappingSubblocksAndGetAsBlob();
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+
+    // we use a look-up table here (which is an arbitrary function)
+    vector<uint8_t> look_up_table(65536);
+    for (size_t i = 0; i < look_up_table.size(); ++i)
+    {
+        look_up_table[i] = static_cast<uint8_t>((i * 7) ^ (i >> 8));
+    }
+
+    const auto accessor = reader->CreateSingleChannelScalingTileAccessor();
+    const CDimCoordinate plane_coordinate{ {DimensionIndex::C, 0} };
+    for (const float zoom : { 1.0f, 0.5f, 0.37f })
+    {
+        ISingleChannelScalingTileAccessor::Options options;
+        options.Clear();
+        options.backGroundColor = RgbFloatColor{ 0,0,0 };
+        const auto composite_gray16 = accessor->Get(PixelType::Gray16, IntRect{ 3,2,100,101 }, &plane_coordinate, zoom, &options);
+
+        options.gradation.enabled = true;
+        options.gradation.lookUpTableElementCount = static_cast<int>(look_up_table.size());
+        options.gradation.ptrLookUpTable = look_up_table.data();
+        const auto composite_with_gradation = accessor->Get(PixelType::Gray8, IntRect{ 3,2,100,101 }, &plane_coordinate, zoom, &options);
+
+        const auto expected = ApplyLookUpTableToGray16Bitmap(composite_gray16, look_up_table);
+        EXPECT_TRUE(AreBitmapDataEqual(composite_with_gradation, expected)) << "zoom=" << zoom;
+    }
+}
+
+TEST(Accessor, SingleChannelScalingTileAccessorWithGradationAndInvalidArgumentsExpectException)
+{
+    auto czi_document_as_blob = CreateGray16CziWithFourOverlappingSubblocksAndGetAsBlob();
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+
+    const auto accessor = reader->CreateSingleChannelScalingTileAccessor();
+    const CDimCoordinate plane_coordinate{ {DimensionIndex::C, 0} };
+    ISingleChannelScalingTileAccessor::Options options;
+    options.Clear();
+    options.gradation.enabled = true;
+
+    // the destination must be Gray8
+    EXPECT_THROW(accessor->Get(PixelType::Gray16, IntRect{ 0,0,50,50 }, &plane_coordinate, 1, &options), invalid_argument);
+
+    // the size of the look-up table must match the source pixeltype
+    const vector<uint8_t> look_up_table(256);
+    options.gradation.lookUpTableElementCount = static_cast<int>(look_up_table.size());
+    options.gradation.ptrLookUpTable = look_up_table.data();
+    EXPECT_THROW(accessor->Get(PixelType::Gray8, IntRect{ 0,0,50,50 }, &plane_coordinate, 1, &options), invalid_argument);
+}
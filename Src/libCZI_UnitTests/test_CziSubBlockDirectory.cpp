@@ -5,6 +5,9 @@
 #include "include_gtest.h"
 #include "testImage.h"
 #include "inc_libCZI.h"
+#include <algorithm>
+#include <random>
+#include <vector>
 
 using namespace libCZI;
 using namespace libCZI::detail;
@@ -237,3 +240,135 @@ TEST(CziSubBlockDirectory, CziSubBlockDirectory1)
 
     //auto pyramidStatistics = subBlkDir.GetPyramidStatistics();
 }
+
+static std::vector<CCziSubBlockDirectory::SubBlkEntry> CreateSubBlkEntriesInRandomOrder()
+{
+    // create a mosaic for 2 channels and 10 z-planes (with 49 tiles each), and a pyramid-layer for each plane
+    std::vector<CCziSubBlockDirectory::SubBlkEntry> entries;
+    for (int c = 0; c < 2; ++c)
+    {
+        for (int z = 0; z < 10; ++z)
+        {
+            for (int m = 0; m < 49; ++m)
+            {
+                CCziSubBlockDirectory::SubBlkEntry entry;
+                entry.Invalidate();
+                entry.coordinate = CDimCoordinate{ { DimensionIndex::C, c }, { DimensionIndex::Z, z } };
+                entry.mIndex = m;
+                entry.x = (m % 7) * 100;
+                entry.y = (m / 7) * 100;
+                entry.width = entry.height = entry.storedWidth = entry.storedHeight = 100;
+                entry.PixelType = (int)PixelType::Gray8;
+                entry.FilePosition = entries.size() * 1000;
+                entry.Compression = 0;
+                entries.push_back(entry);
+            }
+
+            for (int tile = 0; tile < 4; ++tile)
+            {
+                CCziSubBlockDirectory::SubBlkEntry entry;
+                entry.Invalidate();
+                entry.coordinate = CDimCoordinate{ { DimensionIndex::C, c }, { DimensionIndex::Z, z } };
+                entry.x = (tile % 2) * 400;
+                entry.y = (tile / 2) * 400;
+                entry.width = entry.height = 400;
+                entry.storedWidth = entry.storedHeight = 100;
+                entry.PixelType = (int)PixelType::Gray8;
+                entry.FilePosition = entries.size() * 1000;
+                entry.Compression = 0;
+                entries.push_back(entry);
+            }
+        }
+    }
+
+    std::mt19937 random_engine(42);
+    std::shuffle(entries.begin(), entries.end(), random_engine);
+    return entries;
+}
+
+static std::vector<CCziSubBlockDirectory::SubBlkEntry> GetEntries(const CWriterCziSubBlockDirectory& directory)
+{
+    std::vector<CCziSubBlockDirectory::SubBlkEntry> entries;
+    directory.EnumEntries(
+        [&](size_t index, const CCziSubBlockDirectory::SubBlkEntry& entry)->bool
+        {
+            EXPECT_EQ(index, entries.size());
+            entries.push_back(entry);
+            return true;
+        });
+
+    return entries;
+}
+
+TEST(CziSubBlockDirectory, WriterDirectoryWithLimitedEntriesInMemoryHasSameContentAndOrder)
+{
+    const auto entries = CreateSubBlkEntriesInRandomOrder();
+    CWriterCziSubBlockDirectory directory_in_memory(false);
+    CWriterCziSubBlockDirectory directory_with_runs(false, 64);
+    for (const auto& entry : entries)
+    {
+        EXPECT_TRUE(directory_in_memory.TryAddSubBlock(entry));
+        EXPECT_TRUE(directory_with_runs.TryAddSubBlock(entry));
+    }
+
+    const auto entries_in_memory = GetEntries(directory_in_memory);
+    const auto entries_with_runs = GetEntries(directory_with_runs);
+    ASSERT_EQ(entries_in_memory.size(), entries.size());
+    ASSERT_EQ(entries_with_runs.size(), entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        EXPECT_EQ(Utils::Compare(&entries_in_memory[i].coordinate, &entries_with_runs[i].coordinate), 0);
+        EXPECT_EQ(entries_in_memory[i].mIndex, entries_with_runs[i].mIndex);
+        EXPECT_EQ(entries_in_memory[i].x, entries_with_runs[i].x);
+        EXPECT_EQ(entries_in_memory[i].y, entries_with_runs[i].y);
+        EXPECT_EQ(entries_in_memory[i].width, entries_with_runs[i].width);
+        EXPECT_EQ(entries_in_memory[i].storedWidth, entries_with_runs[i].storedWidth);
+        EXPECT_EQ(entries_in_memory[i].FilePosition, entries_with_runs[i].FilePosition);
+    }
+
+    EXPECT_EQ(directory_in_memory.GetStatistics().subBlockCount, directory_with_runs.GetStatistics().subBlockCount);
+    EXPECT_EQ(directory_in_memory.GetStatistics().maxMindex, directory_with_runs.GetStatistics().maxMindex);
+}
+
+TEST(CziSubBlockDirectory, WriterDirectoryWithLimitedEntriesInMemoryDetectsDuplicates)
+{
+    const auto entries = CreateSubBlkEntriesInRandomOrder();
+    CWriterCziSubBlockDirectory directory(false, 16);
+    for (const auto& entry : entries)
+    {
+        EXPECT_TRUE(directory.TryAddSubBlock(entry));
+    }
+
+    // now, add all entries again (with a different file-position) - all of them must be reported as duplicates, no matter
+    //  whether they are in memory or have been spilled to the temporary file
+    for (auto entry : entries)
+    {
+        entry.FilePosition += 1;
+        EXPECT_FALSE(directory.TryAddSubBlock(entry));
+    }
+
+    auto entry = entries[0];
+    entry.mIndex = 1000;
+    EXPECT_TRUE(directory.TryAddSubBlock(entry));
+    EXPECT_EQ(GetEntries(directory).size(), entries.size() + 1);
+}
+
+TEST(CziSubBlockDirectory, WriterDirectoryWithLimitedEntriesInMemoryAndAllowDuplicates)
+{
+    const auto entries = CreateSubBlkEntriesInRandomOrder();
+    CWriterCziSubBlockDirectory directory(true, 16);
+    for (const auto& entry : entries)
+    {
+        EXPECT_TRUE(directory.TryAddSubBlock(entry));
+    }
+
+    // with "allow duplicates", entries with the same coordinate but a different file-position are accepted
+    for (auto entry : entries)
+    {
+        EXPECT_FALSE(directory.TryAddSubBlock(entry));
+        entry.FilePosition += 1;
+        EXPECT_TRUE(directory.TryAddSubBlock(entry));
+    }
+
+    EXPECT_EQ(GetEntries(directory).size(), 2 * entries.size());
+}
@@ -4,8 +4,13 @@
 
 #include "include_gtest.h"
 #include "inc_libCZI.h"
+#include "MemOutputStream.h"
+#include "MemInputOutputStream.h"
+#include "utils.h"
+#include "../libCZI/WriteCombiningOutputStream.h"
 
 using namespace libCZI;
+using namespace libCZI::detail;
 
 TEST(StreamImplementations, StreamInMemory1)
 {
@@ -80,3 +85,242 @@ TEST(StreamImplementations, StreamInMemory3)
 
     EXPECT_TRUE(bufferForRead[1] == 0 && bufferForRead[2] == 0) << "incorrect result";
 }
+
+namespace
+{
+    /// An output-stream (in memory) which counts the number of write-operations.
+    class CCountingMemOutputStream : public CMemOutputStream
+    {
+    public:
+        int numberOfWriteCalls{ 0 };
+
+        CCountingMemOutputStream() : CMemOutputStream(0) {}
+
+        void Write(std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* ptrBytesWritten) override
+        {
+            ++this->numberOfWriteCalls;
+            CMemOutputStream::Write(offset, pv, size, ptrBytesWritten);
+        }
+    };
+
+    std::vector<std::uint8_t> CreateTestData(size_t size)
+    {
+        std::vector<std::uint8_t> data(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            data[i] = static_cast<std::uint8_t>(i * 7 + 3);
+        }
+
+        return data;
+    }
+}
+
+TEST(StreamImplementations, WriteCombiningOutputStreamCoalesceContiguousWritesAndCheckResult)
+{
+    const auto data = CreateTestData(1000);
+    auto memStream = std::make_shared<CCountingMemOutputStream>();
+    CWriteCombiningOutputStream stream(memStream, 4096);
+
+    for (size_t offset = 0; offset < data.size(); offset += 100)
+    {
+        std::uint64_t bytesWritten = 0;
+        stream.Write(offset, data.data() + offset, 100, &bytesWritten);
+        EXPECT_EQ(bytesWritten, 100);
+    }
+
+    EXPECT_EQ(memStream->numberOfWriteCalls, 0);
+    stream.Flush();
+    EXPECT_EQ(memStream->numberOfWriteCalls, 1);
+    ASSERT_EQ(memStream->GetDataSize(), data.size());
+    EXPECT_EQ(memcmp(memStream->GetDataC(), data.data(), data.size()), 0);
+
+    // a second flush must not write anything
+    stream.Flush();
+    EXPECT_EQ(memStream->numberOfWriteCalls, 1);
+}
+
+TEST(StreamImplementations, WriteCombiningOutputStreamPatchDataInBufferAndCheckResult)
+{
+    auto data = CreateTestData(500);
+    auto memStream = std::make_shared<CCountingMemOutputStream>();
+    CWriteCombiningOutputStream stream(memStream, 4096);
+
+    // write a "header" with placeholder content, then the "payload", then update the header
+    const std::uint8_t placeholder[32] = {};
+    stream.Write(0, placeholder, sizeof(placeholder), nullptr);
+    stream.Write(32, data.data() + 32, data.size() - 32, nullptr);
+    stream.Write(0, data.data(), 32, nullptr);
+
+    // now write data which starts in the buffered range and extends it
+    const auto moreData = CreateTestData(100);
+    stream.Write(450, moreData.data(), moreData.size(), nullptr);
+    data.resize(550);
+    memcpy(data.data() + 450, moreData.data(), moreData.size());
+
+    stream.Flush();
+    EXPECT_EQ(memStream->numberOfWriteCalls, 1);
+    ASSERT_EQ(memStream->GetDataSize(), data.size());
+    EXPECT_EQ(memcmp(memStream->GetDataC(), data.data(), data.size()), 0);
+}
+
+TEST(StreamImplementations, WriteCombiningOutputStreamWithNonContiguousAndLargeWritesAndCheckResult)
+{
+    const auto data = CreateTestData(3000);
+    auto memStream = std::make_shared<CCountingMemOutputStream>();
+    CWriteCombiningOutputStream stream(memStream, 1024);
+
+    stream.Write(0, data.data(), 100, nullptr);
+    EXPECT_EQ(memStream->numberOfWriteCalls, 0);
+
+    // a write which does not touch the buffered range is passed through, and the buffer is kept
+    stream.Write(2000, data.data() + 2000, 1000, nullptr);
+    EXPECT_EQ(memStream->numberOfWriteCalls, 1);
+
+    // a write which does not fit into the buffer flushes the buffer, and if it is larger than the buffer, it is passed through
+    stream.Write(100, data.data() + 100, 1900, nullptr);
+    EXPECT_EQ(memStream->numberOfWriteCalls, 3);
+
+    stream.Flush();
+    EXPECT_EQ(memStream->numberOfWriteCalls, 3);
+    ASSERT_EQ(memStream->GetDataSize(), data.size());
+    EXPECT_EQ(memcmp(memStream->GetDataC(), data.data(), data.size()), 0);
+}
+
+TEST(StreamImplementations, WriteCombiningInputOutputStreamReadAfterWriteAndCheckResult)
+{
+    const auto data = CreateTestData(200);
+    auto memStream = std::make_shared<CMemInputOutputStream>(0);
+    CWriteCombiningInputOutputStream stream(memStream, 1024);
+
+    stream.Write(0, data.data(), data.size(), nullptr);
+    EXPECT_EQ(memStream->GetDataSize(), 0);
+
+    std::uint8_t buffer[50];
+    std::uint64_t bytesRead = 0;
+    stream.Read(100, buffer, sizeof(buffer), &bytesRead);
+    EXPECT_EQ(bytesRead, sizeof(buffer));
+    EXPECT_EQ(memcmp(buffer, data.data() + 100, sizeof(buffer)), 0);
+    EXPECT_EQ(memStream->GetDataSize(), data.size());
+}
+
+TEST(StreamImplementations, WriteCziWithWriteCombiningBufferAndCompareWithUnbufferedResult)
+{
+    auto createCzi = [](bool useWriteCombiningBuffer, int* numberOfWriteCalls)->std::vector<std::uint8_t>
+        {
+            CZIWriterOptions options;
+            options.use_write_combining_buffer_for_all_streams = useWriteCombiningBuffer;
+            options.write_combining_buffer_size = useWriteCombiningBuffer ? 64 * 1024 : 0;
+            const auto writer = CreateCZIWriter(&options);
+            const auto outStream = std::make_shared<CCountingMemOutputStream>();
+            libCZI::GUID fileGuid{ 0x1234567,0x89ab,0xcdef,{ 1,2,3,4,5,6,7,8 } };
+            const auto writerInfo = std::make_shared<CCziWriterInfo>(fileGuid);
+            writer->Create(outStream, writerInfo);
+
+            for (int c = 0; c < 20; ++c)
+            {
+                const auto bitmap = CreateTestBitmap(PixelType::Gray8, 64, 64);
+                ScopedBitmapLockerSP lockBitmap{ bitmap };
+                AddSubBlockInfoStridedBitmap addSbBlkInfo;
+                addSbBlkInfo.Clear();
+                addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, c } };
+                addSbBlkInfo.mIndexValid = false;
+                addSbBlkInfo.x = 0;
+                addSbBlkInfo.y = 0;
+                addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 64;
+                addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 64;
+                addSbBlkInfo.PixelType = PixelType::Gray8;
+                addSbBlkInfo.ptrBitmap = lockBitmap.ptrDataRoi;
+                addSbBlkInfo.strideBitmap = lockBitmap.stride;
+                writer->SyncAddSubBlock(addSbBlkInfo);
+            }
+
+            writer->Close();
+            *numberOfWriteCalls = outStream->numberOfWriteCalls;
+            const auto data = reinterpret_cast<const std::uint8_t*>(outStream->GetDataC());
+            return std::vector<std::uint8_t>(data, data + outStream->GetDataSize());
+        };
+
+    int numberOfWriteCallsUnbuffered, numberOfWriteCallsBuffered;
+    const auto unbuffered = createCzi(false, &numberOfWriteCallsUnbuffered);
+    const auto buffered = createCzi(true, &numberOfWriteCallsBuffered);
+    EXPECT_LT(numberOfWriteCallsBuffered, numberOfWriteCallsUnbuffered);
+    EXPECT_TRUE(unbuffered == buffered);
+}
+
+namespace
+{
+    void AddGray8SubBlocks(const std::function<void(const AddSubBlockInfoStridedBitmap&)>& add_sub_block, int count)
+    {
+        for (int c = 0; c < count; ++c)
+        {
+            const auto bitmap = CreateTestBitmap(PixelType::Gray8, 64, 64);
+            ScopedBitmapLockerSP lockBitmap{ bitmap };
+            AddSubBlockInfoStridedBitmap addSbBlkInfo;
+            addSbBlkInfo.Clear();
+            addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, c } };
+            addSbBlkInfo.mIndexValid = false;
+            addSbBlkInfo.x = 0;
+            addSbBlkInfo.y = 0;
+            addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 64;
+            addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 64;
+            addSbBlkInfo.PixelType = PixelType::Gray8;
+            addSbBlkInfo.ptrBitmap = lockBitmap.ptrDataRoi;
+            addSbBlkInfo.strideBitmap = lockBitmap.stride;
+            add_sub_block(addSbBlkInfo);
+        }
+    }
+}
+
+TEST(StreamImplementations, DestroyCziWriterWithoutCloseAndCheckThatWriteCombiningBufferIsFlushed)
+{
+    auto writeWithoutClose = [](bool useWriteCombiningBuffer)->std::vector<std::uint8_t>
+        {
+            const auto outStream = std::make_shared<CCountingMemOutputStream>();
+            {
+                CZIWriterOptions options;
+                options.use_write_combining_buffer_for_all_streams = useWriteCombiningBuffer;
+                options.write_combining_buffer_size = useWriteCombiningBuffer ? 64 * 1024 : 0;
+                const auto writer = CreateCZIWriter(&options);
+                libCZI::GUID fileGuid{ 0x1234567,0x89ab,0xcdef,{ 1,2,3,4,5,6,7,8 } };
+                writer->Create(outStream, std::make_shared<CCziWriterInfo>(fileGuid));
+                AddGray8SubBlocks([&](const AddSubBlockInfoStridedBitmap& info)->void { writer->SyncAddSubBlock(info); }, 5);
+
+                // the writer is destroyed here without calling "Close"
+            }
+
+            const auto data = reinterpret_cast<const std::uint8_t*>(outStream->GetDataC());
+            return std::vector<std::uint8_t>(data, data + outStream->GetDataSize());
+        };
+
+    const auto unbuffered = writeWithoutClose(false);
+    const auto buffered = writeWithoutClose(true);
+    EXPECT_GT(unbuffered.size(), 5u * 64 * 64);
+    EXPECT_TRUE(unbuffered == buffered);
+}
+
+TEST(StreamImplementations, DestroyCziReaderWriterWithoutCloseAndCheckThatWriteCombiningBufferIsFlushed)
+{
+    auto writeWithoutClose = [](std::uint32_t writeCombiningBufferSize)->std::vector<std::uint8_t>
+        {
+            const auto stream = std::make_shared<CMemInputOutputStream>(0);
+            {
+                CZIReaderWriterOptions options;
+                options.use_write_combining_buffer_for_all_streams = true;
+                options.write_combining_buffer_size = writeCombiningBufferSize;
+                const auto readerWriter = CreateCZIReaderWriter(&options);
+                libCZI::GUID fileGuid{ 0x1234567,0x89ab,0xcdef,{ 1,2,3,4,5,6,7,8 } };
+                readerWriter->Create(stream, std::make_shared<CCziReaderWriterInfo>(fileGuid));
+                AddGray8SubBlocks([&](const AddSubBlockInfoStridedBitmap& info)->void { readerWriter->SyncAddSubBlock(info); }, 5);
+
+                // the reader-writer is destroyed here without calling "Close"
+            }
+
+            const auto data = reinterpret_cast<const std::uint8_t*>(stream->GetDataC());
+            return std::vector<std::uint8_t>(data, data + stream->GetDataSize());
+        };
+
+    const auto unbuffered = writeWithoutClose(0);
+    const auto buffered = writeWithoutClose(64 * 1024);
+    EXPECT_GT(unbuffered.size(), 5u * 64 * 64);
+    EXPECT_TRUE(unbuffered == buffered);
+}
@@ -9,6 +9,7 @@
 #include "inc_libCZI.h"
 #include "../libCZI/SingleChannelTileAccessor.h"
 #include "../libCZI/SingleChannelScalingTileAccessor.h"
+#include "../libCZI/SingleChannelPyramidLevelTileAccessor.h"
 #include "MemOutputStream.h"
 #include "utils.h"
 
@@ -348,6 +349,45 @@ public:
     }
 };
 
+class SingleChannelPyramidLayerTileAccessorHandler
+{
+    shared_ptr<ISingleChannelPyramidLayerTileAccessor> accessor_;
+    bool sort_by_m_;
+public:
+    explicit SingleChannelPyramidLayerTileAccessorHandler(bool sortByM = true) : sort_by_m_(sortByM)
+    {
+    }
+
+    void Initialize(const shared_ptr<libCZI::ISubBlockRepository>& repository)
+    {
+        this->accessor_ = make_shared<CSingleChannelPyramidLevelTileAccessor>(repository);
+    }
+
+    shared_ptr<IBitmapData> GetBitmap(PixelType pixeltype, const IntRect& roi, const IDimCoordinate* planeCoordinate, bool with_optimization, bool with_background_clear) const
+    {
+        ISingleChannelPyramidLayerTileAccessor::Options options;
+        options.Clear();
+        options.useVisibilityCheckOptimization = with_optimization;
+        options.sortByM = this->sort_by_m_;
+        if (with_background_clear)
+        {
+            options.backGroundColor = RgbFloatColor{ 0,0,0 };
+        }
+
+        return this->accessor_->Get(pixeltype, roi, planeCoordinate, ISingleChannelPyramidLayerTileAccessor::PyramidLayerInfo{ 2, 0 }, &options);
+    }
+
+    shared_ptr<IBitmapData> GetBitmapWithOptimization(PixelType pixeltype, const IntRect& roi, const IDimCoordinate* planeCoordinate) const
+    {
+        return this->GetBitmap(pixeltype, roi, planeCoordinate, true, true);
+    }
+
+    shared_ptr<IBitmapData> GetBitmapWithoutOptimization(PixelType pixeltype, const IntRect& roi, const IDimCoordinate* planeCoordinate) const
+    {
+        return this->GetBitmap(pixeltype, roi, planeCoordinate, false, true);
+    }
+};
+
 TEST(TileAccessorCoverageOptimization, ThreeOverlappingSubBlockWithVisibilityOptimizationTest_SingleChannelTileAccessor)
 {
     ThreeOverlappingSubBlockWithVisibilityOptimizationTest(SingleChannelTileAccessorHandler{});
@@ -388,6 +428,26 @@ TEST(TileAccessorCoverageOptimization, RandomSubblocksCompareRenderingWithAndWit
     RandomSubblocksAndCompareRenderingWithAndWithoutVisibilityOptimization(SingleChannelScalingTileAccessorHandler{ false });
 }
 
+TEST(TileAccessorCoverageOptimization, ThreeOverlappingSubBlockWithVisibilityOptimizationTest_SingleChannelPyramidLayerTileAccessor)
+{
+    ThreeOverlappingSubBlockWithVisibilityOptimizationTest(SingleChannelPyramidLayerTileAccessorHandler{});
+}
+
+TEST(TileAccessorCoverageOptimization, ThreeSubBlocksAtSamePositionWithVisibilityOptimizationTest_SingleChannelPyramidLayerTileAccessor)
+{
+    ThreeSubBlocksAtSamePositionWithVisibilityOptimizationTest(SingleChannelPyramidLayerTileAccessorHandler{});
+}
+
+TEST(TileAccessorCoverageOptimization, RandomSubblocksCompareRenderingWithAndWithoutVisibilityOptimization_SingleChannelPyramidLayerTileAccessor)
+{
+    RandomSubblocksAndCompareRenderingWithAndWithoutVisibilityOptimization(SingleChannelPyramidLayerTileAccessorHandler{});
+}
+
+TEST(TileAccessorCoverageOptimization, RandomSubblocksCompareRenderingWithAndWithoutVisibilityOptimizationWithoutSortByM_SingleChannelPyramidLayerTileAccessor)
+{
+    RandomSubblocksAndCompareRenderingWithAndWithoutVisibilityOptimization(SingleChannelPyramidLayerTileAccessorHandler{ false });
+}
+
 // Stub to bridge the access restrictions
 class CSingleChannelAccessorBaseToTestStub : public CSingleChannelAccessorBase
 {
@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "include_gtest.h"
+#include "inc_libCZI.h"
+#include "../libCZI/cpu_dispatch.h"
+#include "../libCZI/utilities.h"
+
+#include <random>
+#include <vector>
+
+using namespace libCZI;
+using namespace libCZI::detail;
+using namespace std;
+
+namespace
+{
+    /// Gets all instruction sets which can be used on this machine.
+    vector<InstructionSet> GetUsableInstructionSets()
+    {
+        vector<InstructionSet> result;
+        for (const auto instruction_set : { InstructionSet::Generic, InstructionSet::AVX2, InstructionSet::NEON })
+        {
+            if (CpuDispatch::IsInstructionSetUsable(instruction_set))
+            {
+                result.push_back(instruction_set);
+            }
+        }
+
+        return result;
+    }
+
+    /// RAII-helper which forces an instruction set, and resets it when going out of scope.
+    class ScopedForcedInstructionSet
+    {
+    public:
+        explicit ScopedForcedInstructionSet(InstructionSet instruction_set)
+        {
+            CpuDispatch::ForceInstructionSet(instruction_set);
+        }
+
+        ~ScopedForcedInstructionSet()
+        {
+            CpuDispatch::ResetForcedInstructionSet();
+        }
+    };
+
+    template <typename t>
+    vector<t> CreateRandomData(size_t count, uint32_t seed)
+    {
+        mt19937 generator(seed);
+        uniform_int_distribution<uint32_t> distribution(0, (numeric_limits<t>::max)());
+        vector<t> data(count);
+        for (auto& v : data)
+        {
+            v = static_cast<t>(distribution(generator));
+        }
+
+        return data;
+    }
+}
+
+TEST(CpuDispatch, GenericIsAlwaysUsableAndDetectedInstructionSetIsUsable)
+{
+    EXPECT_TRUE(CpuDispatch::IsInstructionSetUsable(InstructionSet::Generic));
+    EXPECT_TRUE(CpuDispatch::IsInstructionSetUsable(CpuDispatch::GetDetectedInstructionSet()));
+    EXPECT_EQ(CpuDispatch::GetKernels().instructionSet, CpuDispatch::GetDetectedInstructionSet());
+}
+
+TEST(CpuDispatch, ForceInstructionSetAndCheckKernels)
+{
+    for (const auto instruction_set : GetUsableInstructionSets())
+    {
+        ScopedForcedInstructionSet forced_instruction_set(instruction_set);
+        EXPECT_EQ(CpuDispatch::GetKernels().instructionSet, instruction_set);
+    }
+
+    EXPECT_EQ(CpuDispatch::GetKernels().instructionSet, CpuDispatch::GetDetectedInstructionSet());
+}
+
+TEST(CpuDispatch, ForceUnusableInstructionSetAndExpectException)
+{
+    for (const auto instruction_set : { InstructionSet::AVX2, InstructionSet::NEON })
+    {
+        if (!CpuDispatch::IsInstructionSetUsable(instruction_set))
+        {
+            EXPECT_THROW(CpuDispatch::ForceInstructionSet(instruction_set), invalid_argument);
+        }
+    }
+}
+
+TEST(CpuDispatch, CompareLineKernelsWithGenericImplementation)
+{
+    // we use lengths which are not a multiple of the vector-width, so that the remainder-handling is exercised as well
+    for (const size_t count : { 0, 1, 15, 16, 17, 31, 32, 33, 1000, 1031 })
+    {
+        const auto source_gray16 = CreateRandomData<uint16_t>(count, static_cast<uint32_t>(count));
+        const auto source_gray8 = CreateRandomData<uint8_t>(count, static_cast<uint32_t>(count) + 1);
+
+        vector<uint8_t> expected_gray8(count);
+        vector<uint16_t> expected_gray16(count);
+        vector<uint16_t> expected_fill(count);
+        {
+            ScopedForcedInstructionSet forced_instruction_set(InstructionSet::Generic);
+            const auto& kernels = CpuDispatch::GetKernels();
+            kernels.convertGray16ToGray8Line(source_gray16.data(), expected_gray8.data(), count);
+            kernels.convertGray8ToGray16Line(source_gray8.data(), expected_gray16.data(), count);
+            kernels.fillGray16Line(expected_fill.data(), count, 0x1234);
+        }
+
+        for (const auto instruction_set : GetUsableInstructionSets())
+        {
+            ScopedForcedInstructionSet forced_instruction_set(instruction_set);
+            const auto& kernels = CpuDispatch::GetKernels();
+
+            vector<uint8_t> result_gray8(count);
+            kernels.convertGray16ToGray8Line(source_gray16.data(), result_gray8.data(), count);
+            EXPECT_EQ(result_gray8, expected_gray8) << CpuDispatch::InstructionSetToInformalString(instruction_set) << " count=" << count;
+
+            vector<uint16_t> result_gray16(count);
+            kernels.convertGray8ToGray16Line(source_gray8.data(), result_gray16.data(), count);
+            EXPECT_EQ(result_gray16, expected_gray16) << CpuDispatch::InstructionSetToInformalString(instruction_set) << " count=" << count;
+
+            vector<uint16_t> result_fill(count);
+            kernels.fillGray16Line(result_fill.data(), count, 0x1234);
+            EXPECT_EQ(result_fill, expected_fill) << CpuDispatch::InstructionSetToInformalString(instruction_set) << " count=" << count;
+        }
+    }
+}
+
+TEST(CpuDispatch, LoHiBytePackUnpackRoundTripWithAllInstructionSets)
+{
+    constexpr uint32_t width = 37;
+    constexpr uint32_t height = 5;
+    constexpr uint32_t stride = width * 2 + 6;
+    const auto source = CreateRandomData<uint8_t>(static_cast<size_t>(stride) * height, 42);
+
+    for (const auto instruction_set : GetUsableInstructionSets())
+    {
+        ScopedForcedInstructionSet forced_instruction_set(instruction_set);
+        vector<uint8_t> unpacked(static_cast<size_t>(width) * 2 * height);
+        LoHiBytePackUnpack::LoHiByteUnpackStrided(source.data(), width, stride, height, unpacked.data());
+        vector<uint8_t> packed(static_cast<size_t>(stride) * height);
+        LoHiBytePackUnpack::LoHiBytePackStrided(unpacked.data(), unpacked.size(), width, height, stride, packed.data());
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            EXPECT_TRUE(equal(source.cbegin() + y * stride, source.cbegin() + y * stride + width * 2, packed.cbegin() + y * stride)) << CpuDispatch::InstructionSetToInformalString(instruction_set);
+        }
+    }
+}
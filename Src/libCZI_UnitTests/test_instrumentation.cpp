@@ -0,0 +1,240 @@
+// SPDX-FileCopyrightText: 2025 Carl Zeiss Microscopy GmbH
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "include_gtest.h"
+#include "inc_libCZI.h"
+#include "../libCZI/Instrumentation.h"
+#include "MemOutputStream.h"
+#include "MemInputOutputStream.h"
+#include "utils.h"
+
+using namespace libCZI;
+using namespace std;
+
+static tuple<shared_ptr<void>, size_t> CreateCziWithGray8SubBlocks(const vector<IntRect>& subblocks)
+{
+    const auto writer = CreateCZIWriter();
+    const auto outStream = make_shared<CMemOutputStream>(0);
+
+    const auto spWriterInfo = make_shared<CCziWriterInfo>(
+        GUID{ 0,0,0,{ 0,0,0,0,0,0,0,0 } },
+        CDimBounds{ { DimensionIndex::C, 0, 1 } },
+        0, static_cast<int>(subblocks.size() - 1));
+
+    writer->Create(outStream, spWriterInfo);
+
+    int count = 0;
+    for (const auto& rectangle : subblocks)
+    {
+        const size_t size_of_bitmap = static_cast<size_t>(rectangle.w) * rectangle.h;
+        unique_ptr<uint8_t[]> bitmap(new uint8_t[size_of_bitmap]);
+        memset(bitmap.get(), count + 1, size_of_bitmap);
+        AddSubBlockInfoStridedBitmap addSbBlkInfo;
+        addSbBlkInfo.Clear();
+        addSbBlkInfo.coordinate.Set(DimensionIndex::C, 0);
+        addSbBlkInfo.mIndexValid = true;
+        addSbBlkInfo.mIndex = count++;
+        addSbBlkInfo.x = rectangle.x;
+        addSbBlkInfo.y = rectangle.y;
+        addSbBlkInfo.logicalWidth = rectangle.w;
+        addSbBlkInfo.logicalHeight = rectangle.h;
+        addSbBlkInfo.physicalWidth = rectangle.w;
+        addSbBlkInfo.physicalHeight = rectangle.h;
+        addSbBlkInfo.PixelType = PixelType::Gray8;
+        addSbBlkInfo.ptrBitmap = bitmap.get();
+        addSbBlkInfo.strideBitmap = rectangle.w;
+        writer->SyncAddSubBlock(addSbBlkInfo);
+    }
+
+    const auto metaDataBuilder = writer->GetPreparedMetadata(PrepareMetadataInfo{});
+
+    WriteMetadataInfo write_metadata_info;
+    const auto& strMetadata = metaDataBuilder->GetXml();
+    write_metadata_info.szMetadata = strMetadata.c_str();
+    write_metadata_info.szMetadataSize = strMetadata.size() + 1;
+    write_metadata_info.ptrAttachment = nullptr;
+    write_metadata_info.attachmentSize = 0;
+    writer->SyncWriteMetadata(write_metadata_info);
+
+    writer->Close();
+
+    return make_tuple(outStream->GetCopy(nullptr), outStream->GetDataSize());
+}
+
+TEST(Instrumentation, DurationHistogramBucketIndex)
+{
+    EXPECT_EQ(libCZI::detail::PerformanceCounters::GetBucketIndex(0), 0);
+    EXPECT_EQ(libCZI::detail::PerformanceCounters::GetBucketIndex(999), 0);
+    EXPECT_EQ(libCZI::detail::PerformanceCounters::GetBucketIndex(1000), 1);
+    EXPECT_EQ(libCZI::detail::PerformanceCounters::GetBucketIndex(1999), 1);
+    EXPECT_EQ(libCZI::detail::PerformanceCounters::GetBucketIndex(2000), 2);
+    EXPECT_EQ(libCZI::detail::PerformanceCounters::GetBucketIndex(4000), 3);
+    EXPECT_EQ(libCZI::detail::PerformanceCounters::GetBucketIndex(numeric_limits<uint64_t>::max()), DurationHistogram::kBucketCount - 1);
+}
+
+TEST(Instrumentation, ReaderPerformanceCountersForStreamAndSubBlocks)
+{
+    auto czi_document_as_blob = CreateCziWithGray8SubBlocks({ { 0, 0, 4, 4 }, { 4, 0, 4, 4 }, { 8, 0, 4, 4 } });
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+
+    const auto counters_after_open = reader->GetPerformanceCounters();
+    EXPECT_GT(counters_after_open.GetCounter(PerformanceCounter::StreamReadCalls), 0u);
+    EXPECT_GT(counters_after_open.GetCounter(PerformanceCounter::StreamReadBytes), 0u);
+    EXPECT_EQ(counters_after_open.GetCounter(PerformanceCounter::SubBlocksRead), 0u);
+    EXPECT_EQ(counters_after_open.GetTimer(PerformanceTimer::StreamRead).count, counters_after_open.GetCounter(PerformanceCounter::StreamReadCalls));
+
+    reader->ReadSubBlock(0);
+    reader->ReadSubBlock(2);
+
+    const auto counters = reader->GetPerformanceCounters();
+    EXPECT_EQ(counters.GetCounter(PerformanceCounter::SubBlocksRead), 2u);
+    EXPECT_GT(counters.GetCounter(PerformanceCounter::StreamReadCalls), counters_after_open.GetCounter(PerformanceCounter::StreamReadCalls));
+    EXPECT_GE(counters.GetCounter(PerformanceCounter::StreamReadBytes), counters_after_open.GetCounter(PerformanceCounter::StreamReadBytes) + 2 * 16);
+    EXPECT_LE(counters.GetCounter(PerformanceCounter::StreamReadBytes), get<1>(czi_document_as_blob));
+    EXPECT_EQ(counters.GetTimer(PerformanceTimer::StreamRead).count, counters.GetCounter(PerformanceCounter::StreamReadCalls));
+
+    uint64_t count_in_buckets = 0;
+    for (const auto bucket : counters.GetTimer(PerformanceTimer::StreamRead).buckets)
+    {
+        count_in_buckets += bucket;
+    }
+
+    EXPECT_EQ(count_in_buckets, counters.GetTimer(PerformanceTimer::StreamRead).count);
+
+    // the composition-related counters are only maintained globally
+    EXPECT_EQ(counters.GetTimer(PerformanceTimer::SingleChannelAccessorGet).count, 0u);
+}
+
+TEST(Instrumentation, GlobalPerformanceCountersForScalingAccessorWithVisibilityCheckAndCache)
+{
+    // three subblocks at the same position, so with the visibility check only the top-most one is drawn
+    auto czi_document_as_blob = CreateCziWithGray8SubBlocks({ { 0, 0, 4, 4 }, { 0, 0, 4, 4 }, { 0, 0, 4, 4 } });
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+    const auto accessor = reader->CreateSingleChannelScalingTileAccessor();
+    const CDimCoordinate plane_coordinate{ { DimensionIndex::C, 0 } };
+
+    ResetGlobalPerformanceCounters();
+
+    ISingleChannelScalingTileAccessor::Options options;
+    options.Clear();
+    options.useVisibilityCheckOptimization = true;
+    options.subBlockCache = CreateSubBlockCache();
+    options.onlyUseSubBlockCacheForCompressedData = false;
+
+    // use a zoom different from 1, so that the nearest-neighbor scaling is used (with zoom 1 a simple copy is done)
+    accessor->Get(PixelType::Gray8, IntRect{ 0, 0, 4, 4 }, &plane_coordinate, 0.5f, &options);
+    accessor->Get(PixelType::Gray8, IntRect{ 0, 0, 4, 4 }, &plane_coordinate, 0.5f, &options);
+
+    const auto counters = GetGlobalPerformanceCounters();
+    EXPECT_EQ(counters.GetCounter(PerformanceCounter::TilesCulledByVisibilityCheck), 4u);
+    EXPECT_EQ(counters.GetCounter(PerformanceCounter::SubBlockCacheMisses), 1u);
+    EXPECT_EQ(counters.GetCounter(PerformanceCounter::SubBlockCacheHits), 1u);
+    EXPECT_EQ(counters.GetCounter(PerformanceCounter::SubBlocksRead), 1u);
+    EXPECT_EQ(counters.GetTimer(PerformanceTimer::SingleChannelAccessorGet).count, 2u);
+    EXPECT_EQ(counters.GetTimer(PerformanceTimer::NNResize).count, 2u);
+
+    ResetGlobalPerformanceCounters();
+    const auto counters_after_reset = GetGlobalPerformanceCounters();
+    EXPECT_EQ(counters_after_reset.GetCounter(PerformanceCounter::TilesCulledByVisibilityCheck), 0u);
+    EXPECT_EQ(counters_after_reset.GetTimer(PerformanceTimer::SingleChannelAccessorGet).count, 0u);
+}
+
+TEST(Instrumentation, ChromeTraceEventSink)
+{
+    auto czi_document_as_blob = CreateCziWithGray8SubBlocks({ { 0, 0, 4, 4 }, { 4, 0, 4, 4 } });
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+    const auto accessor = reader->CreateSingleChannelScalingTileAccessor();
+    const CDimCoordinate plane_coordinate{ { DimensionIndex::C, 0 } };
+
+    const auto trace_output_stream = make_shared<CMemOutputStream>(0);
+    auto sink = CreateChromeTraceEventSink(trace_output_stream);
+    SetTraceEventSink(sink);
+    accessor->Get(PixelType::Gray8, IntRect{ 0, 0, 8, 4 }, &plane_coordinate, 0.5f, nullptr);
+    SetTraceEventSink(nullptr);
+    sink.reset();
+
+    const string trace(trace_output_stream->GetDataC(), trace_output_stream->GetDataSize());
+    EXPECT_EQ(trace.substr(0, 2), "[\n");
+    EXPECT_EQ(trace.substr(trace.size() - 3), "\n]\n");
+    EXPECT_NE(trace.find("{\"name\":\"SingleChannelAccessorGet\",\"cat\":\"libCZI\",\"ph\":\"X\""), string::npos);
+    EXPECT_NE(trace.find("{\"name\":\"NNResize\""), string::npos);
+    EXPECT_NE(trace.find("{\"name\":\"StreamRead\""), string::npos);
+}
+
+namespace
+{
+    /// An output stream which writes at most 3 bytes with each call (in order to check that short writes are handled).
+    class CShortWritesOutputStream : public IOutputStream
+    {
+    private:
+        CMemOutputStream stream_{ 0 };
+    public:
+        void Write(std::uint64_t offset, const void* pv, std::uint64_t size, std::uint64_t* ptrBytesWritten) override
+        {
+            this->stream_.Write(offset, pv, (std::min)(size, static_cast<std::uint64_t>(3)), ptrBytesWritten);
+        }
+
+        string GetData() const
+        {
+            return string(this->stream_.GetDataC(), this->stream_.GetDataSize());
+        }
+    };
+}
+
+TEST(Instrumentation, ChromeTraceEventSinkWithShortWritesAndCharactersToBeEscaped)
+{
+    const auto trace_output_stream = make_shared<CShortWritesOutputStream>();
+    auto sink = CreateChromeTraceEventSink(trace_output_stream);
+    sink->AddCompleteEvent("a\"b\\c\nd\x01", "cat\t", 1, 2, 3);
+    sink.reset();
+
+    EXPECT_EQ(
+        trace_output_stream->GetData(),
+        "[\n{\"name\":\"a\\\"b\\\\c\\u000ad\\u0001\",\"cat\":\"cat\\u0009\",\"ph\":\"X\",\"ts\":1,\"dur\":2,\"pid\":1,\"tid\":3}\n]\n");
+}
+
+TEST(Instrumentation, ScalingAccessorRequestStatistics)
+{
+    // two subblocks at the same position (so that with the visibility check the lower one is culled), and one next to them
+    auto czi_document_as_blob = CreateCziWithGray8SubBlocks({ { 0, 0, 4, 4 }, { 0, 0, 4, 4 }, { 4, 0, 4, 4 } });
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+    const auto accessor = reader->CreateSingleChannelScalingTileAccessor();
+    const CDimCoordinate plane_coordinate{ { DimensionIndex::C, 0 } };
+
+    AccessorStatistics statistics;
+    ISingleChannelScalingTileAccessor::Options options;
+    options.Clear();
+    options.useVisibilityCheckOptimization = true;
+    options.subBlockCache = CreateSubBlockCache();
+    options.onlyUseSubBlockCacheForCompressedData = false;
+    options.statistics = &statistics;
+    accessor->Get(PixelType::Gray8, IntRect{ 0, 0, 8, 4 }, &plane_coordinate, 0.5f, &options);
+
+    EXPECT_EQ(statistics.subBlocksEnumerated, 3u);
+    EXPECT_EQ(statistics.subBlocksCulled, 1u);
+    EXPECT_EQ(statistics.subBlocksReadFromStream, 2u);
+    EXPECT_EQ(statistics.subBlocksFromCache, 0u);
+    EXPECT_EQ(statistics.compressedBytesRead, 2u * 16u);
+    EXPECT_GT(statistics.totalNanoseconds, 0u);
+    EXPECT_GE(statistics.totalNanoseconds, statistics.enumerateNanoseconds + statistics.readNanoseconds + statistics.decodeNanoseconds + statistics.scaleNanoseconds);
+
+    // the second request is served from the cache, and the statistics are reset at the start of the request
+    accessor->Get(PixelType::Gray8, IntRect{ 0, 0, 8, 4 }, &plane_coordinate, 0.5f, &options);
+
+    EXPECT_EQ(statistics.subBlocksEnumerated, 3u);
+    EXPECT_EQ(statistics.subBlocksCulled, 1u);
+    EXPECT_EQ(statistics.subBlocksReadFromStream, 0u);
+    EXPECT_EQ(statistics.subBlocksFromCache, 2u);
+    EXPECT_EQ(statistics.compressedBytesRead, 0u);
+    EXPECT_EQ(statistics.readNanoseconds, 0u);
+    EXPECT_EQ(statistics.decodeNanoseconds, 0u);
+}
@@ -6,6 +6,8 @@
 #include "inc_libCZI.h"
 #include "../libCZI/bitmapData.h"
 #include "../libCZI/utilities.h"
+#include "../libCZI/BitmapOperationsBitonal.h"
+#include <random>
 #include "MemOutputStream.h"
 #include "utils.h"
 
@@ -1092,3 +1094,181 @@ TEST(MaskAwareComposition, SingleChannelTileAccessorMaskTooSmallComposeWithoutMa
         }
     }
 }
+
+namespace
+{
+    /// Fill the bitonal bitmap with a pattern consisting of long runs of "1"s and "0"s, interspersed with
+    /// regions of random bits - so that all code paths of the span-based mask processing are exercised.
+    void FillMaskWithRunsAndNoise(IBitonalBitmapData* mask, uint32_t seed)
+    {
+        mt19937 random_engine(seed);
+        uniform_int_distribution<int> run_length_distribution(1, 150);
+        uniform_int_distribution<int> kind_distribution(0, 2);
+        ScopedBitonalBitmapLockerP mask_locker{ mask };
+        for (uint32_t y = 0; y < mask->GetHeight(); ++y)
+        {
+            uint32_t x = 0;
+            while (x < mask->GetWidth())
+            {
+                const int kind = kind_distribution(random_engine);
+                const uint32_t length = (min)(static_cast<uint32_t>(run_length_distribution(random_engine)), mask->GetWidth() - x);
+                for (uint32_t i = 0; i < length; ++i)
+                {
+                    const bool value = kind == 0 ? false : (kind == 1 ? true : (random_engine() & 1) != 0);
+                    BitmapOperationsBitonal::SetPixelInBitonalUnchecked(x + i, y, mask_locker.ptrData, mask_locker.stride, value);
+                }
+
+                x += length;
+            }
+        }
+    }
+
+    shared_ptr<IBitmapData> CreateGray16BitmapWithRandomContent(uint32_t width, uint32_t height, uint32_t seed)
+    {
+        mt19937 random_engine(seed);
+        auto bitmap = CStdBitmapData::Create(PixelType::Gray16, width, height);
+        ScopedBitmapLockerSP locker{ bitmap };
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            uint16_t* line = reinterpret_cast<uint16_t*>(static_cast<uint8_t*>(locker.ptrDataRoi) + y * static_cast<size_t>(locker.stride));
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                line[x] = static_cast<uint16_t>(random_engine());
+            }
+        }
+
+        return bitmap;
+    }
+}
+
+TEST(MaskAwareComposition, CopyWithOffsetAndMaskCompareToPixelwiseReference)
+{
+    constexpr uint32_t kWidth = 301;
+    constexpr uint32_t kHeight = 97;
+    const auto source = CreateGray16BitmapWithRandomContent(kWidth, kHeight, 1);
+    const auto mask = CBitonalBitmapData<>::Create(kWidth, kHeight);
+    FillMaskWithRunsAndNoise(mask.get(), 2);
+
+    for (const auto& offset : { IntPoint{ 0, 0 }, IntPoint{ -3, 5 }, IntPoint{ 17, -9 }, IntPoint{ -70, -1 } })
+    {
+        for (const auto destination_pixel_type : { PixelType::Gray16, PixelType::Gray8 })
+        {
+            auto destination = CStdBitmapData::Create(destination_pixel_type, 280, 90);
+            CBitmapOperations::Fill(destination.get(), RgbFloatColor{ 0.5f, 0.5f, 0.5f });
+            auto expected = CStdBitmapData::Create(destination_pixel_type, 280, 90);
+            CBitmapOperations::Fill(expected.get(), RgbFloatColor{ 0.5f, 0.5f, 0.5f });
+
+            {
+                ScopedBitmapLockerSP source_locker{ source };
+                ScopedBitonalBitmapLockerSP mask_locker{ mask };
+                ScopedBitmapLockerSP destination_locker{ destination };
+                BitmapOperationsBitonal::CopyWithOffsetAndMaskInfo info;
+                info.xOffset = offset.x;
+                info.yOffset = offset.y;
+                info.srcPixelType = source->GetPixelType();
+                info.srcPtr = source_locker.ptrDataRoi;
+                info.srcStride = source_locker.stride;
+                info.srcWidth = static_cast<int>(source->GetWidth());
+                info.srcHeight = static_cast<int>(source->GetHeight());
+                info.dstPixelType = destination->GetPixelType();
+                info.dstPtr = destination_locker.ptrDataRoi;
+                info.dstStride = destination_locker.stride;
+                info.dstWidth = static_cast<int>(destination->GetWidth());
+                info.dstHeight = static_cast<int>(destination->GetHeight());
+                info.drawTileBorder = false;
+                info.maskPtr = mask_locker.ptrData;
+                info.maskStride = static_cast<int>(mask_locker.stride);
+                info.maskWidth = static_cast<int>(mask->GetWidth());
+                info.maskHeight = static_cast<int>(mask->GetHeight());
+                BitmapOperationsBitonal::CopyWithOffsetAndMask(info);
+            }
+
+            // now, create the expected result by checking the mask pixel-by-pixel
+            {
+                ScopedBitmapLockerSP source_locker{ source };
+                ScopedBitonalBitmapLockerSP mask_locker{ mask };
+                ScopedBitmapLockerSP expected_locker{ expected };
+                for (int y = 0; y < static_cast<int>(expected->GetHeight()); ++y)
+                {
+                    for (int x = 0; x < static_cast<int>(expected->GetWidth()); ++x)
+                    {
+                        const int x_source = x - offset.x;
+                        const int y_source = y - offset.y;
+                        if (x_source < 0 || y_source < 0 || x_source >= static_cast<int>(kWidth) || y_source >= static_cast<int>(kHeight) ||
+                            !BitmapOperationsBitonal::GetPixelFromBitonalUnchecked(x_source, y_source, mask_locker.ptrData, mask_locker.stride))
+                        {
+                            continue;
+                        }
+
+                        const uint16_t source_value = *reinterpret_cast<const uint16_t*>(static_cast<const uint8_t*>(source_locker.ptrDataRoi) + y_source * static_cast<size_t>(source_locker.stride) + x_source * 2);
+                        uint8_t* expected_pixel = static_cast<uint8_t*>(expected_locker.ptrDataRoi) + y * static_cast<size_t>(expected_locker.stride);
+                        if (destination_pixel_type == PixelType::Gray16)
+                        {
+                            reinterpret_cast<uint16_t*>(expected_pixel)[x] = source_value;
+                        }
+                        else
+                        {
+                            CConvGray16ToGray8().ConvertPixel(expected_pixel + x, &source_value);
+                        }
+                    }
+                }
+            }
+
+            EXPECT_TRUE(AreBitmapDataEqual(destination, expected));
+        }
+    }
+}
+
+TEST(MaskAwareComposition, NNResizeMaskAwareCompareToPixelwiseReference)
+{
+    constexpr uint32_t kWidth = 260;
+    constexpr uint32_t kHeight = 70;
+    const auto source = CreateGray16BitmapWithRandomContent(kWidth, kHeight, 3);
+    const auto mask = CBitonalBitmapData<>::Create(kWidth - 5, kHeight);
+    FillMaskWithRunsAndNoise(mask.get(), 4);
+
+    // we test "downscaling" and "upscaling" here, and one case where the source ROI extends beyond the source bitmap
+    for (const auto& rois : { make_tuple(DblRect{ 0, 0, 260, 70 }, DblRect{ 0, 0, 130, 35 }),
+                              make_tuple(DblRect{ 10, 5, 100, 30 }, DblRect{ 0, 0, 310, 95 }),
+                              make_tuple(DblRect{ -20, -7, 300, 80 }, DblRect{ 3, 2, 200, 60 }) })
+    {
+        auto destination = CStdBitmapData::Create(PixelType::Gray16, 320, 100);
+        CBitmapOperations::Fill(destination.get(), RgbFloatColor{ 0.5f, 0.5f, 0.5f });
+        auto expected = CStdBitmapData::Create(PixelType::Gray16, 320, 100);
+        CBitmapOperations::Fill(expected.get(), RgbFloatColor{ 0.5f, 0.5f, 0.5f });
+
+        BitmapOperationsBitonal::NNResizeMaskAware(source.get(), mask.get(), destination.get(), get<0>(rois), get<1>(rois));
+
+        // we first do a NN-resize without mask, and then copy pixel-by-pixel where the (resized) mask is set
+        auto resized_without_mask = CStdBitmapData::Create(PixelType::Gray16, 320, 100);
+        CBitmapOperations::Fill(resized_without_mask.get(), RgbFloatColor{ 0.5f, 0.5f, 0.5f });
+        CBitmapOperations::NNResize(source.get(), resized_without_mask.get(), get<0>(rois), get<1>(rois));
+        {
+            const DblRect& roi_source = get<0>(rois);
+            const DblRect& roi_destination = get<1>(rois);
+            ScopedBitonalBitmapLockerSP mask_locker{ mask };
+            ScopedBitmapLockerSP resized_locker{ resized_without_mask };
+            ScopedBitmapLockerSP expected_locker{ expected };
+            for (int y = 0; y < static_cast<int>(expected->GetHeight()); ++y)
+            {
+                const long y_source = (min)((max)(lround((y - roi_destination.y) * (roi_source.h / roi_destination.h) + roi_source.y), 0L), static_cast<long>(kHeight) - 1);
+                for (int x = 0; x < static_cast<int>(expected->GetWidth()); ++x)
+                {
+                    const long x_source = (min)((max)(lround((x - roi_destination.x) * (roi_source.w / roi_destination.w) + roi_source.x), 0L), static_cast<long>(kWidth) - 1);
+                    if (x_source >= static_cast<long>(mask->GetWidth()) ||
+                        !BitmapOperationsBitonal::GetPixelFromBitonalUnchecked(x_source, y_source, mask_locker.ptrData, mask_locker.stride))
+                    {
+                        continue;
+                    }
+
+                    memcpy(
+                        static_cast<uint8_t*>(expected_locker.ptrDataRoi) + y * static_cast<size_t>(expected_locker.stride) + x * 2,
+                        static_cast<const uint8_t*>(resized_locker.ptrDataRoi) + y * static_cast<size_t>(resized_locker.stride) + x * 2,
+                        2);
+                }
+            }
+        }
+
+        EXPECT_TRUE(AreBitmapDataEqual(destination, expected));
+    }
+}
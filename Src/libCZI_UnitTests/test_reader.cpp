@@ -1452,3 +1452,231 @@ TEST(CziReader, ReadSubBlockWithZstd1CompressionWithHiLoBytePackTooLargeDisableR
     options.handle_zstd_data_size_mismatch = false;
     EXPECT_THROW(sub_block->CreateBitmap(&options), exception);
 }
+
+static void AddGray8SubBlockToWriter(ICziWriter* writer, int m_index, uint8_t value)
+{
+    constexpr size_t size_of_bitmap = 10 * 10;
+    uint8_t bitmap[size_of_bitmap];
+    memset(bitmap, value, size_of_bitmap);
+    AddSubBlockInfoStridedBitmap addSbBlkInfo;
+    addSbBlkInfo.Clear();
+    addSbBlkInfo.coordinate.Set(DimensionIndex::C, 0);
+    addSbBlkInfo.coordinate.Set(DimensionIndex::T, 0);
+    addSbBlkInfo.mIndexValid = true;
+    addSbBlkInfo.mIndex = m_index;
+    addSbBlkInfo.x = m_index * 10;
+    addSbBlkInfo.y = 0;
+    addSbBlkInfo.logicalWidth = 10;
+    addSbBlkInfo.logicalHeight = 10;
+    addSbBlkInfo.physicalWidth = 10;
+    addSbBlkInfo.physicalHeight = 10;
+    addSbBlkInfo.PixelType = PixelType::Gray8;
+    addSbBlkInfo.ptrBitmap = bitmap;
+    addSbBlkInfo.strideBitmap = 10;
+    writer->SyncAddSubBlock(addSbBlkInfo);
+}
+
+static void WriteMetadataAndClose(ICziWriter* writer)
+{
+    const auto metaDataBuilder = writer->GetPreparedMetadata(PrepareMetadataInfo{});
+    WriteMetadataInfo write_metadata_info;
+    const auto& strMetadata = metaDataBuilder->GetXml();
+    write_metadata_info.szMetadata = strMetadata.c_str();
+    write_metadata_info.szMetadataSize = strMetadata.size() + 1;
+    write_metadata_info.ptrAttachment = nullptr;
+    write_metadata_info.attachmentSize = 0;
+    writer->SyncWriteMetadata(write_metadata_info);
+    writer->Close();
+}
+
+static uint8_t GetFirstPixelOfSubBlock(ICZIReader* reader, int index)
+{
+    const auto bitmap = reader->ReadSubBlock(index)->CreateBitmap();
+    const ScopedBitmapLockerSP lck{ bitmap };
+    return *static_cast<const uint8_t*>(lck.ptrDataRoi);
+}
+
+TEST(CziReader, OpenDocumentBeingWrittenInFollowModeAndCheckThatRefreshPicksUpAppendedSegments)
+{
+    // arrange
+    const auto stream = make_shared<CMemInputOutputStream>(0);
+    const auto writer = CreateCZIWriter();
+    writer->Create(
+        stream,
+        make_shared<CCziWriterInfo>(
+            GUID{ 0x1234567,0x89ab,0xcdef,{ 1,2,3,4,5,6,7,8 } },
+            CDimBounds{ { DimensionIndex::T, 0, 1 }, { DimensionIndex::C, 0, 1 } }));
+    for (int i = 0; i < 3; ++i)
+    {
+        AddGray8SubBlockToWriter(writer.get(), i, static_cast<uint8_t>(i + 1));
+    }
+
+    const auto reader = CreateCZIReader();
+    ICZIReader::OpenOptions open_options;
+    open_options.follow_appended_segments = true;
+
+    // act
+    reader->Open(stream, &open_options);
+
+    // assert
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 3);
+    EXPECT_EQ(GetFirstPixelOfSubBlock(reader.get(), 2), 3);
+    EXPECT_THROW(reader->ReadMetadataSegment(), LibCZISegmentNotPresent);
+
+    // act
+    for (int i = 3; i < 5; ++i)
+    {
+        AddGray8SubBlockToWriter(writer.get(), i, static_cast<uint8_t>(i + 1));
+    }
+
+    static const uint8_t attachmentData[4] = { 1,2,3,4 };
+    AddAttachmentInfo attchmntInfo;
+    attchmntInfo.ptrData = attachmentData;
+    attchmntInfo.dataSize = sizeof(attachmentData);
+    attchmntInfo.SetName("Test");
+    attchmntInfo.SetContentFileType("BIN");
+    attchmntInfo.contentGuid = { 0x7b86d8b2,0x3b86,0x4bf8,{ 0x98,0x3a,0xc6,0x8e,0x03,0x0a,0x2d,0x7e } };
+    writer->SyncAddAttachment(attchmntInfo);
+
+    // assert
+    EXPECT_EQ(reader->Refresh(), 2);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 5);
+    EXPECT_EQ(reader->GetStatistics().boundingBox.w, 50);
+    EXPECT_EQ(GetFirstPixelOfSubBlock(reader.get(), 4), 5);
+    EXPECT_EQ(reader->GetAttachmentCount(), 1);
+    size_t attachment_size;
+    const auto attachment_data = reader->ReadAttachment(0)->GetRawData(&attachment_size);
+    ASSERT_EQ(attachment_size, sizeof(attachmentData));
+    EXPECT_EQ(memcmp(attachment_data.get(), attachmentData, sizeof(attachmentData)), 0);
+    EXPECT_EQ(reader->Refresh(), 0);
+
+    // act
+    WriteMetadataAndClose(writer.get());
+
+    // assert
+    EXPECT_EQ(reader->Refresh(), 0);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 5);
+    EXPECT_EQ(reader->GetAttachmentCount(), 1);
+    EXPECT_NO_THROW(reader->ReadMetadataSegment());
+    EXPECT_TRUE(reader->GetFileHeaderInfo().fileGuid == (GUID{ 0x1234567,0x89ab,0xcdef,{ 1,2,3,4,5,6,7,8 } }));
+}
+
+TEST(CziReader, OpenDocumentBeingWrittenWithWriteCombiningBufferInFollowModeAndCheckThatSegmentsArePickedUpAfterFlush)
+{
+    // arrange
+    const auto stream = make_shared<CMemInputOutputStream>(0);
+    CZIWriterOptions writer_options;
+    writer_options.use_write_combining_buffer_for_all_streams = true;
+    const auto writer = CreateCZIWriter(&writer_options);
+    writer->Create(
+        stream,
+        make_shared<CCziWriterInfo>(
+            GUID{ 0x1234567,0x89ab,0xcdef,{ 1,2,3,4,5,6,7,8 } },
+            CDimBounds{ { DimensionIndex::T, 0, 1 }, { DimensionIndex::C, 0, 1 } }));
+    for (int i = 0; i < 3; ++i)
+    {
+        AddGray8SubBlockToWriter(writer.get(), i, static_cast<uint8_t>(i + 1));
+    }
+
+    writer->Flush();
+
+    const auto reader = CreateCZIReader();
+    ICZIReader::OpenOptions open_options;
+    open_options.follow_appended_segments = true;
+
+    // act
+    reader->Open(stream, &open_options);
+
+    // assert
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 3);
+
+    // act
+    for (int i = 3; i < 5; ++i)
+    {
+        AddGray8SubBlockToWriter(writer.get(), i, static_cast<uint8_t>(i + 1));
+    }
+
+    // assert
+    EXPECT_EQ(reader->Refresh(), 0) << "the subblocks are still held in the write-combining buffer";
+
+    // act
+    writer->Flush();
+
+    // assert
+    EXPECT_EQ(reader->Refresh(), 2);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 5);
+    EXPECT_EQ(GetFirstPixelOfSubBlock(reader.get(), 4), 5);
+
+    // act
+    WriteMetadataAndClose(writer.get());
+
+    // assert
+    EXPECT_EQ(reader->Refresh(), 0);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 5);
+    EXPECT_NO_THROW(reader->ReadMetadataSegment());
+}
+
+TEST(CziReader, OpenDocumentBeingWrittenWithDeduplicationInFollowModeAndCheckThatSharedSegmentsArePickedUpFromDirectory)
+{
+    // arrange
+    const auto stream = make_shared<CMemInputOutputStream>(0);
+    CZIWriterOptions writer_options;
+    writer_options.deduplicate_subblocks = true;
+    const auto writer = CreateCZIWriter(&writer_options);
+    writer->Create(
+        stream,
+        make_shared<CCziWriterInfo>(
+            GUID{ 0,0,0,{ 0,0,0,0,0,0,0,0 } },
+            CDimBounds{ { DimensionIndex::T, 0, 1 }, { DimensionIndex::C, 0, 1 } }));
+
+    const auto reader = CreateCZIReader();
+    ICZIReader::OpenOptions open_options;
+    open_options.follow_appended_segments = true;
+    reader->Open(stream, &open_options);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 0);
+
+    // act
+    AddGray8SubBlockToWriter(writer.get(), 0, 42);
+    AddGray8SubBlockToWriter(writer.get(), 1, 42);
+
+    // assert - the second subblock is stored in the segment of the first one, so it is only known from the subblock-directory
+    EXPECT_EQ(reader->Refresh(), 1);
+
+    // act
+    WriteMetadataAndClose(writer.get());
+
+    // assert
+    EXPECT_EQ(reader->Refresh(), 1);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 2);
+    SubBlockInfo info;
+    ASSERT_TRUE(reader->TryGetSubBlockInfo(1, &info));
+    EXPECT_EQ(info.logicalRect.x, 10);
+    EXPECT_EQ(GetFirstPixelOfSubBlock(reader.get(), 1), 42);
+}
+
+TEST(CziReader, OpenCompleteDocumentInFollowModeAndCheckRefresh)
+{
+    // arrange
+    auto czi_document_as_blob = CreateTestCzi();
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    ICZIReader::OpenOptions open_options;
+    open_options.follow_appended_segments = true;
+
+    // act
+    reader->Open(memory_stream, &open_options);
+
+    // assert
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 5);
+    EXPECT_EQ(reader->Refresh(), 0);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 5);
+}
+
+TEST(CziReader, CallRefreshWithoutFollowModeAndExpectException)
+{
+    auto czi_document_as_blob = CreateTestCzi();
+    const auto memory_stream = make_shared<CMemInputOutputStream>(get<0>(czi_document_as_blob).get(), get<1>(czi_document_as_blob));
+    const auto reader = CreateCZIReader();
+    reader->Open(memory_stream);
+    EXPECT_THROW(reader->Refresh(), logic_error);
+}
@@ -9,6 +9,8 @@
 #include "MemInputOutputStream.h"
 #include "SegmentWalker.h"
 #include <algorithm>
+#include <cstdio>
+#include <map>
 
 using namespace libCZI;
 using namespace std;
@@ -1548,3 +1550,495 @@ TEST(CziReaderWriter, TryGetSubBlockInfoOfArbitrarySubBlockInChannel)
     b = reader_writer->TryGetSubBlockInfoOfArbitrarySubBlockInChannel(1, sub_block_info);
     EXPECT_FALSE(b);
 }
+
+/// Creates a CZI with 4 subblocks (10x10 pixels, Gray8) with deduplication enabled - the subblocks with M-index 0, 1 and 2 are all-zero
+/// (and therefore share one segment), the subblock with M-index 3 has all pixels set to 3.
+static tuple<shared_ptr<void>, size_t> CreateTestCziWithDeduplicatedSubBlocks()
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.deduplicate_subblocks = true;
+    auto writer = CreateCZIWriter(&writerOptions);
+    auto outStream = make_shared<CMemOutputStream>(0);
+    auto spWriterInfo = make_shared<CCziWriterInfo>(GUID{ 0x1234567,0x89ab,0xcdef,{ 1,2,3,4,5,6,7,8 } });
+    writer->Create(outStream, spWriterInfo);
+
+    for (int m = 0; m < 4; ++m)
+    {
+        vector<uint8_t> pixels(10 * 10, m < 3 ? 0 : 3);
+        AddSubBlockInfoMemPtr addSbBlkInfo;
+        addSbBlkInfo.Clear();
+        addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, 0 } };
+        addSbBlkInfo.mIndexValid = true;
+        addSbBlkInfo.mIndex = m;
+        addSbBlkInfo.x = m * 10;
+        addSbBlkInfo.y = 0;
+        addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 10;
+        addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 10;
+        addSbBlkInfo.PixelType = PixelType::Gray8;
+        addSbBlkInfo.ptrData = pixels.data();
+        addSbBlkInfo.dataSize = pixels.size();
+        writer->SyncAddSubBlock(addSbBlkInfo);
+    }
+
+    writer->Close();
+    size_t size;
+    auto data = outStream->GetCopy(&size);
+    return make_tuple(data, size);
+}
+
+TEST(CziReaderWriter, RemoveAndReplaceDeduplicatedSubBlocks)
+{
+    auto testCzi = CreateTestCziWithDeduplicatedSubBlocks();
+
+    const auto input_output_stream = make_shared<CMemInputOutputStream>(get<0>(testCzi).get(), get<1>(testCzi));
+    const auto reader_writer = CreateCZIReaderWriter();
+    reader_writer->Create(input_output_stream);
+
+    map<int, int> index_of_m_index;
+    reader_writer->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            index_of_m_index[info.mIndex] = index;
+            return true;
+        });
+
+    ASSERT_EQ(index_of_m_index.size(), 4);
+
+    // remove the subblock with M-index 0, and replace the one with M-index 1 - the segment shared with M-index 2 must remain intact
+    reader_writer->RemoveSubBlock(index_of_m_index[0]);
+
+    vector<uint8_t> pixels(10 * 10, 0xff);
+    AddSubBlockInfoMemPtr addSbBlkInfo;
+    addSbBlkInfo.Clear();
+    addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, 0 } };
+    addSbBlkInfo.mIndexValid = true;
+    addSbBlkInfo.mIndex = 1;
+    addSbBlkInfo.x = 10;
+    addSbBlkInfo.y = 0;
+    addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 10;
+    addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 10;
+    addSbBlkInfo.PixelType = PixelType::Gray8;
+    addSbBlkInfo.ptrData = pixels.data();
+    addSbBlkInfo.dataSize = pixels.size();
+    reader_writer->ReplaceSubBlock(index_of_m_index[1], addSbBlkInfo);
+    reader_writer->Close();
+
+    size_t size;
+    const auto czi = input_output_stream->GetCopy(&size);
+    const auto reader = CreateCZIReader();
+    reader->Open(CreateStreamFromMemory(czi, size), nullptr);
+
+    map<int, uint8_t> pixel_value_of_m_index;
+    reader->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            const auto sub_block = reader->ReadSubBlock(index);
+            size_t size_data;
+            const auto data = sub_block->GetRawData(ISubBlock::MemBlkType::Data, &size_data);
+            EXPECT_EQ(size_data, 100);
+            const uint8_t* p = static_cast<const uint8_t*>(data.get());
+            EXPECT_TRUE(all_of(p, p + size_data, [p](uint8_t v)->bool {return v == p[0]; }));
+            pixel_value_of_m_index[info.mIndex] = p[0];
+            return true;
+        });
+
+    ASSERT_EQ(pixel_value_of_m_index.size(), 3);
+    EXPECT_EQ(pixel_value_of_m_index.count(0), 0);
+    EXPECT_EQ(pixel_value_of_m_index[1], 0xff);
+    EXPECT_EQ(pixel_value_of_m_index[2], 0);
+    EXPECT_EQ(pixel_value_of_m_index[3], 3);
+}
+
+static void AddGray8SubBlockWithMIndex(ICziReaderWriter* reader_writer, int m_index, uint8_t pixel_value)
+{
+    vector<uint8_t> pixels(4 * 4, pixel_value);
+    AddSubBlockInfoMemPtr addSbBlkInfo;
+    addSbBlkInfo.Clear();
+    addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, 0 }, { DimensionIndex::Z, 0 } };
+    addSbBlkInfo.mIndexValid = true;
+    addSbBlkInfo.mIndex = m_index;
+    addSbBlkInfo.x = m_index * 4;
+    addSbBlkInfo.y = 0;
+    addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 4;
+    addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 4;
+    addSbBlkInfo.PixelType = PixelType::Gray8;
+    addSbBlkInfo.ptrData = pixels.data();
+    addSbBlkInfo.dataSize = pixels.size();
+    reader_writer->SyncAddSubBlock(addSbBlkInfo);
+}
+
+static map<string, int> CountSegments(IStream* stream)
+{
+    map<string, int> segment_count;
+    CSegmentWalker::Walk(
+        stream,
+        [&](int, const std::string& id, std::int64_t, std::int64_t)->bool
+        {
+            ++segment_count[id];
+            return true;
+        });
+
+    return segment_count;
+}
+
+TEST(CziReaderWriter, CommitAndContinueModifying)
+{
+    auto testCzi = CreateTestCzi();
+    const auto input_output_stream = make_shared<CMemInputOutputStream>(get<0>(testCzi).get(), get<1>(testCzi));
+    const auto reader_writer = CreateCZIReaderWriter();
+    reader_writer->Create(input_output_stream);
+
+    AddGray8SubBlockWithMIndex(reader_writer.get(), 100, 1);
+    reader_writer->Commit();
+
+    // after "Commit", the file is a valid CZI which contains the added subblock
+    size_t size;
+    auto czi = input_output_stream->GetCopy(&size);
+    auto reader = CreateCZIReader();
+    reader->Open(CreateStreamFromMemory(czi, size), nullptr);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 51);
+    EXPECT_EQ(reader->GetStatistics().maxMindex, 100);
+    reader->Close();
+
+    AddGray8SubBlockWithMIndex(reader_writer.get(), 101, 2);
+    reader_writer->Close();
+
+    czi = input_output_stream->GetCopy(&size);
+    reader = CreateCZIReader();
+    reader->Open(CreateStreamFromMemory(czi, size), nullptr);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 52);
+    EXPECT_EQ(reader->GetStatistics().maxMindex, 101);
+}
+
+TEST(CziReaderWriter, AddAndReplaceInMultipleSessionsAndCheckThatSubBlockDirectoryIsUpdatedInPlace)
+{
+    auto testCzi = CreateTestCzi();
+    const auto input_output_stream = make_shared<CMemInputOutputStream>(get<0>(testCzi).get(), get<1>(testCzi));
+
+    // in the first session, the subblock-directory may have to be relocated (if the existing segment has no space left) - in
+    //  this case space is reserved in the new segment, so that subsequent sessions can update the directory in place
+    auto reader_writer = CreateCZIReaderWriter();
+    reader_writer->Create(input_output_stream);
+    AddGray8SubBlockWithMIndex(reader_writer.get(), 100, 1);
+    reader_writer->Close();
+
+    const auto segment_count_after_first_session = CountSegments(input_output_stream.get());
+    EXPECT_EQ(segment_count_after_first_session.at("ZISRAWDIRECTORY"), 1);
+
+    for (int i = 1; i <= 3; ++i)
+    {
+        reader_writer = CreateCZIReaderWriter();
+        reader_writer->Create(input_output_stream);
+        AddGray8SubBlockWithMIndex(reader_writer.get(), 100 + i, static_cast<uint8_t>(1 + i));
+        reader_writer->Close();
+    }
+
+    // now replace a subblock with one of the same size (so that the subblock and its directory-entry can be written in place)
+    reader_writer = CreateCZIReaderWriter();
+    reader_writer->Create(input_output_stream);
+    int key_of_subblock_to_replace = -1;
+    reader_writer->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            if (info.mIndex == 101)
+            {
+                key_of_subblock_to_replace = index;
+                return false;
+            }
+
+            return true;
+        });
+
+    ASSERT_GE(key_of_subblock_to_replace, 0);
+    vector<uint8_t> pixels(4 * 4, 42);
+    AddSubBlockInfoMemPtr addSbBlkInfo;
+    addSbBlkInfo.Clear();
+    addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, 0 }, { DimensionIndex::Z, 1 } };
+    addSbBlkInfo.mIndexValid = true;
+    addSbBlkInfo.mIndex = 101;
+    addSbBlkInfo.x = 404;
+    addSbBlkInfo.y = 0;
+    addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 4;
+    addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 4;
+    addSbBlkInfo.PixelType = PixelType::Gray8;
+    addSbBlkInfo.ptrData = pixels.data();
+    addSbBlkInfo.dataSize = pixels.size();
+    reader_writer->ReplaceSubBlock(key_of_subblock_to_replace, addSbBlkInfo);
+    reader_writer->Close();
+
+    // the subblock-directory has not been relocated (and no segment has been marked as deleted)
+    auto segment_count = CountSegments(input_output_stream.get());
+    EXPECT_EQ(segment_count.at("ZISRAWDIRECTORY"), 1);
+    EXPECT_EQ(segment_count["DELETED"], segment_count_after_first_session.count("DELETED") > 0 ? segment_count_after_first_session.at("DELETED") : 0);
+    EXPECT_EQ(segment_count.at("ZISRAWSUBBLOCK"), segment_count_after_first_session.at("ZISRAWSUBBLOCK") + 3);
+
+    size_t size;
+    const auto czi = input_output_stream->GetCopy(&size);
+    const auto reader = CreateCZIReader();
+    reader->Open(CreateStreamFromMemory(czi, size), nullptr);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 54);
+    map<int, pair<SubBlockInfo, uint8_t>> added_subblocks;
+    reader->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            if (info.mIndex >= 100)
+            {
+                const auto sub_block = reader->ReadSubBlock(index);
+                size_t size_data;
+                const auto data = sub_block->GetRawData(ISubBlock::MemBlkType::Data, &size_data);
+                added_subblocks[info.mIndex] = make_pair(sub_block->GetSubBlockInfo(), static_cast<const uint8_t*>(data.get())[0]);
+            }
+
+            return true;
+        });
+
+    ASSERT_EQ(added_subblocks.size(), 4);
+    EXPECT_EQ(added_subblocks[100].second, 1);
+    EXPECT_EQ(added_subblocks[101].second, 42);
+    EXPECT_EQ(added_subblocks[102].second, 3);
+    EXPECT_EQ(added_subblocks[103].second, 4);
+    int z;
+    EXPECT_TRUE(added_subblocks[101].first.coordinate.TryGetPosition(DimensionIndex::Z, &z));
+    EXPECT_EQ(z, 1);
+    EXPECT_EQ(added_subblocks[101].first.logicalRect.x, 404);
+}
+
+static tuple<shared_ptr<void>, size_t> CreateTestCziWithDeletedSegments()
+{
+    auto testCzi = CreateTestCzi();
+    const auto input_output_stream = make_shared<CMemInputOutputStream>(get<0>(testCzi).get(), get<1>(testCzi));
+    const auto reader_writer = CreateCZIReaderWriter();
+    reader_writer->Create(input_output_stream);
+
+    // replace the subblocks with M=0 by larger ones (so that the existing segments are marked as deleted) and remove the subblocks with M=4
+    map<int, int> keys_to_replace_with_z;
+    vector<int> keys_to_remove;
+    reader_writer->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            int z;
+            info.coordinate.TryGetPosition(DimensionIndex::Z, &z);
+            if (info.mIndex == 0)
+            {
+                keys_to_replace_with_z[index] = z;
+            }
+            else if (info.mIndex == 4)
+            {
+                keys_to_remove.push_back(index);
+            }
+
+            return true;
+        });
+
+    for (const auto& item : keys_to_replace_with_z)
+    {
+        vector<uint8_t> pixels(8 * 8, static_cast<uint8_t>(100 + item.second));
+        AddSubBlockInfoMemPtr addSbBlkInfo;
+        addSbBlkInfo.Clear();
+        addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, 0 }, { DimensionIndex::Z, item.second } };
+        addSbBlkInfo.mIndexValid = true;
+        addSbBlkInfo.mIndex = 0;
+        addSbBlkInfo.x = 0;
+        addSbBlkInfo.y = 0;
+        addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 8;
+        addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 8;
+        addSbBlkInfo.PixelType = PixelType::Gray8;
+        addSbBlkInfo.ptrData = pixels.data();
+        addSbBlkInfo.dataSize = pixels.size();
+        reader_writer->ReplaceSubBlock(item.first, addSbBlkInfo);
+    }
+
+    for (const int key : keys_to_remove)
+    {
+        reader_writer->RemoveSubBlock(key);
+    }
+
+    static const uint8_t attachment_data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    AddAttachmentInfo attachment_info;
+    attachment_info.Clear();
+    attachment_info.contentGuid = GUID{ 0x11111111, 0x2222, 0x3333, { 4, 4, 4, 4, 4, 4, 4, 4 } };
+    attachment_info.SetContentFileType("BIN");
+    attachment_info.SetName("Test");
+    attachment_info.ptrData = attachment_data;
+    attachment_info.dataSize = sizeof(attachment_data);
+    reader_writer->SyncAddAttachment(attachment_info);
+    reader_writer->Close();
+
+    size_t size;
+    auto czi = input_output_stream->GetCopy(&size);
+    return make_tuple(czi, size);
+}
+
+static map<tuple<int, int>, vector<uint8_t>> GetDataOfSubBlocksByZAndM(ICZIReader* reader)
+{
+    map<tuple<int, int>, vector<uint8_t>> data_of_subblocks;
+    reader->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            int z;
+            info.coordinate.TryGetPosition(DimensionIndex::Z, &z);
+            const auto sub_block = reader->ReadSubBlock(index);
+            size_t size_data;
+            const auto data = sub_block->GetRawData(ISubBlock::MemBlkType::Data, &size_data);
+            data_of_subblocks[make_tuple(z, info.mIndex)] = vector<uint8_t>(static_cast<const uint8_t*>(data.get()), static_cast<const uint8_t*>(data.get()) + size_data);
+            return true;
+        });
+
+    return data_of_subblocks;
+}
+
+TEST(CziReaderWriter, CompactCziWithDeletedSegmentsAndCheckContent)
+{
+    const auto edited_czi = CreateTestCziWithDeletedSegments();
+    const auto edited_stream = CreateStreamFromMemory(get<0>(edited_czi), get<1>(edited_czi));
+    auto segment_count = CountSegments(edited_stream.get());
+    ASSERT_GT(segment_count["DELETED"], 0);
+
+    // some of the subblocks have identical content, so we disable deduplication in order to get one segment per subblock
+    CompactCziOptions options;
+    options.deduplicate_subblocks = false;
+    const auto compacted_stream = make_shared<CMemOutputStream>(0);
+    const auto statistics = CompactCzi(edited_stream, compacted_stream, &options);
+    EXPECT_EQ(statistics.subblock_count, 40);
+    EXPECT_EQ(statistics.attachment_count, 1);
+    EXPECT_TRUE(statistics.metadata_segment_copied);
+    EXPECT_LT(compacted_stream->GetDataSize(), get<1>(edited_czi));
+
+    size_t size;
+    const auto compacted_czi = compacted_stream->GetCopy(&size);
+    const auto compacted_input_stream = CreateStreamFromMemory(compacted_czi, size);
+    segment_count = CountSegments(compacted_input_stream.get());
+    EXPECT_EQ(segment_count.count("DELETED"), 0);
+    EXPECT_EQ(segment_count.at("ZISRAWSUBBLOCK"), 40);
+    EXPECT_EQ(segment_count.at("ZISRAWATTACH"), 1);
+    EXPECT_EQ(segment_count.at("ZISRAWMETADATA"), 1);
+
+    const auto reader_edited = CreateCZIReader();
+    reader_edited->Open(CreateStreamFromMemory(get<0>(edited_czi), get<1>(edited_czi)), nullptr);
+    const auto reader_compacted = CreateCZIReader();
+    reader_compacted->Open(compacted_input_stream, nullptr);
+
+    // the file-GUID is retained by default
+    const auto guid_edited = reader_edited->GetFileHeaderInfo().fileGuid;
+    const auto guid_compacted = reader_compacted->GetFileHeaderInfo().fileGuid;
+    EXPECT_TRUE(memcmp(&guid_edited, &guid_compacted, sizeof(GUID)) == 0);
+
+    const auto data_edited = GetDataOfSubBlocksByZAndM(reader_edited.get());
+    const auto data_compacted = GetDataOfSubBlocksByZAndM(reader_compacted.get());
+    EXPECT_EQ(data_edited.size(), 40);
+    EXPECT_TRUE(data_edited == data_compacted);
+    EXPECT_EQ(data_compacted.at(make_tuple(3, 0)), vector<uint8_t>(8 * 8, 103));
+
+    ASSERT_EQ(reader_compacted->GetAttachmentCount(), 1);
+    const auto attachment = reader_compacted->ReadAttachment(0);
+    EXPECT_STREQ(attachment->GetAttachmentInfo().name.c_str(), "Test");
+    size_t size_attachment;
+    const auto attachment_data = attachment->GetRawData(&size_attachment);
+    ASSERT_EQ(size_attachment, 8);
+    EXPECT_EQ(static_cast<const uint8_t*>(attachment_data.get())[7], 8);
+
+    const auto metadata_edited = reader_edited->ReadMetadataSegment()->CreateMetaFromMetadataSegment()->GetXml();
+    const auto metadata_compacted = reader_compacted->ReadMetadataSegment()->CreateMetaFromMetadataSegment()->GetXml();
+    EXPECT_EQ(metadata_edited, metadata_compacted);
+}
+
+TEST(CziReaderWriter, CompactCziFileInPlaceAndCheckContentAndThatTemporaryFileIsRemoved)
+{
+    const auto edited_czi = CreateTestCziWithDeletedSegments();
+    const string filename_utf8 = testing::TempDir() + "libczi_compactczifile_test.czi";
+    const wstring filename(filename_utf8.cbegin(), filename_utf8.cend());
+    CreateOutputStreamForFile(filename.c_str(), true)->Write(0, get<0>(edited_czi).get(), get<1>(edited_czi), nullptr);
+
+    // the source stream is passed in as a temporary, so it is released before the file is replaced
+    const auto statistics = CompactCziFile(CreateStreamFromFile(filename.c_str()), filename.c_str());
+    EXPECT_EQ(statistics.subblock_count, 40);
+    EXPECT_ANY_THROW(CreateStreamFromFile((filename + L".partial").c_str()));
+
+    const auto reader_edited = CreateCZIReader();
+    reader_edited->Open(CreateStreamFromMemory(get<0>(edited_czi), get<1>(edited_czi)), nullptr);
+    const auto reader_compacted = CreateCZIReader();
+    reader_compacted->Open(CreateStreamFromFile(filename.c_str()), nullptr);
+    const auto compacted_stream_for_counting = CreateStreamFromFile(filename.c_str());
+    EXPECT_EQ(CountSegments(compacted_stream_for_counting.get()).count("DELETED"), 0);
+    EXPECT_TRUE(GetDataOfSubBlocksByZAndM(reader_edited.get()) == GetDataOfSubBlocksByZAndM(reader_compacted.get()));
+    reader_compacted->Close();
+
+    remove(filename_utf8.c_str());
+}
+
+TEST(CziReaderWriter, CompactDeduplicatedCziAndCheckThatSharedSegmentsAreRetained)
+{
+    const auto test_czi = CreateTestCziWithDeduplicatedSubBlocks();
+    const auto source_stream = CreateStreamFromMemory(get<0>(test_czi), get<1>(test_czi));
+    ASSERT_EQ(CountSegments(source_stream.get()).at("ZISRAWSUBBLOCK"), 2);
+
+    // with the default options, the segments shared in the source are shared in the destination as well
+    const auto compacted_stream = make_shared<CMemOutputStream>(0);
+    const auto statistics = CompactCzi(source_stream, compacted_stream);
+    EXPECT_EQ(statistics.subblock_count, 4);
+    EXPECT_LE(compacted_stream->GetDataSize(), get<1>(test_czi));
+
+    size_t size;
+    const auto compacted_czi = compacted_stream->GetCopy(&size);
+    const auto compacted_input_stream = CreateStreamFromMemory(compacted_czi, size);
+    EXPECT_EQ(CountSegments(compacted_input_stream.get()).at("ZISRAWSUBBLOCK"), 2);
+
+    const auto reader = CreateCZIReader();
+    reader->Open(compacted_input_stream, nullptr);
+    map<int, vector<uint8_t>> data_by_m_index;
+    reader->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            size_t size_data;
+            const auto data = reader->ReadSubBlock(index)->GetRawData(ISubBlock::MemBlkType::Data, &size_data);
+            data_by_m_index[info.mIndex] = vector<uint8_t>(static_cast<const uint8_t*>(data.get()), static_cast<const uint8_t*>(data.get()) + size_data);
+            return true;
+        });
+    ASSERT_EQ(data_by_m_index.size(), 4);
+    EXPECT_EQ(data_by_m_index.at(0), vector<uint8_t>(10 * 10, 0));
+    EXPECT_EQ(data_by_m_index.at(2), vector<uint8_t>(10 * 10, 0));
+    EXPECT_EQ(data_by_m_index.at(3), vector<uint8_t>(10 * 10, 3));
+
+    // without deduplication, every subblock gets its own segment
+    CompactCziOptions options;
+    options.deduplicate_subblocks = false;
+    const auto compacted_stream_without_deduplication = make_shared<CMemOutputStream>(0);
+    CompactCzi(CreateStreamFromMemory(get<0>(test_czi), get<1>(test_czi)), compacted_stream_without_deduplication, &options);
+    const auto compacted_czi_without_deduplication = compacted_stream_without_deduplication->GetCopy(&size);
+    EXPECT_EQ(CountSegments(CreateStreamFromMemory(compacted_czi_without_deduplication, size).get()).at("ZISRAWSUBBLOCK"), 4);
+}
+
+TEST(CziReaderWriter, CompactCziWithSpatialLayoutAndNewFileGuidThenEditWithReaderWriter)
+{
+    const auto edited_czi = CreateTestCziWithDeletedSegments();
+
+    CompactCziOptions options;
+    options.subblock_layout = CZIWriterSubBlockLayout::PlaneThenHilbertOrder;
+    options.keep_file_guid = false;
+    options.file_guid = GUID{ 0xabcdef01, 0x2345, 0x6789, { 9, 8, 7, 6, 5, 4, 3, 2 } };
+    const auto compacted_stream = make_shared<CMemOutputStream>(0);
+    const auto statistics = CompactCzi(CreateStreamFromMemory(get<0>(edited_czi), get<1>(edited_czi)), compacted_stream, &options);
+    EXPECT_EQ(statistics.subblock_count, 40);
+
+    // the compacted document is a valid CZI which can be edited further with the reader-writer
+    size_t size;
+    const auto compacted_czi = compacted_stream->GetCopy(&size);
+    const auto input_output_stream = make_shared<CMemInputOutputStream>(compacted_czi.get(), size);
+    const auto reader_writer = CreateCZIReaderWriter();
+    reader_writer->Create(input_output_stream);
+    const auto file_guid = reader_writer->GetFileHeaderInfo().fileGuid;
+    EXPECT_TRUE(memcmp(&file_guid, &options.file_guid, sizeof(GUID)) == 0);
+    EXPECT_EQ(reader_writer->GetStatistics().subBlockCount, 40);
+    AddGray8SubBlockWithMIndex(reader_writer.get(), 100, 1);
+    reader_writer->Close();
+
+    const auto czi = input_output_stream->GetCopy(&size);
+    const auto reader_edited = CreateCZIReader();
+    reader_edited->Open(CreateStreamFromMemory(get<0>(edited_czi), get<1>(edited_czi)), nullptr);
+    const auto reader = CreateCZIReader();
+    reader->Open(CreateStreamFromMemory(czi, size), nullptr);
+    auto data = GetDataOfSubBlocksByZAndM(reader.get());
+    EXPECT_EQ(data.size(), 41);
+    data.erase(make_tuple(0, 100));
+    EXPECT_TRUE(data == GetDataOfSubBlocksByZAndM(reader_edited.get()));
+}
@@ -87,6 +87,112 @@ TEST(CoverageCalculator, RandomRectanglesCompareWithReferenceImplementation)
     }
 }
 
+TEST(CoverageCalculator, RoiCoverageTrackerWithRandomRectanglesCompareWithReferenceImplementation)
+{
+    std::random_device dev;
+    std::mt19937 rng(dev());
+    std::uniform_int_distribution<int> distribution(-10, 109);
+    std::uniform_int_distribution<int> size_distribution(1, 40);
+
+    static constexpr IntRect kRoi{ 0, 0, 100, 100 };
+
+    for (int repeat = 0; repeat < 10; repeat++)
+    {
+        RoiCoverageTracker tracker(kRoi);
+        vector<IntRect> rectangles;
+        int64_t previously_covered_area = 0;
+        for (int i = 0; i < 50; ++i)
+        {
+            rectangles.emplace_back(IntRect{ distribution(rng), distribution(rng), size_distribution(rng), size_distribution(rng) });
+            const int64_t newly_covered_area = tracker.AddRectangle(rectangles.back());
+
+            // after each addition, the covered area must match the reference, and the return value must give the increase
+            const int64_t reference_result_for_covered_area = CalcAreaOfIntersectionWithRectangleReference(rectangles, kRoi);
+            ASSERT_EQ(reference_result_for_covered_area, tracker.GetCoveredArea());
+            ASSERT_EQ(reference_result_for_covered_area - previously_covered_area, newly_covered_area);
+            ASSERT_EQ(reference_result_for_covered_area == static_cast<int64_t>(kRoi.w) * kRoi.h, tracker.IsCompletelyCovered());
+            previously_covered_area = reference_result_for_covered_area;
+        }
+    }
+}
+
+TEST(CoverageCalculator, RoiCoverageTrackerWithMosaicExpectCompletelyCovered)
+{
+    // a 10x10 mosaic of tiles (of size 12x12, so that adjacent tiles overlap by 2 pixels) is added, and the ROI lies
+    //  completely within the mosaic
+    RoiCoverageTracker tracker(IntRect{ 5, 5, 90, 90 });
+    for (int y = 0; y < 10; ++y)
+    {
+        for (int x = 0; x < 10; ++x)
+        {
+            EXPECT_FALSE(tracker.IsCompletelyCovered());
+            tracker.AddRectangle(IntRect{ x * 10, y * 10, 12, 12 });
+        }
+    }
+
+    EXPECT_TRUE(tracker.IsCompletelyCovered());
+    EXPECT_EQ(tracker.GetCoveredArea(), 90 * 90);
+
+    // adding more rectangles does not change anything now
+    EXPECT_EQ(tracker.AddRectangle(IntRect{ 0, 0, 100, 100 }), 0);
+}
+
+TEST(CoverageCalculator, RoiCoverageTrackerWithEmptyRoi)
+{
+    RoiCoverageTracker tracker(IntRect{ 5, 5, 0, 10 });
+    EXPECT_TRUE(tracker.IsCompletelyCovered());
+    EXPECT_EQ(tracker.AddRectangle(IntRect{ 0, 0, 100, 100 }), 0);
+    EXPECT_EQ(tracker.GetCoveredArea(), 0);
+}
+
+TEST(CoverageCalculator, RoiCoverageTrackerWithRandomRectanglesAndCheckUncoveredRectangles)
+{
+    std::random_device dev;
+    std::mt19937 rng(dev());
+    std::uniform_int_distribution<int> distribution(-10, 109);
+    std::uniform_int_distribution<int> size_distribution(1, 40);
+
+    static constexpr IntRect kRoi{ 0, 0, 100, 100 };
+
+    for (int repeat = 0; repeat < 10; repeat++)
+    {
+        RoiCoverageTracker tracker(kRoi);
+        vector<IntRect> rectangles;
+        const int number_of_rectangles = 1 + size_distribution(rng);
+        for (int i = 0; i < number_of_rectangles; ++i)
+        {
+            rectangles.emplace_back(IntRect{ distribution(rng), distribution(rng), size_distribution(rng), size_distribution(rng) });
+            tracker.AddRectangle(rectangles.back());
+        }
+
+        // the uncovered rectangles must be within the ROI, must not intersect with any of the rectangles added, must not
+        //  overlap each other, and together with the covered area they must give the area of the ROI
+        vector<IntRect> uncovered_rectangles;
+        tracker.EnumerateUncoveredRectangles(
+            [&](const IntRect& rect)->void
+            {
+                uncovered_rectangles.push_back(rect);
+            });
+
+        int64_t uncovered_area = 0;
+        for (const auto& uncovered_rectangle : uncovered_rectangles)
+        {
+            EXPECT_TRUE(uncovered_rectangle.IsNonEmpty());
+            EXPECT_EQ(uncovered_rectangle.Intersect(kRoi).w, uncovered_rectangle.w);
+            EXPECT_EQ(uncovered_rectangle.Intersect(kRoi).h, uncovered_rectangle.h);
+            for (const auto& rectangle : rectangles)
+            {
+                EXPECT_FALSE(uncovered_rectangle.IntersectsWith(rectangle));
+            }
+
+            uncovered_area += static_cast<int64_t>(uncovered_rectangle.w) * uncovered_rectangle.h;
+        }
+
+        EXPECT_EQ(CalcAreaOfIntersectionWithRectangleReference(uncovered_rectangles, kRoi), uncovered_area);
+        EXPECT_EQ(uncovered_area + tracker.GetCoveredArea(), static_cast<int64_t>(kRoi.w) * kRoi.h);
+    }
+}
+
 struct CoverageCoverageCalculatorFixture : public testing::TestWithParam<tuple<vector<IntRect>, int64_t>> {};
 
 TEST_P(CoverageCoverageCalculatorFixture, CreateDocumentAndUseSingleChannelScalingTileAccessorWithSortByMAndCheckResult)
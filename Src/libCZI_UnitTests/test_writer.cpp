@@ -2,6 +2,8 @@
 //
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <numeric>
+#include <set>
 #include "include_gtest.h"
 #include "inc_libCZI.h"
 #include "MemOutputStream.h"
@@ -11,6 +13,7 @@
 #include "../libCZI/decoder_zstd.h"
 #include "../libCZI/CziWriter.h"
 #include "../libCZI/CZIReader.h"
+#include "../libCZI/SpatialSubBlockOrder.h"
 
 using namespace libCZI;
 using namespace libCZI::detail;
@@ -2316,3 +2319,941 @@ TEST(CziWriter, TryAddingDuplicateSubBlocksToCziWriterAndWhenCheckIsDisable)
     auto statistics = reader->GetStatistics();
     EXPECT_EQ(statistics.subBlockCount, 2);
 }
+
+namespace
+{
+    /// Create a CZI with a mosaic of subblocks (with random content), where the subblocks are compressed by the
+    /// caller and added with 'SyncAddSubBlock' (if 'useAsyncAdd' is false), or where they are added uncompressed with
+    /// 'AsyncAddSubBlock' (if 'useAsyncAdd' is true). The returned blob is the CZI-file.
+    shared_ptr<void> CreateMosaicCziWithSyncOrAsyncAdd(
+                            const vector<shared_ptr<IBitmapData>>& bitmaps,
+                            CompressionMode compressionMode,
+                            const CZIWriterOptions& writerOptions,
+                            bool useAsyncAdd,
+                            size_t* sizeOfCzi)
+    {
+        const auto writer = CreateCZIWriter(&writerOptions);
+        const auto outStream = make_shared<CMemOutputStream>(0);
+        const auto spWriterInfo = make_shared<CCziWriterInfo>(GUID{ 0x1234567,0x89ab,0xcdef,{ 1,2,3,4,5,6,7,8 } });
+        writer->Create(outStream, spWriterInfo);
+
+        static const char subBlockMetadata[] = "<METADATA><Tags><AcquisitionTime>2024-01-01T00:00:00</AcquisitionTime></Tags></METADATA>";
+        for (size_t i = 0; i < bitmaps.size(); ++i)
+        {
+            const auto& bitmap = bitmaps[i];
+            AddSubBlockInfoBase info;
+            info.coordinate = CDimCoordinate{ { DimensionIndex::C, 0 } };
+            info.mIndexValid = true;
+            info.mIndex = static_cast<int>(i);
+            info.x = static_cast<int>(i % 4) * static_cast<int>(bitmap->GetWidth());
+            info.y = static_cast<int>(i / 4) * static_cast<int>(bitmap->GetHeight());
+            info.logicalWidth = static_cast<int>(bitmap->GetWidth());
+            info.logicalHeight = static_cast<int>(bitmap->GetHeight());
+            info.SetCompressionMode(compressionMode);
+
+            if (useAsyncAdd)
+            {
+                AddSubBlockInfoUncompressedBitmap addSbBlkInfo;
+                static_cast<AddSubBlockInfoBase&>(addSbBlkInfo) = info;
+                addSbBlkInfo.bitmap = bitmap;
+                addSbBlkInfo.ptrSbBlkMetadata = subBlockMetadata;
+                addSbBlkInfo.sbBlkMetadataSize = sizeof(subBlockMetadata) - 1;
+                writer->AsyncAddSubBlock(addSbBlkInfo);
+            }
+            else
+            {
+                ScopedBitmapLockerSP lockBm{ bitmap };
+                shared_ptr<IMemoryBlock> compressedData;
+                switch (compressionMode)
+                {
+                case CompressionMode::Zstd0:
+                    compressedData = ZstdCompress::CompressZStd0Alloc(bitmap->GetWidth(), bitmap->GetHeight(), lockBm.stride, bitmap->GetPixelType(), lockBm.ptrDataRoi, nullptr);
+                    break;
+                case CompressionMode::Zstd1:
+                    compressedData = ZstdCompress::CompressZStd1Alloc(bitmap->GetWidth(), bitmap->GetHeight(), lockBm.stride, bitmap->GetPixelType(), lockBm.ptrDataRoi, nullptr);
+                    break;
+                default:
+                    break;
+                }
+
+                AddSubBlockInfoStridedBitmap addSbBlkInfo;
+                static_cast<AddSubBlockInfoBase&>(addSbBlkInfo) = info;
+                addSbBlkInfo.physicalWidth = static_cast<int>(bitmap->GetWidth());
+                addSbBlkInfo.physicalHeight = static_cast<int>(bitmap->GetHeight());
+                addSbBlkInfo.PixelType = bitmap->GetPixelType();
+                addSbBlkInfo.ptrSbBlkMetadata = subBlockMetadata;
+                addSbBlkInfo.sbBlkMetadataSize = sizeof(subBlockMetadata) - 1;
+                if (compressedData)
+                {
+                    AddSubBlockInfoMemPtr addSbBlkInfoMemPtr;
+                    static_cast<AddSubBlockInfoBase&>(addSbBlkInfoMemPtr) = addSbBlkInfo;
+                    addSbBlkInfoMemPtr.ptrData = compressedData->GetPtr();
+                    addSbBlkInfoMemPtr.dataSize = static_cast<uint32_t>(compressedData->GetSizeOfData());
+                    addSbBlkInfoMemPtr.ptrSbBlkMetadata = subBlockMetadata;
+                    addSbBlkInfoMemPtr.sbBlkMetadataSize = sizeof(subBlockMetadata) - 1;
+                    writer->SyncAddSubBlock(addSbBlkInfoMemPtr);
+                }
+                else
+                {
+                    addSbBlkInfo.ptrBitmap = lockBm.ptrDataRoi;
+                    addSbBlkInfo.strideBitmap = lockBm.stride;
+                    writer->SyncAddSubBlock(addSbBlkInfo);
+                }
+            }
+        }
+
+        const auto metadataBuilder = writer->GetPreparedMetadata(PrepareMetadataInfo());
+        const string xml = metadataBuilder->GetXml(true);
+        WriteMetadataInfo writerMdInfo;
+        writerMdInfo.Clear();
+        writerMdInfo.szMetadata = xml.c_str();
+        writerMdInfo.szMetadataSize = xml.size();
+        writer->SyncWriteMetadata(writerMdInfo);
+        writer->Close();
+
+        return outStream->GetCopy(sizeOfCzi);
+    }
+
+    void CompareSyncAndAsyncAddAndExpectIdenticalResult(PixelType pixelType, CompressionMode compressionMode, const CZIWriterOptions& writerOptions)
+    {
+        vector<shared_ptr<IBitmapData>> bitmaps;
+        for (int i = 0; i < 12; ++i)
+        {
+            // we add some subblocks with constant content, in order to get a wide range of compressed sizes
+            bitmaps.emplace_back((i % 3 == 0) ? CreateTestBitmap(pixelType, 64, 48) : CreateRandomBitmap(pixelType, 64, 48));
+        }
+
+        size_t sizeSync = 0;
+        const auto cziSync = CreateMosaicCziWithSyncOrAsyncAdd(bitmaps, compressionMode, CZIWriterOptions{}, false, &sizeSync);
+        size_t sizeAsync = 0;
+        const auto cziAsync = CreateMosaicCziWithSyncOrAsyncAdd(bitmaps, compressionMode, writerOptions, true, &sizeAsync);
+
+        ASSERT_EQ(sizeSync, sizeAsync);
+        EXPECT_EQ(memcmp(cziSync.get(), cziAsync.get(), sizeSync), 0);
+    }
+}
+
+TEST(CziWriter, AsyncAddSubBlockWithZstd1AndWorkerThreadsAndCompareWithSyncAdd)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.number_of_compression_threads = 3;
+    CompareSyncAndAsyncAddAndExpectIdenticalResult(PixelType::Gray16, CompressionMode::Zstd1, writerOptions);
+}
+
+TEST(CziWriter, AsyncAddSubBlockWithZstd0AndWorkerThreadsAndCompareWithSyncAdd)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.number_of_compression_threads = 2;
+    CompareSyncAndAsyncAddAndExpectIdenticalResult(PixelType::Bgr24, CompressionMode::Zstd0, writerOptions);
+}
+
+TEST(CziWriter, AsyncAddSubBlockUncompressedWithoutWorkerThreadsAndCompareWithSyncAdd)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.number_of_compression_threads = 0;
+    CompareSyncAndAsyncAddAndExpectIdenticalResult(PixelType::Gray8, CompressionMode::UnCompressed, writerOptions);
+}
+
+TEST(CziWriter, AsyncAddSubBlockWithSmallMemoryLimitAndCompareWithSyncAdd)
+{
+    // the memory limit is smaller than a single subblock, so at most one subblock is pending at any time
+    CZIWriterOptions writerOptions;
+    writerOptions.number_of_compression_threads = 4;
+    writerOptions.max_memory_for_pending_subblocks = 1024;
+    CompareSyncAndAsyncAddAndExpectIdenticalResult(PixelType::Gray16, CompressionMode::Zstd1, writerOptions);
+}
+
+TEST(CziWriter, AsyncAddSubBlockWithUnsupportedCompressionModeAndExpectException)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.number_of_compression_threads = 1;
+    const auto writer = CreateCZIWriter(&writerOptions);
+    writer->Create(make_shared<CMemOutputStream>(0), nullptr);
+
+    AddSubBlockInfoUncompressedBitmap addSbBlkInfo;
+    addSbBlkInfo.coordinate = CDimCoordinate::Parse("C0");
+    addSbBlkInfo.x = 0;
+    addSbBlkInfo.y = 0;
+    addSbBlkInfo.logicalWidth = 16;
+    addSbBlkInfo.logicalHeight = 16;
+    addSbBlkInfo.bitmap = CreateTestBitmap(PixelType::Gray8, 16, 16);
+    addSbBlkInfo.SetCompressionMode(CompressionMode::Jpg);
+    EXPECT_THROW(writer->AsyncAddSubBlock(addSbBlkInfo), invalid_argument);
+
+    addSbBlkInfo.SetCompressionMode(CompressionMode::Zstd1);
+    addSbBlkInfo.bitmap.reset();
+    EXPECT_THROW(writer->AsyncAddSubBlock(addSbBlkInfo), invalid_argument);
+}
+
+TEST(CziWriter, AsyncAddDuplicateSubBlocksAndExpectErrorWhenFlushing)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.number_of_compression_threads = 2;
+    const auto writer = CreateCZIWriter(&writerOptions);
+    writer->Create(make_shared<CMemOutputStream>(0), nullptr);
+
+    AddSubBlockInfoUncompressedBitmap addSbBlkInfo;
+    addSbBlkInfo.coordinate = CDimCoordinate::Parse("C0T0Z1");
+    addSbBlkInfo.mIndexValid = true;
+    addSbBlkInfo.mIndex = 0;
+    addSbBlkInfo.x = 0;
+    addSbBlkInfo.y = 0;
+    addSbBlkInfo.logicalWidth = 64;
+    addSbBlkInfo.logicalHeight = 64;
+    addSbBlkInfo.bitmap = CreateTestBitmap(PixelType::Gray8, 64, 64);
+    addSbBlkInfo.SetCompressionMode(CompressionMode::Zstd1);
+
+    // the check for duplicates happens when the subblock is written, so the error is reported at the latest with 'Flush'
+    EXPECT_THROW(
+        {
+            writer->AsyncAddSubBlock(addSbBlkInfo);
+            writer->AsyncAddSubBlock(addSbBlkInfo);
+            writer->Flush();
+        },
+        LibCZIException);
+}
+
+namespace
+{
+    /// Create a CZI with a mosaic of 3x3 subblocks (of size 100x80, with random content) for the channels C0 and C1, where the
+    /// mosaic's origin is at (-50,30). The subblocks are added with 'AsyncAddSubBlock' (Zstd1-compressed by the writer), or - if
+    /// 'useSyncAdd' is true - with 'SyncAddSubBlock' (where C0 is added Zstd1-compressed and C1 uncompressed).
+    /// The bitmap of the complete mosaic (for each channel) is returned in 'mosaicBitmaps'.
+    shared_ptr<void> CreateMosaicCzi(const CZIWriterOptions& writerOptions, PixelType pixelType, bool useSyncAdd, vector<shared_ptr<IBitmapData>>& mosaicBitmaps, size_t* sizeOfCzi)
+    {
+        const auto writer = CreateCZIWriter(&writerOptions);
+        const auto outStream = make_shared<CMemOutputStream>(0);
+        writer->Create(outStream, nullptr);
+
+        const uint8_t bytesPerPel = CziUtils::GetBytesPerPel(pixelType);
+        mosaicBitmaps.clear();
+        for (int c = 0; c < 2; ++c)
+        {
+            const auto mosaicBitmap = CreateRandomBitmap(pixelType, 300, 240);
+            mosaicBitmaps.push_back(mosaicBitmap);
+            ScopedBitmapLockerSP lockMosaic{ mosaicBitmap };
+            for (int tileY = 0; tileY < 3; ++tileY)
+            {
+                for (int tileX = 0; tileX < 3; ++tileX)
+                {
+                    auto tileBitmap = CStdBitmapData::Create(pixelType, 100, 80);
+                    {
+                        ScopedBitmapLockerSP lockTile{ tileBitmap };
+                        for (int y = 0; y < 80; ++y)
+                        {
+                            memcpy(
+                                static_cast<uint8_t*>(lockTile.ptrDataRoi) + static_cast<size_t>(y) * lockTile.stride,
+                                static_cast<const uint8_t*>(lockMosaic.ptrDataRoi) + static_cast<size_t>(tileY * 80 + y) * lockMosaic.stride + static_cast<size_t>(tileX) * 100 * bytesPerPel,
+                                100 * static_cast<size_t>(bytesPerPel));
+                        }
+                    }
+
+                    if (useSyncAdd)
+                    {
+                        const ScopedBitmapLockerSP lockTile{ tileBitmap };
+                        shared_ptr<IMemoryBlock> encodedData;
+                        vector<uint8_t> uncompressedData;
+                        AddSubBlockInfoMemPtr addSbBlkInfo;
+                        addSbBlkInfo.Clear();
+                        if (c == 0)
+                        {
+                            encodedData = ZstdCompress::CompressZStd1Alloc(100, 80, lockTile.stride, pixelType, lockTile.ptrDataRoi, nullptr);
+                            addSbBlkInfo.ptrData = encodedData->GetPtr();
+                            addSbBlkInfo.dataSize = static_cast<uint32_t>(encodedData->GetSizeOfData());
+                            addSbBlkInfo.SetCompressionMode(CompressionMode::Zstd1);
+                        }
+                        else
+                        {
+                            // uncompressed data in CZI has a stride equal to the line-size
+                            const size_t lineSize = 100 * static_cast<size_t>(bytesPerPel);
+                            for (int y = 0; y < 80; ++y)
+                            {
+                                const uint8_t* line = static_cast<const uint8_t*>(lockTile.ptrDataRoi) + static_cast<size_t>(y) * lockTile.stride;
+                                uncompressedData.insert(uncompressedData.end(), line, line + lineSize);
+                            }
+
+                            addSbBlkInfo.ptrData = uncompressedData.data();
+                            addSbBlkInfo.dataSize = static_cast<uint32_t>(uncompressedData.size());
+                            addSbBlkInfo.SetCompressionMode(CompressionMode::UnCompressed);
+                        }
+
+                        addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, c } };
+                        addSbBlkInfo.mIndexValid = true;
+                        addSbBlkInfo.mIndex = tileY * 3 + tileX;
+                        addSbBlkInfo.x = -50 + tileX * 100;
+                        addSbBlkInfo.y = 30 + tileY * 80;
+                        addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 100;
+                        addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 80;
+                        addSbBlkInfo.PixelType = pixelType;
+                        writer->SyncAddSubBlock(addSbBlkInfo);
+                    }
+                    else
+                    {
+                        AddSubBlockInfoUncompressedBitmap addSbBlkInfo;
+                        addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, c } };
+                        addSbBlkInfo.mIndexValid = true;
+                        addSbBlkInfo.mIndex = tileY * 3 + tileX;
+                        addSbBlkInfo.x = -50 + tileX * 100;
+                        addSbBlkInfo.y = 30 + tileY * 80;
+                        addSbBlkInfo.logicalWidth = 100;
+                        addSbBlkInfo.logicalHeight = 80;
+                        addSbBlkInfo.bitmap = tileBitmap;
+                        addSbBlkInfo.SetCompressionMode(CompressionMode::Zstd1);
+                        writer->AsyncAddSubBlock(addSbBlkInfo);
+                    }
+                }
+            }
+        }
+
+        writer->Close();
+        return outStream->GetCopy(sizeOfCzi);
+    }
+
+    /// Check the pyramid layers found in the specified CZI (which was created with 'CreateMosaicCzi') against the mosaic bitmaps.
+    /// We check that each pixel of a pyramid subblock is equal to the respective pixel of the mosaic, and that each pyramid layer exactly covers
+    /// the mosaic (without overlap). The number of pyramid layers found is returned.
+    int CheckPyramidOfMosaicCzi(const shared_ptr<void>& czi, size_t sizeOfCzi, const vector<shared_ptr<IBitmapData>>& mosaicBitmaps, int minificationFactor)
+    {
+        const auto reader = CreateCZIReader();
+        reader->Open(CreateStreamFromMemory(czi, sizeOfCzi), nullptr);
+
+        const IntRect mosaicRect{ -50, 30, 300, 240 };
+        const auto ceilDiv = [](int a, int b)->int { return a >= 0 ? (a + b - 1) / b : -((-a) / b); };
+
+        // key is (channel, layer), value is the number of pixels in the pyramid subblocks
+        map<pair<int, int>, int64_t> pixelCountPerChannelAndLayer;
+        int maxLayer = 0;
+        reader->EnumerateSubBlocks(
+            [&](int index, const SubBlockInfo& info)->bool
+            {
+                if (info.logicalRect.w == static_cast<int>(info.physicalSize.w))
+                {
+                    EXPECT_EQ(info.pyramidType, SubBlockPyramidType::None);
+                    return true;
+                }
+
+                EXPECT_NE(info.pyramidType, SubBlockPyramidType::None);
+                EXPECT_FALSE(info.IsMindexValid());
+                const int scale = info.logicalRect.w / static_cast<int>(info.physicalSize.w);
+                EXPECT_EQ(info.logicalRect.w, scale * static_cast<int>(info.physicalSize.w));
+                EXPECT_EQ(info.logicalRect.h, scale * static_cast<int>(info.physicalSize.h));
+                int layer = 0;
+                for (int s = 1; s < scale; s *= minificationFactor)
+                {
+                    ++layer;
+                }
+
+                int c;
+                info.coordinate.TryGetPosition(DimensionIndex::C, &c);
+                pixelCountPerChannelAndLayer[make_pair(c, layer)] += static_cast<int64_t>(info.physicalSize.w) * info.physicalSize.h;
+                maxLayer = (std::max)(maxLayer, layer);
+
+                const auto bitmap = reader->ReadSubBlock(index)->CreateBitmap();
+                const uint8_t bytesPerPel = CziUtils::GetBytesPerPel(bitmap->GetPixelType());
+                ScopedBitmapLockerSP lockBitmap{ bitmap };
+                ScopedBitmapLockerSP lockMosaic{ mosaicBitmaps[c] };
+                for (uint32_t y = 0; y < info.physicalSize.h; ++y)
+                {
+                    for (uint32_t x = 0; x < info.physicalSize.w; ++x)
+                    {
+                        const int mosaicX = info.logicalRect.x + static_cast<int>(x) * scale - mosaicRect.x;
+                        const int mosaicY = info.logicalRect.y + static_cast<int>(y) * scale - mosaicRect.y;
+                        EXPECT_TRUE(mosaicX >= 0 && mosaicX < mosaicRect.w && mosaicY >= 0 && mosaicY < mosaicRect.h);
+                        const bool pixelIsEqual = memcmp(
+                            static_cast<const uint8_t*>(lockBitmap.ptrDataRoi) + y * static_cast<size_t>(lockBitmap.stride) + x * static_cast<size_t>(bytesPerPel),
+                            static_cast<const uint8_t*>(lockMosaic.ptrDataRoi) + mosaicY * static_cast<size_t>(lockMosaic.stride) + mosaicX * static_cast<size_t>(bytesPerPel),
+                            bytesPerPel) == 0;
+                        if (!pixelIsEqual)
+                        {
+                            ADD_FAILURE() << "pixel mismatch in pyramid-subblock #" << index << " at (" << x << "," << y << ")";
+                            return false;
+                        }
+                    }
+                }
+
+                return true;
+            });
+
+        int scale = 1;
+        for (int layer = 1; layer <= maxLayer; ++layer)
+        {
+            scale *= minificationFactor;
+            const int64_t expectedPixelCount =
+                static_cast<int64_t>(ceilDiv(mosaicRect.x + mosaicRect.w, scale) - ceilDiv(mosaicRect.x, scale)) *
+                (ceilDiv(mosaicRect.y + mosaicRect.h, scale) - ceilDiv(mosaicRect.y, scale));
+            EXPECT_EQ(pixelCountPerChannelAndLayer[make_pair(0, layer)], expectedPixelCount);
+            EXPECT_EQ(pixelCountPerChannelAndLayer[make_pair(1, layer)], expectedPixelCount);
+        }
+
+        return maxLayer;
+    }
+}
+
+TEST(CziWriter, AsyncAddSubBlockWithPyramidGenerationFactor2AndCheckPyramidLayers)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.number_of_compression_threads = 2;
+    writerOptions.generate_pyramid = true;
+    writerOptions.pyramid_minification_factor = 2;
+    writerOptions.pyramid_tile_size = 64;
+    writerOptions.pyramid_compression_mode = CompressionMode::Zstd1;
+
+    vector<shared_ptr<IBitmapData>> mosaicBitmaps;
+    size_t sizeOfCzi = 0;
+    const auto czi = CreateMosaicCzi(writerOptions, PixelType::Gray16, false, mosaicBitmaps, &sizeOfCzi);
+
+    // the extent of layer 2 is 75x60, which does not fit into a tile of 64x64, so we expect 3 pyramid layers
+    const int numberOfLayers = CheckPyramidOfMosaicCzi(czi, sizeOfCzi, mosaicBitmaps, 2);
+    EXPECT_EQ(numberOfLayers, 3);
+
+    const auto reader = CreateCZIReader();
+    reader->Open(CreateStreamFromMemory(czi, sizeOfCzi), nullptr);
+    const auto pyramidStatistics = reader->GetPyramidStatistics();
+    ASSERT_EQ(pyramidStatistics.scenePyramidStatistics.size(), 1);
+    const auto& layerStatistics = pyramidStatistics.scenePyramidStatistics.begin()->second;
+    ASSERT_EQ(layerStatistics.size(), 4);
+    for (const auto& item : layerStatistics)
+    {
+        EXPECT_TRUE(item.layerInfo.IsLayer0() || item.layerInfo.minificationFactor == 2);
+    }
+}
+
+TEST(CziWriter, AsyncAddSubBlockWithPyramidGenerationFactor3AndCheckPyramidLayers)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.number_of_compression_threads = 0;
+    writerOptions.generate_pyramid = true;
+    writerOptions.pyramid_minification_factor = 3;
+    writerOptions.pyramid_tile_size = 32;
+    writerOptions.pyramid_compression_mode = CompressionMode::UnCompressed;
+
+    vector<shared_ptr<IBitmapData>> mosaicBitmaps;
+    size_t sizeOfCzi = 0;
+    const auto czi = CreateMosaicCzi(writerOptions, PixelType::Bgr24, false, mosaicBitmaps, &sizeOfCzi);
+
+    // the extent of layer 2 is 34x27, which does not fit into a tile of 32x32, so we expect 3 pyramid layers
+    const int numberOfLayers = CheckPyramidOfMosaicCzi(czi, sizeOfCzi, mosaicBitmaps, 3);
+    EXPECT_EQ(numberOfLayers, 3);
+}
+
+TEST(CziWriter, SyncAddSubBlockWithPyramidGenerationAndCheckPyramidLayers)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.number_of_compression_threads = 2;
+    writerOptions.generate_pyramid = true;
+    writerOptions.pyramid_minification_factor = 2;
+    writerOptions.pyramid_tile_size = 64;
+    writerOptions.pyramid_compression_mode = CompressionMode::Zstd1;
+
+    vector<shared_ptr<IBitmapData>> mosaicBitmaps;
+    size_t sizeOfCzi = 0;
+    const auto czi = CreateMosaicCzi(writerOptions, PixelType::Gray16, true, mosaicBitmaps, &sizeOfCzi);
+
+    // the layer-0 subblocks are decoded by the writer, so we expect the same pyramid as with "AsyncAddSubBlock"
+    const int numberOfLayers = CheckPyramidOfMosaicCzi(czi, sizeOfCzi, mosaicBitmaps, 2);
+    EXPECT_EQ(numberOfLayers, 3);
+}
+
+TEST(CziWriter, AsyncAddSubBlockWithPyramidGenerationForSmallImageAndExpectNoPyramid)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.generate_pyramid = true;
+    writerOptions.pyramid_tile_size = 512;
+
+    vector<shared_ptr<IBitmapData>> mosaicBitmaps;
+    size_t sizeOfCzi = 0;
+    const auto czi = CreateMosaicCzi(writerOptions, PixelType::Gray8, false, mosaicBitmaps, &sizeOfCzi);
+    EXPECT_EQ(CheckPyramidOfMosaicCzi(czi, sizeOfCzi, mosaicBitmaps, 2), 0);
+}
+
+TEST(CziWriter, CreateWriterWithInvalidPyramidOptionsAndExpectException)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.generate_pyramid = true;
+    writerOptions.pyramid_minification_factor = 4;
+    const auto writer = CreateCZIWriter(&writerOptions);
+    EXPECT_THROW(writer->Create(make_shared<CMemOutputStream>(0), nullptr), invalid_argument);
+}
+
+TEST(CziWriter, SpatialSubBlockOrderCheckHilbertAndMortonIndex)
+{
+    EXPECT_EQ(CSpatialSubBlockOrder::CalcMortonIndex(0, 0), 0);
+    EXPECT_EQ(CSpatialSubBlockOrder::CalcMortonIndex(1, 0), 1);
+    EXPECT_EQ(CSpatialSubBlockOrder::CalcMortonIndex(0, 1), 2);
+    EXPECT_EQ(CSpatialSubBlockOrder::CalcMortonIndex(1, 1), 3);
+    EXPECT_EQ(CSpatialSubBlockOrder::CalcMortonIndex(2, 0), 4);
+    EXPECT_EQ(CSpatialSubBlockOrder::CalcMortonIndex(0xffffffff, 0xffffffff), 0xffffffffffffffffULL);
+
+    // for a grid of 16x16 cells, the Hilbert indices must be a permutation of 0...255, and adjacent indices must be adjacent cells
+    vector<pair<uint32_t, uint32_t>> cellsInHilbertOrder(256, make_pair(0xffffffff, 0xffffffff));
+    for (uint32_t y = 0; y < 16; ++y)
+    {
+        for (uint32_t x = 0; x < 16; ++x)
+        {
+            const auto index = CSpatialSubBlockOrder::CalcHilbertIndex(x, y);
+            ASSERT_LT(index, 256);
+            EXPECT_EQ(cellsInHilbertOrder[static_cast<size_t>(index)].first, 0xffffffff);
+            cellsInHilbertOrder[static_cast<size_t>(index)] = make_pair(x, y);
+        }
+    }
+
+    for (size_t i = 1; i < cellsInHilbertOrder.size(); ++i)
+    {
+        const int distance =
+            abs(static_cast<int>(cellsInHilbertOrder[i].first) - static_cast<int>(cellsInHilbertOrder[i - 1].first)) +
+            abs(static_cast<int>(cellsInHilbertOrder[i].second) - static_cast<int>(cellsInHilbertOrder[i - 1].second));
+        EXPECT_EQ(distance, 1);
+    }
+}
+
+namespace
+{
+    /// Create a CZI with a mosaic of 4x4 tiles (of size 10x10, without overlap) for the channels C0 and C1. The tiles are added in
+    /// "acquisition order", i.e. the channels are interleaved and the tiles are scanned in a serpentine pattern.
+    shared_ptr<void> CreateMosaicCziInAcquisitionOrder(CZIWriterSubBlockLayout layout, size_t* sizeOfCzi)
+    {
+        CZIWriterOptions writerOptions;
+        writerOptions.subblock_layout = layout;
+        const auto writer = CreateCZIWriter(&writerOptions);
+        const auto outStream = make_shared<CMemOutputStream>(0);
+        const auto writerInfo = make_shared<CCziWriterInfo>(libCZI::GUID{ 0x1234567, 0x89ab, 0xcdef, { 1, 2, 3, 4, 5, 6, 7, 8 } });
+        writer->Create(outStream, writerInfo);
+
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                const int column = (row % 2 == 0) ? i : 3 - i;
+                for (int c = 0; c < 2; ++c)
+                {
+                    // the pixel value encodes the tile-position and the channel, so that we can check the content later on
+                    const uint8_t pixelValue = static_cast<uint8_t>(c * 16 + row * 4 + column);
+                    vector<uint8_t> pixels(10 * 10, pixelValue);
+                    AddSubBlockInfoMemPtr addSbBlkInfo;
+                    addSbBlkInfo.Clear();
+                    addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, c } };
+                    addSbBlkInfo.mIndexValid = true;
+                    addSbBlkInfo.mIndex = row * 4 + column;
+                    addSbBlkInfo.x = column * 10;
+                    addSbBlkInfo.y = row * 10;
+                    addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 10;
+                    addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 10;
+                    addSbBlkInfo.PixelType = PixelType::Gray8;
+                    addSbBlkInfo.ptrData = pixels.data();
+                    addSbBlkInfo.dataSize = pixels.size();
+                    writer->SyncAddSubBlock(addSbBlkInfo);
+                }
+            }
+        }
+
+        writer->Close();
+        return outStream->GetCopy(sizeOfCzi);
+    }
+}
+
+TEST(CziWriter, WriteWithSpatialSubBlockLayoutAndCheckOrderInFile)
+{
+    for (const auto layout : { CZIWriterSubBlockLayout::PlaneThenHilbertOrder, CZIWriterSubBlockLayout::PlaneThenMortonOrder })
+    {
+        size_t sizeOfCzi = 0;
+        const auto czi = CreateMosaicCziInAcquisitionOrder(layout, &sizeOfCzi);
+        const auto reader = CreateCZIReader();
+        reader->Open(CreateStreamFromMemory(czi, sizeOfCzi), nullptr);
+
+        // get the subblocks ordered by their position in the file
+        vector<DirectorySubBlockInfo> subBlocksInFileOrder;
+        vector<int> indices;
+        reader->EnumerateSubBlocksEx(
+            [&](int index, const DirectorySubBlockInfo& info)->bool
+            {
+                subBlocksInFileOrder.push_back(info);
+                indices.push_back(index);
+                return true;
+            });
+        ASSERT_EQ(subBlocksInFileOrder.size(), 32);
+
+        vector<size_t> order(subBlocksInFileOrder.size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](size_t a, size_t b)->bool { return subBlocksInFileOrder[a].filePosition < subBlocksInFileOrder[b].filePosition; });
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            const auto& info = subBlocksInFileOrder[order[i]];
+
+            // the first 16 subblocks must be of channel 0, the next 16 of channel 1
+            int c;
+            ASSERT_TRUE(info.coordinate.TryGetPosition(DimensionIndex::C, &c));
+            EXPECT_EQ(c, i < 16 ? 0 : 1);
+
+            // and within a channel, the tiles must be ordered along the space-filling curve
+            const auto column = static_cast<uint32_t>(info.logicalRect.x / 10);
+            const auto row = static_cast<uint32_t>(info.logicalRect.y / 10);
+            const auto expectedCurveIndex = layout == CZIWriterSubBlockLayout::PlaneThenHilbertOrder ?
+                CSpatialSubBlockOrder::CalcHilbertIndex(column, row) :
+                CSpatialSubBlockOrder::CalcMortonIndex(column, row);
+            EXPECT_EQ(expectedCurveIndex, i % 16);
+
+            // check that the content of the subblock is correct
+            const auto subBlock = reader->ReadSubBlock(indices[order[i]]);
+            size_t sizeData;
+            const auto data = subBlock->GetRawData(ISubBlock::MemBlkType::Data, &sizeData);
+            ASSERT_EQ(sizeData, 100);
+            EXPECT_EQ(static_cast<const uint8_t*>(data.get())[0], static_cast<uint8_t>(c * 16 + row * 4 + column));
+        }
+    }
+}
+
+TEST(CziWriter, WriteWithSpatialSubBlockLayoutAndCompareStatisticsWithInOrderLayout)
+{
+    size_t sizeOfCziInOrder = 0, sizeOfCziSpatial = 0;
+    const auto cziInOrder = CreateMosaicCziInAcquisitionOrder(CZIWriterSubBlockLayout::InOrderOfAddition, &sizeOfCziInOrder);
+    const auto cziSpatial = CreateMosaicCziInAcquisitionOrder(CZIWriterSubBlockLayout::PlaneThenHilbertOrder, &sizeOfCziSpatial);
+    EXPECT_EQ(sizeOfCziInOrder, sizeOfCziSpatial);
+
+    const auto readerInOrder = CreateCZIReader();
+    readerInOrder->Open(CreateStreamFromMemory(cziInOrder, sizeOfCziInOrder), nullptr);
+    const auto readerSpatial = CreateCZIReader();
+    readerSpatial->Open(CreateStreamFromMemory(cziSpatial, sizeOfCziSpatial), nullptr);
+
+    const auto statisticsInOrder = readerInOrder->GetStatistics();
+    const auto statisticsSpatial = readerSpatial->GetStatistics();
+    EXPECT_EQ(statisticsInOrder.subBlockCount, statisticsSpatial.subBlockCount);
+    EXPECT_TRUE(statisticsInOrder.boundingBox.x == statisticsSpatial.boundingBox.x && statisticsInOrder.boundingBox.y == statisticsSpatial.boundingBox.y &&
+        statisticsInOrder.boundingBox.w == statisticsSpatial.boundingBox.w && statisticsInOrder.boundingBox.h == statisticsSpatial.boundingBox.h);
+    EXPECT_EQ(statisticsInOrder.minMindex, statisticsSpatial.minMindex);
+    EXPECT_EQ(statisticsInOrder.maxMindex, statisticsSpatial.maxMindex);
+    EXPECT_EQ(Utils::DimBoundsToString(&statisticsInOrder.dimBounds), Utils::DimBoundsToString(&statisticsSpatial.dimBounds));
+}
+
+TEST(CziWriter, WriteWithSpatialSubBlockLayoutAndCheckMetadataAndAttachmentOfSubBlocks)
+{
+    // the subblocks held back for the spatial layout are spooled to a temporary file - check that data, metadata and
+    // attachment of every subblock survive this round-trip
+    CZIWriterOptions writerOptions;
+    writerOptions.subblock_layout = CZIWriterSubBlockLayout::PlaneThenHilbertOrder;
+    const auto writer = CreateCZIWriter(&writerOptions);
+    const auto outStream = make_shared<CMemOutputStream>(0);
+    const auto writerInfo = make_shared<CCziWriterInfo>(libCZI::GUID{ 0x1234567, 0x89ab, 0xcdef, { 1, 2, 3, 4, 5, 6, 7, 8 } });
+    writer->Create(outStream, writerInfo);
+
+    for (int m = 0; m < 16; ++m)
+    {
+        const int row = m / 4;
+        const int column = (row % 2 == 0) ? m % 4 : 3 - m % 4;
+        const vector<uint8_t> pixels(10 * 10, static_cast<uint8_t>(m));
+        const string metadata = "<METADATA><Tags><M>" + to_string(m) + "</M></Tags></METADATA>";
+        const vector<uint8_t> attachment(static_cast<size_t>(m + 1), static_cast<uint8_t>(0x80 + m));
+        AddSubBlockInfoMemPtr addSbBlkInfo;
+        addSbBlkInfo.Clear();
+        addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, 0 } };
+        addSbBlkInfo.mIndexValid = true;
+        addSbBlkInfo.mIndex = m;
+        addSbBlkInfo.x = column * 10;
+        addSbBlkInfo.y = row * 10;
+        addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 10;
+        addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 10;
+        addSbBlkInfo.PixelType = PixelType::Gray8;
+        addSbBlkInfo.ptrData = pixels.data();
+        addSbBlkInfo.dataSize = static_cast<uint32_t>(pixels.size());
+        addSbBlkInfo.ptrSbBlkMetadata = metadata.c_str();
+        addSbBlkInfo.sbBlkMetadataSize = static_cast<uint32_t>(metadata.size());
+        addSbBlkInfo.ptrSbBlkAttachment = attachment.data();
+        addSbBlkInfo.sbBlkAttachmentSize = static_cast<uint32_t>(attachment.size());
+        writer->SyncAddSubBlock(addSbBlkInfo);
+    }
+
+    writer->Close();
+
+    size_t sizeOfCzi = 0;
+    const auto czi = outStream->GetCopy(&sizeOfCzi);
+    const auto reader = CreateCZIReader();
+    reader->Open(CreateStreamFromMemory(czi, sizeOfCzi), nullptr);
+
+    int subBlockCount = 0;
+    reader->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            ++subBlockCount;
+            const auto subBlock = reader->ReadSubBlock(index);
+            const int m = info.mIndex;
+
+            size_t size;
+            const auto data = subBlock->GetRawData(ISubBlock::MemBlkType::Data, &size);
+            EXPECT_EQ(size, 100);
+            EXPECT_EQ(static_cast<const uint8_t*>(data.get())[99], static_cast<uint8_t>(m));
+
+            const auto metadata = subBlock->GetRawData(ISubBlock::MemBlkType::Metadata, &size);
+            const string expectedMetadata = "<METADATA><Tags><M>" + to_string(m) + "</M></Tags></METADATA>";
+            EXPECT_EQ(string(static_cast<const char*>(metadata.get()), size), expectedMetadata);
+
+            const auto attachment = subBlock->GetRawData(ISubBlock::MemBlkType::Attachment, &size);
+            EXPECT_EQ(size, static_cast<size_t>(m + 1));
+            EXPECT_TRUE(all_of(
+                static_cast<const uint8_t*>(attachment.get()),
+                static_cast<const uint8_t*>(attachment.get()) + size,
+                [m](uint8_t b)->bool { return b == static_cast<uint8_t>(0x80 + m); }));
+            return true;
+        });
+
+    EXPECT_EQ(subBlockCount, 16);
+}
+
+namespace
+{
+    uint8_t GetExpectedPixelValueOfBackgroundTilesMosaic(int row, int column)
+    {
+        return (row + column) % 2 == 0 ? 0 : static_cast<uint8_t>(1 + row * 4 + column);
+    }
+
+    /// Creates a mosaic of 4x4 tiles (of size 10x10 pixels, Gray8) where the tiles in a checkerboard pattern are all-zero (i.e. identical),
+    /// and the other tiles have a pixel value which encodes their position.
+    shared_ptr<void> CreateMosaicCziWithBackgroundTiles(bool deduplicate, CZIWriterSubBlockLayout layout, SubBlockDeduplicationStatistics* statistics, size_t* sizeOfCzi)
+    {
+        CZIWriterOptions writerOptions;
+        writerOptions.deduplicate_subblocks = deduplicate;
+        writerOptions.subblock_layout = layout;
+        const auto writer = CreateCZIWriter(&writerOptions);
+        const auto outStream = make_shared<CMemOutputStream>(0);
+        const auto writerInfo = make_shared<CCziWriterInfo>(libCZI::GUID{ 0x1234567, 0x89ab, 0xcdef, { 1, 2, 3, 4, 5, 6, 7, 8 } });
+        writer->Create(outStream, writerInfo);
+
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                vector<uint8_t> pixels(10 * 10, GetExpectedPixelValueOfBackgroundTilesMosaic(row, column));
+                AddSubBlockInfoMemPtr addSbBlkInfo;
+                addSbBlkInfo.Clear();
+                addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, 0 } };
+                addSbBlkInfo.mIndexValid = true;
+                addSbBlkInfo.mIndex = row * 4 + column;
+                addSbBlkInfo.x = column * 10;
+                addSbBlkInfo.y = row * 10;
+                addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 10;
+                addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 10;
+                addSbBlkInfo.PixelType = PixelType::Gray8;
+                addSbBlkInfo.ptrData = pixels.data();
+                addSbBlkInfo.dataSize = pixels.size();
+                writer->SyncAddSubBlock(addSbBlkInfo);
+            }
+        }
+
+        writer->Close();
+        *statistics = writer->GetDeduplicationStatistics();
+        return outStream->GetCopy(sizeOfCzi);
+    }
+}
+
+TEST(CziWriter, WriteWithDeduplicationAndCheckStatisticsAndContent)
+{
+    SubBlockDeduplicationStatistics statistics, statisticsWithoutDeduplication;
+    size_t sizeOfCzi = 0, sizeOfCziWithoutDeduplication = 0;
+    const auto czi = CreateMosaicCziWithBackgroundTiles(true, CZIWriterSubBlockLayout::InOrderOfAddition, &statistics, &sizeOfCzi);
+    CreateMosaicCziWithBackgroundTiles(false, CZIWriterSubBlockLayout::InOrderOfAddition, &statisticsWithoutDeduplication, &sizeOfCziWithoutDeduplication);
+
+    // 8 tiles are all-zero, so only one of them is expected to be written
+    EXPECT_EQ(statistics.subBlocksWritten, 9);
+    EXPECT_EQ(statistics.subBlocksDeduplicated, 7);
+    EXPECT_EQ(sizeOfCziWithoutDeduplication - sizeOfCzi, statistics.bytesSaved);
+    EXPECT_EQ(statisticsWithoutDeduplication.subBlocksWritten, 0);
+    EXPECT_EQ(statisticsWithoutDeduplication.subBlocksDeduplicated, 0);
+    EXPECT_EQ(statisticsWithoutDeduplication.bytesSaved, 0);
+
+    const auto reader = CreateCZIReader();
+    reader->Open(CreateStreamFromMemory(czi, sizeOfCzi), nullptr);
+
+    set<uint64_t> filePositionsOfBackgroundTiles, filePositionsOfOtherTiles;
+    int subBlockCount = 0;
+    reader->EnumerateSubBlocksEx(
+        [&](int index, const DirectorySubBlockInfo& info)->bool
+        {
+            const int row = info.logicalRect.y / 10;
+            const int column = info.logicalRect.x / 10;
+            const auto expectedPixelValue = GetExpectedPixelValueOfBackgroundTilesMosaic(row, column);
+            (expectedPixelValue == 0 ? filePositionsOfBackgroundTiles : filePositionsOfOtherTiles).insert(info.filePosition);
+
+            // the information of the subblock must be the one from the directory (and not the one in the shared segment-header)
+            const auto subBlock = reader->ReadSubBlock(index);
+            const auto& subBlockInfo = subBlock->GetSubBlockInfo();
+            EXPECT_EQ(subBlockInfo.logicalRect.x, column * 10);
+            EXPECT_EQ(subBlockInfo.logicalRect.y, row * 10);
+            EXPECT_EQ(subBlockInfo.mIndex, row * 4 + column);
+
+            size_t sizeData;
+            const auto data = subBlock->GetRawData(ISubBlock::MemBlkType::Data, &sizeData);
+            EXPECT_EQ(sizeData, 100);
+            EXPECT_EQ(static_cast<const uint8_t*>(data.get())[0], expectedPixelValue);
+            ++subBlockCount;
+            return true;
+        });
+
+    EXPECT_EQ(subBlockCount, 16);
+    EXPECT_EQ(filePositionsOfBackgroundTiles.size(), 1);
+    EXPECT_EQ(filePositionsOfOtherTiles.size(), 8);
+
+    const auto accessor = reader->CreateSingleChannelTileAccessor();
+    const CDimCoordinate planeCoordinate{ { DimensionIndex::C, 0 } };
+    const auto bitmap = accessor->Get(PixelType::Gray8, IntRect{ 0, 0, 40, 40 }, &planeCoordinate, nullptr);
+    const ScopedBitmapLockerSP lockInfo{ bitmap };
+    for (int y = 0; y < 40; ++y)
+    {
+        const uint8_t* line = static_cast<const uint8_t*>(lockInfo.ptrDataRoi) + y * lockInfo.stride;
+        for (int x = 0; x < 40; ++x)
+        {
+            ASSERT_EQ(line[x], GetExpectedPixelValueOfBackgroundTilesMosaic(y / 10, x / 10));
+        }
+    }
+}
+
+TEST(CziWriter, WriteWithDeduplicationAndSpatialLayoutAndCompareWithInOrderLayout)
+{
+    SubBlockDeduplicationStatistics statisticsInOrder, statisticsSpatial;
+    size_t sizeOfCziInOrder = 0, sizeOfCziSpatial = 0;
+    CreateMosaicCziWithBackgroundTiles(true, CZIWriterSubBlockLayout::InOrderOfAddition, &statisticsInOrder, &sizeOfCziInOrder);
+    const auto czi = CreateMosaicCziWithBackgroundTiles(true, CZIWriterSubBlockLayout::PlaneThenHilbertOrder, &statisticsSpatial, &sizeOfCziSpatial);
+
+    EXPECT_EQ(sizeOfCziInOrder, sizeOfCziSpatial);
+    EXPECT_EQ(statisticsInOrder.subBlocksWritten, statisticsSpatial.subBlocksWritten);
+    EXPECT_EQ(statisticsInOrder.subBlocksDeduplicated, statisticsSpatial.subBlocksDeduplicated);
+    EXPECT_EQ(statisticsInOrder.bytesSaved, statisticsSpatial.bytesSaved);
+
+    const auto reader = CreateCZIReader();
+    reader->Open(CreateStreamFromMemory(czi, sizeOfCziSpatial), nullptr);
+    reader->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            const auto subBlock = reader->ReadSubBlock(index);
+            size_t sizeData;
+            const auto data = subBlock->GetRawData(ISubBlock::MemBlkType::Data, &sizeData);
+            EXPECT_EQ(sizeData, 100);
+            EXPECT_EQ(static_cast<const uint8_t*>(data.get())[0], GetExpectedPixelValueOfBackgroundTilesMosaic(info.logicalRect.y / 10, info.logicalRect.x / 10));
+            return true;
+        });
+}
+
+TEST(CziWriter, ReadDeduplicatedCziAndCheckThatSharedSegmentIsReadOnceAndBitmapsAreIndependent)
+{
+    SubBlockDeduplicationStatistics statistics;
+    size_t sizeOfCzi = 0;
+    const auto czi = CreateMosaicCziWithBackgroundTiles(true, CZIWriterSubBlockLayout::InOrderOfAddition, &statistics, &sizeOfCzi);
+
+    for (const bool cacheSharedSubBlockSegments : { true, false })
+    {
+        ICZIReader::OpenOptions openOptions;
+        openOptions.cache_shared_subblock_segments = cacheSharedSubBlockSegments;
+        const auto reader = CreateCZIReader();
+        reader->Open(CreateStreamFromMemory(czi, sizeOfCzi), &openOptions);
+
+        // get the indices of two background tiles (which share a segment) and of two other tiles
+        vector<int> indicesOfBackgroundTiles, indicesOfOtherTiles;
+        reader->EnumerateSubBlocks(
+            [&](int index, const SubBlockInfo& info)->bool
+            {
+                const auto pixelValue = GetExpectedPixelValueOfBackgroundTilesMosaic(info.logicalRect.y / 10, info.logicalRect.x / 10);
+                (pixelValue == 0 ? indicesOfBackgroundTiles : indicesOfOtherTiles).push_back(index);
+                return true;
+            });
+
+        ASSERT_GE(indicesOfBackgroundTiles.size(), 2);
+        ASSERT_GE(indicesOfOtherTiles.size(), 2);
+        const auto subBlockBackground1 = reader->ReadSubBlock(indicesOfBackgroundTiles[0]);
+        const auto subBlockBackground2 = reader->ReadSubBlock(indicesOfBackgroundTiles[1]);
+        const auto subBlockOther1 = reader->ReadSubBlock(indicesOfOtherTiles[0]);
+        const auto subBlockOther2 = reader->ReadSubBlock(indicesOfOtherTiles[1]);
+
+        // with caching, the data of the shared segment is read only once
+        size_t sizeData;
+        EXPECT_EQ(
+            subBlockBackground1->GetRawData(ISubBlock::MemBlkType::Data, &sizeData).get() == subBlockBackground2->GetRawData(ISubBlock::MemBlkType::Data, &sizeData).get(),
+            cacheSharedSubBlockSegments);
+        EXPECT_NE(subBlockOther1->GetRawData(ISubBlock::MemBlkType::Data, &sizeData).get(), subBlockOther2->GetRawData(ISubBlock::MemBlkType::Data, &sizeData).get());
+
+        // each call to "CreateBitmap" gives an independent bitmap, so modifying one of them must not affect the other
+        const auto bitmapBackground1 = subBlockBackground1->CreateBitmap();
+        const auto bitmapBackground2 = subBlockBackground2->CreateBitmap();
+        EXPECT_NE(bitmapBackground1.get(), bitmapBackground2.get());
+        {
+            const ScopedBitmapLockerSP lockInfo{ bitmapBackground1 };
+            EXPECT_EQ(static_cast<const uint8_t*>(lockInfo.ptrDataRoi)[0], 0);
+            static_cast<uint8_t*>(lockInfo.ptrDataRoi)[0] = 42;
+        }
+
+        const ScopedBitmapLockerSP lockInfo{ bitmapBackground2 };
+        EXPECT_EQ(static_cast<const uint8_t*>(lockInfo.ptrDataRoi)[0], 0);
+        EXPECT_TRUE(AreBitmapDataEqual(subBlockBackground2->CreateBitmap(), bitmapBackground2));
+    }
+}
+
+TEST(CziWriter, WriteWithLimitedNumberOfDirectoryEntriesInMemoryAndCheckContent)
+{
+    CZIWriterOptions writerOptions;
+    writerOptions.max_subblock_directory_entries_in_memory = 5;
+    const auto writer = CreateCZIWriter(&writerOptions);
+    const auto outStream = make_shared<CMemOutputStream>(0);
+    const auto writerInfo = make_shared<CCziWriterInfo>(libCZI::GUID{ 0x1234567, 0x89ab, 0xcdef, { 1, 2, 3, 4, 5, 6, 7, 8 } });
+    writer->Create(outStream, writerInfo);
+
+    const auto addTile = [&](int row, int column)->void
+        {
+            vector<uint8_t> pixels(10 * 10, static_cast<uint8_t>(1 + row * 4 + column));
+            AddSubBlockInfoMemPtr addSbBlkInfo;
+            addSbBlkInfo.Clear();
+            addSbBlkInfo.coordinate = CDimCoordinate{ { DimensionIndex::C, 0 } };
+            addSbBlkInfo.mIndexValid = true;
+            addSbBlkInfo.mIndex = row * 4 + column;
+            addSbBlkInfo.x = column * 10;
+            addSbBlkInfo.y = row * 10;
+            addSbBlkInfo.logicalWidth = addSbBlkInfo.physicalWidth = 10;
+            addSbBlkInfo.logicalHeight = addSbBlkInfo.physicalHeight = 10;
+            addSbBlkInfo.PixelType = PixelType::Gray8;
+            addSbBlkInfo.ptrData = pixels.data();
+            addSbBlkInfo.dataSize = pixels.size();
+            writer->SyncAddSubBlock(addSbBlkInfo);
+        };
+
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            addTile(row, column);
+        }
+    }
+
+    // the first subblock has been spilled to the temporary file by now, and adding it again must be detected as a duplicate
+    bool duplicateDetected = false;
+    try
+    {
+        addTile(0, 0);
+    }
+    catch (LibCZIWriteException& e)
+    {
+        duplicateDetected = e.GetErrorType() == LibCZIWriteException::ErrorType::AddCoordinateAlreadyExisting;
+    }
+
+    EXPECT_TRUE(duplicateDetected);
+    writer->Close();
+
+    size_t sizeOfCzi;
+    const auto czi = outStream->GetCopy(&sizeOfCzi);
+    const auto reader = CreateCZIReader();
+    reader->Open(CreateStreamFromMemory(czi, sizeOfCzi), nullptr);
+    EXPECT_EQ(reader->GetStatistics().subBlockCount, 16);
+
+    vector<int> mIndices;
+    reader->EnumerateSubBlocks(
+        [&](int index, const SubBlockInfo& info)->bool
+        {
+            mIndices.push_back(info.mIndex);
+            const auto subBlock = reader->ReadSubBlock(index);
+            size_t sizeData;
+            const auto data = subBlock->GetRawData(ISubBlock::MemBlkType::Data, &sizeData);
+            EXPECT_EQ(sizeData, 100);
+            EXPECT_EQ(static_cast<const uint8_t*>(data.get())[0], 1 + info.mIndex);
+            return true;
+        });
+
+    // the subblock-directory is sorted (by M-index here), just like it is the case without a limit
+    vector<int> expectedMIndices(16);
+    iota(expectedMIndices.begin(), expectedMIndices.end(), 0);
+    EXPECT_EQ(mIndices, expectedMIndices);
+}